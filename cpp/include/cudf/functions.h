@@ -94,6 +94,44 @@ gdf_error gdf_column_free(gdf_column *column);
 /* ----------------------------------------------------------------------------*/
 gdf_error gdf_column_concat(gdf_column *output, gdf_column *columns_to_concat[], int num_columns);
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief  Creates a view of the rows [begin, end) of a column without copying
+ * its data
+ *
+ * The slice shares the data buffer of the input. The validity bitmask is shared
+ * as well when begin is a multiple of 32 rows, i.e., when the slice starts on a
+ * word boundary of the mask. Otherwise the slice gets its own copy of the mask,
+ * shifted into place a word at a time. In both cases release the slice with
+ * gdf_column_slice_free, never with gdf_column_free.
+ * 
+ * @param[in] input The column to slice
+ * @param[in] begin The first row of the slice
+ * @param[in] end One past the last row of the slice
+ * @param[out] output The slice. Its null_count is computed.
+ * 
+ * @returns GDF_SUCCESS upon successful completion, GDF_DATASET_EMPTY if input
+ * or output is null, GDF_INVALID_API_CALL if the range is out of bounds,
+ * GDF_UNSUPPORTED_DTYPE if the rows are not fixed width
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_column_slice(gdf_column *input, gdf_size_type begin, gdf_size_type end, gdf_column *output);
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief  Releases a slice created by gdf_column_slice from input
+ *
+ * Frees the validity bitmask of the slice if it is not shared with input. The
+ * data is always owned by input.
+ * 
+ * @param[in] input The column the slice was taken from
+ * @param[in,out] slice The slice to release
+ * 
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_column_slice_free(gdf_column *input, gdf_column *slice);
+
 /* context operations */
 
 gdf_error gdf_context_view(gdf_context *context, int flag_sorted, gdf_method flag_method,
@@ -107,6 +145,31 @@ int gdf_cuda_last_error();
 const char * gdf_cuda_error_string(int cuda_error);
 const char * gdf_cuda_error_name(int cuda_error);
 
+/* scratch memory */
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Reports usage statistics of the device scratch memory allocator
+ *
+ * @param[out] stats Filled with the statistics of the allocator
+ *
+ * @returns GDF_SUCCESS, or GDF_INVALID_API_CALL if stats is null
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_scratch_memory_stats(gdf_allocator_stats *stats);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Returns all device memory cached by the scratch memory allocator
+ * to RMM, including the blocks cached by other threads
+ *
+ * The cached blocks belong to RMM, so this must be called before rmmFinalize.
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_scratch_memory_release();
+
 /* ipc */
 
 gdf_ipc_parser_type* gdf_ipc_parser_open(const uint8_t *schema, size_t length);
@@ -167,6 +230,12 @@ gdf_error gdf_segmented_radixsort_plan_free(gdf_segmented_radixsort_plan_type *h
 * The following function performs a sort on the key and value columns.
 * The null_count of the keycol and valcol columns are expected to be 0
 * otherwise a GDF_VALIDITY_UNSUPPORTED error is returned.
+* The sort within each segment is stable. Segments of up to 8 items are
+* sorted per thread, segments of up to 1024 items per thread block and only
+* larger ones by the device-wide segmented radix sort, so many small groups
+* sort efficiently. If the columns are in (unregistered) host memory, the
+* offsets must be host arrays too and the segments are sorted on the host by
+* a pool of threads. valcol->data may be NULL to sort the keys only.
 */
 gdf_error gdf_segmented_radixsort_i8(gdf_segmented_radixsort_plan_type *hdl,
                                      gdf_column *keycol, gdf_column *valcol,
@@ -204,6 +273,12 @@ gdf_error gdf_segmented_radixsort_generic(gdf_segmented_radixsort_plan_type *hdl
 /**
  * @brief Transposes the table in_cols and copies to out_cols
  * 
+ * The output columns must all have the same dtype. Input columns either have
+ * that dtype or a narrower numeric one that converts to it without loss
+ * (e.g., GDF_INT8 or GDF_INT16 into GDF_INT32, GDF_INT32 into GDF_FLOAT64).
+ * If the tables are in (unregistered) host memory, they are transposed on
+ * the host.
+ *
  * @param[in] ncols Number of columns in in_cols
  * @param[in] in_cols[] Input table of (ncols) number of columns each of size (nrows)
  * @param[out] out_cols[] Preallocated output_table of (nrows) columns each of size (ncols)
@@ -345,6 +420,50 @@ gdf_error gdf_full_join(
                          gdf_column * right_indices,
                          gdf_context *join_context);
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief  Performs an as-of join: matches every left row with the right row
+ * of the same group whose key is nearest to its own in the given direction,
+ * e.g., every trade with the last quote of its symbol at or before it.
+ *
+ * The groups of every left row are found by a binary search of the right
+ * table, then the key by a binary search within the group, so the left table
+ * may be in any order. Left rows with a null key, or without a match within
+ * the tolerance, get -1. Nulls in the `by` columns form a group of their own.
+ * 
+ * @param[in] left_by[] The columns of the left dataframe the groups are defined by
+ * @param[in] left_on The key column of the left dataframe
+ * @param[in] right_by[] The columns of the right dataframe the groups are defined by
+ * @param[in] right_on The key column of the right dataframe, of the same type
+ * as `left_on` and without nulls. Timestamps of different units are compared
+ * in the finer unit
+ * @param[in] num_by The number of `by` columns, 0 to match over the whole table
+ * @param[in] direction Whether to match backward, forward or to the nearest key
+ * @param[in] tolerance The largest distance between matched keys, in the unit
+ * of the keys (the finer unit for timestamps), or a negative value for none
+ * @param[in] allow_exact_matches Whether a right key equal to the left key
+ * matches
+ * @param[out] right_indices Pre-allocated gdf_column of gdf_index_type with
+ * one entry per left row, the index of its right row or -1
+ * @param[in] join_context If join_context->flag_sorted is set, the right table
+ * must be sorted by the `by` columns and then the key as gdf_order_by sorts
+ * them with nulls smallest. Otherwise a sorted copy of it is made
+ * 
+ * @returns   GDF_SUCCESS if the join operation was successful, otherwise an appropriate
+ * error code
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_asof_join(gdf_column**       left_by,
+                        gdf_column*        left_on,
+                        gdf_column**       right_by,
+                        gdf_column*        right_on,
+                        int                num_by,
+                        gdf_asof_direction direction,
+                        double             tolerance,
+                        int                allow_exact_matches,
+                        gdf_column*        right_indices,
+                        gdf_context*       join_context);
+
 /* partioning */
 
 /* --------------------------------------------------------------------------*/
@@ -375,26 +494,200 @@ gdf_error gdf_hash_partition(int num_input_cols,
                              int num_cols_to_hash,
                              int num_partitions, 
                              gdf_column * partitioned_output[],
-                             int partition_offsets[],
+                             gdf_size_type partition_offsets[],
                              gdf_hash_func hash);
 
-/* prefixsum */
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Rearranges the input columns into the desired number of partitions
+ * of contiguous rows such that every row of a partition goes before every row
+ * of the next partition in the order gdf_order_by sorts them. The rows within
+ * a partition are not sorted.
+ * 
+ * The partition boundaries are chosen by sorting a sample of the rows, so the
+ * partitions are of similar sizes unless many rows are equal. Equal rows are
+ * always in the same partition.
+ * 
+ * @param[in] num_input_cols The number of columns in the input columns
+ * @param[in] input[] The input set of columns, of fixed width types
+ * @param[in] asc_desc Device array of sort order types for each column
+ *                     (0 is ascending order and 1 is descending). If NULL
+ *                     is provided defaults to ascending order for evey column.
+ * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
+ *                                    smaller than non-nulls or viceversa
+ * @param[in] num_partitions The number of partitions to rearrange the input rows into
+ * @param[out] partitioned_output Preallocated gdf_columns to hold the rearrangement 
+ * of the input columns into the desired number of partitions
+ * @param[out] partition_offsets Preallocated array the size of the number of
+ * partitions. Where partition_offsets[i] indicates the starting position
+ * of partition 'i'
+ * 
+ * @returns  If the operation was successful, returns GDF_SUCCESS
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_range_partition(int num_input_cols,
+                              gdf_column * input[],
+                              int8_t * asc_desc,
+                              int flag_nulls_are_smallest,
+                              int num_partitions,
+                              gdf_column * partitioned_output[],
+                              gdf_size_type partition_offsets[]);
 
 /* --------------------------------------------------------------------------*/
 /** 
- * @brief  Computes the prefix sum of a column
+ * @brief Creates a partitioner that hash partitions a stream of batches of
+ * rows. The partitions are kept in device memory, and the largest ones are
+ * spilled to files whenever they exceed the memory budget, so inputs larger
+ * than device memory can be partitioned.
  * 
- * @param inp Input column for prefix sum with null_count = 0
+ * @param[in] num_cols The number of columns of every batch
+ * @param[in] dtypes The types of the columns, which must be fixed width
+ * @param[in] columns_to_hash[] Indices of the columns to hash
+ * @param[in] num_cols_to_hash The number of columns to hash
+ * @param[in] num_partitions The number of partitions
+ * @param[in] hash The hash function to use
+ * @param[in] memory_budget The device memory in bytes the partitions may hold,
+ * or 0 to never spill
+ * @param[in] spill_directory The directory of the spill files, or NULL for /tmp
+ * 
+ * @returns  The partitioner, or NULL if the arguments are invalid
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_partitioner_type* gdf_hash_partitioner(int num_cols,
+                                           gdf_dtype * dtypes,
+                                           int columns_to_hash[],
+                                           int num_cols_to_hash,
+                                           int num_partitions,
+                                           gdf_hash_func hash,
+                                           size_t memory_budget,
+                                           const char * spill_directory);
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Frees a partitioner and its spill files
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_hash_partitioner_free(gdf_partitioner_type *hdl);
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Partitions a batch of rows and appends them to the partitions
+ * 
+ * @param[in] hdl The partitioner
+ * @param[in] input[] The columns of the batch, with the partitioner's types
+ * 
+ * @returns  If the operation was successful, returns GDF_SUCCESS
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_hash_partitioner_add(gdf_partitioner_type *hdl,
+                                   gdf_column * input[]);
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Gets the number of rows in a partition, spilled or not
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_hash_partitioner_size(gdf_partitioner_type *hdl,
+                                    int partition,
+                                    gdf_size_type *size);
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Gets the number of bytes written to the spill files so far
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_hash_partitioner_spilled_bytes(gdf_partitioner_type *hdl,
+                                             size_t *bytes);
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Moves the rows of a partition to preallocated columns and empties
+ * the partition. Rows of earlier batches come before rows of later ones.
+ * 
+ * @param[in] hdl The partitioner
+ * @param[in] partition The partition to take
+ * @param[out] output[] Preallocated columns the size of the partition. Their
+ * null counts are set, and their validity is only written if allocated.
+ * 
+ * @returns  If the operation was successful, returns GDF_SUCCESS
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_hash_partitioner_take(gdf_partitioner_type *hdl,
+                                    int partition,
+                                    gdf_column * output[]);
+
+/* prefixsum */
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Computes the prefix sum of a column
+ *
+ * Equivalent to calling gdf_scan with GDF_SCAN_SUM.
+ *
+ * @param inp Input column for prefix sum
  * @param out The output column containing the prefix sum of the input
  * @param inclusive Flag for applying an inclusive prefix sum
- * 
+ *
  * @returns   GDF_SUCCESS if the operation was successful, otherwise an appropriate
- * error code. If inp->null_count is not set to 0 GDF_VALIDITY_UNSUPPORTED is
- * returned.
+ * error code.
  */
 /* ----------------------------------------------------------------------------*/
 gdf_error gdf_prefixsum_generic(gdf_column *inp, gdf_column *out, int inclusive);
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Computes the prefix scan of a column with the specified operation
+ *
+ * Null elements of `inp` do not contribute to the running value, i.e., they
+ * are treated as the identity of `op`, and the corresponding elements of `out`
+ * are set to null. `out->valid` must be allocated if `inp` contains nulls.
+ *
+ * @param inp Input column of any numeric type
+ * @param out Pre-allocated output column of the same size and type as `inp`
+ * @param op The binary operation of the scan (sum, min, max or product)
+ * @param inclusive Flag for applying an inclusive (non-zero) or exclusive (0)
+ * scan
+ *
+ * @returns   GDF_SUCCESS if the operation was successful, otherwise an appropriate
+ * error code.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_scan(gdf_column *inp, gdf_column *out, gdf_scan_op op, int inclusive);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Computes the segmented prefix scan of several columns in one call
+ *
+ * The rows of every input column are partitioned into contiguous segments
+ * described by `segment_offsets`, e.g., the group offsets produced by a
+ * sort-based groupby. The scan restarts at the beginning of every segment.
+ * The row-to-segment mapping is computed once and shared by all the columns.
+ * Nulls are handled as in gdf_scan.
+ *
+ * @param num_cols The number of columns to scan
+ * @param inp Array of input columns, all of the same size
+ * @param out Array of pre-allocated output columns of the same size and type
+ * as the corresponding input column
+ * @param segment_offsets Column of gdf_index_type (GDF_INT32, or GDF_INT64 when
+ * built with GDF_LARGE_COLUMNS) with the index of the first row of each
+ * segment, starting at 0. The offsets must be sorted in ascending order and
+ * lie within [0, size], GDF_INVALID_API_CALL is returned otherwise. If NULL,
+ * each column is scanned as a single segment.
+ * @param op The binary operation of the scan (sum, min, max or product)
+ * @param inclusive Flag for applying an inclusive (non-zero) or exclusive (0)
+ * scan
+ *
+ * @returns   GDF_SUCCESS if the operation was successful, otherwise an appropriate
+ * error code.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_segmented_scan(int num_cols,
+                             gdf_column *inp[],
+                             gdf_column *out[],
+                             gdf_column *segment_offsets,
+                             gdf_scan_op op,
+                             int inclusive);
+
 /* --------------------------------------------------------------------------*/
 /** 
  * @brief  Computes the prefix sum of a column
@@ -832,10 +1125,19 @@ gdf_error gdf_comparison_static_f64(gdf_column *lhs, double value, gdf_column *o
 //allows you two compare two columns against each other using a comparison operation, retunrs a stencil like functions above
 gdf_error gdf_comparison(gdf_column *lhs, gdf_column *rhs, gdf_column *output,gdf_comparison_operator operation);
 
-//takes a stencil and uses it to compact a colum e.g. remove all values for which the stencil = 0
-//The lhs column is expected to have 0 null_count otherwise GDF_VALIDITY_UNSUPPORTED is returned
+//takes a GDF_INT8 stencil and uses it to compact a colum e.g. remove all values for which the stencil = 0 or is null
+//output is allocated with the size of lhs, its size is set to the number of remaining values
+//If lhs has nulls output needs a validity bitmask otherwise GDF_VALIDITY_MISSING is returned
 gdf_error gdf_apply_stencil(gdf_column *lhs, gdf_column * stencil, gdf_column * output);
 
+//takes a GDF_INT8 stencil and uses it to compact all the columns of a table at once e.g. remove all rows for which the stencil = 0 or is null
+//the data of the output columns is allocated with exactly the remaining rows, with a validity bitmask where the input column has one
+//each output gets a copy of the name of its input, allocated with malloc and freed by the caller
+gdf_error gdf_apply_stencil_table(gdf_column *input[], int num_cols, gdf_column *stencil, gdf_column *output[]);
+
+//same as gdf_apply_stencil_table with a bitmask of one bit per row as the stencil, the rows whose bit is set are kept
+gdf_error gdf_apply_bitmask_table(gdf_column *input[], int num_cols, gdf_valid_type *stencil, gdf_column *output[]);
+
 gdf_error gdf_concat(gdf_column *lhs, gdf_column *rhs, gdf_column *output);
 
 /*
@@ -867,6 +1169,47 @@ gdf_error gdf_filter(size_t nrows,     //in: # rows
 		     size_t* d_indx,   //out: device-side array of row indices that remain after filtering
 		     size_t* new_sz);  //out: host-side # rows that remain after filtering
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Evaluates an AND/OR tree of comparisons, IN-lists, BETWEEN and
+ * IS [NOT] NULL terms over the rows of a table into a bitmask.
+ *
+ * @param[in] cols The columns the predicate refers to by index, all of the same size
+ * @param[in] ncols The number of columns
+ * @param[in] predicates Host array of the nodes of the predicate, whose last node is the root
+ * @param[in] num_predicates The number of nodes
+ * @param[out] output Preallocated device bitmask of gdf_get_num_chars_bitmask(size)
+ * bytes, with the bits of the rows that satisfy the predicate set
+ * @param[out] num_true The number of rows that satisfy the predicate
+ *
+ * @returns GDF_SUCCESS upon successful completion, GDF_INVALID_API_CALL if a
+ * node is not well formed, is the operand of more than one node, or if more
+ * than 64 AND/OR nodes are nested as right operands. Left operands may be
+ * nested to any depth.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_evaluate_predicate(gdf_column *cols[], int ncols,
+                                 gdf_predicate const *predicates, int num_predicates,
+                                 gdf_valid_type *output, gdf_size_type *num_true);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Keeps the rows of a table that satisfy a predicate, see
+ * gdf_evaluate_predicate and gdf_apply_bitmask_table.
+ *
+ * @param[in] cols The columns to filter, which the predicate refers to by index
+ * @param[in] ncols The number of columns
+ * @param[in] predicates Host array of the nodes of the predicate, whose last node is the root
+ * @param[in] num_predicates The number of nodes
+ * @param[out] output The filtered columns, allocated by the function
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_filter_predicate(gdf_column *cols[], int ncols,
+                               gdf_predicate const *predicates, int num_predicates,
+                               gdf_column *output[]);
+
 gdf_error gdf_group_by_sum(int ncols,                    // # columns
                            gdf_column** cols,            //input cols with 0 null_count otherwise GDF_VALIDITY_UNSUPPORTED is returned
                            gdf_column* col_agg,          //column to aggregate on with 0 null_count otherwise GDF_VALIDITY_UNSUPPORTED is returned
@@ -927,6 +1270,105 @@ gdf_error gdf_quantile_aprrox(	gdf_column*  col_in,       //input column with 0
                                 void*        t_erased_res, //type-erased result of same type as column;
                                 gdf_context* ctxt);        //context info
 
+/* --------------------------------------------------------------------------*
+ * @brief Computes several quantiles of a column with a single sort.
+ *
+ * Each quantile gives the same result as gdf_quantile_exact with the same
+ * q and method; gdf_quantile_aprrox corresponds to GDF_QUANT_LOWER.
+ *
+ * @param[in] col_in Input column with 0 null_count otherwise
+ *                   GDF_VALIDITY_UNSUPPORTED is returned
+ * @param[in] q Host array of the requested quantiles in [0,1]
+ * @param[in] methods Host array of the method used for each quantile
+ * @param[in] num_quantiles # quantiles
+ * @param[out] results Host array receiving the num_quantiles results
+ * @param[in] ctxt Context info: flag_sorted if col_in is already sorted,
+ *                 flag_sort_inplace to allow sorting col_in in place
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_quantiles(gdf_column*                col_in,
+                        const double*              q,
+                        const gdf_quantile_method* methods,
+                        int                        num_quantiles,
+                        double*                    results,
+                        gdf_context*               ctxt);
+
+/* --------------------------------------------------------------------------*
+ * @brief Computes several quantiles of every group of a column, e.g., of the
+ * groups of a sort-based groupby.
+ *
+ * The values are sorted within their groups once for all the quantiles.
+ * Empty groups yield NaN.
+ *
+ * @param[in] col_in Input column with 0 null_count otherwise
+ *                   GDF_VALIDITY_UNSUPPORTED is returned
+ * @param[in] segment_offsets gdf_index_type column with the ascending index
+ *                            of the first row of each group, starting at 0
+ * @param[in] q Host array of the requested quantiles in [0,1]
+ * @param[in] methods Host array of the method used for each quantile
+ * @param[in] num_quantiles # quantiles
+ * @param[out] out Array of num_quantiles pre-allocated GDF_FLOAT64 columns of
+ *                 one row per group, receiving the quantiles of each group
+ * @param[in] ctxt Context info: flag_sorted if col_in is already sorted
+ *                 within each group, flag_sort_inplace to allow sorting
+ *                 col_in in place
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_group_quantiles(gdf_column*                col_in,
+                              gdf_column*                segment_offsets,
+                              const double*              q,
+                              const gdf_quantile_method* methods,
+                              int                        num_quantiles,
+                              gdf_column*                out[],
+                              gdf_context*               ctxt);
+
+/* --------------------------------------------------------------------------*
+ * @brief Approximate quantile sketches (merging t-digest).
+ *
+ * A sketch summarizes the values it is given in O(compression) centroids,
+ * small near the extremes, so memory stays bounded however much data is
+ * added. Sketches built per batch, or per partition (e.g., on slices of the
+ * output of gdf_hash_partition), can be merged in any order and serialized,
+ * so quantiles over a stream can be computed without keeping the raw data.
+ *
+ * gdf_quantile_sketch creates an empty sketch; a compression <= 0 selects the
+ * default of 100. Larger values are more accurate and use more memory.
+ * ----------------------------------------------------------------------------*/
+gdf_quantile_sketch_type* gdf_quantile_sketch(int compression);
+gdf_error gdf_quantile_sketch_free(gdf_quantile_sketch_type *hdl);
+
+/* Adds the valid, non-NaN values of a numeric column to the sketch */
+gdf_error gdf_quantile_sketch_add(gdf_quantile_sketch_type *hdl, gdf_column *col);
+
+/* Adds everything summarized by `other` to `hdl`, leaving `other` unchanged */
+gdf_error gdf_quantile_sketch_merge(gdf_quantile_sketch_type *hdl,
+                                    gdf_quantile_sketch_type *other);
+
+/*
+ * Estimates the quantiles q[i] in [0,1] into the host array results. An empty
+ * sketch yields NaN.
+ */
+gdf_error gdf_quantile_sketch_query(gdf_quantile_sketch_type *hdl,
+                                    const double *q,
+                                    int num_quantiles,
+                                    double *results);
+
+/*
+ * Serializes the sketch into a host buffer of at least
+ * gdf_quantile_sketch_serialized_size bytes. gdf_quantile_sketch_deserialize
+ * returns a new sketch to be freed with gdf_quantile_sketch_free, or NULL if
+ * the buffer does not hold a valid sketch.
+ */
+size_t gdf_quantile_sketch_serialized_size(gdf_quantile_sketch_type *hdl);
+gdf_error gdf_quantile_sketch_serialize(gdf_quantile_sketch_type *hdl,
+                                        void *buffer, size_t buffer_size);
+gdf_quantile_sketch_type* gdf_quantile_sketch_deserialize(const void *buffer,
+                                                          size_t buffer_size);
+
 /* --------------------------------------------------------------------------*
  * @brief Replace elements from `col` according to the mapping `old_values` to
  *        `new_values`, that is, replace all `old_values[i]` present in `col` 
@@ -943,6 +1385,35 @@ gdf_error gdf_find_and_replace_all(gdf_column*       col,
                                    const gdf_column* old_values,
                                    const gdf_column* new_values);
 
+/* --------------------------------------------------------------------------*
+ * @brief Replaces the values of `col` found in `old_values` with the
+ *        corresponding `new_values`, like gdf_find_and_replace_all, and
+ *        handles the values that are not found according to `policy`.
+ *
+ * If a value occurs several times in `old_values`, its first occurrence is
+ * used. Null rows of `col` stay null unless `old_values` has a null, in
+ * which case they are replaced with the new value of the first null. A null
+ * new value makes the replaced row null. Small maps are searched linearly;
+ * larger ones are looked up in a hash table, so the cost does not grow with
+ * the number of old values.
+ *
+ * @param[in,out] col gdf_column with the data to be modified. Needs a
+ * validity mask if rows can become null.
+ * @param[in] old_values gdf_column with the old values to be replaced
+ * @param[in] new_values gdf_column with the new values
+ * @param[in] policy What to do with the valid values not in `old_values`
+ * @param[in] default_value gdf_column of size 1 with the replacement for
+ * unmatched values if `policy` is GDF_UNMATCHED_DEFAULT, otherwise ignored
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ *
+ * --------------------------------------------------------------------------*/
+gdf_error gdf_find_and_replace(gdf_column*          col,
+                               const gdf_column*    old_values,
+                               const gdf_column*    new_values,
+                               gdf_unmatched_policy policy,
+                               const gdf_column*    default_value);
+
 /* --------------------------------------------------------------------------* 
  * @brief Sorts an array of gdf_column.
  * 
@@ -953,8 +1424,9 @@ gdf_error gdf_find_and_replace_all(gdf_column*       col,
  * @param[in] num_inputs # columns
  * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
  *                                    smaller than non-nulls or viceversa
- * @param[out] output_indices Pre-allocated gdf_column to be filled with sorted
- *                            indices
+ * @param[out] output_indices Pre-allocated gdf_column of gdf_index_type
+ *                            (GDF_INT32, or GDF_INT64 when built with
+ *                            GDF_LARGE_COLUMNS) to be filled with sorted indices
  * 
  * @returns GDF_SUCCESS upon successful completion
  *
@@ -965,6 +1437,66 @@ gdf_error gdf_order_by(gdf_column** input_columns,
                        gdf_column*  output_indices,
                        int          flag_nulls_are_smallest);
 
+/* --------------------------------------------------------------------------*
+ * @brief Finds the indices of the first k rows of an array of gdf_column in
+ * the order gdf_order_by would sort them, without a full sort.
+ *
+ * Rows are selected into per-thread heaps of size k which are then merged,
+ * so the cost is O(n log k). Rows that compare equal keep their input order,
+ * so the result is the first k entries of a stable gdf_order_by.
+ *
+ * @param[in] input_columns Array of gdf_columns
+ * @param[in] asc_desc Device array of sort order types for each column
+ *                     (0 is ascending order and 1 is descending). If NULL
+ *                     is provided defaults to ascending order for evey column.
+ * @param[in] num_inputs # columns
+ * @param[in] k # rows to select
+ * @param[out] output_indices Pre-allocated gdf_column of gdf_index_type and
+ *                            size k. If there are fewer than k rows, the
+ *                            remaining entries are set to -1
+ * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
+ *                                    smaller than non-nulls or viceversa
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_top_k(gdf_column** input_columns,
+                    int8_t*      asc_desc,
+                    size_t       num_inputs,
+                    gdf_size_type k,
+                    gdf_column*  output_indices,
+                    int          flag_nulls_are_smallest);
+
+/* --------------------------------------------------------------------------*
+ * @brief Finds the indices of the first k rows of each segment of an array
+ * of gdf_column, e.g., of each group of a sort-based groupby.
+ *
+ * Same as gdf_top_k applied to every segment independently.
+ *
+ * @param[in] input_columns Array of gdf_columns
+ * @param[in] asc_desc Device array of sort order types for each column, or NULL
+ * @param[in] num_inputs # columns
+ * @param[in] segment_offsets gdf_index_type column with the ascending index of
+ *                            the first row of each segment, starting at 0
+ * @param[in] k # rows to select per segment
+ * @param[out] output_indices Pre-allocated gdf_column of gdf_index_type and
+ *                            size k * segment_offsets->size. The rows of
+ *                            segment i are written to [i * k, (i + 1) * k),
+ *                            padded with -1 if the segment has fewer than k rows
+ * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
+ *                                    smaller than non-nulls or viceversa
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_segmented_top_k(gdf_column** input_columns,
+                              int8_t*      asc_desc,
+                              size_t       num_inputs,
+                              gdf_column*  segment_offsets,
+                              gdf_size_type k,
+                              gdf_column*  output_indices,
+                              int          flag_nulls_are_smallest);
+
 /* --------------------------------------------------------------------------*
  * @brief Replaces all null values in a column with either a specific value or corresponding values of another column
  *
@@ -1016,3 +1548,120 @@ gdf_error gdf_digitize(gdf_column* col,
                        gdf_column* bins,   // same type as col
                        bool right,
                        gdf_index_type out_indices[]);
+
+/* --------------------------------------------------------------------------*
+ * @brief Computes the histograms of one or more columns in one call, reading
+ * each column once.
+ *
+ * Bucket `i` of the histogram of `cols[c]` holds the values whose
+ * gdf_digitize index for `bins[c]` is `i`. The histogram therefore has
+ * `bins[c]->size + 1` buckets, the first counting the values below the first
+ * edge and the last those above the last edge. Null and NaN values are not
+ * counted.
+ *
+ * @param[in] cols Columns with the values to be binned
+ * @param[in] bins Per column, a gdf_column of ascending bin edges without
+ * nulls, of the same type as the column
+ * @param[in] ncols Number of columns
+ * @param[in] right Whether the intervals include their right edge, as in
+ * gdf_digitize
+ * @param[out] counts Per column, a device array of `bins[c]->size + 1`
+ * counts
+ * @param[out] sums Per column, NULL or a device array of `bins[c]->size + 1`
+ * sums of the values in each bucket. May be NULL to skip all the sums.
+ *
+ * @return GDF_SUCCESS upon successful completion, otherwise an
+ *         appropriate error code.
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_histogram(gdf_column* cols[],
+                        gdf_column* bins[],
+                        int ncols,
+                        bool right,
+                        gdf_size_type* counts[],
+                        double* sums[]);
+
+/* --------------------------------------------------------------------------*
+ * @brief Computes histograms of `num_bins` equal width bins over
+ * `[lo[c], hi[c]]` for one or more columns in one call.
+ *
+ * The buckets are those of gdf_histogram for the `num_bins + 1` edges
+ * `lo[c] + k * (hi[c] - lo[c]) / num_bins`, i.e., `num_bins + 2` buckets
+ * with the values below `lo[c]` first and those above `hi[c]` last. The bin
+ * of a value is computed rather than searched for. Values are compared as
+ * doubles.
+ *
+ * @param[in] cols Columns with the values to be binned
+ * @param[in] ncols Number of columns
+ * @param[in] lo Per column, the first edge
+ * @param[in] hi Per column, the last edge, greater than `lo[c]`
+ * @param[in] num_bins Number of bins between `lo[c]` and `hi[c]`
+ * @param[in] right Whether the intervals include their right edge
+ * @param[out] counts Per column, a device array of `num_bins + 2` counts
+ * @param[out] sums Per column, NULL or a device array of `num_bins + 2` sums.
+ * May be NULL to skip all the sums.
+ *
+ * @return GDF_SUCCESS upon successful completion, otherwise an
+ *         appropriate error code.
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_histogram_uniform(gdf_column* cols[],
+                                int ncols,
+                                const double lo[],
+                                const double hi[],
+                                int num_bins,
+                                bool right,
+                                gdf_size_type* counts[],
+                                double* sums[]);
+
+/* --------------------------------------------------------------------------*
+ * @brief Finds, for every row of a table of needles, the position at which it
+ * would be inserted into a sorted table to keep it sorted (searchsorted).
+ *
+ * The rows are compared lexicographically like gdf_order_by compares them,
+ * so `sorted_cols` must be sorted as gdf_order_by sorts them with the same
+ * `asc_desc` and `flag_nulls_are_smallest`. Null needles are placed like null
+ * rows.
+ *
+ * @param[in] sorted_cols Array of the sorted gdf_columns
+ * @param[in] needle_cols Array of gdf_columns with the rows to search for,
+ *                        of the same types as `sorted_cols`
+ * @param[in] ncols # columns
+ * @param[in] asc_desc Device array of sort order types for each column, or
+ *                     NULL for ascending order on every column
+ * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
+ *                                    smaller than non-nulls or viceversa
+ * @param[in] side GDF_SEARCH_LEFT for the first position of an equal row,
+ *                 GDF_SEARCH_RIGHT for the position after the last one
+ * @param[out] output Pre-allocated gdf_column of gdf_index_type with one entry
+ *                    per needle
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ *
+ * ----------------------------------------------------------------------------*/
+gdf_error gdf_search_sorted(gdf_column**    sorted_cols,
+                            gdf_column**    needle_cols,
+                            size_t          ncols,
+                            int8_t*         asc_desc,
+                            int             flag_nulls_are_smallest,
+                            gdf_search_side side,
+                            gdf_column*     output);
+
+/* --------------------------------------------------------------------------*
+ * @brief A copy of a sorted table prepared for repeated gdf_search_sorted
+ * lookups.
+ *
+ * The rows are stored in Eytzinger (breadth first) order, so the first steps
+ * of every search hit the same few cache lines. gdf_search_index returns NULL
+ * if the columns are invalid; the index does not refer to them afterwards.
+ * gdf_search_index_lookup gives the same results as gdf_search_sorted.
+ * ----------------------------------------------------------------------------*/
+gdf_search_index_type* gdf_search_index(gdf_column** sorted_cols,
+                                        size_t       ncols,
+                                        int8_t*      asc_desc,
+                                        int          flag_nulls_are_smallest);
+gdf_error gdf_search_index_free(gdf_search_index_type *hdl);
+gdf_error gdf_search_index_lookup(gdf_search_index_type *hdl,
+                                  gdf_column**    needle_cols,
+                                  gdf_search_side side,
+                                  gdf_column*     output);
@@ -20,4 +20,16 @@
 
 gdf_error read_csv(csv_read_arg *args);
 
+gdf_error read_ipc(ipc_read_arg *args);
+
+gdf_error gdf_to_arrow_ipc(gdf_column **columns, int num_cols, gdf_ipc_sink *sink);
+
+gdf_error read_parquet(pq_read_arg *args);
+
+gdf_error read_orc(orc_read_arg *args);
+
+gdf_error read_json(json_read_arg *args);
+
+gdf_error write_csv(gdf_column **columns, int num_cols, csv_write_arg *args);
+
 gdf_error gdf_to_csr(gdf_column **gdfData, int num_cols, csr_gdf *csrReturn);
@@ -18,6 +18,12 @@
  * API
  *
  * gdf_error read_csv(csv_read_arg *args);
+ * gdf_error read_ipc(ipc_read_arg *args);
+ * gdf_error gdf_to_arrow_ipc(gdf_column **columns, int num_cols, gdf_ipc_sink *sink);
+ * gdf_error read_parquet(pq_read_arg *args);
+ * gdf_error read_orc(orc_read_arg *args);
+ * gdf_error read_json(json_read_arg *args);
+ * gdf_error write_csv(gdf_column **columns, int num_cols, csv_write_arg *args);
  *
  */
 #pragma once
@@ -45,7 +51,7 @@ typedef struct {
    * Output Arguments - allocated in reader.
    */
   int           num_cols_out;               ///< Out: return the number of columns read in
-  int           num_rows_out;               ///< Out: return the number of rows read in
+  gdf_size_type num_rows_out;               ///< Out: return the number of rows read in
   gdf_column    **data;                     ///< Out: return the array of *gdf_columns
 
   /*
@@ -132,3 +138,222 @@ typedef struct {
  * dialect          - not used
  *
  */
+
+
+/**---------------------------------------------------------------------------*
+ * @brief  This struct contains all input parameters to the read_ipc function.
+ * Also contains the output dataframe.
+ *
+ * The input is an Arrow IPC stream or file that is already in device memory.
+ * Columns returned as views point into that buffer and are only valid as long
+ * as it is.
+ *
+ *---------------------------------------------------------------------------**/
+typedef struct {
+
+  /*
+   * Output Arguments - allocated in reader.
+   */
+  int           num_cols_out;               ///< Out: return the number of columns read in
+  gdf_size_type num_rows_out;               ///< Out: return the number of rows read in
+  gdf_column    **data;                     ///< Out: return the array of *gdf_columns
+  gdf_column    **dictionaries;             ///< Out: return the dictionary of each GDF_CATEGORY column, NULL for the other columns
+  bool          *is_view;                   ///< Out: return for each column whether its buffers point into the input instead of being allocated
+
+  /*
+   * Input arguments
+   */
+  const void    *buffer;                    ///< Device memory holding the whole IPC stream or file
+  size_t        buffer_size;                ///< The size of the buffer in bytes
+  bool          zero_copy;                  ///< Return views into the buffer for the columns of a single record batch whose buffers are aligned
+
+} ipc_read_arg;
+
+
+/*
+ * Enumerator for the destinations of an Arrow IPC stream
+ */
+typedef enum
+{
+  IPC_DEVICE_BUFFER,                        ///< Indicates that the stream is written to a buffer in device memory
+  IPC_FILE_DESCRIPTOR                       ///< Indicates that the stream is written to an open file descriptor
+} gdf_ipc_sink_form;
+
+/**---------------------------------------------------------------------------*
+ * @brief  This struct describes where gdf_to_arrow_ipc writes the stream, and
+ * returns its size.
+ *
+ *---------------------------------------------------------------------------**/
+typedef struct {
+
+  /*
+   * Output Arguments
+   */
+  size_t        bytes_written;              ///< Out: return the size of the stream in bytes
+
+  /*
+   * Input arguments
+   */
+  gdf_ipc_sink_form sink_form;              ///< Type of destination of the stream
+  void          *buffer;                    ///< If sink_form is IPC_DEVICE_BUFFER, the device buffer to write to. If NULL, only bytes_written is computed
+  size_t        buffer_size;                ///< If sink_form is IPC_DEVICE_BUFFER, the size of the buffer in bytes
+  int           fd;                         ///< If sink_form is IPC_FILE_DESCRIPTOR, the file descriptor to write to
+
+} gdf_ipc_sink;
+
+
+/*
+ * Enumerator for the comparisons that readers prune parts of a file with,
+ * using the min/max statistics of the filter column
+ */
+typedef enum
+{
+  STATS_FILTER_NONE,                        ///< Indicates that the whole file is read
+  STATS_FILTER_EQUAL,                       ///< Reads the parts that may hold values equal to filter_value
+  STATS_FILTER_LESS,                        ///< Reads the parts that may hold values less than filter_value
+  STATS_FILTER_LESS_EQUAL,                  ///< Reads the parts that may hold values less than or equal to filter_value
+  STATS_FILTER_GREATER,                     ///< Reads the parts that may hold values greater than filter_value
+  STATS_FILTER_GREATER_EQUAL                ///< Reads the parts that may hold values greater than or equal to filter_value
+} gdf_stats_filter_op;
+
+/**---------------------------------------------------------------------------*
+ * @brief  This struct contains all input parameters to the read_parquet
+ * function. Also contains the output dataframe.
+ *
+ * Input parameters are all stored in host memory. The output dataframe is in
+ * the device memory.
+ *
+ * The filter prunes whole row groups using the min/max statistics of the
+ * filter column, the rows of the row groups that are read are not filtered.
+ *
+ *---------------------------------------------------------------------------**/
+typedef struct {
+
+  /*
+   * Output Arguments - allocated in reader.
+   */
+  int           num_cols_out;               ///< Out: return the number of columns read in
+  gdf_size_type num_rows_out;               ///< Out: return the number of rows read in
+  gdf_column    **data;                     ///< Out: return the array of *gdf_columns
+  int           num_row_groups_skipped;     ///< Out: return the number of row groups pruned by the filter
+
+  /*
+   * Input arguments - all data is in the host memory
+   */
+  gdf_csv_input_form input_data_form;       ///< Type of source of Parquet data
+  const char    *filepath_or_buffer;        ///< If input_data_form is FILE_PATH, contains the filepath. If input_data_type is HOST_BUFFER, points to the host memory buffer
+  size_t        buffer_size;                ///< If input_data_form is HOST_BUFFER, represents the size of the buffer in bytes. Unused otherwise
+
+  int           num_cols;                   ///< Number of columns in use_cols
+  const char    **use_cols;                 ///< Names of the columns to read, NULL reads all columns
+
+  const char    *filter_column;             ///< Name of the column whose statistics prune row groups, NULL reads all row groups
+  gdf_stats_filter_op filter_op;            ///< How the values of filter_column compare to filter_value
+  double        filter_value;               ///< The value compared to the statistics of filter_column
+
+} pq_read_arg;
+
+/**---------------------------------------------------------------------------*
+ * @brief  This struct contains all input parameters to the read_orc
+ * function. Also contains the output dataframe.
+ *
+ * Input parameters are all stored in host memory. The output dataframe is in
+ * the device memory.
+ *
+ * The filter prunes whole stripes using the min/max statistics of the filter
+ * column, the rows of the stripes that are read are not filtered.
+ *
+ *---------------------------------------------------------------------------**/
+typedef struct {
+
+  /*
+   * Output Arguments - allocated in reader.
+   */
+  int           num_cols_out;               ///< Out: return the number of columns read in
+  gdf_size_type num_rows_out;               ///< Out: return the number of rows read in
+  gdf_column    **data;                     ///< Out: return the array of *gdf_columns
+  int           num_stripes_skipped;        ///< Out: return the number of stripes pruned by the filter
+
+  /*
+   * Input arguments - all data is in the host memory
+   */
+  gdf_csv_input_form input_data_form;       ///< Type of source of ORC data
+  const char    *filepath_or_buffer;        ///< If input_data_form is FILE_PATH, contains the filepath. If input_data_type is HOST_BUFFER, points to the host memory buffer
+  size_t        buffer_size;                ///< If input_data_form is HOST_BUFFER, represents the size of the buffer in bytes. Unused otherwise
+
+  int           num_cols;                   ///< Number of columns in use_cols
+  const char    **use_cols;                 ///< Names of the columns to read, NULL reads all columns
+
+  const char    *filter_column;             ///< Name of the column whose statistics prune stripes, NULL reads all stripes
+  gdf_stats_filter_op filter_op;            ///< How the values of filter_column compare to filter_value
+  double        filter_value;               ///< The value compared to the statistics of filter_column
+
+} orc_read_arg;
+
+/**---------------------------------------------------------------------------*
+ * @brief  This struct contains all input parameters to the read_json
+ * function. Also contains the output dataframe.
+ *
+ * Input parameters are all stored in host memory. The output dataframe is in
+ * the device memory.
+ *
+ * Only JSON Lines, one object per line, are supported. The columns are the
+ * keys of the first record.
+ *
+ *---------------------------------------------------------------------------**/
+typedef struct {
+
+  /*
+   * Output Arguments - allocated in reader.
+   */
+  int           num_cols_out;               ///< Out: return the number of columns read in
+  gdf_size_type num_rows_out;               ///< Out: return the number of rows read in
+  gdf_column    **data;                     ///< Out: return the array of *gdf_columns
+
+  /*
+   * Input arguments - all data is in the host memory
+   */
+  gdf_csv_input_form input_data_form;       ///< Type of source of JSON data
+  const char    *filepath_or_buffer;        ///< If input_data_form is FILE_PATH, contains the filepath. If input_data_type is HOST_BUFFER, points to the host memory buffer
+  size_t        buffer_size;                ///< If input_data_form is HOST_BUFFER, represents the size of the buffer in bytes. Unused otherwise
+
+  bool          lines;                      ///< Read the data as JSON Lines, one object per line. Must be true
+
+  int           num_cols;                   ///< Number of entries in the dtype array
+  const char    **dtype;                    ///< Data types, either ordered ("int64") or by column name ("id:int64"). Columns without one are inferred. NULL infers all columns
+
+  size_t        byte_range_offset;          ///< Offset of the byte range to read, the records that start in the range are read
+  size_t        byte_range_size;            ///< Size of the byte range to read, 0 reads to the end of the data
+
+} json_read_arg;
+
+/**---------------------------------------------------------------------------*
+ * @brief  This struct contains all input parameters to the write_csv
+ * function, and returns the size of the output.
+ *
+ * Input parameters are all stored in host memory. Zero or NULL selects the
+ * default of an option.
+ *
+ *---------------------------------------------------------------------------**/
+typedef struct {
+
+  /*
+   * Output Arguments
+   */
+  size_t        bytes_written;              ///< Out: return the size of the file in bytes
+
+  /*
+   * Input arguments - all data is in the host memory
+   */
+  const char    *filepath;                  ///< The file to write, it is created or truncated
+
+  char          delimiter;                  ///< The field separator, default is ','
+  const char    *line_terminator;           ///< The row separator, default is "\n"
+  char          quotechar;                  ///< The character used to quote fields, default is '"'
+  bool          quote_all;                  ///< Quote every string and header field. Otherwise only the ones that contain the delimiter, the quotechar or a line break are quoted
+  const char    *na_rep;                    ///< The text of null values and NaN, default is the empty string
+
+  bool          header;                     ///< Write the names of the columns as the first row
+  const char    *compression;               ///< Specify the type of compression (nullptr,"none","infer","gzip"), "infer" infers the compression from the file extension, default(nullptr) is uncompressed
+
+} csv_write_arg;
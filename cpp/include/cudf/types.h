@@ -1,7 +1,11 @@
 #pragma once
 
 // TODO: Update to use fixed width types when CFFI goes away
+#ifdef GDF_LARGE_COLUMNS
+typedef int64_t gdf_size_type; /**< Limits the maximum size of a gdf_column to 2^63-1 */
+#else
 typedef int gdf_size_type; /**< Limits the maximum size of a gdf_column to 2^31-1 */
+#endif
 typedef gdf_size_type gdf_index_type;
 typedef unsigned char gdf_valid_type;
 typedef	long	gdf_date64;
@@ -88,7 +92,7 @@ typedef struct {
 typedef struct gdf_column_{
     void *data;                       /**< Pointer to the columns data */ 
     gdf_valid_type *valid;            /**< Pointer to the columns validity bit mask where the 'i'th bit indicates if the 'i'th row is NULL */
-    gdf_size_type size;               /**< Number of data elements in the columns data buffer. Limited to 2^31 - 1.*/
+    gdf_size_type size;               /**< Number of data elements in the columns data buffer. Limited to 2^31 - 1 unless built with GDF_LARGE_COLUMNS.*/
     gdf_dtype dtype;                  /**< The datatype of the column's data */
     gdf_size_type null_count;         /**< The number of NULL values in the column's data */
     gdf_dtype_extra_info dtype_info;
@@ -135,6 +139,45 @@ typedef enum {
 } gdf_agg_op;
 
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief These enums indicate the supported binary operations that can be
+ * used to compute a prefix scan over a column
+ */
+/* ----------------------------------------------------------------------------*/
+typedef enum {
+  GDF_SCAN_SUM = 0,   /**< Computes the running sum of the values in the column */
+  GDF_SCAN_MIN,       /**< Computes the running minimum of the values in the column */
+  GDF_SCAN_MAX,       /**< Computes the running maximum of the values in the column */
+  GDF_SCAN_PRODUCT,   /**< Computes the running product of the values in the column */
+  N_GDF_SCAN_OPS,     /**< The total number of scan operations. ALL NEW OPERATIONS SHOULD BE ADDED ABOVE THIS LINE*/
+} gdf_scan_op;
+
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief These enums indicate what gdf_find_and_replace does with the valid
+ * values that are not found among the old values
+ */
+/* ----------------------------------------------------------------------------*/
+typedef enum {
+  GDF_UNMATCHED_KEEP = 0,  /**< Unmatched values are left as they are */
+  GDF_UNMATCHED_NULL,      /**< Unmatched values become null */
+  GDF_UNMATCHED_DEFAULT,   /**< Unmatched values are replaced with a default value */
+} gdf_unmatched_policy;
+
+typedef enum {
+  GDF_SEARCH_LEFT = 0,  /**< Find the first position not before the searched row */
+  GDF_SEARCH_RIGHT,     /**< Find the first position after the searched row */
+} gdf_search_side;
+
+typedef enum {
+  GDF_ASOF_BACKWARD = 0,  /**< Match the last right row with a key not after the left key */
+  GDF_ASOF_FORWARD,       /**< Match the first right row with a key not before the left key */
+  GDF_ASOF_NEAREST,       /**< Match the closest of both, the backward one on ties */
+} gdf_asof_direction;
+
+
 /* --------------------------------------------------------------------------*/
 /** 
  * @brief  Colors for use with NVTX ranges.
@@ -170,6 +213,21 @@ typedef struct gdf_context_{
   int flag_sort_inplace;        /**< 0 = No sort in place allowed, 1 = else */
 } gdf_context;
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Usage statistics of a libcudf scratch memory allocator
+ */
+/* ----------------------------------------------------------------------------*/
+typedef struct {
+  size_t num_allocations;           /**< Number of allocation requests */
+  size_t num_deallocations;         /**< Number of deallocation requests */
+  size_t num_cache_hits;            /**< Allocation requests served from a cache */
+  size_t num_upstream_allocations;  /**< Allocation requests forwarded to the upstream allocator */
+  size_t bytes_in_use;              /**< Bytes currently handed out */
+  size_t peak_bytes_in_use;         /**< High-water mark of bytes_in_use */
+  size_t bytes_cached;              /**< Bytes held in caches, available for reuse */
+} gdf_allocator_stats;
+
 struct _OpaqueIpcParser;
 typedef struct _OpaqueIpcParser gdf_ipc_parser_type;
 
@@ -182,6 +240,18 @@ struct _OpaqueSegmentedRadixsortPlan;
 typedef struct _OpaqueSegmentedRadixsortPlan gdf_segmented_radixsort_plan_type;
 
 
+struct _OpaqueQuantileSketch;
+typedef struct _OpaqueQuantileSketch gdf_quantile_sketch_type;
+
+
+struct _OpaqueSearchIndex;
+typedef struct _OpaqueSearchIndex gdf_search_index_type;
+
+
+struct _OpaqueHashPartitioner;
+typedef struct _OpaqueHashPartitioner gdf_partitioner_type;
+
+
 
 
 typedef enum{
@@ -198,6 +268,50 @@ typedef enum{
 	GDF_GREATER_THAN_OR_EQUALS
 } gdf_comparison_operator;
 
+typedef enum {
+  GDF_PREDICATE_COMPARE = 0,      /**< column op values[0] */
+  GDF_PREDICATE_COMPARE_COLUMNS,  /**< column op other_column */
+  GDF_PREDICATE_IN,               /**< column equals one of values[0, num_values) */
+  GDF_PREDICATE_BETWEEN,          /**< values[0] <= column <= values[1] */
+  GDF_PREDICATE_IS_NULL,          /**< column is null */
+  GDF_PREDICATE_IS_NOT_NULL,      /**< column is not null */
+  GDF_PREDICATE_AND,              /**< Both predicates left and right hold */
+  GDF_PREDICATE_OR,               /**< Either predicate left or right holds */
+} gdf_predicate_kind;
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  A constant compared with a column. Values of GDF_FLOAT32 and
+ * GDF_FLOAT64 are read from real, those of the other types from integer,
+ * e.g. days since the epoch for GDF_DATE32.
+ */
+/* ----------------------------------------------------------------------------*/
+typedef struct {
+  gdf_dtype dtype;   /**< The type of the value */
+  int64_t integer;   /**< The value of an integer, date, timestamp or category */
+  double real;       /**< The value of a floating point number */
+} gdf_predicate_value;
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  A node of a filter predicate. Nodes are given in an array whose
+ * last node is the root, and AND/OR nodes refer to earlier nodes by index.
+ * The nodes form a tree: a node is the operand of at most one AND/OR node.
+ *
+ * A term with a null operand is false, so WHERE semantics are kept.
+ */
+/* ----------------------------------------------------------------------------*/
+typedef struct {
+  gdf_predicate_kind kind;
+  gdf_comparison_operator op;        /**< The operator of GDF_PREDICATE_COMPARE[_COLUMNS] */
+  int column;                        /**< The index of the tested column */
+  int other_column;                  /**< The right hand column of GDF_PREDICATE_COMPARE_COLUMNS */
+  gdf_predicate_value const* values; /**< Host array of the constants of the term */
+  int num_values;                    /**< The number of constants */
+  int left;                          /**< The index of the first operand of AND/OR */
+  int right;                         /**< The index of the second operand of AND/OR */
+} gdf_predicate;
+
 typedef enum{
 	GDF_WINDOW_RANGE,
 	GDF_WINDOW_ROW
@@ -1,7 +1,17 @@
 import cffi
 import os
+import re
 
 include_dir = os.environ.get('CUDF_INCLUDE_DIR', '../../include/cudf/')
+large_columns = os.environ.get('CUDF_LARGE_COLUMNS', 'OFF').upper() in ('ON', '1', 'TRUE')
+
+
+def resolve_large_columns(source):
+    """cffi does not evaluate preprocessor conditionals, so keep the branch of
+    each `#ifdef GDF_LARGE_COLUMNS` block that matches the libcudf build"""
+    block = re.compile(r'#ifdef GDF_LARGE_COLUMNS\n(.*?)#else\n(.*?)#endif\n', re.S)
+    return block.sub(lambda m: m.group(1) if large_columns else m.group(2), source)
+
 
 ffibuilder = cffi.FFI()
 ffibuilder.set_source("libgdf_cffi.libgdf_cffi", None)
@@ -9,7 +19,7 @@ ffibuilder.set_source("libgdf_cffi.libgdf_cffi", None)
 for fname in ['types.h', 'convert_types.h', 'functions.h',
               'io_types.h', 'io_functions.h']:
     with open(os.path.join(include_dir, fname), 'r') as fin:
-        ffibuilder.cdef(fin.read())
+        ffibuilder.cdef(resolve_large_columns(fin.read()))
 
 if __name__ == "__main__":
     ffibuilder.compile()
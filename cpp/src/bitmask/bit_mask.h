@@ -130,7 +130,7 @@ namespace bit_mask {
    *
    *  @return GDF_SUCCESS on success, the RMM or CUDA error on error
    */
-  gdf_error create_bit_mask(bit_mask_t **mask, gdf_size_type number_of_records, int fill_value = -1, gdf_size_type padding_bytes = 64) {
+  inline gdf_error create_bit_mask(bit_mask_t **mask, gdf_size_type number_of_records, int fill_value = -1, gdf_size_type padding_bytes = 64) {
     //
     //  To handle padding, we will round the number_of_records up to the next padding boundary, then identify how many element
     //  that equates to.  Then we can allocate the appropriate amount of storage.
@@ -266,6 +266,142 @@ namespace bit_mask {
     atomicAnd( &valid[rec], ~(bit_mask_t{1} << bit));
   }
 
+  /**
+   *  @brief count the number of set bits in a bit mask element
+   *
+   *  Uses the hardware population count on both host and device.
+   *
+   *  @param[in]  element   The bit mask element
+   *
+   *  @return the number of bits set to one
+   */
+  CUDA_HOST_DEVICE_CALLABLE
+  int popcount(bit_mask_t element) {
+#ifdef __CUDA_ARCH__
+    return __popc(element);
+#else
+    return __builtin_popcount(element);
+#endif
+  }
+
+  /**
+   *  @brief shift the 64 bit value hi:lo right and return the low 32 bits
+   *
+   *  Used to realign bit mask elements to an arbitrary bit offset without
+   *  going through the individual bits.
+   *
+   *  @param[in]  lo      The low element
+   *  @param[in]  hi      The high element
+   *  @param[in]  shift   The number of bits to shift by, in [0, 32)
+   *
+   *  @return the realigned element
+   */
+  CUDA_HOST_DEVICE_CALLABLE
+  bit_mask_t funnel_shift_right(bit_mask_t lo, bit_mask_t hi, int shift) {
+#ifdef __CUDA_ARCH__
+    return __funnelshift_r(lo, hi, shift);
+#else
+    return (0 == shift) ? lo : ((lo >> shift) | (hi << (detail::BITS_PER_ELEMENT - shift)));
+#endif
+  }
+
+  /**
+   *  @brief mask selecting the bits of the last element that correspond to records
+   *
+   *  @param[in]  number_of_records   The number of records in the bit mask
+   *
+   *  @return the mask of used bits in the last element, all ones if the last
+   *          element is full
+   */
+  CUDA_HOST_DEVICE_CALLABLE
+  bit_mask_t last_element_mask(gdf_size_type number_of_records) {
+    const gdf_size_type bits{detail::which_bit(number_of_records)};
+    return (0 == bits) ? ~bit_mask_t{0} : ((bit_mask_t{1} << bits) - 1);
+  }
+
+  /**
+   *  @brief read a bit mask element from a gdf_valid_type validity buffer
+   *
+   *  Validity buffers are only allocated to a multiple of gdf_valid_type, so the
+   *  last element may be partial. Whole elements are read with a single load,
+   *  the partial one a byte at a time. Bytes past the end of the buffer read
+   *  as zero. The buffer must be aligned to sizeof(bit_mask_t).
+   *
+   *  @param[in]  valid       The validity buffer
+   *  @param[in]  element     The index of the element to read
+   *  @param[in]  num_bytes   The size of the validity buffer in bytes
+   *
+   *  @return the element
+   */
+  CUDA_HOST_DEVICE_CALLABLE
+  bit_mask_t load_element(const gdf_valid_type *valid, gdf_size_type element, gdf_size_type num_bytes) {
+    const gdf_size_type first_byte{element * static_cast<gdf_size_type>(sizeof(bit_mask_t))};
+
+    if (first_byte + static_cast<gdf_size_type>(sizeof(bit_mask_t)) <= num_bytes) {
+      return reinterpret_cast<const bit_mask_t*>(valid)[element];
+    }
+
+    bit_mask_t result{0};
+    for (gdf_size_type b = 0; first_byte + b < num_bytes; ++b) {
+      result |= static_cast<bit_mask_t>(valid[first_byte + b]) << (b * GDF_VALID_BITSIZE);
+    }
+    return result;
+  }
+
+  /**
+   *  @brief write a bit mask element to a gdf_valid_type validity buffer
+   *
+   *  Counterpart of load_element, bytes past the end of the buffer are dropped.
+   *
+   *  @param[out] valid       The validity buffer
+   *  @param[in]  element     The index of the element to write
+   *  @param[in]  num_bytes   The size of the validity buffer in bytes
+   *  @param[in]  value       The bits to store
+   */
+  CUDA_HOST_DEVICE_CALLABLE
+  void store_element(gdf_valid_type *valid, gdf_size_type element, gdf_size_type num_bytes, bit_mask_t value) {
+    const gdf_size_type first_byte{element * static_cast<gdf_size_type>(sizeof(bit_mask_t))};
+
+    if (first_byte + static_cast<gdf_size_type>(sizeof(bit_mask_t)) <= num_bytes) {
+      reinterpret_cast<bit_mask_t*>(valid)[element] = value;
+      return;
+    }
+
+    for (gdf_size_type b = 0; first_byte + b < num_bytes; ++b) {
+      valid[first_byte + b] = static_cast<gdf_valid_type>(value >> (b * GDF_VALID_BITSIZE));
+    }
+  }
+
+  /**
+   *  @brief read the BITS_PER_ELEMENT bits of a validity buffer that start at an
+   *  arbitrary bit position
+   *
+   *  Bits before the start or past the end of the buffer read as zero. A null
+   *  buffer reads as all ones, i.e., every record is valid.
+   *
+   *  @param[in]  valid       The validity buffer, may be nullptr
+   *  @param[in]  first_bit   The position of the first bit to read, may be negative
+   *  @param[in]  num_bytes   The size of the validity buffer in bytes
+   *
+   *  @return bit i of the result is bit (first_bit + i) of the buffer
+   */
+  CUDA_HOST_DEVICE_CALLABLE
+  bit_mask_t load_bits(const gdf_valid_type *valid, gdf_size_type first_bit, gdf_size_type num_bytes) {
+    if (nullptr == valid) {
+      return ~bit_mask_t{0};
+    }
+
+    // floor division, first_bit may be negative
+    const gdf_size_type element{(first_bit >= 0) ? first_bit / detail::BITS_PER_ELEMENT
+                                                 : -((detail::BITS_PER_ELEMENT - 1 - first_bit) / detail::BITS_PER_ELEMENT)};
+    const int shift{static_cast<int>(first_bit - element * detail::BITS_PER_ELEMENT)};
+
+    const bit_mask_t lo{(element >= 0) ? load_element(valid, element, num_bytes) : bit_mask_t{0}};
+    const bit_mask_t hi{((shift > 0) && (element + 1 >= 0)) ? load_element(valid, element + 1, num_bytes) : bit_mask_t{0}};
+
+    return funnel_shift_right(lo, hi, shift);
+  }
+
 };
 
 #endif
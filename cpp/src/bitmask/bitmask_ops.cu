@@ -1,95 +1,265 @@
 #include "cudf.h"
 #include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
-#include "cudf/functions.h"
-#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/allocator.hpp"
+#include "bitmask/bit_mask.h"
+#include "bitmask/bitmask_ops.h"
 
 #include <cuda_runtime.h>
+#include <algorithm>
 #include <vector>
-#include <thrust/transform.h>
-#include <thrust/functional.h>
-#include <thrust/execution_policy.h>
-#include <thrust/iterator/iterator_adaptor.h>
-#include <thrust/device_vector.h>
+#include <cub/cub.cuh>
 
-/*
- * bit_mask_null_counts Generated using the following code
+using bit_mask::bit_mask_t;
 
-#include <iostream>
+namespace {
 
+constexpr int BITMASK_BLOCK_SIZE{256};
 
-int main()
+// Kernels below use grid-stride loops, so the grid is capped rather than
+// sized to the input
+constexpr gdf_size_type BITMASK_MAX_GRID_SIZE{1 << 16};
+
+gdf_size_type grid_size(gdf_size_type num_elements) {
+	return std::max(gdf_size_type{1},
+			std::min((num_elements + BITMASK_BLOCK_SIZE - 1) / BITMASK_BLOCK_SIZE, BITMASK_MAX_GRID_SIZE));
+}
+
+CUDA_DEVICE_CALLABLE
+bit_mask_t load_or_all_valid(gdf_valid_type const * valid, gdf_size_type element, gdf_size_type num_bytes) {
+	return (nullptr == valid) ? ~bit_mask_t{0} : bit_mask::load_element(valid, element, num_bytes);
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Combines num_masks bitmasks word by word with the operation op
+ */
+/* ----------------------------------------------------------------------------*/
+template <bitmask_op op>
+__global__
+void combine_bitmasks(gdf_valid_type * const valid_out,
+                      gdf_valid_type const * const * const masks,
+                      int const num_masks,
+                      gdf_size_type const num_elements,
+                      gdf_size_type const num_bytes)
 {
-	for (int i = 0 ; i != 256 ; i++) {
-		int count = 0;
-		for (int p = 0 ; p != 8 ; p++) {
-			if (i & (1 << p)) {
-				count++;
+	gdf_size_type element = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+
+	while (element < num_elements) {
+		bit_mask_t result{load_or_all_valid(masks[0], element, num_bytes)};
+
+		for (int i = 1; i < num_masks; ++i) {
+			bit_mask_t const current{load_or_all_valid(masks[i], element, num_bytes)};
+			switch (op) {
+				case bitmask_op::AND:    result &= current; break;
+				case bitmask_op::OR:     result |= current; break;
+				case bitmask_op::ANDNOT: result &= ~current; break;
 			}
 		}
-		std::cout<<(8-count)<<", ";
+
+		bit_mask::store_element(valid_out, element, num_bytes, result);
+
+		element += static_cast<gdf_size_type>(blockDim.x) * gridDim.x;
 	}
-	std::cout<<std::endl;
 }
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Writes the bits [in_offset, in_offset + num_values) of valid_in to
+ * [out_offset, out_offset + num_values) of valid_out, one output word per thread.
+ *
+ * The words at either end of the output range are only partially covered and
+ * are merged with their current contents.
  */
-std::vector<gdf_valid_type> bit_mask_null_counts = { 8, 7, 7, 6, 7, 6, 6, 5, 7, 6, 6, 5, 6, 5, 5, 4, 7, 6, 6, 5, 6, 5, 5, 4, 6, 5, 5, 4, 5, 4, 4, 3, 7, 6, 6, 5, 6, 5, 5, 4, 6, 5, 5, 4, 5, 4, 4, 3, 6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2, 7, 6, 6, 5, 6, 5, 5, 4, 6, 5, 5, 4, 5, 4, 4, 3, 6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2, 6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2, 5, 4, 4, 3, 4, 3, 3, 2, 4, 3, 3, 2, 3, 2, 2, 1, 7, 6, 6, 5, 6, 5, 5, 4, 6, 5, 5, 4, 5, 4, 4, 3, 6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2, 6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2, 5, 4, 4, 3, 4, 3, 3, 2, 4, 3, 3, 2, 3, 2, 2, 1, 6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2, 5, 4, 4, 3, 4, 3, 3, 2, 4, 3, 3, 2, 3, 2, 2, 1, 5, 4, 4, 3, 4, 3, 3, 2, 4, 3, 3, 2, 3, 2, 2, 1, 4, 3, 3, 2, 3, 2, 2, 1, 3, 2, 2, 1, 2, 1, 1, 0 };
+/* ----------------------------------------------------------------------------*/
+__global__
+void copy_bitmask_offset(gdf_valid_type * const valid_out,
+                         gdf_size_type const out_offset,
+                         gdf_valid_type const * const valid_in,
+                         gdf_size_type const in_offset,
+                         gdf_size_type const num_values,
+                         gdf_size_type const first_element,
+                         gdf_size_type const num_elements,
+                         gdf_size_type const out_bytes,
+                         gdf_size_type const in_bytes)
+{
+	constexpr gdf_size_type BITS{bit_mask::detail::BITS_PER_ELEMENT};
+
+	gdf_size_type i = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+
+	while (i < num_elements) {
+		gdf_size_type const element{first_element + i};
+		gdf_size_type const element_start{element * BITS};
+
+		bit_mask_t bits{bit_mask::load_bits(valid_in, element_start - out_offset + in_offset, in_bytes)};
+
+		// The bits of this word that fall inside the output range
+		gdf_size_type const lo{(out_offset > element_start) ? out_offset - element_start : 0};
+		gdf_size_type const end{out_offset + num_values - element_start};
+		gdf_size_type const hi{(end < BITS) ? end : BITS};
 
-unsigned char gdf_num_bits_zero_after_pos(unsigned char number, int pos){
-	//if pos == 0 then its aligned
-	if(pos == 0){
-		return 0;
+		if ((hi - lo) < BITS) {
+			bit_mask_t const range_mask{((bit_mask_t{1} << (hi - lo)) - 1) << lo};
+			bit_mask_t const current{bit_mask::load_element(valid_out, element, out_bytes)};
+			bits = (current & ~range_mask) | (bits & range_mask);
+		}
+
+		bit_mask::store_element(valid_out, element, out_bytes, bits);
+
+		i += static_cast<gdf_size_type>(blockDim.x) * gridDim.x;
 	}
-	unsigned char count = 0;
-	for (int p = pos ; p != 8 ; p++) {
-		if (number & (number << p)) {
-			count++;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Counts the set bits in [0, num_values) of a bitmask with __popc on
+ * whole words, masking off the unused bits of the last word.
+ */
+/* ----------------------------------------------------------------------------*/
+__global__
+void count_valid_bits(gdf_valid_type const * const valid,
+                      gdf_size_type const num_elements,
+                      gdf_size_type const num_values,
+                      gdf_size_type const num_bytes,
+                      unsigned long long * const global_count)
+{
+	using BlockReduce = cub::BlockReduce<unsigned long long, BITMASK_BLOCK_SIZE>;
+	__shared__ typename BlockReduce::TempStorage temp_storage;
+
+	gdf_size_type element = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+
+	unsigned long long my_count{0};
+
+	while (element < num_elements) {
+		bit_mask_t word{bit_mask::load_element(valid, element, num_bytes)};
+		if (element == (num_elements - 1)) {
+			word &= bit_mask::last_element_mask(num_values);
 		}
+		my_count += bit_mask::popcount(word);
+
+		element += static_cast<gdf_size_type>(blockDim.x) * gridDim.x;
+	}
+
+	unsigned long long const block_count{BlockReduce(temp_storage).Sum(my_count)};
+
+	if (threadIdx.x == 0) {
+		atomicAdd(global_count, block_count);
 	}
-	return (8 - pos) - count;
 }
 
-gdf_error all_bitmask_on(gdf_valid_type * valid_out, gdf_size_type & out_null_count, gdf_size_type num_values, cudaStream_t stream){
-	gdf_size_type num_chars_bitmask = ( ( num_values +( GDF_VALID_BITSIZE - 1)) / GDF_VALID_BITSIZE );
+} // namespace
 
-	thrust::device_ptr<gdf_valid_type> valid_out_ptr = thrust::device_pointer_cast(valid_out);
-	gdf_valid_type max_char = 255;
-	thrust::fill(rmm::exec_policy(stream)->on(stream),thrust::detail::make_normal_iterator(valid_out_ptr),thrust::detail::make_normal_iterator(valid_out_ptr + num_chars_bitmask),max_char);
-	//we have no nulls so set all the bits in gdf_valid_type to 1
-	out_null_count = 0;
+gdf_error bitmask_combine(gdf_valid_type * valid_out, gdf_valid_type const * const masks[], int num_masks,
+		gdf_size_type num_values, bitmask_op op, cudaStream_t stream){
+
+	GDF_REQUIRE(num_masks > 0, GDF_INVALID_API_CALL);
+	GDF_REQUIRE(nullptr != masks, GDF_DATASET_EMPTY);
+	GDF_REQUIRE(nullptr != valid_out, GDF_DATASET_EMPTY);
+
+	if (0 == num_values) {
+		return GDF_SUCCESS;
+	}
+
+	gdf_size_type const num_bytes{gdf_get_num_chars_bitmask(num_values)};
+	gdf_size_type const num_elements{bit_mask::num_elements(num_values)};
+
+	gdf_valid_type const ** d_masks{nullptr};
+	SCRATCH_ALLOC_TRY(&d_masks, sizeof(gdf_valid_type*) * num_masks, stream);
+	CUDA_TRY( cudaMemcpyAsync(d_masks, masks, sizeof(gdf_valid_type*) * num_masks, cudaMemcpyHostToDevice, stream) );
+
+	switch (op) {
+		case bitmask_op::AND:
+			combine_bitmasks<bitmask_op::AND><<<grid_size(num_elements), BITMASK_BLOCK_SIZE, 0, stream>>>(
+					valid_out, d_masks, num_masks, num_elements, num_bytes);
+			break;
+		case bitmask_op::OR:
+			combine_bitmasks<bitmask_op::OR><<<grid_size(num_elements), BITMASK_BLOCK_SIZE, 0, stream>>>(
+					valid_out, d_masks, num_masks, num_elements, num_bytes);
+			break;
+		case bitmask_op::ANDNOT:
+			combine_bitmasks<bitmask_op::ANDNOT><<<grid_size(num_elements), BITMASK_BLOCK_SIZE, 0, stream>>>(
+					valid_out, d_masks, num_masks, num_elements, num_bytes);
+			break;
+	}
+	CUDA_TRY( cudaGetLastError() );
+
+	SCRATCH_FREE_TRY(d_masks, stream);
 	return GDF_SUCCESS;
 }
 
-gdf_error apply_bitmask_to_bitmask(gdf_size_type & out_null_count, gdf_valid_type * valid_out, gdf_valid_type * valid_left, gdf_valid_type * valid_right,
-		cudaStream_t stream, gdf_size_type num_values){
+gdf_error bitmask_copy_offset(gdf_valid_type * valid_out, gdf_size_type out_offset,
+		gdf_valid_type const * valid_in, gdf_size_type in_offset,
+		gdf_size_type num_values, cudaStream_t stream){
+
+	GDF_REQUIRE(nullptr != valid_out, GDF_DATASET_EMPTY);
+	GDF_REQUIRE((out_offset >= 0) && (in_offset >= 0) && (num_values >= 0), GDF_INVALID_API_CALL);
 
-	gdf_size_type num_chars_bitmask = ( ( num_values +( GDF_VALID_BITSIZE - 1)) / GDF_VALID_BITSIZE );
-	thrust::device_ptr<gdf_valid_type> valid_out_ptr = thrust::device_pointer_cast(valid_out);
-	thrust::device_ptr<gdf_valid_type> valid_left_ptr = thrust::device_pointer_cast(valid_left);
-	//here we are basically figuring out what is the last pointed to unsigned char that can contain part of the bitmask
-	thrust::device_ptr<gdf_valid_type> valid_left_end_ptr = thrust::device_pointer_cast(valid_left + num_chars_bitmask );
-	thrust::device_ptr<gdf_valid_type> valid_right_ptr = thrust::device_pointer_cast(valid_right);
+	if (0 == num_values) {
+		return GDF_SUCCESS;
+	}
 
+	gdf_size_type const first_element{bit_mask::detail::which_element(out_offset)};
+	gdf_size_type const last_element{bit_mask::detail::which_element(out_offset + num_values - 1)};
+	gdf_size_type const num_elements{last_element - first_element + 1};
 
-	thrust::transform(rmm::exec_policy(stream)->on(stream), thrust::detail::make_normal_iterator(valid_left_ptr),
-			thrust::detail::make_normal_iterator(valid_left_end_ptr), thrust::detail::make_normal_iterator(valid_right_ptr),
-			thrust::detail::make_normal_iterator(valid_out_ptr), thrust::bit_and<gdf_valid_type>());
+	copy_bitmask_offset<<<grid_size(num_elements), BITMASK_BLOCK_SIZE, 0, stream>>>(
+			valid_out, out_offset, valid_in, in_offset, num_values,
+			first_element, num_elements,
+			gdf_get_num_chars_bitmask(out_offset + num_values),
+			gdf_get_num_chars_bitmask(in_offset + num_values));
+	CUDA_TRY( cudaGetLastError() );
 
+	return GDF_SUCCESS;
+}
 
-	char * last_char = new char[1];
-	cudaError_t error = cudaMemcpyAsync(last_char,valid_out + ( num_chars_bitmask-1),sizeof(gdf_valid_type),cudaMemcpyDeviceToHost,stream);
+gdf_error bitmask_count_valid(gdf_valid_type const * valid, gdf_size_type num_values,
+		gdf_size_type * valid_count, cudaStream_t stream){
 
+	GDF_REQUIRE(nullptr != valid_count, GDF_DATASET_EMPTY);
 
-	rmm::device_vector<gdf_valid_type> bit_mask_null_counts_device(bit_mask_null_counts);
+	if ((nullptr == valid) || (0 == num_values)) {
+		*valid_count = num_values;
+		return GDF_SUCCESS;
+	}
 
-	//this permutation iterator makes it so that each char basically gets replaced with its number of null counts
-	//so if you sum up this perm iterator you add up all of the counts for null values per unsigned char
-	thrust::permutation_iterator<rmm::device_vector<gdf_valid_type>::iterator,thrust::detail::normal_iterator<thrust::device_ptr<gdf_valid_type> > >
-	null_counts_iter( bit_mask_null_counts_device.begin(),thrust::detail::make_normal_iterator(valid_out_ptr));
+	gdf_size_type const num_elements{bit_mask::num_elements(num_values)};
 
-	//you will notice that we subtract the number of zeros we found in the last character
-	out_null_count = thrust::reduce(rmm::exec_policy(stream)->on(stream),null_counts_iter, null_counts_iter + num_chars_bitmask) - gdf_num_bits_zero_after_pos(*last_char,num_values % GDF_VALID_BITSIZE );
+	// Counted as unsigned long long, for which atomicAdd is natively supported
+	unsigned long long * d_count{nullptr};
+	SCRATCH_ALLOC_TRY(&d_count, sizeof(unsigned long long), stream);
+	CUDA_TRY( cudaMemsetAsync(d_count, 0, sizeof(unsigned long long), stream) );
 
-	delete[] last_char;
+	count_valid_bits<<<grid_size(num_elements), BITMASK_BLOCK_SIZE, 0, stream>>>(
+			valid, num_elements, num_values, gdf_get_num_chars_bitmask(num_values), d_count);
+	CUDA_TRY( cudaGetLastError() );
+
+	unsigned long long h_count{0};
+	CUDA_TRY( cudaMemcpyAsync(&h_count, d_count, sizeof(unsigned long long), cudaMemcpyDeviceToHost, stream) );
+	SCRATCH_FREE_TRY(d_count, stream);
+	CUDA_TRY( cudaStreamSynchronize(stream) );
+
+	*valid_count = static_cast<gdf_size_type>(h_count);
+	return GDF_SUCCESS;
+}
+
+gdf_error all_bitmask_on(gdf_valid_type * valid_out, gdf_size_type & out_null_count, gdf_size_type num_values, cudaStream_t stream){
+	//we have no nulls so set all the bits in gdf_valid_type to 1
+	CUDA_TRY( cudaMemsetAsync(valid_out, 0xff, gdf_get_num_chars_bitmask(num_values) * sizeof(gdf_valid_type), stream) );
+	out_null_count = 0;
 	return GDF_SUCCESS;
 }
 
+gdf_error apply_bitmask_to_bitmask(gdf_size_type & out_null_count, gdf_valid_type * valid_out, gdf_valid_type * valid_left, gdf_valid_type * valid_right,
+		cudaStream_t stream, gdf_size_type num_values){
+
+	gdf_valid_type const * const masks[] = {valid_left, valid_right};
+	gdf_error status = bitmask_combine(valid_out, masks, 2, num_values, bitmask_op::AND, stream);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	gdf_size_type valid_count{0};
+	status = bitmask_count_valid(valid_out, num_values, &valid_count, stream);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	out_null_count = num_values - valid_count;
+	return GDF_SUCCESS;
+}
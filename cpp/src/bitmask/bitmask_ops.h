@@ -2,11 +2,80 @@
 #define GDF_BITMASK_OPS_H
 
 #include <cuda_runtime.h>
+#include "cudf.h"
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Bitwise operations that combine validity bitmasks
+ */
+/* ----------------------------------------------------------------------------*/
+enum class bitmask_op {
+  AND,     ///< out = m[0] & m[1] & ... & m[n-1]
+  OR,      ///< out = m[0] | m[1] | ... | m[n-1]
+  ANDNOT   ///< out = m[0] & ~m[1] & ... & ~m[n-1]
+};
 
-gdf_error all_bitmask_on(gdf_valid_type * valid_out, gdf_size_type & out_null_count, gdf_size_type num_values, cudaStream_t stream);
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Combines any number of validity bitmasks with a bitwise operation
+ *
+ * Works on 32 bit words, one thread per word. A nullptr mask is treated as all
+ * bits set, i.e., a column without nulls. The masks must be aligned to 4 bytes,
+ * which holds for any buffer coming from the allocator.
+ *
+ * @param[out] valid_out The resulting bitmask, may alias any of the inputs
+ * @param[in] masks Host array of device pointers to the masks to combine
+ * @param[in] num_masks The number of masks, at least one
+ * @param[in] num_values The number of bits in each mask
+ * @param[in] op The operation to apply
+ * @param[in] stream The stream to run on
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error bitmask_combine(gdf_valid_type * valid_out, gdf_valid_type const * const masks[], int num_masks,
+		gdf_size_type num_values, bitmask_op op, cudaStream_t stream);
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Copies a range of bits between two validity bitmasks that may start
+ * at arbitrary, different bit offsets
+ *
+ * Each output word is assembled from two input words with a funnel shift. Bits
+ * of valid_out outside of [out_offset, out_offset + num_values) are preserved,
+ * so calls on the same stream can fill adjacent ranges of one mask.
+ *
+ * @param[out] valid_out The destination bitmask
+ * @param[in] out_offset The bit position in valid_out of the first copied bit
+ * @param[in] valid_in The source bitmask, nullptr copies all ones
+ * @param[in] in_offset The bit position in valid_in of the first bit to copy
+ * @param[in] num_values The number of bits to copy
+ * @param[in] stream The stream to run on
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error bitmask_copy_offset(gdf_valid_type * valid_out, gdf_size_type out_offset,
+		gdf_valid_type const * valid_in, gdf_size_type in_offset,
+		gdf_size_type num_values, cudaStream_t stream);
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Counts the set bits in [0, num_values) of a validity bitmask using
+ * the hardware population count
+ *
+ * @param[in] valid The bitmask, nullptr counts as all bits set
+ * @param[in] num_values The number of bits to count
+ * @param[out] valid_count Host pointer receiving the count
+ * @param[in] stream The stream to run on, synchronized before returning
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error bitmask_count_valid(gdf_valid_type const * valid, gdf_size_type num_values,
+		gdf_size_type * valid_count, cudaStream_t stream);
 
+gdf_error all_bitmask_on(gdf_valid_type * valid_out, gdf_size_type & out_null_count, gdf_size_type num_values, cudaStream_t stream);
 
 gdf_error apply_bitmask_to_bitmask(gdf_size_type & out_null_count, gdf_valid_type * valid_out, gdf_valid_type * valid_left, gdf_valid_type * valid_right,
 		cudaStream_t stream, gdf_size_type num_values);
@@ -19,26 +19,15 @@
  * @file column.cpp
  * ---------------------------------------------------------------------------**/
 #include <vector>
+#include <algorithm>
 #include <cassert>
-#include <cub/cub.cuh>
 
 #include "cudf.h"
 #include "rmm/rmm.h"
-#include "rmm/thrust_rmm_allocator.h"
 #include "utilities/error_utils.h"
 #include "utilities/cudf_utils.h"
-
-#include <thrust/tabulate.h>
-
-
-// To account for if gdf_valid_type is not a 4 byte type,
-// compute the RATIO of the number of bytes in gdf_valid_type
-// to the 4 byte type being used for casting
-using valid32_t = uint32_t;
-constexpr size_t RATIO = sizeof(valid32_t) / sizeof(gdf_valid_type);
-constexpr int BITS_PER_MASK32 = GDF_VALID_BITSIZE * RATIO;
-
-constexpr int block_size = 256;
+#include "bitmask/bit_mask.h"
+#include "bitmask/bitmask_ops.h"
 
 /** --------------------------------------------------------------------------*
  * @brief  Counts the number of valid bits for the specified number of rows
@@ -49,7 +38,7 @@ constexpr int block_size = 256;
  * 
  * @returns  The number of valid bits in [0, num_rows) in the host vector of masks
  * ----------------------------------------------------------------------------*/
-size_t count_valid_bits_host(std::vector<gdf_valid_type> const & masks, int const num_rows)
+size_t count_valid_bits_host(std::vector<gdf_valid_type> const & masks, gdf_size_type const num_rows)
 {
   if((0 == num_rows) || (0 == masks.size())){
     return 0;
@@ -60,13 +49,7 @@ size_t count_valid_bits_host(std::vector<gdf_valid_type> const & masks, int cons
   // Count the valid bits for all masks except the last one
   for(size_t i = 0; i < (masks.size() - 1); ++i)
   {
-    gdf_valid_type current_mask = masks[i];
-
-    while(current_mask > 0)
-    {
-      current_mask &= (current_mask-1) ;
-      count++;
-    }
+    count += bit_mask::popcount(masks[i]);
   }
 
   // Only count the bits in the last mask that correspond to rows
@@ -75,87 +58,12 @@ size_t count_valid_bits_host(std::vector<gdf_valid_type> const & masks, int cons
   if(num_rows_last_mask == 0)
     num_rows_last_mask = GDF_VALID_BITSIZE;
 
-  gdf_valid_type last_mask = *(masks.end() - 1);
-  for(int i = 0; (i < num_rows_last_mask) && (last_mask > 0); ++i)
-  {
-    count += (last_mask & gdf_valid_type(1));
-    last_mask >>= 1;
-  }
+  gdf_valid_type const last_mask = *(masks.end() - 1);
+  count += bit_mask::popcount(last_mask & ((1u << num_rows_last_mask) - 1));
 
   return count;
 }
 
-
-/* --------------------------------------------------------------------------*/
-/** 
- * @brief Kernel to count the number of set bits in a column's validity buffer
- *
- * The underlying buffer type may only be a 1B type, but it is casted to a 4B 
- * type (valid32_t) such that __popc may be used to more efficiently count the 
- * number of set bits. This requires handling the last 4B element as a special 
- * case as the buffer may not be a multiple of 4 bytes.
- * 
- * @param[in] masks32 Pointer to buffer (casted as a 4B type) whose bits will be counted
- * @param[in] num_masks32 The number of 4B elements in the buffer
- * @param[in] num_rows The number of rows in the column, i.e., the number of bits
- * in the buffer that correspond to rows
- * @param[out] global_count The number of set bits in the range of bits [0, num_rows)
- */
-/* ----------------------------------------------------------------------------*/
-template <typename size_type>
-__global__ 
-void count_valid_bits(valid32_t const * const masks32, 
-                      int const num_masks32, 
-                      int const num_rows, 
-                      size_type * const global_count)
-{
-  using BlockReduce = cub::BlockReduce<size_type, block_size>;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-
-  // If the number of rows is not a multiple of 32, then the remaining 
-  // rows need to be handled separtely because not all of its bits correspond
-  // to rows
-  int last_mask32{0};
-  int const num_rows_last_mask{num_rows % BITS_PER_MASK32};
-  if(0 == num_rows_last_mask)
-    last_mask32 = num_masks32;
-  else
-    last_mask32 = num_masks32 - 1;
-
-  int const idx{static_cast<int>(threadIdx.x + blockIdx.x * blockDim.x)};
-
-  int cur_mask{idx};
-
-  size_type my_count{0};
-
-  // Use popc to count the valid bits for the all of the masks 
-  // where all of the bits correspond to rows
-  while(cur_mask < last_mask32)
-  {
-    my_count += __popc(masks32[cur_mask]);
-    cur_mask += blockDim.x * gridDim.x;
-  }
-
-  // Handle the remainder rows
-  if(idx < num_rows_last_mask)
-  {
-    gdf_valid_type const * const valids{reinterpret_cast<gdf_valid_type const *>(masks32)};
-    int const my_row{num_rows - idx - 1};
-
-    if(true == gdf_is_valid(valids,my_row))
-      ++my_count;
-  }
-
-  // Reduces the count from each thread in a block into a block count
-  int const block_count{BlockReduce(temp_storage).Sum(my_count)};
-
-  // Store the block count into the global count
-  if(threadIdx.x == 0)
-  {
-    atomicAdd(global_count, block_count);
-  }
-}
-
 /* ---------------------------------------------------------------------------*
  * @brief  Counts the number of valid bits for the specified number of rows
  * in a validity bitmask.
@@ -178,46 +86,9 @@ gdf_error gdf_count_nonzero_mask(gdf_valid_type const *masks,
 
   if(0 == num_rows) {return GDF_SUCCESS;}
 
-  if(nullptr == masks){
-      *count = num_rows;
-      return GDF_SUCCESS;
-  }
-
-  // Masks will be proccessed as 4B types, therefore we require that the underlying
-  // type be less than or equal to 4B
-  assert(sizeof(valid32_t) >= sizeof(gdf_valid_type));
-
-  // Number of gdf_valid_types in the validity bitmask
-  gdf_size_type const num_masks{gdf_get_num_chars_bitmask(num_rows)};
-
-  // Number of 4 byte types in the validity bit mask 
-  gdf_size_type num_masks32{static_cast<gdf_size_type>(std::ceil(static_cast<float>(num_masks) / RATIO))};
-
   gdf_size_type h_count{0};
-  if(num_masks32 > 0)
-  {
-    // TODO: Probably shouldn't create/destroy the stream every time
-    cudaStream_t count_stream;
-    CUDA_TRY(cudaStreamCreate(&count_stream));
-    int * d_count{nullptr};
-
-    // Cast validity buffer to 4 byte type
-    valid32_t const * masks32{reinterpret_cast<valid32_t const *>(masks)};
-
-    RMM_TRY(RMM_ALLOC((void**)&d_count, sizeof(gdf_size_type), count_stream));
-    CUDA_TRY(cudaMemsetAsync(d_count, 0, sizeof(gdf_size_type), count_stream));
-
-    gdf_size_type const grid_size{(num_masks32 + block_size - 1)/block_size};
-
-    count_valid_bits<<<grid_size, block_size,0,count_stream>>>(masks32, num_masks32, num_rows, d_count);
-
-    CUDA_TRY( cudaGetLastError() );
-
-    CUDA_TRY(cudaMemcpyAsync(&h_count, d_count, sizeof(gdf_size_type), cudaMemcpyDeviceToHost, count_stream));
-    RMM_TRY(RMM_FREE(d_count, count_stream));
-    CUDA_TRY(cudaStreamSynchronize(count_stream));
-    CUDA_TRY(cudaStreamDestroy(count_stream));
-  }
+  gdf_error const status = bitmask_count_valid(masks, num_rows, &h_count, 0);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
 
   assert(h_count >= 0);
   assert(h_count <= num_rows);
@@ -236,9 +107,10 @@ gdf_error gdf_count_nonzero_mask(gdf_valid_type const *masks,
  * @param[out] output_mask The concatenated mask
  * @param[in] output_column_length The total length (in data elements) of the 
  *                                 concatenated column
- * @param[in] masks_to_concat The array of device pointers to validity bitmasks
- *                            for the columns to concatenate
- * @param[in] column_lengths An array of lengths of the columns to concatenate
+ * @param[in] masks_to_concat Host array of device pointers to validity bitmasks
+ *                            for the columns to concatenate. A nullptr mask is
+ *                            treated as all valid
+ * @param[in] column_lengths Host array of lengths of the columns to concatenate
  * @param[in] num_columns The number of columns to concatenate
  * @return gdf_error GDF_SUCCESS or GDF_CUDA_ERROR if there is a runtime CUDA
            error
@@ -249,53 +121,25 @@ gdf_error gdf_mask_concat(gdf_valid_type *output_mask,
                           gdf_size_type *column_lengths, 
                           gdf_size_type num_columns)
 {
-    // This lambda is executed in a thrust algorithm. Each thread computes and
-    // returns one gdf_valid_type element for the concatenated output mask
-    auto mask_concatenator = [=] __device__ (gdf_size_type mask_index) {
-      gdf_valid_type output_m = 0;
-     
-      int cur_mask_index = 0, cur_mask_start = 0;
-      int cur_mask_len = column_lengths[0];
-      
-      // Each thread processes one GDF_VALID_BITSIZE worth of valid bits
-      for (int bit = 0; bit < GDF_VALID_BITSIZE; ++bit) 
-      { 
-        gdf_size_type output_index = mask_index * GDF_VALID_BITSIZE + bit;
+    gdf_size_type output_offset{0};
 
-        // stop when we are beyond the length of the output column (in elements)
-        if (output_index >= output_column_length) break;
-        
-        // find the next column's mask when we step past the current column's length
-        while ( (cur_mask_start + cur_mask_len <= output_index) && (cur_mask_index < num_columns - 1) )
-        {
-          cur_mask_start += cur_mask_len;
-          cur_mask_len = column_lengths[++cur_mask_index];           
-        }
-        
-        // Set each valid bit at the right location in this thread's output gdf_valid_type
-        // Note: gdf_is_valid returns true when the input mask is a null pointer
-        // This makes it behave as if columns with null validity masks have masks of all 1s,
-        // which is the desired behavior.
-        gdf_size_type index = output_index - cur_mask_start;
-        if ( gdf_is_valid(masks_to_concat[cur_mask_index], index) ) 
-        {
-          output_m |= (1 << bit);     
-        }
-      }
+    // Each mask is copied whole words at a time into the output, shifted to
+    // the output offset at which its column starts. The word shared by two
+    // adjacent columns is merged by the second copy; the copies run in order
+    // on the same stream.
+    for (gdf_size_type i = 0; i < num_columns; ++i)
+    {
+      gdf_size_type const length{std::min(column_lengths[i], output_column_length - output_offset)};
 
-      return output_m;
-    };
+      gdf_error const status = bitmask_copy_offset(output_mask, output_offset,
+                                                   masks_to_concat[i], 0,
+                                                   length, 0);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
 
-    // This is like thrust::for_each where the lambda gets the current index into the output array
-    // as input
-    thrust::tabulate(rmm::exec_policy()->on(0),
-                     output_mask,
-                     output_mask + gdf_get_num_chars_bitmask(output_column_length),
-                     mask_concatenator);
+      output_offset += length;
+    }
 
     CUDA_TRY( cudaGetLastError() );
         
     return GDF_SUCCESS;
 }
-
-
@@ -24,9 +24,9 @@
 #include <thrust/copy.h>
 #include <thrust/remove.h>
 #include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/zip_iterator.h>
 
 #include <thrust/execution_policy.h>
-#include <thrust/iterator/iterator_adaptor.h>
 #include <thrust/iterator/transform_iterator.h>
 
 #include "cudf.h"
@@ -35,73 +35,18 @@
 #include "rmm/thrust_rmm_allocator.h"
 
 //std lib
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 
 
 
-//wow the freaking example from iterator_adaptpr, what a break right!
-template<typename Iterator>
-class repeat_iterator
-		: public thrust::iterator_adaptor<
-		  repeat_iterator<Iterator>, // the first template parameter is the name of the iterator we're creating
-		  Iterator                   // the second template parameter is the name of the iterator we're adapting
-		  // we can use the default for the additional template parameters
-		  >
-{
-public:
-	// shorthand for the name of the iterator_adaptor we're deriving from
-	typedef thrust::iterator_adaptor<
-			repeat_iterator<Iterator>,
-			Iterator
-			> super_t;
-	__host__ __device__
-	repeat_iterator(const Iterator &x, int n) : super_t(x), begin(x), n(n) {}
-	// befriend thrust::iterator_core_access to allow it access to the private interface below
-	friend class thrust::iterator_core_access;
-private:
-	// repeat each element of the adapted range n times
-	unsigned int n;
-	// used to keep track of where we began
-	const Iterator begin;
-	// it is private because only thrust::iterator_core_access needs access to it
-	__host__ __device__
-	typename super_t::reference dereference() const
-	{
-		return *(begin + (this->base() - begin) / n);
-	}
-};
-
-
-
-typedef repeat_iterator<thrust::detail::normal_iterator<thrust::device_ptr<gdf_valid_type> > > gdf_valid_iterator;
-
 gdf_size_type get_number_of_bytes_for_valid (gdf_size_type column_size) {
     return sizeof(gdf_valid_type) * (column_size + GDF_VALID_BITSIZE - 1) / GDF_VALID_BITSIZE;
 }
 
 
-// note: functor inherits from unary_function
-struct modulus_bit_width : public thrust::unary_function<gdf_size_type,gdf_size_type>
-{
-	gdf_size_type n_bytes;
-	gdf_size_type column_size;
-	
-	modulus_bit_width (gdf_size_type b_nytes, gdf_size_type column_size) {
-		this->n_bytes = n_bytes;
-		this->column_size = column_size;
-	}
-	__host__ __device__
-	gdf_size_type operator()(gdf_size_type x) const
-	{
-		gdf_size_type col_position = x / 8;	
-        gdf_size_type length_col = n_bytes != col_position+1 ? GDF_VALID_BITSIZE : column_size - GDF_VALID_BITSIZE * (n_bytes - 1);
-		//return x % GDF_VALID_BITSIZE;
-		return (length_col - 1) - (x % 8);
-		// x << 
-	}
-};
-
-
 struct shift_left: public thrust::unary_function<gdf_valid_type,gdf_valid_type>
 {
 
@@ -149,186 +94,280 @@ struct bit_or: public thrust::unary_function<thrust::tuple<gdf_valid_type,gdf_va
 		return thrust::get<0>(x) | thrust::get<1>(x);
 	}
 };
- 
 
-typedef thrust::transform_iterator<modulus_bit_width, thrust::counting_iterator<gdf_size_type> > bit_position_iterator;
 
+std::map<gdf_dtype, int16_t> column_type_width = {{GDF_INT8, sizeof(int8_t)}, {GDF_INT16, sizeof(int16_t)},{GDF_INT32, sizeof(int32_t)}, {GDF_INT64, sizeof(int64_t)},
+		{GDF_FLOAT32, sizeof(float)}, {GDF_FLOAT64, sizeof(double)} };
 
-template<typename stencil_type>
-struct is_stencil_true
-{
-	__host__ __device__
-	bool operator()(const thrust::tuple<stencil_type, gdf_valid_iterator::value_type, bit_position_iterator::value_type> value)
-	{
-		gdf_size_type position = thrust::get<2>(value);
 
-		return ((thrust::get<1>(value) >> position) & 1) && (thrust::get<0>(value) != 0);
-	}
-};
+namespace {
 
-struct is_bit_set
-{
-	__host__ __device__
-	bool operator()(const thrust::tuple< gdf_valid_iterator::value_type, bit_position_iterator::value_type> value)
-	{
-		gdf_size_type position = thrust::get<1>(value);
+constexpr int COMPACTION_BLOCK_SIZE = 256;
 
-		return ((thrust::get<0>(value) >> position) & 1);
-	}
-}; 
+// gridDim.y limits the number of columns compacted by a launch
+constexpr int MAX_COLUMNS_PER_LAUNCH = 65535;
 
-struct bit_mask_pack_op : public thrust::unary_function<int64_t,gdf_valid_type>
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief A column taking part in a compaction. The output validity is null if
+ * the output has no bitmask.
+ */
+/* ----------------------------------------------------------------------------*/
+struct compaction_column
 {
-	__host__ __device__
-		gdf_valid_type operator()(const int64_t expanded)
-		{
-			gdf_valid_type result = 0;
-			for(unsigned int i = 0; i < GDF_VALID_BITSIZE; i++){
-				// 0, 8, 16, ....,48,  56
-				unsigned char byte = (expanded >> ( (GDF_VALID_BITSIZE - 1 - i )  * 8));
-				result |= (byte & 1) << i;
-			}
-			return (result);
-		}
+	void const * input_data;
+	gdf_valid_type const * input_valid;
+	void * output_data;
+	gdf_valid_type * output_valid;
+	int width;
 };
 
+// A row is kept if its stencil value is non zero and not null
+struct stencil_is_true
+{
+	int8_t const * stencil;
+	gdf_valid_type const * stencil_valid;
 
-std::map<gdf_dtype, int16_t> column_type_width = {{GDF_INT8, sizeof(int8_t)}, {GDF_INT16, sizeof(int16_t)},{GDF_INT32, sizeof(int32_t)}, {GDF_INT64, sizeof(int64_t)},
-		{GDF_FLOAT32, sizeof(float)}, {GDF_FLOAT64, sizeof(double)} };
-
-//because applying a stencil only needs to know the WIDTH of a type for copying to output, we won't be making a bunch of templated version to store this but rather
-//storing a map from gdf_type to width
-//TODO: add a way for the space where we store temp bitmaps for compaction be allocated
-//on the outside
-gdf_error gdf_apply_stencil(gdf_column *lhs, gdf_column * stencil, gdf_column * output){
-	//OK: add a rquire here that output and lhs are the same size
-	GDF_REQUIRE(output->size == lhs->size, GDF_COLUMN_SIZE_MISMATCH);
-	GDF_REQUIRE(lhs->dtype == output->dtype, GDF_DTYPE_MISMATCH);
-    GDF_REQUIRE(!lhs->valid || !lhs->null_count, GDF_VALIDITY_UNSUPPORTED);
-
-	//find the width in bytes of this data type
-	auto searched_item = column_type_width.find(lhs->dtype);
-	int16_t width = searched_item->second; //width in bytes
-
-	searched_item = column_type_width.find(stencil->dtype);
-	int16_t stencil_width= searched_item->second; //width in bytes
+	__device__
+	bool operator()(gdf_index_type row) const
+	{
+		return (0 != stencil[row]) && gdf_is_valid(stencil_valid, row);
+	}
+};
 
-	cudaStream_t stream;
-	cudaStreamCreate(&stream);
+// A row is kept if its bit is set
+struct stencil_bit_is_set
+{
+	gdf_valid_type const * stencil;
 
-	size_t n_bytes = get_number_of_bytes_for_valid(stencil->size);
-
-	bit_position_iterator bit_position_iter(thrust::make_counting_iterator<gdf_size_type>(0), modulus_bit_width(n_bytes, stencil->size));
-	gdf_valid_iterator valid_iterator(thrust::detail::make_normal_iterator(thrust::device_pointer_cast(stencil->valid)),GDF_VALID_BITSIZE);
-	//TODO: can probably make this happen with some kind of iterator so it can work on any width size
-
-	//zip the stencil and the valid iterator together
-	typedef thrust::tuple<thrust::detail::normal_iterator<thrust::device_ptr<int8_t> >,gdf_valid_iterator, bit_position_iterator > zipped_stencil_tuple;
-	typedef thrust::zip_iterator<zipped_stencil_tuple> zipped_stencil_iterator;
-
-	//what kind of shit is that you might wonder?
-	//well basically we are zipping up an iterator to the stencil, one to the bit masks, and one which lets us get the bit position based on our index
-	zipped_stencil_iterator zipped_stencil_iter(
-			thrust::make_tuple(
-					thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int8_t * )stencil->data)),
-					valid_iterator,
-					thrust::make_transform_iterator<modulus_bit_width, thrust::counting_iterator<gdf_size_type> >(
-							thrust::make_counting_iterator<gdf_size_type>(0),
-							modulus_bit_width(n_bytes, stencil->size))
-			));
-
-	//NOTE!!!! the output column is getting set to a specific size  but we are NOT compacting the allocation,
-	//whoever calls that should handle that
-	if(width == 1){
-		thrust::detail::normal_iterator<thrust::device_ptr<int8_t> > input_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int8_t *) lhs->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int8_t> > output_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int8_t *) output->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int8_t> > output_end =
-				thrust::copy_if(rmm::exec_policy(stream)->on(stream),input_start,input_start + lhs->size,zipped_stencil_iter,output_start,is_stencil_true<thrust::detail::normal_iterator<thrust::device_ptr<int8_t> >::value_type >());
-		output->size = output_end - output_start;
-	}else if(width == 2){
-		thrust::detail::normal_iterator<thrust::device_ptr<int16_t> > input_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int16_t *) lhs->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int16_t> > output_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int16_t *) output->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int16_t> > output_end =
-				thrust::copy_if(rmm::exec_policy(stream)->on(stream),input_start,input_start + lhs->size,zipped_stencil_iter,output_start,is_stencil_true<thrust::detail::normal_iterator<thrust::device_ptr<int8_t> >::value_type >());
-		output->size = output_end - output_start;
-	}else if(width == 4){
-		thrust::detail::normal_iterator<thrust::device_ptr<int32_t> > input_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int32_t *) lhs->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int32_t> > output_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int32_t *) output->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int32_t> > output_end =
-				thrust::copy_if(rmm::exec_policy(stream)->on(stream),input_start,input_start + lhs->size,zipped_stencil_iter,output_start,is_stencil_true<thrust::detail::normal_iterator<thrust::device_ptr<int8_t> >::value_type >());
-		output->size = output_end - output_start;
-	}else if(width == 8){
-		thrust::detail::normal_iterator<thrust::device_ptr<int64_t> > input_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int64_t *) lhs->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int64_t> > output_start =
-				thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int64_t *) output->data));
-		thrust::detail::normal_iterator<thrust::device_ptr<int64_t> > output_end =
-				thrust::copy_if(rmm::exec_policy(stream)->on(stream),input_start,input_start + lhs->size,zipped_stencil_iter,output_start,is_stencil_true<thrust::detail::normal_iterator<thrust::device_ptr<int8_t> >::value_type >());
-		output->size = output_end - output_start;
+	__device__
+	bool operator()(gdf_index_type row) const
+	{
+		return gdf_is_valid(stencil, row);
 	}
+};
 
-	gdf_size_type num_values = lhs->size;
-	//TODO:BRING OVER THE BITMASK!!!
-	//need to store a prefix sum
-	//align to size 8
-	rmm::device_vector<gdf_valid_type> valid_bit_mask; //we are expanding the bit mask to an int8 because I can't envision an algorithm that operates on the bitmask that
-	if(num_values % GDF_VALID_BITSIZE != 0){
-		valid_bit_mask.resize(num_values + (GDF_VALID_BITSIZE - (num_values % GDF_VALID_BITSIZE))); //align this allocation on GDF_VALID_BITSIZE so we don't have to bounds check
-	}else{
-		valid_bit_mask.resize(num_values);
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Gathers the kept rows of a batch of columns, one column per
+ * blockIdx.y and one output row per thread, with their validity bits.
+ *
+ * The rows of a warp start at a multiple of 32, so the ballot of their
+ * validity is four whole bytes of the output bitmask.
+ *
+ * @param[in] columns The columns to compact
+ * @param[in] gather_map The input row of every output row
+ * @param[in] num_rows The number of output rows
+ * @param[out] null_counts Zeroed counters of the nulls of every output column
+ */
+/* ----------------------------------------------------------------------------*/
+__global__
+void compact_columns(compaction_column const * columns,
+                     gdf_index_type const * gather_map,
+                     gdf_size_type num_rows,
+                     gdf_size_type * null_counts)
+{
+	compaction_column const column = columns[blockIdx.y];
+	gdf_size_type const row = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+
+	bool is_valid{false};
+	if (row < num_rows) {
+		gdf_index_type const source = gather_map[row];
+		switch (column.width) {
+			case 1: static_cast<int8_t *>(column.output_data)[row] = static_cast<int8_t const *>(column.input_data)[source]; break;
+			case 2: static_cast<int16_t *>(column.output_data)[row] = static_cast<int16_t const *>(column.input_data)[source]; break;
+			case 4: static_cast<int32_t *>(column.output_data)[row] = static_cast<int32_t const *>(column.input_data)[source]; break;
+			case 8: static_cast<int64_t *>(column.output_data)[row] = static_cast<int64_t const *>(column.input_data)[source]; break;
+		}
+		is_valid = gdf_is_valid(column.input_valid, source);
 	}
 
-	// doesn't require the use for a prefix sum which will have size 8 * num rows which is much larger than this
+	// The column is the same for the whole block, so every lane takes part
+	if (nullptr != column.output_valid) {
+		uint32_t const bits = __ballot_sync(0xffffffff, is_valid);
+		int const lane = threadIdx.x % warpSize;
+		gdf_size_type const warp_row = row - lane;
+		if (lane < 4 && warp_row + lane * GDF_VALID_BITSIZE < num_rows) {
+			column.output_valid[warp_row / GDF_VALID_BITSIZE + lane] =
+				static_cast<gdf_valid_type>(bits >> (lane * GDF_VALID_BITSIZE));
+		}
+		if (0 == lane && warp_row < num_rows) {
+			gdf_size_type const warp_rows = min(gdf_size_type{32}, num_rows - warp_row);
+			atomicAdd(null_counts + blockIdx.y, warp_rows - __popc(bits));
+		}
+	}
+}
 
-	typedef thrust::tuple<gdf_valid_iterator, bit_position_iterator > mask_tuple;
-	typedef thrust::zip_iterator<mask_tuple> zipped_mask;
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Computes the input row of every kept row in one pass over the stencil
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename keep_row>
+void compute_gather_map(keep_row keep, gdf_size_type num_rows,
+                        rmm::device_vector<gdf_index_type> & gather_map, cudaStream_t stream)
+{
+	gather_map.resize(num_rows);
+	auto const end = thrust::copy_if(rmm::exec_policy(stream)->on(stream),
+	                                 thrust::make_counting_iterator<gdf_index_type>(0),
+	                                 thrust::make_counting_iterator<gdf_index_type>(num_rows),
+	                                 gather_map.begin(), keep);
+	gather_map.resize(end - gather_map.begin());
+}
 
+gdf_error get_compaction_width(gdf_column * column, int * width)
+{
+	GDF_REQUIRE(column->dtype > GDF_invalid && column->dtype < GDF_STRING, GDF_UNSUPPORTED_DTYPE);
+	return get_column_byte_width(column, width);
+}
 
-	zipped_mask  zipped_mask_iter(
-			thrust::make_tuple(
-					valid_iterator,
-					thrust::make_transform_iterator<modulus_bit_width, thrust::counting_iterator<gdf_size_type> >(
-							thrust::make_counting_iterator<gdf_size_type>(0),
-							modulus_bit_width(n_bytes, stencil->size))
-			)
-	);
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Compacts the input columns into output columns with room for the
+ * rows of the gather map, in one launch per MAX_COLUMNS_PER_LAUNCH columns.
+ * Sets the size and the null count of the outputs.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error compact_table(gdf_column * const input[], gdf_column * const output[], int num_cols,
+                        rmm::device_vector<gdf_index_type> const & gather_map, cudaStream_t stream)
+{
+	gdf_size_type const num_rows = gather_map.size();
+
+	std::vector<compaction_column> columns(num_cols);
+	for (int c = 0; c < num_cols; ++c) {
+		gdf_error status = get_compaction_width(input[c], &columns[c].width);
+		GDF_REQUIRE(GDF_SUCCESS == status, status);
+		columns[c].input_data = input[c]->data;
+		columns[c].input_valid = (input[c]->null_count > 0) ? input[c]->valid : nullptr;
+		columns[c].output_data = output[c]->data;
+		columns[c].output_valid = output[c]->valid;
+	}
 
-	typedef thrust::transform_iterator<is_bit_set, zipped_mask > bit_set_iterator;
-	bit_set_iterator bit_set_iter = thrust::make_transform_iterator<is_bit_set,zipped_mask>(
-			zipped_mask_iter,
-			is_bit_set()
-	);
+	std::vector<gdf_size_type> null_counts(num_cols, 0);
+	if (num_rows > 0) {
+		rmm::device_vector<compaction_column> d_columns(columns);
+		rmm::device_vector<gdf_size_type> d_null_counts(num_cols, 0);
+		gdf_size_type const grid_size = (num_rows + COMPACTION_BLOCK_SIZE - 1) / COMPACTION_BLOCK_SIZE;
+		for (int first = 0; first < num_cols; first += MAX_COLUMNS_PER_LAUNCH) {
+			dim3 const grid(grid_size, std::min(num_cols - first, MAX_COLUMNS_PER_LAUNCH));
+			compact_columns<<<grid, COMPACTION_BLOCK_SIZE, 0, stream>>>(
+				d_columns.data().get() + first, gather_map.data().get(), num_rows,
+				d_null_counts.data().get() + first);
+			CUDA_CHECK_LAST();
+		}
+		CUDA_TRY( cudaMemcpyAsync(null_counts.data(), d_null_counts.data().get(),
+		                          num_cols * sizeof(gdf_size_type), cudaMemcpyDeviceToHost, stream) );
+		CUDA_TRY( cudaStreamSynchronize(stream) );
+	}
 
-	//copy the bitmask to device_vector of int8
-	thrust::copy(rmm::exec_policy(stream)->on(stream), bit_set_iter, bit_set_iter + num_values, valid_bit_mask.begin());
+	for (int c = 0; c < num_cols; ++c) {
+		output[c]->size = num_rows;
+		output[c]->null_count = null_counts[c];
+	}
+	return GDF_SUCCESS;
+}
 
-	//remove the values that don't pass the stencil
-	thrust::remove_if(rmm::exec_policy(stream)->on(stream),valid_bit_mask.begin(), valid_bit_mask.begin() + num_values,zipped_stencil_iter, is_stencil_true<thrust::detail::normal_iterator<thrust::device_ptr<int8_t> >::value_type >());
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Allocates output columns for the rows of the gather map and compacts
+ * the input columns into them
+ *
+ * The outputs own a copy of the name of their input, allocated with malloc.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error compact_table_into_new_columns(gdf_column * const input[], gdf_column * const output[], int num_cols,
+                                         rmm::device_vector<gdf_index_type> const & gather_map, cudaStream_t stream)
+{
+	gdf_size_type const num_rows = gather_map.size();
+	for (int c = 0; c < num_cols; ++c) {
+		int width{0};
+		gdf_error status = get_compaction_width(input[c], &width);
+		GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+		void * data{nullptr};
+		gdf_valid_type * valid{nullptr};
+		if (num_rows > 0) {
+			RMM_TRY( RMM_ALLOC(&data, static_cast<size_t>(width) * num_rows, stream) );
+			if (nullptr != input[c]->valid) {
+				RMM_TRY( RMM_ALLOC((void**)&valid, gdf_get_num_chars_bitmask(num_rows), stream) );
+			}
+		}
+		gdf_column_view(output[c], data, valid, num_rows, input[c]->dtype);
+		output[c]->dtype_info = input[c]->dtype_info;
+		output[c]->col_name = nullptr;
+		if (nullptr != input[c]->col_name) {
+			output[c]->col_name = static_cast<char *>(malloc(strlen(input[c]->col_name) + 1));
+			strcpy(output[c]->col_name, input[c]->col_name);
+		}
+	}
+	return compact_table(input, output, num_cols, gather_map, stream);
+}
 
-	//recompact the values and store them in the output bitmask
-	//we can group them into pieces of 8 because we aligned this earlier on when we made the device_vector
-	thrust::detail::normal_iterator<thrust::device_ptr<int64_t> > valid_bit_mask_group_8_iter =
-			thrust::detail::make_normal_iterator(thrust::device_pointer_cast((int64_t *) valid_bit_mask.data().get()));
+gdf_error check_table(gdf_column * input[], int num_cols, gdf_column * output[])
+{
+	GDF_REQUIRE(num_cols > 0 && nullptr != input && nullptr != output, GDF_INVALID_API_CALL);
+	for (int c = 0; c < num_cols; ++c) {
+		GDF_REQUIRE(nullptr != input[c] && nullptr != output[c], GDF_DATASET_EMPTY);
+		GDF_REQUIRE(input[c]->size == input[0]->size, GDF_COLUMN_SIZE_MISMATCH);
+		GDF_REQUIRE(0 == input[c]->size || nullptr != input[c]->data, GDF_DATASET_EMPTY);
+		GDF_REQUIRE(input[c]->dtype > GDF_invalid && input[c]->dtype < GDF_STRING, GDF_UNSUPPORTED_DTYPE);
+	}
+	return GDF_SUCCESS;
+}
 
+gdf_error check_stencil(gdf_column * stencil, gdf_size_type size)
+{
+	GDF_REQUIRE(nullptr != stencil, GDF_DATASET_EMPTY);
+	GDF_REQUIRE(GDF_INT8 == stencil->dtype, GDF_UNSUPPORTED_DTYPE);
+	GDF_REQUIRE(size == stencil->size, GDF_COLUMN_SIZE_MISMATCH);
+	GDF_REQUIRE(0 == size || nullptr != stencil->data, GDF_DATASET_EMPTY);
+	return GDF_SUCCESS;
+}
 
-	//you may notice that we can write out more bytes than our valid_num_bytes, this only happens when we are not aligned to  GDF_VALID_BITSIZE bytes, becasue the
-	//arrow standard requires 64 byte alignment, this is a safe assumption to make
-	thrust::transform(rmm::exec_policy(stream)->on(stream), valid_bit_mask_group_8_iter, valid_bit_mask_group_8_iter + ((num_values + GDF_VALID_BITSIZE - 1) / GDF_VALID_BITSIZE),
-			thrust::detail::make_normal_iterator(thrust::device_pointer_cast(output->valid)),bit_mask_pack_op());
+} // end unnamed namespace
 
-	cudaStreamSynchronize(stream);
+//Compacts through a gather map computed once from the stencil; rows whose stencil value is null are removed.
+//The output keeps the size of its allocation but its size is set to the number of remaining rows
+gdf_error gdf_apply_stencil(gdf_column *lhs, gdf_column * stencil, gdf_column * output){
+	GDF_REQUIRE(nullptr != lhs && nullptr != output, GDF_DATASET_EMPTY);
+	GDF_REQUIRE(output->size == lhs->size, GDF_COLUMN_SIZE_MISMATCH);
+	GDF_REQUIRE(lhs->dtype == output->dtype, GDF_DTYPE_MISMATCH);
+	GDF_REQUIRE(!lhs->null_count || output->valid, GDF_VALIDITY_MISSING);
+	gdf_error status = check_table(&lhs, 1, &output);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+	status = check_stencil(stencil, lhs->size);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	cudaStream_t stream = 0;
+	rmm::device_vector<gdf_index_type> gather_map;
+	compute_gather_map(stencil_is_true{static_cast<int8_t const *>(stencil->data), stencil->valid},
+	                   lhs->size, gather_map, stream);
+	return compact_table(&lhs, &output, 1, gather_map, stream);
+}
 
-	cudaStreamDestroy(stream);
+gdf_error gdf_apply_stencil_table(gdf_column *input[], int num_cols, gdf_column *stencil, gdf_column *output[]){
+	gdf_error status = check_table(input, num_cols, output);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+	status = check_stencil(stencil, input[0]->size);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	cudaStream_t stream = 0;
+	rmm::device_vector<gdf_index_type> gather_map;
+	compute_gather_map(stencil_is_true{static_cast<int8_t const *>(stencil->data), stencil->valid},
+	                   input[0]->size, gather_map, stream);
+	return compact_table_into_new_columns(input, output, num_cols, gather_map, stream);
+}
 
-	return GDF_SUCCESS;
+gdf_error gdf_apply_bitmask_table(gdf_column *input[], int num_cols, gdf_valid_type *stencil, gdf_column *output[]){
+	gdf_error status = check_table(input, num_cols, output);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+	GDF_REQUIRE(0 == input[0]->size || nullptr != stencil, GDF_DATASET_EMPTY);
 
-} 
+	cudaStream_t stream = 0;
+	rmm::device_vector<gdf_index_type> gather_map;
+	compute_gather_map(stencil_bit_is_set{stencil}, input[0]->size, gather_map, stream);
+	return compact_table_into_new_columns(input, output, num_cols, gather_map, stream);
+}
 
 size_t  get_last_byte_length(size_t column_size) {
     size_t n_bytes = get_number_of_bytes_for_valid(column_size);
@@ -24,8 +24,10 @@
 #include "utilities/error_utils.h"
 #include "rmm/rmm.h"
 #include "utilities/type_dispatcher.hpp"
+#include "bitmask/bitmask_ops.h"
 #include <cuda_runtime_api.h>
 #include <algorithm>
+#include <vector>
 
 // forward decl -- see validops.cu
 gdf_error gdf_mask_concat(gdf_valid_type *output_mask,
@@ -110,10 +112,8 @@ gdf_error gdf_column_concat(gdf_column *output_column, gdf_column *columns_to_co
   }
   
   if (at_least_one_mask_present) {
-    gdf_valid_type** masks;
-    gdf_size_type* column_lengths;
-    CUDA_TRY( cudaMallocManaged((void**)&masks, sizeof(gdf_valid_type*)*num_columns) );
-    CUDA_TRY( cudaMallocManaged((void**)&column_lengths, sizeof(gdf_size_type)*num_columns) );
+    std::vector<gdf_valid_type*> masks(num_columns);
+    std::vector<gdf_size_type> column_lengths(num_columns);
 
     for (int i = 0; i < num_columns; ++i) {   
       masks[i] = columns_to_concat[i]->valid;
@@ -122,13 +122,10 @@ gdf_error gdf_column_concat(gdf_column *output_column, gdf_column *columns_to_co
   
     result = gdf_mask_concat(output_column->valid, 
                              output_column->size, 
-                             masks, 
-                             column_lengths, 
+                             masks.data(), 
+                             column_lengths.data(), 
                              num_columns);
 
-    CUDA_TRY( cudaFree(masks) );
-    CUDA_TRY( cudaFree(column_lengths) );
-
     return result;
   }
   else if (nullptr != output_column->valid) {
@@ -142,6 +139,110 @@ gdf_error gdf_column_concat(gdf_column *output_column, gdf_column *columns_to_co
   return GDF_SUCCESS;
 }
 
+namespace {
+  // The bitmask kernels load validity masks as 32 bit words, so a mask can
+  // only be shared if the slice starts on a word boundary
+  constexpr gdf_size_type SLICE_VALID_ALIGNMENT{32};
+
+  bool slice_shares_valid(gdf_column const * input, gdf_column const * slice)
+  {
+    if ((nullptr == input->valid) || (nullptr == slice->valid)) {
+      return true;
+    }
+    return (slice->valid >= input->valid) &&
+           (slice->valid < input->valid + gdf_get_num_chars_bitmask(input->size));
+  }
+}
+
+/** ---------------------------------------------------------------------------*
+ * @brief Creates a view of the rows [begin, end) of a column that shares the
+ * input's data buffer, and its validity bitmask when begin is word aligned.
+ *
+ * @param[in] input The column to slice
+ * @param[in] begin The first row of the slice
+ * @param[in] end One past the last row of the slice
+ * @param[out] output The slice
+ *
+ * @return gdf_error GDF_SUCCESS upon completion; GDF_DATASET_EMPTY if input or
+ *         output is NULL, GDF_INVALID_API_CALL if [begin, end) is not within
+ *         the input, GDF_UNSUPPORTED_DTYPE if the rows are not fixed width
+ * ---------------------------------------------------------------------------**/
+gdf_error gdf_column_slice(gdf_column *input, gdf_size_type begin, gdf_size_type end, gdf_column *output)
+{
+  GDF_REQUIRE(nullptr != input, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(nullptr != output, GDF_DATASET_EMPTY);
+  GDF_REQUIRE((0 <= begin) && (begin <= end) && (end <= input->size), GDF_INVALID_API_CALL);
+  // Only fixed-width rows can be addressed by offsetting the data pointer
+  GDF_REQUIRE((input->dtype > GDF_invalid) && (input->dtype < GDF_STRING), GDF_UNSUPPORTED_DTYPE);
+
+  int column_byte_width{0};
+  gdf_error result = get_column_byte_width(input, &column_byte_width);
+  GDF_REQUIRE(GDF_SUCCESS == result, result);
+
+  gdf_size_type const size{end - begin};
+
+  output->data = (nullptr == input->data) ? nullptr
+                 : static_cast<int8_t*>(input->data) + static_cast<size_t>(begin) * column_byte_width;
+  output->size = size;
+  output->dtype = input->dtype;
+  output->dtype_info = input->dtype_info;
+  output->col_name = input->col_name;
+  output->valid = nullptr;
+  output->null_count = 0;
+
+  if ((nullptr == input->valid) || (0 == size)) {
+    return GDF_SUCCESS;
+  }
+
+  bool const owns_valid = (0 != (begin % SLICE_VALID_ALIGNMENT));
+  if (!owns_valid) {
+    output->valid = input->valid + begin / GDF_VALID_BITSIZE;
+  }
+  else {
+    RMM_TRY( RMM_ALLOC((void**)&output->valid, sizeof(gdf_valid_type) * gdf_get_num_chars_bitmask(size), 0) );
+    result = bitmask_copy_offset(output->valid, 0, input->valid, begin, size, 0);
+  }
+
+  if ((GDF_SUCCESS == result) && (0 != input->null_count)) {
+    gdf_size_type valid_count{0};
+    result = bitmask_count_valid(output->valid, size, &valid_count, 0);
+    output->null_count = size - valid_count;
+  }
+
+  if ((GDF_SUCCESS != result) && owns_valid) {
+    RMM_FREE(output->valid, 0);
+    output->valid = nullptr;
+    output->null_count = 0;
+  }
+  return result;
+}
+
+/** ---------------------------------------------------------------------------*
+ * @brief Releases a slice created by gdf_column_slice, freeing its validity
+ * bitmask if it is not shared with the sliced column
+ *
+ * @param[in] input The column the slice was taken from
+ * @param[in,out] slice The slice to release
+ *
+ * @return gdf_error GDF_SUCCESS upon completion; GDF_DATASET_EMPTY if input or
+ *         slice is NULL
+ * ---------------------------------------------------------------------------**/
+gdf_error gdf_column_slice_free(gdf_column *input, gdf_column *slice)
+{
+  GDF_REQUIRE(nullptr != input, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(nullptr != slice, GDF_DATASET_EMPTY);
+
+  if (not slice_shares_valid(input, slice)) {
+    RMM_TRY( RMM_FREE(slice->valid, 0) );
+  }
+
+  slice->data = nullptr;
+  slice->valid = nullptr;
+  slice->size = 0;
+  slice->null_count = 0;
+  return GDF_SUCCESS;
+}
+
 /** ---------------------------------------------------------------------------*
  * @brief Return the size of the gdf_column data type.
  *
@@ -21,6 +21,7 @@
 #include "utilities/cudf_utils.h"
 #include "rmm/thrust_rmm_allocator.h"
 #include "utilities/error_utils.h"
+#include "bitmask/bit_mask.h"
 #include "hash/hash_functions.cuh"
 #include "hash/managed.cuh"
 #include "sqls/sqls_rtti_comp.h"
@@ -118,35 +119,21 @@ void scatter_valid_mask( gdf_valid_type const * const input_mask,
                          size_type const * const __restrict__ scatter_map,
                          size_type const num_rows)
 {
-  using mask_type = uint32_t;
-  constexpr uint32_t BITS_PER_MASK = 8 * sizeof(mask_type);
+  // The output is addressed as bit_mask_t, for which atomicOr is natively supported
+  bit_mask::bit_mask_t * const __restrict__ output_mask32 = reinterpret_cast<bit_mask::bit_mask_t * >(output_mask);
 
-  // Cast the validity type to a type where atomicOr is natively supported
-  const mask_type * __restrict__ input_mask32 = reinterpret_cast<mask_type const *>(input_mask);
-  mask_type * const __restrict__ output_mask32 = reinterpret_cast<mask_type * >(output_mask);
-
-  size_type row_number = threadIdx.x + blockIdx.x * blockDim.x;
+  size_type row_number = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
   while(row_number < num_rows)
   {
-    // Get the bit corresponding to the row
-    const mask_type input_bit = input_mask32[row_number/BITS_PER_MASK] & (static_cast<mask_type>(1) << (row_number % BITS_PER_MASK));
-
     // Only scatter the input bit if it is valid
-    if(input_bit > 0)
+    if(gdf_is_valid(input_mask, row_number))
     {
-      const size_type output_row = scatter_map[row_number];
-      // Set the according output bit
-      const mask_type output_bit = static_cast<mask_type>(1) << (output_row % BITS_PER_MASK);
-
-      // Find the mask in the output that will hold the bit for the scattered row
-      const size_type output_location = output_row / BITS_PER_MASK;
-
-      // Bitwise OR to set the scattered row's bit
-      atomicOr(&output_mask32[output_location], output_bit);
+      // Different rows may scatter into the same output element
+      bit_mask::set_bit_safe(output_mask32, scatter_map[row_number]);
     }
 
-    row_number += blockDim.x * gridDim.x;
+    row_number += static_cast<size_type>(blockDim.x) * gridDim.x;
   }
 }
 
@@ -155,11 +142,17 @@ void scatter_valid_mask( gdf_valid_type const * const input_mask,
  * @brief  Gathers a validity bitmask.
  * 
  * This kernel is used in order to gather the validity bit mask for a gdf_column.
+ *
+ * Every warp gathers the bits of 32 consecutive output rows and assembles them
+ * into a single bit_mask_t with a ballot, which the first lane stores. Whole
+ * output words are written without atomics, so the output does not need to be
+ * cleared beforehand. The block size must be a multiple of the warp size.
  * 
  * @param input_mask The mask that will be gathered.
  * @param output_mask The output after gathering the input
  * @param gather_map The map that indicates where elements from the input
-   will be gathered to in the output. output_bit[ gather_map [i] ] = input_bit[i]
+   will be gathered to in the output. output_bit[i] = input_bit[ gather_map [i] ].
+   Rows gathered from outside of the input are null.
  * @param num_rows The number of bits expected in the output masks
  * @param input_mask_length The number of bits in the input mask
  */
@@ -172,45 +165,35 @@ void gather_valid_mask( gdf_valid_type const * const input_mask,
                         index_type const num_rows,
                         index_type const input_mask_length)
 {
-  using mask_type = uint32_t;
-  constexpr uint32_t BITS_PER_MASK = 8 * sizeof(mask_type);
+  static_assert(bit_mask::detail::BITS_PER_ELEMENT == 32, "One ballot must fill one bit_mask_t");
+
+  index_type row_number = threadIdx.x + static_cast<index_type>(blockIdx.x) * blockDim.x;
 
-  // Cast the validity type to a type where atomicOr is natively supported
-  const mask_type * __restrict__ input_mask32 = reinterpret_cast<mask_type const *>(input_mask);
-  mask_type * const __restrict__ output_mask32 = reinterpret_cast<mask_type * >(output_mask);
+  // The loop condition must be uniform across the warp for the ballot
+  index_type warp_first_row = row_number - (threadIdx.x % warpSize);
+  index_type const stride = static_cast<index_type>(blockDim.x) * gridDim.x;
 
-  index_type row_number = threadIdx.x + blockIdx.x * blockDim.x;
+  gdf_size_type const output_bytes = gdf_get_num_chars_bitmask(num_rows);
 
   ValidRange<index_type> valid(0, input_mask_length);
-  while(row_number < num_rows)
+  while(warp_first_row < num_rows)
   {
-    const index_type gather_location = gather_map[row_number];
-    if (!valid(gather_location)) {
-        row_number += blockDim.x * gridDim.x; continue;
+    bool output_is_valid{false};
+    if(row_number < num_rows)
+    {
+      const index_type gather_location = gather_map[row_number];
+      output_is_valid = valid(gather_location) && gdf_is_valid(input_mask, gather_location);
     }
 
-    // Get the bit corresponding from the gathered row
-    // FIXME Replace with a standard `get_bit` function
-    mask_type input_bit = (static_cast<mask_type>(1) << (gather_location % BITS_PER_MASK));
-    if (nullptr != input_mask) {
-        input_bit = input_bit & input_mask32[gather_location/BITS_PER_MASK];
-    }
+    bit_mask::bit_mask_t const output_bits = __ballot_sync(0xffffffff, output_is_valid);
 
-    // Only set the output bit if the input is valid
-    if(input_bit > 0)
+    if(0 == (threadIdx.x % warpSize))
     {
-      // FIXME Replace with a standard `set_bit` function
-      // Construct the mask that sets the bit for the output row
-      const mask_type output_bit = static_cast<mask_type>(1) << (row_number % BITS_PER_MASK);
-
-      // Find the mask in the output that will hold the bit for output row
-      const index_type output_location = row_number / BITS_PER_MASK;
-
-      // Bitwise OR to set the gathered row's bit
-      atomicOr(&output_mask32[output_location], output_bit);
+      bit_mask::store_element(output_mask, bit_mask::detail::which_element(row_number), output_bytes, output_bits);
     }
 
-    row_number += blockDim.x * gridDim.x;
+    row_number += stride;
+    warp_first_row += stride;
   }
 }
 
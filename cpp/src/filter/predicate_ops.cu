@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "cudf.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "rmm/thrust_rmm_allocator.h"
+
+#include <cuda_runtime.h>
+#include <cub/block/block_reduce.cuh>
+#include <vector>
+
+namespace {
+
+constexpr int PREDICATE_BLOCK_SIZE = 256;
+
+// The operands of the open AND/OR nodes are kept one bit each in a uint64_t
+constexpr int MAX_PREDICATE_DEPTH = 64;
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief A value of a row or a constant, compared as floating point if either
+ * side of a comparison is floating point and as an integer otherwise
+ */
+/* ----------------------------------------------------------------------------*/
+struct operand
+{
+	int64_t integer;
+	double real;
+	bool is_real;
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief A leaf of the predicate with its columns resolved. The validity
+ * pointers are null for columns without nulls.
+ */
+/* ----------------------------------------------------------------------------*/
+struct predicate_term
+{
+	gdf_predicate_kind kind;
+	gdf_comparison_operator op;
+	void const * data;
+	gdf_valid_type const * valid;
+	gdf_dtype dtype;
+	void const * other_data;
+	gdf_valid_type const * other_valid;
+	gdf_dtype other_dtype;
+	int first_value;
+	int num_values;
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief The instructions the predicate tree is compiled into.
+ *
+ * AND(l, r) becomes `l; AND_SKIP end; PUSH; r; POP_AND; end:`, where AND_SKIP
+ * jumps when l is false for the whole warp, and OR(l, r) the same with OR_SKIP
+ * jumping when l is true for all rows of the warp.
+ */
+/* ----------------------------------------------------------------------------*/
+enum opcode : int
+{
+	EVALUATE_TERM,  /**< Sets the accumulator to the term of the operand */
+	AND_SKIP,       /**< Jumps to the operand if no row of the warp is true */
+	OR_SKIP,        /**< Jumps to the operand if every row of the warp is true */
+	PUSH,           /**< Pushes the accumulator */
+	POP_AND,        /**< Pops a bit and ANDs it into the accumulator */
+	POP_OR,         /**< Pops a bit and ORs it into the accumulator */
+};
+
+struct instruction
+{
+	opcode code;
+	int operand;
+};
+
+struct predicate_program
+{
+	std::vector<instruction> code;
+	std::vector<predicate_term> terms;
+	std::vector<operand> values;
+};
+
+bool is_real(gdf_dtype dtype)
+{
+	return GDF_FLOAT32 == dtype || GDF_FLOAT64 == dtype;
+}
+
+bool is_fixed_width(gdf_dtype dtype)
+{
+	return dtype > GDF_invalid && dtype < GDF_STRING;
+}
+
+__device__
+operand load_operand(void const * data, gdf_dtype dtype, gdf_size_type row)
+{
+	operand value{0, 0., false};
+	switch (dtype) {
+		case GDF_INT8: value.integer = static_cast<int8_t const *>(data)[row]; break;
+		case GDF_INT16: value.integer = static_cast<int16_t const *>(data)[row]; break;
+		case GDF_INT32:
+		case GDF_DATE32:
+		case GDF_CATEGORY: value.integer = static_cast<int32_t const *>(data)[row]; break;
+		case GDF_INT64:
+		case GDF_DATE64:
+		case GDF_TIMESTAMP: value.integer = static_cast<int64_t const *>(data)[row]; break;
+		case GDF_FLOAT32: value.real = static_cast<float const *>(data)[row]; value.is_real = true; break;
+		case GDF_FLOAT64: value.real = static_cast<double const *>(data)[row]; value.is_real = true; break;
+		default: break;
+	}
+	return value;
+}
+
+template <typename T>
+__device__
+bool apply_operator(T lhs, T rhs, gdf_comparison_operator op)
+{
+	switch (op) {
+		case GDF_EQUALS: return lhs == rhs;
+		case GDF_NOT_EQUALS: return lhs != rhs;
+		case GDF_LESS_THAN: return lhs < rhs;
+		case GDF_LESS_THAN_OR_EQUALS: return lhs <= rhs;
+		case GDF_GREATER_THAN: return lhs > rhs;
+		case GDF_GREATER_THAN_OR_EQUALS: return lhs >= rhs;
+	}
+	return false;
+}
+
+__device__
+bool compare(operand const & lhs, operand const & rhs, gdf_comparison_operator op)
+{
+	if (lhs.is_real || rhs.is_real) {
+		double const l = lhs.is_real ? lhs.real : static_cast<double>(lhs.integer);
+		double const r = rhs.is_real ? rhs.real : static_cast<double>(rhs.integer);
+		return apply_operator(l, r, op);
+	}
+	return apply_operator(lhs.integer, rhs.integer, op);
+}
+
+__device__
+bool evaluate_term(predicate_term const & term, operand const * values, gdf_size_type row)
+{
+	bool const is_valid = gdf_is_valid(term.valid, row);
+	switch (term.kind) {
+		case GDF_PREDICATE_IS_NULL: return !is_valid;
+		case GDF_PREDICATE_IS_NOT_NULL: return is_valid;
+		default: break;
+	}
+	if (!is_valid) {
+		return false;
+	}
+
+	operand const value = load_operand(term.data, term.dtype, row);
+	switch (term.kind) {
+		case GDF_PREDICATE_COMPARE:
+			return compare(value, values[term.first_value], term.op);
+		case GDF_PREDICATE_COMPARE_COLUMNS:
+			return gdf_is_valid(term.other_valid, row) &&
+			       compare(value, load_operand(term.other_data, term.other_dtype, row), term.op);
+		case GDF_PREDICATE_IN:
+			for (int i = 0; i < term.num_values; ++i) {
+				if (compare(value, values[term.first_value + i], GDF_EQUALS)) {
+					return true;
+				}
+			}
+			return false;
+		case GDF_PREDICATE_BETWEEN:
+			return compare(value, values[term.first_value], GDF_GREATER_THAN_OR_EQUALS) &&
+			       compare(value, values[term.first_value + 1], GDF_LESS_THAN_OR_EQUALS);
+		default:
+			return false;
+	}
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Runs the predicate program with one row per thread and writes the
+ * result of every warp as four whole bytes of the output bitmask. The true
+ * rows are counted per block, with one atomic per block.
+ *
+ * The warp is also the unit of short-circuiting: the right operand of an
+ * AND/OR is skipped when the left one decides all 32 rows. Every lane runs
+ * the program, so the votes see the whole warp, and rows past the end are
+ * false.
+ *
+ * @param[in] program The instructions
+ * @param[in] program_size The number of instructions
+ * @param[in] terms The leaves of the predicate
+ * @param[in] values The constants of the leaves
+ * @param[in] num_rows The number of rows
+ * @param[out] output The bitmask of the rows that satisfy the predicate
+ * @param[out] num_true Zeroed counter of those rows
+ */
+/* ----------------------------------------------------------------------------*/
+__global__
+void evaluate_predicate(instruction const * program, int program_size,
+                        predicate_term const * terms, operand const * values,
+                        gdf_size_type num_rows, gdf_valid_type * output,
+                        unsigned long long * num_true)
+{
+	using BlockReduce = cub::BlockReduce<unsigned long long, PREDICATE_BLOCK_SIZE>;
+	__shared__ typename BlockReduce::TempStorage temp_storage;
+
+	gdf_size_type const row = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+	bool const in_range = row < num_rows;
+
+	bool result{false};
+	uint64_t stack{0};
+	int pc{0};
+	while (pc < program_size) {
+		instruction const current = program[pc++];
+		switch (current.code) {
+			case EVALUATE_TERM:
+				result = in_range && evaluate_term(terms[current.operand], values, row);
+				break;
+			case AND_SKIP:
+				if (!__any_sync(0xffffffff, result)) pc = current.operand;
+				break;
+			case OR_SKIP:
+				if (__all_sync(0xffffffff, result || !in_range)) pc = current.operand;
+				break;
+			case PUSH:
+				stack = (stack << 1) | result;
+				break;
+			case POP_AND:
+				result = result && (stack & 1);
+				stack >>= 1;
+				break;
+			case POP_OR:
+				result = result || (stack & 1);
+				stack >>= 1;
+				break;
+		}
+	}
+
+	uint32_t const bits = __ballot_sync(0xffffffff, result);
+	int const lane = threadIdx.x % warpSize;
+	gdf_size_type const warp_row = row - lane;
+	if (lane < 4 && warp_row + lane * GDF_VALID_BITSIZE < num_rows) {
+		output[warp_row / GDF_VALID_BITSIZE + lane] = static_cast<gdf_valid_type>(bits >> (lane * GDF_VALID_BITSIZE));
+	}
+
+	unsigned long long const warp_count = (0 == lane) ? __popc(bits) : 0;
+	unsigned long long const block_count{BlockReduce(temp_storage).Sum(warp_count)};
+	if (0 == threadIdx.x && 0 != block_count) {
+		atomicAdd(num_true, block_count);
+	}
+}
+
+gdf_error check_columns(gdf_column * cols[], int ncols)
+{
+	GDF_REQUIRE(ncols > 0 && nullptr != cols, GDF_INVALID_API_CALL);
+	for (int c = 0; c < ncols; ++c) {
+		GDF_REQUIRE(nullptr != cols[c], GDF_DATASET_EMPTY);
+		GDF_REQUIRE(cols[c]->size == cols[0]->size, GDF_COLUMN_SIZE_MISMATCH);
+		GDF_REQUIRE(is_fixed_width(cols[c]->dtype), GDF_UNSUPPORTED_DTYPE);
+		GDF_REQUIRE(0 == cols[c]->size || nullptr != cols[c]->data, GDF_DATASET_EMPTY);
+	}
+	return GDF_SUCCESS;
+}
+
+// Checks a node refers to existing columns, constants and earlier nodes, none
+// of which is an operand of another node. Compiling copies the subtree of an
+// operand, so shared nodes could grow the program exponentially.
+gdf_error check_predicate(gdf_predicate const & node, int index, int ncols,
+                          std::vector<bool> & is_operand)
+{
+	GDF_REQUIRE(node.kind >= GDF_PREDICATE_COMPARE && node.kind <= GDF_PREDICATE_OR, GDF_INVALID_API_CALL);
+	if (GDF_PREDICATE_AND == node.kind || GDF_PREDICATE_OR == node.kind) {
+		GDF_REQUIRE(node.left >= 0 && node.left < index, GDF_INVALID_API_CALL);
+		GDF_REQUIRE(node.right >= 0 && node.right < index, GDF_INVALID_API_CALL);
+		GDF_REQUIRE(node.left != node.right && !is_operand[node.left] && !is_operand[node.right],
+		            GDF_INVALID_API_CALL);
+		is_operand[node.left] = true;
+		is_operand[node.right] = true;
+		return GDF_SUCCESS;
+	}
+
+	GDF_REQUIRE(node.column >= 0 && node.column < ncols, GDF_INVALID_API_CALL);
+	switch (node.kind) {
+		case GDF_PREDICATE_COMPARE_COLUMNS:
+			GDF_REQUIRE(node.other_column >= 0 && node.other_column < ncols, GDF_INVALID_API_CALL);
+			// fall through
+		case GDF_PREDICATE_COMPARE:
+			GDF_REQUIRE(node.op >= GDF_EQUALS && node.op <= GDF_GREATER_THAN_OR_EQUALS, GDF_INVALID_API_CALL);
+			break;
+		default:
+			break;
+	}
+
+	int min_values{0};
+	switch (node.kind) {
+		case GDF_PREDICATE_COMPARE: min_values = 1; break;
+		case GDF_PREDICATE_BETWEEN: min_values = 2; break;
+		default: break;
+	}
+	GDF_REQUIRE(node.num_values >= min_values, GDF_INVALID_API_CALL);
+	GDF_REQUIRE(0 == node.num_values || nullptr != node.values, GDF_INVALID_API_CALL);
+	return GDF_SUCCESS;
+}
+
+gdf_error add_term(gdf_column * cols[], gdf_predicate const & node, predicate_program & program)
+{
+	predicate_term term{};
+	term.kind = node.kind;
+	term.op = node.op;
+	term.data = cols[node.column]->data;
+	term.valid = (cols[node.column]->null_count > 0) ? cols[node.column]->valid : nullptr;
+	term.dtype = cols[node.column]->dtype;
+	if (GDF_PREDICATE_COMPARE_COLUMNS == node.kind) {
+		gdf_column const * other = cols[node.other_column];
+		term.other_data = other->data;
+		term.other_valid = (other->null_count > 0) ? other->valid : nullptr;
+		term.other_dtype = other->dtype;
+	}
+
+	int num_values{0};
+	switch (node.kind) {
+		case GDF_PREDICATE_COMPARE: num_values = 1; break;
+		case GDF_PREDICATE_BETWEEN: num_values = 2; break;
+		case GDF_PREDICATE_IN: num_values = node.num_values; break;
+		default: break;
+	}
+	term.first_value = program.values.size();
+	term.num_values = num_values;
+	for (int i = 0; i < num_values; ++i) {
+		gdf_predicate_value const & value = node.values[i];
+		GDF_REQUIRE(is_fixed_width(value.dtype), GDF_UNSUPPORTED_DTYPE);
+		program.values.push_back(operand{value.integer, value.real, is_real(value.dtype)});
+	}
+
+	program.code.push_back(instruction{EVALUATE_TERM, static_cast<int>(program.terms.size())});
+	program.terms.push_back(term);
+	return GDF_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief A node being compiled and how far: its left operand is compiled
+ * next, then its right operand, then it is closed
+ */
+/* ----------------------------------------------------------------------------*/
+struct compile_frame
+{
+	enum stage_kind { COMPILE_LEFT, COMPILE_RIGHT, CLOSE };
+	int node;
+	int depth;
+	stage_kind stage;
+	size_t skip;
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Compiles the tree of a node, whose operands are checked to come
+ * before it and to belong to no other node.
+ *
+ * The tree is walked with an explicit stack, so a deep chain of nodes cannot
+ * overflow the host stack. Only the nesting of right operands takes a bit of
+ * the stack of the kernel, and is limited to MAX_PREDICATE_DEPTH.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error compile(gdf_column * cols[], gdf_predicate const * predicates, int root,
+                  predicate_program & program)
+{
+	std::vector<compile_frame> frames{compile_frame{root, 0, compile_frame::COMPILE_LEFT, 0}};
+	while (!frames.empty()) {
+		compile_frame & frame = frames.back();
+		gdf_predicate const & current = predicates[frame.node];
+		bool const is_and = (GDF_PREDICATE_AND == current.kind);
+		if (!is_and && GDF_PREDICATE_OR != current.kind) {
+			gdf_error const status = add_term(cols, current, program);
+			GDF_REQUIRE(GDF_SUCCESS == status, status);
+			frames.pop_back();
+			continue;
+		}
+
+		switch (frame.stage) {
+			case compile_frame::COMPILE_LEFT: {
+				GDF_REQUIRE(frame.depth < MAX_PREDICATE_DEPTH, GDF_INVALID_API_CALL);
+				frame.stage = compile_frame::COMPILE_RIGHT;
+				compile_frame const left{current.left, frame.depth, compile_frame::COMPILE_LEFT, 0};
+				frames.push_back(left);
+				break;
+			}
+			case compile_frame::COMPILE_RIGHT: {
+				frame.skip = program.code.size();
+				frame.stage = compile_frame::CLOSE;
+				program.code.push_back(instruction{is_and ? AND_SKIP : OR_SKIP, 0});
+				program.code.push_back(instruction{PUSH, 0});
+				compile_frame const right{current.right, frame.depth + 1, compile_frame::COMPILE_LEFT, 0};
+				frames.push_back(right);
+				break;
+			}
+			case compile_frame::CLOSE:
+				program.code.push_back(instruction{is_and ? POP_AND : POP_OR, 0});
+				program.code[frame.skip].operand = static_cast<int>(program.code.size());
+				frames.pop_back();
+				break;
+		}
+	}
+	return GDF_SUCCESS;
+}
+
+} // namespace
+
+gdf_error gdf_evaluate_predicate(gdf_column *cols[], int ncols,
+                                 gdf_predicate const *predicates, int num_predicates,
+                                 gdf_valid_type *output, gdf_size_type *num_true)
+{
+	gdf_error status = check_columns(cols, ncols);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+	GDF_REQUIRE(num_predicates > 0 && nullptr != predicates && nullptr != num_true, GDF_INVALID_API_CALL);
+	std::vector<bool> is_operand(num_predicates, false);
+	for (int i = 0; i < num_predicates; ++i) {
+		status = check_predicate(predicates[i], i, ncols, is_operand);
+		GDF_REQUIRE(GDF_SUCCESS == status, status);
+	}
+
+	predicate_program program;
+	status = compile(cols, predicates, num_predicates - 1, program);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	gdf_size_type const num_rows = cols[0]->size;
+	*num_true = 0;
+	if (0 == num_rows) {
+		return GDF_SUCCESS;
+	}
+	GDF_REQUIRE(nullptr != output, GDF_DATASET_EMPTY);
+
+	cudaStream_t stream = 0;
+	rmm::device_vector<instruction> d_code(program.code);
+	rmm::device_vector<predicate_term> d_terms(program.terms);
+	rmm::device_vector<operand> d_values(program.values);
+	rmm::device_vector<unsigned long long> d_num_true(1, 0);
+
+	gdf_size_type const grid_size = (num_rows + PREDICATE_BLOCK_SIZE - 1) / PREDICATE_BLOCK_SIZE;
+	evaluate_predicate<<<grid_size, PREDICATE_BLOCK_SIZE, 0, stream>>>(
+		d_code.data().get(), static_cast<int>(d_code.size()), d_terms.data().get(), d_values.data().get(),
+		num_rows, output, d_num_true.data().get());
+	CUDA_CHECK_LAST();
+
+	unsigned long long h_num_true{0};
+	CUDA_TRY( cudaMemcpyAsync(&h_num_true, d_num_true.data().get(), sizeof(unsigned long long),
+	                          cudaMemcpyDeviceToHost, stream) );
+	CUDA_TRY( cudaStreamSynchronize(stream) );
+	*num_true = static_cast<gdf_size_type>(h_num_true);
+	return GDF_SUCCESS;
+}
+
+gdf_error gdf_filter_predicate(gdf_column *cols[], int ncols,
+                               gdf_predicate const *predicates, int num_predicates,
+                               gdf_column *output[])
+{
+	gdf_error status = check_columns(cols, ncols);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	rmm::device_vector<gdf_valid_type> mask(gdf_get_num_chars_bitmask(cols[0]->size));
+	gdf_size_type num_true{0};
+	status = gdf_evaluate_predicate(cols, ncols, predicates, num_predicates, mask.data().get(), &num_true);
+	GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+	return gdf_apply_bitmask_table(cols, ncols, mask.data().get(), output);
+}
@@ -28,6 +28,7 @@
 #include "hash_groupby_kernels.cuh"
 #include "dataframe/cudf_table.cuh"
 #include "rmm/thrust_rmm_allocator.h"
+#include "utilities/allocator.hpp"
 
 
 
@@ -183,7 +184,7 @@ gdf_error GroupbyHash(gdf_table<size_type> const & groupby_input_table,
 
   // Used by threads to coordinate where to write their results
   size_type * global_write_index{nullptr};
-  RMM_TRY(RMM_ALLOC((void**)&global_write_index, sizeof(size_type), 0)); // TODO: non-default stream?
+  SCRATCH_ALLOC_TRY(&global_write_index, sizeof(size_type), 0); // TODO: non-default stream?
   CUDA_TRY(cudaMemset(global_write_index, 0, sizeof(size_type)));
 
   const dim3 extract_grid_size ((hash_table_size + THREAD_BLOCK_SIZE - 1) / THREAD_BLOCK_SIZE, 1, 1);
@@ -202,18 +203,18 @@ gdf_error GroupbyHash(gdf_table<size_type> const & groupby_input_table,
   // At the end of the extraction kernel, the global write index will be equal to
   // the size of the output. Update the output size.
   CUDA_TRY( cudaMemcpy(out_size, global_write_index, sizeof(size_type), cudaMemcpyDeviceToHost) );
-  RMM_TRY( RMM_FREE(global_write_index, 0) );
+  SCRATCH_FREE_TRY(global_write_index, 0);
   groupby_output_table.set_column_length(*out_size);
 
   // Optionally sort the groupby/aggregation result columns
   if(true == sort_result) {
 
-      rmm::device_vector<int32_t> sorted_indices(*out_size);
+      rmm::device_vector<gdf_index_type> sorted_indices(*out_size);
       thrust::sequence(rmm::exec_policy()->on(0), sorted_indices.begin(), sorted_indices.end());
 
       gdf_column sorted_indices_col;
       gdf_error status = gdf_column_view(&sorted_indices_col, (void*)thrust::raw_pointer_cast(sorted_indices.data()), 
-                            nullptr, *out_size, GDF_INT32);
+                            nullptr, *out_size, GDF_INDEX_DTYPE);
       if (status != GDF_SUCCESS)
         return status;
 
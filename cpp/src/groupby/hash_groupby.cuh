@@ -205,13 +205,14 @@ gdf_error dispatch_aggregation_type(gdf_table<size_type> const & groupby_input_t
  * @param[in,out] out_groupby_columns[] A preallocated buffer to store the resultant group-by columns
  * @param[in,out] out_aggregation_column A preallocated buffer to store the resultant aggregation column
  * @tparam[in] aggregation_operation A functor that defines the aggregation operation
+ * @tparam size_type The type used for row counts and indices
  * 
  * @returns gdf_error
  */
 /* ----------------------------------------------------------------------------*/
 template <template <typename aggregation_type> class aggregation_operation,
-          typename size_type>
-gdf_error gdf_group_by_hash(size_type ncols,               
+          typename size_type = gdf_size_type>
+gdf_error gdf_group_by_hash(int ncols,               
                             gdf_column* in_groupby_columns[],        
                             gdf_column* in_aggregation_column,       
                             gdf_column* out_groupby_columns[],
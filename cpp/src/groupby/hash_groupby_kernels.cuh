@@ -52,7 +52,7 @@ __global__ void build_aggregation_table(map_type * const __restrict__ the_map,
                                         aggregation_operation op,
                                         row_comparator the_comparator)
 {
-  size_type i = threadIdx.x + blockIdx.x * blockDim.x;
+  size_type i = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
   while( i < column_size ){
 
@@ -70,7 +70,7 @@ __global__ void build_aggregation_table(map_type * const __restrict__ the_map,
                     true,
                     row_hash);
 
-    i += blockDim.x * gridDim.x;
+    i += static_cast<size_type>(blockDim.x) * gridDim.x;
   }
 }
 
@@ -86,7 +86,7 @@ __global__ void build_aggregation_table(map_type * const __restrict__ the_map,
                                         count_op<typename map_type::mapped_type> op,
                                         row_comparator the_comparator)
 {
-  size_type i = threadIdx.x + blockIdx.x * blockDim.x;
+  size_type i = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
   // Hash the current row of the input table
   const auto row_hash = groupby_input_table.hash_row(i);
@@ -104,7 +104,7 @@ __global__ void build_aggregation_table(map_type * const __restrict__ the_map,
                     the_comparator,
                     true,
                     row_hash);
-    i += blockDim.x * gridDim.x;
+    i += static_cast<size_type>(blockDim.x) * gridDim.x;
   }
 }
 
@@ -133,7 +133,7 @@ __global__ void extract_groupby_result(const map_type * const __restrict__ the_m
                                        aggregation_type * const __restrict__ aggregation_out_column,
                                        size_type * const global_write_index)
 {
-  size_type i = threadIdx.x + blockIdx.x * blockDim.x;
+  size_type i = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
   constexpr typename map_type::key_type unused_key{map_type::get_unused_key()};
 
@@ -156,7 +156,7 @@ __global__ void extract_groupby_result(const map_type * const __restrict__ the_m
 
       aggregation_out_column[thread_write_index] = hashtabl_values[i].second;
     }
-    i += gridDim.x * blockDim.x;
+    i += static_cast<size_type>(gridDim.x) * blockDim.x;
   }
 }
 #endif
@@ -120,15 +120,26 @@ gdf_error gdf_hash_columns(gdf_column ** columns_to_hash, int num_columns, gdf_c
 			op);
 
 
-	all_bitmask_on(output_column->valid, output_column->null_count, num_values,*stream);
-	//and all of the bitmaps together
-
+	//and all of the bitmaps together in a single pass
+	std::vector<gdf_valid_type const *> masks_with_nulls;
 	for(int i = 0; i < num_columns; i++){
 		if(columns_to_hash[i]->null_count > 0){
-			apply_bitmask_to_bitmask( output_column->null_count,
-						output_column->valid, output_column->valid,
-						columns_to_hash[i]->valid, *stream, num_values);
+			masks_with_nulls.push_back(columns_to_hash[i]->valid);
+		}
+	}
+
+	gdf_error mask_error = GDF_SUCCESS;
+	if(masks_with_nulls.empty()){
+		mask_error = all_bitmask_on(output_column->valid, output_column->null_count, num_values,*stream);
+	}else{
+		mask_error = bitmask_combine(output_column->valid, masks_with_nulls.data(),
+				masks_with_nulls.size(), num_values, bitmask_op::AND, *stream);
+
+		gdf_size_type valid_count{0};
+		if(mask_error == GDF_SUCCESS){
+			mask_error = bitmask_count_valid(output_column->valid, num_values, &valid_count, *stream);
 		}
+		output_column->null_count = num_values - valid_count;
 	}
 	
 	RMM_TRY( RMM_FREE(widths, *stream) ); 
@@ -141,5 +152,5 @@ gdf_error gdf_hash_columns(gdf_column ** columns_to_hash, int num_columns, gdf_c
 		cudaStreamDestroy(temp_stream);
 	}
 
-	return GDF_SUCCESS;
+	return mask_error;
 }
@@ -14,19 +14,29 @@
  * limitations under the License.
  */
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <thrust/tabulate.h>
 
 #include "cudf.h"
 #include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
 #include "join/joining.h"
 #include "dataframe/cudf_table.cuh"
 #include "hash/hash_functions.cuh"
 #include "utilities/int_fastdiv.h"
 #include "utilities/nvtx/nvtx_utils.h"
-
-constexpr int BLOCK_SIZE = 256;
-constexpr int ROWS_PER_THREAD = 1;
+#include "partition/partition_scatter.cuh"
 
 /* --------------------------------------------------------------------------*/
 /** 
@@ -277,7 +287,7 @@ void compute_row_partition_numbers(gdf_table<size_type> const & the_table,
   // Accumulate histogram of the size of each partition in shared memory
   extern __shared__ size_type shared_partition_sizes[];
 
-  size_type row_number = threadIdx.x + blockIdx.x * blockDim.x;
+  size_type row_number = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
   // Initialize local histogram
   size_type partition_number = threadIdx.x;
@@ -304,7 +314,7 @@ void compute_row_partition_numbers(gdf_table<size_type> const & the_table,
 
     atomicAdd(&(shared_partition_sizes[partition_number]), size_type(1));
 
-    row_number += blockDim.x * gridDim.x;
+    row_number += static_cast<size_type>(blockDim.x) * gridDim.x;
   }
 
   __syncthreads();
@@ -325,65 +335,6 @@ void compute_row_partition_numbers(gdf_table<size_type> const & the_table,
   }
 }
 
-/* --------------------------------------------------------------------------*/
-/** 
- * @brief  Given an array of partition numbers, computes the final output location
-   for each element in the output such that all rows with the same partition are 
-   contiguous in memory.
- * 
- * @param row_partition_numbers The array that records the partition number for each row
- * @param num_rows The number of rows
- * @param num_partitions THe number of partitions
- * @param[out] block_partition_offsets Array that holds the offset of each partition for each thread block,
- * i.e., { {block0 partition0 offset, block1 partition0 offset, ...}, 
-         {block0 partition1 offset, block1 partition1 offset, ...},
-         ...
-         {block0 partition(num_partitions-1) offset, block1 partition(num_partitions -1) offset, ...} }
- */
-/* ----------------------------------------------------------------------------*/
-template <typename size_type>
-__global__ 
-void compute_row_output_locations(size_type * row_partition_numbers, 
-                                  const size_type num_rows,
-                                  const size_type num_partitions,
-                                  size_type * block_partition_offsets)
-{
-  // Shared array that holds the offset of this blocks partitions in 
-  // global memory
-  extern __shared__ size_type shared_partition_offsets[];
-
-  // Initialize array of this blocks offsets from global array
-  size_type partition_number= threadIdx.x;
-  while(partition_number < num_partitions)
-  {
-    shared_partition_offsets[partition_number] = block_partition_offsets[partition_number * gridDim.x + blockIdx.x];
-    partition_number += blockDim.x;
-  }
-  __syncthreads();
-
-  size_type row_number = threadIdx.x + blockIdx.x * blockDim.x;
-
-  // Get each row's partition number, and get it's output location by 
-  // incrementing block's offset counter for that partition number
-  // and store the row's output location in-place
-  while( row_number < num_rows )
-  {
-    // Get partition number of this row
-    const size_type partition_number = row_partition_numbers[row_number];
-
-    // Get output location based on partition number by incrementing the corresponding
-    // partition offset for this block
-    const size_type row_output_location = atomicAdd(&(shared_partition_offsets[partition_number]), size_type(1));
-
-    // Store the row's output location in-place
-    row_partition_numbers[row_number] = row_output_location;
-
-    row_number += blockDim.x * gridDim.x;
-  }
-}
-
-
-
 /* --------------------------------------------------------------------------*/
 /** 
  * @brief Partitions an input gdf_table into a specified number of partitions.
@@ -401,6 +352,7 @@ void compute_row_output_locations(size_type * row_partition_numbers,
  * of partition 'i'
  * @param[out] partitioned_output Preallocated gdf_columns to hold the rearrangement
  * of the input columns into the desired number of partitions
+ * @param[in] stream The stream to compute the partitions on
  * @tparam hash_function The hash function that will be used to hash the rows
  */
 /* ----------------------------------------------------------------------------*/
@@ -410,7 +362,8 @@ gdf_error hash_partition_gdf_table(gdf_table<size_type> const & input_table,
                                    gdf_table<size_type> const & table_to_hash,
                                    const size_type num_partitions,
                                    size_type * partition_offsets,
-                                   gdf_table<size_type> & partitioned_output)
+                                   gdf_table<size_type> & partitioned_output,
+                                   cudaStream_t stream = 0)
 {
 
   const size_type num_rows = table_to_hash.get_column_length();
@@ -420,7 +373,7 @@ gdf_error hash_partition_gdf_table(gdf_table<size_type> const & input_table,
 
   // Allocate array to hold which partition each row belongs to
   size_type * row_partition_numbers{nullptr};
-  RMM_TRY( RMM_ALLOC((void**)&row_partition_numbers, num_rows * sizeof(hash_value_type), 0) ); // TODO: non-default stream?
+  SCRATCH_ALLOC_TRY(&row_partition_numbers, num_rows * sizeof(hash_value_type), stream);
   
   // Array to hold the size of each partition computed by each block
   //  i.e., { {block0 partition0 size, block1 partition0 size, ...}, 
@@ -428,12 +381,12 @@ gdf_error hash_partition_gdf_table(gdf_table<size_type> const & input_table,
   //          ...
   //          {block0 partition(num_partitions-1) size, block1 partition(num_partitions -1) size, ...} }
   size_type * block_partition_sizes{nullptr};
-  RMM_TRY(RMM_ALLOC((void**)&block_partition_sizes, (grid_size * num_partitions) * sizeof(size_type), 0) );
+  SCRATCH_ALLOC_TRY(&block_partition_sizes, (grid_size * num_partitions) * sizeof(size_type), stream);
 
   // Holds the total number of rows in each partition
   size_type * global_partition_sizes{nullptr};
-  RMM_TRY( RMM_ALLOC((void**)&global_partition_sizes, num_partitions * sizeof(size_type), 0) );
-  CUDA_TRY( cudaMemsetAsync(global_partition_sizes, 0, num_partitions * sizeof(size_type)) );
+  SCRATCH_ALLOC_TRY(&global_partition_sizes, num_partitions * sizeof(size_type), stream);
+  CUDA_TRY( cudaMemsetAsync(global_partition_sizes, 0, num_partitions * sizeof(size_type), stream) );
 
   // If the number of partitions is a power of two, we can compute the partition 
   // number of each row more efficiently with bitwise operations
@@ -446,13 +399,13 @@ gdf_error hash_partition_gdf_table(gdf_table<size_type> const & input_table,
     // a partitioning operator on the hash value. Also computes the number of
     // rows in each partition both for each thread block as well as across all blocks
     compute_row_partition_numbers<hash_function>
-    <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type)>>>(table_to_hash, 
-                                                                    num_rows,
-                                                                    num_partitions,
-                                                                    partitioner_type(num_partitions),
-                                                                    row_partition_numbers,
-                                                                    block_partition_sizes,
-                                                                    global_partition_sizes);
+    <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type), stream>>>(table_to_hash, 
+                                                                            num_rows,
+                                                                            num_partitions,
+                                                                            partitioner_type(num_partitions),
+                                                                            row_partition_numbers,
+                                                                            block_partition_sizes,
+                                                                            global_partition_sizes);
 
   }
   else
@@ -464,79 +417,23 @@ gdf_error hash_partition_gdf_table(gdf_table<size_type> const & input_table,
     // a partitioning operator on the hash value. Also computes the number of
     // rows in each partition both for each thread block as well as across all blocks
     compute_row_partition_numbers<hash_function>
-    <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type)>>>(table_to_hash, 
-                                                                    num_rows,
-                                                                    num_partitions,
-                                                                    partitioner_type(num_partitions),
-                                                                    row_partition_numbers,
-                                                                    block_partition_sizes,
-                                                                    global_partition_sizes);
+    <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type), stream>>>(table_to_hash, 
+                                                                            num_rows,
+                                                                            num_partitions,
+                                                                            partitioner_type(num_partitions),
+                                                                            row_partition_numbers,
+                                                                            block_partition_sizes,
+                                                                            global_partition_sizes);
   }
 
 
   CUDA_CHECK_LAST();
 
   
-  // Compute exclusive scan of all blocks' partition sizes in-place to determine 
-  // the starting point for each blocks portion of each partition in the output
-  size_type * scanned_block_partition_sizes{block_partition_sizes};
-  thrust::exclusive_scan(rmm::exec_policy()->on(0),
-                         block_partition_sizes, 
-                         block_partition_sizes + (grid_size * num_partitions), 
-                         scanned_block_partition_sizes);
-  CUDA_CHECK_LAST();
-
-
-  // Compute exclusive scan of size of each partition to determine offset location
-  // of each partition in final output. This can be done independently on a separate stream
-  cudaStream_t s1{};
-  cudaStreamCreate(&s1);
-  size_type * scanned_global_partition_sizes{global_partition_sizes};
-  thrust::exclusive_scan(rmm::exec_policy(s1)->on(s1),
-                         global_partition_sizes, 
-                         global_partition_sizes + num_partitions,
-                         scanned_global_partition_sizes);
-  CUDA_CHECK_LAST();
-
-  // Copy the result of the exlusive scan to the output offsets array
-  // to indicate the starting point for each partition in the output
-  CUDA_TRY(cudaMemcpyAsync(partition_offsets, 
-                           scanned_global_partition_sizes, 
-                           num_partitions * sizeof(size_type),
-                           cudaMemcpyDeviceToHost,
-                           s1));
-
-  // Compute the output location for each row in-place based on it's 
-  // partition number such that each partition will be contiguous in memory
-  size_type * row_output_locations{row_partition_numbers};
-  compute_row_output_locations
-  <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type)>>>(row_output_locations,
-                                                                  num_rows,
-                                                                  num_partitions,
-                                                                  scanned_block_partition_sizes);
-
-  CUDA_CHECK_LAST();
-
-  // Creates the partitioned output table by scattering the rows of
-  // the input table to rows of the output table based on each rows
-  // output location
-  gdf_error gdf_error_code = input_table.scatter(partitioned_output,
-                                                 row_output_locations);
-
-  if(GDF_SUCCESS != gdf_error_code){
-    return gdf_error_code;
-  }
-
-  CUDA_CHECK_LAST();
-
-  RMM_TRY(RMM_FREE(row_partition_numbers, 0));
-  RMM_TRY(RMM_FREE(block_partition_sizes, 0));
-
-  cudaStreamSynchronize(s1);
-  cudaStreamDestroy(s1);
-  RMM_TRY(RMM_FREE(global_partition_sizes, 0));
-
-  return GDF_SUCCESS;
+  return scatter_to_partitions(input_table, num_partitions, grid_size,
+                               row_partition_numbers, block_partition_sizes,
+                               global_partition_sizes, partition_offsets,
+                               partitioned_output, stream);
 }
 
 /* --------------------------------------------------------------------------*/
@@ -566,12 +463,10 @@ gdf_error gdf_hash_partition(int num_input_cols,
                              int num_cols_to_hash,
                              int num_partitions,
                              gdf_column * partitioned_output[],
-                             int partition_offsets[],
+                             gdf_size_type partition_offsets[],
                              gdf_hash_func hash)
 {
-  // Use int until gdf API is updated to use something other than int
-  // for ordinal variables
-  using size_type = int;
+  using size_type = gdf_size_type;
 
   // Ensure all the inputs are non-zero and not null
   if((0 == num_input_cols) 
@@ -657,3 +552,487 @@ gdf_error gdf_hash_partition(int num_input_cols,
   return gdf_status;
 }
 
+namespace {
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Copies count validity bits of src starting at src_offset to dst
+   * starting at dst_offset, keeping the bits of dst before dst_offset. A
+   * null src copies valid bits.
+   *
+   * Each thread assembles one byte of dst, so no atomics are needed.
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__
+  void copy_valid_bits(gdf_valid_type * dst, gdf_size_type dst_offset,
+                       gdf_valid_type const * src, gdf_size_type src_offset,
+                       gdf_size_type count)
+  {
+    const gdf_size_type byte = dst_offset / GDF_VALID_BITSIZE
+                               + threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+    const gdf_size_type end_bit = dst_offset + count;
+    if (byte * GDF_VALID_BITSIZE >= end_bit) {
+      return;
+    }
+    gdf_valid_type bits = dst[byte];
+    for (int b = 0; b < GDF_VALID_BITSIZE; ++b) {
+      const gdf_size_type bit = byte * GDF_VALID_BITSIZE + b;
+      if (bit >= dst_offset && bit < end_bit) {
+        const gdf_valid_type mask = gdf_valid_type{1} << b;
+        bits = gdf_is_valid(src, src_offset + (bit - dst_offset)) ? (bits | mask) : (bits & ~mask);
+      }
+    }
+    dst[byte] = bits;
+  }
+
+  gdf_error append_valid_bits(gdf_valid_type * dst, gdf_size_type dst_offset,
+                              gdf_valid_type const * src, gdf_size_type src_offset,
+                              gdf_size_type count, cudaStream_t stream)
+  {
+    if (0 == count) {
+      return GDF_SUCCESS;
+    }
+    const gdf_size_type num_bytes = gdf_get_num_chars_bitmask(dst_offset + count)
+                                    - dst_offset / GDF_VALID_BITSIZE;
+    copy_valid_bits<<<(num_bytes + BLOCK_SIZE - 1) / BLOCK_SIZE, BLOCK_SIZE, 0, stream>>>(
+        dst, dst_offset, src, src_offset, count);
+    CUDA_CHECK_LAST();
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The rows of a partition: the ones in device memory, and the ones
+   * spilled to its file as chunks of
+   * { int64 number of rows, then for every column its data and its validity }
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct partition_buffer
+  {
+    std::vector<rmm::device_vector<char>> data;
+    std::vector<rmm::device_vector<gdf_valid_type>> valid;
+    gdf_size_type size{0};            // The number of rows in device memory
+    gdf_size_type spilled_size{0};    // The number of rows in the file
+    off_t file_size{0};
+    int fd{-1};
+
+    size_t device_bytes() const
+    {
+      size_t bytes{0};
+      for (size_t c = 0; c < data.size(); ++c) {
+        bytes += data[c].capacity() + valid[c].capacity() * sizeof(gdf_valid_type);
+      }
+      return bytes;
+    }
+  };
+
+  gdf_error write_all(int fd, void const * buffer, size_t size, off_t offset)
+  {
+    char const * bytes = static_cast<char const *>(buffer);
+    while (size > 0) {
+      const ssize_t written = pwrite(fd, bytes, size, offset);
+      if (written < 0 && EINTR == errno) {
+        continue;
+      }
+      GDF_REQUIRE(written > 0, GDF_FILE_ERROR);
+      bytes += written;
+      size -= written;
+      offset += written;
+    }
+    return GDF_SUCCESS;
+  }
+
+  gdf_error read_all(int fd, void * buffer, size_t size, off_t offset)
+  {
+    char * bytes = static_cast<char *>(buffer);
+    while (size > 0) {
+      const ssize_t num_read = pread(fd, bytes, size, offset);
+      if (num_read < 0 && EINTR == errno) {
+        continue;
+      }
+      GDF_REQUIRE(num_read > 0, GDF_FILE_ERROR);
+      bytes += num_read;
+      size -= num_read;
+      offset += num_read;
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Hash partitions batches of rows into buffers that are spilled to
+   * files when they exceed a memory budget
+   */
+  /* ----------------------------------------------------------------------------*/
+  class HashPartitioner {
+  public:
+    gdf_error init(int num_cols, gdf_dtype const * dtypes,
+                   int const * columns_to_hash, int num_cols_to_hash,
+                   int num_partitions, gdf_hash_func hash,
+                   size_t memory_budget, char const * spill_directory)
+    {
+      GDF_REQUIRE(num_cols > 0 && nullptr != dtypes, GDF_INVALID_API_CALL);
+      GDF_REQUIRE(num_cols_to_hash > 0 && nullptr != columns_to_hash, GDF_INVALID_API_CALL);
+      GDF_REQUIRE(num_partitions > 0, GDF_INVALID_API_CALL);
+      GDF_REQUIRE(GDF_HASH_MURMUR3 == hash || GDF_HASH_IDENTITY == hash, GDF_INVALID_HASH_FUNCTION);
+
+      for (int c = 0; c < num_cols; ++c) {
+        // Only fixed width types can be spilled and appended
+        GDF_REQUIRE(dtypes[c] > GDF_invalid && dtypes[c] < GDF_STRING, GDF_UNSUPPORTED_DTYPE);
+        gdf_column column{};
+        column.dtype = dtypes[c];
+        int width{0};
+        gdf_error status = get_column_byte_width(&column, &width);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        dtypes_.push_back(dtypes[c]);
+        widths_.push_back(width);
+      }
+      for (int i = 0; i < num_cols_to_hash; ++i) {
+        GDF_REQUIRE(columns_to_hash[i] >= 0 && columns_to_hash[i] < num_cols, GDF_INVALID_API_CALL);
+        columns_to_hash_.push_back(columns_to_hash[i]);
+      }
+      hash_ = hash;
+      memory_budget_ = memory_budget;
+      spill_directory_ = (nullptr != spill_directory) ? spill_directory : "/tmp";
+
+      partitions_.resize(num_partitions);
+      for (auto & partition : partitions_) {
+        partition.data.resize(num_cols);
+        partition.valid.resize(num_cols);
+      }
+      CUDA_TRY( cudaStreamCreate(&stream_) );
+      return GDF_SUCCESS;
+    }
+
+    ~HashPartitioner()
+    {
+      for (auto & partition : partitions_) {
+        if (partition.fd >= 0) {
+          close(partition.fd);
+        }
+      }
+      if (0 != stream_) {
+        cudaStreamDestroy(stream_);
+      }
+    }
+
+    /* --------------------------------------------------------------------------*/
+    /**
+     * @brief Partitions a batch, appends its partitions to the buffers and
+     * spills the largest buffers until they fit the memory budget
+     */
+    /* ----------------------------------------------------------------------------*/
+    gdf_error add(gdf_column * input[])
+    {
+      GDF_REQUIRE(nullptr != input, GDF_INVALID_API_CALL);
+      const int num_cols = dtypes_.size();
+      const int num_partitions = partitions_.size();
+      for (int c = 0; c < num_cols; ++c) {
+        GDF_REQUIRE(nullptr != input[c], GDF_DATASET_EMPTY);
+        GDF_REQUIRE(dtypes_[c] == input[c]->dtype, GDF_PARTITION_DTYPE_MISMATCH);
+        GDF_REQUIRE(input[0]->size == input[c]->size, GDF_COLUMN_SIZE_MISMATCH);
+        GDF_REQUIRE(0 == input[c]->size || nullptr != input[c]->data, GDF_DATASET_EMPTY);
+      }
+      const gdf_size_type num_rows = input[0]->size;
+      if (0 == num_rows) {
+        return GDF_SUCCESS;
+      }
+
+      // Partition the batch into scratch columns
+      std::vector<rmm::device_vector<char>> batch_data(num_cols);
+      std::vector<rmm::device_vector<gdf_valid_type>> batch_valid(num_cols);
+      std::vector<gdf_column> batch_columns(num_cols);
+      std::vector<gdf_column *> batch_ptrs(num_cols);
+      for (int c = 0; c < num_cols; ++c) {
+        batch_data[c].resize(static_cast<size_t>(num_rows) * widths_[c]);
+        if (nullptr != input[c]->valid) {
+          batch_valid[c].resize(gdf_get_num_chars_bitmask(num_rows));
+        }
+        batch_columns[c] = *input[c];
+        batch_columns[c].data = batch_data[c].data().get();
+        batch_columns[c].valid = batch_valid[c].empty() ? nullptr : batch_valid[c].data().get();
+        batch_ptrs[c] = &batch_columns[c];
+      }
+
+      std::vector<gdf_column *> hash_ptrs;
+      for (int c : columns_to_hash_) {
+        hash_ptrs.push_back(input[c]);
+      }
+      std::unique_ptr< const gdf_table<gdf_size_type> > input_table{new gdf_table<gdf_size_type>(num_cols, input)};
+      std::unique_ptr< const gdf_table<gdf_size_type> > table_to_hash{new gdf_table<gdf_size_type>(hash_ptrs.size(),
+                                                                                                    hash_ptrs.data())};
+      std::unique_ptr< gdf_table<gdf_size_type> > batch_table{new gdf_table<gdf_size_type>(num_cols, batch_ptrs.data())};
+
+      std::vector<gdf_size_type> offsets(num_partitions + 1, num_rows);
+      gdf_error status = (GDF_HASH_MURMUR3 == hash_)
+        ? hash_partition_gdf_table<MurmurHash3_32>(*input_table, *table_to_hash, num_partitions,
+                                                   offsets.data(), *batch_table, stream_)
+        : hash_partition_gdf_table<IdentityHash>(*input_table, *table_to_hash, num_partitions,
+                                                 offsets.data(), *batch_table, stream_);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+      // Append every partition of the batch to its buffer
+      for (int p = 0; p < num_partitions; ++p) {
+        partition_buffer & partition = partitions_[p];
+        const gdf_size_type count = offsets[p + 1] - offsets[p];
+        if (0 == count) {
+          continue;
+        }
+        const gdf_size_type new_size = partition.size + count;
+        for (int c = 0; c < num_cols; ++c) {
+          partition.data[c].resize(static_cast<size_t>(new_size) * widths_[c]);
+          CUDA_TRY( cudaMemcpyAsync(partition.data[c].data().get() + static_cast<size_t>(partition.size) * widths_[c],
+                                    batch_data[c].data().get() + static_cast<size_t>(offsets[p]) * widths_[c],
+                                    static_cast<size_t>(count) * widths_[c], cudaMemcpyDeviceToDevice, stream_) );
+          partition.valid[c].resize(gdf_get_num_chars_bitmask(new_size));
+          status = append_valid_bits(partition.valid[c].data().get(), partition.size,
+                                     batch_columns[c].valid, offsets[p], count, stream_);
+          GDF_REQUIRE(GDF_SUCCESS == status, status);
+        }
+        partition.size = new_size;
+      }
+      CUDA_TRY( cudaStreamSynchronize(stream_) );
+
+      return spill_to_budget();
+    }
+
+    gdf_error size(int partition, gdf_size_type * size) const
+    {
+      GDF_REQUIRE(partition >= 0 && partition < static_cast<int>(partitions_.size()), GDF_INVALID_API_CALL);
+      GDF_REQUIRE(nullptr != size, GDF_INVALID_API_CALL);
+      *size = partitions_[partition].spilled_size + partitions_[partition].size;
+      return GDF_SUCCESS;
+    }
+
+    size_t spilled_bytes() const { return spilled_bytes_; }
+
+    /* --------------------------------------------------------------------------*/
+    /**
+     * @brief Copies the spilled rows and then the rows in device memory of a
+     * partition to the output columns, and empties the partition
+     */
+    /* ----------------------------------------------------------------------------*/
+    gdf_error take(int partition_number, gdf_column * output[])
+    {
+      gdf_size_type total_size{0};
+      gdf_error status = size(partition_number, &total_size);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      GDF_REQUIRE(nullptr != output, GDF_INVALID_API_CALL);
+      const int num_cols = dtypes_.size();
+      for (int c = 0; c < num_cols; ++c) {
+        GDF_REQUIRE(nullptr != output[c], GDF_DATASET_EMPTY);
+        GDF_REQUIRE(dtypes_[c] == output[c]->dtype, GDF_PARTITION_DTYPE_MISMATCH);
+        GDF_REQUIRE(total_size == output[c]->size, GDF_COLUMN_SIZE_MISMATCH);
+        GDF_REQUIRE(0 == total_size || nullptr != output[c]->data, GDF_DATASET_EMPTY);
+      }
+      partition_buffer & partition = partitions_[partition_number];
+
+      // The spilled chunks, in the order they were written
+      gdf_size_type row{0};
+      off_t offset{0};
+      std::vector<char> h_data;
+      std::vector<gdf_valid_type> h_valid;
+      rmm::device_vector<gdf_valid_type> d_valid;
+      while (offset < partition.file_size) {
+        int64_t chunk_rows{0};
+        status = read_all(partition.fd, &chunk_rows, sizeof(chunk_rows), offset);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        offset += sizeof(chunk_rows);
+        for (int c = 0; c < num_cols; ++c) {
+          h_data.resize(static_cast<size_t>(chunk_rows) * widths_[c]);
+          status = read_all(partition.fd, h_data.data(), h_data.size(), offset);
+          GDF_REQUIRE(GDF_SUCCESS == status, status);
+          offset += h_data.size();
+          CUDA_TRY( cudaMemcpy(static_cast<char *>(output[c]->data) + static_cast<size_t>(row) * widths_[c],
+                               h_data.data(), h_data.size(), cudaMemcpyHostToDevice) );
+
+          h_valid.resize(gdf_get_num_chars_bitmask(chunk_rows));
+          status = read_all(partition.fd, h_valid.data(), h_valid.size(), offset);
+          GDF_REQUIRE(GDF_SUCCESS == status, status);
+          offset += h_valid.size();
+          if (nullptr != output[c]->valid) {
+            d_valid = h_valid;
+            status = append_valid_bits(output[c]->valid, row, d_valid.data().get(), 0, chunk_rows, stream_);
+            GDF_REQUIRE(GDF_SUCCESS == status, status);
+            CUDA_TRY( cudaStreamSynchronize(stream_) );
+          }
+        }
+        row += chunk_rows;
+      }
+
+      // The rows in device memory
+      for (int c = 0; c < num_cols; ++c) {
+        CUDA_TRY( cudaMemcpyAsync(static_cast<char *>(output[c]->data) + static_cast<size_t>(row) * widths_[c],
+                                  partition.data[c].data().get(), static_cast<size_t>(partition.size) * widths_[c],
+                                  cudaMemcpyDeviceToDevice, stream_) );
+        if (nullptr != output[c]->valid) {
+          status = append_valid_bits(output[c]->valid, row, partition.valid[c].data().get(), 0,
+                                     partition.size, stream_);
+          GDF_REQUIRE(GDF_SUCCESS == status, status);
+        }
+      }
+      CUDA_TRY( cudaStreamSynchronize(stream_) );
+
+      for (int c = 0; c < num_cols; ++c) {
+        gdf_size_type valid_count{total_size};
+        if (nullptr != output[c]->valid && total_size > 0) {
+          status = gdf_count_nonzero_mask(output[c]->valid, total_size, &valid_count);
+          GDF_REQUIRE(GDF_SUCCESS == status, status);
+        }
+        output[c]->null_count = total_size - valid_count;
+      }
+
+      release_device_memory(partition);
+      partition.spilled_size = 0;
+      if (partition.fd >= 0) {
+        GDF_REQUIRE(0 == ftruncate(partition.fd, 0), GDF_FILE_ERROR);
+      }
+      partition.file_size = 0;
+      return GDF_SUCCESS;
+    }
+
+  private:
+    void release_device_memory(partition_buffer & partition)
+    {
+      for (size_t c = 0; c < partition.data.size(); ++c) {
+        partition.data[c].clear();
+        partition.data[c].shrink_to_fit();
+        partition.valid[c].clear();
+        partition.valid[c].shrink_to_fit();
+      }
+      partition.size = 0;
+    }
+
+    // Spills the largest partitions until the rest fit the memory budget
+    gdf_error spill_to_budget()
+    {
+      if (0 == memory_budget_) {
+        return GDF_SUCCESS;
+      }
+      size_t device_bytes{0};
+      for (auto const & partition : partitions_) {
+        device_bytes += partition.device_bytes();
+      }
+      while (device_bytes > memory_budget_) {
+        auto largest = std::max_element(partitions_.begin(), partitions_.end(),
+                                        [](partition_buffer const & a, partition_buffer const & b) {
+                                          return a.device_bytes() < b.device_bytes();
+                                        });
+        device_bytes -= largest->device_bytes();
+        gdf_error status = spill(*largest);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+      }
+      return GDF_SUCCESS;
+    }
+
+    // Appends the rows of a partition in device memory to its file
+    gdf_error spill(partition_buffer & partition)
+    {
+      if (partition.fd < 0) {
+        // The file is removed right away, and is gone once it is closed
+        std::string path = spill_directory_ + "/cudf_partition_XXXXXX";
+        partition.fd = mkstemp(&path[0]);
+        GDF_REQUIRE(partition.fd >= 0, GDF_FILE_ERROR);
+        unlink(path.c_str());
+      }
+
+      const int64_t chunk_rows = partition.size;
+      gdf_error status = write_all(partition.fd, &chunk_rows, sizeof(chunk_rows), partition.file_size);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      off_t offset = partition.file_size + sizeof(chunk_rows);
+      std::vector<char> h_data;
+      std::vector<gdf_valid_type> h_valid;
+      for (size_t c = 0; c < partition.data.size(); ++c) {
+        h_data.resize(static_cast<size_t>(chunk_rows) * widths_[c]);
+        CUDA_TRY( cudaMemcpy(h_data.data(), partition.data[c].data().get(), h_data.size(),
+                             cudaMemcpyDeviceToHost) );
+        status = write_all(partition.fd, h_data.data(), h_data.size(), offset);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        offset += h_data.size();
+
+        h_valid.resize(gdf_get_num_chars_bitmask(chunk_rows));
+        CUDA_TRY( cudaMemcpy(h_valid.data(), partition.valid[c].data().get(), h_valid.size(),
+                             cudaMemcpyDeviceToHost) );
+        status = write_all(partition.fd, h_valid.data(), h_valid.size(), offset);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        offset += h_valid.size();
+      }
+
+      spilled_bytes_ += offset - partition.file_size;
+      partition.file_size = offset;
+      partition.spilled_size += partition.size;
+      release_device_memory(partition);
+      return GDF_SUCCESS;
+    }
+
+    std::vector<gdf_dtype> dtypes_;
+    std::vector<int> widths_;
+    std::vector<int> columns_to_hash_;
+    gdf_hash_func hash_{GDF_HASH_MURMUR3};
+    size_t memory_budget_{0};
+    std::string spill_directory_;
+    std::vector<partition_buffer> partitions_;
+    size_t spilled_bytes_{0};
+    cudaStream_t stream_{0};
+  };
+
+  gdf_partitioner_type* cffi_wrap(HashPartitioner* obj){
+    return reinterpret_cast<gdf_partitioner_type*>(obj);
+  }
+
+  HashPartitioner* cffi_unwrap(gdf_partitioner_type* hdl){
+    return reinterpret_cast<HashPartitioner*>(hdl);
+  }
+
+} // end unnamed namespace
+
+gdf_partitioner_type* gdf_hash_partitioner(int num_cols,
+                                           gdf_dtype * dtypes,
+                                           int columns_to_hash[],
+                                           int num_cols_to_hash,
+                                           int num_partitions,
+                                           gdf_hash_func hash,
+                                           size_t memory_budget,
+                                           const char * spill_directory)
+{
+  std::unique_ptr<HashPartitioner> partitioner(new HashPartitioner);
+  if (GDF_SUCCESS != partitioner->init(num_cols, dtypes, columns_to_hash, num_cols_to_hash,
+                                       num_partitions, hash, memory_budget, spill_directory)) {
+    return nullptr;
+  }
+  return cffi_wrap(partitioner.release());
+}
+
+gdf_error gdf_hash_partitioner_free(gdf_partitioner_type *hdl)
+{
+  delete cffi_unwrap(hdl);
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_hash_partitioner_add(gdf_partitioner_type *hdl, gdf_column * input[])
+{
+  GDF_REQUIRE(nullptr != hdl, GDF_INVALID_API_CALL);
+  PUSH_RANGE("LIBGDF_HASH_PARTITIONER_ADD", PARTITION_COLOR);
+  gdf_error status = cffi_unwrap(hdl)->add(input);
+  POP_RANGE();
+  return status;
+}
+
+gdf_error gdf_hash_partitioner_size(gdf_partitioner_type *hdl, int partition, gdf_size_type *size)
+{
+  GDF_REQUIRE(nullptr != hdl, GDF_INVALID_API_CALL);
+  return cffi_unwrap(hdl)->size(partition, size);
+}
+
+gdf_error gdf_hash_partitioner_spilled_bytes(gdf_partitioner_type *hdl, size_t *bytes)
+{
+  GDF_REQUIRE(nullptr != hdl && nullptr != bytes, GDF_INVALID_API_CALL);
+  *bytes = cffi_unwrap(hdl)->spilled_bytes();
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_hash_partitioner_take(gdf_partitioner_type *hdl, int partition, gdf_column * output[])
+{
+  GDF_REQUIRE(nullptr != hdl, GDF_INVALID_API_CALL);
+  return cffi_unwrap(hdl)->take(partition, output);
+}
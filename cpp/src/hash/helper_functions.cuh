@@ -180,7 +180,7 @@ __global__ void init_hashtbl(
     const key_type key_val,
     const elem_type elem_val)
 {
-    const size_type idx = blockIdx.x * blockDim.x + threadIdx.x;
+    const size_type idx = static_cast<size_type>(blockIdx.x) * blockDim.x + threadIdx.x;
     if ( idx < n )
     {
         store_pair_vectorized( hashtbl_values + idx, thrust::make_pair( key_val, elem_val ) );
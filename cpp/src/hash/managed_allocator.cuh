@@ -20,6 +20,7 @@
 #include <new>
 
 #include "rmm/rmm.h"
+#include "utilities/allocator.hpp"
 
 template <class T>
 struct managed_allocator {
@@ -62,11 +63,12 @@ struct legacy_allocator {
 
       T* allocate(std::size_t n) const {
           T* ptr = 0;
-          rmmError_t result = RMM_ALLOC( (void**)&ptr, n*sizeof(T), 0 ); // TODO non-default stream?
-          if( RMM_SUCCESS != result || nullptr == ptr ) 
+          gdf_error result = cudf::memory::device_allocator().allocate(
+              reinterpret_cast<void**>(&ptr), n*sizeof(T), 0 ); // TODO non-default stream?
+          if( GDF_SUCCESS != result || nullptr == ptr ) 
           {
-            std::cerr << "ERROR: RMM call in line " << __LINE__ << "of file " 
-                      << __FILE__ << " failed with result " << rmmGetErrorString(result) 
+            std::cerr << "ERROR: scratch allocation in line " << __LINE__ << "of file " 
+                      << __FILE__ << " failed with result " << gdf_error_get_name(result) 
                       << " (" << result << ") "
                       << " Attempted to allocate: " << n * sizeof(T) << " bytes.\n";
             throw std::bad_alloc();
@@ -75,8 +77,8 @@ struct legacy_allocator {
           return ptr;
       }
       void deallocate(T* p, std::size_t) const {
-          rmmError_t result = RMM_FREE(p, 0); // TODO: non-default stream
-          if ( RMM_SUCCESS != result) throw std::runtime_error("legacy_allocator: RMM Memory Manager Error");
+          gdf_error result = cudf::memory::device_allocator().deallocate(p, 0); // TODO: non-default stream
+          if ( GDF_SUCCESS != result) throw std::runtime_error("legacy_allocator: scratch memory allocator error");
       }
 };
 
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "io_comp.h"
+#include <string.h> // memset
+#include <zlib.h> // deflate
+
+struct io_comp_stream_s
+{
+    z_stream zstrm;
+};
+
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @Brief Starts a compressed stream
+ * 
+ * @param strm[out] Returns the stream, to be released with io_compress_end
+ * @param strm_type[in] IO_UNCOMP_STREAM_TYPE_GZIP or IO_UNCOMP_STREAM_TYPE_INFLATE
+ * 
+ * @returns gdf_error with error code on failure, otherwise GDF_SUCCESS
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error io_compress_begin(io_comp_stream_s **strm, int strm_type)
+{
+    int window_bits;
+
+    if (!strm)
+    {
+        return GDF_INVALID_API_CALL;
+    }
+    *strm = nullptr;
+    if (strm_type == IO_UNCOMP_STREAM_TYPE_GZIP)
+    {
+        window_bits = 15 + 16; // +16 for a GZIP header and trailer
+    }
+    else if (strm_type == IO_UNCOMP_STREAM_TYPE_INFLATE)
+    {
+        window_bits = -15; // -15 for raw data without GZIP headers
+    }
+    else
+    {
+        return GDF_UNSUPPORTED_DTYPE;
+    }
+
+    io_comp_stream_s *s = new io_comp_stream_s;
+    memset(&s->zstrm, 0, sizeof(s->zstrm));
+    if (deflateInit2(&s->zstrm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        delete s;
+        return GDF_C_ERROR;
+    }
+    *strm = s;
+    return GDF_SUCCESS;
+}
+
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @Brief Compresses the next chunk of a stream, and appends the compressed
+ * bytes that are ready to a vector
+ * 
+ * @param strm[in] The stream returned by io_compress_begin
+ * @param src[in] Pointer to the chunk in system memory
+ * @param src_size[in] The size of the chunk, in bytes
+ * @param last[in] Whether the chunk is the last one, which flushes the stream
+ * @param dst[in,out] Vector the compressed bytes are appended to
+ * 
+ * @returns gdf_error with error code on failure, otherwise GDF_SUCCESS
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error io_compress_append(io_comp_stream_s *strm, const void *src, size_t src_size, bool last, std::vector<char>& dst)
+{
+    if (!strm || (src_size && !src))
+    {
+        return GDF_INVALID_API_CALL;
+    }
+    z_stream &zstrm = strm->zstrm;
+    const int flush = (last) ? Z_FINISH : Z_NO_FLUSH;
+    const uint8_t *next_in = (const uint8_t *)src;
+    int zerr;
+
+    // avail_in is 32-bit, larger chunks are fed in pieces
+    do
+    {
+        const size_t in_size = (src_size < (1u << 30)) ? src_size : (1u << 30);
+        zstrm.next_in = (Bytef *)next_in;
+        zstrm.avail_in = (uInt)in_size;
+        next_in += in_size;
+        src_size -= in_size;
+        const int piece_flush = (src_size == 0) ? flush : Z_NO_FLUSH;
+        do
+        {
+            const size_t dst_pos = dst.size();
+            const size_t out_size = deflateBound(&zstrm, zstrm.avail_in) + 64;
+            dst.resize(dst_pos + out_size);
+            zstrm.next_out = (Bytef *)(dst.data() + dst_pos);
+            zstrm.avail_out = (uInt)out_size;
+            zerr = deflate(&zstrm, piece_flush);
+            dst.resize(dst_pos + out_size - zstrm.avail_out);
+            if (zerr == Z_STREAM_ERROR)
+            {
+                return GDF_C_ERROR;
+            }
+        } while (zstrm.avail_in != 0 || (piece_flush == Z_FINISH && zerr != Z_STREAM_END));
+    } while (src_size != 0);
+
+    return GDF_SUCCESS;
+}
+
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @Brief Releases a stream returned by io_compress_begin
+ */
+/* ----------------------------------------------------------------------------*/
+void io_compress_end(io_comp_stream_s *strm)
+{
+    if (strm)
+    {
+        deflateEnd(&strm->zstrm);
+        delete strm;
+    }
+}
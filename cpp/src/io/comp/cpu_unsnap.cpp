@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * cpu_unsnap.cpp
+ *
+ * Memory-to-memory decompression of raw snappy blocks, as found in Parquet
+ * and ORC pages. The format is described in
+ * https://github.com/google/snappy/blob/master/format_description.txt
+ *
+ */
+
+#include <string.h>
+#include "unsnap.h"
+
+#define SNAPPY_TAG_LITERAL  0
+#define SNAPPY_TAG_COPY1    1
+#define SNAPPY_TAG_COPY2    2
+#define SNAPPY_TAG_COPY4    3
+
+
+size_t cpu_snappy_uncompressed_length(const uint8_t *input, size_t inlen, size_t *uncomp_len)
+{
+    // Little-endian varint of up to 32 bits
+    uint32_t len = 0;
+    for (size_t i = 0; i < inlen && i < 5; i++)
+    {
+        len |= (uint32_t)(input[i] & 0x7f) << (7 * i);
+        if (!(input[i] & 0x80))
+        {
+            *uncomp_len = len;
+            return i + 1;
+        }
+    }
+    *uncomp_len = 0;
+    return 0;
+}
+
+
+int32_t cpu_snappy_uncompress(const uint8_t *input, size_t inlen, uint8_t *dst, size_t *dstlen)
+{
+    size_t uncomp_len = 0;
+    size_t src_pos = cpu_snappy_uncompressed_length(input, inlen, &uncomp_len);
+    size_t dst_pos = 0;
+
+    if (src_pos == 0)
+    {
+        *dstlen = 0;
+        return SNAPPY_DATA_ERROR;
+    }
+    if (uncomp_len > *dstlen)
+    {
+        *dstlen = 0;
+        return SNAPPY_OUTBUFF_FULL;
+    }
+    while (src_pos < inlen)
+    {
+        uint32_t tag = input[src_pos++];
+        size_t len, offset;
+
+        if ((tag & 3) == SNAPPY_TAG_LITERAL)
+        {
+            len = tag >> 2;
+            if (len >= 60)
+            {
+                // The length minus one follows in 1 to 4 bytes
+                uint32_t num_bytes = len - 59;
+                if (src_pos + num_bytes > inlen)
+                    break;
+                len = 0;
+                for (uint32_t i = 0; i < num_bytes; i++)
+                {
+                    len |= (size_t)input[src_pos + i] << (8 * i);
+                }
+                src_pos += num_bytes;
+            }
+            len += 1;
+            if (src_pos + len > inlen || dst_pos + len > uncomp_len)
+                break;
+            memcpy(dst + dst_pos, input + src_pos, len);
+            src_pos += len;
+            dst_pos += len;
+            continue;
+        }
+
+        if ((tag & 3) == SNAPPY_TAG_COPY1)
+        {
+            if (src_pos + 1 > inlen)
+                break;
+            len = ((tag >> 2) & 7) + 4;
+            offset = ((tag >> 5) << 8) | input[src_pos];
+            src_pos += 1;
+        }
+        else
+        {
+            uint32_t num_bytes = ((tag & 3) == SNAPPY_TAG_COPY2) ? 2 : 4;
+            if (src_pos + num_bytes > inlen)
+                break;
+            len = (tag >> 2) + 1;
+            offset = 0;
+            for (uint32_t i = 0; i < num_bytes; i++)
+            {
+                offset |= (size_t)input[src_pos + i] << (8 * i);
+            }
+            src_pos += num_bytes;
+        }
+        if (offset == 0 || offset > dst_pos || dst_pos + len > uncomp_len)
+            break;
+        // The source and destination may overlap, which repeats the last offset bytes
+        for (size_t i = 0; i < len; i++)
+        {
+            dst[dst_pos + i] = dst[dst_pos + i - offset];
+        }
+        dst_pos += len;
+    }
+    *dstlen = dst_pos;
+    return (src_pos == inlen && dst_pos == uncomp_len) ? SNAPPY_OK : SNAPPY_DATA_ERROR;
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "cudf.h"
+#include "io_uncomp.h" // stream types
+
+/*
+ * Streaming compression, for writers that produce their output in chunks.
+ * The stream types are the IO_UNCOMP_STREAM_TYPE_XXX ones that can be written:
+ * IO_UNCOMP_STREAM_TYPE_GZIP and IO_UNCOMP_STREAM_TYPE_INFLATE (raw deflate).
+ */
+struct io_comp_stream_s;
+
+gdf_error io_compress_begin(io_comp_stream_s **strm, int strm_type);
+
+gdf_error io_compress_append(io_comp_stream_s *strm, const void *src, size_t src_size, bool last, std::vector<char>& dst);
+
+void io_compress_end(io_comp_stream_s *strm);
@@ -26,7 +26,11 @@ enum {
     IO_UNCOMP_STREAM_TYPE_ZIP   = 2,
     IO_UNCOMP_STREAM_TYPE_BZIP2 = 3,
     IO_UNCOMP_STREAM_TYPE_XZ    = 4,
+    IO_UNCOMP_STREAM_TYPE_SNAPPY = 5,  // Raw snappy block, never inferred
+    IO_UNCOMP_STREAM_TYPE_INFLATE = 6, // Raw deflate data without headers, never inferred
 };
 
 gdf_error io_uncompress_single_h2d(const void *src, gdf_size_type src_size, int strm_type, std::vector<char>& dst);
 
+gdf_error io_uncompress_block(const void *src, size_t src_size, int strm_type, void *dst, size_t *dst_size);
+
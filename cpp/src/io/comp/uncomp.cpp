@@ -20,6 +20,7 @@
 #include <string.h> // memset
 #include <zlib.h> // uncompress
 #include "unbz2.h" // bz2 uncompress
+#include "unsnap.h" // snappy uncompress
 
 #define GZ_FLG_FTEXT    0x01    // ASCII text hint
 #define GZ_FLG_FHCRC    0x02    // Header CRC present
@@ -374,6 +375,14 @@ gdf_error io_uncompress_single_h2d(const void *src, gdf_size_type src_size, int
         }
         if (strm_type != IO_UNCOMP_STREAM_TYPE_INFER)
             break; // Fall through for INFER     
+    case IO_UNCOMP_STREAM_TYPE_SNAPPY:
+        // Raw snappy blocks have no signature to infer them from
+        if (strm_type == IO_UNCOMP_STREAM_TYPE_SNAPPY && cpu_snappy_uncompressed_length(raw, src_size, &uncomp_len) > 0)
+        {
+            comp_data = raw;
+            comp_len = src_size;
+        }
+        break;
     default:
         // Unsupported format
         break;
@@ -427,6 +436,17 @@ gdf_error io_uncompress_single_h2d(const void *src, gdf_size_type src_size, int
             return GDF_FILE_ERROR;
         }
     }
+    else if (strm_type == IO_UNCOMP_STREAM_TYPE_SNAPPY)
+    {
+        dst.resize(uncomp_len);
+        size_t dst_len = uncomp_len;
+        if (cpu_snappy_uncompress(comp_data, comp_len, (uint8_t*)dst.data(), &dst_len) != SNAPPY_OK)
+        {
+            dst.resize(0);
+            return GDF_FILE_ERROR;
+        }
+        dst.resize(dst_len);
+    }
     else
     {
         return GDF_UNSUPPORTED_DTYPE;
@@ -436,4 +456,44 @@ gdf_error io_uncompress_single_h2d(const void *src, gdf_size_type src_size, int
 }
 
 
-
+/* --------------------------------------------------------------------------*/
+/** 
+ * @Brief Uncompresses a single raw deflate or snappy block into a buffer
+ * large enough for it, as in formats that compress their data in blocks of
+ * bounded size.
+ * 
+ * @param src[in] Pointer to the compressed block in system memory
+ * @param src_size[in] The size of the compressed block, in bytes
+ * @param strm_type[in] IO_UNCOMP_STREAM_TYPE_INFLATE or IO_UNCOMP_STREAM_TYPE_SNAPPY
+ * @param dst[out] The uncompressed output in system memory
+ * @param dst_size[in,out] The size of dst, returns the uncompressed size
+ * 
+ * @returns gdf_error with error code on failure, otherwise GDF_SUCCESS
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error io_uncompress_block(const void *src, size_t src_size, int strm_type, void *dst, size_t *dst_size)
+{
+    if (!(src && src_size && dst && dst_size))
+    {
+        return GDF_INVALID_API_CALL;
+    }
+    if (strm_type == IO_UNCOMP_STREAM_TYPE_INFLATE)
+    {
+        if (cpu_inflate((uint8_t *)dst, dst_size, (const uint8_t *)src, src_size) != 0)
+        {
+            return GDF_FILE_ERROR;
+        }
+    }
+    else if (strm_type == IO_UNCOMP_STREAM_TYPE_SNAPPY)
+    {
+        if (cpu_snappy_uncompress((const uint8_t *)src, src_size, (uint8_t *)dst, dst_size) != SNAPPY_OK)
+        {
+            return GDF_FILE_ERROR;
+        }
+    }
+    else
+    {
+        return GDF_UNSUPPORTED_DTYPE;
+    }
+    return GDF_SUCCESS;
+}
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SNAPPY_OK               0
+#define SNAPPY_DATA_ERROR       (-1)
+#define SNAPPY_OUTBUFF_FULL     (-2)
+
+// Reads the uncompressed length stored at the start of a raw snappy block, returns the size of the length in bytes (0 on error)
+size_t cpu_snappy_uncompressed_length(const uint8_t *input, size_t inlen, size_t *uncomp_len);
+
+// Uncompresses a raw snappy block (without the framing format). On input, *dstlen is the size of dst, on output the number of bytes written.
+int32_t cpu_snappy_uncompress(const uint8_t *input, size_t inlen, uint8_t *dst, size_t *dstlen);
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -52,19 +53,16 @@
 #include "utilities/error_utils.h"
 #include "utilities/trie.cuh"
 #include "utilities/type_dispatcher.hpp"
+#include "utilities/allocator.hpp"
 
 #include "rmm/rmm.h"
 #include "rmm/thrust_rmm_allocator.h"
 #include "io/comp/io_uncomp.h"
-
-constexpr size_t max_chunk_bytes = 64*1024*1024; // 64MB
+#include "io/utilities/parsing_utils.cuh"
 
 using std::vector;
 using std::string;
 
-using cu_reccnt_t = unsigned long long int;
-using cu_recstart_t = unsigned long long int;
-
 
 /**---------------------------------------------------------------------------*
  * @brief Struct used for internal parsing state
@@ -125,7 +123,6 @@ gdf_error getUncompressedHostData(const char* h_data, size_t num_bytes,
 	vector<char>& h_uncomp_data);
 gdf_error uploadDataToDevice(const char* h_uncomp_data, size_t h_uncomp_size, raw_csv_t * raw_csv);
 gdf_error allocateGdfDataSpace(gdf_column *);
-gdf_dtype convertStringToDtype(std::string &dtype);
 
 #define checkError(error, txt)  if ( error != GDF_SUCCESS) { std::cerr << "ERROR:  " << error <<  "  in "  << txt << std::endl;  return error; }
 
@@ -135,17 +132,10 @@ gdf_dtype convertStringToDtype(std::string &dtype);
 
 __device__ int findSetBit(int tid, long num_bits, uint64_t *f_bits, int x);
 
-gdf_error launch_countRecords(const char* h_data, size_t h_size, raw_csv_t * raw_csv, gdf_size_type& rec_cnt);
-gdf_error launch_storeRecordStart(const char* h_data, size_t h_size, raw_csv_t * csvData);
 gdf_error launch_dataConvertColumns(raw_csv_t * raw_csv, void** d_gdf,  gdf_valid_type** valid, gdf_dtype* d_dtypes, string_pair **str_cols, unsigned long long *);
 
 gdf_error launch_dataTypeDetection(raw_csv_t * raw_csv, column_data_t* d_columnData);
 
-__global__ void countRecords(char *data, const char terminator, const char quotechar, long num_bytes, long num_bits, cu_reccnt_t* num_records);
-__global__ void storeRecordStart(char *data, size_t chunk_offset, 
-	const char terminator, const char quotechar, bool include_first_row,
-	long num_bytes, long num_bits, cu_reccnt_t* num_records,
-	cu_recstart_t* recStart);
 __global__ void convertCsvToGdf(char *csv, const ParseOptions opts,
 	gdf_size_type num_records, int num_columns, bool *parseCol,
 	cu_recstart_t *recStart, gdf_dtype *dtype, void **gdf_data, gdf_valid_type **valid,
@@ -294,7 +284,8 @@ gdf_error read_csv(csv_read_arg *args)
 	//-----------------------------------------------------------------------------
 	// create the CSV data structure - this will be filled in as the CSV data is processed.
 	// Done first to validate data types
-	raw_csv_t * raw_csv = new raw_csv_t();
+	auto raw_csv_owner = std::make_unique<raw_csv_t>();
+	raw_csv_t * raw_csv = raw_csv_owner.get();
 	// error = parseArguments(args, raw_csv);
 	raw_csv->num_actual_cols	= args->num_cols;
 	raw_csv->num_active_cols	= args->num_cols;
@@ -465,7 +456,8 @@ gdf_error read_csv(csv_read_arg *args)
 	assert(h_uncomp_data != nullptr);
 	assert(h_uncomp_size != 0);
 
-	error = launch_countRecords(h_uncomp_data, h_uncomp_size, raw_csv, raw_csv->num_records);
+	error = launch_countRecords(h_uncomp_data, h_uncomp_size, raw_csv->opts.terminator, raw_csv->opts.quotechar,
+	                            raw_csv->byte_range_offset == 0, raw_csv->num_records);
 	checkError(error, "call to record number of rows");
 
 	//-----------------------------------------------------------------------------
@@ -474,7 +466,8 @@ gdf_error read_csv(csv_read_arg *args)
 
 	//-----------------------------------------------------------------------------
 	//-- Scan data and set the starting positions
-	error = launch_storeRecordStart(h_uncomp_data, h_uncomp_size, raw_csv);
+	error = launch_storeRecordStart(h_uncomp_data, h_uncomp_size, raw_csv->opts.terminator, raw_csv->opts.quotechar,
+	                                raw_csv->byte_range_offset == 0, raw_csv->recStart);
 	checkError(error, "call to record initial position store");
 
 	// Previous kernel stores the record pinput_file.typeositions as encountered by all threads
@@ -530,7 +523,7 @@ gdf_error read_csv(csv_read_arg *args)
 
 		// Allocating a boolean array that will use to state if a column needs to read or filtered.
 		raw_csv->h_parseCol = (bool*)malloc(sizeof(bool) * (h_num_cols));
-		RMM_TRY( RMM_ALLOC((void**)&raw_csv->d_parseCol,(sizeof(bool) * (h_num_cols)),0 ) );
+		SCRATCH_ALLOC_TRY(&raw_csv->d_parseCol, (sizeof(bool) * (h_num_cols)), 0);
 		for (int i = 0; i<h_num_cols; i++)
 			raw_csv->h_parseCol[i]=true;
 		
@@ -579,7 +572,7 @@ gdf_error read_csv(csv_read_arg *args)
 	}
 	else {
 		raw_csv->h_parseCol = (bool*)malloc(sizeof(bool) * (args->num_cols));
-		RMM_TRY( RMM_ALLOC((void**)&raw_csv->d_parseCol,(sizeof(bool) * (args->num_cols)),0 ) );
+		SCRATCH_ALLOC_TRY(&raw_csv->d_parseCol, (sizeof(bool) * (args->num_cols)), 0);
 
 		for (int i = 0; i<raw_csv->num_actual_cols; i++){
 			raw_csv->h_parseCol[i]=true;
@@ -641,7 +634,7 @@ gdf_error read_csv(csv_read_arg *args)
 		column_data_t *d_ColumnData,*h_ColumnData;
 
 		h_ColumnData = (column_data_t*)malloc(sizeof(column_data_t) * (raw_csv->num_active_cols));
-		RMM_TRY( RMM_ALLOC((void**)&d_ColumnData,(sizeof(column_data_t) * (raw_csv->num_active_cols)),0 ) );
+		SCRATCH_ALLOC_TRY(&d_ColumnData, (sizeof(column_data_t) * (raw_csv->num_active_cols)), 0);
 
 		CUDA_TRY( cudaMemset(d_ColumnData,	0, 	(sizeof(column_data_t) * (raw_csv->num_active_cols)) ) ) ;
 
@@ -677,7 +670,7 @@ gdf_error read_csv(csv_read_arg *args)
 		raw_csv->dtypes=d_detectedTypes;
 
 		free(h_ColumnData);
-		RMM_TRY( RMM_FREE( d_ColumnData, 0 ) );
+		SCRATCH_FREE_TRY(d_ColumnData, 0);
 	}
 	else{
 		for ( int x = 0; x < raw_csv->num_actual_cols; x++) {
@@ -710,10 +703,10 @@ gdf_error read_csv(csv_read_arg *args)
 	h_data 			= (void**)malloc (	sizeof(void*)* (raw_csv->num_active_cols));
 	h_valid 		= (gdf_valid_type**)malloc (	sizeof(gdf_valid_type*)* (raw_csv->num_active_cols));
 
-	RMM_TRY( RMM_ALLOC((void**)&d_dtypes, 		(sizeof(gdf_dtype) 			* raw_csv->num_active_cols), 0 ) );
-	RMM_TRY( RMM_ALLOC((void**)&d_data, 		(sizeof(void *)				* raw_csv->num_active_cols), 0 ) );
-	RMM_TRY( RMM_ALLOC((void**)&d_valid, 		(sizeof(gdf_valid_type *)	* raw_csv->num_active_cols), 0 ) );
-	RMM_TRY( RMM_ALLOC((void**)&d_valid_count, 	(sizeof(unsigned long long) * raw_csv->num_active_cols), 0 ) );
+	SCRATCH_ALLOC_TRY(&d_dtypes, (sizeof(gdf_dtype) * raw_csv->num_active_cols), 0);
+	SCRATCH_ALLOC_TRY(&d_data, (sizeof(void *) * raw_csv->num_active_cols), 0);
+	SCRATCH_ALLOC_TRY(&d_valid, (sizeof(gdf_valid_type *) * raw_csv->num_active_cols), 0);
+	SCRATCH_ALLOC_TRY(&d_valid_count, (sizeof(unsigned long long) * raw_csv->num_active_cols), 0);
 	CUDA_TRY( cudaMemset(d_valid_count,	0, 		(sizeof(unsigned long long)	* raw_csv->num_active_cols)) );
 
 
@@ -727,10 +720,10 @@ gdf_error read_csv(csv_read_arg *args)
 
 	if (stringColCount > 0 ) {
 		h_str_cols = (string_pair**) malloc ((sizeof(string_pair *)	* stringColCount));
-		RMM_TRY( RMM_ALLOC((void**)&d_str_cols, 	(sizeof(string_pair *)		* stringColCount), 0) );
+		SCRATCH_ALLOC_TRY(&d_str_cols, (sizeof(string_pair *) * stringColCount), 0);
 
 		for (int col = 0; col < stringColCount; col++) {
-			RMM_TRY( RMM_ALLOC((void**)(h_str_cols + col), sizeof(string_pair) * (raw_csv->num_records), 0) );
+			SCRATCH_ALLOC_TRY((h_str_cols + col), sizeof(string_pair) * (raw_csv->num_records), 0);
 		}
 
 		CUDA_TRY(cudaMemcpy(d_str_cols, h_str_cols, sizeof(string_pair *)	* stringColCount, cudaMemcpyHostToDevice));
@@ -802,7 +795,7 @@ gdf_error read_csv(csv_read_arg *args)
 				gdf->data = stringCol;
 			}
 
-			RMM_TRY( RMM_FREE( h_str_cols [stringColCount], 0 ) );
+			SCRATCH_FREE_TRY(h_str_cols[stringColCount], 0);
 
 			stringColCount++;
 		}
@@ -823,53 +816,27 @@ gdf_error read_csv(csv_read_arg *args)
 	free(raw_csv->h_parseCol);
 
 	if (d_str_cols != NULL)
-		RMM_TRY( RMM_FREE( d_str_cols, 0 ) ); 
+		SCRATCH_FREE_TRY(d_str_cols, 0); 
 
-	RMM_TRY( RMM_FREE( d_valid, 0 ) );
-	RMM_TRY( RMM_FREE( d_valid_count, 0 ) );
-	RMM_TRY( RMM_FREE( d_dtypes, 0 ) );
-	RMM_TRY( RMM_FREE( d_data, 0 ) ); 
+	SCRATCH_FREE_TRY(d_valid, 0);
+	SCRATCH_FREE_TRY(d_valid_count, 0);
+	SCRATCH_FREE_TRY(d_dtypes, 0);
+	SCRATCH_FREE_TRY(d_data, 0); 
 
 	RMM_TRY( RMM_FREE( raw_csv->recStart, 0 ) ); 
-	RMM_TRY( RMM_FREE( raw_csv->d_parseCol, 0 ) ); 
-	RMM_TRY( RMM_FREE ( raw_csv->data, 0) );
+	SCRATCH_FREE_TRY(raw_csv->d_parseCol, 0); 
+	SCRATCH_FREE_TRY(raw_csv->data, 0);
 
 
 	args->data 			= cols;
 	args->num_cols_out	= raw_csv->num_active_cols;
 	args->num_rows_out	= raw_csv->num_records;
 
-	delete raw_csv;
 	return error;
 }
 
 
 
-/*
- * What is passed in is the data type as a string, need to convert that into gdf_dtype enum
- */
-gdf_dtype convertStringToDtype(std::string &dtype) {
-
-	if (dtype.compare( "str") == 0) 		return GDF_STRING;
-	if (dtype.compare( "date") == 0) 		return GDF_DATE64;
-	if (dtype.compare( "date32") == 0) 		return GDF_DATE32;
-	if (dtype.compare( "date64") == 0) 		return GDF_DATE64;
-	if (dtype.compare( "timestamp") == 0)	return GDF_TIMESTAMP;
-	if (dtype.compare( "category") == 0) 	return GDF_CATEGORY;
-	if (dtype.compare( "float") == 0)		return GDF_FLOAT32;
-	if (dtype.compare( "float32") == 0)		return GDF_FLOAT32;
-	if (dtype.compare( "float64") == 0)		return GDF_FLOAT64;
-	if (dtype.compare( "double") == 0)		return GDF_FLOAT64;
-	if (dtype.compare( "short") == 0)		return GDF_INT16;
-	if (dtype.compare( "int") == 0)			return GDF_INT32;
-	if (dtype.compare( "int32") == 0)		return GDF_INT32;
-	if (dtype.compare( "int64") == 0)		return GDF_INT64;
-	if (dtype.compare( "long") == 0)		return GDF_INT64;
-
-	return GDF_invalid;
-}
-
-
 /**---------------------------------------------------------------------------*
  * @brief Infer the compression type from the compression parameter and 
  * the input file name
@@ -1038,7 +1005,7 @@ gdf_error uploadDataToDevice(const char *h_uncomp_data, size_t h_uncomp_size,
                       cudaMemcpyDefault));
 
   // Upload the raw data that is within the rows of interest
-  RMM_TRY(RMM_ALLOC(&raw_csv->data, raw_csv->num_bytes, 0));
+  SCRATCH_ALLOC_TRY(&raw_csv->data, raw_csv->num_bytes, 0);
   CUDA_TRY(cudaMemcpy(raw_csv->data, h_uncomp_data + start_offset,
                       raw_csv->num_bytes, cudaMemcpyHostToDevice));
 
@@ -1090,245 +1057,6 @@ gdf_error allocateGdfDataSpace(gdf_column *col) {
 //----------------------------------------------------------------------------------------------------------------
 
 
-/**---------------------------------------------------------------------------*
- * @brief Counts the number of rows in the input csv file.
- * 
- * Does not load the entire file into the GPU memory at any time, so it can 
- * be used to parse large files.
- * Does not take quotes into consideration, so it will return extra rows
- * if the line terminating characters are present within quotes.
- * Because of this the result should be postprocessed to remove 
- * the fake line endings.
- * 
- * @param[in] h_data Pointer to the csv data in host memory
- * @param[in] h_size Size of the input data, in bytes
- * @param[in] terminator Line terminator character
- * @param[in] quote Quote character
- * @param[out] rec_cnt The resulting number of rows (records)
- * 
- * @return gdf_error with error code on failure, otherwise GDF_SUCCESS
- *---------------------------------------------------------------------------**/
-gdf_error launch_countRecords(const char *h_data, size_t h_size,
-                              raw_csv_t *raw_csv, gdf_size_type &rec_cnt)
-{
-	const size_t chunk_count = (h_size + max_chunk_bytes - 1) / max_chunk_bytes;
-	rmm::device_vector<cu_reccnt_t> d_counts(chunk_count);
-
-	char* d_chunk = nullptr;
-	RMM_TRY(RMM_ALLOC (&d_chunk, max_chunk_bytes, 0)); 
-
-	int blockSize;		// suggested thread count to use
-	int minGridSize;	// minimum block count required
-	CUDA_TRY(cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, countRecords));
-
-	for (size_t ci = 0; ci < chunk_count; ++ci) {
-		const auto h_chunk = h_data + ci * max_chunk_bytes;
-		const auto chunk_bytes = std::min((size_t)(h_size - ci * max_chunk_bytes), max_chunk_bytes);
-		const auto chunk_bits = (chunk_bytes + 63) / 64;
-
-		// Copy chunk to device
-		CUDA_TRY(cudaMemcpy(d_chunk, h_chunk, chunk_bytes, cudaMemcpyDefault));
-
-		const int gridSize = (chunk_bits + blockSize - 1) / blockSize;
-		countRecords <<< gridSize, blockSize >>> (
-			d_chunk, raw_csv->opts.terminator, raw_csv->opts.quotechar,
-			chunk_bytes, chunk_bits, thrust::raw_pointer_cast(&d_counts[ci])
-			);
-	}
-
-	RMM_TRY( RMM_FREE(d_chunk, 0) );
-
-	CUDA_TRY(cudaGetLastError());
-
-	// Row count is used to allocate/track row start positions
-	// If not starting at an offset, add an extra row to account for offset=0
-	rec_cnt = thrust::reduce(rmm::exec_policy()->on(0), d_counts.begin(), d_counts.end());
-	if (raw_csv->byte_range_offset == 0) {
-		rec_cnt++;
-	}
-
-	return GDF_SUCCESS;
-}
-
-
-/**---------------------------------------------------------------------------* 
- * @brief CUDA kernel that counts the number of rows in the given 
- * file segment, based on the location of line terminators. 
- * 
- * @param[in] data Device memory pointer to the csv data, 
- * potentially a chunk of the whole file
- * @param[in] terminator Line terminator character
- * @param[in] quotechar Quote character
- * @param[in] num_bytes Number of bytes in the input data
- * @param[in] num_bits Number of 'bits' in the input data. Each 'bit' is
- * processed by a separate CUDA thread
- * @param[in,out] num_records Device memory pointer to the number of found rows
- * 
- * @return gdf_error with error code on failure, otherwise GDF_SUCCESS
- *---------------------------------------------------------------------------**/
-__global__ void countRecords(char *data, const char terminator, const char quotechar, long num_bytes, long num_bits, 
-	cu_reccnt_t* num_records) {
-
-	// thread IDs range per block, so also need the block id
-	const long tid = threadIdx.x + (blockDim.x * blockIdx.x);
-
-	if (tid >= num_bits)
-		return;
-
-	// data ID is a multiple of 64
-	const long did = tid * 64L;
-
-	const char *raw = (data + did);
-
-	const long byteToProcess = ((did + 64L) < num_bytes) ? 64L : (num_bytes - did);
-
-	// process the data
-	cu_reccnt_t tokenCount = 0;
-	for (long x = 0; x < byteToProcess; x++) {
-		
-		// Scan and log records. If quotations are enabled, then also log quotes
-		// for a postprocess ignore, as the chunk here has limited visibility.
-		if ((raw[x] == terminator) || (quotechar != '\0' && raw[x] == quotechar)) {
-			tokenCount++;
-		} else if (terminator == '\n' && (x + 1L) < byteToProcess && 
-		           raw[x] == '\r' && raw[x + 1L] == '\n') {
-			x++;
-			tokenCount++;
-		}
-
-	}
-	atomicAdd(num_records, tokenCount);
-}
-
-
-/**---------------------------------------------------------------------------*
- * @brief Finds the start of each row (record) in the given file, based on
- * the location of line terminators. The offset of each found row is stored 
- * in the recStart data member of the csvData parameter.
- * 
- * Does not load the entire file into the GPU memory at any time, so it can 
- * be used to parse large files.
- * Does not take quotes into consideration, so it will return extra rows
- * if the line terminating characters are present within quotes.
- * Because of this the result should be postprocessed to remove 
- * the fake line endings.
- * 
- * @param[in] h_data Pointer to the csv data in host memory
- * @param[in] h_size Size of the input data, in bytes
- * @param[in,out] csvData Structure containing the csv parsing parameters
- * and intermediate results
- * 
- * @return gdf_error with error code on failure, otherwise GDF_SUCCESS
- *---------------------------------------------------------------------------**/
-gdf_error launch_storeRecordStart(const char *h_data, size_t h_size,
-                                  raw_csv_t *csvData) {
-
-	char* d_chunk = nullptr;
-	// Allocate extra byte in case \r\n is at the chunk border
-	RMM_TRY(RMM_ALLOC (&d_chunk, max_chunk_bytes + 1, 0)); 
-	
-	cu_reccnt_t*	d_num_records;
-	RMM_TRY(RMM_ALLOC((void**)&d_num_records, sizeof(cu_reccnt_t), 0) );
-	CUDA_TRY(cudaMemset(d_num_records, 0ull, sizeof(cu_reccnt_t)));
-
-	int blockSize;		// suggested thread count to use
-	int minGridSize;	// minimum block count required
-	CUDA_TRY(cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, storeRecordStart) );
-
-	const size_t chunk_count = (h_size + max_chunk_bytes - 1) / max_chunk_bytes;
-	for (size_t ci = 0; ci < chunk_count; ++ci) {	
-		const auto chunk_offset = ci * max_chunk_bytes;	
-		const auto h_chunk = h_data + chunk_offset;
-		const auto chunk_bytes = std::min((size_t)(h_size - ci * max_chunk_bytes), max_chunk_bytes);
-		const auto chunk_bits = (chunk_bytes + 63) / 64;
-		// include_first_row should only apply to the first chunk
-		const bool cu_include_first_row = (ci == 0) && (csvData->byte_range_offset == 0);
-		
-		// Copy chunk to device. Copy extra byte if not last chunk
-		CUDA_TRY(cudaMemcpy(d_chunk, h_chunk, ci < (chunk_count - 1)?chunk_bytes:chunk_bytes + 1, cudaMemcpyDefault));
-
-		const int gridSize = (chunk_bits + blockSize - 1) / blockSize;
-		storeRecordStart <<< gridSize, blockSize >>> (
-			d_chunk, chunk_offset, csvData->opts.terminator, csvData->opts.quotechar, cu_include_first_row,
-			chunk_bytes, chunk_bits, d_num_records,
-			csvData->recStart
-		);
-	}
-
-	RMM_TRY( RMM_FREE( d_num_records, 0 ) ); 
-	RMM_TRY( RMM_FREE( d_chunk, 0 ) );
-
-	CUDA_TRY( cudaGetLastError() );
-
-	return GDF_SUCCESS;
-}
-
-
-/**---------------------------------------------------------------------------*
- * @brief CUDA kernel that finds the start of each row (record) in the given 
- * file segment, based on the location of line terminators. 
- * 
- * The offset of each found row is stored in a device memory array. 
- * The kernel operate on a segment (chunk) of the csv file.
- * 
- * @param[in] data Device memory pointer to the csv data, 
- * potentially a chunk of the whole file
- * @param[in] chunk_offset Offset of the data pointer from the start of the file
- * @param[in] terminator Line terminator character
- * @param[in] quotechar Quote character
- * @param[in] num_bytes Number of bytes in the input data
- * @param[in] num_bits Number of 'bits' in the input data. Each 'bit' is
- * processed by a separate CUDA thread
- * @param[in,out] num_records Device memory pointer to the number of found rows
- * @param[out] recStart device memory array containing the offset of each record
- * 
- * @return void
- *---------------------------------------------------------------------------**/
-__global__ void storeRecordStart(char *data, size_t chunk_offset, 
-	const char terminator, const char quotechar, bool include_first_row,
-	long num_bytes, long num_bits, cu_reccnt_t* num_records,
-	cu_recstart_t* recStart) {
-
-	// thread IDs range per block, so also need the block id
-	const long tid = threadIdx.x + (blockDim.x * blockIdx.x);
-
-	if ( tid >= num_bits)
-		return;
-
-	// data ID - multiple of 64
-	const long did = tid * 64L;
-
-	if (did == 0 && include_first_row) {
-		const auto pos = atomicAdd(num_records, 1ull);
-		recStart[pos] = 0;
-	}
-
-	const char *raw = (data + did);
-
-	const long byteToProcess = ((did + 64L) < num_bytes) ? 64L : (num_bytes - did);
-
-	// process the data
-	for (long x = 0; x < byteToProcess; x++) {
-
-		// Scan and log records. If quotations are enabled, then also log quotes
-		// for a postprocess ignore, as the chunk here has limited visibility.
-		if ((raw[x] == terminator) || (quotechar != '\0' && raw[x] == quotechar)) {
-
-			const auto pos = atomicAdd(num_records, 1ull);
-			recStart[pos] = did + chunk_offset + x + 1;
-
-		} else if (terminator == '\n' && (x + 1L) < byteToProcess && 
-				   raw[x] == '\r' && raw[x + 1L] == '\n') {
-
-			x++;
-			const auto pos = atomicAdd(num_records, 1ull);
-			recStart[pos] = did + chunk_offset + x + 1;
-		}
-
-	}
-}
-
-
 /**---------------------------------------------------------------------------*
  * @brief Helper function to setup and launch CSV parsing CUDA kernel.
  * 
@@ -1362,51 +1090,6 @@ gdf_error launch_dataConvertColumns(raw_csv_t *raw_csv, void **gdf,
   return GDF_SUCCESS;
 }
 
-/**---------------------------------------------------------------------------*
- * @brief Functor for converting CSV data to cuDF data type value.
- *---------------------------------------------------------------------------**/
-struct ConvertFunctor {
-  /**---------------------------------------------------------------------------*
-   * @brief Template specialization for operator() that handles integer types
-   * that additionally checks whether the parsed data value should be overridden
-   * with user-specified true/false matches.
-   *
-   * It is handled here rather than within convertStrToValue() as that function
-   * is already used to construct the true/false match list from user-provided
-   * strings at the start of parsing.
-   *---------------------------------------------------------------------------**/
-  template <typename T,
-            typename std::enable_if_t<std::is_integral<T>::value> * = nullptr>
-  __host__ __device__ __forceinline__ void operator()(
-      const char *csvData, void *gdfColumnData, long rowIndex, long start,
-      long end, const ParseOptions &opts) {
-    T &value{static_cast<T *>(gdfColumnData)[rowIndex]};
-    value = convertStrToValue<T>(csvData, start, end, opts);
-
-    // Check for user-specified true/false values where the output is
-    // replaced with 1/0 respectively
-    const size_t field_len = end - start + 1;
-    if (serializedTrieContains(opts.trueValuesTrie, csvData + start, field_len)) {
-      value = 1;
-    } else if (serializedTrieContains(opts.falseValuesTrie, csvData + start, field_len)) {
-      value = 0;
-    }
-  }
-
-  /**---------------------------------------------------------------------------*
-   * @brief Default template operator() dispatch specialization all data types
-   * (including wrapper types) that is not covered by integral specialization.
-   *---------------------------------------------------------------------------**/
-  template <typename T,
-            typename std::enable_if_t<!std::is_integral<T>::value> * = nullptr>
-  __host__ __device__ __forceinline__ void operator()(
-      const char *csvData, void *gdfColumnData, long rowIndex, long start,
-      long end, const ParseOptions &opts) {
-    T &value{static_cast<T *>(gdfColumnData)[rowIndex]};
-    value = convertStrToValue<T>(csvData, start, end, opts);
-  }
-};
-
 /**---------------------------------------------------------------------------*
  * @brief CUDA kernel iterates over the data until the end of the current field
  * 
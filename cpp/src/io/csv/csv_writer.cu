@@ -0,0 +1,902 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Writes gdf_columns as CSV
+ *
+ * Every row is formatted by its own thread, in two passes: the first one
+ * computes the length of each row, whose scan gives where each row goes,
+ * and the second one writes the text. The text is produced in chunks of
+ * about chunk_bytes, and each chunk is written to the file, compressed if
+ * requested, while the next one is formatted.
+ *
+ * @file csv_writer.cu
+ * ---------------------------------------------------------------------------**/
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <thrust/binary_search.h>
+#include <thrust/scan.h>
+
+#include <NVStrings.h>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "io/comp/io_comp.h"
+
+gdf_error inferCompressionType(const char* compression_arg, const char* filepath, std::string& compression_type);
+
+namespace { // unnamed namespace
+
+  using string_pair = std::pair<const char*, size_t>;
+
+  // The rows are formatted and written in chunks of about this many bytes
+  constexpr size_t chunk_bytes = 64 * 1024 * 1024;
+
+  // The longest text of a value that is not a string
+  constexpr int max_value_chars = 40;
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief What the formatting kernels need to know about a column
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct column_info
+  {
+    gdf_dtype dtype;
+    gdf_time_unit time_unit;
+    const void* data;
+    const gdf_valid_type* valid;
+    const string_pair* strings;   // The strings of a GDF_STRING column
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The options of write_csv, the strings are in device memory
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct format_options
+  {
+    char delimiter;
+    char quotechar;
+    bool quote_all;
+    const char* terminator;
+    int terminator_length;
+    const char* na_rep;
+    int na_rep_length;
+  };
+
+  __host__ __device__ inline uint64_t power_of_ten(int exponent)
+  {
+    uint64_t value = 1;
+    while (exponent-- > 0) {
+      value *= 10;
+    }
+    return value;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes the digits of value, padded with zeros to at least width
+   * digits
+   *
+   * @returns The number of characters written
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline int format_digits(uint64_t value, int width, char* out)
+  {
+    char digits[20];
+    int count = 0;
+    do {
+      digits[count++] = '0' + value % 10;
+      value /= 10;
+    } while (value != 0);
+    int length = 0;
+    for (; length < width - count; ++length) {
+      out[length] = '0';
+    }
+    while (count > 0) {
+      out[length++] = digits[--count];
+    }
+    return length;
+  }
+
+  __host__ __device__ inline int format_integer(int64_t value, char* out)
+  {
+    if (value < 0) {
+      out[0] = '-';
+      return 1 + format_digits(-static_cast<uint64_t>(value), 1, out + 1);
+    }
+    return format_digits(value, 1, out);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The normalized powers of ten 10^-348, 10^-340, ..., 10^340, as
+   * 64-bit significands and binary exponents, used to scale the binary
+   * values into the range of the digit generation of Grisu2
+   */
+  /* ----------------------------------------------------------------------------*/
+  __constant__ uint64_t cached_power_significands[] = {
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull,
+    0xcf42894a5dce35eaull, 0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull,
+    0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full, 0xbe5691ef416bd60cull,
+    0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull,
+    0xc21094364dfb5637ull, 0x9096ea6f3848984full, 0xd77485cb25823ac7ull,
+    0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull, 0xb23867fb2a35b28eull,
+    0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull,
+    0xb5b5ada8aaff80b8ull, 0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull,
+    0x964e858c91ba2655ull, 0xdff9772470297ebdull, 0xa6dfbd9fb8e5b88full,
+    0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull,
+    0xaa242499697392d3ull, 0xfd87b5f28300ca0eull, 0xbce5086492111aebull,
+    0x8cbccc096f5088ccull, 0xd1b71758e219652cull, 0x9c40000000000000ull,
+    0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull,
+    0x9f4f2726179a2245ull, 0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull,
+    0x83c7088e1aab65dbull, 0xc45d1df942711d9aull, 0x924d692ca61be758ull,
+    0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull,
+    0x952ab45cfa97a0b3ull, 0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull,
+    0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull, 0x88fcf317f22241e2ull,
+    0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull,
+    0x8bab8eefb6409c1aull, 0xd01fef10a657842cull, 0x9b10a4e5e9913129ull,
+    0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull, 0x80444b5e7aa7cf85ull,
+    0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull
+  };
+  __constant__ int16_t cached_power_exponents[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A floating point number with a 64-bit significand, f * 2^e
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct diy_fp
+  {
+    uint64_t f;
+    int e;
+  };
+
+  __device__ inline diy_fp multiply(diy_fp a, diy_fp b)
+  {
+    const uint64_t m32 = 0xffffffffull;
+    const uint64_t ac = (a.f >> 32) * (b.f >> 32);
+    const uint64_t bc = (a.f & m32) * (b.f >> 32);
+    const uint64_t ad = (a.f >> 32) * (b.f & m32);
+    const uint64_t bd = (a.f & m32) * (b.f & m32);
+    uint64_t tmp = (bd >> 32) + (ad & m32) + (bc & m32);
+    tmp += 1ull << 31;  // Round
+    return diy_fp{ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), a.e + b.e + 64};
+  }
+
+  __device__ inline diy_fp normalize(diy_fp x)
+  {
+    while (!(x.f & (1ull << 63))) {
+      x.f <<= 1;
+      --x.e;
+    }
+    return x;
+  }
+
+  // Moves the last digit of the digits down while that brings them closer to
+  // the value and keeps them inside its rounding interval
+  __device__ inline void grisu_round(char* digits, int length, uint64_t delta, uint64_t rest,
+                                     uint64_t ten_kappa, uint64_t wp_w)
+  {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+      --digits[length - 1];
+      rest += ten_kappa;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Computes the shortest digits that read back as value, with the
+   * Grisu2 algorithm of Florian Loitsch, "Printing Floating-Point Numbers
+   * Quickly and Accurately with Integers"
+   *
+   * The digits are exact for every value, and the shortest for almost all.
+   *
+   * @param[in] value A positive finite value
+   * @param[out] digits The decimal digits, at most 17 of them
+   * @param[out] K The decimal exponent of the last digit
+   *
+   * @returns The number of digits
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  __device__ int grisu2(T value, char* digits, int* K)
+  {
+    // The significand bits and the exponent bias of T
+    constexpr int significand_bits = (sizeof(T) == sizeof(float)) ? 23 : 52;
+    constexpr int exponent_bias = (sizeof(T) == sizeof(float)) ? 127 : 1023;
+    constexpr uint64_t hidden_bit = 1ull << significand_bits;
+
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(T));
+    const int biased_exponent = static_cast<int>(bits >> significand_bits);
+    diy_fp v{bits & (hidden_bit - 1), 1 - exponent_bias - significand_bits};
+    if (biased_exponent != 0) {
+      v.f += hidden_bit;
+      v.e = biased_exponent - exponent_bias - significand_bits;
+    }
+
+    // The boundaries halfway to the neighbouring values, the lower one is
+    // closer at a power of two
+    const diy_fp plus = normalize(diy_fp{(v.f << 1) + 1, v.e - 1});
+    diy_fp minus = (v.f == hidden_bit && biased_exponent > 1) ? diy_fp{(v.f << 2) - 1, v.e - 2}
+                                                               : diy_fp{(v.f << 1) - 1, v.e - 1};
+    minus.f <<= minus.e - plus.e;
+    minus.e = plus.e;
+
+    // Scale by the cached power of ten that brings the exponent to [-60, -32]
+    const double dk = (-61 - plus.e) * 0.30102999566398114 + 347;
+    int k = static_cast<int>(dk);
+    if (dk - k > 0.0) {
+      ++k;
+    }
+    const unsigned index = static_cast<unsigned>((k >> 3) + 1);
+    *K = -(-348 + static_cast<int>(index << 3));
+    const diy_fp c_mk{cached_power_significands[index], cached_power_exponents[index]};
+    const diy_fp W = multiply(normalize(v), c_mk);
+    diy_fp Wp = multiply(plus, c_mk);
+    diy_fp Wm = multiply(minus, c_mk);
+    ++Wm.f;
+    --Wp.f;
+
+    // Generate the digits of Wp until they are within delta of it
+    uint64_t delta = Wp.f - Wm.f;
+    const int shift = -Wp.e;
+    const uint64_t one = 1ull << shift;
+    const uint64_t wp_w = Wp.f - W.f;
+    uint32_t p1 = static_cast<uint32_t>(Wp.f >> shift);
+    uint64_t p2 = Wp.f & (one - 1);
+    int kappa = 1;
+    while (kappa < 10 && p1 >= power_of_ten(kappa)) {
+      ++kappa;
+    }
+
+    int length = 0;
+    while (kappa > 0) {
+      const uint64_t divisor = power_of_ten(kappa - 1);
+      const uint32_t d = p1 / divisor;
+      p1 %= divisor;
+      if (d != 0 || length != 0) {
+        digits[length++] = '0' + d;
+      }
+      --kappa;
+      const uint64_t rest = (static_cast<uint64_t>(p1) << shift) + p2;
+      if (rest <= delta) {
+        *K += kappa;
+        grisu_round(digits, length, delta, rest, power_of_ten(kappa) << shift, wp_w);
+        return length;
+      }
+    }
+    for (;;) {
+      p2 *= 10;
+      delta *= 10;
+      const char d = static_cast<char>(p2 >> shift);
+      if (d != 0 || length != 0) {
+        digits[length++] = '0' + d;
+      }
+      p2 &= one - 1;
+      --kappa;
+      if (p2 < delta) {
+        *K += kappa;
+        grisu_round(digits, length, delta, p2, one, (-kappa < 20) ? wp_w * power_of_ten(-kappa) : 0);
+        return length;
+      }
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes the shortest decimal text that reads back as value
+   *
+   * Like the repr of Python floats, values from 1e-4 up to 1e16 are written
+   * in positional notation with at least one fractional digit, the others in
+   * scientific notation. NaN is not passed in, format_row writes it as na_rep.
+   *
+   * @returns The number of characters written, at most 25
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  __device__ int format_float(T value, char* out)
+  {
+    int length = 0;
+    if (signbit(value)) {
+      out[length++] = '-';
+      value = -value;
+    }
+    if (isinf(value)) {
+      out[length++] = 'i'; out[length++] = 'n'; out[length++] = 'f';
+      return length;
+    }
+    if (value == 0) {
+      out[length++] = '0'; out[length++] = '.'; out[length++] = '0';
+      return length;
+    }
+
+    char digits[20];
+    int K = 0;
+    int num_digits = grisu2(value, digits, &K);
+    while (num_digits > 1 && digits[num_digits - 1] == '0') {
+      --num_digits;
+      ++K;
+    }
+    const int exponent = num_digits + K - 1;  // Of the first digit
+    if (exponent >= -4 && exponent < 16) {
+      if (exponent < 0) {
+        out[length++] = '0';
+        out[length++] = '.';
+        for (int i = -1; i > exponent; --i) {
+          out[length++] = '0';
+        }
+        for (int i = 0; i < num_digits; ++i) {
+          out[length++] = digits[i];
+        }
+      }
+      else {
+        for (int i = 0; i <= exponent; ++i) {
+          out[length++] = (i < num_digits) ? digits[i] : '0';
+        }
+        out[length++] = '.';
+        if (num_digits <= exponent + 1) {
+          out[length++] = '0';
+        }
+        for (int i = exponent + 1; i < num_digits; ++i) {
+          out[length++] = digits[i];
+        }
+      }
+    }
+    else {
+      out[length++] = digits[0];
+      if (num_digits > 1) {
+        out[length++] = '.';
+        for (int i = 1; i < num_digits; ++i) {
+          out[length++] = digits[i];
+        }
+      }
+      out[length++] = 'e';
+      out[length++] = (exponent < 0) ? '-' : '+';
+      length += format_digits((exponent < 0) ? -exponent : exponent, 2, out + length);
+    }
+    return length;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes the days since the UNIX epoch as YYYY-MM-DD
+   *
+   * The civil date is computed as in http://howardhinnant.github.io/date_algorithms.html
+   *
+   * @returns The number of characters written
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline int format_date(int64_t days, char* out)
+  {
+    days += 719468;
+    const int64_t era = ((days >= 0) ? days : days - 146096) / 146097;
+    const unsigned day_of_era = static_cast<unsigned>(days - era * 146097);
+    const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    const unsigned month_index = (5 * day_of_year + 2) / 153;
+    const unsigned day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    const unsigned month = (month_index < 10) ? month_index + 3 : month_index - 9;
+    const int64_t year = year_of_era + era * 400 + (month <= 2);
+
+    int length = 0;
+    if (year < 0) {
+      out[length++] = '-';
+    }
+    length += format_digits((year < 0) ? -year : year, 4, out + length);
+    out[length++] = '-';
+    length += format_digits(month, 2, out + length);
+    out[length++] = '-';
+    length += format_digits(day, 2, out + length);
+    return length;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes a time since the UNIX epoch as YYYY-MM-DDTHH:MM:SS, with
+   * the fraction of the second if it is not zero
+   *
+   * @param[in] ticks The time in units of 1 / 10^fraction_digits seconds
+   *
+   * @returns The number of characters written
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline int format_datetime(int64_t ticks, int fraction_digits, char* out)
+  {
+    const int64_t ticks_per_second = power_of_ten(fraction_digits);
+    const int64_t ticks_per_day = ticks_per_second * 86400;
+    int64_t days = ticks / ticks_per_day;
+    int64_t rest = ticks % ticks_per_day;
+    if (rest < 0) {
+      --days;
+      rest += ticks_per_day;
+    }
+    const int64_t seconds = rest / ticks_per_second;
+    const int64_t fraction = rest % ticks_per_second;
+
+    int length = format_date(days, out);
+    out[length++] = 'T';
+    length += format_digits(seconds / 3600, 2, out + length);
+    out[length++] = ':';
+    length += format_digits(seconds / 60 % 60, 2, out + length);
+    out[length++] = ':';
+    length += format_digits(seconds % 60, 2, out + length);
+    if (fraction != 0) {
+      out[length++] = '.';
+      length += format_digits(fraction, fraction_digits, out + length);
+    }
+    return length;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes a string, quoted if it contains the delimiter, the
+   * quotechar or a line break, or if all strings are quoted. The quotechars
+   * of a quoted string are doubled.
+   *
+   * @param[out] out Where to write the string, or nullptr to only compute
+   * its length
+   *
+   * @returns The number of characters of the string
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline long format_string(const char* str, size_t str_length,
+                                                format_options const& opts, char* out)
+  {
+    bool quoted = opts.quote_all;
+    long num_quotechars = 0;
+    for (size_t i = 0; i < str_length; ++i) {
+      const char c = str[i];
+      num_quotechars += (c == opts.quotechar);
+      quoted |= (c == opts.delimiter || c == opts.quotechar || c == '\n' || c == '\r');
+    }
+    if (!quoted) {
+      if (nullptr != out) {
+        memcpy(out, str, str_length);
+      }
+      return str_length;
+    }
+    if (nullptr != out) {
+      long length = 0;
+      out[length++] = opts.quotechar;
+      for (size_t i = 0; i < str_length; ++i) {
+        if (str[i] == opts.quotechar) {
+          out[length++] = opts.quotechar;
+        }
+        out[length++] = str[i];
+      }
+      out[length++] = opts.quotechar;
+    }
+    return str_length + num_quotechars + 2;
+  }
+
+  template <typename T>
+  __device__ inline T value_at(column_info const& col, gdf_size_type row)
+  {
+    return static_cast<const T*>(col.data)[row];
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Whether a field is written as na_rep: nulls, null strings and NaN
+   */
+  /* ----------------------------------------------------------------------------*/
+  __device__ inline bool is_na(column_info const& col, gdf_size_type row)
+  {
+    if (!gdf_is_valid(col.valid, row)) return true;
+    switch (col.dtype) {
+      case GDF_STRING:  return nullptr == col.strings[row].first;
+      case GDF_FLOAT32: return isnan(value_at<float>(col, row));
+      case GDF_FLOAT64: return isnan(value_at<double>(col, row));
+      default:          return false;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes a row, fields separated by the delimiter and followed by the
+   * line terminator
+   *
+   * @param[out] out Where to write the row, or nullptr to only compute its
+   * length
+   *
+   * @returns The number of characters of the row
+   */
+  /* ----------------------------------------------------------------------------*/
+  __device__ long format_row(const column_info* cols, int num_cols, gdf_size_type row,
+                             format_options const& opts, char* out)
+  {
+    long length = 0;
+    for (int c = 0; c < num_cols; ++c) {
+      column_info const& col = cols[c];
+      if (c > 0) {
+        if (nullptr != out) {
+          out[length] = opts.delimiter;
+        }
+        ++length;
+      }
+
+      if (is_na(col, row)) {
+        if (nullptr != out) {
+          memcpy(out + length, opts.na_rep, opts.na_rep_length);
+        }
+        length += opts.na_rep_length;
+        continue;
+      }
+      if (GDF_STRING == col.dtype) {
+        length += format_string(col.strings[row].first, col.strings[row].second, opts,
+                                (nullptr != out) ? out + length : nullptr);
+        continue;
+      }
+
+      char text[max_value_chars];
+      int text_length = 0;
+      switch (col.dtype) {
+        case GDF_INT8:      text_length = format_integer(value_at<int8_t>(col, row), text); break;
+        case GDF_INT16:     text_length = format_integer(value_at<int16_t>(col, row), text); break;
+        case GDF_INT32:     text_length = format_integer(value_at<int32_t>(col, row), text); break;
+        case GDF_INT64:     text_length = format_integer(value_at<int64_t>(col, row), text); break;
+        case GDF_CATEGORY:  text_length = format_integer(value_at<int32_t>(col, row), text); break;
+        case GDF_FLOAT32:   text_length = format_float(value_at<float>(col, row), text); break;
+        case GDF_FLOAT64:   text_length = format_float(value_at<double>(col, row), text); break;
+        case GDF_DATE32:    text_length = format_date(value_at<int32_t>(col, row), text); break;
+        case GDF_DATE64:    text_length = format_datetime(value_at<int64_t>(col, row), 3, text); break;
+        case GDF_TIMESTAMP: {
+          const int fraction_digits = (TIME_UNIT_s == col.time_unit) ? 0 :
+                                      (TIME_UNIT_us == col.time_unit) ? 6 :
+                                      (TIME_UNIT_ns == col.time_unit) ? 9 : 3;
+          text_length = format_datetime(value_at<int64_t>(col, row), fraction_digits, text);
+          break;
+        }
+        default: break;
+      }
+      if (nullptr != out) {
+        memcpy(out + length, text, text_length);
+      }
+      length += text_length;
+    }
+
+    if (nullptr != out) {
+      memcpy(out + length, opts.terminator, opts.terminator_length);
+    }
+    return length + opts.terminator_length;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief CUDA kernel that computes the length of the text of every row
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__ void computeRowLengths(const column_info* cols, int num_cols, gdf_size_type num_rows,
+                                    const format_options opts, size_t* lengths)
+  {
+    const gdf_size_type row = threadIdx.x + (blockDim.x * blockIdx.x);
+    if (row < num_rows) {
+      lengths[row] = format_row(cols, num_cols, row, opts, nullptr);
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief CUDA kernel that writes the text of the rows of a chunk
+   *
+   * @param[in] row_ends The offset past the end of every row of the output
+   * @param[out] out The text of the chunk, which starts at chunk_start
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__ void formatRows(const column_info* cols, int num_cols, gdf_size_type first_row,
+                             gdf_size_type last_row, const format_options opts,
+                             const size_t* row_ends, size_t chunk_start, char* out)
+  {
+    const gdf_size_type row = first_row + threadIdx.x + (blockDim.x * blockIdx.x);
+    if (row < last_row) {
+      const size_t row_start = (row > 0) ? row_ends[row - 1] : 0;
+      format_row(cols, num_cols, row, opts, out + (row_start - chunk_start));
+    }
+  }
+
+  // Owns a file descriptor
+  struct output_file
+  {
+    int fd{-1};
+    ~output_file()
+    {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+  };
+
+  // Owns a buffer of pinned host memory
+  struct pinned_buffer
+  {
+    char* data{nullptr};
+    ~pinned_buffer()
+    {
+      if (nullptr != data) {
+        cudaFreeHost(data);
+      }
+    }
+  };
+
+  // Owns a CUDA event
+  struct cuda_event
+  {
+    cudaEvent_t event{nullptr};
+    ~cuda_event()
+    {
+      if (nullptr != event) {
+        cudaEventDestroy(event);
+      }
+    }
+  };
+
+  gdf_error write_all(int fd, const char* data, size_t size)
+  {
+    while (size > 0) {
+      const ssize_t written = write(fd, data, size);
+      if (written < 0 && EINTR == errno) {
+        continue;
+      }
+      GDF_REQUIRE(written > 0, GDF_FILE_ERROR);
+      data += written;
+      size -= written;
+    }
+    return GDF_SUCCESS;
+  }
+
+  // Returns the header field of a column, its name or its index
+  std::string header_field(gdf_column const* column, int index, format_options const& opts)
+  {
+    const std::string name = (nullptr != column->col_name) ? column->col_name : std::to_string(index);
+    std::string field(name.size() * 2 + 2, '\0');
+    field.resize(format_string(name.data(), name.size(), opts, &field[0]));
+    return field;
+  }
+
+} // unnamed namespace
+
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Writes columns as CSV to a file
+ *
+ * Numbers are written as the shortest text that reads back as the same
+ * value, dates as YYYY-MM-DD, and GDF_DATE64 and GDF_TIMESTAMP values as
+ * YYYY-MM-DDTHH:MM:SS with the fraction of the second if it is not zero.
+ * GDF_CATEGORY columns are written as their int32 values. The output can be
+ * read back with read_csv.
+ *
+ * @param[in] columns The columns to write, all of the same size
+ * @param[in] num_cols The number of columns
+ * @param[in,out] args The file and the options, returns the size of the file
+ *
+ * @returns GDF_SUCCESS upon successful completion, GDF_FILE_ERROR if writing
+ * to the file fails
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error write_csv(gdf_column **columns, int num_cols, csv_write_arg *args)
+{
+  GDF_REQUIRE(nullptr != args, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(nullptr != args->filepath, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(num_cols > 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(nullptr != columns, GDF_DATASET_EMPTY);
+
+  cudaStream_t stream{0};
+  const gdf_size_type num_rows = columns[0]->size;
+
+  // Strings are formatted from their device pointers and lengths
+  std::vector<column_info> h_cols(num_cols);
+  std::vector<rmm::device_vector<string_pair>> string_pairs(num_cols);
+  for (int c = 0; c < num_cols; ++c) {
+    const gdf_column* column = columns[c];
+    GDF_REQUIRE(nullptr != column, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(num_rows == column->size, GDF_COLUMN_SIZE_MISMATCH);
+    GDF_REQUIRE(0 == num_rows || nullptr != column->data, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(GDF_invalid < column->dtype && column->dtype < N_GDF_TYPES, GDF_UNSUPPORTED_DTYPE);
+
+    h_cols[c] = column_info{column->dtype, column->dtype_info.time_unit, column->data,
+                            (column->null_count > 0) ? column->valid : nullptr, nullptr};
+    if (GDF_STRING == column->dtype && num_rows > 0) {
+      string_pairs[c].resize(num_rows);
+      NVStrings* strings = static_cast<NVStrings*>(column->data);
+      GDF_REQUIRE(static_cast<gdf_size_type>(strings->size()) == num_rows, GDF_COLUMN_SIZE_MISMATCH);
+      strings->create_index(string_pairs[c].data().get(), true);
+      h_cols[c].strings = string_pairs[c].data().get();
+    }
+  }
+
+  std::string compression_type;
+  gdf_error error = inferCompressionType(args->compression, args->filepath, compression_type);
+  GDF_REQUIRE(GDF_SUCCESS == error, error);
+  GDF_REQUIRE(compression_type == "none" || compression_type == "gzip", GDF_INVALID_API_CALL);
+
+  const std::string terminator = (nullptr != args->line_terminator) ? args->line_terminator : "\n";
+  const std::string na_rep = (nullptr != args->na_rep) ? args->na_rep : "";
+  format_options opts{};
+  opts.delimiter = (args->delimiter != '\0') ? args->delimiter : ',';
+  opts.quotechar = (args->quotechar != '\0') ? args->quotechar : '"';
+  opts.quote_all = args->quote_all;
+  GDF_REQUIRE(opts.delimiter != opts.quotechar, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(!terminator.empty(), GDF_INVALID_API_CALL);
+
+  std::string header;
+  if (args->header) {
+    for (int c = 0; c < num_cols; ++c) {
+      if (c > 0) {
+        header += opts.delimiter;
+      }
+      header += header_field(columns[c], c, opts);
+    }
+    header += terminator;
+  }
+
+  rmm::device_vector<char> d_terminator(terminator.begin(), terminator.end());
+  rmm::device_vector<char> d_na_rep(na_rep.begin(), na_rep.end());
+  opts.terminator = d_terminator.data().get();
+  opts.terminator_length = terminator.size();
+  opts.na_rep = d_na_rep.data().get();
+  opts.na_rep_length = na_rep.size();
+  rmm::device_vector<column_info> d_cols(h_cols);
+
+  // The end offset of every row, and the rows each chunk ends with
+  rmm::device_vector<size_t> row_ends(num_rows);
+  std::vector<gdf_size_type> chunk_rows(1, 0);
+  std::vector<size_t> chunk_ends(1, 0);
+  int blockSize;    // suggested thread count to use
+  int minGridSize;  // minimum block count required
+  if (num_rows > 0) {
+    CUDA_TRY( cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, computeRowLengths) );
+    computeRowLengths <<< (num_rows + blockSize - 1) / blockSize, blockSize, 0, stream >>> (
+        d_cols.data().get(), num_cols, num_rows, opts, row_ends.data().get());
+    CUDA_TRY( cudaGetLastError() );
+    thrust::inclusive_scan(rmm::exec_policy(stream)->on(stream), row_ends.begin(), row_ends.end(),
+                           row_ends.begin());
+
+    size_t total_bytes = row_ends.back();
+    std::vector<size_t> targets;
+    for (size_t target = chunk_bytes; target < total_bytes; target += chunk_bytes) {
+      targets.push_back(target);
+    }
+    rmm::device_vector<size_t> d_targets(targets);
+    rmm::device_vector<gdf_size_type> d_bounds(targets.size());
+    thrust::upper_bound(rmm::exec_policy(stream)->on(stream), row_ends.begin(), row_ends.end(),
+                        d_targets.begin(), d_targets.end(), d_bounds.begin());
+    std::vector<gdf_size_type> bounds(targets.size());
+    thrust::copy(d_bounds.begin(), d_bounds.end(), bounds.begin());
+    for (gdf_size_type bound : bounds) {
+      if (bound > chunk_rows.back() && bound < num_rows) {
+        chunk_rows.push_back(bound);
+        chunk_ends.push_back(row_ends[bound - 1]);
+      }
+    }
+    chunk_rows.push_back(num_rows);
+    chunk_ends.push_back(total_bytes);
+  }
+
+  size_t max_chunk_size = 0;
+  for (size_t k = 1; k < chunk_ends.size(); ++k) {
+    max_chunk_size = std::max(max_chunk_size, chunk_ends[k] - chunk_ends[k - 1]);
+  }
+  const int num_chunks = chunk_rows.size() - 1;
+
+  // Two buffers, so that a chunk is formatted while the previous one is written
+  rmm::device_vector<char> d_text[2];
+  pinned_buffer h_text[2];
+  cuda_event copied[2];
+  for (int b = 0; b < std::min(num_chunks, 2); ++b) {
+    d_text[b].resize(max_chunk_size);
+    CUDA_TRY( cudaMallocHost(&h_text[b].data, max_chunk_size) );
+  }
+  for (auto& copy : copied) {
+    CUDA_TRY( cudaEventCreateWithFlags(&copy.event, cudaEventDisableTiming) );
+  }
+  CUDA_TRY( cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, formatRows) );
+  auto format_chunk = [&](int k) -> gdf_error {
+    const int b = k % 2;
+    const gdf_size_type first_row = chunk_rows[k];
+    const gdf_size_type chunk_num_rows = chunk_rows[k + 1] - first_row;
+    formatRows <<< (chunk_num_rows + blockSize - 1) / blockSize, blockSize, 0, stream >>> (
+        d_cols.data().get(), num_cols, first_row, chunk_rows[k + 1], opts, row_ends.data().get(),
+        chunk_ends[k], d_text[b].data().get());
+    CUDA_TRY( cudaMemcpyAsync(h_text[b].data, d_text[b].data().get(), chunk_ends[k + 1] - chunk_ends[k],
+                              cudaMemcpyDeviceToHost, stream) );
+    CUDA_TRY( cudaEventRecord(copied[b].event, stream) );
+    return GDF_SUCCESS;
+  };
+
+  output_file file;
+  file.fd = open(args->filepath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  GDF_REQUIRE(file.fd >= 0, GDF_FILE_ERROR);
+
+  io_comp_stream_s* comp_stream{nullptr};
+  if (compression_type == "gzip") {
+    error = io_compress_begin(&comp_stream, IO_UNCOMP_STREAM_TYPE_GZIP);
+    GDF_REQUIRE(GDF_SUCCESS == error, error);
+  }
+  std::vector<char> compressed;
+  args->bytes_written = 0;
+  auto write_text = [&](const char* text, size_t size, bool last) {
+    if (nullptr == comp_stream) {
+      args->bytes_written += size;
+      return write_all(file.fd, text, size);
+    }
+    compressed.clear();
+    const gdf_error status = io_compress_append(comp_stream, text, size, last, compressed);
+    if (GDF_SUCCESS != status) {
+      return status;
+    }
+    args->bytes_written += compressed.size();
+    return write_all(file.fd, compressed.data(), compressed.size());
+  };
+
+  if (num_chunks > 0) {
+    error = format_chunk(0);
+  }
+  if (GDF_SUCCESS == error) {
+    error = write_text(header.data(), header.size(), 0 == num_chunks);
+  }
+  for (int k = 0; k < num_chunks && GDF_SUCCESS == error; ++k) {
+    if (cudaSuccess != cudaEventSynchronize(copied[k % 2].event)) {
+      error = GDF_CUDA_ERROR;
+      break;
+    }
+    if (k + 1 < num_chunks) {
+      error = format_chunk(k + 1);
+      if (GDF_SUCCESS != error) {
+        break;
+      }
+    }
+    error = write_text(h_text[k % 2].data, chunk_ends[k + 1] - chunk_ends[k], k + 1 == num_chunks);
+  }
+
+  io_compress_end(comp_stream);
+  CUDA_TRY( cudaStreamSynchronize(stream) );
+  CUDA_TRY( cudaGetLastError() );
+  return error;
+}
@@ -64,12 +64,12 @@
 
 #include "cudf.h"
 
-__host__ __device__ bool extractDate(const char *data, long sIdx, long eIdx,
-                                     bool dayfirst, int *year, int *month,
-                                     int *day);
-__host__ __device__ void extractTime(const char *data, long start, long end,
-                                     int *hour, int *minute, int *second,
-                                     int *millisecond);
+__host__ __device__ inline bool extractDate(const char *data, long sIdx, long eIdx,
+                                            bool dayfirst, int *year, int *month,
+                                            int *day);
+__host__ __device__ inline void extractTime(const char *data, long start, long end,
+                                            int *hour, int *minute, int *second,
+                                            int *millisecond);
 
 __host__ __device__ constexpr int32_t daysSinceEpoch(int year, int month, int day);
 __host__ __device__ constexpr int64_t secondsSinceEpoch(int year, int month, int day, int hour, int minute, int second);
@@ -117,7 +117,7 @@ __host__ __device__ T convertStrToInteger(const char *data, long start,
  * @return index into the string, or -1 if the character is not found
  */
 __host__ __device__
-long findFirstOccurrence(const char *data, long start_idx, long end_idx, char c) {
+inline long findFirstOccurrence(const char *data, long start_idx, long end_idx, char c) {
 
 	for (long i = start_idx; i <= end_idx; ++i) {
 		if (data[i] == c) {
@@ -142,7 +142,7 @@ long findFirstOccurrence(const char *data, long start_idx, long end_idx, char c)
  * @return returns the number of days since epoch
  */
 __host__ __device__
-gdf_date32 parseDateFormat(const char *data, long start_idx, long end_idx, bool dayfirst) {
+inline gdf_date32 parseDateFormat(const char *data, long start_idx, long end_idx, bool dayfirst) {
 
 	int day, month, year;
 	gdf_date32 e = -1;
@@ -169,8 +169,8 @@ gdf_date32 parseDateFormat(const char *data, long start_idx, long end_idx, bool
  * 
  * @return Milliseconds since epoch
  */
-__host__ __device__ gdf_date64 parseDateTimeFormat(const char *data, long start,
-                                                   long end, bool dayfirst) {
+__host__ __device__ inline gdf_date64 parseDateTimeFormat(const char *data, long start,
+                                                          long end, bool dayfirst) {
   int day, month, year;
   int hour, minute, second, millisecond = 0;
   gdf_date64 answer = -1;
@@ -225,7 +225,7 @@ __host__ __device__ gdf_date64 parseDateTimeFormat(const char *data, long start,
  * @return T/F - false indicates that an error occurred
  */
 __host__ __device__
-bool extractDate(const char *data, long sIdx, long eIdx, bool dayfirst, int *year, int *month, int *day) {
+inline bool extractDate(const char *data, long sIdx, long eIdx, bool dayfirst, int *year, int *month, int *day) {
 
 	char sep = '/';
 
@@ -312,9 +312,9 @@ bool extractDate(const char *data, long sIdx, long eIdx, bool dayfirst, int *yea
  * @param[out] second The second value (0 if not present)
  * @param[out] millisecond The millisecond (0 if not present)
  */
-__host__ __device__ void extractTime(const char *data, long start, long end,
-                                     int *hour, int *minute, int *second,
-                                     int *millisecond) {
+__host__ __device__ inline void extractTime(const char *data, long start, long end,
+                                            int *hour, int *minute, int *second,
+                                            int *millisecond) {
   constexpr char sep = ':';
 
   // Adjust for AM/PM and any whitespace before
@@ -20,6 +20,7 @@
 #include "datetime_parser.cuh"
 #include "utilities/wrapper_types.hpp"
 #include <cuda_runtime_api.h>
+#include <type_traits>
 
 #include "utilities/trie.cuh"
 
@@ -45,8 +46,8 @@ __inline__ __device__ bool isWhitespace(char ch) {
  * 
  * @return Adjusted or unchanged start_idx and end_idx
  *---------------------------------------------------------------------------**/
-__device__ void adjustForWhitespaceAndQuotes(const char* data, long* start,
-                                             long* end, char quotechar = '\0') {
+__inline__ __device__ void adjustForWhitespaceAndQuotes(const char* data, long* start,
+                                                        long* end, char quotechar = '\0') {
   while ((*start <= *end) &&
          (isWhitespace(data[*start]) || data[*start] == quotechar)) {
     (*start)++;
@@ -102,8 +103,8 @@ __host__ __device__ bool isBooleanValue(T value, int32_t* bool_values,
  * 
  * @return The hash value
  *---------------------------------------------------------------------------**/
-__host__ __device__ int32_t convertStrToHash(const char* key, long start,
-                                             long end, uint32_t seed) {
+__host__ __device__ inline int32_t convertStrToHash(const char* key, long start,
+                                                    long end, uint32_t seed) {
 
   auto getblock32 = [] __host__ __device__ (const uint32_t* p,
                                             int i) -> uint32_t {
@@ -261,28 +262,75 @@ __host__ __device__ T convertStrToValue(const char* data, long start, long end,
 }
 
 template <>
-__host__ __device__ cudf::date32 convertStrToValue<cudf::date32>(
+__host__ __device__ inline cudf::date32 convertStrToValue<cudf::date32>(
     const char* data, long start, long end, const ParseOptions& opts) {
   return cudf::date32{parseDateFormat(data, start, end, opts.dayfirst)};
 }
 
 template <>
-__host__ __device__ cudf::date64 convertStrToValue<cudf::date64>(
+__host__ __device__ inline cudf::date64 convertStrToValue<cudf::date64>(
     const char* data, long start, long end, const ParseOptions& opts) {
   return cudf::date64{parseDateTimeFormat(data, start, end, opts.dayfirst)};
 }
 
 template <>
-__host__ __device__ cudf::category convertStrToValue<cudf::category>(
+__host__ __device__ inline cudf::category convertStrToValue<cudf::category>(
     const char* data, long start, long end, const ParseOptions& opts) {
   constexpr int32_t HASH_SEED = 33;
   return cudf::category{convertStrToHash(data, start, end + 1, HASH_SEED)};
 }
 
 template <>
-__host__ __device__ cudf::timestamp convertStrToValue<cudf::timestamp>(
+__host__ __device__ inline cudf::timestamp convertStrToValue<cudf::timestamp>(
     const char* data, long start, long end, const ParseOptions& opts) {
   return cudf::timestamp{convertStrToValue<int64_t>(data, start, end, opts)};
 }
 
+/**---------------------------------------------------------------------------*
+ * @brief Functor for converting text data to cuDF data type value.
+ *
+ * Dispatched on the output column type with cudf::type_dispatcher.
+ *---------------------------------------------------------------------------**/
+struct ConvertFunctor {
+  /**---------------------------------------------------------------------------*
+   * @brief Template specialization for operator() that handles integer types
+   * that additionally checks whether the parsed data value should be overridden
+   * with user-specified true/false matches.
+   *
+   * It is handled here rather than within convertStrToValue() as that function
+   * is already used to construct the true/false match list from user-provided
+   * strings at the start of parsing.
+   *---------------------------------------------------------------------------**/
+  template <typename T,
+            typename std::enable_if_t<std::is_integral<T>::value> * = nullptr>
+  __host__ __device__ __forceinline__ void operator()(
+      const char *csvData, void *gdfColumnData, long rowIndex, long start,
+      long end, const ParseOptions &opts) {
+    T &value{static_cast<T *>(gdfColumnData)[rowIndex]};
+    value = convertStrToValue<T>(csvData, start, end, opts);
+
+    // Check for user-specified true/false values where the output is
+    // replaced with 1/0 respectively
+    const size_t field_len = end - start + 1;
+    if (serializedTrieContains(opts.trueValuesTrie, csvData + start, field_len)) {
+      value = 1;
+    } else if (serializedTrieContains(opts.falseValuesTrie, csvData + start, field_len)) {
+      value = 0;
+    }
+  }
+
+  /**---------------------------------------------------------------------------*
+   * @brief Default template operator() dispatch specialization all data types
+   * (including wrapper types) that is not covered by integral specialization.
+   *---------------------------------------------------------------------------**/
+  template <typename T,
+            typename std::enable_if_t<!std::is_integral<T>::value> * = nullptr>
+  __host__ __device__ __forceinline__ void operator()(
+      const char *csvData, void *gdfColumnData, long rowIndex, long start,
+      long end, const ParseOptions &opts) {
+    T &value{static_cast<T *>(gdfColumnData)[rowIndex]};
+    value = convertStrToValue<T>(csvData, start, end, opts);
+  }
+};
+
 #endif
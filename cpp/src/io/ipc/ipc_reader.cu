@@ -0,0 +1,766 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Reads an Arrow IPC stream or file in device memory into gdf_columns
+ *
+ * Only the message metadata is copied to the host and parsed there, the
+ * buffers of the record batches stay on the device. The columns of a stream
+ * with a single record batch can be views into the input buffer.
+ *
+ * @file ipc_reader.cu
+ * ---------------------------------------------------------------------------**/
+
+#include <thrust/copy.h>
+#include <thrust/for_each.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#pragma diag_suppress set_but_not_used
+#include <cudf/ipc_generated/Schema_generated.h>
+#pragma diag_default set_but_not_used
+#include <cudf/ipc_generated/Message_generated.h>
+
+#include <NVStrings.h>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/allocator.hpp"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "bitmask/bitmask_ops.h"
+
+using namespace org::apache::arrow;
+
+namespace { // unnamed namespace
+
+  using string_pair = std::pair<const char*, size_t>;
+
+  constexpr char file_magic[] = "ARROW1";
+  constexpr size_t file_magic_size{6};
+  constexpr size_t file_header_size{8};   // The magic padded to 8 bytes
+  constexpr int32_t continuation_marker{-1};
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief How the values of an Arrow field are stored and which column they
+   * are read into
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct field_desc
+  {
+    std::string name;
+    gdf_dtype dtype;
+    gdf_dtype_extra_info dtype_info;
+    int width;              // Bytes per value, 0 for bits
+    int num_buffers;        // Buffers per record batch, with the validity
+    int64_t dictionary_id;  // -1 unless dictionary encoded
+    int index_width;        // Bytes per dictionary index
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The buffers of one field in one record batch, in device memory
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct column_chunk
+  {
+    gdf_size_type size;
+    gdf_size_type null_count;
+    gdf_valid_type const* valid;  // nullptr if there are no nulls
+    uint8_t const* data;
+    int32_t const* offsets;       // String offsets, nullptr for fixed width
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Walks the messages of an IPC stream in device memory, copying
+   * their metadata to the host
+   */
+  /* ----------------------------------------------------------------------------*/
+  class message_reader
+  {
+  public:
+    message_reader(uint8_t const* begin, uint8_t const* end)
+      : _position(begin), _end(end), _body(nullptr)
+    { }
+
+    /* --------------------------------------------------------------------------*/
+    /**
+     * @brief Reads the metadata of the next message
+     *
+     * @param[out] message The next message, nullptr at the end of the stream
+     *
+     * @returns GDF_SUCCESS, or GDF_FILE_ERROR if the stream is malformed
+     */
+    /* ----------------------------------------------------------------------------*/
+    gdf_error next(flatbuf::Message const** message)
+    {
+      *message = nullptr;
+
+      int32_t length{0};
+      gdf_error status = read_length(&length);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      if (continuation_marker == length) {
+        status = read_length(&length);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+      }
+      if (0 == length) {
+        return GDF_SUCCESS;
+      }
+      GDF_REQUIRE(length > 0 && length <= _end - _position, GDF_FILE_ERROR);
+
+      _metadata.resize(length);
+      CUDA_TRY( cudaMemcpy(_metadata.data(), _position, length, cudaMemcpyDeviceToHost) );
+      _position += length;
+
+      flatbuffers::Verifier verifier(_metadata.data(), _metadata.size());
+      GDF_REQUIRE(flatbuf::VerifyMessageBuffer(verifier), GDF_FILE_ERROR);
+
+      auto const msg = flatbuf::GetMessage(_metadata.data());
+      GDF_REQUIRE(msg->version() >= flatbuf::MetadataVersion_V4, GDF_NOTIMPLEMENTED_ERROR);
+      GDF_REQUIRE(msg->bodyLength() >= 0 && msg->bodyLength() <= _end - _position, GDF_FILE_ERROR);
+
+      _body = _position;
+      _position += msg->bodyLength();
+      *message = msg;
+      return GDF_SUCCESS;
+    }
+
+    /// The body of the last message read
+    uint8_t const* body() const { return _body; }
+
+  private:
+    gdf_error read_length(int32_t* length)
+    {
+      *length = 0;
+      if (_end - _position < static_cast<ptrdiff_t>(sizeof(int32_t))) {
+        return GDF_SUCCESS;
+      }
+      CUDA_TRY( cudaMemcpy(length, _position, sizeof(int32_t), cudaMemcpyDeviceToHost) );
+      _position += sizeof(int32_t);
+      return GDF_SUCCESS;
+    }
+
+    uint8_t const* _position;
+    uint8_t const* _end;
+    uint8_t const* _body;
+    std::vector<uint8_t> _metadata;
+  };
+
+  gdf_time_unit to_time_unit(flatbuf::TimeUnit unit)
+  {
+    switch (unit) {
+      case flatbuf::TimeUnit_SECOND:      return TIME_UNIT_s;
+      case flatbuf::TimeUnit_MILLISECOND: return TIME_UNIT_ms;
+      case flatbuf::TimeUnit_MICROSECOND: return TIME_UNIT_us;
+      case flatbuf::TimeUnit_NANOSECOND:  return TIME_UNIT_ns;
+      default:                            return TIME_UNIT_NONE;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Maps an Arrow field to the column it is read into
+   *
+   * Unsigned integers are read into the signed type of the same width and
+   * booleans into GDF_INT8. Dictionary encoded fields keep the type of their
+   * values here, see field_desc::dictionary_id.
+   *
+   * @returns GDF_SUCCESS, or GDF_UNSUPPORTED_DTYPE for nested and other types
+   * without a gdf_dtype
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error describe_field(flatbuf::Field const* field, field_desc* desc)
+  {
+    GDF_REQUIRE(nullptr == field->children() || 0 == field->children()->size(),
+                GDF_UNSUPPORTED_DTYPE);
+
+    desc->name = (nullptr != field->name()) ? field->name()->str() : std::string();
+    desc->dtype_info.time_unit = TIME_UNIT_NONE;
+    desc->num_buffers = 2;
+    desc->dictionary_id = -1;
+    desc->index_width = 0;
+
+    switch (field->type_type()) {
+      case flatbuf::Type_Bool:
+        desc->dtype = GDF_INT8;
+        desc->width = 0;
+        break;
+      case flatbuf::Type_Int: {
+        int const bits = field->type_as_Int()->bitWidth();
+        switch (bits) {
+          case 8:  desc->dtype = GDF_INT8;  break;
+          case 16: desc->dtype = GDF_INT16; break;
+          case 32: desc->dtype = GDF_INT32; break;
+          case 64: desc->dtype = GDF_INT64; break;
+          default: return GDF_UNSUPPORTED_DTYPE;
+        }
+        desc->width = bits / 8;
+        break;
+      }
+      case flatbuf::Type_FloatingPoint:
+        switch (field->type_as_FloatingPoint()->precision()) {
+          case flatbuf::Precision_SINGLE: desc->dtype = GDF_FLOAT32; desc->width = 4; break;
+          case flatbuf::Precision_DOUBLE: desc->dtype = GDF_FLOAT64; desc->width = 8; break;
+          default: return GDF_UNSUPPORTED_DTYPE;
+        }
+        break;
+      case flatbuf::Type_Date:
+        if (flatbuf::DateUnit_DAY == field->type_as_Date()->unit()) {
+          desc->dtype = GDF_DATE32;
+          desc->width = 4;
+        } else {
+          desc->dtype = GDF_DATE64;
+          desc->width = 8;
+        }
+        break;
+      case flatbuf::Type_Timestamp:
+        desc->dtype = GDF_TIMESTAMP;
+        desc->dtype_info.time_unit = to_time_unit(field->type_as_Timestamp()->unit());
+        desc->width = 8;
+        break;
+      case flatbuf::Type_Utf8:
+        desc->dtype = GDF_STRING;
+        desc->width = 1;
+        desc->num_buffers = 3;
+        break;
+      default:
+        return GDF_UNSUPPORTED_DTYPE;
+    }
+
+    auto const encoding = field->dictionary();
+    if (nullptr != encoding) {
+      desc->dictionary_id = encoding->id();
+      // The index type defaults to int32
+      desc->index_width = (nullptr != encoding->indexType()) ? encoding->indexType()->bitWidth() / 8 : 4;
+      GDF_REQUIRE(1 == desc->index_width || 2 == desc->index_width ||
+                  4 == desc->index_width || 8 == desc->index_width, GDF_UNSUPPORTED_DTYPE);
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Locates the buffers of each field in the body of a record batch
+   *
+   * The fields of a record batch of dictionary encoded columns hold the
+   * indices, the fields of a dictionary batch hold the values.
+   *
+   * @param[in] batch The record batch metadata
+   * @param[in] body The record batch body in device memory
+   * @param[in] body_length The size of the body in bytes
+   * @param[in] fields The fields of the batch
+   * @param[in] dictionary_values Whether the batch holds dictionary values
+   * @param[out] chunks One chunk per field
+   *
+   * @returns GDF_SUCCESS, or GDF_FILE_ERROR if the metadata does not fit the
+   * body
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error describe_batch(flatbuf::RecordBatch const* batch,
+                           uint8_t const* body, int64_t body_length,
+                           std::vector<field_desc> const& fields,
+                           bool dictionary_values,
+                           std::vector<column_chunk>* chunks)
+  {
+    GDF_REQUIRE(nullptr != batch && nullptr != batch->nodes() && nullptr != batch->buffers(),
+                GDF_FILE_ERROR);
+    GDF_REQUIRE(batch->nodes()->size() == fields.size(), GDF_FILE_ERROR);
+    GDF_REQUIRE(batch->length() >= 0 &&
+                batch->length() <= std::numeric_limits<gdf_size_type>::max(), GDF_COLUMN_SIZE_TOO_BIG);
+
+    chunks->clear();
+    flatbuffers::uoffset_t next_buffer{0};
+
+    for (size_t i = 0; i < fields.size(); ++i) {
+      field_desc const& field = fields[i];
+      auto const node = batch->nodes()->Get(i);
+      GDF_REQUIRE(node->length() == batch->length(), GDF_FILE_ERROR);
+
+      bool const is_index = !dictionary_values && (field.dictionary_id >= 0);
+      int const num_buffers = is_index ? 2 : field.num_buffers;
+      GDF_REQUIRE(next_buffer + num_buffers <= batch->buffers()->size(), GDF_FILE_ERROR);
+
+      uint8_t const* buffers[3] = {nullptr, nullptr, nullptr};
+      int64_t lengths[3] = {0, 0, 0};
+      for (int b = 0; b < num_buffers; ++b) {
+        auto const buffer = batch->buffers()->Get(next_buffer++);
+        GDF_REQUIRE(buffer->offset() >= 0 && buffer->length() >= 0 &&
+                    buffer->offset() + buffer->length() <= body_length, GDF_FILE_ERROR);
+        buffers[b] = (buffer->length() > 0) ? body + buffer->offset() : nullptr;
+        lengths[b] = buffer->length();
+      }
+
+      column_chunk chunk;
+      chunk.size = static_cast<gdf_size_type>(node->length());
+      chunk.null_count = static_cast<gdf_size_type>(node->null_count());
+      chunk.valid = (chunk.null_count > 0) ? reinterpret_cast<gdf_valid_type const*>(buffers[0]) : nullptr;
+      chunk.data = buffers[1];
+      chunk.offsets = nullptr;
+
+      GDF_REQUIRE(chunk.null_count >= 0 && chunk.null_count <= chunk.size, GDF_FILE_ERROR);
+      GDF_REQUIRE(0 == chunk.null_count || lengths[0] >= gdf_get_num_chars_bitmask(chunk.size),
+                  GDF_FILE_ERROR);
+
+      int64_t data_length{0};
+      if (is_index) {
+        data_length = int64_t{field.index_width} * chunk.size;
+      } else if (GDF_STRING == field.dtype) {
+        GDF_REQUIRE(lengths[1] >= int64_t{sizeof(int32_t)} * (chunk.size + 1) || 0 == chunk.size,
+                    GDF_FILE_ERROR);
+        chunk.offsets = reinterpret_cast<int32_t const*>(buffers[1]);
+        // Without characters every string is empty, but must not become null
+        chunk.data = (nullptr != buffers[2]) ? buffers[2] : buffers[1];
+      } else if (0 == field.width) {
+        data_length = (int64_t{chunk.size} + 7) / 8;
+      } else {
+        data_length = int64_t{field.width} * chunk.size;
+      }
+      GDF_REQUIRE(lengths[1] >= data_length, GDF_FILE_ERROR);
+
+      chunks->push_back(chunk);
+    }
+    return GDF_SUCCESS;
+  }
+
+  struct unpack_bits
+  {
+    uint8_t const* bits;
+
+    __device__
+    int8_t operator()(gdf_size_type i) const
+    {
+      return static_cast<int8_t>((bits[i / 8] >> (i % 8)) & 1);
+    }
+  };
+
+  struct make_string_pair
+  {
+    int32_t const* offsets;
+    char const* chars;
+    gdf_valid_type const* valid;
+    string_pair* pairs;
+
+    __device__
+    void operator()(gdf_size_type i) const
+    {
+      if (gdf_is_valid(valid, i)) {
+        pairs[i].first = chars + offsets[i];
+        pairs[i].second = static_cast<size_t>(offsets[i + 1] - offsets[i]);
+      } else {
+        pairs[i].first = nullptr;
+        pairs[i].second = 0;
+      }
+    }
+  };
+
+  template <typename T>
+  void widen_indices(column_chunk const& chunk, int32_t* output, cudaStream_t stream)
+  {
+    T const* indices = reinterpret_cast<T const*>(chunk.data);
+    thrust::copy(rmm::exec_policy(stream)->on(stream), indices, indices + chunk.size, output);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Whether a single chunk can be used as the column as it is
+   */
+  /* ----------------------------------------------------------------------------*/
+  bool is_viewable(field_desc const& field, column_chunk const& chunk, bool is_index)
+  {
+    int const width = is_index ? field.index_width : field.width;
+    if (GDF_STRING == field.dtype && !is_index) return false;
+    if (0 == width || (is_index && int{sizeof(int32_t)} != width)) return false;
+
+    return (0 == reinterpret_cast<uintptr_t>(chunk.data) % static_cast<uintptr_t>(width)) &&
+           (0 == reinterpret_cast<uintptr_t>(chunk.valid) % sizeof(uint32_t));
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Builds the column of a field from its chunks in all record batches
+   *
+   * @param[in] field The field to read
+   * @param[in] chunks The chunks of the field, one per record batch
+   * @param[in] is_index Whether the chunks hold dictionary indices, which are
+   * read into a GDF_CATEGORY column of int32
+   * @param[in] zero_copy Whether a single chunk may be returned as a view
+   * @param[in] stream The stream to run on
+   * @param[out] column The column, with buffers allocated unless it is a view.
+   * On failure it holds what was allocated so far, see free_column
+   * @param[out] is_view Whether the column is a view into the chunks
+   *
+   * @returns GDF_SUCCESS upon successful completion
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error make_column(field_desc const& field, std::vector<column_chunk> const& chunks,
+                        bool is_index, bool zero_copy, cudaStream_t stream,
+                        gdf_column* column, bool* is_view)
+  {
+    column->data = nullptr;
+    column->valid = nullptr;
+    column->col_name = nullptr;
+    column->dtype = is_index ? GDF_CATEGORY : field.dtype;
+    *is_view = false;
+
+    int64_t size{0};
+    gdf_size_type null_count{0};
+    for (auto const& chunk : chunks) {
+      size += chunk.size;
+      null_count += chunk.null_count;
+    }
+    GDF_REQUIRE(size <= std::numeric_limits<gdf_size_type>::max(), GDF_COLUMN_SIZE_TOO_BIG);
+
+    column->size = static_cast<gdf_size_type>(size);
+    column->null_count = null_count;
+    column->dtype_info = is_index ? gdf_dtype_extra_info{TIME_UNIT_NONE} : field.dtype_info;
+    column->col_name = static_cast<char*>(malloc(field.name.size() + 1));
+    memcpy(column->col_name, field.name.c_str(), field.name.size() + 1);
+
+    if (zero_copy && (1 == chunks.size()) && is_viewable(field, chunks[0], is_index)) {
+      column->data = const_cast<uint8_t*>(chunks[0].data);
+      column->valid = const_cast<gdf_valid_type*>(chunks[0].valid);
+      *is_view = true;
+      return GDF_SUCCESS;
+    }
+
+    if (null_count > 0) {
+      gdf_size_type const num_masks = gdf_get_num_chars_bitmask(column->size);
+      RMM_TRY( RMM_ALLOC(&column->valid, sizeof(gdf_valid_type) * num_masks, stream) );
+      gdf_size_type offset{0};
+      for (auto const& chunk : chunks) {
+        // The bitmask kernels read the validity a word at a time
+        gdf_valid_type* aligned{nullptr};
+        gdf_error status{GDF_SUCCESS};
+        if (0 != reinterpret_cast<uintptr_t>(chunk.valid) % sizeof(uint32_t)) {
+          gdf_size_type const num_bytes = gdf_get_num_chars_bitmask(chunk.size);
+          SCRATCH_ALLOC_TRY(&aligned, num_bytes, stream);
+          if (cudaSuccess != cudaMemcpyAsync(aligned, chunk.valid, num_bytes, cudaMemcpyDeviceToDevice, stream)) {
+            status = GDF_CUDA_ERROR;
+          }
+        }
+        if (GDF_SUCCESS == status) {
+          status = bitmask_copy_offset(column->valid, offset,
+                                       (nullptr != aligned) ? aligned : chunk.valid, 0,
+                                       chunk.size, stream);
+        }
+        if (nullptr != aligned) {
+          SCRATCH_FREE_TRY(aligned, stream);
+        }
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        offset += chunk.size;
+      }
+    }
+
+    if (GDF_STRING == column->dtype) {
+      string_pair* pairs{nullptr};
+      if (column->size > 0) {
+        SCRATCH_ALLOC_TRY(&pairs, sizeof(string_pair) * column->size, stream);
+      }
+      gdf_size_type offset{0};
+      for (auto const& chunk : chunks) {
+        thrust::for_each(rmm::exec_policy(stream)->on(stream),
+                         thrust::make_counting_iterator<gdf_size_type>(0),
+                         thrust::make_counting_iterator<gdf_size_type>(chunk.size),
+                         make_string_pair{chunk.offsets, reinterpret_cast<char const*>(chunk.data),
+                                          chunk.valid, pairs + offset});
+        offset += chunk.size;
+      }
+      cudaError_t const sync_status = cudaStreamSynchronize(stream);
+      if (cudaSuccess == sync_status) {
+        column->data = NVStrings::create_from_index(pairs, column->size);
+      }
+      if (nullptr != pairs) {
+        SCRATCH_FREE_TRY(pairs, stream);
+      }
+      CUDA_TRY( sync_status );
+      return GDF_SUCCESS;
+    }
+
+    if (0 == column->size) {
+      return GDF_SUCCESS;
+    }
+
+    int const width = is_index ? int{sizeof(int32_t)} : std::max(field.width, 1);
+    RMM_TRY( RMM_ALLOC(&column->data, int64_t{width} * column->size, stream) );
+
+    uint8_t* output = static_cast<uint8_t*>(column->data);
+    for (auto const& chunk : chunks) {
+      if (is_index && int{sizeof(int32_t)} != field.index_width) {
+        int32_t* indices = reinterpret_cast<int32_t*>(output);
+        switch (field.index_width) {
+          case 1: widen_indices<int8_t>(chunk, indices, stream); break;
+          case 2: widen_indices<int16_t>(chunk, indices, stream); break;
+          default: widen_indices<int64_t>(chunk, indices, stream); break;
+        }
+      } else if (!is_index && 0 == field.width) {
+        thrust::transform(rmm::exec_policy(stream)->on(stream),
+                          thrust::make_counting_iterator<gdf_size_type>(0),
+                          thrust::make_counting_iterator<gdf_size_type>(chunk.size),
+                          reinterpret_cast<int8_t*>(output), unpack_bits{chunk.data});
+      } else {
+        CUDA_TRY( cudaMemcpyAsync(output, chunk.data, int64_t{width} * chunk.size,
+                                  cudaMemcpyDeviceToDevice, stream) );
+      }
+      output += int64_t{width} * chunk.size;
+    }
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Frees a column made by make_column, including the struct. The
+   * buffers of a view belong to the input and are left alone.
+   */
+  /* ----------------------------------------------------------------------------*/
+  void free_column(gdf_column* column, bool is_view, cudaStream_t stream)
+  {
+    if (nullptr == column) {
+      return;
+    }
+    if (!is_view) {
+      if (GDF_STRING == column->dtype) {
+        if (nullptr != column->data) {
+          NVStrings::destroy(static_cast<NVStrings*>(column->data));
+        }
+      } else if (nullptr != column->data) {
+        RMM_FREE(column->data, stream);
+      }
+      if (nullptr != column->valid) {
+        RMM_FREE(column->valid, stream);
+      }
+    }
+    free(column->col_name);
+    free(column);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Frees the outputs of a failed read_ipc and resets them
+   */
+  /* ----------------------------------------------------------------------------*/
+  void free_output(ipc_read_arg* args, cudaStream_t stream)
+  {
+    for (int i = 0; i < args->num_cols_out; ++i) {
+      free_column(args->data[i], args->is_view[i], stream);
+      free_column(args->dictionaries[i], false, stream);
+    }
+    free(args->data);
+    free(args->dictionaries);
+    free(args->is_view);
+    args->data = nullptr;
+    args->dictionaries = nullptr;
+    args->is_view = nullptr;
+    args->num_cols_out = 0;
+    args->num_rows_out = 0;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Finds the messages of an IPC file, which follow the magic and end
+   * at the footer, or of an IPC stream
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error find_messages(uint8_t const* buffer, size_t size,
+                          uint8_t const** begin, uint8_t const** end)
+  {
+    *begin = buffer;
+    *end = buffer + size;
+
+    char header[file_header_size] = {0};
+    if (size < file_header_size) {
+      return GDF_SUCCESS;
+    }
+    CUDA_TRY( cudaMemcpy(header, buffer, file_header_size, cudaMemcpyDeviceToHost) );
+    if (0 != memcmp(header, file_magic, file_magic_size)) {
+      return GDF_SUCCESS;
+    }
+
+    // The file ends with the footer, its length and the magic
+    size_t const trailer_size{sizeof(int32_t) + file_magic_size};
+    GDF_REQUIRE(size >= file_header_size + trailer_size, GDF_FILE_ERROR);
+    char trailer[trailer_size];
+    CUDA_TRY( cudaMemcpy(trailer, buffer + size - trailer_size, trailer_size, cudaMemcpyDeviceToHost) );
+    GDF_REQUIRE(0 == memcmp(trailer + sizeof(int32_t), file_magic, file_magic_size), GDF_FILE_ERROR);
+
+    int32_t footer_length{0};
+    memcpy(&footer_length, trailer, sizeof(int32_t));
+    GDF_REQUIRE(footer_length >= 0 &&
+                static_cast<size_t>(footer_length) <= size - file_header_size - trailer_size,
+                GDF_FILE_ERROR);
+
+    *begin = buffer + file_header_size;
+    *end = buffer + size - trailer_size - footer_length;
+    return GDF_SUCCESS;
+  }
+
+} // unnamed namespace
+
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Reads an Arrow IPC stream or file into gdf_columns
+ *
+ * The stream starts with the schema, followed by the dictionary batches and
+ * the record batches, whose columns are concatenated. Dictionary encoded
+ * fields are read into GDF_CATEGORY columns of int32 indices, their values
+ * into args->dictionaries. Utf8 fields are read into GDF_STRING columns.
+ *
+ * @param[in,out] args The input buffer and the output columns, see
+ * ipc_read_arg. Nothing stays allocated in it when the read fails.
+ *
+ * @returns GDF_SUCCESS upon successful completion, GDF_FILE_ERROR if the
+ * input is malformed, GDF_UNSUPPORTED_DTYPE for fields of nested types and
+ * GDF_NOTIMPLEMENTED_ERROR for delta or replaced dictionaries
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error read_ipc(ipc_read_arg *args)
+{
+  GDF_REQUIRE(nullptr != args, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(nullptr != args->buffer, GDF_DATASET_EMPTY);
+
+  cudaStream_t stream{0};
+
+  uint8_t const* begin{nullptr};
+  uint8_t const* end{nullptr};
+  gdf_error status = find_messages(static_cast<uint8_t const*>(args->buffer), args->buffer_size,
+                                   &begin, &end);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+  message_reader reader(begin, end);
+  flatbuf::Message const* message{nullptr};
+
+  // The schema comes first
+  status = reader.next(&message);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+  GDF_REQUIRE(nullptr != message && flatbuf::MessageHeader_Schema == message->header_type(),
+              GDF_FILE_ERROR);
+
+  std::vector<field_desc> fields;
+  auto const schema = message->header_as_Schema();
+  if (nullptr != schema->fields()) {
+    for (auto const field : *schema->fields()) {
+      fields.push_back(field_desc());
+      status = describe_field(field, &fields.back());
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+    }
+  }
+
+  // The chunks of each field, and the values of each dictionary
+  std::vector<std::vector<column_chunk>> columns(fields.size());
+  std::map<int64_t, std::pair<field_desc, column_chunk>> dictionaries;
+  int64_t num_rows{0};
+
+  while (true) {
+    status = reader.next(&message);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    if (nullptr == message) {
+      break;
+    }
+
+    std::vector<column_chunk> chunks;
+
+    if (flatbuf::MessageHeader_DictionaryBatch == message->header_type()) {
+      auto const batch = message->header_as_DictionaryBatch();
+      GDF_REQUIRE(!batch->isDelta(), GDF_NOTIMPLEMENTED_ERROR);
+      GDF_REQUIRE(0 == dictionaries.count(batch->id()), GDF_NOTIMPLEMENTED_ERROR);
+
+      auto const field = std::find_if(fields.begin(), fields.end(), [&](field_desc const& f) {
+        return f.dictionary_id == batch->id();
+      });
+      GDF_REQUIRE(fields.end() != field, GDF_FILE_ERROR);
+
+      std::vector<field_desc> values(1, *field);
+      values[0].dictionary_id = -1;
+      status = describe_batch(batch->data(), reader.body(), message->bodyLength(), values, true, &chunks);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      dictionaries[batch->id()] = std::make_pair(values[0], chunks[0]);
+    }
+    else if (flatbuf::MessageHeader_RecordBatch == message->header_type()) {
+      auto const batch = message->header_as_RecordBatch();
+      status = describe_batch(batch, reader.body(), message->bodyLength(), fields, false, &chunks);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      for (size_t i = 0; i < fields.size(); ++i) {
+        columns[i].push_back(chunks[i]);
+      }
+      num_rows += batch->length();
+    }
+    else {
+      return GDF_FILE_ERROR;
+    }
+  }
+  GDF_REQUIRE(num_rows <= std::numeric_limits<gdf_size_type>::max(), GDF_COLUMN_SIZE_TOO_BIG);
+
+  int const num_cols = static_cast<int>(fields.size());
+  gdf_column** data = static_cast<gdf_column**>(malloc(sizeof(gdf_column*) * num_cols));
+  gdf_column** dictionary_cols = static_cast<gdf_column**>(malloc(sizeof(gdf_column*) * num_cols));
+  bool* is_view = static_cast<bool*>(malloc(sizeof(bool) * num_cols));
+
+  args->data = data;
+  args->dictionaries = dictionary_cols;
+  args->is_view = is_view;
+  args->num_cols_out = num_cols;
+  args->num_rows_out = static_cast<gdf_size_type>(num_rows);
+
+  for (int i = 0; i < num_cols; ++i) {
+    data[i] = nullptr;
+    dictionary_cols[i] = nullptr;
+    is_view[i] = false;
+  }
+
+  for (int i = 0; i < num_cols; ++i) {
+    field_desc const& field = fields[i];
+    bool const is_dictionary = (field.dictionary_id >= 0);
+
+    data[i] = static_cast<gdf_column*>(malloc(sizeof(gdf_column)));
+    status = make_column(field, columns[i], is_dictionary, args->zero_copy, stream,
+                         data[i], &is_view[i]);
+
+    if (GDF_SUCCESS == status && is_dictionary) {
+      auto const values = dictionaries.find(field.dictionary_id);
+      if (dictionaries.end() == values) {
+        status = GDF_FILE_ERROR;
+      }
+      else {
+        // Dictionaries are always copied, is_view only describes data[i]
+        bool dictionary_is_view{false};
+        dictionary_cols[i] = static_cast<gdf_column*>(malloc(sizeof(gdf_column)));
+        status = make_column(values->second.first, {values->second.second}, false, false, stream,
+                             dictionary_cols[i], &dictionary_is_view);
+      }
+    }
+
+    if (GDF_SUCCESS != status) {
+      free_output(args, stream);
+      return status;
+    }
+  }
+
+  return GDF_SUCCESS;
+}
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Writes gdf_columns as an Arrow IPC stream
+ *
+ * The stream is a schema message, one record batch message whose body holds
+ * the column buffers, and the end of stream marker. The metadata is built on
+ * the host, the buffers are copied straight from the columns.
+ *
+ * @file ipc_writer.cu
+ * ---------------------------------------------------------------------------**/
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#pragma diag_suppress set_but_not_used
+#include <cudf/ipc_generated/Schema_generated.h>
+#pragma diag_default set_but_not_used
+#include <cudf/ipc_generated/Message_generated.h>
+
+#include "cudf.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+
+using namespace org::apache::arrow;
+
+namespace { // unnamed namespace
+
+  // Buffers and messages start at multiples of the alignment
+  constexpr int64_t alignment{8};
+
+  int64_t padded(int64_t size)
+  {
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A buffer of a column, and where it goes in the record batch body
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct body_buffer
+  {
+    void const* data;
+    int64_t offset;
+    int64_t length;
+  };
+
+  flatbuf::TimeUnit to_arrow_unit(gdf_time_unit unit)
+  {
+    switch (unit) {
+      case TIME_UNIT_s:  return flatbuf::TimeUnit_SECOND;
+      case TIME_UNIT_us: return flatbuf::TimeUnit_MICROSECOND;
+      case TIME_UNIT_ns: return flatbuf::TimeUnit_NANOSECOND;
+      default:           return flatbuf::TimeUnit_MILLISECOND;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Builds the schema field of a column
+   *
+   * GDF_CATEGORY columns are written as their int32 codes.
+   *
+   * @returns GDF_SUCCESS, or GDF_UNSUPPORTED_DTYPE for GDF_STRING
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error make_field(flatbuffers::FlatBufferBuilder& fbb, gdf_column const* column,
+                       flatbuffers::Offset<flatbuf::Field>* field)
+  {
+    flatbuf::Type type_type;
+    flatbuffers::Offset<void> type;
+
+    switch (column->dtype) {
+      case GDF_INT8:
+      case GDF_INT16:
+      case GDF_INT32:
+      case GDF_INT64:
+      case GDF_CATEGORY: {
+        int width{0};
+        gdf_error const status = get_column_byte_width(const_cast<gdf_column*>(column), &width);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        type_type = flatbuf::Type_Int;
+        type = flatbuf::CreateInt(fbb, width * 8, true).Union();
+        break;
+      }
+      case GDF_FLOAT32:
+        type_type = flatbuf::Type_FloatingPoint;
+        type = flatbuf::CreateFloatingPoint(fbb, flatbuf::Precision_SINGLE).Union();
+        break;
+      case GDF_FLOAT64:
+        type_type = flatbuf::Type_FloatingPoint;
+        type = flatbuf::CreateFloatingPoint(fbb, flatbuf::Precision_DOUBLE).Union();
+        break;
+      case GDF_DATE32:
+        type_type = flatbuf::Type_Date;
+        type = flatbuf::CreateDate(fbb, flatbuf::DateUnit_DAY).Union();
+        break;
+      case GDF_DATE64:
+        type_type = flatbuf::Type_Date;
+        type = flatbuf::CreateDate(fbb, flatbuf::DateUnit_MILLISECOND).Union();
+        break;
+      case GDF_TIMESTAMP:
+        type_type = flatbuf::Type_Timestamp;
+        type = flatbuf::CreateTimestamp(fbb, to_arrow_unit(column->dtype_info.time_unit)).Union();
+        break;
+      default:
+        return GDF_UNSUPPORTED_DTYPE;
+    }
+
+    // Arrow requires the children, even if there are none
+    auto const name = fbb.CreateString((nullptr != column->col_name) ? column->col_name : "");
+    auto const children = fbb.CreateVector(std::vector<flatbuffers::Offset<flatbuf::Field>>());
+    *field = flatbuf::CreateField(fbb, name, true, type_type, type, 0, children);
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Frames a message: its metadata length, the metadata and padding
+   * to the alignment, which the body follows
+   */
+  /* ----------------------------------------------------------------------------*/
+  std::vector<uint8_t> frame_message(flatbuffers::FlatBufferBuilder& fbb,
+                                     flatbuf::MessageHeader header_type,
+                                     flatbuffers::Offset<void> header,
+                                     int64_t body_length)
+  {
+    fbb.Finish(flatbuf::CreateMessage(fbb, flatbuf::MetadataVersion_V4, header_type, header, body_length));
+
+    int32_t const length = static_cast<int32_t>(padded(sizeof(int32_t) + fbb.GetSize()) - sizeof(int32_t));
+    std::vector<uint8_t> frame(sizeof(int32_t) + length, 0);
+    memcpy(frame.data(), &length, sizeof(int32_t));
+    memcpy(frame.data() + sizeof(int32_t), fbb.GetBufferPointer(), fbb.GetSize());
+    return frame;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Writes all the pieces to a file descriptor, as few writev calls as
+   * possible
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error write_all(int fd, std::vector<iovec>& pieces)
+  {
+    size_t first{0};
+    while (first < pieces.size()) {
+      if (0 == pieces[first].iov_len) {
+        ++first;
+        continue;
+      }
+      int const count = static_cast<int>(std::min<size_t>(IOV_MAX, pieces.size() - first));
+      ssize_t written = writev(fd, &pieces[first], count);
+      if (written < 0) {
+        GDF_REQUIRE(EINTR == errno, GDF_FILE_ERROR);
+        continue;
+      }
+      // The first piece is not empty, so a write without progress would
+      // repeat forever
+      GDF_REQUIRE(written > 0, GDF_FILE_ERROR);
+      // Skip what was written, which may end inside a piece
+      while (written > 0) {
+        size_t const length = std::min<size_t>(written, pieces[first].iov_len);
+        pieces[first].iov_base = static_cast<uint8_t*>(pieces[first].iov_base) + length;
+        pieces[first].iov_len -= length;
+        written -= length;
+        if (0 == pieces[first].iov_len) {
+          ++first;
+        }
+      }
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Gathers the messages and the body into a file descriptor
+   *
+   * Buffers in host memory are written from where they are, the others are
+   * staged in pinned memory first.
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error write_to_fd(int fd, std::vector<uint8_t>& schema, std::vector<uint8_t>& batch,
+                        std::vector<body_buffer> const& buffers, int64_t body_length,
+                        std::vector<uint8_t>& end_of_stream)
+  {
+    static uint8_t zeros[alignment] = {0};
+
+    int64_t staged_length{0};
+    std::vector<bool> is_host(buffers.size());
+    for (size_t b = 0; b < buffers.size(); ++b) {
+      is_host[b] = is_host_memory(buffers[b].data);
+      if (!is_host[b]) {
+        staged_length += padded(buffers[b].length);
+      }
+    }
+
+    uint8_t* staging{nullptr};
+    if (staged_length > 0) {
+      CUDA_TRY( cudaMallocHost(&staging, staged_length) );
+    }
+
+    std::vector<iovec> pieces;
+    pieces.push_back(iovec{schema.data(), schema.size()});
+    pieces.push_back(iovec{batch.data(), batch.size()});
+
+    int64_t position{0};
+    int64_t staged{0};
+    cudaError_t copy_status{cudaSuccess};
+    for (size_t b = 0; b < buffers.size(); ++b) {
+      body_buffer const& buffer = buffers[b];
+      void* data = const_cast<void*>(buffer.data);
+      if (!is_host[b]) {
+        data = staging + staged;
+        copy_status = (cudaSuccess != copy_status) ? copy_status :
+          cudaMemcpyAsync(data, buffer.data, buffer.length, cudaMemcpyDeviceToHost, 0);
+        staged += padded(buffer.length);
+      }
+      pieces.push_back(iovec{zeros, static_cast<size_t>(buffer.offset - position)});
+      pieces.push_back(iovec{data, static_cast<size_t>(buffer.length)});
+      position = buffer.offset + buffer.length;
+    }
+    pieces.push_back(iovec{zeros, static_cast<size_t>(body_length - position)});
+    pieces.push_back(iovec{end_of_stream.data(), end_of_stream.size()});
+
+    if (cudaSuccess == copy_status) {
+      copy_status = cudaStreamSynchronize(0);
+    }
+    gdf_error const status = (cudaSuccess == copy_status) ? write_all(fd, pieces) : GDF_CUDA_ERROR;
+
+    if (nullptr != staging) {
+      CUDA_TRY( cudaFreeHost(staging) );
+    }
+    return status;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Copies the messages and the body into a device buffer
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error write_to_device(uint8_t* output, std::vector<uint8_t> const& schema,
+                            std::vector<uint8_t> const& batch,
+                            std::vector<body_buffer> const& buffers, int64_t body_length,
+                            std::vector<uint8_t> const& end_of_stream)
+  {
+    CUDA_TRY( cudaMemcpyAsync(output, schema.data(), schema.size(), cudaMemcpyHostToDevice, 0) );
+    output += schema.size();
+    CUDA_TRY( cudaMemcpyAsync(output, batch.data(), batch.size(), cudaMemcpyHostToDevice, 0) );
+    output += batch.size();
+
+    // Zero the padding between the buffers
+    CUDA_TRY( cudaMemsetAsync(output, 0, body_length, 0) );
+    for (auto const& buffer : buffers) {
+      CUDA_TRY( cudaMemcpyAsync(output + buffer.offset, buffer.data, buffer.length, cudaMemcpyDefault, 0) );
+    }
+    output += body_length;
+
+    CUDA_TRY( cudaMemcpyAsync(output, end_of_stream.data(), end_of_stream.size(), cudaMemcpyHostToDevice, 0) );
+    CUDA_TRY( cudaStreamSynchronize(0) );
+    return GDF_SUCCESS;
+  }
+
+} // unnamed namespace
+
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Writes columns as an Arrow IPC stream with a single record batch
+ *
+ * The validity and data buffers are written as they are, the validity only
+ * for columns with nulls. GDF_CATEGORY columns are written as int32 columns.
+ * The stream can be read back with read_ipc, or by Arrow.
+ *
+ * @param[in] columns The columns to write, all of the same size
+ * @param[in] num_cols The number of columns
+ * @param[in,out] sink Where to write the stream, returns its size. Passing a
+ * NULL device buffer only computes the size
+ *
+ * @returns GDF_SUCCESS upon successful completion, GDF_UNSUPPORTED_DTYPE for
+ * GDF_STRING columns, GDF_INVALID_API_CALL if the device buffer is too small
+ * and GDF_FILE_ERROR if writing to the file descriptor fails
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_to_arrow_ipc(gdf_column **columns, int num_cols, gdf_ipc_sink *sink)
+{
+  GDF_REQUIRE(nullptr != sink, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(num_cols >= 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(0 == num_cols || nullptr != columns, GDF_DATASET_EMPTY);
+
+  gdf_size_type const num_rows = (num_cols > 0) ? columns[0]->size : 0;
+
+  flatbuffers::FlatBufferBuilder schema_fbb;
+  std::vector<flatbuffers::Offset<flatbuf::Field>> fields(num_cols);
+  std::vector<flatbuf::FieldNode> nodes;
+  std::vector<flatbuf::Buffer> buffer_descs;
+  std::vector<body_buffer> buffers;
+  int64_t body_length{0};
+
+  for (int i = 0; i < num_cols; ++i) {
+    gdf_column const* column = columns[i];
+    GDF_REQUIRE(nullptr != column, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(num_rows == column->size, GDF_COLUMN_SIZE_MISMATCH);
+    GDF_REQUIRE(0 == column->size || nullptr != column->data, GDF_DATASET_EMPTY);
+
+    gdf_error status = make_field(schema_fbb, column, &fields[i]);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    int width{0};
+    status = get_column_byte_width(const_cast<gdf_column*>(column), &width);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    bool const has_nulls = (nullptr != column->valid) && (column->null_count > 0);
+    nodes.push_back(flatbuf::FieldNode(column->size, has_nulls ? column->null_count : 0));
+
+    // The validity, then the data
+    int64_t const lengths[] = {has_nulls ? gdf_get_num_chars_bitmask(column->size) : 0,
+                               int64_t{width} * column->size};
+    void const* data[] = {column->valid, column->data};
+    for (int b = 0; b < 2; ++b) {
+      buffer_descs.push_back(flatbuf::Buffer(body_length, lengths[b]));
+      if (lengths[b] > 0) {
+        buffers.push_back(body_buffer{data[b], body_length, lengths[b]});
+      }
+      body_length += padded(lengths[b]);
+    }
+  }
+
+  auto const schema_header = flatbuf::CreateSchema(schema_fbb, flatbuf::Endianness_Little,
+                                                   schema_fbb.CreateVector(fields));
+  std::vector<uint8_t> schema = frame_message(schema_fbb, flatbuf::MessageHeader_Schema,
+                                              schema_header.Union(), 0);
+
+  flatbuffers::FlatBufferBuilder batch_fbb;
+  auto const batch_header = flatbuf::CreateRecordBatch(batch_fbb, num_rows,
+                                                       batch_fbb.CreateVectorOfStructs(nodes),
+                                                       batch_fbb.CreateVectorOfStructs(buffer_descs));
+  std::vector<uint8_t> batch = frame_message(batch_fbb, flatbuf::MessageHeader_RecordBatch,
+                                             batch_header.Union(), body_length);
+
+  std::vector<uint8_t> end_of_stream(sizeof(int32_t), 0);
+
+  sink->bytes_written = schema.size() + batch.size() + body_length + end_of_stream.size();
+
+  if (IPC_FILE_DESCRIPTOR == sink->sink_form) {
+    return write_to_fd(sink->fd, schema, batch, buffers, body_length, end_of_stream);
+  }
+
+  GDF_REQUIRE(IPC_DEVICE_BUFFER == sink->sink_form, GDF_INVALID_API_CALL);
+  if (nullptr == sink->buffer) {
+    return GDF_SUCCESS;
+  }
+  GDF_REQUIRE(sink->bytes_written <= sink->buffer_size, GDF_INVALID_API_CALL);
+  return write_to_device(static_cast<uint8_t*>(sink->buffer), schema, batch, buffers, body_length,
+                         end_of_stream);
+}
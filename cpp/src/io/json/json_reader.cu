@@ -0,0 +1,756 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Reads JSON Lines into gdf_columns
+ *
+ * The records are found the same way read_csv finds its rows. Each record is
+ * then tokenized by its own thread, which matches the keys of the record to
+ * the columns, named after the keys of the first record, and converts the
+ * values with the converters of the CSV reader.
+ *
+ * @file json_reader.cu
+ * ---------------------------------------------------------------------------**/
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <thrust/sort.h>
+
+#include <NVStrings.h>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/allocator.hpp"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "utilities/trie.cuh"
+#include "utilities/type_dispatcher.hpp"
+#include "bitmask/bit_mask.h"
+#include "io/csv/type_conversion.cuh"
+#include "io/utilities/parsing_utils.cuh"
+#include "io/utilities/source_file.h"
+
+namespace { // unnamed namespace
+
+  using string_pair = std::pair<const char*, size_t>;
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The location of a key and its value in the data, the ends are one
+   * past the last character. The key excludes its quotes, the value does not.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct json_field
+  {
+    long key_start;
+    long key_end;
+    long value_start;
+    long value_end;
+  };
+
+  __host__ __device__ inline long skip_whitespace(const char* data, long pos, long stop)
+  {
+    while (pos < stop && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r' || data[pos] == '\n')) {
+      ++pos;
+    }
+    return pos;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Returns the position past the closing quote of the string that
+   * starts at pos, skipping escaped characters
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline long seek_string_end(const char* data, long pos, long stop)
+  {
+    for (++pos; pos < stop; ++pos) {
+      if (data[pos] == '\\') {
+        ++pos;
+      }
+      else if (data[pos] == '"') {
+        return pos + 1;
+      }
+    }
+    return stop;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Returns the position past the value that starts at pos
+   *
+   * Nested objects and arrays are skipped as a whole.
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline long seek_value_end(const char* data, long pos, long stop)
+  {
+    if (data[pos] == '"') {
+      return seek_string_end(data, pos, stop);
+    }
+    if (data[pos] == '{' || data[pos] == '[') {
+      int depth = 0;
+      while (pos < stop) {
+        const char c = data[pos];
+        if (c == '"') {
+          pos = seek_string_end(data, pos, stop);
+          continue;
+        }
+        if (c == '{' || c == '[') {
+          ++depth;
+        }
+        else if ((c == '}' || c == ']') && --depth == 0) {
+          return pos + 1;
+        }
+        ++pos;
+      }
+      return stop;
+    }
+    while (pos < stop && data[pos] != ',' && data[pos] != '}' &&
+           data[pos] != ' ' && data[pos] != '\t' && data[pos] != '\r' && data[pos] != '\n') {
+      ++pos;
+    }
+    return pos;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Returns the position of the first field of the record in
+   * [start, stop), or stop if the record is not an object
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline long first_field(const char* data, long start, long stop)
+  {
+    const long pos = skip_whitespace(data, start, stop);
+    return (pos < stop && data[pos] == '{') ? pos + 1 : stop;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Reads the field at pos, and advances pos past it
+   *
+   * @returns false at the end of the object, or if the object is malformed
+   */
+  /* ----------------------------------------------------------------------------*/
+  __host__ __device__ inline bool next_field(const char* data, long& pos, long stop, json_field* field)
+  {
+    pos = skip_whitespace(data, pos, stop);
+    if (pos < stop && data[pos] == ',') {
+      pos = skip_whitespace(data, pos + 1, stop);
+    }
+    if (pos >= stop || data[pos] != '"') {
+      return false;
+    }
+    field->key_start = pos + 1;
+    pos = seek_string_end(data, pos, stop);
+    field->key_end = pos - 1;
+    pos = skip_whitespace(data, pos, stop);
+    if (pos >= stop || data[pos] != ':') {
+      return false;
+    }
+    pos = skip_whitespace(data, pos + 1, stop);
+    if (pos >= stop) {
+      return false;
+    }
+    field->value_start = pos;
+    pos = seek_value_end(data, pos, stop);
+    field->value_end = pos;
+    return true;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The names of the columns, as the characters of all names and the
+   * offset of each name into them
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct column_names
+  {
+    const char* chars;
+    const long* offsets;  // num_columns + 1 offsets
+    int num_columns;
+  };
+
+  __device__ inline bool key_equals(column_names names, int col, const char* data, json_field const& field)
+  {
+    const long length = names.offsets[col + 1] - names.offsets[col];
+    if (length != field.key_end - field.key_start) {
+      return false;
+    }
+    for (long i = 0; i < length; ++i) {
+      if (names.chars[names.offsets[col] + i] != data[field.key_start + i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Returns the column of the key of the field, or -1 if the key is not
+   * a column
+   *
+   * Records usually list their keys in the same order, so the column at the
+   * index of the field is tried first.
+   */
+  /* ----------------------------------------------------------------------------*/
+  __device__ inline int find_column(column_names names, const char* data, json_field const& field, int field_index)
+  {
+    if (field_index < names.num_columns && key_equals(names, field_index, data, field)) {
+      return field_index;
+    }
+    for (int col = 0; col < names.num_columns; ++col) {
+      if (key_equals(names, col, data, field)) {
+        return col;
+      }
+    }
+    return -1;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The number of values of each kind in a column, used to infer its
+   * data type
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct json_type_counts
+  {
+    unsigned long long countString;
+    unsigned long long countFloat;
+    unsigned long long countInt;
+    unsigned long long countBool;
+    unsigned long long countNull;
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief CUDA kernel that counts the kinds of the values of every column,
+   * one record per thread
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__ void detectJsonTypes(const char* data, const ParseOptions opts,
+                                  gdf_size_type num_records, const cu_recstart_t* rec_starts,
+                                  column_names names, json_type_counts* counts)
+  {
+    const long rec_id = threadIdx.x + (blockDim.x * blockIdx.x);
+    if (rec_id >= num_records) {
+      return;
+    }
+    const long stop = rec_starts[rec_id + 1];
+    long pos = first_field(data, rec_starts[rec_id], stop);
+
+    json_field field;
+    for (int i = 0; next_field(data, pos, stop, &field); ++i) {
+      const int col = find_column(names, data, field, i);
+      if (col < 0) {
+        continue;
+      }
+      const char first = data[field.value_start];
+      const size_t length = field.value_end - field.value_start;
+      if (serializedTrieContains(opts.naValuesTrie, data + field.value_start, length)) {
+        atomicAdd(&counts[col].countNull, 1ull);
+      }
+      else if (first == '"' || first == '{' || first == '[') {
+        atomicAdd(&counts[col].countString, 1ull);
+      }
+      else if (serializedTrieContains(opts.trueValuesTrie, data + field.value_start, length) ||
+               serializedTrieContains(opts.falseValuesTrie, data + field.value_start, length)) {
+        atomicAdd(&counts[col].countBool, 1ull);
+      }
+      else {
+        bool is_float = false;
+        for (long p = field.value_start; p < field.value_end; ++p) {
+          is_float |= (data[p] == opts.decimal || data[p] == 'e' || data[p] == 'E');
+        }
+        atomicAdd(is_float ? &counts[col].countFloat : &counts[col].countInt, 1ull);
+      }
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief CUDA kernel that converts the values of every column, one record
+   * per thread
+   *
+   * Strings point into the data, without their quotes. The quotes of other
+   * values are removed before converting them, so that dates can be quoted.
+   * Nulls and missing keys leave the row invalid.
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__ void convertJsonToGdf(const char* data, const ParseOptions opts,
+                                   gdf_size_type num_records, const cu_recstart_t* rec_starts,
+                                   column_names names, const gdf_dtype* dtypes, void** gdf_data,
+                                   bit_mask::bit_mask_t** valid, string_pair** str_cols,
+                                   unsigned long long* num_valid)
+  {
+    const long rec_id = threadIdx.x + (blockDim.x * blockIdx.x);
+    if (rec_id >= num_records) {
+      return;
+    }
+    const long stop = rec_starts[rec_id + 1];
+    long pos = first_field(data, rec_starts[rec_id], stop);
+
+    json_field field;
+    for (int i = 0; next_field(data, pos, stop, &field); ++i) {
+      const int col = find_column(names, data, field, i);
+      if (col < 0 ||
+          serializedTrieContains(opts.naValuesTrie, data + field.value_start, field.value_end - field.value_start)) {
+        continue;
+      }
+      long start = field.value_start;
+      long end = field.value_end - 1;
+      if (data[start] == '"' && end > start && data[end] == '"') {
+        ++start;
+        --end;
+      }
+
+      if (dtypes[col] == GDF_STRING) {
+        str_cols[col][rec_id] = string_pair(data + start, end - start + 1);
+      }
+      else if (start <= end) {
+        cudf::type_dispatcher(dtypes[col], ConvertFunctor{}, data, gdf_data[col], rec_id, start, end, opts);
+      }
+      else {
+        continue;
+      }
+      // A key repeated within the record keeps its last value, but the row
+      // only counts once
+      if (!bit_mask::is_valid(valid[col], rec_id)) {
+        bit_mask::set_bit_safe(valid[col], rec_id);
+        atomicAdd(&num_valid[col], 1ull);
+      }
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Sets the data types of the columns from the dtype argument, either
+   * in the order of the columns ("int64") or by name ("id:int64")
+   *
+   * Columns without a data type are left GDF_invalid, to be inferred.
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error parse_dtypes(json_read_arg const* args, std::vector<std::string> const& col_names,
+                         std::vector<gdf_dtype>* dtypes)
+  {
+    dtypes->assign(col_names.size(), GDF_invalid);
+    if (nullptr == args->dtype) {
+      return GDF_SUCCESS;
+    }
+    GDF_REQUIRE(args->num_cols >= 0, GDF_INVALID_API_CALL);
+    const bool by_name = (args->num_cols > 0 && nullptr != strchr(args->dtype[0], ':'));
+    GDF_REQUIRE(by_name || args->num_cols <= static_cast<int>(col_names.size()), GDF_INVALID_API_CALL);
+
+    for (int i = 0; i < args->num_cols; ++i) {
+      std::string entry(args->dtype[i]);
+      const size_t colon = entry.rfind(':');
+      GDF_REQUIRE(by_name == (std::string::npos != colon), GDF_INVALID_API_CALL);
+
+      size_t col = i;
+      if (by_name) {
+        const auto it = std::find(col_names.begin(), col_names.end(), entry.substr(0, colon));
+        GDF_REQUIRE(it != col_names.end(), GDF_INVALID_API_CALL);
+        col = it - col_names.begin();
+        entry = entry.substr(colon + 1);
+      }
+      (*dtypes)[col] = convertStringToDtype(entry);
+      GDF_REQUIRE(GDF_invalid != (*dtypes)[col], GDF_UNSUPPORTED_DTYPE);
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Returns the names of the columns that the dtypes of read_json name,
+   * in their order, which are the columns of a byte range without records
+   */
+  /* ----------------------------------------------------------------------------*/
+  std::vector<std::string> typed_column_names(json_read_arg const* args)
+  {
+    std::vector<std::string> col_names;
+    if (nullptr == args->dtype || args->num_cols <= 0 || nullptr == strchr(args->dtype[0], ':')) {
+      return col_names;
+    }
+    for (int i = 0; i < args->num_cols; ++i) {
+      const std::string entry(args->dtype[i]);
+      const size_t colon = entry.rfind(':');
+      if (std::string::npos == colon) {
+        continue;
+      }
+      std::string name = entry.substr(0, colon);
+      if (std::find(col_names.begin(), col_names.end(), name) == col_names.end()) {
+        col_names.push_back(std::move(name));
+      }
+    }
+    return col_names;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Frees the outputs of a failed read_json and resets them
+   *
+   * @param[in,out] args The arguments of read_json
+   * @param[in] str_cols The string pairs not yet copied into NVStrings
+   * @param[in] stream The stream to free on
+   */
+  /* ----------------------------------------------------------------------------*/
+  void free_output(json_read_arg* args, std::vector<string_pair*> const& str_cols, cudaStream_t stream)
+  {
+    for (int col = 0; col < args->num_cols_out; ++col) {
+      if (nullptr != str_cols[col]) {
+        cudf::memory::device_allocator().deallocate(str_cols[col], stream);
+      }
+      gdf_column* const gdf = args->data[col];
+      if (nullptr == gdf) {
+        continue;
+      }
+      if (nullptr != gdf->data) {
+        if (GDF_STRING == gdf->dtype) {
+          NVStrings::destroy(static_cast<NVStrings*>(gdf->data));
+        } else {
+          RMM_FREE(gdf->data, stream);
+        }
+      }
+      if (nullptr != gdf->valid) {
+        RMM_FREE(gdf->valid, stream);
+      }
+      free(gdf->col_name);
+      free(gdf);
+    }
+    free(args->data);
+    args->data = nullptr;
+    args->num_cols_out = 0;
+    args->num_rows_out = 0;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Allocates the output columns of read_json
+   *
+   * The valid masks are cleared. Fixed width columns get their data, the
+   * GDF_STRING columns scratch string pairs in str_cols, which are copied into
+   * NVStrings once they are filled. Nothing stays allocated on failure.
+   *
+   * @param[in,out] args The arguments of read_json
+   * @param[in] col_names The names of the columns
+   * @param[in] dtypes The types of the columns
+   * @param[in] num_records The number of rows
+   * @param[out] str_cols The string pairs of each column, NULL for the fixed
+   * width columns
+   * @param[in] stream The stream to allocate on
+   *
+   * @returns GDF_SUCCESS upon successful completion
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error alloc_output(json_read_arg* args, std::vector<std::string> const& col_names,
+                         std::vector<gdf_dtype> const& dtypes, gdf_size_type num_records,
+                         std::vector<string_pair*>* str_cols, cudaStream_t stream)
+  {
+    const int num_cols = col_names.size();
+    args->data = static_cast<gdf_column**>(malloc(sizeof(gdf_column*) * num_cols));
+    args->num_cols_out = num_cols;
+    args->num_rows_out = num_records;
+    str_cols->assign(num_cols, nullptr);
+    for (int col = 0; col < num_cols; ++col) {
+      args->data[col] = nullptr;
+    }
+
+    auto const alloc = [&]() -> gdf_error {
+      for (int col = 0; col < num_cols; ++col) {
+        gdf_column* gdf = static_cast<gdf_column*>(malloc(sizeof(gdf_column)));
+        args->data[col] = gdf;
+        gdf->size = num_records;
+        gdf->dtype = dtypes[col];
+        gdf->dtype_info = gdf_dtype_extra_info{TIME_UNIT_NONE};
+        gdf->null_count = 0;
+        gdf->data = nullptr;
+        gdf->valid = nullptr;
+        gdf->col_name = static_cast<char*>(malloc(col_names[col].size() + 1));
+        memcpy(gdf->col_name, col_names[col].c_str(), col_names[col].size() + 1);
+        if (0 == num_records) {
+          continue;
+        }
+
+        const size_t valid_bytes = bit_mask::num_elements(num_records) * sizeof(bit_mask::bit_mask_t);
+        RMM_TRY( RMM_ALLOC(&gdf->valid, valid_bytes, stream) );
+        CUDA_TRY( cudaMemsetAsync(gdf->valid, 0, valid_bytes, stream) );
+
+        if (GDF_STRING == dtypes[col]) {
+          SCRATCH_ALLOC_TRY(&(*str_cols)[col], sizeof(string_pair) * num_records, stream);
+          CUDA_TRY( cudaMemsetAsync((*str_cols)[col], 0, sizeof(string_pair) * num_records, stream) );
+        }
+        else {
+          int column_byte_width = 0;
+          const gdf_error error = get_column_byte_width(gdf, &column_byte_width);
+          GDF_REQUIRE(GDF_SUCCESS == error, error);
+          RMM_TRY( RMM_ALLOC(&gdf->data, column_byte_width * num_records, stream) );
+        }
+      }
+      return GDF_SUCCESS;
+    };
+
+    const gdf_error error = alloc();
+    if (GDF_SUCCESS != error) {
+      free_output(args, *str_cols, stream);
+    }
+    return error;
+  }
+
+} // unnamed namespace
+
+/**---------------------------------------------------------------------------*
+ * @brief Reads JSON Lines, one object per line, into gdf_columns
+ *
+ * The columns are the keys of the first record, in their order. Keys that are
+ * not in the first record are ignored, and the rows of records that lack a
+ * key are null. Strings are read as they are written, escape sequences
+ * included. Nested objects and arrays are read as strings of their JSON text.
+ *
+ * Inferred types are GDF_STRING for strings, GDF_FLOAT64 for numbers with a
+ * fraction or an exponent and for integers with nulls, GDF_INT64 for other
+ * integers and GDF_INT8 for booleans and columns with only nulls.
+ *
+ * A byte range in which no record starts reads no rows, into the columns
+ * that the dtypes name.
+ *
+ * @param[in,out] args Structure containing both the the input arguments
+ * and the returned data. Nothing stays allocated in it when the read fails.
+ *
+ * @return gdf_error
+ *---------------------------------------------------------------------------**/
+gdf_error read_json(json_read_arg *args)
+{
+  GDF_REQUIRE(nullptr != args, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(nullptr != args->filepath_or_buffer, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(args->lines, GDF_NOTIMPLEMENTED_ERROR);
+
+  cudaStream_t stream{0};
+
+  source_file file;
+  if (FILE_PATH == args->input_data_form) {
+    const gdf_error status = file.open_path(args->filepath_or_buffer);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+  }
+  else if (HOST_BUFFER == args->input_data_form) {
+    file.use_buffer(args->filepath_or_buffer, args->buffer_size);
+  }
+  else {
+    return GDF_INVALID_API_CALL;
+  }
+  GDF_REQUIRE(args->byte_range_offset < file.size(), GDF_INVALID_API_CALL);
+
+  // Read the records that start in the byte range, up to the end of the last
+  // one, which may be past the end of the range
+  const char* const file_data = reinterpret_cast<const char*>(file.data());
+  size_t data_end = file.size();
+  if (args->byte_range_size != 0 && args->byte_range_offset + args->byte_range_size < file.size()) {
+    const size_t range_end = args->byte_range_offset + args->byte_range_size;
+    const void* const newline = memchr(file_data + range_end, '\n', file.size() - range_end);
+    if (nullptr != newline) {
+      data_end = static_cast<const char*>(newline) - file_data + 1;
+    }
+  }
+  const char* const h_data = file_data + args->byte_range_offset;
+  const size_t h_size = data_end - args->byte_range_offset;
+  const bool include_first_row = (0 == args->byte_range_offset);
+
+  gdf_size_type num_starts{0};
+  gdf_error error = launch_countRecords(h_data, h_size, '\n', '\0', include_first_row, num_starts);
+  GDF_REQUIRE(GDF_SUCCESS == error, error);
+
+  std::vector<cu_recstart_t> h_rec_starts(num_starts);
+  if (num_starts > 0) {
+    rmm::device_vector<cu_recstart_t> d_rec_starts(num_starts);
+    error = launch_storeRecordStart(h_data, h_size, '\n', '\0', include_first_row, d_rec_starts.data().get());
+    GDF_REQUIRE(GDF_SUCCESS == error, error);
+    thrust::sort(rmm::exec_policy(stream)->on(stream), d_rec_starts.begin(), d_rec_starts.end());
+    CUDA_TRY( cudaMemcpy(h_rec_starts.data(), d_rec_starts.data().get(), sizeof(cu_recstart_t) * num_starts,
+                         cudaMemcpyDeviceToHost) );
+  }
+
+  // The offset past the last record ends the last row, add it if the data
+  // does not end with a newline. Then drop the blank lines.
+  if (!h_rec_starts.empty() && h_rec_starts.back() != h_size) {
+    h_rec_starts.push_back(h_size);
+  }
+  if (!h_rec_starts.empty()) {
+    h_rec_starts.erase(std::remove_if(h_rec_starts.begin(), h_rec_starts.end() - 1,
+                                      [&](cu_recstart_t i) {
+                                        return i >= h_size || h_data[i] == '\n' || h_data[i] == '\r';
+                                      }),
+                       h_rec_starts.end() - 1);
+  }
+
+  // A byte range in which no record starts has no rows. Its columns are the
+  // ones the dtypes name, there is no record to name the others.
+  if (h_rec_starts.size() < 2) {
+    const std::vector<std::string> col_names = typed_column_names(args);
+    std::vector<gdf_dtype> dtypes;
+    if (!col_names.empty()) {
+      error = parse_dtypes(args, col_names, &dtypes);
+      GDF_REQUIRE(GDF_SUCCESS == error, error);
+    }
+    std::vector<string_pair*> str_cols;
+    error = alloc_output(args, col_names, dtypes, 0, &str_cols, stream);
+    GDF_REQUIRE(GDF_SUCCESS == error, error);
+    for (int col = 0; col < args->num_cols_out; ++col) {
+      if (GDF_STRING == dtypes[col]) {
+        args->data[col]->data = NVStrings::create_from_index(nullptr, 0);
+      }
+    }
+    return GDF_SUCCESS;
+  }
+  const gdf_size_type num_records = h_rec_starts.size() - 1;
+
+  // The columns are named after the keys of the first record
+  std::vector<std::string> col_names;
+  std::vector<long> h_name_offsets(1, 0);
+  std::string h_name_chars;
+  {
+    const long stop = h_rec_starts[1];
+    long pos = first_field(h_data, h_rec_starts[0], stop);
+    json_field field;
+    while (next_field(h_data, pos, stop, &field)) {
+      std::string name(h_data + field.key_start, field.key_end - field.key_start);
+      if (std::find(col_names.begin(), col_names.end(), name) == col_names.end()) {
+        h_name_chars += name;
+        h_name_offsets.push_back(h_name_chars.size());
+        col_names.push_back(std::move(name));
+      }
+    }
+  }
+  const int num_cols = col_names.size();
+  GDF_REQUIRE(num_cols > 0, GDF_FILE_ERROR);
+
+  std::vector<gdf_dtype> dtypes;
+  error = parse_dtypes(args, col_names, &dtypes);
+  GDF_REQUIRE(GDF_SUCCESS == error, error);
+
+  // Upload the records and the column names
+  const cu_recstart_t first_offset = h_rec_starts.front();
+  const size_t num_bytes = h_rec_starts.back() - first_offset;
+  for (auto& start : h_rec_starts) {
+    start -= first_offset;
+  }
+  rmm::device_vector<char> d_data(h_data + first_offset, h_data + first_offset + num_bytes);
+  rmm::device_vector<cu_recstart_t> d_rec_starts(h_rec_starts);
+  rmm::device_vector<char> d_name_chars(h_name_chars.begin(), h_name_chars.end());
+  rmm::device_vector<long> d_name_offsets(h_name_offsets);
+  const column_names names{d_name_chars.data().get(), d_name_offsets.data().get(), num_cols};
+
+  ParseOptions opts{};
+  opts.delimiter = ',';
+  opts.terminator = '\n';
+  opts.quotechar = '"';
+  opts.decimal = '.';
+  opts.keepquotes = false;
+  opts.skipblanklines = true;
+  rmm::device_vector<SerialTrieNode> d_trueTrie = createSerializedTrie({"true"});
+  rmm::device_vector<SerialTrieNode> d_falseTrie = createSerializedTrie({"false"});
+  rmm::device_vector<SerialTrieNode> d_naTrie = createSerializedTrie({"null"});
+  opts.trueValuesTrie = d_trueTrie.data().get();
+  opts.falseValuesTrie = d_falseTrie.data().get();
+  opts.naValuesTrie = d_naTrie.data().get();
+
+  int blockSize;    // suggested thread count to use
+  int minGridSize;  // minimum block count required
+
+  // Infer the data types that were not given
+  if (std::find(dtypes.begin(), dtypes.end(), GDF_invalid) != dtypes.end()) {
+    rmm::device_vector<json_type_counts> d_counts(num_cols, json_type_counts{});
+    CUDA_TRY( cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, detectJsonTypes) );
+    detectJsonTypes <<< (num_records + blockSize - 1) / blockSize, blockSize, 0, stream >>> (
+        d_data.data().get(), opts, num_records, d_rec_starts.data().get(), names,
+        d_counts.data().get());
+    CUDA_TRY( cudaGetLastError() );
+
+    std::vector<json_type_counts> h_counts(num_cols);
+    CUDA_TRY( cudaMemcpy(h_counts.data(), d_counts.data().get(), sizeof(json_type_counts) * num_cols,
+                         cudaMemcpyDeviceToHost) );
+    for (int col = 0; col < num_cols; ++col) {
+      if (GDF_invalid != dtypes[col]) {
+        continue;
+      }
+      json_type_counts const& counts = h_counts[col];
+      const unsigned long long num_values = counts.countString + counts.countFloat + counts.countInt + counts.countBool;
+      if (counts.countString > 0) {
+        dtypes[col] = GDF_STRING;
+      }
+      else if (counts.countFloat > 0 || (counts.countInt > 0 && num_values < static_cast<unsigned long long>(num_records))) {
+        // Like pandas, integers with nulls are read as floats
+        dtypes[col] = GDF_FLOAT64;
+      }
+      else if (counts.countInt > 0) {
+        dtypes[col] = GDF_INT64;
+      }
+      else {
+        dtypes[col] = GDF_INT8;
+      }
+    }
+  }
+
+  // The string pairs are copied into NVStrings once they are filled. The
+  // outputs are freed if the conversion fails.
+  std::vector<string_pair*> str_cols;
+  error = alloc_output(args, col_names, dtypes, num_records, &str_cols, stream);
+  GDF_REQUIRE(GDF_SUCCESS == error, error);
+
+  auto const convert = [&]() -> gdf_error {
+    std::vector<void*> h_gdf_data(num_cols);
+    std::vector<bit_mask::bit_mask_t*> h_valid(num_cols);
+    for (int col = 0; col < num_cols; ++col) {
+      h_gdf_data[col] = args->data[col]->data;
+      h_valid[col] = reinterpret_cast<bit_mask::bit_mask_t*>(args->data[col]->valid);
+    }
+    rmm::device_vector<gdf_dtype> d_dtypes(dtypes);
+    rmm::device_vector<void*> d_gdf_data(h_gdf_data);
+    rmm::device_vector<bit_mask::bit_mask_t*> d_valid(h_valid);
+    rmm::device_vector<string_pair*> d_str_cols(str_cols);
+    rmm::device_vector<unsigned long long> d_num_valid(num_cols, 0);
+
+    CUDA_TRY( cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, convertJsonToGdf) );
+    convertJsonToGdf <<< (num_records + blockSize - 1) / blockSize, blockSize, 0, stream >>> (
+        d_data.data().get(), opts, num_records, d_rec_starts.data().get(), names,
+        d_dtypes.data().get(), d_gdf_data.data().get(), d_valid.data().get(),
+        d_str_cols.data().get(), d_num_valid.data().get());
+    CUDA_TRY( cudaGetLastError() );
+
+    std::vector<unsigned long long> h_num_valid(num_cols);
+    CUDA_TRY( cudaMemcpy(h_num_valid.data(), d_num_valid.data().get(), sizeof(unsigned long long) * num_cols,
+                         cudaMemcpyDeviceToHost) );
+    for (int col = 0; col < num_cols; ++col) {
+      args->data[col]->null_count = num_records - h_num_valid[col];
+      if (GDF_STRING == dtypes[col]) {
+        args->data[col]->data = NVStrings::create_from_index(str_cols[col], num_records);
+        string_pair* const pairs = str_cols[col];
+        str_cols[col] = nullptr;
+        SCRATCH_FREE_TRY(pairs, stream);
+      }
+    }
+    return GDF_SUCCESS;
+  };
+
+  error = convert();
+  if (GDF_SUCCESS != error) {
+    free_output(args, str_cols, stream);
+  }
+  return error;
+}
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "orc_metadata.h"
+
+#include <cstring>
+
+namespace orc {
+
+namespace {
+
+// The wire types of Protocol Buffers
+enum {
+  PB_VARINT = 0,
+  PB_FIXED64 = 1,
+  PB_LENGTH_DELIMITED = 2,
+  PB_FIXED32 = 5,
+};
+
+/**
+ * @brief Reads the fields of a Protocol Buffers message, any read past the
+ * end of the message fails the reader
+ */
+class protobuf_reader {
+ public:
+  protobuf_reader(uint8_t const* data, size_t size)
+    : _cur(data), _end(data + size), _failed(false)
+  { }
+
+  bool failed() const { return _failed; }
+
+  uint64_t varint()
+  {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (_cur >= _end) {
+        break;
+      }
+      uint8_t const b = *_cur++;
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) {
+        return v;
+      }
+    }
+    _failed = true;
+    return 0;
+  }
+
+  int64_t sint()
+  {
+    uint64_t const v = varint();
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+
+  double fixed64_double()
+  {
+    double v = 0;
+    if (_end - _cur < static_cast<ptrdiff_t>(sizeof(v))) {
+      _failed = true;
+      return v;
+    }
+    memcpy(&v, _cur, sizeof(v));
+    _cur += sizeof(v);
+    return v;
+  }
+
+  /**
+   * @brief Reads the length of a length delimited field and skips past it,
+   * returning a reader of its contents
+   */
+  protobuf_reader nested()
+  {
+    uint64_t const length = varint();
+    if (_failed || length > static_cast<uint64_t>(_end - _cur)) {
+      _failed = true;
+      return protobuf_reader(_end, 0);
+    }
+    protobuf_reader reader(_cur, length);
+    _cur += length;
+    return reader;
+  }
+
+  std::string string()
+  {
+    protobuf_reader contents = nested();
+    return std::string(reinterpret_cast<char const*>(contents._cur), contents._end - contents._cur);
+  }
+
+  /**
+   * @brief Reads a repeated uint32, either packed or a single element
+   */
+  void uint32s(int wire_type, std::vector<uint32_t>* values)
+  {
+    if (PB_LENGTH_DELIMITED == wire_type) {
+      protobuf_reader contents = nested();
+      while (!contents.done()) {
+        values->push_back(static_cast<uint32_t>(contents.varint()));
+      }
+      _failed |= contents.failed();
+    }
+    else {
+      values->push_back(static_cast<uint32_t>(varint()));
+    }
+  }
+
+  /**
+   * @brief Reads the fields up to the end of the message
+   *
+   * For every field, read(id, wire_type) either reads it and returns true, or
+   * returns false to have it skipped.
+   */
+  template <typename F>
+  bool fields(F&& read)
+  {
+    while (!done()) {
+      uint64_t const key = varint();
+      uint32_t const id = static_cast<uint32_t>(key >> 3);
+      int const wire_type = key & 7;
+      if (!read(id, wire_type)) {
+        skip(wire_type);
+      }
+    }
+    return !_failed;
+  }
+
+ private:
+  uint8_t const* _cur;
+  uint8_t const* _end;
+  bool _failed;
+
+  bool done() const { return _failed || _cur >= _end; }
+
+  void skip(int wire_type)
+  {
+    switch (wire_type) {
+      case PB_VARINT:
+        varint();
+        break;
+      case PB_FIXED64:
+      case PB_FIXED32: {
+        ptrdiff_t const size = (PB_FIXED64 == wire_type) ? 8 : 4;
+        if (_end - _cur < size) {
+          _failed = true;
+        } else {
+          _cur += size;
+        }
+        break;
+      }
+      case PB_LENGTH_DELIMITED:
+        nested();
+        break;
+      default:
+        _failed = true;
+    }
+  }
+};
+
+bool read_stripe_information(protobuf_reader reader, StripeInformation* stripe)
+{
+  return reader.fields([&](uint32_t id, int wire_type) {
+    if (PB_VARINT != wire_type) return false;
+    switch (id) {
+      case 1: stripe->offset = reader.varint(); return true;
+      case 2: stripe->index_length = reader.varint(); return true;
+      case 3: stripe->data_length = reader.varint(); return true;
+      case 4: stripe->footer_length = reader.varint(); return true;
+      case 5: stripe->number_of_rows = reader.varint(); return true;
+      default: return false;
+    }
+  });
+}
+
+bool read_type(protobuf_reader reader, Type* type)
+{
+  return reader.fields([&](uint32_t id, int wire_type) {
+    switch (id) {
+      case 1: if (PB_VARINT != wire_type) return false; type->kind = static_cast<int32_t>(reader.varint()); return true;
+      case 2: reader.uint32s(wire_type, &type->subtypes); return true;
+      case 3: if (PB_LENGTH_DELIMITED != wire_type) return false; type->field_names.push_back(reader.string()); return true;
+      default: return false;
+    }
+  });
+}
+
+bool read_column_statistics(protobuf_reader reader, ColumnStatistics* stats)
+{
+  bool ok = true;
+  bool const parsed = reader.fields([&](uint32_t id, int wire_type) {
+    if (PB_LENGTH_DELIMITED != wire_type || (2 != id && 3 != id && 7 != id)) return false;
+    protobuf_reader contents = reader.nested();
+    ok &= contents.fields([&](uint32_t stat_id, int stat_type) {
+      if (stat_id < 1 || stat_id > 2) return false;
+      if (3 == id) {
+        if (PB_FIXED64 != stat_type) return false;
+        stats->has_double = true;
+        (1 == stat_id ? stats->double_min : stats->double_max) = contents.fixed64_double();
+      }
+      else {
+        if (PB_VARINT != stat_type) return false;
+        int64_t const v = contents.sint();
+        if (2 == id) {
+          stats->has_int = true;
+          (1 == stat_id ? stats->int_min : stats->int_max) = v;
+        }
+        else {
+          stats->has_date = true;
+          (1 == stat_id ? stats->date_min : stats->date_max) = static_cast<int32_t>(v);
+        }
+      }
+      return true;
+    });
+    return true;
+  });
+  return ok && parsed;
+}
+
+} // unnamed namespace
+
+bool parse_postscript(uint8_t const* data, size_t size, PostScript* postscript)
+{
+  protobuf_reader reader(data, size);
+  return reader.fields([&](uint32_t id, int wire_type) {
+    switch (id) {
+      case 1: if (PB_VARINT != wire_type) return false; postscript->footer_length = reader.varint(); return true;
+      case 2: if (PB_VARINT != wire_type) return false; postscript->compression = static_cast<int32_t>(reader.varint()); return true;
+      case 3: if (PB_VARINT != wire_type) return false; postscript->compression_block_size = reader.varint(); return true;
+      case 5: if (PB_VARINT != wire_type) return false; postscript->metadata_length = reader.varint(); return true;
+      case 8000: if (PB_LENGTH_DELIMITED != wire_type) return false; postscript->magic = reader.string(); return true;
+      default: return false;
+    }
+  });
+}
+
+bool parse_footer(uint8_t const* data, size_t size, FileFooter* footer)
+{
+  protobuf_reader reader(data, size);
+  bool ok = true;
+  bool const parsed = reader.fields([&](uint32_t id, int wire_type) {
+    switch (id) {
+      case 3:
+        if (PB_LENGTH_DELIMITED != wire_type) return false;
+        footer->stripes.push_back(StripeInformation());
+        ok &= read_stripe_information(reader.nested(), &footer->stripes.back());
+        return true;
+      case 4:
+        if (PB_LENGTH_DELIMITED != wire_type) return false;
+        footer->types.push_back(Type());
+        ok &= read_type(reader.nested(), &footer->types.back());
+        return true;
+      case 6: if (PB_VARINT != wire_type) return false; footer->number_of_rows = reader.varint(); return true;
+      default: return false;
+    }
+  });
+  return ok && parsed;
+}
+
+bool parse_metadata(uint8_t const* data, size_t size, Metadata* metadata)
+{
+  protobuf_reader reader(data, size);
+  bool ok = true;
+  bool const parsed = reader.fields([&](uint32_t id, int wire_type) {
+    if (1 != id || PB_LENGTH_DELIMITED != wire_type) return false;
+    metadata->stripe_stats.push_back(std::vector<ColumnStatistics>());
+    auto& column_stats = metadata->stripe_stats.back();
+    protobuf_reader stripe_stats = reader.nested();
+    ok &= stripe_stats.fields([&](uint32_t stat_id, int stat_type) {
+      if (1 != stat_id || PB_LENGTH_DELIMITED != stat_type) return false;
+      column_stats.push_back(ColumnStatistics());
+      ok &= read_column_statistics(stripe_stats.nested(), &column_stats.back());
+      return true;
+    });
+    return true;
+  });
+  return ok && parsed;
+}
+
+bool parse_stripe_footer(uint8_t const* data, size_t size, StripeFooter* footer)
+{
+  protobuf_reader reader(data, size);
+  bool ok = true;
+  bool const parsed = reader.fields([&](uint32_t id, int wire_type) {
+    if (PB_LENGTH_DELIMITED != wire_type || (1 != id && 2 != id)) return false;
+    protobuf_reader contents = reader.nested();
+    if (1 == id) {
+      footer->streams.push_back(Stream());
+      Stream& stream = footer->streams.back();
+      ok &= contents.fields([&](uint32_t field, int field_type) {
+        if (PB_VARINT != field_type) return false;
+        switch (field) {
+          case 1: stream.kind = static_cast<int32_t>(contents.varint()); return true;
+          case 2: stream.column = static_cast<uint32_t>(contents.varint()); return true;
+          case 3: stream.length = contents.varint(); return true;
+          default: return false;
+        }
+      });
+    }
+    else {
+      footer->columns.push_back(ColumnEncoding());
+      ColumnEncoding& encoding = footer->columns.back();
+      ok &= contents.fields([&](uint32_t field, int field_type) {
+        if (PB_VARINT != field_type) return false;
+        switch (field) {
+          case 1: encoding.kind = static_cast<int32_t>(contents.varint()); return true;
+          case 2: encoding.dictionary_size = static_cast<uint32_t>(contents.varint()); return true;
+          default: return false;
+        }
+      });
+    }
+    return true;
+  });
+  return ok && parsed;
+}
+
+} // namespace orc
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** ---------------------------------------------------------------------------*
+ * @brief The parts of the ORC file metadata the reader uses, as defined in
+ * https://github.com/apache/orc/blob/master/proto/orc_proto.proto
+ *
+ * The metadata is serialized with Protocol Buffers. Fields the reader does
+ * not use are skipped while parsing.
+ * ---------------------------------------------------------------------------**/
+namespace orc {
+
+enum CompressionKind {
+  NONE = 0,
+  ZLIB = 1,
+  SNAPPY = 2,
+  LZO = 3,
+  LZ4 = 4,
+  ZSTD = 5,
+};
+
+enum TypeKind {
+  BOOLEAN = 0,
+  BYTE = 1,
+  SHORT = 2,
+  INT = 3,
+  LONG = 4,
+  FLOAT = 5,
+  DOUBLE = 6,
+  STRING = 7,
+  BINARY = 8,
+  TIMESTAMP = 9,
+  LIST = 10,
+  MAP = 11,
+  STRUCT = 12,
+  UNION = 13,
+  DECIMAL = 14,
+  DATE = 15,
+  VARCHAR = 16,
+  CHAR = 17,
+};
+
+enum StreamKind {
+  PRESENT = 0,
+  DATA = 1,
+  LENGTH = 2,
+  DICTIONARY_DATA = 3,
+  DICTIONARY_COUNT = 4,
+  SECONDARY = 5,
+  ROW_INDEX = 6,
+  BLOOM_FILTER = 7,
+  BLOOM_FILTER_UTF8 = 8,
+};
+
+enum ColumnEncodingKind {
+  DIRECT = 0,
+  DICTIONARY = 1,
+  DIRECT_V2 = 2,
+  DICTIONARY_V2 = 3,
+};
+
+struct PostScript {
+  uint64_t footer_length = 0;
+  int32_t compression = NONE;
+  uint64_t compression_block_size = 256 * 1024;
+  uint64_t metadata_length = 0;
+  std::string magic;
+};
+
+struct StripeInformation {
+  uint64_t offset = 0;
+  uint64_t index_length = 0;
+  uint64_t data_length = 0;
+  uint64_t footer_length = 0;
+  uint64_t number_of_rows = 0;
+};
+
+struct Type {
+  int32_t kind = -1;
+  std::vector<uint32_t> subtypes;
+  std::vector<std::string> field_names;
+};
+
+struct FileFooter {
+  std::vector<StripeInformation> stripes;
+  std::vector<Type> types;
+  uint64_t number_of_rows = 0;
+};
+
+/**
+ * @brief The minimum and maximum of a column, of the integer, floating point
+ * or date statistics the column type has
+ */
+struct ColumnStatistics {
+  bool has_int = false;
+  int64_t int_min = 0;
+  int64_t int_max = 0;
+  bool has_double = false;
+  double double_min = 0;
+  double double_max = 0;
+  bool has_date = false;
+  int32_t date_min = 0;
+  int32_t date_max = 0;
+};
+
+/**
+ * @brief The statistics of every column of every stripe
+ */
+struct Metadata {
+  std::vector<std::vector<ColumnStatistics>> stripe_stats;
+};
+
+struct Stream {
+  int32_t kind = -1;
+  uint32_t column = 0;
+  uint64_t length = 0;
+};
+
+struct ColumnEncoding {
+  int32_t kind = DIRECT;
+  uint32_t dictionary_size = 0;
+};
+
+struct StripeFooter {
+  std::vector<Stream> streams;
+  std::vector<ColumnEncoding> columns;
+};
+
+/**
+ * @brief Parses the PostScript at the end of an ORC file, which is never
+ * compressed
+ *
+ * @returns false if the PostScript is malformed
+ */
+bool parse_postscript(uint8_t const* data, size_t size, PostScript* postscript);
+
+/**
+ * @brief Parses the uncompressed Footer
+ *
+ * @returns false if the Footer is malformed
+ */
+bool parse_footer(uint8_t const* data, size_t size, FileFooter* footer);
+
+/**
+ * @brief Parses the uncompressed Metadata
+ *
+ * @returns false if the Metadata is malformed
+ */
+bool parse_metadata(uint8_t const* data, size_t size, Metadata* metadata);
+
+/**
+ * @brief Parses the uncompressed footer of a stripe
+ *
+ * @returns false if the footer is malformed
+ */
+bool parse_stripe_footer(uint8_t const* data, size_t size, StripeFooter* footer);
+
+} // namespace orc
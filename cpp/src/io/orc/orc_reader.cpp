@@ -0,0 +1,757 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Reads the columns of an ORC file into gdf_columns
+ *
+ * The file tail and the stripe footers are parsed first. The streams of every
+ * selected column of every stripe that is not pruned by its statistics are
+ * then decompressed and decoded by a pool of host threads, straight into
+ * host buffers laid out as the output columns, which are copied to the device
+ * once.
+ *
+ * @file orc_reader.cpp
+ * ---------------------------------------------------------------------------**/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <NVStrings.h>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "utilities/allocator.hpp"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "io/comp/io_uncomp.h"
+#include "io/utilities/source_file.h"
+
+#include "orc_metadata.h"
+#include "orc_streams.h"
+
+namespace { // unnamed namespace
+
+  using string_pair = std::pair<const char*, size_t>;
+
+  constexpr char file_magic[] = "ORC";
+  constexpr size_t file_magic_size{3};
+  constexpr size_t max_postscript_size{255};
+  constexpr int64_t timestamp_epoch_seconds{1420070400};  // 2015-01-01 00:00:00 UTC
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Uncompresses a stream or a part of the file tail, made of blocks
+   * that each start with a 3 byte header
+   *
+   * @param[in] data The compressed stream
+   * @param[in] size The size of the compressed stream
+   * @param[in] compression The compression kind of the file
+   * @param[in] block_size The maximum uncompressed size of a block
+   * @param[out] output The uncompressed stream
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error uncompress(uint8_t const* data, size_t size, int compression, size_t block_size,
+                       std::vector<uint8_t>* output)
+  {
+    output->clear();
+    if (orc::NONE == compression) {
+      output->assign(data, data + size);
+      return GDF_SUCCESS;
+    }
+
+    int stream_type;
+    switch (compression) {
+      case orc::ZLIB:   stream_type = IO_UNCOMP_STREAM_TYPE_INFLATE; break;
+      case orc::SNAPPY: stream_type = IO_UNCOMP_STREAM_TYPE_SNAPPY; break;
+      default:          return GDF_NOTIMPLEMENTED_ERROR;
+    }
+
+    size_t pos = 0;
+    while (pos < size) {
+      GDF_REQUIRE(size - pos >= 3, GDF_FILE_ERROR);
+      uint32_t const header = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16);
+      pos += 3;
+      size_t const length = header >> 1;
+      bool const is_original = (header & 1);
+      GDF_REQUIRE(length <= size - pos, GDF_FILE_ERROR);
+
+      if (is_original) {
+        output->insert(output->end(), data + pos, data + pos + length);
+      }
+      else {
+        size_t const offset = output->size();
+        size_t uncompressed_size = block_size;
+        output->resize(offset + block_size);
+        gdf_error const status = io_uncompress_block(data + pos, length, stream_type,
+                                                     output->data() + offset, &uncompressed_size);
+        GDF_REQUIRE(GDF_SUCCESS == status, GDF_FILE_ERROR);
+        output->resize(offset + uncompressed_size);
+      }
+      pos += length;
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The output column an ORC column is read into
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct column_desc
+  {
+    uint32_t id;            // Index of the column in the types
+    std::string name;
+    int kind;
+    gdf_dtype dtype;
+    gdf_time_unit time_unit;
+    int width;              // Bytes per output value, 0 for strings
+  };
+
+  gdf_error describe_column(orc::Type const& type, column_desc* desc)
+  {
+    desc->kind = type.kind;
+    desc->time_unit = TIME_UNIT_NONE;
+    switch (type.kind) {
+      case orc::BOOLEAN:
+      case orc::BYTE:      desc->dtype = GDF_INT8; desc->width = 1; break;
+      case orc::SHORT:     desc->dtype = GDF_INT16; desc->width = 2; break;
+      case orc::INT:       desc->dtype = GDF_INT32; desc->width = 4; break;
+      case orc::LONG:      desc->dtype = GDF_INT64; desc->width = 8; break;
+      case orc::FLOAT:     desc->dtype = GDF_FLOAT32; desc->width = 4; break;
+      case orc::DOUBLE:    desc->dtype = GDF_FLOAT64; desc->width = 8; break;
+      case orc::DATE:      desc->dtype = GDF_DATE32; desc->width = 4; break;
+      case orc::TIMESTAMP: desc->dtype = GDF_TIMESTAMP; desc->time_unit = TIME_UNIT_ms; desc->width = 8; break;
+      case orc::STRING:
+      case orc::BINARY:
+      case orc::VARCHAR:
+      case orc::CHAR:      desc->dtype = GDF_STRING; desc->width = 0; break;
+      case orc::LIST:
+      case orc::MAP:
+      case orc::STRUCT:
+      case orc::UNION:     return GDF_NOTIMPLEMENTED_ERROR;
+      default:             return GDF_UNSUPPORTED_DTYPE;
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Whether a column of a stripe may hold values matching the filter
+   *
+   * Columns without usable statistics are always read.
+   */
+  /* ----------------------------------------------------------------------------*/
+  bool may_match(orc::ColumnStatistics const& stats, gdf_stats_filter_op op, double value)
+  {
+    double min, max;
+    if (stats.has_int) {
+      min = static_cast<double>(stats.int_min);
+      max = static_cast<double>(stats.int_max);
+    }
+    else if (stats.has_double) {
+      min = stats.double_min;
+      max = stats.double_max;
+    }
+    else if (stats.has_date) {
+      min = stats.date_min;
+      max = stats.date_max;
+    }
+    else {
+      return true;
+    }
+    if (std::isnan(min) || std::isnan(max)) {
+      return true;
+    }
+
+    switch (op) {
+      case STATS_FILTER_EQUAL:         return min <= value && value <= max;
+      case STATS_FILTER_LESS:          return min < value;
+      case STATS_FILTER_LESS_EQUAL:    return min <= value;
+      case STATS_FILTER_GREATER:       return max > value;
+      case STATS_FILTER_GREATER_EQUAL: return max >= value;
+      default:                         return true;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A stripe to read, with the location of each stream in the file
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct stripe_desc
+  {
+    gdf_size_type row_offset;
+    gdf_size_type num_rows;
+    std::vector<orc::Stream> streams;
+    std::vector<uint64_t> stream_offsets;
+    std::vector<orc::ColumnEncoding> encodings;
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A selected column of the whole file, decoded into host memory
+   *
+   * Strings are kept as the characters of each stripe, with the offset of each
+   * row into the characters of its stripe.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct host_column
+  {
+    std::vector<uint8_t> values;
+    std::vector<uint8_t> valid;             // One byte per row
+    std::vector<std::vector<char>> chars;   // Per stripe
+    std::vector<int64_t> offsets;
+    std::vector<int32_t> lengths;
+    std::vector<uint8_t> has_nulls;         // Per stripe
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Reads and uncompresses a stream of a column
+   *
+   * @returns GDF_SUCCESS with an empty output if the stripe has no such stream
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error read_stream(source_file const& file, orc::PostScript const& postscript,
+                        stripe_desc const& stripe, uint32_t column, int kind,
+                        std::vector<uint8_t>* output, bool* found)
+  {
+    output->clear();
+    *found = false;
+    for (size_t i = 0; i < stripe.streams.size(); ++i) {
+      orc::Stream const& stream = stripe.streams[i];
+      if (stream.column == column && stream.kind == kind) {
+        *found = true;
+        return uncompress(file.data() + stripe.stream_offsets[i], stream.length,
+                          postscript.compression, postscript.compression_block_size, output);
+      }
+    }
+    return GDF_SUCCESS;
+  }
+
+  template <typename T>
+  void store(uint8_t* output, size_t row, T value)
+  {
+    memcpy(output + row * sizeof(T), &value, sizeof(T));
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Decodes a column of a stripe into its rows of the host column
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error decode_column(source_file const& file, orc::PostScript const& postscript,
+                          stripe_desc const& stripe, size_t stripe_index,
+                          column_desc const& desc, host_column* output)
+  {
+    size_t const num_rows = stripe.num_rows;
+    GDF_REQUIRE(desc.id < stripe.encodings.size(), GDF_FILE_ERROR);
+    orc::ColumnEncoding const& encoding = stripe.encodings[desc.id];
+    bool const is_v2 = (orc::DIRECT_V2 == encoding.kind || orc::DICTIONARY_V2 == encoding.kind);
+    bool const is_dictionary = (orc::DICTIONARY == encoding.kind || orc::DICTIONARY_V2 == encoding.kind);
+
+    std::vector<uint8_t> present, data, secondary;
+    bool found{false};
+    gdf_error status = read_stream(file, postscript, stripe, desc.id, orc::PRESENT, &present, &found);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    uint8_t* const valid = output->valid.data() + stripe.row_offset;
+    if (found) {
+      GDF_REQUIRE(orc::decode_booleans(present.data(), present.size(), num_rows, valid), GDF_FILE_ERROR);
+    }
+    else {
+      std::fill(valid, valid + num_rows, 1);
+    }
+    size_t const num_valid = std::count(valid, valid + num_rows, 1);
+    output->has_nulls[stripe_index] = (num_valid != num_rows);
+
+    status = read_stream(file, postscript, stripe, desc.id, orc::DATA, &data, &found);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    GDF_REQUIRE(found || 0 == num_valid, GDF_FILE_ERROR);
+
+    if (GDF_STRING == desc.dtype) {
+      std::vector<int64_t> lengths, indices;
+      std::vector<uint8_t> length_stream;
+      status = read_stream(file, postscript, stripe, desc.id, orc::LENGTH, &length_stream, &found);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+      std::vector<char>& chars = output->chars[stripe_index];
+      std::vector<int64_t> starts;
+      if (is_dictionary) {
+        status = read_stream(file, postscript, stripe, desc.id, orc::DICTIONARY_DATA, &secondary, &found);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        indices.resize(num_valid);
+        lengths.resize(encoding.dictionary_size);
+        GDF_REQUIRE(orc::decode_int_rle(data.data(), data.size(), is_v2, false, num_valid, indices.data()) &&
+                    orc::decode_int_rle(length_stream.data(), length_stream.size(), is_v2, false,
+                                        lengths.size(), lengths.data()), GDF_FILE_ERROR);
+        chars.assign(secondary.begin(), secondary.end());
+      }
+      else {
+        lengths.resize(num_valid);
+        GDF_REQUIRE(orc::decode_int_rle(length_stream.data(), length_stream.size(), is_v2, false,
+                                        num_valid, lengths.data()), GDF_FILE_ERROR);
+        chars.assign(data.begin(), data.end());
+      }
+
+      // The start of each string, in the dictionary or in the stripe
+      starts.resize(lengths.size());
+      int64_t start{0};
+      for (size_t i = 0; i < lengths.size(); ++i) {
+        GDF_REQUIRE(lengths[i] >= 0 && lengths[i] <= std::numeric_limits<int32_t>::max(), GDF_FILE_ERROR);
+        starts[i] = start;
+        start += lengths[i];
+      }
+      GDF_REQUIRE(start <= static_cast<int64_t>(chars.size()), GDF_FILE_ERROR);
+
+      size_t k{0};
+      for (size_t row = 0; row < num_rows; ++row) {
+        size_t const r = stripe.row_offset + row;
+        if (!valid[row]) {
+          output->offsets[r] = 0;
+          output->lengths[r] = -1;
+          continue;
+        }
+        int64_t const i = is_dictionary ? indices[k] : static_cast<int64_t>(k);
+        GDF_REQUIRE(i >= 0 && i < static_cast<int64_t>(lengths.size()), GDF_FILE_ERROR);
+        output->offsets[r] = starts[i];
+        output->lengths[r] = static_cast<int32_t>(lengths[i]);
+        ++k;
+      }
+      return GDF_SUCCESS;
+    }
+
+    // Decode the values of the valid rows, then spread them over the rows
+    std::vector<int64_t> values(num_valid);
+    switch (desc.kind) {
+      case orc::BOOLEAN:
+      case orc::BYTE: {
+        std::vector<uint8_t> bytes(num_valid);
+        bool const ok = (orc::BOOLEAN == desc.kind)
+                      ? orc::decode_booleans(data.data(), data.size(), num_valid, bytes.data())
+                      : orc::decode_byte_rle(data.data(), data.size(), num_valid, bytes.data());
+        GDF_REQUIRE(ok, GDF_FILE_ERROR);
+        std::transform(bytes.begin(), bytes.end(), values.begin(),
+                       [](uint8_t b) { return static_cast<int8_t>(b); });
+        break;
+      }
+      case orc::FLOAT:
+      case orc::DOUBLE:
+        GDF_REQUIRE(data.size() >= num_valid * desc.width, GDF_FILE_ERROR);
+        break;
+      case orc::TIMESTAMP: {
+        std::vector<int64_t> nanos(num_valid);
+        status = read_stream(file, postscript, stripe, desc.id, orc::SECONDARY, &secondary, &found);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        GDF_REQUIRE(orc::decode_int_rle(data.data(), data.size(), is_v2, true, num_valid, values.data()) &&
+                    orc::decode_int_rle(secondary.data(), secondary.size(), is_v2, false, num_valid,
+                                        nanos.data()), GDF_FILE_ERROR);
+        for (size_t i = 0; i < num_valid; ++i) {
+          // The low 3 bits hold the number of trailing decimal zeros, less one
+          int64_t nano = nanos[i] >> 3;
+          int const zeros = nanos[i] & 0x7;
+          for (int z = 0; zeros != 0 && z <= zeros; ++z) {
+            nano *= 10;
+          }
+          int64_t seconds = values[i] + timestamp_epoch_seconds;
+          if (seconds < 0 && nano > 999999) {
+            seconds -= 1;
+          }
+          values[i] = seconds * 1000 + nano / 1000000;
+        }
+        break;
+      }
+      default:
+        GDF_REQUIRE(orc::decode_int_rle(data.data(), data.size(), is_v2, true, num_valid, values.data()),
+                    GDF_FILE_ERROR);
+        break;
+    }
+
+    uint8_t* const out = output->values.data();
+    size_t k{0};
+    for (size_t row = 0; row < num_rows; ++row) {
+      size_t const r = stripe.row_offset + row;
+      if (!valid[row]) {
+        memset(out + r * desc.width, 0, desc.width);
+        continue;
+      }
+      switch (desc.kind) {
+        case orc::FLOAT:
+        case orc::DOUBLE:
+          memcpy(out + r * desc.width, data.data() + k * desc.width, desc.width);
+          break;
+        default:
+          switch (desc.width) {
+            case 1: store<int8_t>(out, r, static_cast<int8_t>(values[k])); break;
+            case 2: store<int16_t>(out, r, static_cast<int16_t>(values[k])); break;
+            case 4: store<int32_t>(out, r, static_cast<int32_t>(values[k])); break;
+            default: store<int64_t>(out, r, values[k]); break;
+          }
+      }
+      ++k;
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Copies a decoded host column into a gdf_column
+   *
+   * The buffers of the column are set as soon as they are allocated, so
+   * free_output can free them if the copy fails.
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error make_column(host_column const& input, column_desc const& desc,
+                        std::vector<stripe_desc> const& stripes, gdf_size_type num_rows,
+                        cudaStream_t stream, gdf_column* column)
+  {
+    column->size = num_rows;
+    column->dtype = desc.dtype;
+    column->dtype_info = gdf_dtype_extra_info{desc.time_unit};
+    column->null_count = 0;
+    column->data = nullptr;
+    column->valid = nullptr;
+    column->col_name = static_cast<char*>(malloc(desc.name.size() + 1));
+    memcpy(column->col_name, desc.name.c_str(), desc.name.size() + 1);
+
+    bool const has_nulls = std::any_of(input.has_nulls.begin(), input.has_nulls.end(),
+                                       [](uint8_t b) { return 0 != b; });
+    if (has_nulls) {
+      std::vector<gdf_valid_type> valid(gdf_get_num_chars_bitmask(num_rows), 0);
+      for (gdf_size_type row = 0; row < num_rows; ++row) {
+        if (input.valid[row]) {
+          valid[row / GDF_VALID_BITSIZE] |= gdf_valid_type{1} << (row % GDF_VALID_BITSIZE);
+        } else {
+          ++column->null_count;
+        }
+      }
+      RMM_TRY( RMM_ALLOC(&column->valid, valid.size(), stream) );
+      CUDA_TRY( cudaMemcpyAsync(column->valid, valid.data(), valid.size(), cudaMemcpyHostToDevice, stream) );
+    }
+
+    if (GDF_STRING == desc.dtype) {
+      // Gather the characters of all stripes into one device buffer. The
+      // scratch buffers are freed on every return, NVStrings copies them
+      char* d_chars{nullptr};
+      string_pair* d_pairs{nullptr};
+      auto const gather = [&]() -> gdf_error {
+        std::vector<size_t> bases;
+        size_t total_chars{0};
+        for (auto const& chars : input.chars) {
+          bases.push_back(total_chars);
+          total_chars += chars.size();
+        }
+        if (total_chars > 0) {
+          SCRATCH_ALLOC_TRY(&d_chars, total_chars, stream);
+          for (size_t s = 0; s < input.chars.size(); ++s) {
+            if (!input.chars[s].empty()) {
+              CUDA_TRY( cudaMemcpyAsync(d_chars + bases[s], input.chars[s].data(), input.chars[s].size(),
+                                        cudaMemcpyHostToDevice, stream) );
+            }
+          }
+        }
+
+        std::vector<string_pair> pairs(num_rows);
+        for (size_t s = 0; s < stripes.size(); ++s) {
+          gdf_size_type const end = stripes[s].row_offset + stripes[s].num_rows;
+          for (gdf_size_type row = stripes[s].row_offset; row < end; ++row) {
+            pairs[row] = (input.lengths[row] < 0)
+                       ? string_pair(nullptr, 0)
+                       : string_pair(d_chars + bases[s] + input.offsets[row], input.lengths[row]);
+          }
+        }
+
+        if (num_rows > 0) {
+          SCRATCH_ALLOC_TRY(&d_pairs, sizeof(string_pair) * num_rows, stream);
+          CUDA_TRY( cudaMemcpyAsync(d_pairs, pairs.data(), sizeof(string_pair) * num_rows,
+                                    cudaMemcpyHostToDevice, stream) );
+        }
+        CUDA_TRY( cudaStreamSynchronize(stream) );
+        column->data = NVStrings::create_from_index(d_pairs, num_rows);
+        return GDF_SUCCESS;
+      };
+
+      gdf_error const status = gather();
+      if (nullptr != d_pairs) {
+        cudf::memory::device_allocator().deallocate(d_pairs, stream);
+      }
+      if (nullptr != d_chars) {
+        cudf::memory::device_allocator().deallocate(d_chars, stream);
+      }
+      return status;
+    }
+
+    if (num_rows > 0) {
+      RMM_TRY( RMM_ALLOC(&column->data, input.values.size(), stream) );
+      CUDA_TRY( cudaMemcpyAsync(column->data, input.values.data(), input.values.size(),
+                                cudaMemcpyHostToDevice, stream) );
+    }
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Frees the outputs of a failed read_orc and resets them
+   *
+   * @param[in,out] args The arguments of read_orc
+   * @param[in] stream The stream to free on
+   */
+  /* ----------------------------------------------------------------------------*/
+  void free_output(orc_read_arg* args, cudaStream_t stream)
+  {
+    for (int i = 0; i < args->num_cols_out; ++i) {
+      gdf_column* const column = args->data[i];
+      if (nullptr == column) {
+        continue;
+      }
+      if (nullptr != column->data) {
+        if (GDF_STRING == column->dtype) {
+          NVStrings::destroy(static_cast<NVStrings*>(column->data));
+        } else {
+          RMM_FREE(column->data, stream);
+        }
+      }
+      if (nullptr != column->valid) {
+        RMM_FREE(column->valid, stream);
+      }
+      free(column->col_name);
+      free(column);
+    }
+    free(args->data);
+    args->data = nullptr;
+    args->num_cols_out = 0;
+    args->num_rows_out = 0;
+  }
+
+} // unnamed namespace
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Reads the columns of an ORC file into gdf_columns
+ *
+ * Only the top level columns of primitive types can be read. The stripes
+ * whose statistics show that no value of the filter column can satisfy the
+ * filter are not read. BOOLEAN columns are read into GDF_INT8 columns,
+ * STRING, VARCHAR, CHAR and BINARY columns into GDF_STRING columns and
+ * TIMESTAMP columns into GDF_TIMESTAMP columns of milliseconds, as UTC.
+ *
+ * @param[in,out] args The input file and the output columns, see
+ * orc_read_arg. Nothing stays allocated in it when the read fails.
+ *
+ * @returns GDF_SUCCESS upon successful completion, GDF_FILE_ERROR if the
+ * input is malformed, GDF_UNSUPPORTED_DTYPE for DECIMAL columns and
+ * GDF_NOTIMPLEMENTED_ERROR for nested columns and unsupported compressions
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error read_orc(orc_read_arg *args)
+{
+  GDF_REQUIRE(nullptr != args, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(nullptr != args->filepath_or_buffer, GDF_INVALID_API_CALL);
+
+  cudaStream_t stream{0};
+
+  source_file file;
+  if (FILE_PATH == args->input_data_form) {
+    gdf_error const status = file.open_path(args->filepath_or_buffer);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+  }
+  else if (HOST_BUFFER == args->input_data_form) {
+    file.use_buffer(args->filepath_or_buffer, args->buffer_size);
+  }
+  else {
+    return GDF_INVALID_API_CALL;
+  }
+
+  // The file ends with the metadata, the footer, the PostScript and its size
+  uint8_t const* const data = file.data();
+  size_t const size = file.size();
+  GDF_REQUIRE(size > file_magic_size + 1 && 0 == memcmp(data, file_magic, file_magic_size),
+              GDF_FILE_ERROR);
+  size_t const postscript_size = data[size - 1];
+  GDF_REQUIRE(postscript_size > 0 && postscript_size <= max_postscript_size &&
+              postscript_size < size - file_magic_size, GDF_FILE_ERROR);
+  orc::PostScript postscript;
+  GDF_REQUIRE(orc::parse_postscript(data + size - 1 - postscript_size, postscript_size, &postscript) &&
+              postscript.magic == file_magic, GDF_FILE_ERROR);
+  size_t const tail_size = 1 + postscript_size + postscript.footer_length + postscript.metadata_length;
+  GDF_REQUIRE(postscript.footer_length > 0 && tail_size <= size - file_magic_size &&
+              postscript.compression_block_size > 0, GDF_FILE_ERROR);
+
+  std::vector<uint8_t> buffer;
+  gdf_error status = uncompress(data + size - 1 - postscript_size - postscript.footer_length,
+                                postscript.footer_length, postscript.compression,
+                                postscript.compression_block_size, &buffer);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+  orc::FileFooter footer;
+  GDF_REQUIRE(orc::parse_footer(buffer.data(), buffer.size(), &footer), GDF_FILE_ERROR);
+
+  orc::Metadata metadata;
+  if (postscript.metadata_length > 0) {
+    status = uncompress(data + size - tail_size, postscript.metadata_length, postscript.compression,
+                        postscript.compression_block_size, &buffer);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    GDF_REQUIRE(orc::parse_metadata(buffer.data(), buffer.size(), &metadata), GDF_FILE_ERROR);
+  }
+
+  // The columns are the fields of the root struct
+  GDF_REQUIRE(!footer.types.empty(), GDF_FILE_ERROR);
+  orc::Type const& root = footer.types[0];
+  GDF_REQUIRE(orc::STRUCT == root.kind, GDF_NOTIMPLEMENTED_ERROR);
+  GDF_REQUIRE(root.subtypes.size() == root.field_names.size(), GDF_FILE_ERROR);
+  for (uint32_t id : root.subtypes) {
+    GDF_REQUIRE(id < footer.types.size(), GDF_FILE_ERROR);
+  }
+
+  auto const find_field = [&](const char* name) {
+    for (size_t i = 0; i < root.field_names.size(); ++i) {
+      if (root.field_names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+  };
+
+  // Columns are read in the order of the file
+  std::vector<bool> selected(root.subtypes.size(), nullptr == args->use_cols);
+  if (nullptr != args->use_cols) {
+    for (int i = 0; i < args->num_cols; ++i) {
+      int const field = find_field(args->use_cols[i]);
+      GDF_REQUIRE(field >= 0, GDF_INVALID_API_CALL);
+      selected[field] = true;
+    }
+  }
+  std::vector<column_desc> columns;
+  for (size_t i = 0; i < root.subtypes.size(); ++i) {
+    if (selected[i]) {
+      columns.push_back(column_desc());
+      columns.back().id = root.subtypes[i];
+      columns.back().name = root.field_names[i];
+      status = describe_column(footer.types[root.subtypes[i]], &columns.back());
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+    }
+  }
+
+  // Prune the stripes by the statistics of the filter column, then locate
+  // the streams of the stripes that are read
+  int64_t filter_id{-1};
+  if (nullptr != args->filter_column && STATS_FILTER_NONE != args->filter_op) {
+    int const field = find_field(args->filter_column);
+    GDF_REQUIRE(field >= 0, GDF_INVALID_API_CALL);
+    filter_id = root.subtypes[field];
+  }
+  std::vector<stripe_desc> stripes;
+  int64_t num_rows{0};
+  for (size_t s = 0; s < footer.stripes.size(); ++s) {
+    orc::StripeInformation const& info = footer.stripes[s];
+    if (filter_id >= 0 && s < metadata.stripe_stats.size() &&
+        static_cast<size_t>(filter_id) < metadata.stripe_stats[s].size() &&
+        !may_match(metadata.stripe_stats[s][filter_id], args->filter_op, args->filter_value)) {
+      continue;
+    }
+
+    uint64_t const footer_offset = info.offset + info.index_length + info.data_length;
+    GDF_REQUIRE(info.offset >= file_magic_size && footer_offset >= info.offset &&
+                footer_offset + info.footer_length <= size - tail_size, GDF_FILE_ERROR);
+    status = uncompress(data + footer_offset, info.footer_length, postscript.compression,
+                        postscript.compression_block_size, &buffer);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    orc::StripeFooter stripe_footer;
+    GDF_REQUIRE(orc::parse_stripe_footer(buffer.data(), buffer.size(), &stripe_footer), GDF_FILE_ERROR);
+
+    stripe_desc stripe;
+    stripe.row_offset = static_cast<gdf_size_type>(num_rows);
+    stripe.num_rows = static_cast<gdf_size_type>(info.number_of_rows);
+    stripe.streams = stripe_footer.streams;
+    stripe.encodings = stripe_footer.columns;
+    uint64_t offset = info.offset;
+    for (auto const& s : stripe.streams) {
+      stripe.stream_offsets.push_back(offset);
+      offset += s.length;
+    }
+    GDF_REQUIRE(offset <= footer_offset, GDF_FILE_ERROR);
+    stripes.push_back(std::move(stripe));
+
+    num_rows += info.number_of_rows;
+    GDF_REQUIRE(num_rows <= std::numeric_limits<gdf_size_type>::max(), GDF_COLUMN_SIZE_TOO_BIG);
+  }
+
+  // Decode every column of every stripe on a pool of threads, each into its
+  // own rows of the host columns
+  std::vector<host_column> host_columns(columns.size());
+  for (size_t c = 0; c < columns.size(); ++c) {
+    host_column& column = host_columns[c];
+    column.valid.resize(num_rows);
+    column.has_nulls.resize(stripes.size(), 0);
+    if (GDF_STRING == columns[c].dtype) {
+      column.chars.resize(stripes.size());
+      column.offsets.resize(num_rows);
+      column.lengths.resize(num_rows);
+    } else {
+      column.values.resize(num_rows * columns[c].width);
+    }
+  }
+
+  size_t const num_tasks = stripes.size() * columns.size();
+  std::atomic<size_t> next_task{0};
+  std::vector<gdf_error> task_status(num_tasks, GDF_SUCCESS);
+  auto const worker = [&]() {
+    for (size_t task = next_task++; task < num_tasks; task = next_task++) {
+      size_t const s = task / columns.size();
+      size_t const c = task % columns.size();
+      task_status[task] = decode_column(file, postscript, stripes[s], s, columns[c], &host_columns[c]);
+    }
+  };
+  size_t const num_threads =
+    std::max(size_t{1}, std::min(static_cast<size_t>(std::thread::hardware_concurrency()), num_tasks));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads)
+    thread.join();
+  for (gdf_error task : task_status) {
+    GDF_REQUIRE(GDF_SUCCESS == task, task);
+  }
+
+  int const num_cols = static_cast<int>(columns.size());
+  gdf_column** output = static_cast<gdf_column**>(malloc(sizeof(gdf_column*) * num_cols));
+  args->data = output;
+  args->num_cols_out = num_cols;
+  args->num_rows_out = static_cast<gdf_size_type>(num_rows);
+  args->num_stripes_skipped = static_cast<int>(footer.stripes.size() - stripes.size());
+  for (int i = 0; i < num_cols; ++i) {
+    output[i] = nullptr;
+  }
+
+  for (int i = 0; i < num_cols; ++i) {
+    output[i] = static_cast<gdf_column*>(malloc(sizeof(gdf_column)));
+    status = make_column(host_columns[i], columns[i], stripes, static_cast<gdf_size_type>(num_rows),
+                         stream, output[i]);
+    if (GDF_SUCCESS != status) {
+      free_output(args, stream);
+      return status;
+    }
+  }
+
+  return GDF_SUCCESS;
+}
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "orc_streams.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace orc {
+
+namespace {
+
+// The sub-encodings of run length encoding version 2
+enum {
+  SHORT_REPEAT = 0,
+  DIRECT = 1,
+  PATCHED_BASE = 2,
+  DELTA = 3,
+};
+
+/**
+ * @brief Reads bytes, varints and big endian bit-packed values, any read past
+ * the end of the stream fails the reader
+ */
+class stream_reader {
+ public:
+  stream_reader(uint8_t const* data, size_t size)
+    : _data(data), _size(size), _pos(0), _failed(false)
+  { }
+
+  bool failed() const { return _failed; }
+
+  uint8_t byte()
+  {
+    if (_pos >= _size) {
+      _failed = true;
+      return 0;
+    }
+    return _data[_pos++];
+  }
+
+  uint64_t varint()
+  {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t const b = byte();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80) || _failed) {
+        return v;
+      }
+    }
+    _failed = true;
+    return 0;
+  }
+
+  int64_t zigzag() { return unzigzag(varint()); }
+
+  uint64_t big_endian(int num_bytes)
+  {
+    uint64_t v = 0;
+    for (int i = 0; i < num_bytes; ++i) {
+      v = (v << 8) | byte();
+    }
+    return v;
+  }
+
+  /**
+   * @brief Reads count values of width bits packed from the most significant
+   * bit, starting at the next byte and leaving the rest of the last byte
+   */
+  void unpack(size_t count, int width, std::vector<uint64_t>* values)
+  {
+    values->resize(count);
+    uint64_t const total_bits = static_cast<uint64_t>(count) * width;
+    if ((total_bits + 7) / 8 > _size - std::min(_pos, _size)) {
+      _failed = true;
+      std::fill(values->begin(), values->end(), 0);
+      return;
+    }
+    uint64_t bit = static_cast<uint64_t>(_pos) * 8;
+    for (size_t i = 0; i < count; ++i) {
+      uint64_t v = 0;
+      for (int remaining = width; remaining > 0;) {
+        uint8_t const b = _data[bit / 8];
+        int const available = 8 - static_cast<int>(bit % 8);
+        int const take = std::min(available, remaining);
+        v = (v << take) | ((b >> (available - take)) & ((1u << take) - 1));
+        remaining -= take;
+        bit += take;
+      }
+      (*values)[i] = v;
+    }
+    _pos += (total_bits + 7) / 8;
+  }
+
+  static int64_t unzigzag(uint64_t v)
+  {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+
+ private:
+  uint8_t const* _data;
+  size_t _size;
+  size_t _pos;
+  bool _failed;
+};
+
+// The bit widths of the 5-bit width codes
+int decode_bit_width(int code)
+{
+  static int const widths[] = {1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11, 12, 13, 14, 15, 16,
+                               17, 18, 19, 20, 21, 22, 23, 24, 26, 28, 30, 32, 40, 48, 56, 64};
+  return widths[code & 0x1f];
+}
+
+// The smallest bit width of the 5-bit width codes that holds width bits
+int closest_fixed_bits(int width)
+{
+  for (int code = 0; code < 32; ++code) {
+    if (decode_bit_width(code) >= width) {
+      return decode_bit_width(code);
+    }
+  }
+  return 64;
+}
+
+/**
+ * @brief Decodes the runs of run length encoding version 1
+ */
+bool decode_rle_v1(stream_reader& reader, bool is_signed, size_t count, int64_t* output)
+{
+  size_t n = 0;
+  while (n < count && !reader.failed()) {
+    uint8_t const header = reader.byte();
+    if (header < 0x80) {
+      size_t const run = header + 3;
+      int64_t const delta = static_cast<int8_t>(reader.byte());
+      int64_t const base = is_signed ? reader.zigzag() : static_cast<int64_t>(reader.varint());
+      for (size_t i = 0; i < run && n < count; ++i) {
+        output[n++] = base + static_cast<int64_t>(i) * delta;
+      }
+    }
+    else {
+      size_t const run = 0x100 - header;
+      for (size_t i = 0; i < run && n < count; ++i) {
+        output[n++] = is_signed ? reader.zigzag() : static_cast<int64_t>(reader.varint());
+      }
+    }
+  }
+  return n == count && !reader.failed();
+}
+
+/**
+ * @brief Decodes the runs of run length encoding version 2
+ */
+bool decode_rle_v2(stream_reader& reader, bool is_signed, size_t count, int64_t* output)
+{
+  std::vector<uint64_t> values;
+  std::vector<uint64_t> patches;
+  size_t n = 0;
+  auto const emit = [&](int64_t v) {
+    if (n < count) {
+      output[n++] = v;
+    }
+  };
+
+  while (n < count && !reader.failed()) {
+    uint8_t const header = reader.byte();
+    int const encoding = header >> 6;
+
+    if (SHORT_REPEAT == encoding) {
+      int const num_bytes = ((header >> 3) & 0x7) + 1;
+      size_t const run = (header & 0x7) + 3;
+      uint64_t const v = reader.big_endian(num_bytes);
+      int64_t const value = is_signed ? stream_reader::unzigzag(v) : static_cast<int64_t>(v);
+      for (size_t i = 0; i < run; ++i) {
+        emit(value);
+      }
+      continue;
+    }
+
+    int const width_code = (header >> 1) & 0x1f;
+    size_t const length = ((static_cast<size_t>(header & 1) << 8) | reader.byte()) + 1;
+
+    if (DIRECT == encoding) {
+      reader.unpack(length, decode_bit_width(width_code), &values);
+      for (uint64_t v : values) {
+        emit(is_signed ? stream_reader::unzigzag(v) : static_cast<int64_t>(v));
+      }
+    }
+    else if (PATCHED_BASE == encoding) {
+      int const width = decode_bit_width(width_code);
+      uint8_t const third = reader.byte();
+      int const base_bytes = ((third >> 5) & 0x7) + 1;
+      int const patch_width = decode_bit_width(third & 0x1f);
+      uint8_t const fourth = reader.byte();
+      int const gap_width = ((fourth >> 5) & 0x7) + 1;
+      size_t const num_patches = fourth & 0x1f;
+
+      // The base is stored in sign-magnitude form
+      uint64_t const base_bits = reader.big_endian(base_bytes);
+      uint64_t const sign = uint64_t{1} << (base_bytes * 8 - 1);
+      int64_t const base = (base_bits & sign) ? -static_cast<int64_t>(base_bits & ~sign)
+                                              : static_cast<int64_t>(base_bits);
+
+      reader.unpack(length, width, &values);
+      reader.unpack(num_patches, closest_fixed_bits(patch_width + gap_width), &patches);
+      if (reader.failed() || patch_width + width > 64) {
+        return false;
+      }
+
+      // Each patch holds the gap from the previous patched value and the high
+      // bits of the value, gaps over 255 are split into patches of no bits
+      uint64_t const patch_mask = (patch_width < 64) ? (uint64_t{1} << patch_width) - 1 : ~uint64_t{0};
+      size_t position = 0;
+      for (size_t p = 0; p < num_patches; ++p) {
+        position += patches[p] >> patch_width;
+        uint64_t const patch = patches[p] & patch_mask;
+        if (0 == patch) {
+          continue;
+        }
+        if (position >= length) {
+          return false;
+        }
+        values[position] |= patch << width;
+      }
+      for (uint64_t v : values) {
+        emit(base + static_cast<int64_t>(v));
+      }
+    }
+    else {
+      int const width = (0 != width_code) ? decode_bit_width(width_code) : 0;
+      int64_t value = is_signed ? reader.zigzag() : static_cast<int64_t>(reader.varint());
+      int64_t const delta = reader.zigzag();
+      emit(value);
+      if (length > 1) {
+        value += delta;
+        emit(value);
+      }
+      if (length > 2) {
+        if (0 == width) {
+          for (size_t i = 2; i < length; ++i) {
+            value += delta;
+            emit(value);
+          }
+        }
+        else {
+          // The deltas all have the sign of the first one
+          reader.unpack(length - 2, width, &values);
+          for (uint64_t v : values) {
+            value += (delta < 0) ? -static_cast<int64_t>(v) : static_cast<int64_t>(v);
+            emit(value);
+          }
+        }
+      }
+    }
+  }
+  return n == count && !reader.failed();
+}
+
+} // unnamed namespace
+
+bool decode_byte_rle(uint8_t const* data, size_t size, size_t count, uint8_t* output)
+{
+  stream_reader reader(data, size);
+  size_t n = 0;
+  while (n < count && !reader.failed()) {
+    uint8_t const header = reader.byte();
+    if (header < 0x80) {
+      size_t const run = header + 3;
+      uint8_t const value = reader.byte();
+      for (size_t i = 0; i < run && n < count; ++i) {
+        output[n++] = value;
+      }
+    }
+    else {
+      size_t const run = 0x100 - header;
+      for (size_t i = 0; i < run && n < count; ++i) {
+        output[n++] = reader.byte();
+      }
+    }
+  }
+  return n == count && !reader.failed();
+}
+
+bool decode_booleans(uint8_t const* data, size_t size, size_t count, uint8_t* output)
+{
+  std::vector<uint8_t> bytes((count + 7) / 8);
+  if (!decode_byte_rle(data, size, bytes.size(), bytes.data())) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    output[i] = (bytes[i / 8] >> (7 - i % 8)) & 1;
+  }
+  return true;
+}
+
+bool decode_int_rle(uint8_t const* data, size_t size, bool is_v2, bool is_signed,
+                    size_t count, int64_t* output)
+{
+  stream_reader reader(data, size);
+  return is_v2 ? decode_rle_v2(reader, is_signed, count, output)
+               : decode_rle_v1(reader, is_signed, count, output);
+}
+
+} // namespace orc
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** ---------------------------------------------------------------------------*
+ * @brief Decoders of the run length encodings of ORC streams, as described in
+ * https://orc.apache.org/specification/ORCv1/
+ *
+ * Every decoder reads exactly count values from an uncompressed stream, and
+ * fails if the stream is malformed or holds fewer values.
+ * ---------------------------------------------------------------------------**/
+namespace orc {
+
+/**
+ * @brief Decodes a byte run length encoded stream
+ */
+bool decode_byte_rle(uint8_t const* data, size_t size, size_t count, uint8_t* output);
+
+/**
+ * @brief Decodes a boolean stream, a byte run length encoded stream of bits
+ * from the most significant one, into one 0 or 1 byte per value
+ */
+bool decode_booleans(uint8_t const* data, size_t size, size_t count, uint8_t* output);
+
+/**
+ * @brief Decodes an integer stream of run length encoding version 1 or 2
+ *
+ * @param[in] is_v2 Whether the column encoding is DIRECT_V2 or DICTIONARY_V2
+ * @param[in] is_signed Whether the values are zigzag encoded
+ */
+bool decode_int_rle(uint8_t const* data, size_t size, bool is_v2, bool is_signed,
+                    size_t count, int64_t* output);
+
+} // namespace orc
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "parquet_metadata.h"
+
+namespace parquet {
+
+namespace {
+
+// The field types of the Thrift compact protocol
+enum {
+  ST_STOP = 0,
+  ST_TRUE = 1,
+  ST_FALSE = 2,
+  ST_BYTE = 3,
+  ST_I16 = 4,
+  ST_I32 = 5,
+  ST_I64 = 6,
+  ST_DOUBLE = 7,
+  ST_BINARY = 8,
+  ST_LIST = 9,
+  ST_SET = 10,
+  ST_MAP = 11,
+  ST_STRUCT = 12,
+};
+
+// Nesting deeper than this is malformed for Parquet metadata
+constexpr int max_depth{16};
+
+/**
+ * @brief Reads values of the Thrift compact protocol, any read past the end
+ * of the data fails the reader
+ */
+class compact_reader {
+ public:
+  compact_reader(uint8_t const* data, size_t size)
+    : _cur(data), _end(data + size), _failed(false)
+  { }
+
+  bool failed() const { return _failed; }
+  size_t consumed(uint8_t const* begin) const { return _cur - begin; }
+
+  uint8_t byte()
+  {
+    if (_cur >= _end) {
+      _failed = true;
+      return 0;
+    }
+    return *_cur++;
+  }
+
+  uint64_t varint()
+  {
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t const b = byte();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) {
+        return v;
+      }
+    }
+    _failed = true;
+    return 0;
+  }
+
+  int64_t zigzag()
+  {
+    uint64_t const v = varint();
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+
+  int32_t i32() { return static_cast<int32_t>(zigzag()); }
+  int64_t i64() { return zigzag(); }
+
+  std::string binary()
+  {
+    uint64_t const length = varint();
+    if (_failed || length > static_cast<uint64_t>(_end - _cur)) {
+      _failed = true;
+      return std::string();
+    }
+    std::string s(reinterpret_cast<char const*>(_cur), length);
+    _cur += length;
+    return s;
+  }
+
+  /**
+   * @brief Reads a list header, returns the number of elements
+   */
+  uint32_t list_header(int* element_type)
+  {
+    uint8_t const header = byte();
+    *element_type = header & 0xf;
+    uint32_t size = header >> 4;
+    if (15 == size) {
+      size = static_cast<uint32_t>(varint());
+    }
+    return size;
+  }
+
+  /**
+   * @brief Reads the fields of a struct up to its stop field
+   *
+   * For every field, read(id, type) either reads it and returns true, or
+   * returns false to have it skipped.
+   */
+  template <typename F>
+  bool fields(F&& read, int depth = 0)
+  {
+    int16_t id = 0;
+    while (!_failed) {
+      uint8_t const header = byte();
+      int const type = header & 0xf;
+      if (ST_STOP == type) {
+        break;
+      }
+      int const delta = header >> 4;
+      id = (0 != delta) ? static_cast<int16_t>(id + delta) : static_cast<int16_t>(zigzag());
+      if (!read(id, type)) {
+        skip(type, depth);
+      }
+    }
+    return !_failed;
+  }
+
+  void skip(int type, int depth)
+  {
+    if (depth > max_depth) {
+      _failed = true;
+      return;
+    }
+    switch (type) {
+      case ST_TRUE:
+      case ST_FALSE:
+        break;
+      case ST_BYTE:
+        byte();
+        break;
+      case ST_I16:
+      case ST_I32:
+      case ST_I64:
+        varint();
+        break;
+      case ST_DOUBLE:
+        for (int i = 0; i < 8; ++i) byte();
+        break;
+      case ST_BINARY:
+        binary();
+        break;
+      case ST_LIST:
+      case ST_SET: {
+        int element_type;
+        uint32_t const size = list_header(&element_type);
+        for (uint32_t i = 0; i < size && !_failed; ++i) {
+          // Booleans in lists take a byte each
+          if (ST_TRUE == element_type || ST_FALSE == element_type) {
+            byte();
+          } else {
+            skip(element_type, depth + 1);
+          }
+        }
+        break;
+      }
+      case ST_MAP: {
+        uint32_t const size = static_cast<uint32_t>(varint());
+        if (size > 0) {
+          uint8_t const types = byte();
+          for (uint32_t i = 0; i < size && !_failed; ++i) {
+            skip(types >> 4, depth + 1);
+            skip(types & 0xf, depth + 1);
+          }
+        }
+        break;
+      }
+      case ST_STRUCT:
+        fields([](int16_t, int) { return false; }, depth + 1);
+        break;
+      default:
+        _failed = true;
+    }
+  }
+
+  /**
+   * @brief Reads a list of structs, calling read_element to read each one
+   */
+  template <typename F>
+  bool struct_list(int type, F&& read_element)
+  {
+    if (ST_LIST != type) {
+      return false;
+    }
+    int element_type;
+    uint32_t const size = list_header(&element_type);
+    if (ST_STRUCT != element_type) {
+      _failed = true;
+      return true;
+    }
+    for (uint32_t i = 0; i < size && !_failed; ++i) {
+      read_element();
+    }
+    return true;
+  }
+
+ private:
+  uint8_t const* _cur;
+  uint8_t const* _end;
+  bool _failed;
+};
+
+bool read_statistics(compact_reader& reader, Statistics* stats)
+{
+  return reader.fields([&](int16_t id, int type) {
+    switch (id) {
+      case 1: if (ST_BINARY != type) return false; stats->max = reader.binary(); stats->has_max = true; return true;
+      case 2: if (ST_BINARY != type) return false; stats->min = reader.binary(); stats->has_min = true; return true;
+      case 3: if (ST_I64 != type) return false; stats->null_count = reader.i64(); return true;
+      case 5: if (ST_BINARY != type) return false; stats->max_value = reader.binary(); stats->has_max_value = true; return true;
+      case 6: if (ST_BINARY != type) return false; stats->min_value = reader.binary(); stats->has_min_value = true; return true;
+      default: return false;
+    }
+  });
+}
+
+bool read_column_metadata(compact_reader& reader, ColumnChunk* chunk)
+{
+  return reader.fields([&](int16_t id, int type) {
+    switch (id) {
+      case 1: if (ST_I32 != type) return false; chunk->type = reader.i32(); return true;
+      case 3: {
+        if (ST_LIST != type) return false;
+        int element_type;
+        uint32_t const size = reader.list_header(&element_type);
+        for (uint32_t i = 0; i < size && !reader.failed(); ++i) {
+          chunk->path_in_schema.push_back(reader.binary());
+        }
+        return true;
+      }
+      case 4: if (ST_I32 != type) return false; chunk->codec = reader.i32(); return true;
+      case 5: if (ST_I64 != type) return false; chunk->num_values = reader.i64(); return true;
+      case 7: if (ST_I64 != type) return false; chunk->total_compressed_size = reader.i64(); return true;
+      case 9: if (ST_I64 != type) return false; chunk->data_page_offset = reader.i64(); return true;
+      case 11: if (ST_I64 != type) return false; chunk->dictionary_page_offset = reader.i64(); return true;
+      case 12: if (ST_STRUCT != type) return false; read_statistics(reader, &chunk->statistics); return true;
+      default: return false;
+    }
+  });
+}
+
+bool read_column_chunk(compact_reader& reader, ColumnChunk* chunk)
+{
+  return reader.fields([&](int16_t id, int type) {
+    if (3 == id && ST_STRUCT == type) {
+      read_column_metadata(reader, chunk);
+      return true;
+    }
+    return false;
+  });
+}
+
+bool read_row_group(compact_reader& reader, RowGroup* row_group)
+{
+  return reader.fields([&](int16_t id, int type) {
+    switch (id) {
+      case 1:
+        return reader.struct_list(type, [&]() {
+          row_group->columns.push_back(ColumnChunk());
+          read_column_chunk(reader, &row_group->columns.back());
+        });
+      case 3: if (ST_I64 != type) return false; row_group->num_rows = reader.i64(); return true;
+      default: return false;
+    }
+  });
+}
+
+bool read_schema_element(compact_reader& reader, SchemaElement* element)
+{
+  return reader.fields([&](int16_t id, int type) {
+    switch (id) {
+      case 1: if (ST_I32 != type) return false; element->type = reader.i32(); return true;
+      case 2: if (ST_I32 != type) return false; element->type_length = reader.i32(); return true;
+      case 3: if (ST_I32 != type) return false; element->repetition_type = reader.i32(); return true;
+      case 4: if (ST_BINARY != type) return false; element->name = reader.binary(); return true;
+      case 5: if (ST_I32 != type) return false; element->num_children = reader.i32(); return true;
+      case 6: if (ST_I32 != type) return false; element->converted_type = reader.i32(); return true;
+      default: return false;
+    }
+  });
+}
+
+} // unnamed namespace
+
+bool parse_file_metadata(uint8_t const* data, size_t size, FileMetaData* metadata)
+{
+  compact_reader reader(data, size);
+  reader.fields([&](int16_t id, int type) {
+    switch (id) {
+      case 1: if (ST_I32 != type) return false; metadata->version = reader.i32(); return true;
+      case 2:
+        return reader.struct_list(type, [&]() {
+          metadata->schema.push_back(SchemaElement());
+          read_schema_element(reader, &metadata->schema.back());
+        });
+      case 3: if (ST_I64 != type) return false; metadata->num_rows = reader.i64(); return true;
+      case 4:
+        return reader.struct_list(type, [&]() {
+          metadata->row_groups.push_back(RowGroup());
+          read_row_group(reader, &metadata->row_groups.back());
+        });
+      default: return false;
+    }
+  });
+  return !reader.failed();
+}
+
+bool parse_page_header(uint8_t const* data, size_t size, PageHeader* header, size_t* header_size)
+{
+  compact_reader reader(data, size);
+  reader.fields([&](int16_t id, int type) {
+    switch (id) {
+      case 1: if (ST_I32 != type) return false; header->type = reader.i32(); return true;
+      case 2: if (ST_I32 != type) return false; header->uncompressed_page_size = reader.i32(); return true;
+      case 3: if (ST_I32 != type) return false; header->compressed_page_size = reader.i32(); return true;
+      case 5:
+      case 7:
+        // DataPageHeader and DictionaryPageHeader start alike
+        if (ST_STRUCT != type) return false;
+        return reader.fields([&](int16_t page_id, int page_type) {
+          if (ST_I32 != page_type) return false;
+          switch (page_id) {
+            case 1: header->num_values = reader.i32(); return true;
+            case 2: header->encoding = reader.i32(); return true;
+            case 3:
+              if (5 != id) return false;
+              header->definition_level_encoding = reader.i32();
+              return true;
+            default: return false;
+          }
+        });
+      case 8:
+        if (ST_STRUCT != type) return false;
+        return reader.fields([&](int16_t page_id, int page_type) {
+          if (7 == page_id && (ST_TRUE == page_type || ST_FALSE == page_type)) {
+            header->is_compressed = (ST_TRUE == page_type);
+            return true;
+          }
+          if (ST_I32 != page_type) return false;
+          switch (page_id) {
+            case 1: header->num_values = reader.i32(); return true;
+            case 2: header->num_nulls = reader.i32(); return true;
+            case 4: header->encoding = reader.i32(); return true;
+            case 5: header->definition_levels_byte_length = reader.i32(); return true;
+            case 6: header->repetition_levels_byte_length = reader.i32(); return true;
+            default: return false;
+          }
+        });
+      default: return false;
+    }
+  });
+  *header_size = reader.consumed(data);
+  return !reader.failed();
+}
+
+} // namespace parquet
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** ---------------------------------------------------------------------------*
+ * @brief The parts of the Parquet file metadata the reader uses, as defined in
+ * https://github.com/apache/parquet-format/blob/master/src/main/thrift/parquet.thrift
+ *
+ * The metadata is serialized with the Thrift compact protocol. Fields the
+ * reader does not use are skipped while parsing.
+ * ---------------------------------------------------------------------------**/
+namespace parquet {
+
+enum Type {
+  BOOLEAN = 0,
+  INT32 = 1,
+  INT64 = 2,
+  INT96 = 3,
+  FLOAT = 4,
+  DOUBLE = 5,
+  BYTE_ARRAY = 6,
+  FIXED_LEN_BYTE_ARRAY = 7,
+};
+
+enum ConvertedType {
+  UNKNOWN = -1,
+  UTF8 = 0,
+  DECIMAL = 5,
+  DATE = 6,
+  TIME_MILLIS = 7,
+  TIME_MICROS = 8,
+  TIMESTAMP_MILLIS = 9,
+  TIMESTAMP_MICROS = 10,
+  UINT_8 = 11,
+  UINT_16 = 12,
+  UINT_32 = 13,
+  UINT_64 = 14,
+  INT_8 = 15,
+  INT_16 = 16,
+  INT_32 = 17,
+  INT_64 = 18,
+};
+
+enum FieldRepetitionType {
+  REQUIRED = 0,
+  OPTIONAL = 1,
+  REPEATED = 2,
+};
+
+enum Encoding {
+  PLAIN = 0,
+  PLAIN_DICTIONARY = 2,
+  RLE = 3,
+  BIT_PACKED = 4,
+  DELTA_BINARY_PACKED = 5,
+  DELTA_LENGTH_BYTE_ARRAY = 6,
+  DELTA_BYTE_ARRAY = 7,
+  RLE_DICTIONARY = 8,
+};
+
+enum Compression {
+  UNCOMPRESSED = 0,
+  SNAPPY = 1,
+  GZIP = 2,
+  LZO = 3,
+  BROTLI = 4,
+  LZ4 = 5,
+  ZSTD = 6,
+};
+
+enum PageType {
+  DATA_PAGE = 0,
+  INDEX_PAGE = 1,
+  DICTIONARY_PAGE = 2,
+  DATA_PAGE_V2 = 3,
+};
+
+struct SchemaElement {
+  int32_t type = -1;
+  int32_t type_length = 0;
+  int32_t repetition_type = REQUIRED;
+  std::string name;
+  int32_t num_children = 0;
+  int32_t converted_type = UNKNOWN;
+};
+
+/**
+ * @brief The minimum and maximum of a column chunk, plain encoded
+ *
+ * min_value and max_value are preferred over the deprecated min and max,
+ * which are only meaningful for signed types.
+ */
+struct Statistics {
+  std::string max;
+  std::string min;
+  int64_t null_count = -1;
+  std::string max_value;
+  std::string min_value;
+  bool has_max = false;
+  bool has_min = false;
+  bool has_max_value = false;
+  bool has_min_value = false;
+};
+
+/**
+ * @brief A column chunk with its ColumnMetaData flattened in
+ */
+struct ColumnChunk {
+  int32_t type = -1;
+  std::vector<std::string> path_in_schema;
+  int32_t codec = UNCOMPRESSED;
+  int64_t num_values = 0;
+  int64_t total_compressed_size = 0;
+  int64_t data_page_offset = 0;
+  int64_t dictionary_page_offset = 0;
+  Statistics statistics;
+};
+
+struct RowGroup {
+  std::vector<ColumnChunk> columns;
+  int64_t num_rows = 0;
+};
+
+struct FileMetaData {
+  int32_t version = 0;
+  std::vector<SchemaElement> schema;
+  int64_t num_rows = 0;
+  std::vector<RowGroup> row_groups;
+};
+
+struct PageHeader {
+  int32_t type = -1;
+  int32_t uncompressed_page_size = 0;
+  int32_t compressed_page_size = 0;
+  int32_t num_values = 0;
+  int32_t encoding = PLAIN;
+  // Only for DATA_PAGE
+  int32_t definition_level_encoding = RLE;
+  // Only for DATA_PAGE_V2, whose levels are never compressed
+  int32_t num_nulls = 0;
+  int32_t definition_levels_byte_length = 0;
+  int32_t repetition_levels_byte_length = 0;
+  bool is_compressed = true;
+};
+
+/**
+ * @brief Parses the FileMetaData at the end of a Parquet file
+ *
+ * @returns false if the metadata is malformed
+ */
+bool parse_file_metadata(uint8_t const* data, size_t size, FileMetaData* metadata);
+
+/**
+ * @brief Parses the header of a page, which its data follows
+ *
+ * @param[out] header_size The size of the header in bytes
+ *
+ * @returns false if the header is malformed
+ */
+bool parse_page_header(uint8_t const* data, size_t size, PageHeader* header, size_t* header_size);
+
+} // namespace parquet
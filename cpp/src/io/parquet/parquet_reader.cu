@@ -0,0 +1,988 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Reads the columns of a Parquet file into gdf_columns
+ *
+ * The footer is parsed on the host, where the row groups whose statistics
+ * cannot match the filter are pruned and the pages of the selected column
+ * chunks are decompressed into a single staging buffer. That buffer is copied
+ * to the device once, where every data page is decoded by its own block: the
+ * definition levels and dictionary indices are expanded from their RLE /
+ * bit-packed runs, and the values are scattered into the output columns.
+ *
+ * @file parquet_reader.cu
+ * ---------------------------------------------------------------------------**/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <cub/cub.cuh>
+
+#include <NVStrings.h>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "utilities/allocator.hpp"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "bitmask/bit_mask.h"
+#include "bitmask/bitmask_ops.h"
+#include "io/comp/io_uncomp.h"
+#include "io/utilities/source_file.h"
+
+#include "parquet_metadata.h"
+
+namespace { // unnamed namespace
+
+  using string_pair = std::pair<const char*, size_t>;
+
+  constexpr char file_magic[] = "PAR1";
+  constexpr size_t file_magic_size{4};
+  constexpr int decode_block_size{128};
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The output column a Parquet column is read into
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct column_desc
+  {
+    int leaf;               // Index of the column chunk in each row group
+    gdf_dtype dtype;
+    gdf_time_unit time_unit;
+    int src_width;          // Bytes per plain encoded value, 0 for bits and byte arrays
+    int dst_width;          // Bytes per output value
+    bool nullable;
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Maps the physical and converted type of a Parquet column to a
+   * gdf_dtype
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error describe_column(parquet::SchemaElement const& element, column_desc* desc)
+  {
+    desc->time_unit = TIME_UNIT_NONE;
+    desc->nullable = (parquet::OPTIONAL == element.repetition_type);
+    GDF_REQUIRE(parquet::DECIMAL != element.converted_type, GDF_UNSUPPORTED_DTYPE);
+
+    switch (element.type) {
+      case parquet::BOOLEAN:
+        desc->dtype = GDF_INT8;
+        desc->src_width = 0;
+        desc->dst_width = 1;
+        return GDF_SUCCESS;
+      case parquet::INT32:
+        desc->src_width = 4;
+        switch (element.converted_type) {
+          case parquet::INT_8:
+          case parquet::UINT_8:  desc->dtype = GDF_INT8; desc->dst_width = 1; break;
+          case parquet::INT_16:
+          case parquet::UINT_16: desc->dtype = GDF_INT16; desc->dst_width = 2; break;
+          case parquet::DATE:    desc->dtype = GDF_DATE32; desc->dst_width = 4; break;
+          default:               desc->dtype = GDF_INT32; desc->dst_width = 4; break;
+        }
+        return GDF_SUCCESS;
+      case parquet::INT64:
+        desc->src_width = 8;
+        desc->dst_width = 8;
+        switch (element.converted_type) {
+          case parquet::TIMESTAMP_MILLIS: desc->dtype = GDF_TIMESTAMP; desc->time_unit = TIME_UNIT_ms; break;
+          case parquet::TIMESTAMP_MICROS: desc->dtype = GDF_TIMESTAMP; desc->time_unit = TIME_UNIT_us; break;
+          default:                        desc->dtype = GDF_INT64; break;
+        }
+        return GDF_SUCCESS;
+      case parquet::FLOAT:
+        desc->dtype = GDF_FLOAT32;
+        desc->src_width = 4;
+        desc->dst_width = 4;
+        return GDF_SUCCESS;
+      case parquet::DOUBLE:
+        desc->dtype = GDF_FLOAT64;
+        desc->src_width = 8;
+        desc->dst_width = 8;
+        return GDF_SUCCESS;
+      case parquet::BYTE_ARRAY:
+        desc->dtype = GDF_STRING;
+        desc->src_width = 0;
+        desc->dst_width = sizeof(string_pair);
+        return GDF_SUCCESS;
+      default:
+        return GDF_UNSUPPORTED_DTYPE;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Reads a plain encoded statistic as a double
+   *
+   * @returns false if the column type has no numeric statistics
+   */
+  /* ----------------------------------------------------------------------------*/
+  bool decode_statistic(std::string const& value, parquet::SchemaElement const& element,
+                        bool is_unsigned, double* result)
+  {
+    switch (element.type) {
+      case parquet::INT32: {
+        if (value.size() < sizeof(int32_t)) return false;
+        int32_t v;
+        memcpy(&v, value.data(), sizeof(v));
+        *result = is_unsigned ? static_cast<double>(static_cast<uint32_t>(v)) : v;
+        return true;
+      }
+      case parquet::INT64: {
+        if (value.size() < sizeof(int64_t)) return false;
+        int64_t v;
+        memcpy(&v, value.data(), sizeof(v));
+        *result = is_unsigned ? static_cast<double>(static_cast<uint64_t>(v)) : static_cast<double>(v);
+        return true;
+      }
+      case parquet::FLOAT: {
+        if (value.size() < sizeof(float)) return false;
+        float v;
+        memcpy(&v, value.data(), sizeof(v));
+        *result = v;
+        return true;
+      }
+      case parquet::DOUBLE: {
+        if (value.size() < sizeof(double)) return false;
+        memcpy(result, value.data(), sizeof(double));
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Whether a column chunk may hold values matching the filter
+   *
+   * Chunks without usable statistics are always read.
+   */
+  /* ----------------------------------------------------------------------------*/
+  bool may_match(parquet::ColumnChunk const& chunk, parquet::SchemaElement const& element,
+                 gdf_stats_filter_op op, double value)
+  {
+    parquet::Statistics const& stats = chunk.statistics;
+    bool const is_unsigned = (element.converted_type >= parquet::UINT_8 &&
+                              element.converted_type <= parquet::UINT_64);
+
+    double min, max;
+    bool has_range{false};
+    if (stats.has_min_value && stats.has_max_value) {
+      has_range = decode_statistic(stats.min_value, element, is_unsigned, &min) &&
+                  decode_statistic(stats.max_value, element, is_unsigned, &max);
+    }
+    else if (stats.has_min && stats.has_max && !is_unsigned) {
+      // The deprecated statistics were computed with signed comparisons
+      has_range = decode_statistic(stats.min, element, false, &min) &&
+                  decode_statistic(stats.max, element, false, &max);
+    }
+    if (!has_range || std::isnan(min) || std::isnan(max)) {
+      return true;
+    }
+
+    switch (op) {
+      case STATS_FILTER_EQUAL:         return min <= value && value <= max;
+      case STATS_FILTER_LESS:          return min < value;
+      case STATS_FILTER_LESS_EQUAL:    return min <= value;
+      case STATS_FILTER_GREATER:       return max > value;
+      case STATS_FILTER_GREATER_EQUAL: return max >= value;
+      default:                         return true;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A page decompressed into the staging buffer, with offsets into it
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct staged_page
+  {
+    int column;             // Index into the column descs
+    bool is_dictionary;
+    int32_t num_values;
+    int32_t encoding;
+    int64_t levels_offset;  // Definition levels, -1 for required columns
+    int32_t levels_size;
+    int64_t values_offset;
+    int32_t values_size;
+    int dictionary;         // Index of the dictionary page of a data page, -1 if none
+    int64_t strings_base;   // First string entry of a page of byte arrays
+    gdf_size_type row_offset;
+  };
+
+  struct string_entry
+  {
+    int64_t offset;         // Into the staging buffer
+    int32_t length;
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Indexes the plain encoded byte arrays of a page
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error index_byte_arrays(std::vector<char> const& staging, int64_t offset, int32_t size,
+                              std::vector<string_entry>* strings)
+  {
+    int64_t pos = offset;
+    int64_t const end = offset + size;
+    while (pos + 4 <= end) {
+      int32_t length;
+      memcpy(&length, staging.data() + pos, sizeof(length));
+      pos += 4;
+      GDF_REQUIRE(length >= 0 && pos + length <= end, GDF_FILE_ERROR);
+      strings->push_back(string_entry{pos, length});
+      pos += length;
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Appends the pages of a column chunk to the staging buffer,
+   * decompressing them
+   *
+   * @param[in] file The whole file
+   * @param[in] chunk The column chunk
+   * @param[in] column Index of the column desc of the chunk
+   * @param[in] desc The column desc of the chunk
+   * @param[in] num_rows The number of rows of the row group
+   * @param[in,out] row_offset The first row of the chunk in the output column,
+   * advanced past it
+   * @param[in,out] staging The staging buffer
+   * @param[in,out] pages The staged pages
+   * @param[in,out] strings The indexed byte arrays
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error stage_column_chunk(source_file const& file, parquet::ColumnChunk const& chunk,
+                               int column, column_desc const& desc, int64_t num_rows,
+                               gdf_size_type* row_offset, std::vector<char>* staging,
+                               std::vector<staged_page>* pages,
+                               std::vector<string_entry>* strings)
+  {
+    int64_t start = chunk.data_page_offset;
+    if (chunk.dictionary_page_offset > 0 && chunk.dictionary_page_offset < start) {
+      start = chunk.dictionary_page_offset;
+    }
+    GDF_REQUIRE(start >= static_cast<int64_t>(file_magic_size) && chunk.total_compressed_size >= 0,
+                GDF_FILE_ERROR);
+    GDF_REQUIRE(start + chunk.total_compressed_size <= static_cast<int64_t>(file.size()),
+                GDF_FILE_ERROR);
+
+    bool const is_compressed{parquet::UNCOMPRESSED != chunk.codec};
+    int stream_type{IO_UNCOMP_STREAM_TYPE_INFER};
+    switch (chunk.codec) {
+      case parquet::UNCOMPRESSED: break;
+      case parquet::SNAPPY:       stream_type = IO_UNCOMP_STREAM_TYPE_SNAPPY; break;
+      case parquet::GZIP:         stream_type = IO_UNCOMP_STREAM_TYPE_GZIP; break;
+      default:                    return GDF_NOTIMPLEMENTED_ERROR;
+    }
+
+    uint8_t const* cur = file.data() + start;
+    uint8_t const* const end = cur + chunk.total_compressed_size;
+    int dictionary{-1};
+    int64_t values_read{0};
+    std::vector<char> uncompressed;
+
+    while (cur < end && values_read < chunk.num_values) {
+      parquet::PageHeader header;
+      size_t header_size{0};
+      GDF_REQUIRE(parquet::parse_page_header(cur, end - cur, &header, &header_size), GDF_FILE_ERROR);
+      cur += header_size;
+      GDF_REQUIRE(header.compressed_page_size >= 0 && header.compressed_page_size <= end - cur,
+                  GDF_FILE_ERROR);
+      uint8_t const* const payload = cur;
+      cur += header.compressed_page_size;
+
+      if (parquet::DICTIONARY_PAGE != header.type && parquet::DATA_PAGE != header.type &&
+          parquet::DATA_PAGE_V2 != header.type) {
+        continue;
+      }
+      bool const is_v2 = (parquet::DATA_PAGE_V2 == header.type);
+
+      // The levels of V2 pages are never compressed
+      int32_t levels_size{0};
+      if (is_v2) {
+        levels_size = header.repetition_levels_byte_length + header.definition_levels_byte_length;
+        GDF_REQUIRE(header.repetition_levels_byte_length >= 0 &&
+                    header.definition_levels_byte_length >= 0 &&
+                    levels_size <= header.compressed_page_size, GDF_FILE_ERROR);
+      }
+      int64_t const page_offset = staging->size();
+      staging->insert(staging->end(), payload, payload + levels_size);
+
+      uint8_t const* const data = payload + levels_size;
+      int32_t const data_size = header.compressed_page_size - levels_size;
+      if (is_compressed && (!is_v2 || header.is_compressed) && data_size > 0) {
+        gdf_error const status = io_uncompress_single_h2d(data, data_size, stream_type, uncompressed);
+        GDF_REQUIRE(GDF_SUCCESS == status, GDF_FILE_ERROR);
+        staging->insert(staging->end(), uncompressed.begin(), uncompressed.end());
+      }
+      else {
+        staging->insert(staging->end(), data, data + data_size);
+      }
+      int64_t const page_size = staging->size() - page_offset;
+      GDF_REQUIRE(page_size <= std::numeric_limits<int32_t>::max(), GDF_FILE_ERROR);
+
+      staged_page page;
+      page.column = column;
+      page.is_dictionary = (parquet::DICTIONARY_PAGE == header.type);
+      page.num_values = header.num_values;
+      page.encoding = header.encoding;
+      page.levels_offset = -1;
+      page.levels_size = 0;
+      page.values_offset = page_offset;
+      page.values_size = static_cast<int32_t>(page_size);
+      page.dictionary = -1;
+      page.strings_base = strings->size();
+      page.row_offset = *row_offset;
+      GDF_REQUIRE(page.num_values >= 0, GDF_FILE_ERROR);
+
+      if (page.is_dictionary) {
+        GDF_REQUIRE(parquet::PLAIN == page.encoding || parquet::PLAIN_DICTIONARY == page.encoding,
+                    GDF_NOTIMPLEMENTED_ERROR);
+        GDF_REQUIRE(0 != desc.src_width || GDF_STRING == desc.dtype, GDF_NOTIMPLEMENTED_ERROR);
+        dictionary = static_cast<int>(pages->size());
+      }
+      else {
+        bool const is_dictionary_encoded = (parquet::PLAIN_DICTIONARY == page.encoding ||
+                                            parquet::RLE_DICTIONARY == page.encoding);
+        GDF_REQUIRE(parquet::PLAIN == page.encoding || is_dictionary_encoded,
+                    GDF_NOTIMPLEMENTED_ERROR);
+        if (is_dictionary_encoded) {
+          GDF_REQUIRE(dictionary >= 0, GDF_FILE_ERROR);
+          page.dictionary = dictionary;
+        }
+
+        // Flat schemas have no repetition levels, and only nullable columns
+        // have definition levels
+        if (desc.nullable) {
+          if (is_v2) {
+            page.levels_offset = page_offset + header.repetition_levels_byte_length;
+            page.levels_size = header.definition_levels_byte_length;
+          }
+          else {
+            GDF_REQUIRE(parquet::RLE == header.definition_level_encoding, GDF_NOTIMPLEMENTED_ERROR);
+            GDF_REQUIRE(page_size >= 4, GDF_FILE_ERROR);
+            int32_t length;
+            memcpy(&length, staging->data() + page_offset, sizeof(length));
+            GDF_REQUIRE(length >= 0 && length <= page_size - 4, GDF_FILE_ERROR);
+            page.levels_offset = page_offset + 4;
+            page.levels_size = length;
+          }
+          page.values_offset = page.levels_offset + page.levels_size;
+        }
+        else {
+          page.values_offset = page_offset + levels_size;
+        }
+        page.values_size = static_cast<int32_t>(page_offset + page_size - page.values_offset);
+
+        GDF_REQUIRE(int64_t{*row_offset} + page.num_values <= std::numeric_limits<gdf_size_type>::max(),
+                    GDF_COLUMN_SIZE_TOO_BIG);
+        *row_offset += page.num_values;
+        values_read += page.num_values;
+      }
+
+      if (GDF_STRING == desc.dtype && (page.is_dictionary || parquet::PLAIN == page.encoding)) {
+        gdf_error const status = index_byte_arrays(*staging, page.values_offset, page.values_size,
+                                                   strings);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+      }
+      pages->push_back(page);
+    }
+
+    GDF_REQUIRE(values_read == num_rows, GDF_FILE_ERROR);
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A data page to decode, with device pointers into the staging
+   * buffer and the output column
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct page_desc
+  {
+    uint8_t const* levels;        // nullptr for required columns
+    int32_t levels_size;
+    uint8_t const* values;
+    int32_t values_size;
+    int32_t num_values;           // Of rows, null or not
+    int64_t values_count;         // Of plain encoded values
+    bool is_dictionary_encoded;
+    uint8_t const* dictionary;    // Plain encoded dictionary values
+    int64_t dictionary_size;      // Number of dictionary values
+    string_entry const* strings;  // The byte arrays of the page, or of its dictionary
+    char const* string_data;      // The staging buffer the string entries point into
+    int64_t scratch_offset;       // Of the levels and indices of the page
+    gdf_size_type row_offset;
+    int src_width;
+    int dst_width;
+    void* output;
+    bit_mask::bit_mask_t* valid;
+  };
+
+  struct rle_run
+  {
+    bool is_literal;
+    int32_t count;
+    uint32_t value;               // Of a repeated run
+    uint8_t const* data;          // Of a literal run
+  };
+
+  __device__ uint32_t unpack_value(uint8_t const* data, uint8_t const* end, int64_t index,
+                                   int bit_width)
+  {
+    int64_t const bit = index * bit_width;
+    uint8_t const* p = data + (bit >> 3);
+    int const shift = bit & 7;
+    uint64_t v{0};
+    for (int k = 0; k * 8 < shift + bit_width; ++k) {
+      if (p + k < end) {
+        v |= static_cast<uint64_t>(p[k]) << (8 * k);
+      }
+    }
+    return static_cast<uint32_t>((v >> shift) & ((uint64_t{1} << bit_width) - 1));
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Expands the runs of an RLE / bit-packed hybrid encoded stream, all
+   * threads of the block take part
+   *
+   * Values past the end of a malformed stream are zero.
+   *
+   * @param[in] cur The first run
+   * @param[in] end The end of the stream
+   * @param[in] bit_width Bits per value
+   * @param[in] num_values The number of values to expand
+   * @param[out] output The values
+   *
+   * @returns false if the stream ends before num_values values
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  __device__ bool decode_rle(uint8_t const* cur, uint8_t const* end, int bit_width,
+                             int32_t num_values, T* output)
+  {
+    __shared__ rle_run run;
+    __shared__ uint8_t const* next;
+
+    if (0 == threadIdx.x) {
+      next = cur;
+    }
+    int32_t pos{0};
+    while (pos < num_values) {
+      if (0 == threadIdx.x) {
+        uint32_t header{0};
+        int shift{0};
+        uint8_t const* p = next;
+        while (p < end && shift < 32) {
+          uint8_t const b = *p++;
+          header |= static_cast<uint32_t>(b & 0x7f) << shift;
+          shift += 7;
+          if (!(b & 0x80)) break;
+        }
+        run.is_literal = (header & 1);
+        run.data = p;
+        if (p >= end) {
+          run.count = 0;
+        }
+        else if (run.is_literal) {
+          run.count = (header >> 1) * 8;
+          p += static_cast<int64_t>(header >> 1) * bit_width;
+        }
+        else {
+          run.count = header >> 1;
+          run.value = 0;
+          for (int k = 0; k * 8 < bit_width; ++k) {
+            run.value |= (p < end ? static_cast<uint32_t>(*p) : 0) << (8 * k);
+            ++p;
+          }
+        }
+        next = p;
+      }
+      __syncthreads();
+
+      int32_t const count = min(run.count, num_values - pos);
+      if (count <= 0) {
+        break;
+      }
+      for (int32_t i = threadIdx.x; i < count; i += blockDim.x) {
+        output[pos + i] = run.is_literal ? static_cast<T>(unpack_value(run.data, end, i, bit_width))
+                                         : static_cast<T>(run.value);
+      }
+      pos += count;
+      __syncthreads();
+    }
+
+    for (int32_t i = pos + threadIdx.x; i < num_values; i += blockDim.x) {
+      output[i] = 0;
+    }
+    __syncthreads();
+    return pos >= num_values;
+  }
+
+  __device__ uint64_t load_value(uint8_t const* src, int width)
+  {
+    uint64_t v{0};
+    for (int k = 0; k < width; ++k) {
+      v |= static_cast<uint64_t>(src[k]) << (8 * k);
+    }
+    return v;
+  }
+
+  __device__ void store_value(void* output, gdf_size_type row, int width, uint64_t v)
+  {
+    switch (width) {
+      case 1: static_cast<int8_t*>(output)[row] = static_cast<int8_t>(v); break;
+      case 2: static_cast<int16_t*>(output)[row] = static_cast<int16_t>(v); break;
+      case 4: static_cast<int32_t*>(output)[row] = static_cast<int32_t>(v); break;
+      default: static_cast<int64_t*>(output)[row] = static_cast<int64_t>(v); break;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Decodes one data page per block into its output column
+   *
+   * A page holds a value for every non-null row, so the rows are mapped to
+   * values with a block-wide prefix sum of their validity. Definition levels
+   * that end early and values or dictionary indices out of range set the
+   * error flag, the rows are decoded as nulls.
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__ void decode_pages(page_desc const* pages, uint8_t* levels_scratch,
+                               uint32_t* indices_scratch, int* error)
+  {
+    typedef cub::BlockScan<int32_t, decode_block_size> block_scan;
+    __shared__ typename block_scan::TempStorage scan_storage;
+
+    page_desc const& page = pages[blockIdx.x];
+    uint8_t* const levels = levels_scratch + page.scratch_offset;
+    uint32_t* const indices = (nullptr != indices_scratch) ? indices_scratch + page.scratch_offset
+                                                           : nullptr;
+    uint8_t const* const values_end = page.values + page.values_size;
+
+    // Flat schemas have a maximum definition level of 1
+    if (nullptr != page.levels &&
+        !decode_rle(page.levels, page.levels + page.levels_size, 1, page.num_values, levels) &&
+        0 == threadIdx.x) {
+      *error = 1;
+    }
+
+    // Dictionary indices start with their bit width
+    if (page.is_dictionary_encoded) {
+      int const bit_width = (page.values_size > 0) ? min(int{page.values[0]}, 32) : 0;
+      decode_rle(page.values + 1, values_end, bit_width, page.num_values, indices);
+    }
+
+    int32_t num_valid{0};
+    for (int32_t base = 0; base < page.num_values; base += decode_block_size) {
+      int32_t const i = base + threadIdx.x;
+      int32_t const is_valid = (i < page.num_values) && (nullptr == page.levels || 1 == levels[i]);
+      int32_t ordinal, block_valid;
+      block_scan(scan_storage).ExclusiveSum(is_valid, ordinal, block_valid);
+      ordinal += num_valid;
+      num_valid += block_valid;
+      __syncthreads();
+
+      if (i >= page.num_values) {
+        continue;
+      }
+      gdf_size_type const row = page.row_offset + i;
+
+      // The position of the value among the page's values, or in the dictionary
+      int64_t index = ordinal;
+      int64_t count = page.values_count;
+      if (page.is_dictionary_encoded && is_valid) {
+        index = indices[ordinal];
+        count = page.dictionary_size;
+      }
+      bool const in_bounds = is_valid && (index < count);
+      if (is_valid && !in_bounds) {
+        *error = 1;
+      }
+
+      if (nullptr != page.strings) {
+        string_pair* const output = static_cast<string_pair*>(page.output);
+        if (in_bounds) {
+          string_entry const entry = page.strings[index];
+          output[row] = string_pair(page.string_data + entry.offset, entry.length);
+        } else {
+          output[row] = string_pair(nullptr, 0);
+        }
+      }
+      else if (0 == page.src_width) {
+        uint64_t const v = in_bounds ? ((page.values[index >> 3] >> (index & 7)) & 1) : 0;
+        store_value(page.output, row, page.dst_width, v);
+      }
+      else {
+        uint8_t const* const src = (page.is_dictionary_encoded ? page.dictionary : page.values) +
+                                   index * page.src_width;
+        store_value(page.output, row, page.dst_width, in_bounds ? load_value(src, page.src_width) : 0);
+      }
+
+      if (nullptr != page.valid && in_bounds) {
+        bit_mask::set_bit_safe(page.valid, row);
+      }
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Frees the outputs of a failed read_parquet and resets them
+   *
+   * @param[in,out] args The arguments of read_parquet
+   * @param[in] outputs The value buffers not yet moved into their columns
+   * @param[in] stream The stream to free on
+   */
+  /* ----------------------------------------------------------------------------*/
+  void free_output(pq_read_arg* args, std::vector<void*> const& outputs, cudaStream_t stream)
+  {
+    for (int i = 0; i < args->num_cols_out; ++i) {
+      if (nullptr != outputs[i]) {
+        RMM_FREE(outputs[i], stream);
+      }
+      gdf_column* const column = args->data[i];
+      if (nullptr == column) {
+        continue;
+      }
+      if (nullptr != column->data) {
+        if (GDF_STRING == column->dtype) {
+          NVStrings::destroy(static_cast<NVStrings*>(column->data));
+        } else {
+          RMM_FREE(column->data, stream);
+        }
+      }
+      if (nullptr != column->valid) {
+        RMM_FREE(column->valid, stream);
+      }
+      free(column->col_name);
+      free(column);
+    }
+    free(args->data);
+    args->data = nullptr;
+    args->num_cols_out = 0;
+    args->num_rows_out = 0;
+  }
+
+} // unnamed namespace
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Reads the columns of a Parquet file into gdf_columns
+ *
+ * Only flat schemas are supported. The row groups whose min/max statistics
+ * show that no value of the filter column can satisfy the filter are not read.
+ * BOOLEAN columns are read into GDF_INT8 columns, BYTE_ARRAY columns into
+ * GDF_STRING columns.
+ *
+ * @param[in,out] args The input file and the output columns, see
+ * pq_read_arg. Nothing stays allocated in it when the read fails.
+ *
+ * @returns GDF_SUCCESS upon successful completion, GDF_FILE_ERROR if the
+ * input is malformed, including dictionary indices or values past the end of
+ * a page, GDF_UNSUPPORTED_DTYPE for INT96, FIXED_LEN_BYTE_ARRAY and DECIMAL
+ * columns and GDF_NOTIMPLEMENTED_ERROR for nested schemas and unsupported
+ * encodings or codecs, including definition levels that are not RLE encoded
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error read_parquet(pq_read_arg *args)
+{
+  GDF_REQUIRE(nullptr != args, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(nullptr != args->filepath_or_buffer, GDF_INVALID_API_CALL);
+
+  cudaStream_t stream{0};
+
+  source_file file;
+  if (FILE_PATH == args->input_data_form) {
+    gdf_error const status = file.open_path(args->filepath_or_buffer);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+  }
+  else if (HOST_BUFFER == args->input_data_form) {
+    file.use_buffer(args->filepath_or_buffer, args->buffer_size);
+  }
+  else {
+    return GDF_INVALID_API_CALL;
+  }
+
+  // The file starts with the magic and ends with the metadata, its length and
+  // the magic
+  size_t const size = file.size();
+  GDF_REQUIRE(size >= 2 * file_magic_size + sizeof(int32_t), GDF_FILE_ERROR);
+  GDF_REQUIRE(0 == memcmp(file.data(), file_magic, file_magic_size) &&
+              0 == memcmp(file.data() + size - file_magic_size, file_magic, file_magic_size),
+              GDF_FILE_ERROR);
+  int32_t metadata_size;
+  memcpy(&metadata_size, file.data() + size - file_magic_size - sizeof(int32_t), sizeof(int32_t));
+  GDF_REQUIRE(metadata_size > 0 &&
+              static_cast<size_t>(metadata_size) <= size - 2 * file_magic_size - sizeof(int32_t),
+              GDF_FILE_ERROR);
+
+  parquet::FileMetaData metadata;
+  GDF_REQUIRE(parquet::parse_file_metadata(file.data() + size - file_magic_size - sizeof(int32_t) - metadata_size,
+                                           metadata_size, &metadata), GDF_FILE_ERROR);
+
+  // The root is followed by the leaves of a flat schema
+  GDF_REQUIRE(!metadata.schema.empty(), GDF_FILE_ERROR);
+  std::vector<parquet::SchemaElement> const leaves(metadata.schema.begin() + 1, metadata.schema.end());
+  GDF_REQUIRE(static_cast<size_t>(metadata.schema[0].num_children) == leaves.size(),
+              GDF_NOTIMPLEMENTED_ERROR);
+  for (auto const& leaf : leaves) {
+    GDF_REQUIRE(0 == leaf.num_children && parquet::REPEATED != leaf.repetition_type,
+                GDF_NOTIMPLEMENTED_ERROR);
+  }
+  for (auto const& row_group : metadata.row_groups) {
+    GDF_REQUIRE(row_group.columns.size() == leaves.size(), GDF_FILE_ERROR);
+  }
+
+  auto const find_leaf = [&](const char* name) {
+    for (size_t i = 0; i < leaves.size(); ++i) {
+      if (leaves[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+  };
+
+  // Columns are read in the order of the file
+  std::vector<bool> selected(leaves.size(), nullptr == args->use_cols);
+  if (nullptr != args->use_cols) {
+    for (int i = 0; i < args->num_cols; ++i) {
+      int const leaf = find_leaf(args->use_cols[i]);
+      GDF_REQUIRE(leaf >= 0, GDF_INVALID_API_CALL);
+      selected[leaf] = true;
+    }
+  }
+  std::vector<column_desc> columns;
+  for (size_t i = 0; i < leaves.size(); ++i) {
+    if (selected[i]) {
+      columns.push_back(column_desc());
+      columns.back().leaf = static_cast<int>(i);
+      gdf_error const status = describe_column(leaves[i], &columns.back());
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+    }
+  }
+
+  // Prune the row groups by the statistics of the filter column
+  std::vector<int> row_groups;
+  int filter_leaf{-1};
+  if (nullptr != args->filter_column && STATS_FILTER_NONE != args->filter_op) {
+    filter_leaf = find_leaf(args->filter_column);
+    GDF_REQUIRE(filter_leaf >= 0, GDF_INVALID_API_CALL);
+  }
+  int64_t num_rows{0};
+  for (size_t i = 0; i < metadata.row_groups.size(); ++i) {
+    auto const& row_group = metadata.row_groups[i];
+    if (filter_leaf >= 0 && !may_match(row_group.columns[filter_leaf], leaves[filter_leaf],
+                                       args->filter_op, args->filter_value)) {
+      continue;
+    }
+    row_groups.push_back(static_cast<int>(i));
+    num_rows += row_group.num_rows;
+  }
+  GDF_REQUIRE(num_rows <= std::numeric_limits<gdf_size_type>::max(), GDF_COLUMN_SIZE_TOO_BIG);
+
+  // Decompress the pages of the selected chunks into the staging buffer
+  std::vector<char> staging;
+  std::vector<staged_page> pages;
+  std::vector<string_entry> strings;
+  for (size_t c = 0; c < columns.size(); ++c) {
+    gdf_size_type row_offset{0};
+    for (int g : row_groups) {
+      auto const& row_group = metadata.row_groups[g];
+      gdf_error const status = stage_column_chunk(file, row_group.columns[columns[c].leaf],
+                                                  static_cast<int>(c), columns[c], row_group.num_rows,
+                                                  &row_offset, &staging, &pages, &strings);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+    }
+  }
+
+  int const num_cols = static_cast<int>(columns.size());
+  gdf_column** data = static_cast<gdf_column**>(malloc(sizeof(gdf_column*) * num_cols));
+  args->data = data;
+  args->num_cols_out = num_cols;
+  args->num_rows_out = static_cast<gdf_size_type>(num_rows);
+  args->num_row_groups_skipped = static_cast<int>(metadata.row_groups.size() - row_groups.size());
+  for (int i = 0; i < num_cols; ++i) {
+    data[i] = nullptr;
+  }
+
+  // Strings are gathered into pairs, then copied into NVStrings. The scratch
+  // buffers are freed on every return, the outputs also if the decode fails
+  std::vector<void*> outputs(num_cols, nullptr);
+  uint8_t* d_staging{nullptr};
+  string_entry* d_strings{nullptr};
+  page_desc* d_pages{nullptr};
+  uint8_t* d_levels{nullptr};
+  uint32_t* d_indices{nullptr};
+  int* d_error{nullptr};
+
+  auto const decode = [&]() -> gdf_error {
+    for (int i = 0; i < num_cols; ++i) {
+      column_desc const& desc = columns[i];
+      std::string const& name = leaves[desc.leaf].name;
+
+      data[i] = static_cast<gdf_column*>(malloc(sizeof(gdf_column)));
+      gdf_column* const column = data[i];
+      column->size = static_cast<gdf_size_type>(num_rows);
+      column->dtype = desc.dtype;
+      column->dtype_info = gdf_dtype_extra_info{desc.time_unit};
+      column->null_count = 0;
+      column->data = nullptr;
+      column->valid = nullptr;
+      column->col_name = static_cast<char*>(malloc(name.size() + 1));
+      memcpy(column->col_name, name.c_str(), name.size() + 1);
+
+      if (0 == num_rows) {
+        continue;
+      }
+      RMM_TRY( RMM_ALLOC(&outputs[i], int64_t{desc.dst_width} * num_rows, stream) );
+      if (desc.nullable) {
+        // Whole words, which the decoder sets bits of atomically
+        size_t const num_bytes = bit_mask::num_elements(column->size) * sizeof(bit_mask::bit_mask_t);
+        RMM_TRY( RMM_ALLOC(&column->valid, num_bytes, stream) );
+        CUDA_TRY( cudaMemsetAsync(column->valid, 0, num_bytes, stream) );
+      }
+    }
+
+    // Copy the staging buffer and the descriptions of the data pages
+    if (!staging.empty()) {
+      SCRATCH_ALLOC_TRY(&d_staging, staging.size(), stream);
+      CUDA_TRY( cudaMemcpyAsync(d_staging, staging.data(), staging.size(), cudaMemcpyHostToDevice, stream) );
+    }
+    if (!strings.empty()) {
+      SCRATCH_ALLOC_TRY(&d_strings, sizeof(string_entry) * strings.size(), stream);
+      CUDA_TRY( cudaMemcpyAsync(d_strings, strings.data(), sizeof(string_entry) * strings.size(),
+                                cudaMemcpyHostToDevice, stream) );
+    }
+
+    std::vector<page_desc> data_pages;
+    int64_t scratch_size{0};
+    bool any_dictionary_encoded{false};
+    for (size_t p = 0; p < pages.size(); ++p) {
+      staged_page const& page = pages[p];
+      if (page.is_dictionary || 0 == page.num_values) {
+        continue;
+      }
+      column_desc const& desc = columns[page.column];
+      int64_t const next_strings_base = (p + 1 < pages.size()) ? pages[p + 1].strings_base
+                                                               : static_cast<int64_t>(strings.size());
+
+      page_desc d;
+      d.levels = (page.levels_offset >= 0) ? d_staging + page.levels_offset : nullptr;
+      d.levels_size = page.levels_size;
+      d.values = d_staging + page.values_offset;
+      d.values_size = page.values_size;
+      d.num_values = page.num_values;
+      d.values_count = (GDF_STRING == desc.dtype) ? next_strings_base - page.strings_base
+                     : (0 != desc.src_width) ? page.values_size / desc.src_width
+                     : int64_t{page.values_size} * 8;
+      d.is_dictionary_encoded = (page.dictionary >= 0);
+      d.dictionary = nullptr;
+      d.dictionary_size = 0;
+      d.strings = (GDF_STRING == desc.dtype) ? d_strings + page.strings_base : nullptr;
+      d.string_data = reinterpret_cast<char const*>(d_staging);
+      if (d.is_dictionary_encoded) {
+        staged_page const& dictionary = pages[page.dictionary];
+        d.dictionary = d_staging + dictionary.values_offset;
+        if (GDF_STRING == desc.dtype) {
+          d.strings = d_strings + dictionary.strings_base;
+          d.dictionary_size = pages[page.dictionary + 1].strings_base - dictionary.strings_base;
+        }
+        else {
+          d.dictionary_size = std::min<int64_t>(dictionary.num_values, dictionary.values_size / desc.src_width);
+        }
+        any_dictionary_encoded = true;
+      }
+      d.scratch_offset = scratch_size;
+      d.row_offset = page.row_offset;
+      d.src_width = desc.src_width;
+      d.dst_width = desc.dst_width;
+      d.output = outputs[page.column];
+      d.valid = reinterpret_cast<bit_mask::bit_mask_t*>(data[page.column]->valid);
+      data_pages.push_back(d);
+      scratch_size += page.num_values;
+    }
+
+    if (!data_pages.empty()) {
+      SCRATCH_ALLOC_TRY(&d_pages, sizeof(page_desc) * data_pages.size(), stream);
+      SCRATCH_ALLOC_TRY(&d_levels, scratch_size, stream);
+      if (any_dictionary_encoded) {
+        SCRATCH_ALLOC_TRY(&d_indices, sizeof(uint32_t) * scratch_size, stream);
+      }
+      SCRATCH_ALLOC_TRY(&d_error, sizeof(int), stream);
+      CUDA_TRY( cudaMemcpyAsync(d_pages, data_pages.data(), sizeof(page_desc) * data_pages.size(),
+                                cudaMemcpyHostToDevice, stream) );
+      CUDA_TRY( cudaMemsetAsync(d_error, 0, sizeof(int), stream) );
+
+      decode_pages<<<data_pages.size(), decode_block_size, 0, stream>>>(d_pages, d_levels, d_indices,
+                                                                        d_error);
+      CUDA_CHECK_LAST();
+
+      int h_error{0};
+      CUDA_TRY( cudaMemcpyAsync(&h_error, d_error, sizeof(int), cudaMemcpyDeviceToHost, stream) );
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+      GDF_REQUIRE(0 == h_error, GDF_FILE_ERROR);
+    }
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+
+    for (int i = 0; i < num_cols; ++i) {
+      gdf_column* const column = data[i];
+      if (nullptr != column->valid) {
+        gdf_size_type valid_count{0};
+        gdf_error const status = bitmask_count_valid(column->valid, column->size, &valid_count, stream);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        column->null_count = column->size - valid_count;
+      }
+      if (GDF_STRING == column->dtype) {
+        column->data = NVStrings::create_from_index(static_cast<string_pair*>(outputs[i]), column->size);
+        if (nullptr != outputs[i]) {
+          RMM_TRY( RMM_FREE(outputs[i], stream) );
+        }
+      }
+      else {
+        column->data = outputs[i];
+      }
+      outputs[i] = nullptr;
+    }
+    return GDF_SUCCESS;
+  };
+
+  gdf_error const status = decode();
+
+  for (void* buffer : {static_cast<void*>(d_staging), static_cast<void*>(d_strings),
+                       static_cast<void*>(d_pages), static_cast<void*>(d_levels),
+                       static_cast<void*>(d_indices), static_cast<void*>(d_error)}) {
+    if (nullptr != buffer) {
+      cudf::memory::device_allocator().deallocate(buffer, stream);
+    }
+  }
+  if (GDF_SUCCESS != status) {
+    free_output(args, outputs, stream);
+  }
+  return status;
+}
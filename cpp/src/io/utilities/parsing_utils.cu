@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2018-2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+
+#include <thrust/reduce.h>
+
+#include "parsing_utils.cuh"
+
+#include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
+
+#include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+
+__global__ void countRecords(char *data, const char terminator, const char quotechar, long num_bytes, long num_bits, cu_reccnt_t* num_records);
+__global__ void storeRecordStart(char *data, size_t chunk_offset, 
+	const char terminator, const char quotechar, bool include_first_row,
+	long num_bytes, long num_bits, cu_reccnt_t* num_records,
+	cu_recstart_t* recStart);
+
+/**---------------------------------------------------------------------------*
+ * @brief Counts the number of rows in the input data.
+ * 
+ * Does not load the entire file into the GPU memory at any time, so it can 
+ * be used to parse large files.
+ * Does not take quotes into consideration, so it will return extra rows
+ * if the line terminating characters are present within quotes.
+ * Because of this the result should be postprocessed to remove 
+ * the fake line endings.
+ * 
+ * @param[in] h_data Pointer to the input data in host memory
+ * @param[in] h_size Size of the input data, in bytes
+ * @param[in] terminator Line terminator character
+ * @param[in] quotechar Quote character, '\0' if quotes are not used
+ * @param[in] include_first_row Whether the data starts with a row, i.e. it
+ * is not at an offset into the file
+ * @param[out] rec_cnt The resulting number of rows (records)
+ * 
+ * @return gdf_error with error code on failure, otherwise GDF_SUCCESS
+ *---------------------------------------------------------------------------**/
+gdf_error launch_countRecords(const char *h_data, size_t h_size,
+                              char terminator, char quotechar,
+                              bool include_first_row, gdf_size_type &rec_cnt)
+{
+	const size_t chunk_count = (h_size + max_chunk_bytes - 1) / max_chunk_bytes;
+	rmm::device_vector<cu_reccnt_t> d_counts(chunk_count);
+
+	char* d_chunk = nullptr;
+	SCRATCH_ALLOC_TRY(&d_chunk, max_chunk_bytes, 0); 
+
+	int blockSize;		// suggested thread count to use
+	int minGridSize;	// minimum block count required
+	CUDA_TRY(cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, countRecords));
+
+	for (size_t ci = 0; ci < chunk_count; ++ci) {
+		const auto h_chunk = h_data + ci * max_chunk_bytes;
+		const auto chunk_bytes = std::min((size_t)(h_size - ci * max_chunk_bytes), max_chunk_bytes);
+		const auto chunk_bits = (chunk_bytes + 63) / 64;
+
+		// Copy chunk to device
+		CUDA_TRY(cudaMemcpy(d_chunk, h_chunk, chunk_bytes, cudaMemcpyDefault));
+
+		const int gridSize = (chunk_bits + blockSize - 1) / blockSize;
+		countRecords <<< gridSize, blockSize >>> (
+			d_chunk, terminator, quotechar,
+			chunk_bytes, chunk_bits, thrust::raw_pointer_cast(&d_counts[ci])
+			);
+	}
+
+	SCRATCH_FREE_TRY(d_chunk, 0);
+
+	CUDA_TRY(cudaGetLastError());
+
+	// Row count is used to allocate/track row start positions
+	// If not starting at an offset, add an extra row to account for offset=0
+	rec_cnt = thrust::reduce(rmm::exec_policy()->on(0), d_counts.begin(), d_counts.end());
+	if (include_first_row) {
+		rec_cnt++;
+	}
+
+	return GDF_SUCCESS;
+}
+
+
+/**---------------------------------------------------------------------------* 
+ * @brief CUDA kernel that counts the number of rows in the given 
+ * file segment, based on the location of line terminators. 
+ * 
+ * @param[in] data Device memory pointer to the input data, 
+ * potentially a chunk of the whole file
+ * @param[in] terminator Line terminator character
+ * @param[in] quotechar Quote character
+ * @param[in] num_bytes Number of bytes in the input data
+ * @param[in] num_bits Number of 'bits' in the input data. Each 'bit' is
+ * processed by a separate CUDA thread
+ * @param[in,out] num_records Device memory pointer to the number of found rows
+ * 
+ * @return void
+ *---------------------------------------------------------------------------**/
+__global__ void countRecords(char *data, const char terminator, const char quotechar, long num_bytes, long num_bits, 
+	cu_reccnt_t* num_records) {
+
+	// thread IDs range per block, so also need the block id
+	const long tid = threadIdx.x + (blockDim.x * blockIdx.x);
+
+	if (tid >= num_bits)
+		return;
+
+	// data ID is a multiple of 64
+	const long did = tid * 64L;
+
+	const char *raw = (data + did);
+
+	const long byteToProcess = ((did + 64L) < num_bytes) ? 64L : (num_bytes - did);
+
+	// process the data
+	cu_reccnt_t tokenCount = 0;
+	for (long x = 0; x < byteToProcess; x++) {
+		
+		// Scan and log records. If quotations are enabled, then also log quotes
+		// for a postprocess ignore, as the chunk here has limited visibility.
+		if ((raw[x] == terminator) || (quotechar != '\0' && raw[x] == quotechar)) {
+			tokenCount++;
+		} else if (terminator == '\n' && (x + 1L) < byteToProcess && 
+		           raw[x] == '\r' && raw[x + 1L] == '\n') {
+			x++;
+			tokenCount++;
+		}
+
+	}
+	atomicAdd(num_records, tokenCount);
+}
+
+
+/**---------------------------------------------------------------------------*
+ * @brief Finds the start of each row (record) in the given file, based on
+ * the location of line terminators. The offset of each found row is stored 
+ * in the rec_starts array, in no particular order.
+ * 
+ * Does not load the entire file into the GPU memory at any time, so it can 
+ * be used to parse large files.
+ * Does not take quotes into consideration, so it will return extra rows
+ * if the line terminating characters are present within quotes.
+ * Because of this the result should be postprocessed to remove 
+ * the fake line endings.
+ * 
+ * @param[in] h_data Pointer to the input data in host memory
+ * @param[in] h_size Size of the input data, in bytes
+ * @param[in] terminator Line terminator character
+ * @param[in] quotechar Quote character, '\0' if quotes are not used
+ * @param[in] include_first_row Whether to store the row at offset 0
+ * @param[out] rec_starts Device memory array of the offsets, sized by
+ * launch_countRecords
+ * 
+ * @return gdf_error with error code on failure, otherwise GDF_SUCCESS
+ *---------------------------------------------------------------------------**/
+gdf_error launch_storeRecordStart(const char *h_data, size_t h_size,
+                                  char terminator, char quotechar,
+                                  bool include_first_row,
+                                  cu_recstart_t *rec_starts) {
+
+	char* d_chunk = nullptr;
+	// Allocate extra byte in case \r\n is at the chunk border
+	SCRATCH_ALLOC_TRY(&d_chunk, max_chunk_bytes + 1, 0); 
+	
+	cu_reccnt_t*	d_num_records;
+	SCRATCH_ALLOC_TRY(&d_num_records, sizeof(cu_reccnt_t), 0);
+	CUDA_TRY(cudaMemset(d_num_records, 0ull, sizeof(cu_reccnt_t)));
+
+	int blockSize;		// suggested thread count to use
+	int minGridSize;	// minimum block count required
+	CUDA_TRY(cudaOccupancyMaxPotentialBlockSize(&minGridSize, &blockSize, storeRecordStart) );
+
+	const size_t chunk_count = (h_size + max_chunk_bytes - 1) / max_chunk_bytes;
+	for (size_t ci = 0; ci < chunk_count; ++ci) {	
+		const auto chunk_offset = ci * max_chunk_bytes;	
+		const auto h_chunk = h_data + chunk_offset;
+		const auto chunk_bytes = std::min((size_t)(h_size - ci * max_chunk_bytes), max_chunk_bytes);
+		const auto chunk_bits = (chunk_bytes + 63) / 64;
+		// include_first_row should only apply to the first chunk
+		const bool cu_include_first_row = (ci == 0) && include_first_row;
+		
+		// Copy chunk to device. Copy extra byte if not last chunk, the last
+		// one ends at the end of the input
+		const auto copy_bytes = std::min(chunk_bytes + 1, h_size - chunk_offset);
+		CUDA_TRY(cudaMemcpy(d_chunk, h_chunk, copy_bytes, cudaMemcpyDefault));
+
+		const int gridSize = (chunk_bits + blockSize - 1) / blockSize;
+		storeRecordStart <<< gridSize, blockSize >>> (
+			d_chunk, chunk_offset, terminator, quotechar, cu_include_first_row,
+			chunk_bytes, chunk_bits, d_num_records,
+			rec_starts
+		);
+	}
+
+	SCRATCH_FREE_TRY(d_num_records, 0); 
+	SCRATCH_FREE_TRY(d_chunk, 0);
+
+	CUDA_TRY( cudaGetLastError() );
+
+	return GDF_SUCCESS;
+}
+
+
+/**---------------------------------------------------------------------------*
+ * @brief CUDA kernel that finds the start of each row (record) in the given 
+ * file segment, based on the location of line terminators. 
+ * 
+ * The offset of each found row is stored in a device memory array. 
+ * The kernel operate on a segment (chunk) of the file.
+ * 
+ * @param[in] data Device memory pointer to the input data, 
+ * potentially a chunk of the whole file
+ * @param[in] chunk_offset Offset of the data pointer from the start of the file
+ * @param[in] terminator Line terminator character
+ * @param[in] quotechar Quote character
+ * @param[in] num_bytes Number of bytes in the input data
+ * @param[in] num_bits Number of 'bits' in the input data. Each 'bit' is
+ * processed by a separate CUDA thread
+ * @param[in,out] num_records Device memory pointer to the number of found rows
+ * @param[out] recStart device memory array containing the offset of each record
+ * 
+ * @return void
+ *---------------------------------------------------------------------------**/
+__global__ void storeRecordStart(char *data, size_t chunk_offset, 
+	const char terminator, const char quotechar, bool include_first_row,
+	long num_bytes, long num_bits, cu_reccnt_t* num_records,
+	cu_recstart_t* recStart) {
+
+	// thread IDs range per block, so also need the block id
+	const long tid = threadIdx.x + (blockDim.x * blockIdx.x);
+
+	if ( tid >= num_bits)
+		return;
+
+	// data ID - multiple of 64
+	const long did = tid * 64L;
+
+	if (did == 0 && include_first_row) {
+		const auto pos = atomicAdd(num_records, 1ull);
+		recStart[pos] = 0;
+	}
+
+	const char *raw = (data + did);
+
+	const long byteToProcess = ((did + 64L) < num_bytes) ? 64L : (num_bytes - did);
+
+	// process the data
+	for (long x = 0; x < byteToProcess; x++) {
+
+		// Scan and log records. If quotations are enabled, then also log quotes
+		// for a postprocess ignore, as the chunk here has limited visibility.
+		if ((raw[x] == terminator) || (quotechar != '\0' && raw[x] == quotechar)) {
+
+			const auto pos = atomicAdd(num_records, 1ull);
+			recStart[pos] = did + chunk_offset + x + 1;
+
+		} else if (terminator == '\n' && (x + 1L) < byteToProcess && 
+				   raw[x] == '\r' && raw[x + 1L] == '\n') {
+
+			x++;
+			const auto pos = atomicAdd(num_records, 1ull);
+			recStart[pos] = did + chunk_offset + x + 1;
+		}
+
+	}
+}
+
+
+/*
+ * What is passed in is the data type as a string, need to convert that into gdf_dtype enum
+ */
+gdf_dtype convertStringToDtype(std::string &dtype) {
+
+	if (dtype.compare( "str") == 0) 		return GDF_STRING;
+	if (dtype.compare( "date") == 0) 		return GDF_DATE64;
+	if (dtype.compare( "date32") == 0) 		return GDF_DATE32;
+	if (dtype.compare( "date64") == 0) 		return GDF_DATE64;
+	if (dtype.compare( "timestamp") == 0)	return GDF_TIMESTAMP;
+	if (dtype.compare( "category") == 0) 	return GDF_CATEGORY;
+	if (dtype.compare( "float") == 0)		return GDF_FLOAT32;
+	if (dtype.compare( "float32") == 0)		return GDF_FLOAT32;
+	if (dtype.compare( "float64") == 0)		return GDF_FLOAT64;
+	if (dtype.compare( "double") == 0)		return GDF_FLOAT64;
+	if (dtype.compare( "short") == 0)		return GDF_INT16;
+	if (dtype.compare( "int") == 0)			return GDF_INT32;
+	if (dtype.compare( "int32") == 0)		return GDF_INT32;
+	if (dtype.compare( "int64") == 0)		return GDF_INT64;
+	if (dtype.compare( "long") == 0)		return GDF_INT64;
+
+	return GDF_invalid;
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "cudf.h"
+
+/** ---------------------------------------------------------------------------*
+ * @brief Row detection shared by the text readers
+ *
+ * The input is streamed to the device in chunks and scanned for line
+ * terminators, so the whole file never has to fit in device memory.
+ * ---------------------------------------------------------------------------**/
+
+constexpr size_t max_chunk_bytes = 64*1024*1024; // 64MB
+
+using cu_reccnt_t = unsigned long long int;
+using cu_recstart_t = unsigned long long int;
+
+gdf_error launch_countRecords(const char *h_data, size_t h_size,
+                              char terminator, char quotechar,
+                              bool include_first_row, gdf_size_type &rec_cnt);
+
+gdf_error launch_storeRecordStart(const char *h_data, size_t h_size,
+                                  char terminator, char quotechar,
+                                  bool include_first_row,
+                                  cu_recstart_t *rec_starts);
+
+/**---------------------------------------------------------------------------*
+ * @brief Converts a data type name such as "int64" or "date" to a gdf_dtype
+ *
+ * @return The data type, GDF_invalid if the name is not recognized
+ *---------------------------------------------------------------------------**/
+gdf_dtype convertStringToDtype(std::string &dtype);
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include "cudf.h"
+#include "utilities/error_utils.h"
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief The file, mapped or in a host buffer, unmapped when going out of
+ * scope
+ */
+/* ----------------------------------------------------------------------------*/
+class source_file
+{
+ public:
+  source_file() : _data(nullptr), _size(0), _mapped(false) {}
+  ~source_file()
+  {
+    if (_mapped) {
+      munmap(const_cast<uint8_t*>(_data), _size);
+    }
+  }
+
+  gdf_error open_path(const char* path)
+  {
+    int const fd = open(path, O_RDONLY);
+    GDF_REQUIRE(fd >= 0, GDF_FILE_ERROR);
+    struct stat st{};
+    if (fstat(fd, &st) || 0 == st.st_size) {
+      close(fd);
+      return GDF_FILE_ERROR;
+    }
+    void* const map_data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    GDF_REQUIRE(MAP_FAILED != map_data, GDF_FILE_ERROR);
+    _data = static_cast<uint8_t const*>(map_data);
+    _size = st.st_size;
+    _mapped = true;
+    return GDF_SUCCESS;
+  }
+
+  void use_buffer(const char* buffer, size_t size)
+  {
+    _data = reinterpret_cast<uint8_t const*>(buffer);
+    _size = size;
+  }
+
+  uint8_t const* data() const { return _data; }
+  size_t size() const { return _size; }
+
+ private:
+  uint8_t const* _data;
+  size_t _size;
+  bool _mapped;
+};
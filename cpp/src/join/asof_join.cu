@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//As-of join: the nearest right row by key within equal groups
+
+#include <thrust/gather.h>
+#include <thrust/sequence.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "utilities/type_dispatcher.hpp"
+#include "utilities/wrapper_types.hpp"
+#include "dataframe/cudf_table.cuh"
+
+namespace { // unnamed namespace
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Number of ticks of the finest of two time units in one tick of `unit`
+   */
+  /* ----------------------------------------------------------------------------*/
+  int64_t ticks_per_unit(gdf_time_unit unit, gdf_time_unit finest)
+  {
+    auto exponent = [](gdf_time_unit u) {
+      switch (u) {
+        case TIME_UNIT_ms: return 3;
+        case TIME_UNIT_us: return 6;
+        case TIME_UNIT_ns: return 9;
+        default:           return 0;
+      }
+    };
+    int64_t ticks{1};
+    for (int e = exponent(unit); e < exponent(finest); ++e) {
+      ticks *= 10;
+    }
+    return ticks;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Finds the nearest right row of every left row within the range of
+   * right rows of its group, by bisection of the sorted right keys.
+   *
+   * Keys are compared as doubles for floating point columns and as int64
+   * otherwise, scaled to a common time unit.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  struct asof_match
+  {
+    using key_type = std::conditional_t<std::is_floating_point<T>::value, double, int64_t>;
+
+    T const* left_on;
+    gdf_valid_type const* left_valid;
+    T const* right_on;
+    int64_t left_scale;
+    int64_t right_scale;
+    gdf_index_type const* group_begin;
+    gdf_index_type const* group_end;
+    gdf_size_type num_right;
+    gdf_index_type const* right_order;
+    gdf_asof_direction direction;
+    double tolerance;
+    bool allow_exact_matches;
+
+    __device__
+    key_type left_key(gdf_index_type row) const
+    {
+      return static_cast<key_type>(cudf::detail::unwrap(left_on[row])) * left_scale;
+    }
+
+    __device__
+    key_type right_key(gdf_index_type row) const
+    {
+      return static_cast<key_type>(cudf::detail::unwrap(right_on[row])) * right_scale;
+    }
+
+    // First row of [begin, end) whose key is after `key`, or not before it if
+    // `inclusive` is false
+    __device__
+    gdf_index_type first_after(key_type key, bool inclusive,
+                               gdf_index_type begin, gdf_index_type end) const
+    {
+      gdf_size_type count{end - begin};
+      while (count > 0) {
+        gdf_size_type const step{count / 2};
+        key_type const k = right_key(begin + step);
+        if (k < key || (inclusive && k == key)) {
+          begin += step + 1;
+          count -= step + 1;
+        }
+        else {
+          count = step;
+        }
+      }
+      return begin;
+    }
+
+    __device__
+    bool within_tolerance(key_type distance) const
+    {
+      return tolerance < 0 || static_cast<double>(distance) <= tolerance;
+    }
+
+    __device__
+    gdf_index_type operator()(gdf_index_type row) const
+    {
+      if (!gdf_is_valid(left_valid, row)) {
+        return -1;
+      }
+      gdf_index_type const begin = (nullptr == group_begin) ? 0 : group_begin[row];
+      gdf_index_type const end = (nullptr == group_end) ? num_right : group_end[row];
+      key_type const key = left_key(row);
+
+      gdf_index_type match{-1};
+      key_type distance{0};
+      if (GDF_ASOF_FORWARD != direction) {
+        gdf_index_type const p = first_after(key, allow_exact_matches, begin, end) - 1;
+        if (p >= begin) {
+          match = p;
+          distance = key - right_key(p);
+        }
+      }
+      if (GDF_ASOF_BACKWARD != direction) {
+        gdf_index_type const p = first_after(key, !allow_exact_matches, begin, end);
+        // Nearest prefers the backward match on ties
+        if (p < end && (match < 0 || right_key(p) - key < distance)) {
+          match = p;
+          distance = right_key(p) - key;
+        }
+      }
+
+      if (match < 0 || !within_tolerance(distance)) {
+        return -1;
+      }
+      return (nullptr == right_order) ? match : right_order[match];
+    }
+  };
+
+  struct launch_asof_match
+  {
+    template <typename T>
+    void operator()(gdf_column const* left_on, gdf_column const* right_on,
+                    int64_t left_scale, int64_t right_scale,
+                    gdf_index_type const* group_begin, gdf_index_type const* group_end,
+                    gdf_index_type const* right_order,
+                    gdf_asof_direction direction, double tolerance, bool allow_exact_matches,
+                    gdf_index_type* output, cudaStream_t stream)
+    {
+      asof_match<T> match{static_cast<T const*>(left_on->data), left_on->valid,
+                          static_cast<T const*>(right_on->data),
+                          left_scale, right_scale, group_begin, group_end,
+                          right_on->size, right_order, direction, tolerance,
+                          allow_exact_matches};
+      thrust::transform(rmm::exec_policy(stream)->on(stream),
+                        thrust::make_counting_iterator<gdf_index_type>(0),
+                        thrust::make_counting_iterator<gdf_index_type>(left_on->size),
+                        output, match);
+    }
+  };
+
+  struct gather_data
+  {
+    template <typename T>
+    void operator()(void const* data, gdf_index_type const* map, gdf_size_type size,
+                    void* out, cudaStream_t stream)
+    {
+      thrust::gather(rmm::exec_policy(stream)->on(stream), map, map + size,
+                     static_cast<T const*>(data), static_cast<T*>(out));
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Copies of the right columns sorted by the groups and the key
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct sorted_table
+  {
+    std::vector<gdf_column> columns;
+    std::vector<rmm::device_vector<char>> data;
+    std::vector<rmm::device_vector<gdf_valid_type>> valid;
+    rmm::device_vector<gdf_index_type> order;
+
+    gdf_error sort(gdf_column** cols, int ncols, cudaStream_t stream)
+    {
+      gdf_size_type const size{cols[0]->size};
+      order.resize(size);
+      thrust::sequence(rmm::exec_policy(stream)->on(stream), order.begin(), order.end(), 0);
+
+      gdf_column order_col;
+      gdf_error status = gdf_column_view(&order_col, order.data().get(), nullptr, size, GDF_INDEX_DTYPE);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      status = gdf_order_by(cols, nullptr, ncols, &order_col, 1);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+      columns.resize(ncols);
+      for (int c = 0; c < ncols; ++c) {
+        int width{0};
+        status = get_column_byte_width(cols[c], &width);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+        data.emplace_back(static_cast<size_t>(size) * width);
+        cudf::type_dispatcher(cols[c]->dtype, gather_data{}, cols[c]->data,
+                              order.data().get(), size,
+                              static_cast<void*>(data.back().data().get()), stream);
+
+        gdf_valid_type* col_valid{nullptr};
+        if (nullptr != cols[c]->valid && cols[c]->null_count > 0) {
+          valid.emplace_back(gdf_get_num_chars_bitmask(size));
+          col_valid = valid.back().data().get();
+          gather_valid(cols[c]->valid, col_valid, order.data().get(), size, size, stream);
+          CUDA_CHECK_LAST();
+        }
+
+        status = gdf_column_view_augmented(&columns[c], data.back().data().get(), col_valid,
+                                           size, cols[c]->dtype,
+                                           (nullptr != col_valid) ? cols[c]->null_count : 0);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        columns[c].dtype_info = cols[c]->dtype_info;
+      }
+
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+      return GDF_SUCCESS;
+    }
+  };
+
+  bool is_asof_key(gdf_dtype dtype)
+  {
+    switch (dtype) {
+      case GDF_INT8: case GDF_INT16: case GDF_INT32: case GDF_INT64:
+      case GDF_FLOAT32: case GDF_FLOAT64:
+      case GDF_DATE32: case GDF_DATE64: case GDF_TIMESTAMP:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+} // end unnamed namespace
+
+gdf_error gdf_asof_join(gdf_column**       left_by,
+                        gdf_column*        left_on,
+                        gdf_column**       right_by,
+                        gdf_column*        right_on,
+                        int                num_by,
+                        gdf_asof_direction direction,
+                        double             tolerance,
+                        int                allow_exact_matches,
+                        gdf_column*        right_indices,
+                        gdf_context*       ctxt)
+{
+  GDF_REQUIRE(nullptr != left_on && nullptr != right_on && nullptr != right_indices,
+              GDF_DATASET_EMPTY);
+  GDF_REQUIRE(num_by >= 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(0 == num_by || (nullptr != left_by && nullptr != right_by), GDF_DATASET_EMPTY);
+  GDF_REQUIRE(left_on->dtype == right_on->dtype, GDF_DTYPE_MISMATCH);
+  GDF_REQUIRE(is_asof_key(left_on->dtype), GDF_UNSUPPORTED_DTYPE);
+  GDF_REQUIRE(!right_on->valid || !right_on->null_count, GDF_VALIDITY_UNSUPPORTED);
+  GDF_REQUIRE(GDF_INDEX_DTYPE == right_indices->dtype, GDF_UNSUPPORTED_DTYPE);
+  GDF_REQUIRE(right_indices->size == left_on->size, GDF_COLUMN_SIZE_MISMATCH);
+  for (int c = 0; c < num_by; ++c) {
+    GDF_REQUIRE(nullptr != left_by[c] && nullptr != right_by[c], GDF_DATASET_EMPTY);
+    GDF_REQUIRE(left_by[c]->size == left_on->size, GDF_COLUMN_SIZE_MISMATCH);
+    GDF_REQUIRE(right_by[c]->size == right_on->size, GDF_COLUMN_SIZE_MISMATCH);
+  }
+
+  if (0 == left_on->size) {
+    return GDF_SUCCESS;
+  }
+
+  cudaStream_t stream = 0;
+  gdf_error status{GDF_SUCCESS};
+
+  // The right table sorted by the groups, then the key
+  std::vector<gdf_column*> right_cols(right_by, right_by + num_by);
+  right_cols.push_back(right_on);
+  sorted_table sorted;
+  bool const is_sorted{(nullptr != ctxt) && (0 != ctxt->flag_sorted)};
+  if (!is_sorted && right_on->size > 0) {
+    status = sorted.sort(right_cols.data(), right_cols.size(), stream);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    for (size_t c = 0; c < right_cols.size(); ++c) {
+      right_cols[c] = &sorted.columns[c];
+    }
+  }
+
+  // The range of right rows of the group of every left row
+  rmm::device_vector<gdf_index_type> group_begin, group_end;
+  if (num_by > 0) {
+    group_begin.resize(left_on->size);
+    group_end.resize(left_on->size);
+    gdf_column begin_col, end_col;
+    gdf_column_view(&begin_col, group_begin.data().get(), nullptr, left_on->size, GDF_INDEX_DTYPE);
+    gdf_column_view(&end_col, group_end.data().get(), nullptr, left_on->size, GDF_INDEX_DTYPE);
+    status = gdf_search_sorted(right_cols.data(), left_by, num_by, nullptr, 1,
+                               GDF_SEARCH_LEFT, &begin_col);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    status = gdf_search_sorted(right_cols.data(), left_by, num_by, nullptr, 1,
+                               GDF_SEARCH_RIGHT, &end_col);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+  }
+
+  // Timestamps of different units are compared in the finest one
+  int64_t left_scale{1}, right_scale{1};
+  if (GDF_TIMESTAMP == left_on->dtype) {
+    gdf_time_unit const left_unit = left_on->dtype_info.time_unit;
+    gdf_time_unit const right_unit = right_on->dtype_info.time_unit;
+    gdf_time_unit const finest = std::max(left_unit, right_unit);
+    left_scale = ticks_per_unit(left_unit, finest);
+    right_scale = ticks_per_unit(right_unit, finest);
+  }
+
+  cudf::type_dispatcher(left_on->dtype, launch_asof_match{}, left_on, right_cols.back(),
+                        left_scale, right_scale,
+                        (num_by > 0) ? group_begin.data().get() : nullptr,
+                        (num_by > 0) ? group_end.data().get() : nullptr,
+                        is_sorted ? nullptr : sorted.order.data().get(),
+                        direction, tolerance, 0 != allow_exact_matches,
+                        static_cast<gdf_index_type*>(right_indices->data), stream);
+  CUDA_CHECK_LAST();
+
+  CUDA_TRY( cudaStreamSynchronize(stream) );
+  return GDF_SUCCESS;
+}
@@ -24,6 +24,7 @@
 #include "dataframe/cudf_table.cuh"
 #include "rmm/rmm.h"
 #include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
 
 #include <thrust/copy.h>
 #include <thrust/execution_policy.h>
@@ -477,7 +478,7 @@ gdf_error compute_hash_join(
 
   // Allocate device global counter used by threads to determine output write location
   size_type *d_global_write_index{nullptr};
-  RMM_TRY( RMM_ALLOC((void**)&d_global_write_index, sizeof(size_type), 0) ); // TODO non-default stream?
+  SCRATCH_ALLOC_TRY(&d_global_write_index, sizeof(size_type), 0); // TODO non-default stream?
  
   // Because we only have an estimate of the output size, we may need to probe the
   // hash table multiple times until we've found an output buffer size that is large enough
@@ -531,7 +532,7 @@ gdf_error compute_hash_join(
   }
 
   // free memory used for the counters
-  RMM_TRY( RMM_FREE(d_global_write_index, 0) );
+  SCRATCH_FREE_TRY(d_global_write_index, 0);
 
   if (join_type == JoinType::FULL_JOIN) {
       append_full_join_indices(
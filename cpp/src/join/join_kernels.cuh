@@ -51,7 +51,7 @@ __global__ void build_hash_table( multimap_type * const multi_map,
                                   const size_type build_table_num_rows,
                                   gdf_error * gdf_error_code)
 {
-    size_type i = threadIdx.x + blockIdx.x * blockDim.x;
+    size_type i = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
     while( i < build_table_num_rows) {
 
@@ -74,7 +74,7 @@ __global__ void build_hash_table( multimap_type * const multi_map,
           *gdf_error_code = GDF_HASH_TABLE_INSERT_FAILURE;
         }
       }
-      i += blockDim.x * gridDim.x;
+      i += static_cast<size_type>(blockDim.x) * gridDim.x;
     }
 }
 
@@ -145,7 +145,7 @@ __global__ void compute_join_output_size( multimap_type const * const multi_map,
   __syncwarp();
 #endif
 
-  size_type probe_row_index = threadIdx.x + blockIdx.x * blockDim.x;
+  size_type probe_row_index = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
 
 #if defined(CUDA_VERSION) && CUDA_VERSION >= 9000
   const unsigned int activemask = __ballot_sync(0xffffffff, probe_row_index < probe_table_num_rows);
@@ -298,7 +298,7 @@ __global__ void probe_hash_table( multimap_type const * const multi_map,
   __syncwarp();
 #endif
 
-  output_index_type probe_row_index = threadIdx.x + blockIdx.x * blockDim.x;
+  output_index_type probe_row_index = threadIdx.x + static_cast<output_index_type>(blockIdx.x) * blockDim.x;
 
 #if defined(CUDA_VERSION) && CUDA_VERSION >= 9000
   const unsigned int activemask = __ballot_sync(0xffffffff, probe_row_index < probe_table_num_rows);
@@ -481,7 +481,7 @@ __global__ void probe_hash_table_uniq_keys(
     
     __syncthreads();
 
-    size_type i = threadIdx.x + blockIdx.x * blockDim.x;
+    size_type i = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
     if ( i < probe_table_num_rows ) {
         const auto end = multi_map->end();
         auto found = multi_map->find(probe_table[i]);
@@ -21,7 +21,9 @@
 
 #include "cudf.h"
 #include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
 #include "utilities/error_utils.h"
+#include "utilities/cudf_utils.h"
 #include "dataframe/cudf_table.cuh"
 #include "utilities/nvtx/nvtx_utils.h"
 
@@ -29,11 +31,13 @@
 
 using namespace mgpu;
 
-// Size limit due to use of int32 as join output.
-// FIXME: upgrade to 64-bit
-using output_index_type = int;
+// Join outputs are columns of row indices, so their size is limited by gdf_index_type
+using output_index_type = gdf_index_type;
 constexpr output_index_type MAX_JOIN_SIZE{std::numeric_limits<output_index_type>::max()};
 
+// The sort-based join is built on moderngpu, which uses int for sizes and indices
+constexpr gdf_size_type MAX_SORT_JOIN_SIZE{std::numeric_limits<int>::max()};
+
 /* --------------------------------------------------------------------------*/
 /** 
  * @brief Computes the Join result between two tables using the hash-based implementation. 
@@ -97,6 +101,34 @@ struct SortJoin<JoinType::LEFT_JOIN> {
       }
 };
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief  Converts a column of int32 join indices in place to output_index_type
+ * 
+ * @param indices The column of indices, produced by the sort-based join
+ * 
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error widen_join_indices(gdf_column *indices)
+{
+  if (GDF_INDEX_DTYPE == indices->dtype) return GDF_SUCCESS;
+  GDF_REQUIRE(GDF_INT32 == indices->dtype, GDF_UNSUPPORTED_DTYPE);
+
+  if (nullptr == indices->data) {
+    indices->dtype = GDF_INDEX_DTYPE;
+    return GDF_SUCCESS;
+  }
+
+  int32_t *narrow = static_cast<int32_t*>(indices->data);
+  output_index_type *wide{nullptr};
+  RMM_TRY( RMM_ALLOC((void**)&wide, indices->size * sizeof(output_index_type), 0) );
+  thrust::copy(rmm::exec_policy()->on(0), narrow, narrow + indices->size, wide);
+  RMM_TRY( RMM_FREE(narrow, 0) );
+
+  return gdf_column_view(indices, wide, nullptr, indices->size, GDF_INDEX_DTYPE);
+}
+
 template <JoinType join_type, typename T>
 gdf_error sort_join_typed(gdf_column *leftcol, gdf_column *rightcol,
                           gdf_column *left_result, gdf_column *right_result,
@@ -107,6 +139,9 @@ gdf_error sort_join_typed(gdf_column *leftcol, gdf_column *rightcol,
   GDF_REQUIRE(!leftcol->valid  || !leftcol->null_count , GDF_VALIDITY_UNSUPPORTED);
   GDF_REQUIRE(!rightcol->valid || !rightcol->null_count, GDF_VALIDITY_UNSUPPORTED);
 
+  GDF_REQUIRE(leftcol->size < MAX_SORT_JOIN_SIZE, GDF_COLUMN_SIZE_TOO_BIG);
+  GDF_REQUIRE(rightcol->size < MAX_SORT_JOIN_SIZE, GDF_COLUMN_SIZE_TOO_BIG);
+
   rmm_mgpu_context_t context(false);
   SortJoin<join_type> sort_based_join;
   auto output = sort_based_join(static_cast<T*>(leftcol->data), leftcol->size,
@@ -116,6 +151,11 @@ gdf_error sort_join_typed(gdf_column *leftcol, gdf_column *rightcol,
   *right_result = output.second;
   CUDA_CHECK_LAST();
 
+  // Match the index type of the hash-based join
+  err = widen_join_indices(left_result);
+  GDF_REQUIRE(GDF_SUCCESS == err, err);
+  err = widen_join_indices(right_result);
+
   return err;
 }
 
@@ -17,17 +17,269 @@
 
 #include <type_traits>
 #include <algorithm>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <thrust/transform.h>
+#include <thrust/sequence.h>
+#include <thrust/sort.h>
+#include <thrust/fill.h>
+#include <thrust/tabulate.h>
+#include <thrust/scan.h>
+#include <thrust/copy.h>
+#include <cub/device/device_radix_sort.cuh>
 
 #include "cudf.h"
 #include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
+#include "utilities/type_dispatcher.hpp"
+#include "utilities/wrapper_types.hpp"
 
 #include "rmm/thrust_rmm_allocator.h"
 
 #include "../sqls/sqls_rtti_comp.h"
+#include "orderby.h"
 
 namespace{ //annonymus
 
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Unsigned integer type of N bytes
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <size_t N> struct unsigned_bits;
+  template <> struct unsigned_bits<1> { using type = uint8_t; };
+  template <> struct unsigned_bits<2> { using type = uint16_t; };
+  template <> struct unsigned_bits<4> { using type = uint32_t; };
+  template <> struct unsigned_bits<8> { using type = uint64_t; };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Maps an integer to unsigned bits that compare in the same order,
+   * by flipping the sign bit of signed types
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  CUDA_HOST_DEVICE_CALLABLE
+  std::enable_if_t<std::is_integral<T>::value, uint64_t> order_preserving_bits(T value)
+  {
+    using bits_type = typename unsigned_bits<sizeof(T)>::type;
+    bits_type bits = static_cast<bits_type>(value);
+    if (std::is_signed<T>::value) {
+      bits ^= bits_type{1} << (8 * sizeof(T) - 1);
+    }
+    return bits;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Maps an IEEE float to unsigned bits that compare in the same order:
+   * negative values have all bits inverted, positive values the sign bit set.
+   * -0.0 is mapped like +0.0 since they compare equal.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  CUDA_HOST_DEVICE_CALLABLE
+  std::enable_if_t<std::is_floating_point<T>::value, uint64_t> order_preserving_bits(T value)
+  {
+    using bits_type = typename unsigned_bits<sizeof(T)>::type;
+    if (value == T{0}) {
+      value = T{0};
+    }
+    bits_type bits;
+    memcpy(&bits, &value, sizeof(T));
+    bits_type const sign_bit = bits_type{1} << (8 * sizeof(T) - 1);
+    return (bits & sign_bit) ? static_cast<bits_type>(~bits) : static_cast<bits_type>(bits | sign_bit);
+  }
+
+  struct encode_value
+  {
+    template <typename T>
+    CUDA_HOST_DEVICE_CALLABLE
+    uint64_t operator()(void const * data, gdf_index_type row)
+    {
+      return order_preserving_bits(cudf::detail::unwrap(static_cast<T const *>(data)[row]));
+    }
+  };
+
+  struct type_width
+  {
+    template <typename T>
+    int operator()()
+    {
+      return 8 * sizeof(T);
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief A bit field of the normalized sort key: either the order preserving
+   * value of a column or the flag that places its nulls first or last
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct key_field
+  {
+    void const * data;
+    gdf_valid_type const * valid;
+    gdf_dtype dtype;
+    int bits;
+    bool is_null_flag;
+    bool descending;
+    bool nulls_are_smallest;
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Packs a group of key fields, most significant first, into a
+   * 64 bit key for the given row
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct encode_key_group
+  {
+    key_field const * fields;
+    int num_fields;
+
+    __device__
+    uint64_t operator()(gdf_index_type row) const
+    {
+      uint64_t key{0};
+      for (int i = 0; i < num_fields; ++i) {
+        key_field const & field = fields[i];
+        bool const valid = gdf_is_valid(field.valid, row);
+
+        uint64_t bits{0};
+        if (field.is_null_flag) {
+          bits = (valid == field.nulls_are_smallest) ? 1 : 0;
+        } else if (valid) {
+          // All nulls share one value so that they stay tied on this column
+          bits = cudf::type_dispatcher(field.dtype, encode_value{}, field.data, row);
+        }
+
+        if (field.bits == 64) {
+          key = field.descending ? ~bits : bits;
+        } else {
+          uint64_t const field_mask = (uint64_t{1} << field.bits) - 1;
+          key = (key << field.bits) | ((field.descending ? ~bits : bits) & field_mask);
+        }
+      }
+      return key;
+    }
+  };
+
+  bool is_radix_sortable(gdf_dtype dtype)
+  {
+    switch (dtype) {
+      case GDF_INT8: case GDF_INT16: case GDF_INT32: case GDF_INT64:
+      case GDF_FLOAT32: case GDF_FLOAT64:
+      case GDF_DATE32: case GDF_DATE64: case GDF_TIMESTAMP: case GDF_CATEGORY:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Sorts row indices by multiple columns with an LSD radix sort over
+   * normalized keys.
+   *
+   * Every column contributes an order preserving value field and, if it has
+   * nulls, a one bit null flag placed above it; descending columns have their
+   * fields inverted. Starting from the least significant end, the fields are
+   * packed greedily into 64 bit keys. Each key is then built for the current
+   * permutation of the rows and radix sorted over its used bits only. Since the
+   * radix sort is stable, sorting the keys from least to most significant sorts
+   * the rows by all columns.
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error radix_order_by(gdf_column** cols,
+                           std::vector<int8_t> const & asc_desc,
+                           size_t ncols,
+                           gdf_index_type* d_indx,
+                           gdf_size_type nrows,
+                           bool nulls_are_smallest,
+                           cudaStream_t stream)
+  {
+    // Fields from least to most significant
+    std::vector<key_field> fields;
+    for (size_t i = ncols; i-- > 0; ) {
+      gdf_column const * col = cols[i];
+      bool const descending{asc_desc[i] == GDF_ORDER_DESC};
+      bool const has_nulls{(nullptr != col->valid) && (col->null_count > 0)};
+      fields.push_back(key_field{col->data, has_nulls ? col->valid : nullptr, col->dtype,
+                                 cudf::type_dispatcher(col->dtype, type_width{}),
+                                 false, descending, nulls_are_smallest});
+      if (has_nulls) {
+        fields.push_back(key_field{nullptr, col->valid, col->dtype, 1,
+                                   true, descending, nulls_are_smallest});
+      }
+    }
+
+    // Pack fields into groups of at most 64 bits. Within a group the fields are
+    // stored most significant first, which is the order they are shifted in
+    std::vector<key_field> packed_fields;
+    std::vector<int> group_begin, group_bits;
+    for (size_t f = 0; f < fields.size(); ) {
+      int bits{0};
+      size_t last{f};
+      while ((last < fields.size()) && (bits + fields[last].bits <= 64)) {
+        bits += fields[last++].bits;
+      }
+      group_begin.push_back(packed_fields.size());
+      group_bits.push_back(bits);
+      packed_fields.insert(packed_fields.end(), fields.rbegin() + (fields.size() - last),
+                           fields.rbegin() + (fields.size() - f));
+      f = last;
+    }
+    group_begin.push_back(packed_fields.size());
+
+    rmm::device_vector<key_field> d_fields(packed_fields);
+
+    int const num_items{static_cast<int>(nrows)};
+
+    uint64_t *d_keys{nullptr}, *d_keys_alt{nullptr};
+    gdf_index_type *d_indx_alt{nullptr};
+    SCRATCH_ALLOC_TRY(&d_keys, sizeof(uint64_t) * nrows, stream);
+    SCRATCH_ALLOC_TRY(&d_keys_alt, sizeof(uint64_t) * nrows, stream);
+    SCRATCH_ALLOC_TRY(&d_indx_alt, sizeof(gdf_index_type) * nrows, stream);
+
+    cub::DoubleBuffer<uint64_t> keys(d_keys, d_keys_alt);
+    cub::DoubleBuffer<gdf_index_type> values(d_indx, d_indx_alt);
+
+    size_t storage_bytes{0};
+    CUDA_TRY( cub::DeviceRadixSort::SortPairs(nullptr, storage_bytes, keys, values,
+                                              num_items, 0, 64, stream) );
+    void *d_storage{nullptr};
+    SCRATCH_ALLOC_TRY(&d_storage, storage_bytes, stream);
+
+    for (size_t g = 0; g + 1 < group_begin.size(); ++g) {
+      // Build the keys for the rows in their current order
+      thrust::transform(rmm::exec_policy(stream)->on(stream),
+                        values.Current(), values.Current() + nrows,
+                        keys.Current(),
+                        encode_key_group{d_fields.data().get() + group_begin[g],
+                                         group_begin[g + 1] - group_begin[g]});
+
+      CUDA_TRY( cub::DeviceRadixSort::SortPairs(d_storage, storage_bytes, keys, values,
+                                                num_items, 0, group_bits[g], stream) );
+    }
+
+    if (values.Current() != d_indx) {
+      CUDA_TRY( cudaMemcpyAsync(d_indx, values.Current(), sizeof(gdf_index_type) * nrows,
+                                cudaMemcpyDeviceToDevice, stream) );
+    }
+
+    SCRATCH_FREE_TRY(d_storage, stream);
+    SCRATCH_FREE_TRY(d_indx_alt, stream);
+    SCRATCH_FREE_TRY(d_keys_alt, stream);
+    SCRATCH_FREE_TRY(d_keys, stream);
+
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+    return GDF_SUCCESS;
+  }
+
   gdf_error multi_col_order_by(gdf_column** cols,
                                int8_t* asc_desc,
                                size_t ncols,
@@ -37,31 +289,497 @@ namespace{ //annonymus
     GDF_REQUIRE(cols != nullptr && output_indices != nullptr, GDF_DATASET_EMPTY);
     GDF_REQUIRE(cols[0]->size == output_indices->size, GDF_COLUMN_SIZE_MISMATCH);
     /* NOTE: providing support for indexes to be multiple different types explodes compilation time, such that it become infeasible */
-    GDF_REQUIRE(output_indices->dtype == GDF_INT32, GDF_UNSUPPORTED_DTYPE);
+    GDF_REQUIRE(output_indices->dtype == GDF_INDEX_DTYPE, GDF_UNSUPPORTED_DTYPE);
+
+    gdf_size_type const nrows{cols[0]->size};
+    if (0 == nrows) {
+      return GDF_SUCCESS;
+    }
+
+    // Fixed width columns are sorted with a radix sort over normalized keys.
+    // The comparison sort remains for inputs the radix sort cannot handle.
+    bool const radix_sortable{ (nrows <= std::numeric_limits<int>::max()) &&
+                               std::all_of(cols, cols + ncols, [](gdf_column * col){ return is_radix_sortable(col->dtype); }) };
+    if (radix_sortable) {
+      std::vector<int8_t> h_asc_desc(ncols, GDF_ORDER_ASC);
+      if (nullptr != asc_desc) {
+        CUDA_TRY( cudaMemcpy(h_asc_desc.data(), asc_desc, ncols * sizeof(int8_t), cudaMemcpyDeviceToHost) );
+      }
+      thrust::sequence(rmm::exec_policy()->on(0),
+                       static_cast<gdf_index_type*>(output_indices->data),
+                       static_cast<gdf_index_type*>(output_indices->data) + nrows, 0);
+      return radix_order_by(cols, h_asc_desc, ncols, static_cast<gdf_index_type*>(output_indices->data),
+                            nrows, flag_nulls_are_smallest, 0);
+    }
+
+    return comparison_order_by(cols, asc_desc, ncols, output_indices, flag_nulls_are_smallest);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Strict weak ordering of row indices with the gdf_order_by semantics.
+   * Rows that compare equal are ordered by index, so the order is total and
+   * matches a stable sort.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <bool has_nulls>
+  struct row_less
+  {
+    LesserRTTI<gdf_index_type> comp;
+
+    __device__
+    bool operator()(gdf_index_type row1, gdf_index_type row2) const
+    {
+      if (has_nulls) {
+        if (comp.asc_desc_comparison_with_nulls(row1, row2)) return true;
+        if (comp.asc_desc_comparison_with_nulls(row2, row1)) return false;
+      }
+      else {
+        if (comp.asc_desc_comparison(row1, row2)) return true;
+        if (comp.asc_desc_comparison(row2, row1)) return false;
+      }
+      return row1 < row2;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Inserts a row into a binary max-heap of `count` rows whose elements
+   * are `stride` apart
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename Less>
+  __device__
+  void heap_push(gdf_index_type * heap, gdf_size_type stride, gdf_size_type count,
+                 gdf_index_type row, Less const & less)
+  {
+    gdf_size_type j = count;
+    while (j > 0) {
+      gdf_size_type const parent = (j - 1) / 2;
+      gdf_index_type const parent_row = heap[parent * stride];
+      if (!less(parent_row, row)) break;
+      heap[j * stride] = parent_row;
+      j = parent;
+    }
+    heap[j * stride] = row;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Replaces the root of a binary max-heap of `count` rows whose
+   * elements are `stride` apart by a row and restores the heap order
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename Less>
+  __device__
+  void heap_replace_root(gdf_index_type * heap, gdf_size_type stride, gdf_size_type count,
+                         gdf_index_type row, Less const & less)
+  {
+    gdf_size_type j = 0;
+    while (2 * j + 1 < count) {
+      gdf_size_type child = 2 * j + 1;
+      gdf_index_type child_row = heap[child * stride];
+      if (child + 1 < count) {
+        gdf_index_type const right_row = heap[(child + 1) * stride];
+        if (less(child_row, right_row)) {
+          child = child + 1;
+          child_row = right_row;
+        }
+      }
+      if (!less(row, child_row)) break;
+      heap[j * stride] = child_row;
+      j = child;
+    }
+    heap[j * stride] = row;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief The rows of the segments of the input, the first selection round
+   * reads the row indices themselves
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct row_input
+  {
+    gdf_index_type const * segment_offsets;
+    gdf_size_type num_segments;
+    gdf_size_type nrows;
+
+    __device__ gdf_size_type begin(gdf_size_type segment) const {
+      return (nullptr == segment_offsets) ? 0 : segment_offsets[segment];
+    }
+    __device__ gdf_size_type end(gdf_size_type segment) const {
+      return (segment + 1 < num_segments) ? segment_offsets[segment + 1] : nrows;
+    }
+    __device__ gdf_index_type operator[](gdf_size_type i) const { return i; }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief The candidates of the segments left by a previous selection round,
+   * the heaps of segment s fill the slots [lane_offsets[s] * k, lane_offsets[s + 1] * k)
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct candidate_input
+  {
+    gdf_index_type const * candidates;
+    gdf_size_type const * lane_offsets;
+    gdf_size_type k;
+
+    __device__ gdf_size_type begin(gdf_size_type segment) const { return lane_offsets[segment] * k; }
+    __device__ gdf_size_type end(gdf_size_type segment) const { return lane_offsets[segment + 1] * k; }
+    __device__ gdf_index_type operator[](gdf_size_type i) const { return candidates[i]; }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Selects the k first rows of every segment into per thread max-heaps.
+   *
+   * Segment s is processed by the lanes [lane_offsets[s], lane_offsets[s + 1]),
+   * lane l visiting the input positions begin + l, begin + l + lanes, ... A
+   * thread keeps the k first rows it has seen in a binary heap whose root is the
+   * last of them, so a row only costs O(log k) when it displaces the root. The
+   * heaps of the lanes of a segment are interleaved in a block of lanes * k
+   * candidates, unused slots are -1 and are skipped when read back.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename Less, typename Input>
+  __global__
+  void select_top_k(Less less,
+                    Input input,
+                    gdf_size_type const * lane_offsets,
+                    gdf_size_type num_segments,
+                    gdf_size_type num_lanes,
+                    gdf_size_type k,
+                    gdf_index_type * candidates)
+  {
+    gdf_size_type const tid = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+    if (tid >= num_lanes) {
+      return;
+    }
+
+    // The segment of this lane is the last one starting at or before it
+    gdf_size_type first{0}, last{num_segments};
+    while (last - first > 1) {
+      gdf_size_type const middle = first + (last - first) / 2;
+      if (lane_offsets[middle] <= tid) first = middle;
+      else last = middle;
+    }
+    gdf_size_type const segment = first;
+    gdf_size_type const lanes = lane_offsets[segment + 1] - lane_offsets[segment];
+    gdf_size_type const lane = tid - lane_offsets[segment];
+
+    gdf_index_type * const heap = candidates + lane_offsets[segment] * k + lane;
+    gdf_size_type count{0};
+
+    gdf_size_type const end = input.end(segment);
+    for (gdf_size_type i = input.begin(segment) + lane; i < end; i += lanes) {
+      gdf_index_type const row = input[i];
+      if (row < 0) {
+        continue;
+      }
+      if (count < k) {
+        heap_push(heap, lanes, count++, row, less);
+      }
+      else if (less(row, heap[0])) {
+        heap_replace_root(heap, lanes, k, row, less);
+      }
+    }
+
+    for (gdf_size_type j = count; j < k; ++j) {
+      heap[j * lanes] = -1;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Heap sorts the single heap left for every segment and writes it to
+   * the output
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename Less>
+  __global__
+  void sort_top_k(Less less,
+                  gdf_index_type * candidates,
+                  gdf_size_type num_segments,
+                  gdf_size_type k,
+                  gdf_index_type * output)
+  {
+    gdf_size_type const segment = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+    if (segment >= num_segments) {
+      return;
+    }
+
+    gdf_index_type * const heap = candidates + segment * k;
+    gdf_size_type count{0};
+    while ((count < k) && (heap[count] >= 0)) {
+      ++count;
+    }
+
+    // Move the root, the last of the remaining rows, behind the shrinking heap
+    for (gdf_size_type n = count - 1; n > 0; --n) {
+      gdf_index_type const row = heap[n];
+      heap[n] = heap[0];
+      heap_replace_root(heap, 1, n, row, less);
+    }
+
+    for (gdf_size_type j = 0; j < k; ++j) {
+      output[segment * k + j] = heap[j];
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Orders candidate rows, empty slots go last
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename Less>
+  struct candidate_less
+  {
+    Less less;
+
+    __device__
+    bool operator()(gdf_index_type row1, gdf_index_type row2) const
+    {
+      if (row2 < 0) return row1 >= 0;
+      if (row1 < 0) return false;
+      return less(row1, row2);
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Number of lanes of every segment in the first selection round, one
+   * per rows_per_lane rows of the segment but at least one and at most
+   * max_lanes. Position num_segments is 0 so the exclusive scan ends in the total.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct segment_lanes
+  {
+    row_input input;
+    gdf_size_type rows_per_lane;
+    gdf_size_type max_lanes;
+
+    __device__
+    gdf_size_type operator()(gdf_size_type segment) const
+    {
+      if (segment == input.num_segments) return 0;
+      gdf_size_type const lanes = (input.end(segment) - input.begin(segment)) / rows_per_lane;
+      if (lanes < 1) return 1;
+      return (lanes < max_lanes) ? lanes : max_lanes;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Number of lanes of every segment in a merge round, one per
+   * `fanout` heaps of the previous round
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct merged_lanes
+  {
+    gdf_size_type const * lane_offsets;
+    gdf_size_type num_segments;
+    gdf_size_type fanout;
+
+    __device__
+    gdf_size_type operator()(gdf_size_type segment) const
+    {
+      if (segment == num_segments) return 0;
+      return (lane_offsets[segment + 1] - lane_offsets[segment] + fanout - 1) / fanout;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Turns per segment lane counts into offsets and returns the total
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error scan_lanes(rmm::device_vector<gdf_size_type> & lane_offsets,
+                       gdf_size_type & num_lanes,
+                       cudaStream_t stream)
+  {
+    thrust::exclusive_scan(rmm::exec_policy(stream)->on(stream),
+                           lane_offsets.begin(), lane_offsets.end(), lane_offsets.begin());
+    CUDA_TRY( cudaMemcpyAsync(&num_lanes, lane_offsets.data().get() + lane_offsets.size() - 1,
+                              sizeof(gdf_size_type), cudaMemcpyDeviceToHost, stream) );
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+    return GDF_SUCCESS;
+  }
+
+  template <bool has_nulls>
+  gdf_error top_k(LesserRTTI<gdf_index_type> const & comp,
+                  gdf_index_type const * segment_offsets,
+                  gdf_size_type num_segments,
+                  gdf_size_type nrows,
+                  gdf_size_type k,
+                  gdf_index_type * output,
+                  cudaStream_t stream)
+  {
+    // Selection only pays off if every lane sees several times k rows, and
+    // a merge round reduces this many heaps to one
+    constexpr gdf_size_type oversampling{8};
+    constexpr gdf_size_type max_threads{1 << 18};
+    constexpr int block_dim{128};
+
+    row_less<has_nulls> const less{comp};
+    candidate_less<row_less<has_nulls>> const sorted_less{less};
+
+    if ((1 == num_segments) && (nrows < 2 * oversampling * k)) {
+      // A single segment that is not much larger than k: sort all of it
+      rmm::device_vector<gdf_index_type> sorted(std::max(nrows, k), -1);
+      thrust::sequence(rmm::exec_policy(stream)->on(stream), sorted.begin(), sorted.begin() + nrows, 0);
+      thrust::sort(rmm::exec_policy(stream)->on(stream), sorted.begin(), sorted.end(), sorted_less);
+      thrust::copy(rmm::exec_policy(stream)->on(stream), sorted.begin(), sorted.begin() + k, output);
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+      return GDF_SUCCESS;
+    }
+
+    // Size the lanes of every segment from its own length
+    row_input const rows{segment_offsets, num_segments, nrows};
+    gdf_size_type const max_lanes{std::max(gdf_size_type{1}, max_threads / num_segments)};
+    rmm::device_vector<gdf_size_type> lane_offsets(num_segments + 1);
+    thrust::tabulate(rmm::exec_policy(stream)->on(stream), lane_offsets.begin(), lane_offsets.end(),
+                     segment_lanes{rows, oversampling * k, max_lanes});
+    gdf_size_type num_lanes{0};
+    gdf_error gdf_status = scan_lanes(lane_offsets, num_lanes, stream);
+    if (GDF_SUCCESS != gdf_status)
+      return gdf_status;
+
+    rmm::device_vector<gdf_index_type> candidates(num_lanes * k);
+    select_top_k<<<(num_lanes + block_dim - 1) / block_dim, block_dim, 0, stream>>>(
+        less, rows, lane_offsets.data().get(), num_segments, num_lanes, k, candidates.data().get());
+    CUDA_TRY( cudaGetLastError() );
+
+    // Merge the heaps of every segment, oversampling of them per lane, until
+    // a single one is left
+    while (num_lanes > num_segments) {
+      rmm::device_vector<gdf_size_type> merged_offsets(num_segments + 1);
+      thrust::tabulate(rmm::exec_policy(stream)->on(stream), merged_offsets.begin(), merged_offsets.end(),
+                       merged_lanes{lane_offsets.data().get(), num_segments, oversampling});
+      gdf_size_type num_merged{0};
+      gdf_status = scan_lanes(merged_offsets, num_merged, stream);
+      if (GDF_SUCCESS != gdf_status)
+        return gdf_status;
+
+      rmm::device_vector<gdf_index_type> merged(num_merged * k);
+      select_top_k<<<(num_merged + block_dim - 1) / block_dim, block_dim, 0, stream>>>(
+          less, candidate_input{candidates.data().get(), lane_offsets.data().get(), k},
+          merged_offsets.data().get(), num_segments, num_merged, k, merged.data().get());
+      CUDA_TRY( cudaGetLastError() );
+
+      candidates.swap(merged);
+      lane_offsets.swap(merged_offsets);
+      num_lanes = num_merged;
+    }
+
+    if (1 == num_segments) {
+      // A single heap is ordered faster by all threads
+      thrust::sort(rmm::exec_policy(stream)->on(stream), candidates.begin(), candidates.end(), sorted_less);
+      thrust::copy(rmm::exec_policy(stream)->on(stream), candidates.begin(), candidates.end(), output);
+    }
+    else {
+      sort_top_k<<<(num_segments + block_dim - 1) / block_dim, block_dim, 0, stream>>>(
+          less, candidates.data().get(), num_segments, k, output);
+      CUDA_TRY( cudaGetLastError() );
+    }
+
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+    return GDF_SUCCESS;
+  }
+
+  gdf_error multi_col_top_k(gdf_column** cols,
+                            int8_t* asc_desc,
+                            size_t ncols,
+                            gdf_column* segment_offsets,
+                            gdf_size_type k,
+                            gdf_column* output_indices,
+                            bool flag_nulls_are_smallest)
+  {
+    GDF_REQUIRE(cols != nullptr && output_indices != nullptr, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(ncols > 0 && k > 0, GDF_INVALID_API_CALL);
+    GDF_REQUIRE(output_indices->dtype == GDF_INDEX_DTYPE, GDF_UNSUPPORTED_DTYPE);
+
+    gdf_size_type const nrows{cols[0]->size};
+    for (size_t i = 0; i < ncols; ++i) {
+      GDF_REQUIRE(cols[i]->size == nrows, GDF_COLUMN_SIZE_MISMATCH);
+    }
+
+    gdf_size_type num_segments{1};
+    gdf_index_type const * d_segment_offsets{nullptr};
+    if (nullptr != segment_offsets) {
+      GDF_REQUIRE(GDF_INDEX_DTYPE == segment_offsets->dtype, GDF_UNSUPPORTED_DTYPE);
+      GDF_REQUIRE(!segment_offsets->valid || !segment_offsets->null_count, GDF_VALIDITY_UNSUPPORTED);
+      GDF_REQUIRE(segment_offsets->size > 0, GDF_DATASET_EMPTY);
+      num_segments = segment_offsets->size;
+      d_segment_offsets = static_cast<gdf_index_type const*>(segment_offsets->data);
+    }
+    GDF_REQUIRE(output_indices->size == num_segments * k, GDF_COLUMN_SIZE_MISMATCH);
+
+    cudaStream_t stream = 0;
+    gdf_index_type * output = static_cast<gdf_index_type*>(output_indices->data);
+
+    if (0 == nrows) {
+      thrust::fill(rmm::exec_policy(stream)->on(stream), output, output + output_indices->size, -1);
+      return GDF_SUCCESS;
+    }
 
-    // Check for null so we can use a faster sorting comparator 
     bool const have_nulls{ std::any_of(cols, cols + ncols, [](gdf_column * col){ return col->null_count > 0; }) };
 
     rmm::device_vector<void*> d_cols(ncols);
     rmm::device_vector<gdf_valid_type*> d_valids(ncols);
     rmm::device_vector<int> d_types(ncols, 0);
 
-    void** d_col_data = d_cols.data().get();
-    gdf_valid_type** d_valids_data = d_valids.data().get();
-    int* d_col_types = d_types.data().get();
-
-    gdf_error gdf_status = soa_col_info(cols, ncols, d_col_data, d_valids_data, d_col_types);
+    gdf_error gdf_status = soa_col_info(cols, ncols, d_cols.data().get(), d_valids.data().get(), d_types.data().get());
     if(GDF_SUCCESS != gdf_status)
       return gdf_status;
 
-		multi_col_sort(d_col_data, d_valids_data, d_col_types, asc_desc, ncols, cols[0]->size,
-				have_nulls, static_cast<int32_t*>(output_indices->data), flag_nulls_are_smallest);
+    LesserRTTI<gdf_index_type> comp(d_cols.data().get(), d_valids.data().get(), d_types.data().get(),
+                                    asc_desc, ncols, flag_nulls_are_smallest);
 
-    return GDF_SUCCESS;
+    if (have_nulls) {
+      return top_k<true>(comp, d_segment_offsets, num_segments, nrows, k, output, stream);
+    }
+    return top_k<false>(comp, d_segment_offsets, num_segments, nrows, k, output, stream);
   }
 
 } //end unknown namespace
 
+gdf_error comparison_order_by(gdf_column** cols,
+                              int8_t* asc_desc,
+                              size_t ncols,
+                              gdf_column* output_indices,
+                              bool flag_nulls_are_smallest)
+{
+  GDF_REQUIRE(cols != nullptr && output_indices != nullptr, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(cols[0]->size == output_indices->size, GDF_COLUMN_SIZE_MISMATCH);
+  GDF_REQUIRE(output_indices->dtype == GDF_INDEX_DTYPE, GDF_UNSUPPORTED_DTYPE);
+
+  if (0 == cols[0]->size) {
+    return GDF_SUCCESS;
+  }
+
+  // Check for null so we can use a faster sorting comparator 
+  bool const have_nulls{ std::any_of(cols, cols + ncols, [](gdf_column * col){ return col->null_count > 0; }) };
+
+  rmm::device_vector<void*> d_cols(ncols);
+  rmm::device_vector<gdf_valid_type*> d_valids(ncols);
+  rmm::device_vector<int> d_types(ncols, 0);
+
+  void** d_col_data = d_cols.data().get();
+  gdf_valid_type** d_valids_data = d_valids.data().get();
+  int* d_col_types = d_types.data().get();
+
+  gdf_error gdf_status = soa_col_info(cols, ncols, d_col_data, d_valids_data, d_col_types);
+  if(GDF_SUCCESS != gdf_status)
+    return gdf_status;
+
+  multi_col_sort(d_col_data, d_valids_data, d_col_types, asc_desc, ncols, cols[0]->size,
+                 have_nulls, static_cast<gdf_index_type*>(output_indices->data), flag_nulls_are_smallest);
+
+  return GDF_SUCCESS;
+}
+
 /* --------------------------------------------------------------------------*/
 /** 
  * @brief Sorts an array of gdf_column.
@@ -87,3 +805,60 @@ gdf_error gdf_order_by(gdf_column** cols,
 {
   return multi_col_order_by(cols, asc_desc, ncols, output_indices, flag_nulls_are_smallest);
 }
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Finds the first k rows of an array of gdf_column in the order of
+ * gdf_order_by, without sorting all of them.
+ * 
+ * @param[in] cols Array of gdf_columns
+ * @param[in] asc_desc Device array of sort order types for each column
+ * (0 is ascending order and 1 is descending). If NULL is provided defaults
+ * to ascending order for evey column.
+ * @param[in] ncols # columns
+ * @param[in] k # rows to select
+ * @param[out] output_indices Pre-allocated gdf_column of size k to be filled
+ * with the indices of the selected rows
+ * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
+ * smaller than non-nulls or viceversa
+ * 
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_top_k(gdf_column** cols,
+                    int8_t* asc_desc,
+                    size_t ncols,
+                    gdf_size_type k,
+                    gdf_column* output_indices,
+                    int flag_nulls_are_smallest)
+{
+  return multi_col_top_k(cols, asc_desc, ncols, nullptr, k, output_indices, flag_nulls_are_smallest);
+}
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Finds the first k rows of every segment of an array of gdf_column in
+ * the order of gdf_order_by.
+ * 
+ * @param[in] cols Array of gdf_columns
+ * @param[in] asc_desc Device array of sort order types for each column
+ * @param[in] ncols # columns
+ * @param[in] segment_offsets Column with the index of the first row of each segment
+ * @param[in] k # rows to select per segment
+ * @param[out] output_indices Pre-allocated gdf_column of size k * # segments
+ * @param[in] flag_nulls_are_smallest Flag to indicate if nulls are to be considered
+ * smaller than non-nulls or viceversa
+ * 
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error gdf_segmented_top_k(gdf_column** cols,
+                              int8_t* asc_desc,
+                              size_t ncols,
+                              gdf_column* segment_offsets,
+                              gdf_size_type k,
+                              gdf_column* output_indices,
+                              int flag_nulls_are_smallest)
+{
+  return multi_col_top_k(cols, asc_desc, ncols, segment_offsets, k, output_indices, flag_nulls_are_smallest);
+}
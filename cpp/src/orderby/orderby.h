@@ -0,0 +1,32 @@
+#ifndef GDF_ORDERBY_H
+#define GDF_ORDERBY_H
+
+#include "cudf.h"
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Computes the gdf_order_by permutation with the comparison sort
+ *
+ * gdf_order_by takes this path for the inputs the radix sort cannot handle,
+ * i.e., columns that are not fixed width or more rows than fit into an int.
+ * It works for any sortable dtype, so it can also be called on fixed width
+ * columns to check the radix sort against it.
+ *
+ * @param[in] cols Array of gdf_columns, all of the same size
+ * @param[in] asc_desc Device array of sort order types for each column, NULL
+ * for ascending order of every column
+ * @param[in] ncols # columns
+ * @param[out] output_indices Pre-allocated gdf_column of GDF_INDEX_DTYPE and
+ * the size of the columns, filled with the sorted indices
+ * @param[in] flag_nulls_are_smallest Whether nulls sort before non-nulls
+ *
+ * @returns GDF_SUCCESS upon successful completion
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error comparison_order_by(gdf_column** cols,
+                              int8_t* asc_desc,
+                              size_t ncols,
+                              gdf_column* output_indices,
+                              bool flag_nulls_are_smallest);
+
+#endif
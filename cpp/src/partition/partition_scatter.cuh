@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PARTITION_SCATTER_CUH
+#define PARTITION_SCATTER_CUH
+
+#include <thrust/scan.h>
+
+#include "cudf.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
+#include "dataframe/cudf_table.cuh"
+
+constexpr int BLOCK_SIZE = 256;
+constexpr int ROWS_PER_THREAD = 1;
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief  Given an array of partition numbers, computes the final output location
+   for each element in the output such that all rows with the same partition are 
+   contiguous in memory.
+ * 
+ * @param row_partition_numbers The array that records the partition number for each row
+ * @param num_rows The number of rows
+ * @param num_partitions THe number of partitions
+ * @param[out] block_partition_offsets Array that holds the offset of each partition for each thread block,
+ * i.e., { {block0 partition0 offset, block1 partition0 offset, ...}, 
+         {block0 partition1 offset, block1 partition1 offset, ...},
+         ...
+         {block0 partition(num_partitions-1) offset, block1 partition(num_partitions -1) offset, ...} }
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename size_type>
+__global__ 
+void compute_row_output_locations(size_type * row_partition_numbers, 
+                                  const size_type num_rows,
+                                  const size_type num_partitions,
+                                  size_type * block_partition_offsets)
+{
+  // Shared array that holds the offset of this blocks partitions in 
+  // global memory
+  extern __shared__ size_type shared_partition_offsets[];
+
+  // Initialize array of this blocks offsets from global array
+  size_type partition_number= threadIdx.x;
+  while(partition_number < num_partitions)
+  {
+    shared_partition_offsets[partition_number] = block_partition_offsets[partition_number * gridDim.x + blockIdx.x];
+    partition_number += blockDim.x;
+  }
+  __syncthreads();
+
+  size_type row_number = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
+
+  // Get each row's partition number, and get it's output location by 
+  // incrementing block's offset counter for that partition number
+  // and store the row's output location in-place
+  while( row_number < num_rows )
+  {
+    // Get partition number of this row
+    const size_type partition_number = row_partition_numbers[row_number];
+
+    // Get output location based on partition number by incrementing the corresponding
+    // partition offset for this block
+    const size_type row_output_location = atomicAdd(&(shared_partition_offsets[partition_number]), size_type(1));
+
+    // Store the row's output location in-place
+    row_partition_numbers[row_number] = row_output_location;
+
+    row_number += static_cast<size_type>(blockDim.x) * gridDim.x;
+  }
+}
+
+
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief  Computes the number of rows in each partition both for each thread
+ * block as well as across all blocks, given the partition number of each row.
+ * 
+ * @param[in] row_partition_numbers The partition number of each row
+ * @param[in] num_rows The number of rows
+ * @param[in] num_partitions The number of partitions
+ * @param[out] block_partition_sizes Array that holds the number of rows in each
+ * partition for each thread block, partition major like in compute_row_partition_numbers
+ * @param[out] global_partition_sizes The number of rows in each partition.
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename size_type>
+__global__ 
+void compute_partition_sizes(size_type const * row_partition_numbers,
+                             const size_type num_rows,
+                             const size_type num_partitions,
+                             size_type * block_partition_sizes,
+                             size_type * global_partition_sizes)
+{
+  extern __shared__ size_type shared_partition_sizes[];
+
+  size_type partition_number = threadIdx.x;
+  while(partition_number < num_partitions)
+  {
+    shared_partition_sizes[partition_number] = 0;
+    partition_number += blockDim.x;
+  }
+
+  __syncthreads();
+
+  size_type row_number = threadIdx.x + static_cast<size_type>(blockIdx.x) * blockDim.x;
+  while( row_number < num_rows)
+  {
+    atomicAdd(&(shared_partition_sizes[row_partition_numbers[row_number]]), size_type(1));
+    row_number += static_cast<size_type>(blockDim.x) * gridDim.x;
+  }
+
+  __syncthreads();
+
+  partition_number = threadIdx.x;
+  while(partition_number < num_partitions)
+  {
+    const size_type block_partition_size = shared_partition_sizes[partition_number];
+    atomicAdd(&global_partition_sizes[partition_number], block_partition_size);
+    block_partition_sizes[partition_number * gridDim.x + blockIdx.x] = block_partition_size;
+    partition_number += blockDim.x;
+  }
+}
+
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Rearranges the rows of an input gdf_table such that rows in the same
+ * partition are contiguous, given the partition number of every row and the
+ * number of rows of every partition in every thread block.
+ * 
+ * @param[in] input_table The table to partition
+ * @param[in] num_partitions The number of partitions
+ * @param[in] grid_size The number of thread blocks the sizes were computed by
+ * @param[in,out] row_partition_numbers The partition number of every row,
+ * overwritten by its output location. Freed on success.
+ * @param[in,out] block_partition_sizes The number of rows of every partition
+ * in every block, partition major. Freed on success.
+ * @param[in,out] global_partition_sizes The number of rows of every partition.
+ * Freed on success.
+ * @param[out] partition_offsets Host array where partition_offsets[i]
+ * indicates the starting position of partition 'i'
+ * @param[out] partitioned_output Preallocated gdf_columns to hold the rearrangement
+ * of the input columns
+ * @param[in] stream The stream the scratch arrays were computed on
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename size_type>
+gdf_error scatter_to_partitions(gdf_table<size_type> const & input_table,
+                                const size_type num_partitions,
+                                const size_type grid_size,
+                                size_type * row_partition_numbers,
+                                size_type * block_partition_sizes,
+                                size_type * global_partition_sizes,
+                                size_type * partition_offsets,
+                                gdf_table<size_type> & partitioned_output,
+                                cudaStream_t stream)
+{
+  const size_type num_rows = input_table.get_column_length();
+
+  // Compute exclusive scan of all blocks' partition sizes in-place to determine 
+  // the starting point for each blocks portion of each partition in the output
+  size_type * scanned_block_partition_sizes{block_partition_sizes};
+  thrust::exclusive_scan(rmm::exec_policy(stream)->on(stream),
+                         block_partition_sizes, 
+                         block_partition_sizes + (grid_size * num_partitions), 
+                         scanned_block_partition_sizes);
+  CUDA_CHECK_LAST();
+
+
+  // Compute exclusive scan of size of each partition to determine offset location
+  // of each partition in final output. This can be done independently on a separate stream
+  // once the sizes are computed
+  cudaEvent_t sizes_computed{};
+  CUDA_TRY( cudaEventCreateWithFlags(&sizes_computed, cudaEventDisableTiming) );
+  CUDA_TRY( cudaEventRecord(sizes_computed, stream) );
+  cudaStream_t s1{};
+  cudaStreamCreate(&s1);
+  CUDA_TRY( cudaStreamWaitEvent(s1, sizes_computed, 0) );
+  CUDA_TRY( cudaEventDestroy(sizes_computed) );
+  size_type * scanned_global_partition_sizes{global_partition_sizes};
+  thrust::exclusive_scan(rmm::exec_policy(s1)->on(s1),
+                         global_partition_sizes, 
+                         global_partition_sizes + num_partitions,
+                         scanned_global_partition_sizes);
+  CUDA_CHECK_LAST();
+
+  // Copy the result of the exlusive scan to the output offsets array
+  // to indicate the starting point for each partition in the output
+  CUDA_TRY(cudaMemcpyAsync(partition_offsets, 
+                           scanned_global_partition_sizes, 
+                           num_partitions * sizeof(size_type),
+                           cudaMemcpyDeviceToHost,
+                           s1));
+
+  // Compute the output location for each row in-place based on it's 
+  // partition number such that each partition will be contiguous in memory
+  size_type * row_output_locations{row_partition_numbers};
+  compute_row_output_locations
+  <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type), stream>>>(row_output_locations,
+                                                                          num_rows,
+                                                                          num_partitions,
+                                                                          scanned_block_partition_sizes);
+
+  CUDA_CHECK_LAST();
+
+  // The scatter runs on streams of its own
+  if (0 != stream) {
+    CUDA_TRY( cudaStreamSynchronize(stream) );
+  }
+
+  // Creates the partitioned output table by scattering the rows of
+  // the input table to rows of the output table based on each rows
+  // output location
+  gdf_error gdf_error_code = input_table.scatter(partitioned_output,
+                                                 row_output_locations);
+
+  if(GDF_SUCCESS != gdf_error_code){
+    return gdf_error_code;
+  }
+
+  CUDA_CHECK_LAST();
+
+  SCRATCH_FREE_TRY(row_partition_numbers, stream);
+  SCRATCH_FREE_TRY(block_partition_sizes, stream);
+
+  cudaStreamSynchronize(s1);
+  cudaStreamDestroy(s1);
+  SCRATCH_FREE_TRY(global_partition_sizes, stream);
+
+  return GDF_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <thrust/tabulate.h>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "rmm/thrust_rmm_allocator.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
+#include "dataframe/cudf_table.cuh"
+#include "hash/hash_functions.cuh"
+#include "utilities/nvtx/nvtx_utils.h"
+#include "partition/partition_scatter.cuh"
+
+namespace {
+
+  // Sample rows per partition when choosing the splitters
+  constexpr gdf_size_type SAMPLES_PER_PARTITION = 32;
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Picks one row in each of sample_size equal strides of the table, at
+   * a pseudo random position in its stride so periodic inputs do not alias
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct sample_row
+  {
+    gdf_size_type num_rows;
+    gdf_size_type sample_size;
+
+    __device__
+    gdf_index_type operator()(gdf_index_type i) const
+    {
+      const int64_t begin = static_cast<int64_t>(i) * num_rows / sample_size;
+      const int64_t end = static_cast<int64_t>(i + 1) * num_rows / sample_size;
+      return begin + MurmurHash3_32<gdf_index_type>{}(i) % (end - begin);
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Picks the row of the sorted sample that ends each partition but
+   * the last, so the splitters split the sample evenly
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct splitter_row
+  {
+    gdf_index_type const * sample_rows;
+    gdf_index_type const * sample_order;
+    gdf_size_type sample_size;
+    gdf_size_type num_partitions;
+
+    __device__
+    gdf_index_type operator()(gdf_index_type k) const
+    {
+      return sample_rows[sample_order[(static_cast<int64_t>(k) + 1) * sample_size / num_partitions]];
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Gathers rows of the input columns into new columns, which have a
+   * validity mask and a null count if the input column has a mask
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct gathered_columns
+  {
+    std::vector<rmm::device_vector<char>> data;
+    std::vector<rmm::device_vector<gdf_valid_type>> valid;
+    std::vector<gdf_column> columns;
+    std::vector<gdf_column *> column_ptrs;
+
+    gdf_error gather(int num_cols, gdf_column * input[],
+                     rmm::device_vector<gdf_index_type> const & row_map)
+    {
+      const gdf_size_type size = row_map.size();
+      data.resize(num_cols);
+      valid.resize(num_cols);
+      columns.resize(num_cols);
+      column_ptrs.resize(num_cols);
+      for (int c = 0; c < num_cols; ++c) {
+        int width{0};
+        gdf_error status = get_column_byte_width(input[c], &width);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        data[c].resize(static_cast<size_t>(size) * width);
+        if (nullptr != input[c]->valid) {
+          valid[c].resize(gdf_get_num_chars_bitmask(size));
+        }
+        columns[c] = *input[c];
+        columns[c].data = data[c].data().get();
+        columns[c].valid = valid[c].empty() ? nullptr : valid[c].data().get();
+        columns[c].size = size;
+        columns[c].null_count = 0;
+        column_ptrs[c] = &columns[c];
+      }
+
+      std::unique_ptr< gdf_table<gdf_size_type> > input_table{new gdf_table<gdf_size_type>(num_cols, input)};
+      std::unique_ptr< gdf_table<gdf_size_type> > output_table{new gdf_table<gdf_size_type>(num_cols, column_ptrs.data())};
+      gdf_error status = input_table->gather(row_map, *output_table);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+      for (auto & column : columns) {
+        if (nullptr != column.valid) {
+          gdf_size_type valid_count{0};
+          status = gdf_count_nonzero_mask(column.valid, size, &valid_count);
+          GDF_REQUIRE(GDF_SUCCESS == status, status);
+          column.null_count = size - valid_count;
+        }
+      }
+      return GDF_SUCCESS;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Computes the range partition of every row: the number of
+   * splitters it does not go before in the order of gdf_order_by. The
+   * splitters are chosen by sorting a sample of the rows.
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error compute_range_partition_numbers(int num_cols, gdf_column * input[],
+                                            int8_t * asc_desc, int flag_nulls_are_smallest,
+                                            gdf_size_type num_partitions,
+                                            gdf_size_type * row_partition_numbers)
+  {
+    const gdf_size_type num_rows = input[0]->size;
+    const gdf_size_type sample_size = std::min(num_rows, num_partitions * SAMPLES_PER_PARTITION);
+    cudaStream_t stream = 0;
+
+    // Sort a sample of the rows
+    rmm::device_vector<gdf_index_type> sample_rows(sample_size);
+    thrust::tabulate(rmm::exec_policy(stream)->on(stream),
+                     sample_rows.begin(), sample_rows.end(),
+                     sample_row{num_rows, sample_size});
+    gathered_columns sample;
+    gdf_error status = sample.gather(num_cols, input, sample_rows);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    rmm::device_vector<gdf_index_type> sample_order(sample_size);
+    gdf_column order_column{};
+    order_column.data = sample_order.data().get();
+    order_column.size = sample_size;
+    order_column.dtype = GDF_INDEX_DTYPE;
+    status = gdf_order_by(sample.column_ptrs.data(), asc_desc, num_cols, &order_column,
+                          flag_nulls_are_smallest);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    // Every partition but the last ends at a splitter
+    rmm::device_vector<gdf_index_type> splitter_rows(num_partitions - 1);
+    thrust::tabulate(rmm::exec_policy(stream)->on(stream),
+                     splitter_rows.begin(), splitter_rows.end(),
+                     splitter_row{sample_rows.data().get(), sample_order.data().get(),
+                                  sample_size, num_partitions});
+    gathered_columns splitters;
+    status = splitters.gather(num_cols, input, splitter_rows);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    // Rows equal to a splitter go after it, so equal rows share a partition
+    gdf_column partition_numbers{};
+    partition_numbers.data = row_partition_numbers;
+    partition_numbers.size = num_rows;
+    partition_numbers.dtype = GDF_INDEX_DTYPE;
+    return gdf_search_sorted(splitters.column_ptrs.data(), input, num_cols, asc_desc,
+                             flag_nulls_are_smallest, GDF_SEARCH_RIGHT, &partition_numbers);
+  }
+
+} // end unnamed namespace
+
+gdf_error gdf_range_partition(int num_input_cols,
+                              gdf_column * input[],
+                              int8_t * asc_desc,
+                              int flag_nulls_are_smallest,
+                              int num_partitions,
+                              gdf_column * partitioned_output[],
+                              gdf_size_type partition_offsets[])
+{
+  using size_type = gdf_size_type;
+
+  if((0 >= num_input_cols)
+      || (0 >= num_partitions)
+      || (nullptr == input)
+      || (nullptr == partitioned_output)
+      || (nullptr == partition_offsets))
+  {
+    return GDF_INVALID_API_CALL;
+  }
+
+  const gdf_size_type num_rows{input[0]->size};
+
+  // check that the columns have fixed width types, data, matching types,
+  // and the same number of rows
+  for (size_type i = 0; i < num_input_cols; i++) {
+    if((input[i]->dtype <= GDF_invalid) || (input[i]->dtype >= GDF_STRING))
+      return GDF_UNSUPPORTED_DTYPE;
+
+    if((num_rows > 0) && ((nullptr == input[i]->data)
+                          || (nullptr == partitioned_output[i]->data)))
+      return GDF_DATASET_EMPTY;
+
+    if(input[i]->dtype != partitioned_output[i]->dtype) 
+      return GDF_PARTITION_DTYPE_MISMATCH;
+
+    if((num_rows != input[i]->size) 
+        || (num_rows != partitioned_output[i]->size))
+      return GDF_COLUMN_SIZE_MISMATCH;
+  }
+
+  // If the input is empty, every partition is empty
+  if(0 == num_rows)
+  {
+    std::fill(partition_offsets, partition_offsets + num_partitions, 0);
+    return GDF_SUCCESS;
+  }
+
+  PUSH_RANGE("LIBGDF_RANGE_PARTITION", PARTITION_COLOR);
+
+  cudaStream_t stream = 0;
+  constexpr int rows_per_block = BLOCK_SIZE * ROWS_PER_THREAD;
+  const size_type grid_size = (num_rows + rows_per_block - 1) / rows_per_block;
+
+  size_type * row_partition_numbers{nullptr};
+  SCRATCH_ALLOC_TRY(&row_partition_numbers, num_rows * sizeof(size_type), stream);
+  size_type * block_partition_sizes{nullptr};
+  SCRATCH_ALLOC_TRY(&block_partition_sizes, (grid_size * num_partitions) * sizeof(size_type), stream);
+  size_type * global_partition_sizes{nullptr};
+  SCRATCH_ALLOC_TRY(&global_partition_sizes, num_partitions * sizeof(size_type), stream);
+  CUDA_TRY( cudaMemsetAsync(global_partition_sizes, 0, num_partitions * sizeof(size_type), stream) );
+
+  gdf_error gdf_status{GDF_SUCCESS};
+  if(1 == num_partitions)
+  {
+    CUDA_TRY( cudaMemsetAsync(row_partition_numbers, 0, num_rows * sizeof(size_type), stream) );
+  }
+  else
+  {
+    gdf_status = compute_range_partition_numbers(num_input_cols, input, asc_desc,
+                                                 flag_nulls_are_smallest, num_partitions,
+                                                 row_partition_numbers);
+  }
+
+  if(GDF_SUCCESS == gdf_status)
+  {
+    compute_partition_sizes
+    <<<grid_size, BLOCK_SIZE, num_partitions * sizeof(size_type), stream>>>(row_partition_numbers,
+                                                                            num_rows,
+                                                                            num_partitions,
+                                                                            block_partition_sizes,
+                                                                            global_partition_sizes);
+    CUDA_CHECK_LAST();
+
+    std::unique_ptr< const gdf_table<size_type> > input_table{new gdf_table<size_type>(num_input_cols, input)};
+    std::unique_ptr< gdf_table<size_type> > output_table{new gdf_table<size_type>(num_input_cols, partitioned_output)};
+
+    gdf_status = scatter_to_partitions(*input_table, static_cast<size_type>(num_partitions), grid_size,
+                                       row_partition_numbers, block_partition_sizes,
+                                       global_partition_sizes, partition_offsets,
+                                       *output_table, stream);
+
+    // The output is a permutation of the input
+    for (size_type i = 0; i < num_input_cols; i++) {
+      if(nullptr != partitioned_output[i]->valid)
+        partitioned_output[i]->null_count = input[i]->null_count;
+    }
+  }
+  else
+  {
+    SCRATCH_FREE_TRY(row_partition_numbers, stream);
+    SCRATCH_FREE_TRY(block_partition_sizes, stream);
+    SCRATCH_FREE_TRY(global_partition_sizes, stream);
+  }
+
+  POP_RANGE();
+
+  return gdf_status;
+}
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//Approximate quantile sketches built on the device
+
+#include <thrust/copy.h>
+#include <thrust/sort.h>
+#include <thrust/reduce.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+
+#include "cudf.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "utilities/type_dispatcher.hpp"
+#include "rmm/thrust_rmm_allocator.h"
+
+#include "quantile_sketch.h"
+
+namespace{ //unknown
+
+  gdf_quantile_sketch_type* cffi_wrap(QuantileSketch* obj){
+    return reinterpret_cast<gdf_quantile_sketch_type*>(obj);
+  }
+
+  QuantileSketch* cffi_unwrap(gdf_quantile_sketch_type* hdl){
+    return reinterpret_cast<QuantileSketch*>(hdl);
+  }
+
+  template<typename T>
+  struct is_valid_value
+  {
+    const T* data;
+    const gdf_valid_type* valid;
+
+    CUDA_DEVICE_CALLABLE bool operator()(gdf_size_type i) const
+    {
+      double const value = static_cast<double>(data[i]);
+      return gdf_is_valid(valid, i) && (value == value);
+    }
+  };
+
+  template<typename T>
+  struct to_double
+  {
+    CUDA_DEVICE_CALLABLE double operator()(T value) const
+    {
+      return static_cast<double>(value);
+    }
+  };
+
+  // Index of the unit interval of the scale function holding the i-th of n
+  // sorted values
+  struct scale_bucket
+  {
+    gdf_size_type n;
+    int compression;
+
+    CUDA_DEVICE_CALLABLE int operator()(gdf_size_type i) const
+    {
+      double const q = (static_cast<double>(i) + 0.5) / static_cast<double>(n);
+      return static_cast<int>(floor(compression / (2.0 * M_PI) * asin(2.0 * q - 1.0)));
+    }
+  };
+
+  struct to_centroid
+  {
+    CUDA_DEVICE_CALLABLE Centroid operator()(double value) const
+    {
+      return Centroid{value, 1.0};
+    }
+  };
+
+  struct merge_centroids
+  {
+    CUDA_DEVICE_CALLABLE Centroid operator()(Centroid a, Centroid b) const
+    {
+      double const weight = a.weight + b.weight;
+      return Centroid{a.mean + (b.mean - a.mean) * b.weight / weight, weight};
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Summarizes the valid values of a column into centroids: the values
+   * are sorted and every unit interval of the scale function is reduced to a
+   * single centroid. Only the centroids are copied to the host.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct build_centroids
+  {
+    template<typename ColType,
+             typename std::enable_if_t<std::is_arithmetic<ColType>::value>* = nullptr>
+    gdf_error operator()(gdf_column* col,
+                         int compression,
+                         std::vector<Centroid>& centroids,
+                         double& lo,
+                         double& hi)
+    {
+      cudaStream_t stream = 0;
+      const ColType* data = static_cast<const ColType*>(col->data);
+
+      rmm::device_vector<double> values(col->size);
+      auto values_end = thrust::copy_if(rmm::exec_policy(stream)->on(stream),
+                                        thrust::make_transform_iterator(data, to_double<ColType>{}),
+                                        thrust::make_transform_iterator(data + col->size, to_double<ColType>{}),
+                                        thrust::make_counting_iterator<gdf_size_type>(0),
+                                        values.begin(),
+                                        is_valid_value<ColType>{data, col->valid});
+      gdf_size_type const n = values_end - values.begin();
+      if (0 == n)
+        return GDF_SUCCESS;
+
+      thrust::sort(rmm::exec_policy(stream)->on(stream), values.begin(), values_end);
+
+      rmm::device_vector<int> buckets(n);
+      rmm::device_vector<Centroid> d_centroids(n);
+      auto ends = thrust::reduce_by_key(rmm::exec_policy(stream)->on(stream),
+                                        thrust::make_transform_iterator(thrust::make_counting_iterator<gdf_size_type>(0),
+                                                                        scale_bucket{n, compression}),
+                                        thrust::make_transform_iterator(thrust::make_counting_iterator<gdf_size_type>(n),
+                                                                        scale_bucket{n, compression}),
+                                        thrust::make_transform_iterator(values.begin(), to_centroid{}),
+                                        buckets.begin(),
+                                        d_centroids.begin(),
+                                        thrust::equal_to<int>(),
+                                        merge_centroids{});
+      CUDA_CHECK_LAST();
+
+      centroids.resize(ends.second - d_centroids.begin());
+      CUDA_TRY( cudaMemcpyAsync(centroids.data(), d_centroids.data().get(), centroids.size() * sizeof(Centroid),
+                                cudaMemcpyDeviceToHost, stream) );
+      CUDA_TRY( cudaMemcpyAsync(&lo, values.data().get(), sizeof(double), cudaMemcpyDeviceToHost, stream) );
+      CUDA_TRY( cudaMemcpyAsync(&hi, values.data().get() + n - 1, sizeof(double), cudaMemcpyDeviceToHost, stream) );
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+
+      return GDF_SUCCESS;
+    }
+
+    template<typename ColType,
+             typename std::enable_if_t<!std::is_arithmetic<ColType>::value>* = nullptr>
+    gdf_error operator()(gdf_column* col,
+                         int compression,
+                         std::vector<Centroid>& centroids,
+                         double& lo,
+                         double& hi)
+    {
+      return GDF_UNSUPPORTED_DTYPE;
+    }
+  };
+
+}//unknown namespace
+
+gdf_quantile_sketch_type* gdf_quantile_sketch(int compression)
+{
+  return cffi_wrap(new QuantileSketch(compression));
+}
+
+gdf_error gdf_quantile_sketch_free(gdf_quantile_sketch_type* hdl)
+{
+  delete cffi_unwrap(hdl);
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_quantile_sketch_add(gdf_quantile_sketch_type* hdl, gdf_column* col)
+{
+  GDF_REQUIRE(nullptr != hdl && nullptr != col, GDF_DATASET_EMPTY);
+  if (0 == col->size)
+    return GDF_SUCCESS;
+  GDF_REQUIRE(nullptr != col->data, GDF_DATASET_EMPTY);
+
+  QuantileSketch* sketch = cffi_unwrap(hdl);
+
+  std::vector<Centroid> centroids;
+  double lo{0}, hi{0};
+  gdf_error status = cudf::type_dispatcher(col->dtype, build_centroids{},
+                                           col, sketch->compression, centroids, lo, hi);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+  sketch->add(centroids, lo, hi);
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_quantile_sketch_merge(gdf_quantile_sketch_type* hdl, gdf_quantile_sketch_type* other)
+{
+  GDF_REQUIRE(nullptr != hdl && nullptr != other, GDF_DATASET_EMPTY);
+  cffi_unwrap(hdl)->merge(*cffi_unwrap(other));
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_quantile_sketch_query(gdf_quantile_sketch_type* hdl,
+                                    const double* q,
+                                    int num_quantiles,
+                                    double* results)
+{
+  GDF_REQUIRE(nullptr != hdl, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(num_quantiles >= 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(0 == num_quantiles || (nullptr != q && nullptr != results), GDF_DATASET_EMPTY);
+
+  QuantileSketch const* sketch = cffi_unwrap(hdl);
+  for (int i = 0; i < num_quantiles; ++i)
+    results[i] = sketch->query(q[i]);
+  return GDF_SUCCESS;
+}
+
+size_t gdf_quantile_sketch_serialized_size(gdf_quantile_sketch_type* hdl)
+{
+  return (nullptr == hdl) ? 0 : cffi_unwrap(hdl)->serialized_size();
+}
+
+gdf_error gdf_quantile_sketch_serialize(gdf_quantile_sketch_type* hdl, void* buffer, size_t buffer_size)
+{
+  GDF_REQUIRE(nullptr != hdl && nullptr != buffer, GDF_DATASET_EMPTY);
+  QuantileSketch const* sketch = cffi_unwrap(hdl);
+  GDF_REQUIRE(buffer_size >= sketch->serialized_size(), GDF_INVALID_API_CALL);
+  sketch->serialize(buffer);
+  return GDF_SUCCESS;
+}
+
+gdf_quantile_sketch_type* gdf_quantile_sketch_deserialize(const void* buffer, size_t buffer_size)
+{
+  QuantileSketch* sketch = new QuantileSketch();
+  if (!sketch->deserialize(buffer, buffer_size)) {
+    delete sketch;
+    return nullptr;
+  }
+  return cffi_wrap(sketch);
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+//Mergeable approximate quantile sketch (merging t-digest)
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief A cluster of nearby values summarized by their mean and count
+ */
+/* ----------------------------------------------------------------------------*/
+struct Centroid {
+  double mean;
+  double weight;
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  A merging t-digest.
+ *
+ * The sketch keeps a list of centroids sorted by mean. The size of a centroid
+ * is limited by the scale function k(q) = compression / (2 pi) * asin(2q - 1):
+ * a centroid may only span a unit interval of k. Centroids are therefore
+ * small near the tails, where quantiles need the most precision, and the
+ * sketch holds O(compression) centroids no matter how much data it has seen.
+ *
+ * Merging two sketches concatenates their centroids and compresses them
+ * again, so sketches built per batch or per partition can be combined in
+ * any order without the raw data.
+ */
+/* ----------------------------------------------------------------------------*/
+struct QuantileSketch {
+
+  static constexpr int default_compression{100};
+
+  explicit QuantileSketch(int compression = default_compression)
+    : compression(compression > 0 ? compression : default_compression),
+      total_weight(0),
+      min(std::numeric_limits<double>::infinity()),
+      max(-std::numeric_limits<double>::infinity())
+  {}
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The scale function, mapping a quantile to the centroid index space
+   */
+  /* ----------------------------------------------------------------------------*/
+  static double scale(double q, int compression) {
+    q = std::min(std::max(q, 0.0), 1.0);
+    return compression / (2.0 * M_PI) * std::asin(2.0 * q - 1.0);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Adds centroids sorted by mean, summarizing values in [lo, hi]
+   */
+  /* ----------------------------------------------------------------------------*/
+  void add(std::vector<Centroid> const& sorted, double lo, double hi) {
+    if (sorted.empty())
+      return;
+
+    std::vector<Centroid> merged(centroids.size() + sorted.size());
+    std::merge(centroids.begin(), centroids.end(), sorted.begin(), sorted.end(), merged.begin(),
+               [](Centroid const& a, Centroid const& b) { return a.mean < b.mean; });
+
+    for (auto const& c : sorted)
+      total_weight += c.weight;
+    min = std::min(min, lo);
+    max = std::max(max, hi);
+
+    compress(merged);
+  }
+
+  void merge(QuantileSketch const& other) {
+    add(other.centroids, other.min, other.max);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Estimates quantile q in [0,1] by interpolating between the centers
+   * of the centroids. Returns NaN if the sketch is empty.
+   */
+  /* ----------------------------------------------------------------------------*/
+  double query(double q) const {
+    if (centroids.empty())
+      return std::numeric_limits<double>::quiet_NaN();
+    if (q <= 0.0)
+      return min;
+    if (q >= 1.0)
+      return max;
+
+    double const target = q * total_weight;
+
+    // Between the minimum and the center of the first centroid
+    double const first_center = centroids.front().weight / 2.0;
+    if (target < first_center)
+      return min + (centroids.front().mean - min) * target / first_center;
+
+    double cumulative{0};
+    for (size_t i = 0; i + 1 < centroids.size(); ++i) {
+      double const center = cumulative + centroids[i].weight / 2.0;
+      double const next_center = cumulative + centroids[i].weight + centroids[i + 1].weight / 2.0;
+      if (target < next_center) {
+        double const fraction = (target - center) / (next_center - center);
+        return centroids[i].mean + fraction * (centroids[i + 1].mean - centroids[i].mean);
+      }
+      cumulative += centroids[i].weight;
+    }
+
+    // Between the center of the last centroid and the maximum
+    double const last_center = total_weight - centroids.back().weight / 2.0;
+    double const fraction = (target - last_center) / (total_weight - last_center);
+    return centroids.back().mean + fraction * (max - centroids.back().mean);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief The serialized form is a fixed header followed by the centroids,
+   * all in host byte order
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct Header {
+    uint32_t magic;
+    int32_t compression;
+    uint64_t num_centroids;
+    double total_weight;
+    double min;
+    double max;
+  };
+
+  static constexpr uint32_t magic_number{0x54444731}; // "TDG1"
+
+  size_t serialized_size() const {
+    return sizeof(Header) + centroids.size() * sizeof(Centroid);
+  }
+
+  void serialize(void* buffer) const {
+    Header const header{magic_number, compression, centroids.size(), total_weight, min, max};
+    char* out = static_cast<char*>(buffer);
+    std::memcpy(out, &header, sizeof(Header));
+    if (!centroids.empty())
+      std::memcpy(out + sizeof(Header), centroids.data(), centroids.size() * sizeof(Centroid));
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Restores a serialized sketch. Returns false if the buffer does not
+   * hold a complete sketch.
+   */
+  /* ----------------------------------------------------------------------------*/
+  bool deserialize(const void* buffer, size_t size) {
+    Header header;
+    if (nullptr == buffer || size < sizeof(Header))
+      return false;
+    std::memcpy(&header, buffer, sizeof(Header));
+    if (header.magic != magic_number || header.compression <= 0 ||
+        (size - sizeof(Header)) / sizeof(Centroid) < header.num_centroids)
+      return false;
+
+    compression = header.compression;
+    total_weight = header.total_weight;
+    min = header.min;
+    max = header.max;
+    centroids.resize(header.num_centroids);
+    if (!centroids.empty())
+      std::memcpy(centroids.data(), static_cast<const char*>(buffer) + sizeof(Header),
+                  centroids.size() * sizeof(Centroid));
+    return true;
+  }
+
+  int compression;
+  double total_weight;
+  double min;
+  double max;
+  std::vector<Centroid> centroids;
+
+private:
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Greedily merges neighbouring centroids as long as the result spans
+   * at most a unit interval of the scale function
+   */
+  /* ----------------------------------------------------------------------------*/
+  void compress(std::vector<Centroid> const& sorted) {
+    centroids.clear();
+
+    double weight_so_far{0};
+    Centroid current = sorted.front();
+    for (size_t i = 1; i < sorted.size(); ++i) {
+      Centroid const& next = sorted[i];
+      double const q_left = weight_so_far / total_weight;
+      double const q_right = (weight_so_far + current.weight + next.weight) / total_weight;
+      if (scale(q_right, compression) - scale(q_left, compression) <= 1.0) {
+        double const weight = current.weight + next.weight;
+        current.mean += (next.mean - current.mean) * next.weight / weight;
+        current.weight = weight;
+      }
+      else {
+        weight_so_far += current.weight;
+        centroids.push_back(current);
+        current = next;
+      }
+    }
+    centroids.push_back(current);
+  }
+};
@@ -18,10 +18,19 @@
 
 #include <thrust/device_vector.h>
 #include <thrust/copy.h>
+#include <thrust/gather.h>
+#include <thrust/sort.h>
+#include <thrust/for_each.h>
+#include <thrust/binary_search.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <limits>
+#include <vector>
 
 #include "cudf.h"
 #include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
+#include "utilities/type_dispatcher.hpp"
 #include "rmm/thrust_rmm_allocator.h"
 
 #include "quantiles.h"
@@ -135,6 +144,208 @@ namespace{ //unknown
       }
   }
     
+  // Reads the pair of values gathered around a quantile by their index in
+  // the sorted column
+  template<typename T>
+  struct gathered_accessor
+  {
+    const T* values;
+    size_t lower;
+    CUDA_HOST_DEVICE_CALLABLE T operator()(size_t i) const { return values[i == lower ? 0 : 1]; }
+  };
+
+  template<typename T>
+  struct segment_accessor
+  {
+    const T* values;
+    CUDA_HOST_DEVICE_CALLABLE T operator()(size_t i) const { return values[i]; }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Computes one quantile of one segment of a column sorted within
+   * each segment
+   */
+  /* ----------------------------------------------------------------------------*/
+  template<typename T>
+  struct segment_quantile
+  {
+    const T* sorted;
+    const gdf_index_type* segment_offsets;
+    gdf_size_type num_segments;
+    gdf_size_type size;
+    const double* q;
+    const gdf_quantile_method* methods;
+    double* const* results;
+    double empty_result;
+
+    CUDA_DEVICE_CALLABLE void operator()(gdf_size_type i) const
+    {
+      gdf_size_type segment = i % num_segments;
+      int j = i / num_segments;
+
+      gdf_index_type begin = segment_offsets[segment];
+      gdf_index_type end = (segment + 1 < num_segments) ? segment_offsets[segment + 1] : size;
+
+      results[j][segment] = (end > begin) ?
+        quantile_from_sorted<T>(segment_accessor<T>{sorted + begin}, end - begin, q[j], methods[j]) :
+        empty_result;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Computes several quantiles of every segment of a column. The
+   * column is sorted within its segments once for all the quantiles.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct segmented_quantiles
+  {
+    template<typename ColType,
+             typename std::enable_if_t<std::is_arithmetic<ColType>::value>* = nullptr>
+    gdf_error operator()(gdf_column* col_in,
+                         gdf_column* segment_offsets,
+                         const double* q,
+                         const gdf_quantile_method* methods,
+                         int num_quantiles,
+                         gdf_column* out[],
+                         gdf_context* ctxt)
+    {
+      cudaStream_t stream = 0;
+      gdf_size_type n = col_in->size;
+      gdf_size_type num_segments = segment_offsets->size;
+      const gdf_index_type* offsets = static_cast<const gdf_index_type*>(segment_offsets->data);
+      ColType* p_dv = static_cast<ColType*>(col_in->data);
+
+      rmm::device_vector<ColType> dv;
+      if( !ctxt->flag_sort_inplace && !ctxt->flag_sorted )
+        {
+          dv.resize(n);
+          thrust::copy_n(rmm::exec_policy(stream)->on(stream), p_dv, n, dv.begin());
+          p_dv = dv.data().get();
+        }
+
+      if( !ctxt->flag_sorted )
+        {
+          // Sort by value, then stable sort by segment to restore the segments
+          rmm::device_vector<gdf_index_type> segment_ids(n);
+          thrust::upper_bound(rmm::exec_policy(stream)->on(stream),
+                              offsets, offsets + num_segments,
+                              thrust::make_counting_iterator<gdf_index_type>(0),
+                              thrust::make_counting_iterator<gdf_index_type>(n),
+                              segment_ids.begin());
+          thrust::sort_by_key(rmm::exec_policy(stream)->on(stream),
+                              p_dv, p_dv + n, segment_ids.begin());
+          thrust::stable_sort_by_key(rmm::exec_policy(stream)->on(stream),
+                                     segment_ids.begin(), segment_ids.end(), p_dv);
+        }
+
+      std::vector<double*> h_results(num_quantiles);
+      for(int j = 0; j < num_quantiles; ++j)
+        h_results[j] = static_cast<double*>(out[j]->data);
+
+      rmm::device_vector<double> d_q(q, q + num_quantiles);
+      rmm::device_vector<gdf_quantile_method> d_methods(methods, methods + num_quantiles);
+      rmm::device_vector<double*> d_results(h_results);
+
+      thrust::for_each(rmm::exec_policy(stream)->on(stream),
+                       thrust::make_counting_iterator<gdf_size_type>(0),
+                       thrust::make_counting_iterator<gdf_size_type>(num_segments * num_quantiles),
+                       segment_quantile<ColType>{p_dv, offsets, num_segments, n,
+                                                 d_q.data().get(), d_methods.data().get(),
+                                                 d_results.data().get(),
+                                                 std::numeric_limits<double>::quiet_NaN()});
+      CUDA_CHECK_LAST();
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+
+      return GDF_SUCCESS;
+    }
+
+    template<typename ColType,
+             typename std::enable_if_t<!std::is_arithmetic<ColType>::value>* = nullptr>
+    gdf_error operator()(gdf_column* col_in,
+                         gdf_column* segment_offsets,
+                         const double* q,
+                         const gdf_quantile_method* methods,
+                         int num_quantiles,
+                         gdf_column* out[],
+                         gdf_context* ctxt)
+    {
+      return GDF_UNSUPPORTED_DTYPE;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /** 
+   * @brief Computes several quantiles of a column from a single sort. Only the
+   * values around each quantile are copied back to the host.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct batch_quantiles
+  {
+    template<typename ColType,
+             typename std::enable_if_t<std::is_arithmetic<ColType>::value>* = nullptr>
+    gdf_error operator()(gdf_column* col_in,
+                         const double* q,
+                         const gdf_quantile_method* methods,
+                         int num_quantiles,
+                         double* results,
+                         gdf_context* ctxt)
+    {
+      cudaStream_t stream = 0;
+      size_t n = col_in->size;
+      ColType* p_dv = static_cast<ColType*>(col_in->data);
+
+      rmm::device_vector<ColType> dv;
+      if( !ctxt->flag_sort_inplace && !ctxt->flag_sorted )
+        {
+          dv.resize(n);
+          thrust::copy_n(rmm::exec_policy(stream)->on(stream), p_dv, n, dv.begin());
+          p_dv = dv.data().get();
+        }
+      if( !ctxt->flag_sorted )
+        thrust::sort(rmm::exec_policy(stream)->on(stream), p_dv, p_dv+n);
+
+      // Gather the two values each quantile may need
+      std::vector<size_t> h_positions(2*num_quantiles);
+      for(int i = 0; i < num_quantiles; ++i)
+        {
+          double fract_pos = 0;
+          size_t k = (q[i] >= 1.0) ? n-1 : (n < 2) ? 0 : quantile_position(n, q[i], fract_pos);
+          h_positions[2*i] = k;
+          h_positions[2*i+1] = std::min(k+1, n-1);
+        }
+      rmm::device_vector<size_t> d_positions(h_positions);
+      rmm::device_vector<ColType> d_values(h_positions.size());
+      thrust::gather(rmm::exec_policy(stream)->on(stream),
+                     d_positions.begin(), d_positions.end(), p_dv, d_values.begin());
+
+      std::vector<ColType> h_values(d_values.size());
+      CUDA_TRY( cudaMemcpyAsync(h_values.data(), d_values.data().get(), h_values.size()*sizeof(ColType),
+                                cudaMemcpyDeviceToHost, stream) );
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+
+      for(int i = 0; i < num_quantiles; ++i)
+        {
+          gathered_accessor<ColType> sorted{&h_values[2*i], h_positions[2*i]};
+          results[i] = quantile_from_sorted<ColType>(sorted, n, q[i], methods[i]);
+        }
+      return GDF_SUCCESS;
+    }
+
+    template<typename ColType,
+             typename std::enable_if_t<!std::is_arithmetic<ColType>::value>* = nullptr>
+    gdf_error operator()(gdf_column* col_in,
+                         const double* q,
+                         const gdf_quantile_method* methods,
+                         int num_quantiles,
+                         double* results,
+                         gdf_context* ctxt)
+    {
+      return GDF_UNSUPPORTED_DTYPE;
+    }
+  };
+
 }//unknown namespace
 
 gdf_error gdf_quantile_exact(	gdf_column*         col_in,       //input column;
@@ -268,3 +479,53 @@ gdf_error gdf_quantile_aprrox(	gdf_column*  col_in,       //input column;
   return ret;
 }
 
+
+gdf_error gdf_quantiles(gdf_column*                col_in,
+                        const double*              q,
+                        const gdf_quantile_method* methods,
+                        int                        num_quantiles,
+                        double*                    results,
+                        gdf_context*               ctxt)
+{
+  GDF_REQUIRE(nullptr != col_in && nullptr != ctxt, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(nullptr != q && nullptr != methods && nullptr != results, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(num_quantiles > 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(col_in->size > 0, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(!col_in->valid || !col_in->null_count, GDF_VALIDITY_UNSUPPORTED);
+
+  for(int i = 0; i < num_quantiles; ++i)
+    GDF_REQUIRE(methods[i] >= GDF_QUANT_LINEAR && methods[i] < N_GDF_QUANT_METHODS, GDF_UNSUPPORTED_METHOD);
+
+  return cudf::type_dispatcher(col_in->dtype, batch_quantiles{},
+                               col_in, q, methods, num_quantiles, results, ctxt);
+}
+
+gdf_error gdf_group_quantiles(gdf_column*                col_in,
+                              gdf_column*                segment_offsets,
+                              const double*              q,
+                              const gdf_quantile_method* methods,
+                              int                        num_quantiles,
+                              gdf_column*                out[],
+                              gdf_context*               ctxt)
+{
+  GDF_REQUIRE(nullptr != col_in && nullptr != segment_offsets && nullptr != ctxt, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(nullptr != q && nullptr != methods && nullptr != out, GDF_DATASET_EMPTY);
+  GDF_REQUIRE(num_quantiles > 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(!col_in->valid || !col_in->null_count, GDF_VALIDITY_UNSUPPORTED);
+  GDF_REQUIRE(GDF_INDEX_DTYPE == segment_offsets->dtype, GDF_UNSUPPORTED_DTYPE);
+  GDF_REQUIRE(!segment_offsets->valid || !segment_offsets->null_count, GDF_VALIDITY_UNSUPPORTED);
+
+  for(int j = 0; j < num_quantiles; ++j)
+    {
+      GDF_REQUIRE(methods[j] >= GDF_QUANT_LINEAR && methods[j] < N_GDF_QUANT_METHODS, GDF_UNSUPPORTED_METHOD);
+      GDF_REQUIRE(nullptr != out[j], GDF_DATASET_EMPTY);
+      GDF_REQUIRE(GDF_FLOAT64 == out[j]->dtype, GDF_UNSUPPORTED_DTYPE);
+      GDF_REQUIRE(segment_offsets->size == out[j]->size, GDF_COLUMN_SIZE_MISMATCH);
+    }
+
+  if( 0 == segment_offsets->size )
+    return GDF_SUCCESS;
+
+  return cudf::type_dispatcher(col_in->dtype, segmented_quantiles{},
+                               col_in, segment_offsets, q, methods, num_quantiles, out, ctxt);
+}
@@ -29,13 +29,20 @@
 #include <functional>
 #include <rmm/thrust_rmm_allocator.h>
 
+#include "cudf.h"
+#include "utilities/cudf_utils.h"
 
-template<typename T>
-size_t quantile_index(T* dv, size_t n, double q, double& fract_pos, cudaStream_t stream, bool flag_sorted)
-{
-  if( !flag_sorted )
-    thrust::sort(rmm::exec_policy(stream)->on(stream), dv, dv+n);
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Computes the position of quantile q in n sorted values: the index
+ * of the lower of the two values to interpolate between, and the fractional
+ * position between them.
+ */
+/* ----------------------------------------------------------------------------*/
+CUDA_HOST_DEVICE_CALLABLE
+size_t quantile_position(size_t n, double q, double& fract_pos)
+{
   double pos = q*static_cast<double>(n);//(n-1);
   size_t k = static_cast<size_t>(pos);
   
@@ -46,6 +53,52 @@ size_t quantile_index(T* dv, size_t n, double q, double& fract_pos, cudaStream_t
   return k;
 }
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Computes quantile q of n sorted values with the method prec, given
+ * an accessor to the values. Matches quantile_exact: q >= 1 yields the largest
+ * value and a single value is returned as is.
+ */
+/* ----------------------------------------------------------------------------*/
+template<typename T, typename Accessor>
+CUDA_HOST_DEVICE_CALLABLE
+double quantile_from_sorted(Accessor sorted, size_t n, double q, gdf_quantile_method prec)
+{
+  if( q >= 1.0 )
+    return static_cast<double>(sorted(n-1));
+
+  if( n < 2 )
+    return static_cast<double>(sorted(0));
+
+  double fract_pos = 0;
+  size_t k = quantile_position(n, q, fract_pos);
+  T y0 = sorted(k);
+  T y1 = sorted(k+1);
+
+  switch( prec )
+    {
+    case GDF_QUANT_LOWER:
+      return static_cast<double>(y0);
+    case GDF_QUANT_HIGHER:
+      return static_cast<double>(y1);
+    case GDF_QUANT_MIDPOINT:
+      return static_cast<double>(y0 + y1)/2.0;
+    case GDF_QUANT_NEAREST:
+      return static_cast<double>(fract_pos < 0.5 ? y0 : y1);
+    default:
+      return static_cast<double>(y0) + fract_pos*static_cast<double>(y1-y0);
+    }
+}
+
+template<typename T>
+size_t quantile_index(T* dv, size_t n, double q, double& fract_pos, cudaStream_t stream, bool flag_sorted)
+{
+  if( !flag_sorted )
+    thrust::sort(rmm::exec_policy(stream)->on(stream), dv, dv+n);
+
+  return quantile_position(n, q, fract_pos);
+}
+
 template<typename T>
 T quantile_approx(T* dv, size_t n, double q, cudaStream_t stream = NULL, bool flag_sorted = false)
 {
@@ -2,9 +2,22 @@
 #include "rmm/rmm.h"
 #include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
+#include "utilities/type_dispatcher.hpp"
+#include "rmm/thrust_rmm_allocator.h"
 
 #include <cub/device/device_scan.cuh>
 
+#include <thrust/scan.h>
+#include <thrust/sort.h>
+#include <thrust/binary_search.h>
+#include <thrust/functional.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
+
+#include <limits>
+#include <type_traits>
+
 
 
 template <class T>
@@ -19,11 +32,11 @@ struct Scan {
         void *temp_storage = NULL;
         size_t temp_storage_bytes = 0;
         scan_function(temp_storage, temp_storage_bytes, inp, out, size);
-        RMM_TRY( RMM_ALLOC(&temp_storage, temp_storage_bytes, 0) ); // TODO: non-default stream
+        SCRATCH_ALLOC_TRY(&temp_storage, temp_storage_bytes, 0); // TODO: non-default stream
         // Do scan
         scan_function(temp_storage, temp_storage_bytes, inp, out, size);
         // Cleanup
-        RMM_TRY( RMM_FREE(temp_storage, 0) ); // TODO: non-default stream
+        SCRATCH_FREE_TRY(temp_storage, 0); // TODO: non-default stream
 
         return GDF_SUCCESS;
     }
@@ -63,13 +76,260 @@ SCAN_IMPL(i32, int32_t)
 SCAN_IMPL(i64, int64_t)
 
 
+namespace {
+
+struct ScanSum {
+    template<typename T>
+    __host__ __device__
+    T operator() (const T &lhs, const T &rhs) const {
+        return lhs + rhs;
+    }
+
+    template<typename T>
+    static constexpr T identity() { return T{0}; }
+};
+
+struct ScanProduct {
+    template<typename T>
+    __host__ __device__
+    T operator() (const T &lhs, const T &rhs) const {
+        return lhs * rhs;
+    }
+
+    template<typename T>
+    static constexpr T identity() { return T{1}; }
+};
+
+struct ScanMin {
+    template<typename T>
+    __host__ __device__
+    T operator() (const T &lhs, const T &rhs) const {
+        return lhs <= rhs? lhs: rhs;
+    }
+
+    template<typename T>
+    static constexpr T identity() { return std::numeric_limits<T>::max(); }
+};
+
+struct ScanMax {
+    template<typename T>
+    __host__ __device__
+    T operator() (const T &lhs, const T &rhs) const {
+        return lhs >= rhs? lhs: rhs;
+    }
+
+    template<typename T>
+    static constexpr T identity() { return std::numeric_limits<T>::lowest(); }
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Loads the i'th element of a column, substituting the identity of
+ * the scan operation for null elements so they do not affect the result.
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename T>
+struct NullReplacingLoader {
+    const T *data;
+    const gdf_valid_type *valid;
+    T identity;
+
+    __host__ __device__
+    T operator() (gdf_index_type i) const {
+        return gdf_is_valid(valid, i)? data[i] : identity;
+    }
+};
+
+template <typename Op>
+struct ScanDispatcher {
+    template <typename T,
+              typename std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+    gdf_error operator()(gdf_column *inp, gdf_column *out,
+                         const gdf_index_type *segment_ids,
+                         bool inclusive, cudaStream_t stream) {
+        const T identity = Op::template identity<T>();
+        auto values = thrust::make_transform_iterator(
+            thrust::make_counting_iterator<gdf_index_type>(0),
+            NullReplacingLoader<T>{static_cast<const T*>(inp->data),
+                                   inp->valid, identity});
+        T *result = static_cast<T*>(out->data);
+        const gdf_size_type size = inp->size;
+
+        if (nullptr == segment_ids) {
+            if (inclusive)
+                thrust::inclusive_scan(rmm::exec_policy(stream)->on(stream),
+                                       values, values + size, result, Op{});
+            else
+                thrust::exclusive_scan(rmm::exec_policy(stream)->on(stream),
+                                       values, values + size, result,
+                                       identity, Op{});
+        }
+        else {
+            if (inclusive)
+                thrust::inclusive_scan_by_key(rmm::exec_policy(stream)->on(stream),
+                                              segment_ids, segment_ids + size,
+                                              values, result,
+                                              thrust::equal_to<gdf_index_type>(),
+                                              Op{});
+            else
+                thrust::exclusive_scan_by_key(rmm::exec_policy(stream)->on(stream),
+                                              segment_ids, segment_ids + size,
+                                              values, result, identity,
+                                              thrust::equal_to<gdf_index_type>(),
+                                              Op{});
+        }
+        CUDA_CHECK_LAST();
+
+        return GDF_SUCCESS;
+    }
+
+    template <typename T,
+              typename std::enable_if_t<!std::is_arithmetic<T>::value>* = nullptr>
+    gdf_error operator()(gdf_column *inp, gdf_column *out,
+                         const gdf_index_type *segment_ids,
+                         bool inclusive, cudaStream_t stream) {
+        return GDF_UNSUPPORTED_DTYPE;
+    }
+};
+
+gdf_error verify_scan_columns(gdf_column *inp, gdf_column *out)
+{
+    GDF_REQUIRE(nullptr != inp && nullptr != out, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(inp->size == out->size, GDF_COLUMN_SIZE_MISMATCH);
+    GDF_REQUIRE(inp->dtype == out->dtype, GDF_DTYPE_MISMATCH);
+    GDF_REQUIRE(!inp->valid || !inp->null_count || out->valid,
+                GDF_VALIDITY_MISSING);
+    return GDF_SUCCESS;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Scans a single column. The output inherits the validity of the
+ * input, since a null input row yields a null output row.
+ */
+/* ----------------------------------------------------------------------------*/
+gdf_error scan_column(gdf_column *inp, gdf_column *out,
+                      const gdf_index_type *segment_ids,
+                      gdf_scan_op op, bool inclusive, cudaStream_t stream)
+{
+    gdf_error status = GDF_SUCCESS;
+    switch (op) {
+    case GDF_SCAN_SUM:
+        status = cudf::type_dispatcher(inp->dtype, ScanDispatcher<ScanSum>(),
+                                       inp, out, segment_ids, inclusive, stream);
+        break;
+    case GDF_SCAN_MIN:
+        status = cudf::type_dispatcher(inp->dtype, ScanDispatcher<ScanMin>(),
+                                       inp, out, segment_ids, inclusive, stream);
+        break;
+    case GDF_SCAN_MAX:
+        status = cudf::type_dispatcher(inp->dtype, ScanDispatcher<ScanMax>(),
+                                       inp, out, segment_ids, inclusive, stream);
+        break;
+    case GDF_SCAN_PRODUCT:
+        status = cudf::type_dispatcher(inp->dtype, ScanDispatcher<ScanProduct>(),
+                                       inp, out, segment_ids, inclusive, stream);
+        break;
+    default:
+        return GDF_INVALID_API_CALL;
+    }
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    if (nullptr != out->valid) {
+        const gdf_size_type num_masks = gdf_get_num_chars_bitmask(inp->size);
+        if (nullptr != inp->valid)
+            CUDA_TRY( cudaMemcpyAsync(out->valid, inp->valid,
+                                      num_masks * sizeof(gdf_valid_type),
+                                      cudaMemcpyDeviceToDevice, stream) );
+        else
+            CUDA_TRY( cudaMemsetAsync(out->valid, 0xff,
+                                      num_masks * sizeof(gdf_valid_type),
+                                      stream) );
+    }
+    out->null_count = (nullptr != inp->valid)? inp->null_count : 0;
+
+    return GDF_SUCCESS;
+}
+
+} // end anonymous namespace
+
+
 gdf_error gdf_prefixsum_generic(gdf_column *inp, gdf_column *out,
                                 int inclusive)
 {
-    switch (inp->dtype) {
-    case GDF_INT8:    return gdf_prefixsum_i8(inp, out, inclusive);
-    case GDF_INT32:   return gdf_prefixsum_i32(inp, out, inclusive);
-    case GDF_INT64:   return gdf_prefixsum_i64(inp, out, inclusive);
-    default: return GDF_SUCCESS;
+    return gdf_scan(inp, out, GDF_SCAN_SUM, inclusive);
+}
+
+
+gdf_error gdf_scan(gdf_column *inp, gdf_column *out, gdf_scan_op op,
+                   int inclusive)
+{
+    return gdf_segmented_scan(1, &inp, &out, nullptr, op, inclusive);
+}
+
+
+gdf_error gdf_segmented_scan(int num_cols,
+                             gdf_column *inp[],
+                             gdf_column *out[],
+                             gdf_column *segment_offsets,
+                             gdf_scan_op op,
+                             int inclusive)
+{
+    GDF_REQUIRE(num_cols > 0, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(nullptr != inp && nullptr != out, GDF_DATASET_EMPTY);
+
+    for (int i = 0; i < num_cols; ++i) {
+        gdf_error status = verify_scan_columns(inp[i], out[i]);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        GDF_REQUIRE(inp[i]->size == inp[0]->size, GDF_COLUMN_SIZE_MISMATCH);
+    }
+
+    const gdf_size_type size = inp[0]->size;
+    if (0 == size)
+        return GDF_SUCCESS;
+
+    cudaStream_t stream = 0; // TODO: non-default stream
+
+    // Map every row to the segment it belongs to. Rows in the same segment
+    // share a key, which is all that thrust's *_scan_by_key needs.
+    rmm::device_vector<gdf_index_type> segment_ids;
+    if (nullptr != segment_offsets) {
+        GDF_REQUIRE(GDF_INDEX_DTYPE == segment_offsets->dtype, GDF_UNSUPPORTED_DTYPE);
+        GDF_REQUIRE(!segment_offsets->valid || !segment_offsets->null_count,
+                    GDF_VALIDITY_UNSUPPORTED);
+        GDF_REQUIRE(segment_offsets->size > 0 && nullptr != segment_offsets->data,
+                    GDF_DATASET_EMPTY);
+
+        // The binary search needs ascending offsets within the rows
+        auto offsets = static_cast<const gdf_index_type*>(segment_offsets->data);
+        const gdf_size_type num_offsets = segment_offsets->size;
+        GDF_REQUIRE(thrust::is_sorted(rmm::exec_policy(stream)->on(stream),
+                                      offsets, offsets + num_offsets),
+                    GDF_INVALID_API_CALL);
+        gdf_index_type first{0}, last{0};
+        CUDA_TRY( cudaMemcpyAsync(&first, offsets, sizeof(gdf_index_type),
+                                  cudaMemcpyDeviceToHost, stream) );
+        CUDA_TRY( cudaMemcpyAsync(&last, offsets + num_offsets - 1, sizeof(gdf_index_type),
+                                  cudaMemcpyDeviceToHost, stream) );
+        CUDA_TRY( cudaStreamSynchronize(stream) );
+        GDF_REQUIRE(0 <= first && last <= size, GDF_INVALID_API_CALL);
+
+        segment_ids.resize(size);
+        thrust::upper_bound(rmm::exec_policy(stream)->on(stream),
+                            offsets, offsets + segment_offsets->size,
+                            thrust::make_counting_iterator<gdf_index_type>(0),
+                            thrust::make_counting_iterator<gdf_index_type>(size),
+                            segment_ids.begin());
+        CUDA_CHECK_LAST();
+    }
+    const gdf_index_type *d_segment_ids =
+        (nullptr != segment_offsets)? segment_ids.data().get() : nullptr;
+
+    for (int i = 0; i < num_cols; ++i) {
+        gdf_error status = scan_column(inp[i], out[i], d_segment_ids, op,
+                                       inclusive != 0, stream);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
     }
+
+    return GDF_SUCCESS;
 }
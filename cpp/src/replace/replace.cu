@@ -19,99 +19,342 @@
 #include <thrust/device_ptr.h>
 #include <thrust/find.h>
 #include <thrust/execution_policy.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <type_traits>
 
 #include "cudf.h"
 #include "utilities/error_utils.h"
 #include "utilities//type_dispatcher.hpp"
 #include "utilities/cudf_utils.h"
+#include "hash/hash_functions.cuh"
+#include "rmm/thrust_rmm_allocator.h"
 
 namespace{ //anonymous
 
   constexpr int BLOCK_SIZE = 256;
 
+  // Up to this many old values are searched linearly; more are looked up in
+  // a hash table
+  constexpr gdf_size_type LINEAR_SEARCH_MAX_VALUES = 32;
+
+  // Marks an empty slot of the hash table
+  constexpr gdf_index_type EMPTY_SLOT = -1;
+
+  __device__ __forceinline__
+  int atomic_cas(int* address, int compare, int val)
+  {
+    return atomicCAS(address, compare, val);
+  }
+
+  __device__ __forceinline__
+  long atomic_cas(long* address, long compare, long val)
+  {
+    return static_cast<long>(atomicCAS(reinterpret_cast<unsigned long long*>(address),
+                                       static_cast<unsigned long long>(compare),
+                                       static_cast<unsigned long long>(val)));
+  }
+
+  __device__ __forceinline__
+  void atomic_min(int* address, int val)
+  {
+    atomicMin(address, val);
+  }
+
+  __device__ __forceinline__
+  void atomic_min(long* address, long val)
+  {
+    atomicMin(reinterpret_cast<long long*>(address), static_cast<long long>(val));
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Hashes a value such that values comparing equal hash equally,
+   * i.e., -0.0 like 0.0
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T,
+            typename std::enable_if_t<std::is_floating_point<T>::value>* = nullptr>
+  __device__ __forceinline__
+  hash_value_type hash_value(T value)
+  {
+    return default_hash<T>{}(value == T{0} ? T{0} : value);
+  }
+
+  template <typename T,
+            typename std::enable_if_t<!std::is_floating_point<T>::value>* = nullptr>
+  __device__ __forceinline__
+  hash_value_type hash_value(T value)
+  {
+    return default_hash<T>{}(value);
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Finds the first valid `old_values[i]` equal to a value by scanning
+   * all of them. Returns -1 if there is none.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  struct linear_finder
+  {
+    const T*              old_values;
+    const gdf_valid_type* old_valid;
+    gdf_size_type         num_values;
+
+    __device__ gdf_index_type operator()(T value) const
+    {
+      for (gdf_index_type i = 0; i < num_values; ++i) {
+        if (old_values[i] == value && gdf_is_valid(old_valid, i))
+          return i;
+      }
+      return -1;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Finds the first valid `old_values[i]` equal to a value in an open
+   * addressing hash table of indices into `old_values`. Returns -1 if there is
+   * none.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  struct hash_finder
+  {
+    const T*              old_values;
+    const gdf_index_type* slots;
+    gdf_size_type         slot_mask;
+
+    __device__ gdf_index_type operator()(T value) const
+    {
+      gdf_size_type slot = hash_value(value) & slot_mask;
+      gdf_index_type index;
+      while (EMPTY_SLOT != (index = slots[slot])) {
+        if (old_values[index] == value)
+          return index;
+        slot = (slot + 1) & slot_mask;
+      }
+      return -1;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Inserts the indices of the valid old values into the hash table.
+   * Of equal old values only the first one is kept, as with a linear search.
+   * Values never equal to themselves (NaN) are not inserted.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  __global__
+  void build_replace_table(const T*              old_values,
+                           const gdf_valid_type* old_valid,
+                           gdf_size_type         num_values,
+                           gdf_index_type*       slots,
+                           gdf_size_type         slot_mask)
+  {
+    for (gdf_index_type i = blockIdx.x * blockDim.x + threadIdx.x; i < num_values;
+         i += blockDim.x * gridDim.x) {
+      T const value = old_values[i];
+      if (!gdf_is_valid(old_valid, i) || !(value == value))
+        continue;
+
+      gdf_size_type slot = hash_value(value) & slot_mask;
+      while (true) {
+        gdf_index_type const existing = atomic_cas(slots + slot, EMPTY_SLOT, i);
+        if (EMPTY_SLOT == existing)
+          break;
+        if (old_values[existing] == value) {
+          atomic_min(slots + slot, i);
+          break;
+        }
+        slot = (slot + 1) & slot_mask;
+      }
+    }
+  }
+
   /* --------------------------------------------------------------------------*/
   /** 
    * @brief Kernel that replaces elements from `d_col_data` given the following
-   *        rule: replace all `old_values[i]` in [old_values_begin`, `old_values_end`)
-   *        present in `d_col_data` with `d_new_values[i]`.
+   *        rule: replace all `old_values[i]` present in `d_col_data` with
+   *        `d_new_values[i]`.
+   *
+   * Null rows are replaced with the new value of the first null old value,
+   * if any. A null new value makes the row null. Valid rows that are not
+   * matched are handled according to `policy`. Each warp writes the validity
+   * bits of 32 consecutive rows at once.
    * 
    * @param[in,out] d_col_data Device array with the data to be modified
+   * @param[in,out] d_col_valid The validity mask of `d_col_data`, may be null
+   * if no row can become null
    * @param[in] nrows # rows in `d_col_data`
-   * @param[in] old_values_begin Device pointer to the beginning of the sequence 
-   * of old values to be replaced
-   * @param[in] old_values_end  Device pointer to the end of the sequence 
-   * of old values to be replaced
+   * @param[in] find Returns the index of the old value equal to a value, or -1
+   * @param[in] null_match Index of the first null old value, or -1
    * @param[in] d_new_values Device array with the new values
-   * 
-   * @returns
+   * @param[in] d_new_valid The validity mask of the new values
+   * @param[in] policy What to do with the unmatched valid values
+   * @param[in] d_default_value The value for unmatched values with
+   * GDF_UNMATCHED_DEFAULT
    */
   /* ----------------------------------------------------------------------------*/
-  template <class T>
+  template <class T, class Finder>
   __global__
-  void replace_kernel(T*                          d_col_data,
-                      gdf_size_type                      nrows,
-                      thrust::device_ptr<const T> old_values_begin,
-                      thrust::device_ptr<const T> old_values_end,
-                      const T*                    d_new_values)
+  void replace_kernel(T*                    d_col_data,
+                      gdf_valid_type*       d_col_valid,
+                      gdf_size_type         nrows,
+                      Finder                find,
+                      gdf_index_type        null_match,
+                      const T*              d_new_values,
+                      const gdf_valid_type* d_new_valid,
+                      gdf_unmatched_policy  policy,
+                      const T*              d_default_value)
   {
-    gdf_size_type i = blockIdx.x * blockDim.x + threadIdx.x;
-    while(i < nrows)
-    {
-      auto found_ptr = thrust::find(thrust::seq, old_values_begin, old_values_end, d_col_data[i]);
+    gdf_size_type const lane = threadIdx.x % warpSize;
+    gdf_size_type const num_bytes = gdf_get_num_chars_bitmask(nrows);
 
-      if (found_ptr != old_values_end) {
-          auto d = thrust::distance(old_values_begin, found_ptr);
-          d_col_data[i] = d_new_values[d];
+    // The whole warp iterates while any of its rows is in range
+    for (gdf_size_type i = blockIdx.x * blockDim.x + threadIdx.x; i - lane < nrows;
+         i += blockDim.x * gridDim.x) {
+      bool is_valid{false};
+      if (i < nrows) {
+        is_valid = gdf_is_valid(d_col_valid, i);
+        gdf_index_type const match = is_valid ? find(d_col_data[i]) : null_match;
+        if (match >= 0) {
+          d_col_data[i] = d_new_values[match];
+          is_valid = gdf_is_valid(d_new_valid, match);
+        }
+        else if (is_valid && GDF_UNMATCHED_NULL == policy) {
+          is_valid = false;
+        }
+        else if (is_valid && GDF_UNMATCHED_DEFAULT == policy) {
+          d_col_data[i] = *d_default_value;
+        }
       }
 
-      i += blockDim.x * gridDim.x;
+      if (nullptr != d_col_valid) {
+        uint32_t const bits = __ballot_sync(0xffffffff, is_valid);
+        if (0 == lane) {
+          gdf_size_type const first_byte = (i - lane) / GDF_VALID_BITSIZE;
+          for (int b = 0; b < 4 && first_byte + b < num_bytes; ++b)
+            d_col_valid[first_byte + b] = static_cast<gdf_valid_type>(bits >> (b * GDF_VALID_BITSIZE));
+        }
+      }
     }
   }
 
+  struct is_null_entry
+  {
+    const gdf_valid_type* valid;
+
+    __device__ bool operator()(gdf_index_type i) const
+    {
+      return !gdf_is_valid(valid, i);
+    }
+  };
+
   /* --------------------------------------------------------------------------*/
   /** 
    * @brief Functor called by the `type_dispatcher` in order to invoke and instantiate
-   *        `replace_kernel` with the apropiate data types.
+   *        `replace_kernel` with the apropiate data types and lookup strategy.
    */
   /* ----------------------------------------------------------------------------*/
   struct replace_kernel_forwarder {
     template <typename col_type>
-    void operator()(void*       d_col_data,
-                    gdf_size_type      nrows,
-                    const void* d_old_values,
-                    const void* d_new_values,
-                    gdf_size_type      nvalues)
+    gdf_error operator()(gdf_column*          col,
+                         const gdf_column*    old_values,
+                         const gdf_column*    new_values,
+                         gdf_unmatched_policy policy,
+                         const void*          d_default_value)
     {
-      thrust::device_ptr<const col_type> old_values_begin = thrust::device_pointer_cast(static_cast<const col_type*>(d_old_values));
+      cudaStream_t stream = 0;
+      gdf_size_type const nrows = col->size;
+      gdf_size_type const nvalues = old_values->size;
+      const col_type* d_old_values = static_cast<const col_type*>(old_values->data);
+
+      // The first null old value matches the null rows
+      gdf_index_type null_match{-1};
+      if (nullptr != old_values->valid && old_values->null_count > 0) {
+        auto values_begin = thrust::make_counting_iterator<gdf_index_type>(0);
+        auto found = thrust::find_if(rmm::exec_policy(stream)->on(stream),
+                                     values_begin, values_begin + nvalues,
+                                     is_null_entry{old_values->valid});
+        null_match = (found != values_begin + nvalues) ? *found : -1;
+      }
+
+      const gdf_valid_type* d_old_valid = old_values->null_count > 0 ? old_values->valid : nullptr;
+      const gdf_valid_type* d_new_valid = new_values->null_count > 0 ? new_values->valid : nullptr;
 
       const size_t grid_size = nrows / BLOCK_SIZE + (nrows % BLOCK_SIZE != 0);
-      replace_kernel<<<grid_size, BLOCK_SIZE>>>(static_cast<col_type*>(d_col_data),
-                                             nrows,
-                                             old_values_begin,
-                                             old_values_begin + nvalues,
-                                             static_cast<const col_type*>(d_new_values));
+      if (nvalues <= LINEAR_SEARCH_MAX_VALUES) {
+        linear_finder<col_type> find{d_old_values, d_old_valid, nvalues};
+        replace_kernel<<<grid_size, BLOCK_SIZE, 0, stream>>>(static_cast<col_type*>(col->data),
+                                                            col->valid, nrows, find, null_match,
+                                                            static_cast<const col_type*>(new_values->data),
+                                                            d_new_valid, policy,
+                                                            static_cast<const col_type*>(d_default_value));
+        CUDA_CHECK_LAST();
+        return GDF_SUCCESS;
+      }
+
+      // A power of two number of slots, at most half full
+      gdf_size_type num_slots{1};
+      while (num_slots < 2 * nvalues)
+        num_slots *= 2;
+      rmm::device_vector<gdf_index_type> slots(num_slots, EMPTY_SLOT);
+
+      const size_t build_grid_size = nvalues / BLOCK_SIZE + (nvalues % BLOCK_SIZE != 0);
+      build_replace_table<<<build_grid_size, BLOCK_SIZE, 0, stream>>>(d_old_values, d_old_valid, nvalues,
+                                                                      slots.data().get(), num_slots - 1);
+      CUDA_CHECK_LAST();
+
+      hash_finder<col_type> find{d_old_values, slots.data().get(), num_slots - 1};
+      replace_kernel<<<grid_size, BLOCK_SIZE, 0, stream>>>(static_cast<col_type*>(col->data),
+                                                          col->valid, nrows, find, null_match,
+                                                          static_cast<const col_type*>(new_values->data),
+                                                          d_new_valid, policy,
+                                                          static_cast<const col_type*>(d_default_value));
+      CUDA_CHECK_LAST();
+
+      // The table is released on return
+      CUDA_TRY(cudaStreamSynchronize(stream));
+      return GDF_SUCCESS;
     }
   };
 
-  gdf_error find_and_replace_all(gdf_column*       col,
-                                 const gdf_column* old_values,
-                                 const gdf_column* new_values)
+  gdf_error find_and_replace(gdf_column*          col,
+                             const gdf_column*    old_values,
+                             const gdf_column*    new_values,
+                             gdf_unmatched_policy policy,
+                             const gdf_column*    default_value)
   {
     GDF_REQUIRE(col != nullptr && old_values != nullptr && new_values != nullptr, GDF_DATASET_EMPTY);
     GDF_REQUIRE(old_values->size == new_values->size, GDF_COLUMN_SIZE_MISMATCH);
     GDF_REQUIRE(col->dtype == old_values->dtype && col->dtype == new_values->dtype, GDF_DTYPE_MISMATCH);
-    GDF_REQUIRE(col->valid == nullptr || col->null_count == 0, GDF_VALIDITY_UNSUPPORTED);
-    GDF_REQUIRE(old_values->valid == nullptr || old_values->null_count == 0, GDF_VALIDITY_UNSUPPORTED);
-    GDF_REQUIRE(new_values->valid == nullptr || new_values->null_count == 0, GDF_VALIDITY_UNSUPPORTED);
-
-    
-    cudf::type_dispatcher(col->dtype, replace_kernel_forwarder{},
-                          col->data,
-                          col->size,
-                          old_values->data,
-                          new_values->data,
-                          new_values->size); 
 
+    const void* d_default_value{nullptr};
+    if (GDF_UNMATCHED_DEFAULT == policy) {
+      GDF_REQUIRE(nullptr != default_value && nullptr != default_value->data, GDF_DATASET_EMPTY);
+      GDF_REQUIRE(col->dtype == default_value->dtype, GDF_DTYPE_MISMATCH);
+      GDF_REQUIRE(1 == default_value->size, GDF_COLUMN_SIZE_MISMATCH);
+      GDF_REQUIRE(nullptr == default_value->valid || 0 == default_value->null_count, GDF_VALIDITY_UNSUPPORTED);
+      d_default_value = default_value->data;
+    }
+
+    // Rows can only become null if the column has a validity mask
+    bool const may_add_nulls{GDF_UNMATCHED_NULL == policy || new_values->null_count > 0};
+    GDF_REQUIRE(!may_add_nulls || nullptr != col->valid, GDF_VALIDITY_MISSING);
+
+    if (0 == col->size)
+      return GDF_SUCCESS;
+
+    gdf_error status = cudf::type_dispatcher(col->dtype, replace_kernel_forwarder{},
+                                             col, old_values, new_values,
+                                             policy, d_default_value);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+    if (nullptr != col->valid)
+      return set_null_count(col);
     return GDF_SUCCESS;
   }
 
@@ -134,7 +377,16 @@ gdf_error gdf_find_and_replace_all(gdf_column*       col,
                                    const gdf_column* old_values,
                                    const gdf_column* new_values)
 {
-  return find_and_replace_all(col, old_values, new_values);
+  return find_and_replace(col, old_values, new_values, GDF_UNMATCHED_KEEP, nullptr);
+}
+
+gdf_error gdf_find_and_replace(gdf_column*          col,
+                               const gdf_column*    old_values,
+                               const gdf_column*    new_values,
+                               gdf_unmatched_policy policy,
+                               const gdf_column*    default_value)
+{
+  return find_and_replace(col, old_values, new_values, policy, default_value);
 }
 
 namespace{ //anonymous
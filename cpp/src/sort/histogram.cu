@@ -0,0 +1,318 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "utilities/type_dispatcher.hpp"
+#include "hash/helper_functions.cuh"
+
+#include <algorithm>
+#include <type_traits>
+
+namespace { // unnamed namespace
+
+  constexpr int HISTOGRAM_BLOCK_SIZE{256};
+
+  // Histograms up to this size are privatized in shared memory per block
+  constexpr size_t MAX_SHARED_HISTOGRAM_BYTES{32 * 1024};
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Bins a value by the number of ascending edges it passes, i.e.,
+   * its gdf_digitize index: edges `e <= x` if `right == false`, `e < x` if
+   * `right == true`. The search is branchless and takes the same number of
+   * steps for every value.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T>
+  struct edge_bins
+  {
+    T const* edges;
+    gdf_size_type num_edges;
+    bool right;
+
+    CUDA_DEVICE_CALLABLE bool passes(T edge, T value) const
+    {
+      return right ? edge < value : edge <= value;
+    }
+
+    // Returns false for values that are not binned (NaN)
+    CUDA_DEVICE_CALLABLE bool operator()(T value, gdf_size_type& bucket) const
+    {
+      if (value != value)
+        return false;
+      if (0 == num_edges) {
+        bucket = 0;
+        return true;
+      }
+      gdf_size_type base{0};
+      gdf_size_type length{num_edges};
+      while (length > 1) {
+        gdf_size_type const half{length / 2};
+        base = passes(edges[base + half], value) ? base + half : base;
+        length -= half;
+      }
+      bucket = base + passes(edges[base], value);
+      return true;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Bins a value like edge_bins for the num_bins + 1 edges
+   * `lo + k * (hi - lo) / num_bins`, computing the bin instead of searching
+   * for it. The estimate is corrected against the edges, so values on an edge
+   * are binned exactly as with the explicit edges.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct uniform_bins
+  {
+    double lo;
+    double hi;
+    gdf_size_type num_bins;
+    bool right;
+
+    CUDA_DEVICE_CALLABLE double edge(gdf_size_type k) const
+    {
+      return (k == num_bins) ? hi : lo + (hi - lo) * k / num_bins;
+    }
+
+    CUDA_DEVICE_CALLABLE bool passes(double edge, double value) const
+    {
+      return right ? edge < value : edge <= value;
+    }
+
+    template <typename T>
+    CUDA_DEVICE_CALLABLE bool operator()(T value, gdf_size_type& bucket) const
+    {
+      double const v = static_cast<double>(value);
+      if (v != v)
+        return false;
+      double const x = (v - lo) / (hi - lo) * num_bins;
+      gdf_size_type k = (x < 0) ? 0
+                      : (x > num_bins) ? num_bins + 1
+                      : static_cast<gdf_size_type>(x) + 1;
+      while (k <= num_bins && passes(edge(k), v))
+        ++k;
+      while (k > 0 && !passes(edge(k - 1), v))
+        --k;
+      bucket = k;
+      return true;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Counts, and if `sums` is not null sums, the valid values of a
+   * column per bucket. With `privatized`, every block accumulates into its
+   * own histogram in shared memory and adds it to the output once, so the
+   * global atomics do not depend on the number of rows.
+   */
+  /* ----------------------------------------------------------------------------*/
+  template <typename T, typename Binner, bool privatized>
+  __global__ void histogram_kernel(T const* data, gdf_valid_type const* valid,
+                                   gdf_size_type size, Binner binner,
+                                   gdf_size_type num_buckets,
+                                   gdf_size_type* counts, double* sums)
+  {
+    // The sums come first to keep them aligned
+    extern __shared__ double shared_histogram[];
+    double* block_sums = shared_histogram;
+    unsigned int* block_counts =
+      reinterpret_cast<unsigned int*>(shared_histogram + (nullptr != sums ? num_buckets : 0));
+
+    if (privatized) {
+      for (gdf_size_type b = threadIdx.x; b < num_buckets; b += blockDim.x) {
+        block_counts[b] = 0;
+        if (nullptr != sums)
+          block_sums[b] = 0;
+      }
+      __syncthreads();
+    }
+
+    for (gdf_size_type i = threadIdx.x + blockIdx.x * blockDim.x; i < size;
+         i += blockDim.x * gridDim.x) {
+      gdf_size_type bucket;
+      if (!gdf_is_valid(valid, i) || !binner(data[i], bucket))
+        continue;
+      if (privatized) {
+        atomicAdd(block_counts + bucket, 1u);
+        if (nullptr != sums)
+          atomicAdd(block_sums + bucket, static_cast<double>(data[i]));
+      }
+      else {
+        atomicAdd(counts + bucket, gdf_size_type{1});
+        if (nullptr != sums)
+          atomicAdd(sums + bucket, static_cast<double>(data[i]));
+      }
+    }
+
+    if (privatized) {
+      __syncthreads();
+      for (gdf_size_type b = threadIdx.x; b < num_buckets; b += blockDim.x) {
+        if (0 != block_counts[b]) {
+          atomicAdd(counts + b, static_cast<gdf_size_type>(block_counts[b]));
+          if (nullptr != sums)
+            atomicAdd(sums + b, block_sums[b]);
+        }
+      }
+    }
+  }
+
+  template <typename T, typename Binner>
+  gdf_error launch_histogram(gdf_column const* col, Binner binner,
+                             gdf_size_type num_buckets,
+                             gdf_size_type* counts, double* sums,
+                             cudaStream_t stream)
+  {
+    CUDA_TRY( cudaMemsetAsync(counts, 0, num_buckets * sizeof(gdf_size_type), stream) );
+    if (nullptr != sums)
+      CUDA_TRY( cudaMemsetAsync(sums, 0, num_buckets * sizeof(double), stream) );
+    if (0 == col->size)
+      return GDF_SUCCESS;
+
+    // Enough blocks to fill the device; more would only add flushes of the
+    // block histograms
+    int device{0}, num_sms{0};
+    CUDA_TRY( cudaGetDevice(&device) );
+    CUDA_TRY( cudaDeviceGetAttribute(&num_sms, cudaDevAttrMultiProcessorCount, device) );
+    gdf_size_type const max_blocks{num_sms * (2048 / HISTOGRAM_BLOCK_SIZE)};
+    int const grid_size = std::min(max_blocks,
+                                   (col->size + HISTOGRAM_BLOCK_SIZE - 1) / HISTOGRAM_BLOCK_SIZE);
+
+    T const* data = static_cast<T const*>(col->data);
+    size_t const shared_bytes =
+      num_buckets * (sizeof(unsigned int) + (nullptr != sums ? sizeof(double) : 0));
+
+    if (shared_bytes <= MAX_SHARED_HISTOGRAM_BYTES) {
+      histogram_kernel<T, Binner, true>
+        <<<grid_size, HISTOGRAM_BLOCK_SIZE, shared_bytes, stream>>>(
+          data, col->valid, col->size, binner, num_buckets, counts, sums);
+    }
+    else {
+      histogram_kernel<T, Binner, false>
+        <<<grid_size, HISTOGRAM_BLOCK_SIZE, 0, stream>>>(
+          data, col->valid, col->size, binner, num_buckets, counts, sums);
+    }
+    CUDA_CHECK_LAST();
+
+    return GDF_SUCCESS;
+  }
+
+  struct histogram_by_edges
+  {
+    template <typename T,
+              typename std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+    gdf_error operator()(gdf_column const* col, gdf_column const* bins, bool right,
+                         gdf_size_type* counts, double* sums, cudaStream_t stream)
+    {
+      edge_bins<T> binner{static_cast<T const*>(bins->data), bins->size, right};
+      return launch_histogram<T>(col, binner, bins->size + 1, counts, sums, stream);
+    }
+
+    template <typename T,
+              typename std::enable_if_t<!std::is_arithmetic<T>::value>* = nullptr>
+    gdf_error operator()(gdf_column const* col, gdf_column const* bins, bool right,
+                         gdf_size_type* counts, double* sums, cudaStream_t stream)
+    {
+      return GDF_UNSUPPORTED_DTYPE;
+    }
+  };
+
+  struct histogram_uniform
+  {
+    template <typename T,
+              typename std::enable_if_t<std::is_arithmetic<T>::value>* = nullptr>
+    gdf_error operator()(gdf_column const* col, uniform_bins binner,
+                         gdf_size_type* counts, double* sums, cudaStream_t stream)
+    {
+      return launch_histogram<T>(col, binner, binner.num_bins + 2, counts, sums, stream);
+    }
+
+    template <typename T,
+              typename std::enable_if_t<!std::is_arithmetic<T>::value>* = nullptr>
+    gdf_error operator()(gdf_column const* col, uniform_bins binner,
+                         gdf_size_type* counts, double* sums, cudaStream_t stream)
+    {
+      return GDF_UNSUPPORTED_DTYPE;
+    }
+  };
+
+} // end unnamed namespace
+
+gdf_error gdf_histogram(gdf_column* cols[],
+                        gdf_column* bins[],
+                        int ncols,
+                        bool right,
+                        gdf_size_type* counts[],
+                        double* sums[])
+{
+  GDF_REQUIRE(ncols >= 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(0 == ncols || (nullptr != cols && nullptr != bins && nullptr != counts),
+              GDF_DATASET_EMPTY);
+
+  for (int c = 0; c < ncols; ++c) {
+    GDF_REQUIRE(nullptr != cols[c] && nullptr != bins[c] && nullptr != counts[c],
+                GDF_DATASET_EMPTY);
+    GDF_REQUIRE(cols[c]->dtype == bins[c]->dtype, GDF_DTYPE_MISMATCH);
+    GDF_REQUIRE(!bins[c]->null_count, GDF_VALIDITY_UNSUPPORTED);
+  }
+
+  // One pass over each column computes both the counts and the sums
+  cudaStream_t stream = 0;
+  for (int c = 0; c < ncols; ++c) {
+    gdf_error status = cudf::type_dispatcher(cols[c]->dtype, histogram_by_edges{},
+                                             cols[c], bins[c], right, counts[c],
+                                             (nullptr != sums) ? sums[c] : nullptr, stream);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+  }
+
+  CUDA_TRY( cudaStreamSynchronize(stream) );
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_histogram_uniform(gdf_column* cols[],
+                                int ncols,
+                                const double lo[],
+                                const double hi[],
+                                int num_bins,
+                                bool right,
+                                gdf_size_type* counts[],
+                                double* sums[])
+{
+  GDF_REQUIRE(ncols >= 0 && num_bins > 0, GDF_INVALID_API_CALL);
+  GDF_REQUIRE(0 == ncols || (nullptr != cols && nullptr != lo && nullptr != hi && nullptr != counts),
+              GDF_DATASET_EMPTY);
+
+  for (int c = 0; c < ncols; ++c) {
+    GDF_REQUIRE(nullptr != cols[c] && nullptr != counts[c], GDF_DATASET_EMPTY);
+    // Also rejects NaN ranges
+    GDF_REQUIRE(lo[c] < hi[c], GDF_INVALID_API_CALL);
+  }
+
+  cudaStream_t stream = 0;
+  for (int c = 0; c < ncols; ++c) {
+    uniform_bins binner{lo[c], hi[c], num_bins, right};
+    gdf_error status = cudf::type_dispatcher(cols[c]->dtype, histogram_uniform{},
+                                             cols[c], binner, counts[c],
+                                             (nullptr != sums) ? sums[c] : nullptr, stream);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+  }
+
+  CUDA_TRY( cudaStreamSynchronize(stream) );
+  return GDF_SUCCESS;
+}
@@ -0,0 +1,458 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//Vectorized binary search of the rows of a table in a sorted table
+
+#include <thrust/gather.h>
+#include <thrust/transform.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <memory>
+#include <vector>
+
+#include "cudf.h"
+#include "rmm/rmm.h"
+#include "utilities/cudf_utils.h"
+#include "utilities/error_utils.h"
+#include "utilities/type_dispatcher.hpp"
+#include "utilities/wrapper_types.hpp"
+#include "rmm/thrust_rmm_allocator.h"
+
+namespace { // unnamed namespace
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A column of a table taking part in a search
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct search_column
+  {
+    void const* data;
+    gdf_valid_type const* valid;
+    gdf_dtype dtype;
+    bool descending;
+  };
+
+  struct compare_values
+  {
+    template <typename T>
+    __device__
+    int operator()(void const* lhs, gdf_index_type lhs_row,
+                   void const* rhs, gdf_index_type rhs_row)
+    {
+      T const a = static_cast<T const*>(lhs)[lhs_row];
+      T const b = static_cast<T const*>(rhs)[rhs_row];
+      return (a < b) ? -1 : (b < a) ? 1 : 0;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Compares a row of a sorted table to a row of a table of needles in
+   * the order of gdf_order_by: column by column, descending columns inverted,
+   * nulls equal to each other and smaller or larger than every value.
+   *
+   * @returns A negative value if the sorted row goes before the needle, zero
+   * if they are equal and a positive value if it goes after
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct row_comparator
+  {
+    search_column const* sorted;
+    search_column const* needles;
+    int ncols;
+    bool nulls_are_smallest;
+
+    __device__
+    int operator()(gdf_index_type sorted_row, gdf_index_type needle_row) const
+    {
+      for (int c = 0; c < ncols; ++c) {
+        bool const sorted_valid = gdf_is_valid(sorted[c].valid, sorted_row);
+        bool const needle_valid = gdf_is_valid(needles[c].valid, needle_row);
+        int result{0};
+        if (sorted_valid && needle_valid) {
+          result = cudf::type_dispatcher(sorted[c].dtype, compare_values{},
+                                         sorted[c].data, sorted_row,
+                                         needles[c].data, needle_row);
+        }
+        else if (sorted_valid != needle_valid) {
+          result = (sorted_valid == nulls_are_smallest) ? 1 : -1;
+        }
+        if (0 != result) {
+          return sorted[c].descending ? -result : result;
+        }
+      }
+      return 0;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Finds the position of a needle in the sorted table by bisection:
+   * the first row not before it (left) or the first row after it (right)
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct bisect
+  {
+    row_comparator compare;
+    gdf_size_type num_sorted;
+    bool right;
+
+    __device__
+    gdf_index_type operator()(gdf_index_type needle_row) const
+    {
+      gdf_index_type first{0};
+      gdf_size_type count{num_sorted};
+      while (count > 0) {
+        gdf_size_type const step{count / 2};
+        int const result = compare(first + step, needle_row);
+        if (result < 0 || (right && 0 == result)) {
+          first += step + 1;
+          count -= step + 1;
+        }
+        else {
+          count = step;
+        }
+      }
+      return first;
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Same as bisect for a sorted table stored in Eytzinger (breadth
+   * first) order from position 1. The rows compared at the top of the implicit
+   * tree are few and adjacent, so they stay in cache across the searches.
+   *
+   * The descent ends past a leaf; stripping the trailing right turns and the
+   * last left turn gives the node of the result, 0 meaning past the end.
+   */
+  /* ----------------------------------------------------------------------------*/
+  struct eytzinger_search
+  {
+    row_comparator compare;
+    gdf_index_type const* sorted_position;
+    gdf_size_type num_sorted;
+    bool right;
+
+    __device__
+    gdf_index_type operator()(gdf_index_type needle_row) const
+    {
+      unsigned long long k{1};
+      while (k <= static_cast<unsigned long long>(num_sorted)) {
+        int const result = compare(static_cast<gdf_index_type>(k), needle_row);
+        k = 2 * k + ((result < 0 || (right && 0 == result)) ? 1 : 0);
+      }
+      k >>= __ffsll(static_cast<long long>(~k));
+      return (0 == k) ? num_sorted : sorted_position[k];
+    }
+  };
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Gathers the validity bits of `map` into `out`, one byte per thread
+   */
+  /* ----------------------------------------------------------------------------*/
+  __global__
+  void gather_valid_bits(gdf_valid_type const* valid, gdf_index_type const* map,
+                         gdf_size_type size, gdf_valid_type* out)
+  {
+    gdf_size_type const byte = threadIdx.x + static_cast<gdf_size_type>(blockIdx.x) * blockDim.x;
+    if (byte >= gdf_get_num_chars_bitmask(size)) {
+      return;
+    }
+    gdf_valid_type bits{0};
+    for (int b = 0; b < GDF_VALID_BITSIZE; ++b) {
+      gdf_size_type const row = byte * GDF_VALID_BITSIZE + b;
+      if (row < size && gdf_is_valid(valid, map[row])) {
+        bits |= gdf_valid_type{1} << b;
+      }
+    }
+    out[byte] = bits;
+  }
+
+  struct gather_values
+  {
+    template <typename T>
+    void operator()(void const* data, gdf_index_type const* map, gdf_size_type size,
+                    void* out, cudaStream_t stream)
+    {
+      thrust::gather(rmm::exec_policy(stream)->on(stream), map, map + size,
+                     static_cast<T const*>(data), static_cast<T*>(out));
+    }
+  };
+
+  struct type_size
+  {
+    template <typename T>
+    size_t operator()()
+    {
+      return sizeof(T);
+    }
+  };
+
+  bool is_searchable(gdf_dtype dtype)
+  {
+    switch (dtype) {
+      case GDF_INT8: case GDF_INT16: case GDF_INT32: case GDF_INT64:
+      case GDF_FLOAT32: case GDF_FLOAT64:
+      case GDF_DATE32: case GDF_DATE64: case GDF_TIMESTAMP: case GDF_CATEGORY:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Describes the columns of a table for the device, checking they
+   * have a supported type and the same size
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error describe_columns(gdf_column** cols, size_t ncols,
+                             std::vector<int8_t> const& asc_desc,
+                             std::vector<search_column>& columns)
+  {
+    GDF_REQUIRE(0 == ncols || nullptr != cols, GDF_DATASET_EMPTY);
+    columns.clear();
+    for (size_t c = 0; c < ncols; ++c) {
+      GDF_REQUIRE(nullptr != cols[c], GDF_DATASET_EMPTY);
+      GDF_REQUIRE(cols[c]->size == cols[0]->size, GDF_COLUMN_SIZE_MISMATCH);
+      GDF_REQUIRE(is_searchable(cols[c]->dtype), GDF_UNSUPPORTED_DTYPE);
+      bool const has_nulls{(nullptr != cols[c]->valid) && (cols[c]->null_count > 0)};
+      columns.push_back(search_column{cols[c]->data, has_nulls ? cols[c]->valid : nullptr,
+                                      cols[c]->dtype, asc_desc[c] == GDF_ORDER_DESC});
+    }
+    return GDF_SUCCESS;
+  }
+
+  gdf_error read_asc_desc(int8_t const* asc_desc, size_t ncols, std::vector<int8_t>& h_asc_desc)
+  {
+    h_asc_desc.assign(ncols, GDF_ORDER_ASC);
+    if (nullptr != asc_desc && ncols > 0) {
+      CUDA_TRY( cudaMemcpy(h_asc_desc.data(), asc_desc, ncols * sizeof(int8_t), cudaMemcpyDeviceToHost) );
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Checks the needles match the sorted columns and the output
+   */
+  /* ----------------------------------------------------------------------------*/
+  gdf_error check_needles(std::vector<search_column> const& sorted,
+                          gdf_column** needle_cols, gdf_column const* output)
+  {
+    GDF_REQUIRE(nullptr != output, GDF_DATASET_EMPTY);
+    GDF_REQUIRE(GDF_INDEX_DTYPE == output->dtype, GDF_UNSUPPORTED_DTYPE);
+    if (sorted.empty()) {
+      return GDF_SUCCESS;
+    }
+    GDF_REQUIRE(nullptr != needle_cols, GDF_DATASET_EMPTY);
+    for (size_t c = 0; c < sorted.size(); ++c) {
+      GDF_REQUIRE(nullptr != needle_cols[c], GDF_DATASET_EMPTY);
+      GDF_REQUIRE(needle_cols[c]->dtype == sorted[c].dtype, GDF_DTYPE_MISMATCH);
+      GDF_REQUIRE(needle_cols[c]->size == output->size, GDF_COLUMN_SIZE_MISMATCH);
+    }
+    return GDF_SUCCESS;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief Computes the sorted position of every node of the Eytzinger tree of
+   * `size` rows by an in-order traversal
+   */
+  /* ----------------------------------------------------------------------------*/
+  void eytzinger_order(std::vector<gdf_index_type>& sorted_position, gdf_size_type size,
+                       unsigned long long k, gdf_index_type& next)
+  {
+    if (k <= static_cast<unsigned long long>(size)) {
+      eytzinger_order(sorted_position, size, 2 * k, next);
+      sorted_position[k] = next++;
+      eytzinger_order(sorted_position, size, 2 * k + 1, next);
+    }
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief A sorted table copied into Eytzinger order for repeated searches
+   */
+  /* ----------------------------------------------------------------------------*/
+  class SearchIndex
+  {
+  public:
+    gdf_error build(gdf_column** cols, size_t ncols, int8_t const* asc_desc, bool nulls_are_smallest)
+    {
+      nulls_are_smallest_ = nulls_are_smallest;
+
+      std::vector<int8_t> h_asc_desc;
+      gdf_error status = read_asc_desc(asc_desc, ncols, h_asc_desc);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      status = describe_columns(cols, ncols, h_asc_desc, columns_);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+      size_ = (ncols > 0) ? cols[0]->size : 0;
+
+      // Position 0 is unused; it maps to row 0 so every gather is in bounds
+      std::vector<gdf_index_type> h_sorted_position(size_ + 1, 0);
+      gdf_index_type next{0};
+      eytzinger_order(h_sorted_position, size_, 1, next);
+      sorted_position_ = h_sorted_position;
+
+      if (0 == size_) {
+        return GDF_SUCCESS;
+      }
+
+      cudaStream_t stream = 0;
+      gdf_index_type const* map = sorted_position_.data().get();
+      gdf_size_type const num_slots{size_ + 1};
+      for (auto& column : columns_) {
+        size_t const width = cudf::type_dispatcher(column.dtype, type_size{});
+        data_.emplace_back(num_slots * width);
+        cudf::type_dispatcher(column.dtype, gather_values{}, column.data, map, num_slots,
+                              static_cast<void*>(data_.back().data().get()), stream);
+        column.data = data_.back().data().get();
+
+        if (nullptr != column.valid) {
+          valid_.emplace_back(gdf_get_num_chars_bitmask(num_slots));
+          constexpr int block_size{256};
+          gdf_size_type const num_bytes{gdf_get_num_chars_bitmask(num_slots)};
+          gather_valid_bits<<<(num_bytes + block_size - 1) / block_size, block_size, 0, stream>>>(
+              column.valid, map, num_slots, valid_.back().data().get());
+          CUDA_CHECK_LAST();
+          column.valid = valid_.back().data().get();
+        }
+      }
+      d_columns_ = columns_;
+
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+      return GDF_SUCCESS;
+    }
+
+    gdf_error lookup(gdf_column** needle_cols, bool right, gdf_column* output) const
+    {
+      gdf_error status = check_needles(columns_, needle_cols, output);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+      std::vector<int8_t> asc_desc;
+      for (auto const& column : columns_) {
+        asc_desc.push_back(column.descending ? GDF_ORDER_DESC : GDF_ORDER_ASC);
+      }
+      std::vector<search_column> needles;
+      status = describe_columns(needle_cols, columns_.size(), asc_desc, needles);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      rmm::device_vector<search_column> d_needles(needles);
+
+      cudaStream_t stream = 0;
+      gdf_index_type* out = static_cast<gdf_index_type*>(output->data);
+      row_comparator const compare{d_columns_.data().get(), d_needles.data().get(),
+                                   static_cast<int>(columns_.size()), nulls_are_smallest_};
+      thrust::transform(rmm::exec_policy(stream)->on(stream),
+                        thrust::make_counting_iterator<gdf_index_type>(0),
+                        thrust::make_counting_iterator<gdf_index_type>(output->size), out,
+                        eytzinger_search{compare, sorted_position_.data().get(), size_, right});
+
+      CUDA_TRY( cudaStreamSynchronize(stream) );
+      return GDF_SUCCESS;
+    }
+
+  private:
+    std::vector<search_column> columns_;
+    rmm::device_vector<search_column> d_columns_;
+    std::vector<rmm::device_vector<char>> data_;
+    std::vector<rmm::device_vector<gdf_valid_type>> valid_;
+    rmm::device_vector<gdf_index_type> sorted_position_;
+    gdf_size_type size_{0};
+    bool nulls_are_smallest_{false};
+  };
+
+  gdf_search_index_type* cffi_wrap(SearchIndex* obj){
+    return reinterpret_cast<gdf_search_index_type*>(obj);
+  }
+
+  SearchIndex* cffi_unwrap(gdf_search_index_type* hdl){
+    return reinterpret_cast<SearchIndex*>(hdl);
+  }
+
+} // end unnamed namespace
+
+gdf_error gdf_search_sorted(gdf_column** sorted_cols,
+                            gdf_column** needle_cols,
+                            size_t ncols,
+                            int8_t* asc_desc,
+                            int flag_nulls_are_smallest,
+                            gdf_search_side side,
+                            gdf_column* output)
+{
+  std::vector<int8_t> h_asc_desc;
+  gdf_error status = read_asc_desc(asc_desc, ncols, h_asc_desc);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+  std::vector<search_column> sorted, needles;
+  status = describe_columns(sorted_cols, ncols, h_asc_desc, sorted);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+  status = check_needles(sorted, needle_cols, output);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+  status = describe_columns(needle_cols, ncols, h_asc_desc, needles);
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+
+  if (0 == output->size) {
+    return GDF_SUCCESS;
+  }
+
+  rmm::device_vector<search_column> d_sorted(sorted);
+  rmm::device_vector<search_column> d_needles(needles);
+
+  cudaStream_t stream = 0;
+  gdf_index_type* out = static_cast<gdf_index_type*>(output->data);
+  row_comparator const compare{d_sorted.data().get(), d_needles.data().get(),
+                               static_cast<int>(ncols), 0 != flag_nulls_are_smallest};
+  gdf_size_type const num_sorted{(ncols > 0) ? sorted_cols[0]->size : 0};
+  thrust::transform(rmm::exec_policy(stream)->on(stream),
+                    thrust::make_counting_iterator<gdf_index_type>(0),
+                    thrust::make_counting_iterator<gdf_index_type>(output->size), out,
+                    bisect{compare, num_sorted, GDF_SEARCH_RIGHT == side});
+
+  CUDA_TRY( cudaStreamSynchronize(stream) );
+  return GDF_SUCCESS;
+}
+
+gdf_search_index_type* gdf_search_index(gdf_column** sorted_cols,
+                                        size_t ncols,
+                                        int8_t* asc_desc,
+                                        int flag_nulls_are_smallest)
+{
+  std::unique_ptr<SearchIndex> index(new SearchIndex);
+  if (GDF_SUCCESS != index->build(sorted_cols, ncols, asc_desc, 0 != flag_nulls_are_smallest)) {
+    return nullptr;
+  }
+  return cffi_wrap(index.release());
+}
+
+gdf_error gdf_search_index_free(gdf_search_index_type* hdl)
+{
+  delete cffi_unwrap(hdl);
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_search_index_lookup(gdf_search_index_type* hdl,
+                                  gdf_column** needle_cols,
+                                  gdf_search_side side,
+                                  gdf_column* output)
+{
+  GDF_REQUIRE(nullptr != hdl, GDF_INVALID_API_CALL);
+  return cffi_unwrap(hdl)->lookup(needle_cols, GDF_SEARCH_RIGHT == side, output);
+}
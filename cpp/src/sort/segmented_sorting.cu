@@ -2,8 +2,22 @@
 #include "rmm/rmm.h"
 #include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
 
+#include "rmm/thrust_rmm_allocator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <thrust/copy.h>
+#include <thrust/gather.h>
+#include <thrust/iterator/counting_iterator.h>
+
+#include <cub/block/block_radix_sort.cuh>
 #include <cub/device/device_segmented_radix_sort.cuh>
 
 
@@ -32,15 +46,15 @@ struct SegmentedRadixSortPlan{
     gdf_error setup(size_t sizeof_key, size_t sizeof_val) {
         back_key_size = num_items * sizeof_key;
         back_val_size = num_items * sizeof_val;
-        RMM_TRY( RMM_ALLOC(&back_key, back_key_size, stream) ); // TODO: non-default stream
-        RMM_TRY( RMM_ALLOC(&back_val, back_val_size, stream) );
+        SCRATCH_ALLOC_TRY(&back_key, back_key_size, stream); // TODO: non-default stream
+        SCRATCH_ALLOC_TRY(&back_val, back_val_size, stream);
         return GDF_SUCCESS;
     }
 
     gdf_error teardown() {
-        RMM_TRY(RMM_FREE(back_key, stream));
-        RMM_TRY(RMM_FREE(back_val, stream));
-        RMM_TRY(RMM_FREE(storage, stream));
+        SCRATCH_FREE_TRY(back_key, stream);
+        SCRATCH_FREE_TRY(back_val, stream);
+        SCRATCH_FREE_TRY(storage, stream);
         return GDF_SUCCESS;
     }
 };
@@ -48,9 +62,287 @@ struct SegmentedRadixSortPlan{
 
 
 
+// Segments of up to TINY_SEGMENT_SIZE items are sorted by a single thread in
+// registers, segments of up to MEDIUM_SEGMENT_SIZE items by a thread block in
+// shared memory. Only the larger segments go to the device-wide segmented
+// radix sort, whose per-segment overhead dominates for short segments.
+constexpr unsigned TINY_SEGMENT_SIZE{8};
+constexpr int MEDIUM_BLOCK_THREADS{128};
+constexpr int MEDIUM_ITEMS_PER_THREAD{8};
+constexpr unsigned MEDIUM_SEGMENT_SIZE{MEDIUM_BLOCK_THREADS * MEDIUM_ITEMS_PER_THREAD};
+
+// On the host, segments up to this size are insertion sorted
+constexpr unsigned HOST_INSERTION_SORT_SIZE{16};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Extracts the bits [begin_bit, end_bit) of a key in the order
+ * preserving representation used by the CUB radix sorts, so every strategy
+ * orders keys exactly like the radix sort would.
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename Tk>
+struct RadixDigit {
+    using UnsignedBits = typename cub::Traits<Tk>::UnsignedBits;
+
+    unsigned begin_bit, end_bit;
+
+    __host__ __device__
+    UnsignedBits operator()(Tk key) const {
+        UnsignedBits bits = cub::Traits<Tk>::TwiddleIn(reinterpret_cast<UnsignedBits&>(key));
+        unsigned const num_bits = end_bit - begin_bit;
+        bits >>= begin_bit;
+        if (num_bits < 8 * sizeof(UnsignedBits))
+            bits &= (UnsignedBits{1} << num_bits) - 1;
+        return bits;
+    }
+
+    // Whether key a sorts strictly before key b
+    __host__ __device__
+    bool before(Tk a, Tk b, bool descending) const {
+        return descending ? (*this)(b) < (*this)(a) : (*this)(a) < (*this)(b);
+    }
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Sorts segments of at most TINY_SEGMENT_SIZE items, one per thread,
+ * with an insertion sort over registers. V is cub::NullType when sorting keys
+ * only.
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename Tk, typename V>
+__global__ void sort_tiny_segments(Tk *keys, V *values,
+                                   const unsigned *segment_ids, unsigned num_ids,
+                                   const unsigned *begin_offsets,
+                                   const unsigned *end_offsets,
+                                   bool descending, RadixDigit<Tk> digit)
+{
+    unsigned const i = threadIdx.x + blockIdx.x * blockDim.x;
+    if (i >= num_ids)
+        return;
+
+    unsigned const segment = segment_ids[i];
+    unsigned const begin = begin_offsets[segment];
+    unsigned const size = end_offsets[segment] - begin;
+
+    Tk thread_keys[TINY_SEGMENT_SIZE];
+    V thread_values[TINY_SEGMENT_SIZE];
+    #pragma unroll
+    for (unsigned j = 0; j < TINY_SEGMENT_SIZE; ++j) {
+        if (j < size) {
+            thread_keys[j] = keys[begin + j];
+            if (nullptr != values)
+                thread_values[j] = values[begin + j];
+        }
+    }
+
+    // Stable: an item only moves past strictly greater items
+    #pragma unroll
+    for (unsigned j = 1; j < TINY_SEGMENT_SIZE; ++j) {
+        #pragma unroll
+        for (unsigned k = j; k > 0; --k) {
+            if (j < size && digit.before(thread_keys[k], thread_keys[k - 1], descending)) {
+                Tk const key = thread_keys[k];
+                thread_keys[k] = thread_keys[k - 1];
+                thread_keys[k - 1] = key;
+                V const value = thread_values[k];
+                thread_values[k] = thread_values[k - 1];
+                thread_values[k - 1] = value;
+            }
+        }
+    }
+
+    #pragma unroll
+    for (unsigned j = 0; j < TINY_SEGMENT_SIZE; ++j) {
+        if (j < size) {
+            keys[begin + j] = thread_keys[j];
+            if (nullptr != values)
+                values[begin + j] = thread_values[j];
+        }
+    }
+}
+
+template <typename BlockSort, typename Tk, typename V, int N>
+__device__ void block_sort(BlockSort &sorter, Tk (&keys)[N], V (&values)[N],
+                           bool descending, int begin_bit, int end_bit)
+{
+    if (descending)
+        sorter.SortDescending(keys, values, begin_bit, end_bit);
+    else
+        sorter.Sort(keys, values, begin_bit, end_bit);
+}
+
+template <typename BlockSort, typename Tk, int N>
+__device__ void block_sort(BlockSort &sorter, Tk (&keys)[N], cub::NullType (&values)[N],
+                           bool descending, int begin_bit, int end_bit)
+{
+    if (descending)
+        sorter.SortDescending(keys, begin_bit, end_bit);
+    else
+        sorter.Sort(keys, begin_bit, end_bit);
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Sorts segments of at most MEDIUM_SEGMENT_SIZE items, one per thread
+ * block, with a block-wide radix sort in shared memory. Unused slots are
+ * padded with a key that sorts last; the sort is stable and the padding
+ * follows the items, so it never moves ahead of equal keys.
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename Tk, typename V>
+__global__ void sort_medium_segments(Tk *keys, V *values,
+                                     const unsigned *segment_ids,
+                                     const unsigned *begin_offsets,
+                                     const unsigned *end_offsets,
+                                     bool descending, int begin_bit, int end_bit)
+{
+    using BlockSort = cub::BlockRadixSort<Tk, MEDIUM_BLOCK_THREADS, MEDIUM_ITEMS_PER_THREAD, V>;
+    using UnsignedBits = typename cub::Traits<Tk>::UnsignedBits;
+    __shared__ typename BlockSort::TempStorage temp_storage;
+
+    unsigned const segment = segment_ids[blockIdx.x];
+    unsigned const begin = begin_offsets[segment];
+    unsigned const size = end_offsets[segment] - begin;
+
+    UnsignedBits padding_bits = cub::Traits<Tk>::TwiddleOut(descending ? UnsignedBits{0} : ~UnsignedBits{0});
+    Tk const padding = reinterpret_cast<Tk&>(padding_bits);
+
+    Tk thread_keys[MEDIUM_ITEMS_PER_THREAD];
+    V thread_values[MEDIUM_ITEMS_PER_THREAD];
+    #pragma unroll
+    for (int j = 0; j < MEDIUM_ITEMS_PER_THREAD; ++j) {
+        unsigned const item = threadIdx.x * MEDIUM_ITEMS_PER_THREAD + j;
+        thread_keys[j] = (item < size) ? keys[begin + item] : padding;
+        if (nullptr != values && item < size)
+            thread_values[j] = values[begin + item];
+    }
+
+    BlockSort sorter(temp_storage);
+    block_sort(sorter, thread_keys, thread_values, descending, begin_bit, end_bit);
+
+    #pragma unroll
+    for (int j = 0; j < MEDIUM_ITEMS_PER_THREAD; ++j) {
+        unsigned const item = threadIdx.x * MEDIUM_ITEMS_PER_THREAD + j;
+        if (item < size) {
+            keys[begin + item] = thread_keys[j];
+            if (nullptr != values)
+                values[begin + item] = thread_values[j];
+        }
+    }
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Copies the items of the listed segments from src to dst, one thread
+ * block per segment
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename T>
+__global__ void copy_segments(T *dst, const T *src,
+                              const unsigned *begin_offsets,
+                              const unsigned *end_offsets)
+{
+    unsigned const begin = begin_offsets[blockIdx.x];
+    unsigned const end = end_offsets[blockIdx.x];
+    for (unsigned i = begin + threadIdx.x; i < end; i += blockDim.x)
+        dst[i] = src[i];
+}
+
+struct SegmentSizeBetween {
+    const unsigned *begin_offsets, *end_offsets;
+    unsigned min_size, max_size;
+
+    __device__
+    bool operator()(unsigned segment) const {
+        unsigned const size = end_offsets[segment] - begin_offsets[segment];
+        return (size >= min_size) && (size <= max_size);
+    }
+};
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief Sorts segments of host memory with a pool of threads. Segments are
+ * handed out largest first from a shared counter, so threads that finish
+ * early pick up the remaining work.
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename Tk, typename Tv>
+void sort_segments_host(Tk *keys, Tv *values,
+                        unsigned num_segments,
+                        const unsigned *begin_offsets,
+                        const unsigned *end_offsets,
+                        bool descending, RadixDigit<Tk> digit)
+{
+    std::vector<unsigned> order(num_segments);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](unsigned a, unsigned b) {
+        return (end_offsets[a] - begin_offsets[a]) > (end_offsets[b] - begin_offsets[b]);
+    });
+
+    auto before = [&](Tk a, Tk b) { return digit.before(a, b, descending); };
+
+    std::atomic<size_t> next_segment{0};
+    auto worker = [&]() {
+        std::vector<unsigned> permutation;
+        std::vector<Tk> key_scratch;
+        std::vector<Tv> value_scratch;
+
+        for (size_t i = next_segment++; i < order.size(); i = next_segment++) {
+            unsigned const begin = begin_offsets[order[i]];
+            unsigned const size = end_offsets[order[i]] - begin;
+            Tk *segment_keys = keys + begin;
+            Tv *segment_values = (nullptr != values) ? values + begin : nullptr;
+
+            if (size <= HOST_INSERTION_SORT_SIZE) {
+                for (unsigned j = 1; j < size; ++j) {
+                    for (unsigned k = j; k > 0 && before(segment_keys[k], segment_keys[k - 1]); --k) {
+                        std::swap(segment_keys[k], segment_keys[k - 1]);
+                        if (nullptr != segment_values)
+                            std::swap(segment_values[k], segment_values[k - 1]);
+                    }
+                }
+                continue;
+            }
+
+            permutation.resize(size);
+            std::iota(permutation.begin(), permutation.end(), 0);
+            std::stable_sort(permutation.begin(), permutation.end(), [&](unsigned a, unsigned b) {
+                return before(segment_keys[a], segment_keys[b]);
+            });
+
+            key_scratch.assign(segment_keys, segment_keys + size);
+            for (unsigned j = 0; j < size; ++j)
+                segment_keys[j] = key_scratch[permutation[j]];
+            if (nullptr != segment_values) {
+                value_scratch.assign(segment_values, segment_values + size);
+                for (unsigned j = 0; j < size; ++j)
+                    segment_values[j] = value_scratch[permutation[j]];
+            }
+        }
+    };
+
+    unsigned const num_threads = std::max(1u, std::min(std::thread::hardware_concurrency(), num_segments));
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < num_threads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (auto &thread : threads)
+        thread.join();
+}
+
 template <typename Tk, typename Tv>
 struct SegmentedRadixSort {
 
+    /* --------------------------------------------------------------------------*/
+    /**
+     * @brief Sorts the segments with the strategy that suits their size:
+     * tiny ones per thread, medium ones per block and large ones with the
+     * device-wide segmented radix sort. Columns in host memory are sorted on
+     * the host, with host offsets.
+     */
+    /* ----------------------------------------------------------------------------*/
     static
     gdf_error sort( SegmentedRadixSortPlan *plan,
                     Tk *d_key_buf, Tv *d_value_buf,
@@ -58,7 +350,80 @@ struct SegmentedRadixSort {
                     unsigned *d_begin_offsets,
                     unsigned *d_end_offsets) {
 
-        unsigned  num_items = plan->num_items;
+        // cub::DeviceRadixSort takes the number of items as an int
+        GDF_REQUIRE(plan->num_items <= std::numeric_limits<int>::max(),
+                    GDF_COLUMN_SIZE_TOO_BIG);
+        GDF_REQUIRE(plan->begin_bit < plan->end_bit && plan->end_bit <= 8 * sizeof(Tk),
+                    GDF_INVALID_API_CALL);
+
+        if (0 == num_segments || 0 == plan->num_items)
+            return GDF_SUCCESS;
+
+        cudaStream_t stream = plan->stream;
+        bool const descending = plan->descending;
+        RadixDigit<Tk> const digit{plan->begin_bit, plan->end_bit};
+
+        if (is_host_memory(d_key_buf)) {
+            sort_segments_host(d_key_buf, d_value_buf, num_segments,
+                               d_begin_offsets, d_end_offsets, descending, digit);
+            return GDF_SUCCESS;
+        }
+
+        // Group the segments by size class
+        rmm::device_vector<unsigned> tiny(num_segments), medium(num_segments), large(num_segments);
+        auto segments = thrust::make_counting_iterator<unsigned>(0);
+        unsigned const num_tiny = thrust::copy_if(rmm::exec_policy(stream)->on(stream),
+            segments, segments + num_segments, tiny.begin(),
+            SegmentSizeBetween{d_begin_offsets, d_end_offsets, 2, TINY_SEGMENT_SIZE}) - tiny.begin();
+        unsigned const num_medium = thrust::copy_if(rmm::exec_policy(stream)->on(stream),
+            segments, segments + num_segments, medium.begin(),
+            SegmentSizeBetween{d_begin_offsets, d_end_offsets, TINY_SEGMENT_SIZE + 1, MEDIUM_SEGMENT_SIZE}) - medium.begin();
+        unsigned const num_large = thrust::copy_if(rmm::exec_policy(stream)->on(stream),
+            segments, segments + num_segments, large.begin(),
+            SegmentSizeBetween{d_begin_offsets, d_end_offsets, MEDIUM_SEGMENT_SIZE + 1,
+                               std::numeric_limits<unsigned>::max()}) - large.begin();
+
+        if (num_tiny > 0) {
+            constexpr int block_size{128};
+            sort_tiny_segments<<<(num_tiny + block_size - 1) / block_size, block_size, 0, stream>>>(
+                d_key_buf, d_value_buf, tiny.data().get(), num_tiny,
+                d_begin_offsets, d_end_offsets, descending, digit);
+            CUDA_CHECK_LAST();
+        }
+
+        if (num_medium > 0) {
+            if (d_value_buf) {
+                sort_medium_segments<<<num_medium, MEDIUM_BLOCK_THREADS, 0, stream>>>(
+                    d_key_buf, d_value_buf, medium.data().get(),
+                    d_begin_offsets, d_end_offsets, descending,
+                    plan->begin_bit, plan->end_bit);
+            } else {
+                sort_medium_segments<<<num_medium, MEDIUM_BLOCK_THREADS, 0, stream>>>(
+                    d_key_buf, static_cast<cub::NullType*>(nullptr), medium.data().get(),
+                    d_begin_offsets, d_end_offsets, descending,
+                    plan->begin_bit, plan->end_bit);
+            }
+            CUDA_CHECK_LAST();
+        }
+
+        if (num_large > 0) {
+            gdf_error status = sort_large(plan, d_key_buf, d_value_buf, large, num_large,
+                                          d_begin_offsets, d_end_offsets);
+            GDF_REQUIRE(GDF_SUCCESS == status, status);
+        }
+
+        return GDF_SUCCESS;
+    }
+
+    static
+    gdf_error sort_large( SegmentedRadixSortPlan *plan,
+                          Tk *d_key_buf, Tv *d_value_buf,
+                          rmm::device_vector<unsigned> const& segment_ids,
+                          unsigned num_segments,
+                          unsigned *d_begin_offsets,
+                          unsigned *d_end_offsets) {
+
+        const int num_items = plan->num_items;
         Tk *d_key_alt_buf = (Tk*)plan->back_key;
         Tv *d_value_alt_buf = (Tv*)plan->back_val;
 
@@ -67,93 +432,74 @@ struct SegmentedRadixSort {
         unsigned begin_bit = plan->begin_bit;
         unsigned end_bit = plan->end_bit;
 
+        // The offsets of the large segments only
+        rmm::device_vector<unsigned> begin_offsets(num_segments), end_offsets(num_segments);
+        thrust::gather(rmm::exec_policy(stream)->on(stream),
+                       segment_ids.begin(), segment_ids.begin() + num_segments,
+                       d_begin_offsets, begin_offsets.begin());
+        thrust::gather(rmm::exec_policy(stream)->on(stream),
+                       segment_ids.begin(), segment_ids.begin() + num_segments,
+                       d_end_offsets, end_offsets.begin());
+
         cub::DoubleBuffer<Tk> d_keys(d_key_buf, d_key_alt_buf);
+        cub::DoubleBuffer<Tv> d_values(d_value_buf, d_value_alt_buf);
 
         typedef cub::DeviceSegmentedRadixSort Sorter;
 
-        if (d_value_buf) {
-            // Sort KeyValue pairs
-            cub::DoubleBuffer<Tv> d_values(d_value_buf, d_value_alt_buf);
-            if (descending) {
-                Sorter::SortPairsDescending(plan->storage,
-                                            plan->storage_bytes,
-                                            d_keys,
-                                            d_values,
-                                            num_items,
-                                            num_segments,
-                                            d_begin_offsets,
-                                            d_end_offsets,
-                                            begin_bit,
-                                            end_bit,
-                                            stream);
+        // The first pass only computes the temporary storage requirement,
+        // which grows the plan's storage if needed
+        for (int pass = 0; pass < 2; ++pass) {
+            void *storage = (0 == pass) ? nullptr : plan->storage;
+            size_t storage_bytes = plan->storage_bytes;
+
+            if (d_value_buf) {
+                if (descending) {
+                    Sorter::SortPairsDescending(storage, storage_bytes, d_keys, d_values,
+                                                num_items, num_segments,
+                                                begin_offsets.data().get(), end_offsets.data().get(),
+                                                begin_bit, end_bit, stream);
+                } else {
+                    Sorter::SortPairs(storage, storage_bytes, d_keys, d_values,
+                                      num_items, num_segments,
+                                      begin_offsets.data().get(), end_offsets.data().get(),
+                                      begin_bit, end_bit, stream);
+                }
             } else {
-                Sorter::SortPairs(  plan->storage,
-                                    plan->storage_bytes,
-                                    d_keys,
-                                    d_values,
-                                    num_items,
-                                    num_segments,
-                                    d_begin_offsets,
-                                    d_end_offsets,
-                                    begin_bit,
-                                    end_bit,
-                                    stream    );
+                if (descending) {
+                    Sorter::SortKeysDescending(storage, storage_bytes, d_keys,
+                                               num_items, num_segments,
+                                               begin_offsets.data().get(), end_offsets.data().get(),
+                                               begin_bit, end_bit, stream);
+                } else {
+                    Sorter::SortKeys(storage, storage_bytes, d_keys,
+                                     num_items, num_segments,
+                                     begin_offsets.data().get(), end_offsets.data().get(),
+                                     begin_bit, end_bit, stream);
+                }
             }
             CUDA_CHECK_LAST();
-            if (plan->storage && d_value_buf != d_values.Current()){
-                cudaMemcpyAsync(d_value_buf, d_value_alt_buf,
-                                num_items * sizeof(Tv),
-                                cudaMemcpyDeviceToDevice,
-                                stream);
-                CUDA_CHECK_LAST();
-            }
-        } else {
-            // Sort Keys only
-            if (descending) {
-                Sorter::SortKeysDescending(   plan->storage,
-                                              plan->storage_bytes,
-                                              d_keys,
-                                              num_items,
-                                              num_segments,
-                                              d_begin_offsets,
-                                              d_end_offsets,
-                                              begin_bit,
-                                              end_bit,
-                                              stream  );
-                CUDA_CHECK_LAST()
 
-            } else {
-                Sorter::SortKeys( plan->storage,
-                                  plan->storage_bytes,
-                                  d_keys,
-                                  num_items,
-                                  num_segments,
-                                  d_begin_offsets,
-                                  d_end_offsets,
-                                  begin_bit,
-                                  end_bit,
-                                  stream  );
+            if (0 == pass && storage_bytes > plan->storage_bytes) {
+                SCRATCH_FREE_TRY(plan->storage, stream);
+                SCRATCH_ALLOC_TRY(&plan->storage, storage_bytes, stream);
+                plan->storage_bytes = storage_bytes;
             }
+        }
 
+        // Only the sorted segments are valid in the alternate buffers
+        if (d_key_buf != d_keys.Current()) {
+            copy_segments<<<num_segments, MEDIUM_BLOCK_THREADS, 0, stream>>>(
+                d_key_buf, d_keys.Current(), begin_offsets.data().get(), end_offsets.data().get());
             CUDA_CHECK_LAST();
         }
-
-        if ( plan->storage ) {
-            // We have operated and the result is not in front buffer
-            if (d_key_buf != d_keys.Current()){
-                cudaMemcpyAsync(d_key_buf, d_key_alt_buf, num_items * sizeof(Tk),
-                                          cudaMemcpyDeviceToDevice, stream);
-                CUDA_CHECK_LAST();
-            }
-        } else {
-            // We have not operated.
-            // Just checking for temporary storage requirement
-            RMM_TRY( RMM_ALLOC(&plan->storage, plan->storage_bytes, plan->stream) ); // TODO: non-default stream
+        if (d_value_buf && d_value_buf != d_values.Current()) {
+            copy_segments<<<num_segments, MEDIUM_BLOCK_THREADS, 0, stream>>>(
+                d_value_buf, d_values.Current(), begin_offsets.data().get(), end_offsets.data().get());
             CUDA_CHECK_LAST();
-            // Now that we have allocated, do real work.
-            return sort(plan, d_key_buf, d_value_buf, num_segments,
-                        d_begin_offsets, d_end_offsets);
         }
+
+        // The offset vectors are released on return
+        CUDA_TRY( cudaStreamSynchronize(stream) );
         return GDF_SUCCESS;
     }
 };
@@ -2,6 +2,9 @@
 #include "rmm/rmm.h"
 #include "utilities/cudf_utils.h"
 #include "utilities/error_utils.h"
+#include "utilities/allocator.hpp"
+
+#include <limits>
 
 #include <cub/device/device_radix_sort.cuh>
 
@@ -30,15 +33,15 @@ struct RadixSortPlan{
     gdf_error setup(size_t sizeof_key, size_t sizeof_val) {
         back_key_size = num_items * sizeof_key;
         back_val_size = num_items * sizeof_val;
-        RMM_TRY( RMM_ALLOC(&back_key, back_key_size, stream) ); // TODO: non-default stream
-        RMM_TRY( RMM_ALLOC(&back_val, back_val_size, stream) );
+        SCRATCH_ALLOC_TRY(&back_key, back_key_size, stream); // TODO: non-default stream
+        SCRATCH_ALLOC_TRY(&back_val, back_val_size, stream);
         return GDF_SUCCESS;
     }
 
     gdf_error teardown() {
-        RMM_TRY( RMM_FREE(back_key, stream) );
-        RMM_TRY( RMM_FREE(back_val, stream) );
-        RMM_TRY( RMM_FREE(storage, stream) );
+        SCRATCH_FREE_TRY(back_key, stream);
+        SCRATCH_FREE_TRY(back_val, stream);
+        SCRATCH_FREE_TRY(storage, stream);
         return GDF_SUCCESS;
     }
 };
@@ -50,7 +53,10 @@ struct RadixSort {
     static
     gdf_error sort( RadixSortPlan *plan, Tk *d_key_buf, Tv *d_value_buf) {
 
-        unsigned  num_items = plan->num_items;
+        // cub::DeviceRadixSort takes the number of items as an int
+        GDF_REQUIRE(plan->num_items <= std::numeric_limits<int>::max(),
+                    GDF_COLUMN_SIZE_TOO_BIG);
+        const int num_items = plan->num_items;
         Tk *d_key_alt_buf = (Tk*)plan->back_key;
         Tv *d_value_alt_buf = (Tv*)plan->back_val;
 
@@ -126,7 +132,7 @@ struct RadixSort {
         } else {
             // We have not operated.
             // Just checking for temporary storage requirement
-            RMM_TRY( RMM_ALLOC(&plan->storage, plan->storage_bytes, plan->stream) ); // TODO: non-default stream
+            SCRATCH_ALLOC_TRY(&plan->storage, plan->storage_bytes, plan->stream); // TODO: non-default stream
             CUDA_CHECK_LAST();
             // Now that we have allocated, do real work.
             return sort(plan, d_key_buf, d_value_buf);
@@ -2,134 +2,370 @@
 
 #include "utilities/nvtx/nvtx_utils.h"
 #include "utilities/type_dispatcher.hpp"
+#include "utilities/cudf_utils.h"
 #include "rmm/thrust_rmm_allocator.h"
 #include <cudf.h>
 #include <cub/cub.cuh>
+#include <thrust/transform.h>
 #include <memory>
 #include <stdio.h>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 namespace
 {
 
-constexpr int WARP_SIZE = 32;
+using MaskType = uint32_t;
+
+// A tile is TILE_SIZE x TILE_SIZE values, so the validity bits of a tile are
+// exactly one 32x32 bit matrix
+constexpr int TILE_SIZE = 32;
+constexpr int BLOCK_ROWS = 8;
 constexpr int MAX_GRID_SIZE = (1<<16)-1;
 
+// Rows (and columns) per block of the host transpose, small enough for a
+// block of 8 byte values to stay in the L1 cache
+constexpr gdf_size_type HOST_TILE_SIZE = 64;
+
+/**
+ * @brief Loads the 32 validity bits starting at bit `first_bit`, a multiple of
+ * 32, of a mask of `size` bits. A null mask is all valid. Reads bytewise, as
+ * the mask is only guaranteed to hold whole bytes.
+ */
+CUDA_HOST_DEVICE_CALLABLE
+MaskType load_mask_word(gdf_valid_type const* valid, gdf_size_type first_bit,
+                        gdf_size_type size)
+{
+  if (nullptr == valid)
+    return ~MaskType{0};
+  gdf_size_type const first_byte = first_bit / GDF_VALID_BITSIZE;
+  gdf_size_type const num_bytes = gdf_get_num_chars_bitmask(size);
+  MaskType word{0};
+  for (int b = 0; b < int(sizeof(MaskType)) && first_byte + b < num_bytes; ++b)
+    word |= MaskType{valid[first_byte + b]} << (b * GDF_VALID_BITSIZE);
+  return word;
+}
+
+/**
+ * @brief Stores 32 validity bits starting at bit `first_bit`, a multiple of
+ * 32, of a mask of `size` bits
+ */
+CUDA_HOST_DEVICE_CALLABLE
+void store_mask_word(gdf_valid_type* valid, gdf_size_type first_bit,
+                     gdf_size_type size, MaskType word)
+{
+  gdf_size_type const first_byte = first_bit / GDF_VALID_BITSIZE;
+  gdf_size_type const num_bytes = gdf_get_num_chars_bitmask(size);
+  for (int b = 0; b < int(sizeof(MaskType)) && first_byte + b < num_bytes; ++b)
+    valid[first_byte + b] = static_cast<gdf_valid_type>(word >> (b * GDF_VALID_BITSIZE));
+}
+
 /**
- * @brief Transposes the values from ncols x nrows input columns to
- *  nrows x ncols output columns
- * 
+ * @brief Transposes a 32x32 bit matrix held one row per lane of a warp: on
+ * return, bit i of lane j is bit j of lane i on entry. Every step swaps the
+ * off-diagonal blocks of half the previous size between lanes.
+ */
+__device__ __forceinline__
+MaskType warp_transpose_bits(MaskType x, int lane)
+{
+  MaskType m{0x0000ffff};
+  for (int s = 16; s > 0; s >>= 1, m ^= m << s) {
+    MaskType const other = __shfl_xor_sync(0xffffffff, x, s);
+    x = (lane & s) ? (x & ~m) | ((other >> s) & m)
+                   : (x & m) | ((other << s) & ~m);
+  }
+  return x;
+}
+
+/**
+ * @brief Host counterpart of warp_transpose_bits, in place over 32 words
+ */
+void transpose_bits(MaskType (&a)[TILE_SIZE])
+{
+  MaskType m{0x0000ffff};
+  for (int s = 16; s > 0; s >>= 1, m ^= m << s) {
+    for (int k = 0; k < TILE_SIZE; k = (k + s + 1) & ~s) {
+      MaskType const t = ((a[k] >> s) ^ a[k + s]) & m;
+      a[k + s] ^= t;
+      a[k] ^= t << s;
+    }
+  }
+}
+
+/**
+ * @brief Transposes the values, and if `has_null` the validity masks, from
+ *  ncols x nrows input columns to nrows x ncols output columns
+ *
+ * Each block stages 32x32 tiles in shared memory so that both the reads from
+ * the input columns and the writes to the output columns are coalesced. The
+ * first warp of the block transposes the matching 32x32 block of validity bits
+ * in registers and counts the nulls of each output column.
+ *
  * @tparam ColumnType  Datatype of values pointed to by the pointers
  * @param in_cols[in]  Pointers to input columns' data
  * @param out_cols[out]  Pointers to pre-allocated output columns' data
+ * @param in_cols_valid[in]  Pointers to the validity masks of the input columns
+ * @param out_cols_valid[out]  Pointers to the pre-allocated validity masks of
+ *  the output columns
+ * @param out_cols_null_count[out]  Per output column null counts, zeroed
  * @param ncols[in]  Number of columns in input table
- * @param nrows[in]  Number of rown in input table
+ * @param nrows[in]  Number of rows in input table
+ * @param has_null[in]  Whether to transpose the validity masks
  */
 template <typename ColumnType>
 __global__
-void gpu_transpose(ColumnType **in_cols, ColumnType **out_cols,
-                  gdf_size_type ncols, gdf_size_type nrows)
+void gpu_transpose(ColumnType const* const* in_cols, ColumnType* const* out_cols,
+                   gdf_valid_type const* const* in_cols_valid,
+                   gdf_valid_type* const* out_cols_valid,
+                   gdf_size_type* out_cols_null_count,
+                   gdf_size_type ncols, gdf_size_type nrows, bool has_null)
 {
-  gdf_size_type x = blockIdx.x * blockDim.x + threadIdx.x;
-  gdf_size_type y = blockIdx.y * blockDim.y + threadIdx.y;
-    
-  gdf_size_type stride_x = blockDim.x * gridDim.x;
-  gdf_size_type stride_y = blockDim.y * gridDim.y;
+  // Padded to avoid shared memory bank conflicts on the transposed reads
+  __shared__ ColumnType tile[TILE_SIZE][TILE_SIZE + 1];
+  __shared__ ColumnType const* in_tile_cols[TILE_SIZE];
+  __shared__ ColumnType* out_tile_cols[TILE_SIZE];
 
-  for(gdf_size_type i = x; i < ncols; i += stride_x)
-  {
-    for(gdf_size_type j = y; j < nrows; j += stride_y)
-    {
-      out_cols[j][i] = in_cols[i][j];
+  for (gdf_size_type tile_col = blockIdx.x * TILE_SIZE; tile_col < ncols;
+       tile_col += gridDim.x * TILE_SIZE) {
+    for (gdf_size_type tile_row = blockIdx.y * TILE_SIZE; tile_row < nrows;
+         tile_row += gridDim.y * TILE_SIZE) {
+      gdf_size_type const col = tile_col + threadIdx.x;
+      gdf_size_type const row = tile_row + threadIdx.x;
+
+      // Load the column pointers of the tile once
+      if (0 == threadIdx.y) {
+        in_tile_cols[threadIdx.x] = (col < ncols) ? in_cols[col] : nullptr;
+        out_tile_cols[threadIdx.x] = (row < nrows) ? out_cols[row] : nullptr;
+      }
+      __syncthreads();
+
+      for (int k = threadIdx.y; k < TILE_SIZE; k += BLOCK_ROWS) {
+        if (tile_col + k < ncols && row < nrows)
+          tile[k][threadIdx.x] = in_tile_cols[k][row];
+      }
+      __syncthreads();
+
+      for (int k = threadIdx.y; k < TILE_SIZE; k += BLOCK_ROWS) {
+        if (tile_row + k < nrows && col < ncols)
+          out_tile_cols[k][col] = tile[threadIdx.x][k];
+      }
+
+      if (has_null && 0 == threadIdx.y) {
+        // Lane i holds the bits of input column col for the rows of the tile
+        MaskType word = (col < ncols) ? load_mask_word(in_cols_valid[col], tile_row, nrows) : 0;
+        // Lane i now holds the bits of output column row for the columns of the tile
+        word = warp_transpose_bits(word, threadIdx.x);
+        if (row < nrows) {
+          store_mask_word(out_cols_valid[row], tile_col, ncols, word);
+          gdf_size_type const num_cols = min(gdf_size_type{TILE_SIZE}, ncols - tile_col);
+          atomicAdd(out_cols_null_count + row, num_cols - __popc(word));
+        }
+      }
+      __syncthreads();
     }
   }
 }
 
 /**
- * @brief Transposes the validity mask
- * 
- * @param[in] in_cols_valid  pointers to the validity mask of the input columns
- * @param[out] out_cols_valid  pointers to the pre-allocated validity mask of
- *  the output columns
- * @param[out] out_cols_null_count  array of per output-row null counts
- * @param[in] ncols  number of columns in input table
- * @param[in] nrows  number of rows in input table
+ * @brief Transposes on the host. The rows are split into blocks of
+ * HOST_TILE_SIZE that are handed out to a pool of threads; each block is
+ * transposed HOST_TILE_SIZE columns at a time and its validity bits 32x32 at
+ * a time. Every output column is written by a single thread.
  */
-__global__
-void gpu_transpose_valids(gdf_valid_type **in_cols_valid,
-                          gdf_valid_type **out_cols_valid,
-                          gdf_size_type *out_cols_null_count,
-                          gdf_size_type ncols, gdf_size_type nrows)
+template <typename ColumnType>
+void host_transpose(std::vector<ColumnType const*> const& in_cols,
+                    std::vector<ColumnType*> const& out_cols,
+                    std::vector<gdf_valid_type const*> const& in_cols_valid,
+                    std::vector<gdf_valid_type*> const& out_cols_valid,
+                    std::vector<gdf_size_type>& out_cols_null_count,
+                    gdf_size_type ncols, gdf_size_type nrows, bool has_null)
 {
-  using MaskType = uint32_t;
-  constexpr uint32_t BITS_PER_MASK{sizeof(MaskType) * 8};
+  gdf_size_type const num_row_blocks = (nrows + HOST_TILE_SIZE - 1) / HOST_TILE_SIZE;
+  std::atomic<gdf_size_type> next_block{0};
 
-  gdf_size_type x = blockIdx.x * blockDim.x + threadIdx.x;
-  gdf_size_type y = blockIdx.y * blockDim.y + threadIdx.y;
+  auto worker = [&]() {
+    for (gdf_size_type b = next_block++; b < num_row_blocks; b = next_block++) {
+      gdf_size_type const row_begin = b * HOST_TILE_SIZE;
+      gdf_size_type const row_end = std::min(row_begin + HOST_TILE_SIZE, nrows);
 
-  gdf_size_type stride_x = blockDim.x * gridDim.x;
-  gdf_size_type stride_y = blockDim.y * gridDim.y;
+      for (gdf_size_type col_begin = 0; col_begin < ncols; col_begin += HOST_TILE_SIZE) {
+        gdf_size_type const col_end = std::min(col_begin + HOST_TILE_SIZE, ncols);
+        for (gdf_size_type j = row_begin; j < row_end; ++j) {
+          ColumnType* out = out_cols[j];
+          for (gdf_size_type i = col_begin; i < col_end; ++i)
+            out[i] = in_cols[i][j];
+        }
+      }
 
-  gdf_size_type i = x;
-  gdf_size_type j = y;
-  auto active_threads = __ballot_sync(0xffffffff, i < ncols);
-  while(i < ncols)
-  {
-    j = y;
-    while(j < nrows)
-    {
-      bool const input_is_valid{gdf_is_valid(in_cols_valid[i], j)};
-      MaskType const result_mask{__ballot_sync(active_threads, input_is_valid)};
-
-      MaskType* const __restrict__ out_mask32 =
-        reinterpret_cast<MaskType*>(out_cols_valid[j]);
-
-      gdf_index_type const out_location = i / BITS_PER_MASK;
-
-      // Only one thread writes output
-      if (0 == threadIdx.x % warpSize) {
-        out_mask32[out_location] = result_mask;
-        int num_nulls = __popc(active_threads) - __popc(result_mask);
-        atomicAdd(out_cols_null_count + j, num_nulls);
+      if (!has_null)
+        continue;
+
+      for (gdf_size_type row = row_begin; row < row_end; row += TILE_SIZE) {
+        for (gdf_size_type col = 0; col < ncols; col += TILE_SIZE) {
+          gdf_size_type const num_cols = std::min(gdf_size_type{TILE_SIZE}, ncols - col);
+          MaskType words[TILE_SIZE];
+          for (gdf_size_type i = 0; i < TILE_SIZE; ++i)
+            words[i] = (i < num_cols) ? load_mask_word(in_cols_valid[col + i], row, nrows) : 0;
+          transpose_bits(words);
+          for (gdf_size_type j = 0; j < TILE_SIZE && row + j < row_end; ++j) {
+            store_mask_word(out_cols_valid[row + j], col, ncols, words[j]);
+            out_cols_null_count[row + j] += num_cols - __builtin_popcount(words[j]);
+          }
+        }
       }
-      
-      j += stride_y;
     }
-    i += stride_x;
-    active_threads = __ballot_sync(active_threads, i < ncols);
-  }
+  };
+
+  gdf_size_type const num_threads =
+    std::max(gdf_size_type{1},
+             std::min(static_cast<gdf_size_type>(std::thread::hardware_concurrency()), num_row_blocks));
+  std::vector<std::thread> threads;
+  for (gdf_size_type t = 1; t < num_threads; ++t)
+    threads.emplace_back(worker);
+  worker();
+  for (auto& thread : threads)
+    thread.join();
+}
+
+/**
+ * @brief Whether every value of type From is exactly representable as To
+ */
+template <typename From, typename To>
+constexpr bool is_widening()
+{
+  return std::is_arithmetic<From>::value && std::is_arithmetic<To>::value &&
+         ((std::is_integral<From>::value == std::is_integral<To>::value && sizeof(From) <= sizeof(To)) ||
+          (std::is_integral<From>::value && std::is_floating_point<To>::value && sizeof(From) < sizeof(To)));
 }
 
-// TODO: refactor and separate `valids` kernel launch into another function.
-// Should not need to pass `has_null`
-struct launch_kernel{
+template <typename From, typename To>
+struct widen
+{
+  CUDA_HOST_DEVICE_CALLABLE To operator()(From value) const
+  {
+    return static_cast<To>(value);
+  }
+};
+
+/**
+ * @brief Converts a column to the output type To, so that tables mixing
+ * narrower types can be transposed into a wider one
+ */
+template <typename To>
+struct widen_column
+{
+  template <typename From,
+            typename std::enable_if_t<is_widening<From, To>()>* = nullptr>
+  gdf_error operator()(gdf_column const* col, To* out, bool on_host, cudaStream_t stream)
+  {
+    From const* data = static_cast<From const*>(col->data);
+    if (on_host) {
+      std::transform(data, data + col->size, out, widen<From, To>{});
+    }
+    else {
+      thrust::transform(rmm::exec_policy(stream)->on(stream),
+                        data, data + col->size, out, widen<From, To>{});
+      CUDA_CHECK_LAST();
+    }
+    return GDF_SUCCESS;
+  }
+
+  template <typename From,
+            typename std::enable_if_t<!is_widening<From, To>()>* = nullptr>
+  gdf_error operator()(gdf_column const* col, To* out, bool on_host, cudaStream_t stream)
+  {
+    return GDF_DTYPE_MISMATCH;
+  }
+};
+
+struct launch_transpose{
   template <typename ColumnType>
-  gdf_error operator()(
-    void **in_cols_data_ptr, void **out_cols_data_ptr,
-    gdf_valid_type **in_cols_valid_ptr, gdf_valid_type **out_cols_valid_ptr,
-    gdf_size_type *out_cols_nullct_ptr,
-    gdf_size_type ncols, gdf_size_type nrows, bool has_null)
+  gdf_error operator()(gdf_size_type ncols, gdf_column** in_cols,
+                       gdf_column** out_cols, bool has_null, bool on_host)
   {
-    dim3 dimBlock(WARP_SIZE, WARP_SIZE, 1);
-    dim3 dimGrid(std::min((ncols + WARP_SIZE - 1) / WARP_SIZE, MAX_GRID_SIZE),
-                 std::min((nrows + WARP_SIZE - 1) / WARP_SIZE, MAX_GRID_SIZE),
-                 1);
-
-    gpu_transpose<ColumnType><<<dimGrid,dimBlock>>>(
-      reinterpret_cast<ColumnType**>(in_cols_data_ptr),
-      reinterpret_cast<ColumnType**>(out_cols_data_ptr),
-      ncols, nrows
-    );
-    if (has_null){
-      gpu_transpose_valids<<<dimGrid,dimBlock>>>(
-        in_cols_valid_ptr,
-        out_cols_valid_ptr,
-        out_cols_nullct_ptr,
-        ncols, nrows
+    cudaStream_t stream = 0;
+    gdf_size_type const nrows = in_cols[0]->size;
+    gdf_size_type const out_ncols = nrows;
+    gdf_dtype const dtype = out_cols[0]->dtype;
+
+    // Columns of narrower types are widened to the output type first
+    std::vector<std::vector<ColumnType>> host_widened;
+    std::vector<rmm::device_vector<ColumnType>> device_widened;
+    // No reallocation, which would invalidate the widened columns' pointers
+    host_widened.reserve(ncols);
+    device_widened.reserve(ncols);
+
+    std::vector<ColumnType const*> in_columns_data(ncols);
+    std::vector<gdf_valid_type const*> in_columns_valid(ncols);
+    for (gdf_size_type i = 0; i < ncols; ++i) {
+      in_columns_data[i] = static_cast<ColumnType const*>(in_cols[i]->data);
+      in_columns_valid[i] = in_cols[i]->valid;
+      if (in_cols[i]->dtype != dtype) {
+        ColumnType* widened{nullptr};
+        if (on_host) {
+          host_widened.emplace_back(nrows);
+          widened = host_widened.back().data();
+        }
+        else {
+          device_widened.emplace_back(nrows);
+          widened = device_widened.back().data().get();
+        }
+        gdf_error status = cudf::type_dispatcher(in_cols[i]->dtype, widen_column<ColumnType>{},
+                                                 in_cols[i], widened, on_host, stream);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+        in_columns_data[i] = widened;
+      }
+    }
+
+    std::vector<ColumnType*> out_columns_data(out_ncols);
+    std::vector<gdf_valid_type*> out_columns_valid(out_ncols);
+    for (gdf_size_type i = 0; i < out_ncols; ++i) {
+      out_columns_data[i] = static_cast<ColumnType*>(out_cols[i]->data);
+      out_columns_valid[i] = out_cols[i]->valid;
+    }
+
+    std::vector<gdf_size_type> out_columns_nullct(out_ncols, 0);
+
+    if (on_host) {
+      host_transpose(in_columns_data, out_columns_data,
+                     in_columns_valid, out_columns_valid,
+                     out_columns_nullct, ncols, nrows, has_null);
+    }
+    else {
+      // Copy the column pointers to device
+      rmm::device_vector<ColumnType const*> d_in_columns_data(in_columns_data);
+      rmm::device_vector<gdf_valid_type const*> d_in_columns_valid(in_columns_valid);
+      rmm::device_vector<ColumnType*> d_out_columns_data(out_columns_data);
+      rmm::device_vector<gdf_valid_type*> d_out_columns_valid(out_columns_valid);
+      rmm::device_vector<gdf_size_type> d_out_columns_nullct(out_ncols);
+
+      dim3 dimBlock(TILE_SIZE, BLOCK_ROWS, 1);
+      dim3 dimGrid(std::min((ncols + TILE_SIZE - 1) / TILE_SIZE, MAX_GRID_SIZE),
+                   std::min((nrows + TILE_SIZE - 1) / TILE_SIZE, MAX_GRID_SIZE),
+                   1);
+
+      gpu_transpose<ColumnType><<<dimGrid, dimBlock, 0, stream>>>(
+        d_in_columns_data.data().get(),
+        d_out_columns_data.data().get(),
+        d_in_columns_valid.data().get(),
+        d_out_columns_valid.data().get(),
+        d_out_columns_nullct.data().get(),
+        ncols, nrows, has_null
       );
+      CUDA_CHECK_LAST();
+
+      CUDA_TRY(cudaMemcpyAsync(out_columns_nullct.data(), d_out_columns_nullct.data().get(),
+                               out_ncols * sizeof(gdf_size_type), cudaMemcpyDeviceToHost, stream));
+      CUDA_TRY(cudaStreamSynchronize(stream));
+    }
+
+    // Transfer null counts to gdf structs
+    for (gdf_size_type i = 0; i < out_ncols; i++) {
+      out_cols[i]->null_count = out_columns_nullct[i];
     }
-    cudaDeviceSynchronize();
-    CUDA_CHECK_LAST();
     return GDF_SUCCESS;
   }
 };
@@ -145,19 +381,21 @@ gdf_error gdf_transpose(gdf_size_type ncols, gdf_column** in_cols,
   // If there are no rows in the input, return successfully
   GDF_REQUIRE(in_cols[0]->size > 0, GDF_SUCCESS)
 
-  // Check datatype homogeneity
-  gdf_dtype dtype = in_cols[0]->dtype;
-  for (gdf_size_type i = 1; i < ncols; i++) {
-    GDF_REQUIRE(in_cols[i]->dtype == dtype, GDF_DTYPE_MISMATCH)
-  }
+  // Check sizes and output datatype homogeneity. Input columns either have
+  // the output datatype or one that widens to it.
   gdf_size_type nrows = in_cols[0]->size;
   gdf_size_type out_ncols = nrows;
+  gdf_dtype dtype = out_cols[0]->dtype;
+  for (gdf_size_type i = 0; i < ncols; i++) {
+    GDF_REQUIRE(in_cols[i]->size == nrows, GDF_COLUMN_SIZE_MISMATCH)
+  }
   for (gdf_size_type i = 0; i < out_ncols; i++) {
     GDF_REQUIRE(out_cols[i]->dtype == dtype, GDF_DTYPE_MISMATCH)
+    GDF_REQUIRE(out_cols[i]->size == ncols, GDF_COLUMN_SIZE_MISMATCH)
   }
 
   // Check if there are nulls to be processed
-  bool const has_null{ std::any_of(in_cols, in_cols + ncols, 
+  bool const has_null{ std::any_of(in_cols, in_cols + ncols,
     [](gdf_column * col){ return col->null_count > 0; }) };
 
   if (has_null) {
@@ -166,52 +404,18 @@ gdf_error gdf_transpose(gdf_size_type ncols, gdf_column** in_cols,
     }
   }
 
+  // Tables in plain host memory are transposed on the host. All the columns
+  // must live in the same memory space.
+  bool const on_host{ is_host_memory(in_cols[0]->data) };
+  GDF_REQUIRE(is_host_memory(out_cols[0]->data) == on_host, GDF_INVALID_API_CALL)
+
   PUSH_RANGE("CUDF_TRANSPOSE", GDF_GREEN);
 
-  // Copy input columns `data` and `valid` pointers to device
-  std::vector<void*> in_columns_data(ncols);
-  std::vector<gdf_valid_type*> in_columns_valid(ncols);
-  for (gdf_size_type i = 0; i < ncols; ++i) {
-    in_columns_data[i] = in_cols[i]->data;
-    in_columns_valid[i] = in_cols[i]->valid;
-  }
-  rmm::device_vector<void*> d_in_columns_data(in_columns_data);
-  rmm::device_vector<gdf_valid_type*> d_in_columns_valid(in_columns_valid);
-
-  void** in_cols_data_ptr = d_in_columns_data.data().get();
-  gdf_valid_type** in_cols_valid_ptr = d_in_columns_valid.data().get();
-
-  // Copy output columns `data` and `valid` pointers to device
-  std::vector<void*> out_columns_data(out_ncols);
-  std::vector<gdf_valid_type*> out_columns_valid(out_ncols);
-  for (gdf_size_type i = 0; i < out_ncols; ++i) {
-    out_columns_data[i] = out_cols[i]->data;
-    out_columns_valid[i] = out_cols[i]->valid;
-  }
-  rmm::device_vector<void*> d_out_columns_data(out_columns_data);
-  rmm::device_vector<gdf_valid_type*> d_out_columns_valid(out_columns_valid);
-  rmm::device_vector<gdf_size_type> d_out_columns_nullct(out_ncols);
-
-  void** out_cols_data_ptr = d_out_columns_data.data().get();
-  gdf_valid_type** out_cols_valid_ptr = d_out_columns_valid.data().get();
-  gdf_size_type* out_cols_nullct_ptr = d_out_columns_nullct.data().get();
-
-  cudf::type_dispatcher(dtype,
-                        launch_kernel{},
-                        in_cols_data_ptr,
-                        out_cols_data_ptr,
-                        in_cols_valid_ptr,
-                        out_cols_valid_ptr,
-                        out_cols_nullct_ptr,
-                        ncols, nrows, has_null);
-
-  // Transfer null counts to gdf structs
-  thrust::host_vector<gdf_size_type> out_columns_nullct(d_out_columns_nullct);
-  for(gdf_size_type i = 0; i < out_ncols; i++)
-  {
-    out_cols[i]->null_count = out_columns_nullct[i];
-  }
-  
+  gdf_error status = cudf::type_dispatcher(dtype,
+                                           launch_transpose{},
+                                           ncols, in_cols, out_cols,
+                                           has_null, on_host);
+
   POP_RANGE();
-  return GDF_SUCCESS;
-}
\ No newline at end of file
+  return status;
+}
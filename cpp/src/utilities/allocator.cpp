@@ -0,0 +1,598 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "allocator.hpp"
+#include "error_utils.h"
+#include "rmm/rmm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace cudf {
+namespace memory {
+
+namespace {
+
+/** ---------------------------------------------------------------------------*
+ * @brief Lock-free usage counters shared by all allocator implementations
+ * ---------------------------------------------------------------------------**/
+struct stats_counters {
+  std::atomic<size_t> num_allocations{0};
+  std::atomic<size_t> num_deallocations{0};
+  std::atomic<size_t> num_cache_hits{0};
+  std::atomic<size_t> num_upstream_allocations{0};
+  std::atomic<size_t> bytes_in_use{0};
+  std::atomic<size_t> peak_bytes_in_use{0};
+  std::atomic<size_t> bytes_cached{0};
+
+  void on_allocate(size_t bytes, bool cache_hit) {
+    ++num_allocations;
+    if (cache_hit) ++num_cache_hits;
+    else ++num_upstream_allocations;
+    size_t in_use = (bytes_in_use += bytes);
+    size_t peak = peak_bytes_in_use.load();
+    while (in_use > peak && !peak_bytes_in_use.compare_exchange_weak(peak, in_use)) {}
+  }
+
+  void on_deallocate(size_t bytes) {
+    ++num_deallocations;
+    bytes_in_use -= bytes;
+  }
+
+  gdf_allocator_stats snapshot() const {
+    gdf_allocator_stats stats;
+    stats.num_allocations = num_allocations.load();
+    stats.num_deallocations = num_deallocations.load();
+    stats.num_cache_hits = num_cache_hits.load();
+    stats.num_upstream_allocations = num_upstream_allocations.load();
+    stats.bytes_in_use = bytes_in_use.load();
+    stats.peak_bytes_in_use = peak_bytes_in_use.load();
+    stats.bytes_cached = bytes_cached.load();
+    return stats;
+  }
+};
+
+/** ---------------------------------------------------------------------------*
+ * @brief Map from live pointers to their size, sharded by address so that
+ * concurrent lookups from different threads rarely contend on a lock
+ * ---------------------------------------------------------------------------**/
+class size_registry {
+ public:
+  void insert(void* ptr, size_t bytes) {
+    shard& s = shard_for(ptr);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.sizes[ptr] = bytes;
+  }
+
+  bool erase(void* ptr, size_t& bytes) {
+    shard& s = shard_for(ptr);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.sizes.find(ptr);
+    if (it == s.sizes.end()) return false;
+    bytes = it->second;
+    s.sizes.erase(it);
+    return true;
+  }
+
+  bool find(void* ptr, size_t& bytes) {
+    shard& s = shard_for(ptr);
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto it = s.sizes.find(ptr);
+    if (it == s.sizes.end()) return false;
+    bytes = it->second;
+    return true;
+  }
+
+  template <typename F>
+  void for_each(F f) {
+    for (auto& s : shards) {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      for (auto const& entry : s.sizes) f(entry.first, entry.second);
+    }
+  }
+
+  void clear() {
+    for (auto& s : shards) {
+      std::lock_guard<std::mutex> lock(s.mutex);
+      s.sizes.clear();
+    }
+  }
+
+ private:
+  static constexpr size_t num_shards = 16;
+
+  struct shard {
+    std::mutex mutex;
+    std::unordered_map<void*, size_t> sizes;
+  };
+
+  shard& shard_for(void* ptr) {
+    // allocations are at least 256 byte aligned, drop the low bits
+    return shards[(reinterpret_cast<uintptr_t>(ptr) >> 8) % num_shards];
+  }
+
+  shard shards[num_shards];
+};
+
+} // namespace anonymous
+
+/* ---------------------------------------------------------------------------*
+ * rmm_allocator
+ * ---------------------------------------------------------------------------*/
+
+struct rmm_allocator::impl {
+  stats_counters stats;
+  size_registry sizes;
+  allocation_hook hook;
+};
+
+rmm_allocator::rmm_allocator() : impl_{new impl} {}
+rmm_allocator::~rmm_allocator() = default;
+
+gdf_error rmm_allocator::allocate(void** ptr, size_t bytes, cudaStream_t stream)
+{
+  GDF_REQUIRE(nullptr != ptr, GDF_INVALID_API_CALL);
+  RMM_TRY( RMM_ALLOC(ptr, bytes, stream) );
+  impl_->sizes.insert(*ptr, bytes);
+  impl_->stats.on_allocate(bytes, false);
+  if (impl_->hook)
+    impl_->hook({allocation_event::ALLOCATE, *ptr, bytes, stream, false});
+  return GDF_SUCCESS;
+}
+
+gdf_error rmm_allocator::deallocate(void* ptr, cudaStream_t stream)
+{
+  if (nullptr == ptr) return GDF_SUCCESS;
+  size_t bytes{0};
+  GDF_REQUIRE(impl_->sizes.erase(ptr, bytes), GDF_INVALID_API_CALL);
+  RMM_TRY( RMM_FREE(ptr, stream) );
+  impl_->stats.on_deallocate(bytes);
+  if (impl_->hook)
+    impl_->hook({allocation_event::DEALLOCATE, ptr, bytes, stream, false});
+  return GDF_SUCCESS;
+}
+
+gdf_allocator_stats rmm_allocator::get_stats() const { return impl_->stats.snapshot(); }
+
+void rmm_allocator::set_hook(allocation_hook hook) { impl_->hook = std::move(hook); }
+
+/* ---------------------------------------------------------------------------*
+ * host_allocator
+ * ---------------------------------------------------------------------------*/
+
+struct host_allocator::impl {
+  static constexpr size_t alignment = 256;
+  stats_counters stats;
+  size_registry sizes;
+  allocation_hook hook;
+};
+
+host_allocator::host_allocator() : impl_{new impl} {}
+host_allocator::~host_allocator() = default;
+
+gdf_error host_allocator::allocate(void** ptr, size_t bytes, cudaStream_t stream)
+{
+  GDF_REQUIRE(nullptr != ptr, GDF_INVALID_API_CALL);
+  *ptr = nullptr;
+  GDF_REQUIRE(0 == posix_memalign(ptr, impl::alignment, std::max(bytes, size_t{1})),
+              GDF_MEMORYMANAGER_ERROR);
+  impl_->sizes.insert(*ptr, bytes);
+  impl_->stats.on_allocate(bytes, false);
+  if (impl_->hook)
+    impl_->hook({allocation_event::ALLOCATE, *ptr, bytes, stream, false});
+  return GDF_SUCCESS;
+}
+
+gdf_error host_allocator::deallocate(void* ptr, cudaStream_t stream)
+{
+  if (nullptr == ptr) return GDF_SUCCESS;
+  size_t bytes{0};
+  GDF_REQUIRE(impl_->sizes.erase(ptr, bytes), GDF_INVALID_API_CALL);
+  std::free(ptr);
+  impl_->stats.on_deallocate(bytes);
+  if (impl_->hook)
+    impl_->hook({allocation_event::DEALLOCATE, ptr, bytes, stream, false});
+  return GDF_SUCCESS;
+}
+
+gdf_allocator_stats host_allocator::get_stats() const { return impl_->stats.snapshot(); }
+
+void host_allocator::set_hook(allocation_hook hook) { impl_->hook = std::move(hook); }
+
+/* ---------------------------------------------------------------------------*
+ * pool_allocator
+ * ---------------------------------------------------------------------------*/
+
+namespace {
+
+struct cached_block {
+  void*        ptr;
+  cudaStream_t stream;
+};
+
+// Free lists indexed by size class
+using free_lists = std::vector<std::vector<cached_block>>;
+
+bool pop_block(std::vector<cached_block>& list, cudaStream_t stream, void** ptr)
+{
+  // Most recently released blocks are at the back and most likely to be hot
+  for (auto it = list.rbegin(); it != list.rend(); ++it) {
+    if (it->stream == stream) {
+      *ptr = it->ptr;
+      list.erase(std::next(it).base());
+      return true;
+    }
+  }
+  return false;
+}
+
+std::atomic<uint64_t> next_arena_id{0};
+
+struct thread_cache;
+
+} // namespace anonymous
+
+/** ---------------------------------------------------------------------------*
+ * @brief State of a pool_allocator shared with the thread caches
+ *
+ * Thread caches hold a weak reference to the arena, so a thread that exits
+ * after the pool was destroyed simply drops its cache. The arena keeps a list
+ * of the live thread caches so that release() can drain all of them.
+ * ---------------------------------------------------------------------------**/
+struct pool_allocator::arena {
+  arena(std::shared_ptr<allocator> upstream_, options const& opts_)
+    : upstream{std::move(upstream_)}, opts(opts_), id{next_arena_id++}
+  {
+    size_t size = opts.min_block_size;
+    while (size <= opts.max_cached_block_size) {
+      class_sizes.push_back(size);
+      size *= 2;
+    }
+    shared.resize(class_sizes.size());
+  }
+
+  ~arena() { release_all(); }
+
+  gdf_error drain_thread_caches();
+
+  /// Returns the size class of a request or -1 if it should not be cached
+  int size_class(size_t bytes) const {
+    auto it = std::lower_bound(class_sizes.begin(), class_sizes.end(), bytes);
+    return (it == class_sizes.end()) ? -1 : static_cast<int>(it - class_sizes.begin());
+  }
+
+  size_t block_size(size_t bytes) const {
+    int c = size_class(bytes);
+    return (c < 0) ? bytes : class_sizes[c];
+  }
+
+  gdf_error upstream_allocate(void** ptr, size_t bytes, cudaStream_t stream) {
+    gdf_error status = upstream->allocate(ptr, bytes, stream);
+    if (GDF_SUCCESS != status) {
+      // Give cached memory back and retry once
+      status = release_shared();
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+      status = upstream->allocate(ptr, bytes, stream);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+    }
+    return GDF_SUCCESS;
+  }
+
+  /// Moves blocks from a thread cache into the shared arena, trimming the
+  /// arena if it exceeds its limit
+  gdf_error absorb(free_lists& blocks, size_t bytes) {
+    std::vector<cached_block> evicted;
+    std::vector<size_t> evicted_sizes;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      for (size_t c = 0; c < blocks.size(); ++c) {
+        shared[c].insert(shared[c].end(), blocks[c].begin(), blocks[c].end());
+        blocks[c].clear();
+      }
+      shared_bytes += bytes;
+      // Evict the oldest blocks of the largest classes first
+      for (size_t c = shared.size(); c-- > 0 && shared_bytes > opts.max_cached_bytes; ) {
+        while (!shared[c].empty() && shared_bytes > opts.max_cached_bytes) {
+          evicted.push_back(shared[c].front());
+          evicted_sizes.push_back(class_sizes[c]);
+          shared[c].erase(shared[c].begin());
+          shared_bytes -= class_sizes[c];
+        }
+      }
+    }
+    for (size_t i = 0; i < evicted.size(); ++i) {
+      owned.erase(evicted[i].ptr, evicted_sizes[i]);
+      stats.bytes_cached -= evicted_sizes[i];
+      gdf_error status = upstream->deallocate(evicted[i].ptr, evicted[i].stream);
+      GDF_REQUIRE(GDF_SUCCESS == status, status);
+    }
+    return GDF_SUCCESS;
+  }
+
+  /// Returns every block in the shared arena to the upstream allocator
+  gdf_error release_shared() {
+    free_lists blocks;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      blocks.swap(shared);
+      shared.resize(class_sizes.size());
+      shared_bytes = 0;
+    }
+    if (upstream->is_device_memory())
+      CUDA_TRY( cudaDeviceSynchronize() );
+    for (size_t c = 0; c < blocks.size(); ++c) {
+      for (auto const& block : blocks[c]) {
+        size_t bytes{0};
+        owned.erase(block.ptr, bytes);
+        stats.bytes_cached -= bytes;
+        gdf_error status = upstream->deallocate(block.ptr, block.stream);
+        GDF_REQUIRE(GDF_SUCCESS == status, status);
+      }
+    }
+    return GDF_SUCCESS;
+  }
+
+  /// Frees everything obtained from upstream, including blocks still cached
+  /// by other threads or not yet released by the caller
+  void release_all() {
+    if (upstream->is_device_memory())
+      cudaDeviceSynchronize();
+    owned.for_each([this](void* ptr, size_t) { upstream->deallocate(ptr, 0); });
+    owned.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    shared.clear();
+    shared_bytes = 0;
+  }
+
+  std::shared_ptr<allocator> upstream;
+  options opts;
+  const uint64_t id;
+  std::vector<size_t> class_sizes;
+
+  size_registry owned;     // every block obtained from upstream, by block size
+  stats_counters stats;
+  allocation_hook hook;
+
+  std::mutex mutex;        // protects shared and shared_bytes
+  free_lists shared;
+  size_t shared_bytes{0};
+
+  std::mutex caches_mutex; // protects caches, taken before the mutex of a cache
+  std::vector<thread_cache*> caches;
+};
+
+namespace {
+
+/** ---------------------------------------------------------------------------*
+ * @brief Blocks released by the current thread that have not been moved to
+ * the shared arena yet
+ *
+ * Only the owning thread and pool_allocator::release touch a cache, so its
+ * mutex is uncontended outside of release.
+ * ---------------------------------------------------------------------------**/
+struct thread_cache {
+  std::weak_ptr<pool_allocator::arena> owner;
+  std::mutex mutex;        // protects blocks and bytes
+  free_lists blocks;
+  size_t bytes{0};
+
+  ~thread_cache() {
+    auto pool = owner.lock();
+    if (!pool) return;
+    {
+      std::lock_guard<std::mutex> lock(pool->caches_mutex);
+      pool->caches.erase(std::find(pool->caches.begin(), pool->caches.end(), this));
+    }
+    if (bytes > 0) pool->absorb(blocks, bytes);
+  }
+};
+
+thread_cache& get_thread_cache(std::shared_ptr<pool_allocator::arena> const& pool)
+{
+  // The caches are registered with their arena by address, so they must not move
+  static thread_local std::unordered_map<uint64_t, std::unique_ptr<thread_cache>> caches;
+  std::unique_ptr<thread_cache>& cache = caches[pool->id];
+  if (!cache) {
+    cache.reset(new thread_cache);
+    cache->owner = pool;
+    cache->blocks.resize(pool->class_sizes.size());
+    std::lock_guard<std::mutex> lock(pool->caches_mutex);
+    pool->caches.push_back(cache.get());
+  }
+  return *cache;
+}
+
+} // namespace anonymous
+
+/// Moves the blocks of every thread cache into the shared arena
+gdf_error pool_allocator::arena::drain_thread_caches()
+{
+  free_lists blocks(class_sizes.size());
+  size_t bytes{0};
+  {
+    std::lock_guard<std::mutex> lock(caches_mutex);
+    for (thread_cache* cache : caches) {
+      std::lock_guard<std::mutex> cache_lock(cache->mutex);
+      for (size_t c = 0; c < blocks.size(); ++c) {
+        blocks[c].insert(blocks[c].end(), cache->blocks[c].begin(), cache->blocks[c].end());
+        cache->blocks[c].clear();
+      }
+      bytes += cache->bytes;
+      cache->bytes = 0;
+    }
+  }
+  return absorb(blocks, bytes);
+}
+
+pool_allocator::pool_allocator(std::shared_ptr<allocator> upstream)
+  : pool_allocator(std::move(upstream), options{}) {}
+
+pool_allocator::pool_allocator(std::shared_ptr<allocator> upstream, options const& opts)
+  : arena_{std::make_shared<arena>(std::move(upstream), opts)} {}
+
+pool_allocator::~pool_allocator() = default;
+
+gdf_error pool_allocator::allocate(void** ptr, size_t bytes, cudaStream_t stream)
+{
+  GDF_REQUIRE(nullptr != ptr, GDF_INVALID_API_CALL);
+  const int c = arena_->size_class(bytes);
+  bool cache_hit = false;
+
+  if (c >= 0) {
+    thread_cache& cache = get_thread_cache(arena_);
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      if (pop_block(cache.blocks[c], stream, ptr)) {
+        cache.bytes -= arena_->class_sizes[c];
+        cache_hit = true;
+      }
+    }
+    if (!cache_hit) {
+      std::lock_guard<std::mutex> lock(arena_->mutex);
+      if (pop_block(arena_->shared[c], stream, ptr)) {
+        arena_->shared_bytes -= arena_->class_sizes[c];
+        cache_hit = true;
+      }
+    }
+  }
+
+  const size_t block_bytes = arena_->block_size(bytes);
+  if (cache_hit) {
+    arena_->stats.bytes_cached -= block_bytes;
+  }
+  else {
+    gdf_error status = arena_->upstream_allocate(ptr, block_bytes, stream);
+    GDF_REQUIRE(GDF_SUCCESS == status, status);
+    arena_->owned.insert(*ptr, block_bytes);
+  }
+
+  arena_->stats.on_allocate(block_bytes, cache_hit);
+  if (arena_->hook)
+    arena_->hook({allocation_event::ALLOCATE, *ptr, block_bytes, stream, cache_hit});
+  return GDF_SUCCESS;
+}
+
+gdf_error pool_allocator::deallocate(void* ptr, cudaStream_t stream)
+{
+  if (nullptr == ptr) return GDF_SUCCESS;
+  size_t block_bytes{0};
+  GDF_REQUIRE(arena_->owned.find(ptr, block_bytes), GDF_INVALID_API_CALL);
+  arena_->stats.on_deallocate(block_bytes);
+
+  const int c = arena_->size_class(block_bytes);
+  if (c < 0) {
+    arena_->owned.erase(ptr, block_bytes);
+    if (arena_->hook)
+      arena_->hook({allocation_event::DEALLOCATE, ptr, block_bytes, stream, false});
+    return arena_->upstream->deallocate(ptr, stream);
+  }
+
+  arena_->stats.bytes_cached += block_bytes;
+  if (arena_->hook)
+    arena_->hook({allocation_event::DEALLOCATE, ptr, block_bytes, stream, true});
+
+  thread_cache& cache = get_thread_cache(arena_);
+  free_lists spill;
+  size_t spill_bytes{0};
+  {
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.blocks[c].push_back({ptr, stream});
+    cache.bytes += block_bytes;
+    if (cache.bytes > arena_->opts.max_thread_cache_bytes) {
+      // Hand the older half of every list over to the other threads
+      spill.resize(cache.blocks.size());
+      for (size_t i = 0; i < cache.blocks.size(); ++i) {
+        auto& list = cache.blocks[i];
+        auto middle = list.begin() + list.size() / 2;
+        spill[i].assign(list.begin(), middle);
+        list.erase(list.begin(), middle);
+        spill_bytes += spill[i].size() * arena_->class_sizes[i];
+      }
+      cache.bytes -= spill_bytes;
+    }
+  }
+  return (spill_bytes > 0) ? arena_->absorb(spill, spill_bytes) : GDF_SUCCESS;
+}
+
+gdf_error pool_allocator::release()
+{
+  // Flush the caches of all threads so their blocks are released too
+  gdf_error status = arena_->drain_thread_caches();
+  GDF_REQUIRE(GDF_SUCCESS == status, status);
+  return arena_->release_shared();
+}
+
+gdf_allocator_stats pool_allocator::get_stats() const { return arena_->stats.snapshot(); }
+
+void pool_allocator::set_hook(allocation_hook hook) { arena_->hook = std::move(hook); }
+
+bool pool_allocator::is_device_memory() const { return arena_->upstream->is_device_memory(); }
+
+/* ---------------------------------------------------------------------------*
+ * Process-wide allocators
+ * ---------------------------------------------------------------------------*/
+
+namespace {
+
+// The default pool holds RMM memory, which must not be freed during static
+// destruction when RMM and the CUDA context may already be gone. The instance
+// is never destroyed, gdf_scratch_memory_release returns its blocks to RMM.
+std::shared_ptr<allocator>& device_allocator_instance()
+{
+  static auto instance = new std::shared_ptr<allocator>(
+    std::make_shared<pool_allocator>(std::make_shared<rmm_allocator>()));
+  return *instance;
+}
+
+} // namespace anonymous
+
+allocator& device_allocator()
+{
+  return *device_allocator_instance();
+}
+
+allocator& host_scratch_allocator()
+{
+  static pool_allocator instance{std::make_shared<host_allocator>()};
+  return instance;
+}
+
+void set_device_allocator(std::shared_ptr<allocator> new_allocator)
+{
+  if (nullptr == new_allocator)
+    new_allocator = std::make_shared<pool_allocator>(std::make_shared<rmm_allocator>());
+  device_allocator_instance() = std::move(new_allocator);
+}
+
+} // namespace memory
+} // namespace cudf
+
+gdf_error gdf_scratch_memory_stats(gdf_allocator_stats *stats)
+{
+  GDF_REQUIRE(nullptr != stats, GDF_INVALID_API_CALL);
+  *stats = cudf::memory::device_allocator().get_stats();
+  return GDF_SUCCESS;
+}
+
+gdf_error gdf_scratch_memory_release()
+{
+  return cudf::memory::device_allocator().release();
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** ---------------------------------------------------------------------------*
+ * @brief Allocator interface for libcudf scratch memory
+ *
+ * Buffers that are allocated and released within a single libcudf call
+ * (temporary storage, device-side copies of host metadata, hash tables, ...)
+ * are requested from a cudf::memory::allocator instead of calling RMM_ALLOC
+ * or cudaMalloc directly. The default device allocator is a size-class pool
+ * with per-thread caches on top of RMM, so short-lived buffers are recycled
+ * instead of being allocated and freed on every call.
+ *
+ * Buffers that are returned to the caller (e.g., gdf_column::data) must still
+ * be allocated with RMM_ALLOC, since callers release them with RMM_FREE.
+ *
+ * @file allocator.hpp
+ * ---------------------------------------------------------------------------**/
+
+#ifndef GDF_ALLOCATOR_HPP
+#define GDF_ALLOCATOR_HPP
+
+#include <cuda_runtime_api.h>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+#include "cudf.h"
+
+namespace cudf {
+namespace memory {
+
+/** ---------------------------------------------------------------------------*
+ * @brief Describes a single allocation or deallocation, passed to the
+ * allocation hook of an allocator
+ * ---------------------------------------------------------------------------**/
+struct allocation_event {
+  enum event_kind { ALLOCATE, DEALLOCATE };
+  event_kind    kind;
+  void*         ptr;
+  size_t        bytes;     ///< Size of the block backing the request
+  cudaStream_t  stream;
+  bool          cache_hit; ///< Served from (or returned to) a cache
+};
+
+using allocation_hook = std::function<void(allocation_event const&)>;
+
+/** ---------------------------------------------------------------------------*
+ * @brief Abstract base class of all scratch memory allocators
+ *
+ * Allocations are stream ordered: memory released on `stream` may be handed
+ * out again to later work on the same stream without synchronization.
+ * ---------------------------------------------------------------------------**/
+class allocator {
+ public:
+  virtual ~allocator() = default;
+
+  virtual gdf_error allocate(void** ptr, size_t bytes, cudaStream_t stream) = 0;
+  virtual gdf_error deallocate(void* ptr, cudaStream_t stream) = 0;
+
+  /// Returns any memory cached by the allocator to its upstream
+  virtual gdf_error release() { return GDF_SUCCESS; }
+
+  virtual gdf_allocator_stats get_stats() const = 0;
+
+  /// Installs a callback invoked on every allocation and deallocation.
+  /// Not thread-safe with respect to concurrent (de)allocations.
+  virtual void set_hook(allocation_hook hook) = 0;
+
+  /// True if the allocator returns device accessible memory
+  virtual bool is_device_memory() const = 0;
+};
+
+/** ---------------------------------------------------------------------------*
+ * @brief Device memory allocator forwarding every request to RMM
+ * ---------------------------------------------------------------------------**/
+class rmm_allocator : public allocator {
+ public:
+  rmm_allocator();
+  ~rmm_allocator();
+
+  gdf_error allocate(void** ptr, size_t bytes, cudaStream_t stream) override;
+  gdf_error deallocate(void* ptr, cudaStream_t stream) override;
+  gdf_allocator_stats get_stats() const override;
+  void set_hook(allocation_hook hook) override;
+  bool is_device_memory() const override { return true; }
+
+ private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+/** ---------------------------------------------------------------------------*
+ * @brief Host memory allocator returning 256-byte aligned pageable memory
+ *
+ * Used for host staging buffers and by host implementations of libcudf
+ * algorithms. The stream argument is ignored.
+ * ---------------------------------------------------------------------------**/
+class host_allocator : public allocator {
+ public:
+  host_allocator();
+  ~host_allocator();
+
+  gdf_error allocate(void** ptr, size_t bytes, cudaStream_t stream) override;
+  gdf_error deallocate(void* ptr, cudaStream_t stream) override;
+  gdf_allocator_stats get_stats() const override;
+  void set_hook(allocation_hook hook) override;
+  bool is_device_memory() const override { return false; }
+
+ private:
+  struct impl;
+  std::unique_ptr<impl> impl_;
+};
+
+/** ---------------------------------------------------------------------------*
+ * @brief Caching allocator that rounds requests up to power-of-two size
+ * classes and recycles released blocks
+ *
+ * Released blocks are first kept in a cache private to the releasing thread,
+ * which serves later requests of that thread without locking. When a thread
+ * cache grows beyond `max_thread_cache_bytes` half of it is moved to an arena
+ * shared by all threads. A cached block is only reused for a request on the
+ * stream it was released on, which keeps reuse stream ordered. Requests larger
+ * than `max_cached_block_size` bypass the caches.
+ *
+ * If the upstream allocator fails, all cached blocks are returned upstream and
+ * the request is retried once. release() also empties the caches of all other
+ * threads.
+ * ---------------------------------------------------------------------------**/
+class pool_allocator : public allocator {
+ public:
+  struct options {
+    size_t min_block_size{256};               ///< Smallest size class
+    size_t max_cached_block_size{1ul << 26};  ///< Largest size class (64MB)
+    size_t max_thread_cache_bytes{1ul << 24}; ///< Per-thread cache limit
+    size_t max_cached_bytes{1ul << 31};       ///< Limit of the shared arena
+  };
+
+  explicit pool_allocator(std::shared_ptr<allocator> upstream);
+  pool_allocator(std::shared_ptr<allocator> upstream, options const& opts);
+  ~pool_allocator();
+
+  gdf_error allocate(void** ptr, size_t bytes, cudaStream_t stream) override;
+  gdf_error deallocate(void* ptr, cudaStream_t stream) override;
+  gdf_error release() override;
+  gdf_allocator_stats get_stats() const override;
+  void set_hook(allocation_hook hook) override;
+  bool is_device_memory() const override;
+
+  struct arena;
+
+ private:
+  std::shared_ptr<arena> arena_;
+};
+
+/** ---------------------------------------------------------------------------*
+ * @brief Returns the process-wide allocator for device scratch memory
+ *
+ * Unless replaced by set_device_allocator, this is a pool_allocator on top of
+ * an rmm_allocator.
+ * ---------------------------------------------------------------------------**/
+allocator& device_allocator();
+
+/** ---------------------------------------------------------------------------*
+ * @brief Returns the process-wide allocator for host scratch memory
+ * ---------------------------------------------------------------------------**/
+allocator& host_scratch_allocator();
+
+/** ---------------------------------------------------------------------------*
+ * @brief Replaces the process-wide device scratch allocator
+ *
+ * Must be called while no scratch memory is outstanding. Passing nullptr
+ * restores the default pool.
+ * ---------------------------------------------------------------------------**/
+void set_device_allocator(std::shared_ptr<allocator> new_allocator);
+
+} // namespace memory
+} // namespace cudf
+
+/** ---------------------------------------------------------------------------*
+ * @brief Allocates `size` bytes of device scratch memory into `*ptr`, returning
+ * the error code from the enclosing function on failure
+ * ---------------------------------------------------------------------------**/
+#define SCRATCH_ALLOC_TRY(ptr, size, stream)                                    \
+{                                                                               \
+    gdf_error scratch_status = cudf::memory::device_allocator().allocate(       \
+        reinterpret_cast<void**>(ptr), (size), (stream));                       \
+    if (GDF_SUCCESS != scratch_status) return scratch_status;                   \
+}
+
+/** ---------------------------------------------------------------------------*
+ * @brief Releases device scratch memory obtained with SCRATCH_ALLOC_TRY
+ * ---------------------------------------------------------------------------**/
+#define SCRATCH_FREE_TRY(ptr, stream)                                           \
+{                                                                               \
+    gdf_error scratch_status =                                                  \
+        cudf::memory::device_allocator().deallocate((ptr), (stream));           \
+    if (GDF_SUCCESS != scratch_status) return scratch_status;                   \
+}
+
+#endif // GDF_ALLOCATOR_HPP
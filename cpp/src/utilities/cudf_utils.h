@@ -16,6 +16,15 @@
 #define CUDA_LAUNCHABLE
 #endif
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief The gdf_dtype of columns holding row indices or row counts, i.e.,
+ * gdf_index_type / gdf_size_type values. GDF_INT64 when built with
+ * GDF_LARGE_COLUMNS, GDF_INT32 otherwise.
+ */
+/* ----------------------------------------------------------------------------*/
+constexpr gdf_dtype GDF_INDEX_DTYPE{sizeof(gdf_index_type) == sizeof(int64_t) ? GDF_INT64 : GDF_INT32};
+
 inline gdf_error set_null_count(gdf_column* col) {
   gdf_size_type valid_count{};
   gdf_error result =
@@ -41,6 +50,28 @@ gdf_size_type gdf_get_num_chars_bitmask(gdf_size_type size) {
 	return (( size + ( GDF_VALID_BITSIZE - 1)) / GDF_VALID_BITSIZE ); 
 }
 
+/* --------------------------------------------------------------------------*/
+/** 
+ * @brief Whether ptr points to plain host memory, i.e., memory that was
+ * neither allocated nor registered with CUDA. Such buffers cannot be read by
+ * kernels and are processed on the host.
+ */
+/* ----------------------------------------------------------------------------*/
+inline bool is_host_memory(const void* ptr) {
+	cudaPointerAttributes attributes;
+	if (cudaErrorInvalidValue == cudaPointerGetAttributes(&attributes, ptr)) {
+		// Runtimes before CUDA 11 reject pointers they do not know
+		cudaGetLastError(); // clear the error
+		return true;
+	}
+#if CUDART_VERSION >= 10000
+	// Later ones succeed and report them as unregistered
+	return cudaMemoryTypeUnregistered == attributes.type;
+#else
+	return false;
+#endif
+}
+
 /* --------------------------------------------------------------------------*/
 /** 
  * @brief Flatten AOS info from gdf_columns into SOA.
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2018, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+#include <utilities/cudf_utils.h>
+#include <bitmask/bit_mask.h>
+#include <bitmask/bitmask_ops.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+#include "tests/utilities/cudf_test_utils.cuh"
+#include "tests/utilities/cudf_test_fixtures.h"
+
+#include <cstdlib>
+#include <vector>
+
+struct BitmaskOpsTest : public GdfTest
+{
+  std::vector<gdf_valid_type> random_mask(gdf_size_type num_bits)
+  {
+    std::vector<gdf_valid_type> mask(gdf_get_num_chars_bitmask(num_bits));
+    for (auto & m : mask) {
+      m = static_cast<gdf_valid_type>(std::rand());
+    }
+    return mask;
+  }
+
+  std::vector<gdf_valid_type> to_host(rmm::device_vector<gdf_valid_type> const & d_mask)
+  {
+    std::vector<gdf_valid_type> mask(d_mask.size());
+    cudaMemcpy(mask.data(), d_mask.data().get(), d_mask.size(), cudaMemcpyDeviceToHost);
+    return mask;
+  }
+};
+
+TEST_F(BitmaskOpsTest, HostHelpers)
+{
+  EXPECT_EQ(0, bit_mask::popcount(0u));
+  EXPECT_EQ(32, bit_mask::popcount(0xffffffffu));
+  EXPECT_EQ(3, bit_mask::popcount(0x80000101u));
+
+  EXPECT_EQ(0x12345678u, bit_mask::funnel_shift_right(0x12345678u, 0x9abcdef0u, 0));
+  EXPECT_EQ(0xdef01234u, bit_mask::funnel_shift_right(0x12345678u, 0x9abcdef0u, 16));
+
+  EXPECT_EQ(0xffffffffu, bit_mask::last_element_mask(64));
+  EXPECT_EQ(0x7fu, bit_mask::last_element_mask(39));
+
+  // 5 bytes: one whole element and one partial one
+  std::vector<gdf_valid_type> mask{0x01, 0x02, 0x04, 0x08, 0xff};
+  EXPECT_EQ(0x08040201u, bit_mask::load_element(mask.data(), 0, 5));
+  EXPECT_EQ(0x000000ffu, bit_mask::load_element(mask.data(), 1, 5));
+  EXPECT_EQ(0xff080402u, bit_mask::load_bits(mask.data(), 8, 5));
+  EXPECT_EQ(0x08040201u << 4, bit_mask::load_bits(mask.data(), -4, 5));
+}
+
+TEST_F(BitmaskOpsTest, CombineMasks)
+{
+  for (gdf_size_type num_bits : {1, 31, 32, 33, 100, 1000, 4099}) {
+    std::vector<std::vector<gdf_valid_type>> h_masks{random_mask(num_bits), random_mask(num_bits), random_mask(num_bits)};
+    std::vector<rmm::device_vector<gdf_valid_type>> d_masks;
+    std::vector<gdf_valid_type const *> mask_ptrs;
+    for (auto const & m : h_masks) {
+      d_masks.emplace_back(m);
+    }
+    for (auto const & m : d_masks) {
+      mask_ptrs.push_back(m.data().get());
+    }
+    // A column without a validity mask
+    mask_ptrs.push_back(nullptr);
+
+    for (bitmask_op op : {bitmask_op::AND, bitmask_op::OR, bitmask_op::ANDNOT}) {
+      rmm::device_vector<gdf_valid_type> d_out(gdf_get_num_chars_bitmask(num_bits));
+
+      ASSERT_EQ(GDF_SUCCESS, bitmask_combine(d_out.data().get(), mask_ptrs.data(),
+                                             3, num_bits, op, 0));
+      auto result = to_host(d_out);
+
+      gdf_size_type expected_count{0};
+      for (gdf_size_type i = 0; i < num_bits; ++i) {
+        bool const a{gdf_is_valid(h_masks[0].data(), i)};
+        bool const b{gdf_is_valid(h_masks[1].data(), i)};
+        bool const c{gdf_is_valid(h_masks[2].data(), i)};
+        bool expected{false};
+        switch (op) {
+          case bitmask_op::AND:    expected = a && b && c; break;
+          case bitmask_op::OR:     expected = a || b || c; break;
+          case bitmask_op::ANDNOT: expected = a && !b && !c; break;
+        }
+        EXPECT_EQ(expected, gdf_is_valid(result.data(), i)) << "bit " << i;
+        expected_count += expected;
+      }
+
+      gdf_size_type count{-1};
+      ASSERT_EQ(GDF_SUCCESS, bitmask_count_valid(d_out.data().get(), num_bits, &count, 0));
+      EXPECT_EQ(expected_count, count);
+    }
+
+    // The null mask is all ones: it is the identity for AND and makes OR all valid
+    rmm::device_vector<gdf_valid_type> d_out(gdf_get_num_chars_bitmask(num_bits));
+    ASSERT_EQ(GDF_SUCCESS, bitmask_combine(d_out.data().get(), mask_ptrs.data(),
+                                           4, num_bits, bitmask_op::OR, 0));
+    gdf_size_type count{-1};
+    ASSERT_EQ(GDF_SUCCESS, bitmask_count_valid(d_out.data().get(), num_bits, &count, 0));
+    EXPECT_EQ(num_bits, count);
+  }
+}
+
+TEST_F(BitmaskOpsTest, CopyWithOffsets)
+{
+  gdf_size_type const in_size{300};
+  auto h_in = random_mask(in_size);
+  rmm::device_vector<gdf_valid_type> d_in(h_in);
+
+  for (gdf_size_type in_offset : {0, 1, 7, 32, 45}) {
+    for (gdf_size_type out_offset : {0, 3, 31, 64, 70}) {
+      for (gdf_size_type num_bits : {1, 29, 64, 200}) {
+        gdf_size_type const out_size{out_offset + num_bits + 40};
+        auto h_out = random_mask(out_size);
+        rmm::device_vector<gdf_valid_type> d_out(h_out);
+
+        ASSERT_EQ(GDF_SUCCESS, bitmask_copy_offset(d_out.data().get(), out_offset,
+                                                   d_in.data().get(), in_offset,
+                                                   num_bits, 0));
+        auto result = to_host(d_out);
+
+        for (gdf_size_type i = 0; i < out_size; ++i) {
+          bool const inside{(i >= out_offset) && (i < out_offset + num_bits)};
+          bool const expected{inside ? gdf_is_valid(h_in.data(), i - out_offset + in_offset)
+                                     : gdf_is_valid(h_out.data(), i)};
+          ASSERT_EQ(expected, gdf_is_valid(result.data(), i))
+            << "bit " << i << " in_offset " << in_offset
+            << " out_offset " << out_offset << " num_bits " << num_bits;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(BitmaskOpsTest, ColumnConcat)
+{
+  std::vector<gdf_size_type> sizes{13, 1, 64, 5, 100, 37};
+  gdf_size_type total_size{0};
+
+  std::vector<gdf_col_pointer> columns;
+  std::vector<gdf_column*> raw_columns;
+  std::vector<std::vector<gdf_valid_type>> h_masks;
+  for (size_t c = 0; c < sizes.size(); ++c) {
+    std::vector<int32_t> data(sizes[c]);
+    auto mask = random_mask(sizes[c]);
+    // Every other column has no validity mask
+    if (c % 2 == 1) {
+      columns.push_back(create_gdf_column(data));
+      mask.assign(mask.size(), 0xff);
+    } else {
+      columns.push_back(create_gdf_column(data, mask));
+    }
+    h_masks.push_back(mask);
+    raw_columns.push_back(columns.back().get());
+    total_size += sizes[c];
+  }
+
+  std::vector<int32_t> output_data(total_size);
+  std::vector<gdf_valid_type> output_mask(gdf_get_num_chars_bitmask(total_size), 0);
+  auto output = create_gdf_column(output_data, output_mask);
+
+  ASSERT_EQ(GDF_SUCCESS, gdf_column_concat(output.get(), raw_columns.data(), raw_columns.size()));
+
+  std::vector<gdf_valid_type> result(gdf_get_num_chars_bitmask(total_size));
+  cudaMemcpy(result.data(), output->valid, result.size(), cudaMemcpyDeviceToHost);
+
+  gdf_size_type row{0};
+  for (size_t c = 0; c < sizes.size(); ++c) {
+    for (gdf_size_type i = 0; i < sizes[c]; ++i, ++row) {
+      EXPECT_EQ(gdf_is_valid(h_masks[c].data(), i), gdf_is_valid(result.data(), row))
+        << "column " << c << " row " << i;
+    }
+  }
+}
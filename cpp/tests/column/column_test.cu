@@ -345,3 +345,70 @@ TEST(ColumnByteWidth, TestByteWidth)
     EXPECT_EQ(pair.second, byte_width);
   }
 }
+
+TEST(ColumnSliceTest, SharesDataAndRealignsValid)
+{
+  gdf_size_type const num_rows{1000};
+  std::vector<int64_t> data(num_rows);
+  for (gdf_size_type i = 0; i < num_rows; ++i) data[i] = i;
+
+  std::vector<gdf_valid_type> valid(gdf_get_num_chars_bitmask(num_rows));
+  for (auto & v : valid) v = static_cast<gdf_valid_type>(std::rand());
+
+  auto input = create_gdf_column(data, valid);
+
+  for (gdf_size_type begin : {0, 5, 31, 32, 64, 100, 999, 1000}) {
+    for (gdf_size_type end : {begin, begin + 1, begin + 37, num_rows}) {
+      if (end > num_rows) continue;
+      gdf_column slice;
+      ASSERT_EQ(GDF_SUCCESS, gdf_column_slice(input.get(), begin, end, &slice));
+
+      gdf_size_type const size{end - begin};
+      EXPECT_EQ(size, slice.size);
+      EXPECT_EQ(static_cast<int64_t*>(input->data) + begin, slice.data);
+      if (size > 0 && begin % 32 == 0) {
+        EXPECT_EQ(input->valid + begin / 8, slice.valid);
+      }
+
+      std::vector<int64_t> slice_data(size);
+      std::vector<gdf_valid_type> slice_valid(gdf_get_num_chars_bitmask(size));
+      if (size > 0) {
+        cudaMemcpy(slice_data.data(), slice.data, size * sizeof(int64_t), cudaMemcpyDeviceToHost);
+        cudaMemcpy(slice_valid.data(), slice.valid, slice_valid.size(), cudaMemcpyDeviceToHost);
+      }
+
+      gdf_size_type expected_nulls{0};
+      for (gdf_size_type i = 0; i < size; ++i) {
+        EXPECT_EQ(begin + i, slice_data[i]);
+        bool const expected_valid{gdf_is_valid(valid.data(), begin + i)};
+        EXPECT_EQ(expected_valid, gdf_is_valid(slice_valid.data(), i))
+          << "begin " << begin << " row " << i;
+        expected_nulls += !expected_valid;
+      }
+      EXPECT_EQ(expected_nulls, slice.null_count);
+
+      ASSERT_EQ(GDF_SUCCESS, gdf_column_slice_free(input.get(), &slice));
+    }
+  }
+}
+
+TEST(ColumnSliceTest, InvalidRange)
+{
+  std::vector<int32_t> data(10);
+  auto input = create_gdf_column(data);
+  gdf_column slice;
+
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_column_slice(input.get(), 5, 4, &slice));
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_column_slice(input.get(), -1, 4, &slice));
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_column_slice(input.get(), 0, 11, &slice));
+  EXPECT_EQ(GDF_DATASET_EMPTY, gdf_column_slice(nullptr, 0, 1, &slice));
+
+  // Rows of variable width cannot be sliced by offsetting the data
+  input->dtype = GDF_STRING;
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE, gdf_column_slice(input.get(), 2, 7, &slice));
+  input->dtype = GDF_INT32;
+
+  ASSERT_EQ(GDF_SUCCESS, gdf_column_slice(input.get(), 2, 7, &slice));
+  EXPECT_EQ(nullptr, slice.valid);
+  EXPECT_EQ(0, slice.null_count);
+}
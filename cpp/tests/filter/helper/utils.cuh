@@ -15,6 +15,8 @@
 #include <tuple>
 #include <rmm/rmm.h>
 
+#include "utilities/cudf_utils.h"
+
 template <typename gdf_type>
 inline gdf_dtype gdf_enum_type_for()
 {
@@ -211,13 +213,9 @@ void check_column_for_stencil_operation(gdf_column *column, gdf_column *stencil,
     //EXPECT_EQ(host_column.dtype == host_output_op.dtype);  // it must have the same type
 
     
-    int  n_bytes =  sizeof(int8_t) * (column->size + GDF_VALID_BITSIZE - 1) / GDF_VALID_BITSIZE;
     std::vector<int> indexes;
     for(gdf_size_type i = 0; i < host_stencil.size; i++) {
-        int col_position =  i / 8;
-        int length_col = n_bytes != col_position+1 ? GDF_VALID_BITSIZE : column->size - GDF_VALID_BITSIZE * (n_bytes - 1);
-        int bit_offset =  (length_col - 1) - (i % 8);
-        bool valid = ((host_stencil.valid[col_position] >> bit_offset ) & 1) != 0;
+        bool valid = gdf_is_valid(host_stencil.valid, i);
          if ( (int)( ((int8_t *)host_stencil.data)[i] ) == 1 && valid ) {
              indexes.push_back(i);
          }
@@ -230,10 +228,7 @@ void check_column_for_stencil_operation(gdf_column *column, gdf_column *stencil,
         std::cout << "filtered values: " << index  << "** "  << "\t value: " << (int)value << std::endl;
         EXPECT_EQ( ((RightValueType*)host_output_op.data)[i], value);
         
-        int col_position =  i / 8;
-        int length_col = n_bytes != col_position+1 ? GDF_VALID_BITSIZE : output_op->size - GDF_VALID_BITSIZE * (n_bytes - 1);
-        int bit_offset =  (length_col - 1) - (i % 8);
-        bool valid = ((host_output_op.valid[col_position] >> bit_offset ) & 1) != 0;
+        bool valid = gdf_is_valid(host_output_op.valid, i);
         EXPECT_EQ(valid, true);
     }
 }
@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+namespace {
+
+gdf_predicate_value integer_value(int64_t value)
+{
+  return gdf_predicate_value{GDF_INT64, value, 0.};
+}
+
+gdf_predicate_value real_value(double value)
+{
+  return gdf_predicate_value{GDF_FLOAT64, 0, value};
+}
+
+gdf_predicate term(gdf_predicate_kind kind, int column, gdf_comparison_operator op = GDF_EQUALS,
+                   gdf_predicate_value const* values = nullptr, int num_values = 0)
+{
+  gdf_predicate node{};
+  node.kind = kind;
+  node.column = column;
+  node.op = op;
+  node.values = values;
+  node.num_values = num_values;
+  return node;
+}
+
+gdf_predicate combine(gdf_predicate_kind kind, int left, int right)
+{
+  gdf_predicate node{};
+  node.kind = kind;
+  node.left = left;
+  node.right = right;
+  return node;
+}
+
+} // namespace
+
+struct PredicateTest : public GdfTest {
+
+  static constexpr int num_rows = 1001;
+
+  gdf_col_pointer ints;
+  gdf_col_pointer doubles;
+  gdf_col_pointer bytes;
+  std::vector<gdf_column*> input;
+
+  // Row i has the values i, i / 2. and i % 100, the doubles are null for
+  // multiples of 3 and the bytes for multiples of 5
+  void SetUp() override
+  {
+    std::vector<int32_t> h_ints(num_rows);
+    std::vector<double> h_doubles(num_rows);
+    std::vector<int8_t> h_bytes(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+      h_ints[i] = i;
+      h_doubles[i] = i / 2.;
+      h_bytes[i] = i % 100;
+    }
+    ints = create_gdf_column(h_ints);
+    ints->valid = nullptr;
+    ints->null_count = 0;
+    doubles = create_gdf_column(h_doubles, make_valid(num_rows, [](int i) { return i % 3 != 0; }));
+    bytes = create_gdf_column(h_bytes, make_valid(num_rows, [](int i) { return i % 5 != 0; }));
+    input = {ints.get(), doubles.get(), bytes.get()};
+  }
+
+  // Evaluates the predicate and checks the bits of the rows against expected
+  void check_mask(std::vector<gdf_predicate> const& predicates, bool (*expected)(int))
+  {
+    rmm::device_vector<gdf_valid_type> mask(gdf_get_num_chars_bitmask(num_rows), 0xff);
+    gdf_size_type num_true{-1};
+    ASSERT_EQ(GDF_SUCCESS, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                  predicates.size(), mask.data().get(), &num_true));
+
+    std::vector<gdf_valid_type> h_mask(mask.size());
+    thrust::copy(mask.begin(), mask.end(), h_mask.begin());
+    gdf_size_type expected_true{0};
+    for (int i = 0; i < num_rows; ++i) {
+      EXPECT_EQ(expected(i), gdf_is_valid(h_mask.data(), i)) << "row " << i;
+      expected_true += expected(i);
+    }
+    EXPECT_EQ(expected_true, num_true);
+  }
+};
+
+TEST_F(PredicateTest, AndOrTree)
+{
+  // (ints < 500 AND doubles >= 100) OR bytes IN (1, 7, 42)
+  const gdf_predicate_value five_hundred = integer_value(500);
+  const gdf_predicate_value hundred = real_value(100.);
+  const gdf_predicate_value in_list[] = {integer_value(1), integer_value(7), integer_value(42)};
+  std::vector<gdf_predicate> predicates{
+    term(GDF_PREDICATE_COMPARE, 0, GDF_LESS_THAN, &five_hundred, 1),
+    term(GDF_PREDICATE_COMPARE, 1, GDF_GREATER_THAN_OR_EQUALS, &hundred, 1),
+    combine(GDF_PREDICATE_AND, 0, 1),
+    term(GDF_PREDICATE_IN, 2, GDF_EQUALS, in_list, 3),
+    combine(GDF_PREDICATE_OR, 2, 3)};
+  check_mask(predicates, [](int i) {
+    const int b = i % 100;
+    return (i < 500 && i % 3 != 0 && i / 2. >= 100) || (i % 5 != 0 && (b == 1 || b == 7 || b == 42));
+  });
+}
+
+TEST_F(PredicateTest, ShortCircuit)
+{
+  // The left operands decide whole warps below and above row 640
+  const gdf_predicate_value bound = integer_value(640);
+  std::vector<gdf_predicate> predicates{
+    term(GDF_PREDICATE_COMPARE, 0, GDF_GREATER_THAN_OR_EQUALS, &bound, 1),
+    term(GDF_PREDICATE_IS_NOT_NULL, 2),
+    combine(GDF_PREDICATE_AND, 0, 1)};
+  check_mask(predicates, [](int i) { return i >= 640 && i % 5 != 0; });
+
+  predicates[2].kind = GDF_PREDICATE_OR;
+  check_mask(predicates, [](int i) { return i >= 640 || i % 5 != 0; });
+}
+
+TEST_F(PredicateTest, ColumnsAndNulls)
+{
+  // bytes > doubles OR doubles IS NULL, where nulls make a comparison false
+  gdf_predicate compare_columns = term(GDF_PREDICATE_COMPARE_COLUMNS, 2, GDF_GREATER_THAN);
+  compare_columns.other_column = 1;
+  std::vector<gdf_predicate> predicates{
+    compare_columns,
+    term(GDF_PREDICATE_IS_NULL, 1),
+    combine(GDF_PREDICATE_OR, 0, 1)};
+  check_mask(predicates, [](int i) {
+    return (i % 5 != 0 && i % 3 != 0 && i % 100 > i / 2.) || i % 3 == 0;
+  });
+}
+
+TEST_F(PredicateTest, FilterBetween)
+{
+  // ints BETWEEN 100 AND 200 AND doubles IS NULL
+  const gdf_predicate_value range[] = {integer_value(100), real_value(200.)};
+  std::vector<gdf_predicate> predicates{
+    term(GDF_PREDICATE_BETWEEN, 0, GDF_EQUALS, range, 2),
+    term(GDF_PREDICATE_IS_NULL, 1),
+    combine(GDF_PREDICATE_AND, 0, 1)};
+
+  std::vector<gdf_column> output(input.size());
+  std::vector<gdf_column*> output_ptrs{&output[0], &output[1], &output[2]};
+  ASSERT_EQ(GDF_SUCCESS, gdf_filter_predicate(input.data(), input.size(), predicates.data(),
+                                              predicates.size(), output_ptrs.data()));
+
+  // The multiples of 3 from 102 to 198
+  const gdf_size_type size = 33;
+  ASSERT_EQ(size, output[0].size);
+  const auto h_ints = to_host<int32_t>(&output[0]);
+  for (gdf_size_type j = 0; j < size; ++j) {
+    EXPECT_EQ(102 + 3 * j, h_ints[j]);
+  }
+  EXPECT_EQ(size, output[1].null_count);
+
+  for (auto& col : output) {
+    gdf_column_free(&col);
+    free(col.col_name);
+  }
+}
+
+TEST_F(PredicateTest, LongLeftChain)
+{
+  // ints = 0 OR ints = 2 OR ... with tens of thousands of terms, nested to
+  // the left as a parser builds them
+  const int num_terms = 30000;
+  std::vector<gdf_predicate_value> values;
+  for (int k = 0; k < num_terms; ++k) {
+    values.push_back(integer_value(2 * k));
+  }
+  std::vector<gdf_predicate> predicates{term(GDF_PREDICATE_COMPARE, 0, GDF_EQUALS, &values[0], 1)};
+  for (int k = 1; k < num_terms; ++k) {
+    const int left = predicates.size() - 1;
+    predicates.push_back(term(GDF_PREDICATE_COMPARE, 0, GDF_EQUALS, &values[k], 1));
+    predicates.push_back(combine(GDF_PREDICATE_OR, left, left + 1));
+  }
+  check_mask(predicates, [](int i) { return i % 2 == 0; });
+}
+
+TEST_F(PredicateTest, Errors)
+{
+  rmm::device_vector<gdf_valid_type> mask(gdf_get_num_chars_bitmask(num_rows));
+  gdf_size_type num_true{0};
+  const gdf_predicate_value value = integer_value(1);
+
+  // Operands have to come before the node
+  std::vector<gdf_predicate> predicates{
+    term(GDF_PREDICATE_IS_NULL, 1),
+    combine(GDF_PREDICATE_AND, 0, 1)};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                         predicates.size(), mask.data().get(), &num_true));
+
+  // A node can only be the operand of one node
+  predicates = {
+    term(GDF_PREDICATE_IS_NULL, 1),
+    combine(GDF_PREDICATE_AND, 0, 0)};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                         predicates.size(), mask.data().get(), &num_true));
+  predicates = {
+    term(GDF_PREDICATE_IS_NULL, 1),
+    term(GDF_PREDICATE_IS_NULL, 2),
+    combine(GDF_PREDICATE_AND, 0, 1),
+    combine(GDF_PREDICATE_OR, 2, 1)};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                         predicates.size(), mask.data().get(), &num_true));
+
+  predicates = {term(GDF_PREDICATE_COMPARE, 3, GDF_EQUALS, &value, 1)};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                         predicates.size(), mask.data().get(), &num_true));
+
+  predicates = {term(GDF_PREDICATE_BETWEEN, 0, GDF_EQUALS, &value, 1)};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                         predicates.size(), mask.data().get(), &num_true));
+
+  predicates = {term(GDF_PREDICATE_IS_NULL, 0)};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_evaluate_predicate(input.data(), 0, predicates.data(),
+                                                         predicates.size(), mask.data().get(), &num_true));
+
+  bytes->dtype = GDF_STRING;
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                          predicates.size(), mask.data().get(), &num_true));
+  bytes->dtype = GDF_INT8;
+
+  bytes->size = num_rows - 1;
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH, gdf_evaluate_predicate(input.data(), input.size(), predicates.data(),
+                                                             predicates.size(), mask.data().get(), &num_true));
+  bytes->size = num_rows;
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+struct StencilTableTest : public GdfTest {
+
+  static constexpr int num_rows = 1001;
+
+  gdf_col_pointer ints;
+  gdf_col_pointer doubles;
+  gdf_col_pointer bytes;
+  std::vector<gdf_column*> input;
+
+  // Row i has the values i, i / 2. and i % 100, the doubles are null for
+  // multiples of 3 and the bytes for multiples of 5
+  void SetUp() override
+  {
+    std::vector<int32_t> h_ints(num_rows);
+    std::vector<double> h_doubles(num_rows);
+    std::vector<int8_t> h_bytes(num_rows);
+    for (int i = 0; i < num_rows; ++i) {
+      h_ints[i] = i;
+      h_doubles[i] = i / 2.;
+      h_bytes[i] = i % 100;
+    }
+    ints = create_gdf_column(h_ints);
+    ints->valid = nullptr;
+    ints->null_count = 0;
+    doubles = create_gdf_column(h_doubles, make_valid(num_rows, [](int i) { return i % 3 != 0; }));
+    bytes = create_gdf_column(h_bytes, make_valid(num_rows, [](int i) { return i % 5 != 0; }));
+    input = {ints.get(), doubles.get(), bytes.get()};
+  }
+
+  // Checks the outputs hold exactly the rows kept by keep, in order
+  void check_output(std::vector<gdf_column>& output, bool (*keep)(int))
+  {
+    std::vector<int> kept;
+    for (int i = 0; i < num_rows; ++i) {
+      if (keep(i)) kept.push_back(i);
+    }
+    const gdf_size_type size = kept.size();
+    for (auto& col : output) {
+      ASSERT_EQ(size, col.size);
+    }
+    EXPECT_EQ(nullptr, output[0].valid);
+    EXPECT_EQ(0, output[0].null_count);
+    ASSERT_NE(nullptr, output[1].valid);
+    ASSERT_NE(nullptr, output[2].valid);
+
+    const auto out_ints = to_host<int32_t>(&output[0]);
+    const auto out_doubles = to_host<double>(&output[1]);
+    const auto out_bytes = to_host<int8_t>(&output[2]);
+    const auto doubles_valid = valid_to_host(&output[1]);
+    const auto bytes_valid = valid_to_host(&output[2]);
+    gdf_size_type doubles_nulls{0}, bytes_nulls{0};
+    for (gdf_size_type j = 0; j < size; ++j) {
+      const int i = kept[j];
+      EXPECT_EQ(i, out_ints[j]);
+      EXPECT_EQ(i % 3 != 0, doubles_valid[j]);
+      if (i % 3 != 0) {
+        EXPECT_EQ(i / 2., out_doubles[j]);
+      }
+      EXPECT_EQ(i % 5 != 0, bytes_valid[j]);
+      if (i % 5 != 0) {
+        EXPECT_EQ(i % 100, out_bytes[j]);
+      }
+      doubles_nulls += (i % 3 == 0);
+      bytes_nulls += (i % 5 == 0);
+    }
+    EXPECT_EQ(doubles_nulls, output[1].null_count);
+    EXPECT_EQ(bytes_nulls, output[2].null_count);
+
+    for (auto& col : output) {
+      gdf_column_free(&col);
+      free(col.col_name);
+    }
+  }
+};
+
+TEST_F(StencilTableTest, BooleanStencil)
+{
+  // Rows with a null stencil value are removed too
+  std::vector<int8_t> h_stencil(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    h_stencil[i] = (i % 4 != 1);
+  }
+  gdf_col_pointer stencil = create_gdf_column(h_stencil, make_valid(num_rows, [](int i) { return i % 7 != 0; }));
+
+  // The outputs own copies of the names
+  char name[] = "ints";
+  ints->col_name = name;
+
+  std::vector<gdf_column> output(input.size());
+  std::vector<gdf_column*> output_ptrs{&output[0], &output[1], &output[2]};
+  ASSERT_EQ(GDF_SUCCESS, gdf_apply_stencil_table(input.data(), input.size(), stencil.get(), output_ptrs.data()));
+  EXPECT_STREQ(name, output[0].col_name);
+  EXPECT_NE(name, output[0].col_name);
+  EXPECT_EQ(nullptr, output[1].col_name);
+  check_output(output, [](int i) { return i % 4 != 1 && i % 7 != 0; });
+}
+
+TEST_F(StencilTableTest, BitmaskStencil)
+{
+  const auto h_stencil = make_valid(num_rows, [](int i) { return i % 33 < 20; });
+  rmm::device_vector<gdf_valid_type> stencil(h_stencil);
+
+  std::vector<gdf_column> output(input.size());
+  std::vector<gdf_column*> output_ptrs{&output[0], &output[1], &output[2]};
+  ASSERT_EQ(GDF_SUCCESS, gdf_apply_bitmask_table(input.data(), input.size(), stencil.data().get(),
+                                                 output_ptrs.data()));
+  check_output(output, [](int i) { return i % 33 < 20; });
+}
+
+TEST_F(StencilTableTest, NoRowsKept)
+{
+  const auto h_stencil = make_valid(num_rows, [](int) { return false; });
+  rmm::device_vector<gdf_valid_type> stencil(h_stencil);
+
+  std::vector<gdf_column> output(input.size());
+  std::vector<gdf_column*> output_ptrs{&output[0], &output[1], &output[2]};
+  ASSERT_EQ(GDF_SUCCESS, gdf_apply_bitmask_table(input.data(), input.size(), stencil.data().get(),
+                                                 output_ptrs.data()));
+  for (auto const& col : output) {
+    EXPECT_EQ(0, col.size);
+    EXPECT_EQ(0, col.null_count);
+    EXPECT_EQ(nullptr, col.data);
+  }
+}
+
+TEST_F(StencilTableTest, SingleNullableColumn)
+{
+  std::vector<int8_t> h_stencil(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    h_stencil[i] = (i % 2);
+  }
+  gdf_col_pointer stencil = create_gdf_column(h_stencil);
+  stencil->valid = nullptr;
+  stencil->null_count = 0;
+
+  gdf_col_pointer output = create_gdf_column(std::vector<double>(num_rows),
+                                             std::vector<gdf_valid_type>(gdf_get_num_chars_bitmask(num_rows)));
+  ASSERT_EQ(GDF_SUCCESS, gdf_apply_stencil(doubles.get(), stencil.get(), output.get()));
+  ASSERT_EQ((num_rows - 1) / 2, output->size);
+
+  const auto values = to_host<double>(output.get());
+  const auto valid = valid_to_host(output.get());
+  gdf_size_type nulls{0};
+  for (gdf_size_type j = 0; j < output->size; ++j) {
+    const int i = 2 * j + 1;
+    EXPECT_EQ(i % 3 != 0, valid[j]);
+    if (i % 3 != 0) {
+      EXPECT_EQ(i / 2., values[j]);
+    }
+    nulls += (i % 3 == 0);
+  }
+  EXPECT_EQ(nulls, output->null_count);
+}
+
+TEST_F(StencilTableTest, Errors)
+{
+  gdf_col_pointer stencil = create_gdf_column(std::vector<int8_t>(num_rows - 1, 1));
+  stencil->valid = nullptr;
+
+  std::vector<gdf_column> output(input.size());
+  std::vector<gdf_column*> output_ptrs{&output[0], &output[1], &output[2]};
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH,
+            gdf_apply_stencil_table(input.data(), input.size(), stencil.get(), output_ptrs.data()));
+  EXPECT_EQ(GDF_INVALID_API_CALL,
+            gdf_apply_stencil_table(input.data(), 0, stencil.get(), output_ptrs.data()));
+
+  stencil->size = num_rows;
+  stencil->dtype = GDF_INT32;
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE,
+            gdf_apply_stencil_table(input.data(), input.size(), stencil.get(), output_ptrs.data()));
+
+  bytes->dtype = GDF_STRING;
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE,
+            gdf_apply_bitmask_table(input.data(), input.size(), bytes->valid, output_ptrs.data()));
+  bytes->dtype = GDF_INT8;
+
+  // A nullable column needs an output bitmask
+  gdf_col_pointer no_valid = create_gdf_column(std::vector<double>(num_rows));
+  no_valid->valid = nullptr;
+  stencil->dtype = GDF_INT8;
+  EXPECT_EQ(GDF_VALIDITY_MISSING, gdf_apply_stencil(doubles.get(), stencil.get(), no_valid.get()));
+}
@@ -124,7 +124,7 @@ struct HashPartitionTest : public GdfTest
     }
   }
 
-  std::vector<int> compute_gdf_result(const int num_partitions, bool print = false)
+  std::vector<gdf_size_type> compute_gdf_result(const int num_partitions, bool print = false)
   {
     const int num_columns = std::tuple_size<multi_column_t>::value;
 
@@ -133,7 +133,7 @@ struct HashPartitionTest : public GdfTest
     gdf_column ** gdf_input_columns = raw_gdf_input_columns.data();
     gdf_column ** gdf_output_columns = raw_gdf_output_columns.data();
 
-    std::vector<int> partition_offsets(num_partitions,0);
+    std::vector<gdf_size_type> partition_offsets(num_partitions,0);
 
     result_error = gdf_hash_partition(num_columns, 
                                       gdf_input_columns,
@@ -160,7 +160,7 @@ struct HashPartitionTest : public GdfTest
   } 
 
 
-  void verify_gdf_result(int num_partitions, std::vector<int> partition_offsets, bool print = false)
+  void verify_gdf_result(int num_partitions, std::vector<gdf_size_type> partition_offsets, bool print = false)
   {
 
 
@@ -294,7 +294,7 @@ TYPED_TEST(HashPartitionTest, ExampleTest)
 
   this->create_input(100, 100);
 
-  std::vector<int> partition_offsets = this->compute_gdf_result(num_partitions);
+  std::vector<gdf_size_type> partition_offsets = this->compute_gdf_result(num_partitions);
 
   this->verify_gdf_result(num_partitions, partition_offsets);
 }
@@ -307,7 +307,7 @@ TYPED_TEST(HashPartitionTest, OnePartition)
 
   this->create_input(100000, 1000);
 
-  std::vector<int> partition_offsets = this->compute_gdf_result(num_partitions);
+  std::vector<gdf_size_type> partition_offsets = this->compute_gdf_result(num_partitions);
 
   this->verify_gdf_result(num_partitions, partition_offsets);
 }
@@ -319,7 +319,7 @@ TYPED_TEST(HashPartitionTest, TenPartitions)
 
   this->create_input(1000000, 1000);
 
-  std::vector<int> partition_offsets = this->compute_gdf_result(num_partitions);
+  std::vector<gdf_size_type> partition_offsets = this->compute_gdf_result(num_partitions);
 
   this->verify_gdf_result(num_partitions, partition_offsets);
 }
@@ -330,7 +330,7 @@ TYPED_TEST(HashPartitionTest, EightPartitions)
 
   this->create_input(1000000, 1000);
 
-  std::vector<int> partition_offsets = this->compute_gdf_result(num_partitions);
+  std::vector<gdf_size_type> partition_offsets = this->compute_gdf_result(num_partitions);
 
   this->verify_gdf_result(num_partitions, partition_offsets);
 }
@@ -341,7 +341,7 @@ TYPED_TEST(HashPartitionTest, 257Partitions)
 
   this->create_input(1000000, 1000);
 
-  std::vector<int> partition_offsets = this->compute_gdf_result(num_partitions);
+  std::vector<gdf_size_type> partition_offsets = this->compute_gdf_result(num_partitions);
 
   this->verify_gdf_result(num_partitions, partition_offsets);
 }
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+struct HashPartitionerTest : public GdfTest {
+
+  static constexpr int num_partitions = 7;
+  static constexpr int num_batches = 5;
+  static constexpr int batch_size = 10000;
+
+  gdf_dtype dtypes[2] = {GDF_INT32, GDF_INT64};
+  int columns_to_hash[1] = {0};
+
+  // Batch b holds the keys i % 1000 and the values i, for i in
+  // [b * batch_size, (b + 1) * batch_size). Every third value is null.
+  void add_batches(gdf_partitioner_type* partitioner)
+  {
+    for (int b = 0; b < num_batches; ++b) {
+      std::vector<int32_t> keys(batch_size);
+      std::vector<int64_t> values(batch_size);
+      for (int i = 0; i < batch_size; ++i) {
+        const int64_t row = static_cast<int64_t>(b) * batch_size + i;
+        keys[i] = row % 1000;
+        values[i] = row;
+      }
+      gdf_col_pointer key_column = create_gdf_column(keys);
+      key_column->valid = nullptr;
+      gdf_col_pointer value_column = create_gdf_column(values, make_valid(batch_size, [&](int i) {
+        return values[i] % 3 != 0;
+      }));
+      gdf_column* input[] = {key_column.get(), value_column.get()};
+      ASSERT_EQ(GDF_SUCCESS, gdf_hash_partitioner_add(partitioner, input));
+    }
+  }
+
+  // Takes every partition and checks that each row is in the partition of
+  // its key, with its validity, exactly once
+  void take_and_verify(gdf_partitioner_type* partitioner)
+  {
+    std::vector<int64_t> all_values;
+    for (int p = 0; p < num_partitions; ++p) {
+      gdf_size_type size{0};
+      ASSERT_EQ(GDF_SUCCESS, gdf_hash_partitioner_size(partitioner, p, &size));
+
+      gdf_col_pointer keys = create_gdf_column(std::vector<int32_t>(size));
+      keys->valid = nullptr;
+      gdf_col_pointer values = create_gdf_column(std::vector<int64_t>(size),
+                                                 std::vector<gdf_valid_type>(gdf_get_num_chars_bitmask(size), 0));
+      gdf_column* output[] = {keys.get(), values.get()};
+      ASSERT_EQ(GDF_SUCCESS, gdf_hash_partitioner_take(partitioner, p, output));
+
+      gdf_size_type empty_size{-1};
+      ASSERT_EQ(GDF_SUCCESS, gdf_hash_partitioner_size(partitioner, p, &empty_size));
+      EXPECT_EQ(0, empty_size);
+
+      const auto h_keys = to_host<int32_t>(keys.get());
+      const auto h_values = to_host<int64_t>(values.get());
+      const auto h_valid = valid_to_host(values.get());
+
+      gdf_size_type null_count{0};
+      for (gdf_size_type i = 0; i < size; ++i) {
+        EXPECT_EQ(p, h_keys[i] % num_partitions);
+        EXPECT_EQ(h_values[i] % 1000, h_keys[i]);
+        EXPECT_EQ(h_values[i] % 3 != 0, h_valid[i]);
+        null_count += (h_values[i] % 3 == 0);
+      }
+      EXPECT_EQ(null_count, values->null_count);
+      EXPECT_EQ(0, keys->null_count);
+      all_values.insert(all_values.end(), h_values.begin(), h_values.end());
+    }
+
+    std::sort(all_values.begin(), all_values.end());
+    ASSERT_EQ(static_cast<size_t>(num_batches) * batch_size, all_values.size());
+    for (size_t i = 0; i < all_values.size(); ++i) {
+      ASSERT_EQ(static_cast<int64_t>(i), all_values[i]);
+    }
+  }
+};
+
+TEST_F(HashPartitionerTest, InMemory)
+{
+  gdf_partitioner_type* partitioner = gdf_hash_partitioner(2, dtypes, columns_to_hash, 1, num_partitions,
+                                                           GDF_HASH_IDENTITY, 0, nullptr);
+  ASSERT_NE(nullptr, partitioner);
+  add_batches(partitioner);
+
+  size_t spilled_bytes{1};
+  EXPECT_EQ(GDF_SUCCESS, gdf_hash_partitioner_spilled_bytes(partitioner, &spilled_bytes));
+  EXPECT_EQ(0u, spilled_bytes);
+
+  take_and_verify(partitioner);
+  EXPECT_EQ(GDF_SUCCESS, gdf_hash_partitioner_free(partitioner));
+}
+
+TEST_F(HashPartitionerTest, Spill)
+{
+  // A budget smaller than a batch spills after every batch
+  gdf_partitioner_type* partitioner = gdf_hash_partitioner(2, dtypes, columns_to_hash, 1, num_partitions,
+                                                           GDF_HASH_IDENTITY, 1 << 14, "/tmp");
+  ASSERT_NE(nullptr, partitioner);
+  add_batches(partitioner);
+
+  size_t spilled_bytes{0};
+  EXPECT_EQ(GDF_SUCCESS, gdf_hash_partitioner_spilled_bytes(partitioner, &spilled_bytes));
+  EXPECT_GT(spilled_bytes, 0u);
+
+  take_and_verify(partitioner);
+
+  // The partitions can be reused once taken
+  add_batches(partitioner);
+  take_and_verify(partitioner);
+  EXPECT_EQ(GDF_SUCCESS, gdf_hash_partitioner_free(partitioner));
+}
+
+TEST_F(HashPartitionerTest, Errors)
+{
+  gdf_dtype string_dtypes[] = {GDF_INT32, GDF_STRING};
+  EXPECT_EQ(nullptr, gdf_hash_partitioner(2, string_dtypes, columns_to_hash, 1, num_partitions,
+                                          GDF_HASH_MURMUR3, 0, nullptr));
+  EXPECT_EQ(nullptr, gdf_hash_partitioner(2, dtypes, columns_to_hash, 1, 0,
+                                          GDF_HASH_MURMUR3, 0, nullptr));
+
+  gdf_partitioner_type* partitioner = gdf_hash_partitioner(2, dtypes, columns_to_hash, 1, num_partitions,
+                                                           GDF_HASH_MURMUR3, 0, nullptr);
+  ASSERT_NE(nullptr, partitioner);
+
+  gdf_col_pointer keys = create_gdf_column(std::vector<int32_t>{1, 2, 3});
+  keys->valid = nullptr;
+  gdf_col_pointer floats = create_gdf_column(std::vector<double>{1, 2, 3});
+  floats->valid = nullptr;
+  gdf_column* input[] = {keys.get(), floats.get()};
+  EXPECT_EQ(GDF_PARTITION_DTYPE_MISMATCH, gdf_hash_partitioner_add(partitioner, input));
+
+  gdf_col_pointer values = create_gdf_column(std::vector<int64_t>{1, 2});
+  values->valid = nullptr;
+  input[1] = values.get();
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH, gdf_hash_partitioner_add(partitioner, input));
+
+  gdf_size_type size{0};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_hash_partitioner_size(partitioner, num_partitions, &size));
+  EXPECT_EQ(GDF_SUCCESS, gdf_hash_partitioner_free(partitioner));
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+struct RangePartitionTest : public GdfTest {
+
+  std::vector<gdf_col_pointer> inputs;
+  std::vector<gdf_col_pointer> outputs;
+  std::vector<gdf_column*> input_ptrs;
+  std::vector<gdf_column*> output_ptrs;
+
+  template <typename T>
+  void add_column(std::vector<T> const& values,
+                  std::vector<gdf_valid_type> const& valid = std::vector<gdf_valid_type>())
+  {
+    inputs.push_back(create_gdf_column(values, valid));
+    outputs.push_back(create_gdf_column(std::vector<T>(values.size()),
+                                        std::vector<gdf_valid_type>(valid.size(), 0)));
+    if (valid.empty()) {
+      inputs.back()->valid = nullptr;
+      inputs.back()->null_count = 0;
+      outputs.back()->valid = nullptr;
+    }
+    input_ptrs.push_back(inputs.back().get());
+    output_ptrs.push_back(outputs.back().get());
+  }
+
+  gdf_error partition(std::vector<int8_t> const& asc_desc, int nulls_are_smallest,
+                      std::vector<gdf_size_type>& offsets)
+  {
+    rmm::device_vector<int8_t> d_asc_desc(asc_desc);
+    return gdf_range_partition(input_ptrs.size(), input_ptrs.data(), d_asc_desc.data().get(),
+                               nulls_are_smallest, offsets.size(), output_ptrs.data(), offsets.data());
+  }
+};
+
+TEST_F(RangePartitionTest, Ascending)
+{
+  const int num_rows = 100000;
+  std::vector<int32_t> keys(num_rows);
+  std::vector<int64_t> payload(num_rows);
+  std::srand(7);
+  for (int i = 0; i < num_rows; ++i) {
+    keys[i] = std::rand() % 1000000;
+    payload[i] = 2 * static_cast<int64_t>(keys[i]);
+  }
+  add_column(keys);
+  add_column(payload);
+
+  std::vector<gdf_size_type> offsets(8);
+  ASSERT_EQ(GDF_SUCCESS, partition({GDF_ORDER_ASC, GDF_ORDER_ASC}, 0, offsets));
+  offsets.push_back(num_rows);
+
+  const auto out_keys = to_host<int32_t>(outputs[0].get());
+  const auto out_payload = to_host<int64_t>(outputs[1].get());
+  EXPECT_EQ(0, offsets[0]);
+  int32_t previous_max{-1};
+  for (size_t p = 0; p + 1 < offsets.size(); ++p) {
+    ASSERT_LE(offsets[p], offsets[p + 1]);
+    // Sampling keeps the partitions near num_rows / 8
+    EXPECT_GT(offsets[p + 1] - offsets[p], num_rows / 32);
+    EXPECT_LT(offsets[p + 1] - offsets[p], num_rows / 2);
+    const auto begin = out_keys.begin() + offsets[p];
+    const auto end = out_keys.begin() + offsets[p + 1];
+    EXPECT_LT(previous_max, *std::min_element(begin, end));
+    previous_max = *std::max_element(begin, end);
+  }
+  for (int i = 0; i < num_rows; ++i) {
+    EXPECT_EQ(2 * static_cast<int64_t>(out_keys[i]), out_payload[i]);
+  }
+
+  std::sort(keys.begin(), keys.end());
+  auto sorted_out_keys = out_keys;
+  std::sort(sorted_out_keys.begin(), sorted_out_keys.end());
+  EXPECT_EQ(keys, sorted_out_keys);
+}
+
+TEST_F(RangePartitionTest, DescendingWithNulls)
+{
+  // The first column has a few values and nulls, the second breaks the ties
+  const int num_rows = 20000;
+  std::vector<int16_t> a(num_rows);
+  std::vector<double> b(num_rows);
+  for (int i = 0; i < num_rows; ++i) {
+    a[i] = i % 5;
+    b[i] = (i * 7919) % num_rows;
+  }
+  add_column(a, make_valid(num_rows, [](int i) { return i % 11 != 0; }));
+  add_column(b);
+
+  std::vector<gdf_size_type> offsets(6);
+  ASSERT_EQ(GDF_SUCCESS, partition({GDF_ORDER_DESC, GDF_ORDER_ASC}, 1, offsets));
+  offsets.push_back(num_rows);
+
+  const auto out_a = to_host<int16_t>(outputs[0].get());
+  const auto out_b = to_host<double>(outputs[1].get());
+  const auto out_valid = valid_to_host(outputs[0].get());
+  EXPECT_EQ(inputs[0]->null_count, outputs[0]->null_count);
+
+  // Nulls are smallest, so they go last in a descending column
+  auto before = [&](int i, int j) {
+    if (out_valid[i] != out_valid[j]) return bool(out_valid[i]);
+    if (out_valid[i] && out_a[i] != out_a[j]) return out_a[i] > out_a[j];
+    return out_b[i] < out_b[j];
+  };
+  for (size_t p = 0; p + 2 < offsets.size(); ++p) {
+    for (gdf_size_type i = offsets[p]; i < offsets[p + 1]; ++i) {
+      for (gdf_size_type j = offsets[p + 1]; j < offsets[p + 2]; j += 97) {
+        ASSERT_TRUE(before(i, j)) << "partitions " << p << " and " << p + 1;
+      }
+    }
+  }
+}
+
+TEST_F(RangePartitionTest, EqualRows)
+{
+  add_column(std::vector<int64_t>(1000, 42));
+
+  std::vector<gdf_size_type> offsets(4);
+  ASSERT_EQ(GDF_SUCCESS, partition({GDF_ORDER_ASC}, 0, offsets));
+
+  // Equal rows share a partition, the others are empty
+  EXPECT_EQ(0, offsets[0]);
+  for (size_t p = 1; p < offsets.size(); ++p) {
+    EXPECT_TRUE(0 == offsets[p] || 1000 == offsets[p]);
+  }
+}
+
+TEST_F(RangePartitionTest, Errors)
+{
+  add_column(std::vector<int32_t>{3, 1, 2});
+
+  std::vector<gdf_size_type> offsets(2);
+  std::vector<gdf_size_type> no_offsets;
+  EXPECT_EQ(GDF_INVALID_API_CALL, partition({GDF_ORDER_ASC}, 0, no_offsets));
+
+  outputs[0]->dtype = GDF_INT64;
+  EXPECT_EQ(GDF_PARTITION_DTYPE_MISMATCH, partition({GDF_ORDER_ASC}, 0, offsets));
+  outputs[0]->dtype = GDF_INT32;
+
+  outputs[0]->size = 2;
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH, partition({GDF_ORDER_ASC}, 0, offsets));
+  outputs[0]->size = 3;
+
+  inputs[0]->dtype = GDF_STRING;
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE, partition({GDF_ORDER_ASC}, 0, offsets));
+  inputs[0]->dtype = GDF_INT32;
+}
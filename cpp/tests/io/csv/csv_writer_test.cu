@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <NVStrings.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+struct CsvWriterTest : public GdfTest {
+
+  std::vector<gdf_col_pointer> columns;
+  std::vector<gdf_column*> column_ptrs;
+
+  template <typename T>
+  gdf_column* add_column(const char* name, std::vector<T> const& values,
+                         std::vector<gdf_valid_type> const& valid = std::vector<gdf_valid_type>())
+  {
+    columns.push_back(create_gdf_column(values, valid));
+    columns.back()->col_name = const_cast<char*>(name);
+    column_ptrs.push_back(columns.back().get());
+    return columns.back().get();
+  }
+
+  std::string write(csv_write_arg& args)
+  {
+    EXPECT_EQ(GDF_SUCCESS, write_csv(column_ptrs.data(), column_ptrs.size(), &args));
+    std::ifstream file(args.filepath, std::ios::binary);
+    std::string text{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    EXPECT_EQ(text.size(), args.bytes_written);
+    return text;
+  }
+};
+
+TEST_F(CsvWriterTest, Numbers)
+{
+  add_column("i", std::vector<int32_t>{1, -20, 300});
+  add_column("f", std::vector<double>{0.1, 1e20, -2.5});
+  add_column("g", std::vector<float>{0.3f, 16777216.f, 1.5e-7f});
+  add_column("n", std::vector<int64_t>{7, 0, -9223372036854775807LL}, {0x5});
+
+  csv_write_arg args{};
+  args.filepath = "/tmp/CsvWriterNumbers.csv";
+  args.header = true;
+  args.na_rep = "NA";
+  EXPECT_EQ("i,f,g,n\n"
+            "1,0.1,0.3,7\n"
+            "-20,1e+20,16777216.0,NA\n"
+            "300,-2.5,1.5e-07,-9223372036854775807\n", write(args));
+
+  args.header = false;
+  args.delimiter = '|';
+  args.line_terminator = "\r\n";
+  args.na_rep = nullptr;
+  EXPECT_EQ("1|0.1|0.3|7\r\n"
+            "-20|1e+20|16777216.0|\r\n"
+            "300|-2.5|1.5e-07|-9223372036854775807\r\n", write(args));
+}
+
+TEST_F(CsvWriterTest, NaN)
+{
+  // NaN is written like a null, infinities are not
+  add_column("f", std::vector<double>{std::numeric_limits<double>::quiet_NaN(), 1.0,
+                                      -std::numeric_limits<double>::infinity()});
+  add_column("g", std::vector<float>{2.f, std::numeric_limits<float>::quiet_NaN(), 0.f}, {0x6});
+
+  csv_write_arg args{};
+  args.filepath = "/tmp/CsvWriterNaN.csv";
+  args.header = false;
+  args.na_rep = "NA";
+  EXPECT_EQ("NA,NA\n"
+            "1.0,NA\n"
+            "-inf,0.0\n", write(args));
+}
+
+TEST_F(CsvWriterTest, DatesAndStrings)
+{
+  add_column("day", std::vector<int32_t>{17941, -1})->dtype = GDF_DATE32;
+  add_column("ms", std::vector<int64_t>{1550102400123LL, 0})->dtype = GDF_DATE64;
+  gdf_column* ns = add_column("ns", std::vector<int64_t>{1550102400000000001LL, -1});
+  ns->dtype = GDF_TIMESTAMP;
+  ns->dtype_info.time_unit = TIME_UNIT_ns;
+
+  const char* strings[] = {"plain", "a, \"quoted\" one"};
+  gdf_column* str = add_column("s,t", std::vector<int32_t>{0, 0});
+  RMM_FREE(str->data, 0);
+  str->data = NVStrings::create_from_array(strings, 2);
+  str->dtype = GDF_STRING;
+
+  csv_write_arg args{};
+  args.filepath = "/tmp/CsvWriterDatesAndStrings.csv";
+  args.header = true;
+  const std::string text = write(args);
+  NVStrings::destroy(static_cast<NVStrings*>(str->data));
+  str->data = nullptr;
+
+  EXPECT_EQ("day,ms,ns,\"s,t\"\n"
+            "2019-02-14,2019-02-14T00:00:00.123,2019-02-14T00:00:00.000000001,plain\n"
+            "1969-12-31,1970-01-01T00:00:00,1969-12-31T23:59:59.999999999,\"a, \"\"quoted\"\" one\"\n",
+            text);
+}
+
+TEST_F(CsvWriterTest, GzipRoundTrip)
+{
+  std::vector<int64_t> values(100000);
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = static_cast<int64_t>(i) * 37 - 1000;
+  }
+  add_column("v", values);
+
+  csv_write_arg args{};
+  args.filepath = "/tmp/CsvWriterGzip.csv.gz";
+  args.header = true;
+  args.compression = "infer";
+  ASSERT_EQ(GDF_SUCCESS, write_csv(column_ptrs.data(), column_ptrs.size(), &args));
+
+  const char* names[] = {"v"};
+  const char* types[] = {"int64"};
+  csv_read_arg read_args{};
+  read_args.input_data_form = gdf_csv_input_form::FILE_PATH;
+  read_args.filepath_or_buffer = args.filepath;
+  read_args.num_cols = 1;
+  read_args.names = names;
+  read_args.dtype = types;
+  read_args.delimiter = ',';
+  read_args.lineterminator = '\n';
+  read_args.header = 0;
+  read_args.nrows = -1;
+  read_args.compression = const_cast<char*>("gzip");
+  ASSERT_EQ(GDF_SUCCESS, read_csv(&read_args));
+  ASSERT_EQ(1, read_args.num_cols_out);
+  ASSERT_EQ(static_cast<gdf_size_type>(values.size()), read_args.num_rows_out);
+
+  EXPECT_EQ(values, to_host<int64_t>(read_args.data[0]));
+}
+
+TEST_F(CsvWriterTest, Errors)
+{
+  add_column("a", std::vector<int32_t>{1, 2});
+  add_column("b", std::vector<int32_t>{1});
+
+  csv_write_arg args{};
+  args.filepath = "/tmp/CsvWriterErrors.csv";
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH, write_csv(column_ptrs.data(), column_ptrs.size(), &args));
+  EXPECT_EQ(GDF_INVALID_API_CALL, write_csv(column_ptrs.data(), 0, &args));
+
+  args.compression = "bz2";
+  EXPECT_EQ(GDF_INVALID_API_CALL, write_csv(column_ptrs.data(), 1, &args));
+
+  args.compression = nullptr;
+  args.filepath = "/tmp/CsvWriterDoesNotExist/out.csv";
+  EXPECT_EQ(GDF_FILE_ERROR, write_csv(column_ptrs.data(), 1, &args));
+}
@@ -0,0 +1,467 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include <arrow/api.h>
+#include <arrow/io/api.h>
+#include <arrow/ipc/api.h>
+
+#include <cudf.h>
+#include <NVStrings.h>
+#include <utilities/cudf_utils.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+#include <rmm/rmm.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+
+struct IpcReaderTest : public GdfTest {
+
+  // Alternating valid and null values, every third one null
+  static std::shared_ptr<arrow::Array> int32_array(int32_t first, int32_t size)
+  {
+    arrow::Int32Builder builder;
+    for (int32_t i = 0; i < size; ++i) {
+      if (i % 3 == 1) {
+        builder.AppendNull();
+      } else {
+        builder.Append(first + i);
+      }
+    }
+    std::shared_ptr<arrow::Array> array;
+    builder.Finish(&array);
+    return array;
+  }
+
+  static std::shared_ptr<arrow::Array> double_array(int32_t first, int32_t size)
+  {
+    arrow::DoubleBuilder builder;
+    for (int32_t i = 0; i < size; ++i) {
+      builder.Append((first + i) * 0.5);
+    }
+    std::shared_ptr<arrow::Array> array;
+    builder.Finish(&array);
+    return array;
+  }
+
+  static std::shared_ptr<arrow::Array> bool_array(int32_t first, int32_t size)
+  {
+    arrow::BooleanBuilder builder;
+    for (int32_t i = 0; i < size; ++i) {
+      builder.Append((first + i) % 5 < 2);
+    }
+    std::shared_ptr<arrow::Array> array;
+    builder.Finish(&array);
+    return array;
+  }
+
+  // Writes the batches as an IPC stream, or an IPC file
+  static std::shared_ptr<arrow::Buffer> write(std::shared_ptr<arrow::Schema> const& schema,
+                                              std::vector<std::shared_ptr<arrow::RecordBatch>> const& batches,
+                                              bool as_file)
+  {
+    std::shared_ptr<arrow::io::BufferOutputStream> sink;
+    EXPECT_TRUE(arrow::io::BufferOutputStream::Create(1024, arrow::default_memory_pool(), &sink).ok());
+    std::shared_ptr<arrow::ipc::RecordBatchWriter> writer;
+    if (as_file) {
+      EXPECT_TRUE(arrow::ipc::RecordBatchFileWriter::Open(sink.get(), schema, &writer).ok());
+    } else {
+      EXPECT_TRUE(arrow::ipc::RecordBatchStreamWriter::Open(sink.get(), schema, &writer).ok());
+    }
+    for (auto const& batch : batches) {
+      EXPECT_TRUE(writer->WriteRecordBatch(*batch).ok());
+    }
+    EXPECT_TRUE(writer->Close().ok());
+    std::shared_ptr<arrow::Buffer> buffer;
+    EXPECT_TRUE(sink->Finish(&buffer).ok());
+    return buffer;
+  }
+
+  // Copies the buffer to the device, shifted by offset bytes
+  static rmm::device_vector<uint8_t> to_device(std::shared_ptr<arrow::Buffer> const& buffer, size_t offset)
+  {
+    std::vector<uint8_t> host(offset, 0);
+    host.insert(host.end(), buffer->data(), buffer->data() + buffer->size());
+    return rmm::device_vector<uint8_t>(host);
+  }
+
+  // Frees what read_ipc allocated, the views point into the input
+  static void free_columns(ipc_read_arg& args)
+  {
+    for (int i = 0; i < args.num_cols_out; ++i) {
+      for (gdf_column* column : {args.data[i], args.dictionaries[i]}) {
+        if (nullptr == column) continue;
+        if (column != args.data[i] || !args.is_view[i]) {
+          if (GDF_STRING == column->dtype) {
+            NVStrings::destroy(static_cast<NVStrings*>(column->data));
+          } else {
+            RMM_FREE(column->data, 0);
+          }
+          RMM_FREE(column->valid, 0);
+        }
+        free(column->col_name);
+        free(column);
+      }
+    }
+    free(args.data);
+    free(args.dictionaries);
+    free(args.is_view);
+  }
+
+  // Reads the batches of int32, double and bool columns and checks the
+  // concatenated columns
+  void check_numbers(std::vector<int32_t> const& batch_sizes, bool as_file, size_t offset)
+  {
+    auto schema = arrow::schema({arrow::field("ints", arrow::int32()),
+                                 arrow::field("doubles", arrow::float64()),
+                                 arrow::field("bools", arrow::boolean())});
+    std::vector<std::shared_ptr<arrow::RecordBatch>> batches;
+    std::vector<int32_t> expected_ints;
+    std::vector<double> expected_doubles;
+    std::vector<int8_t> expected_bools;
+    std::vector<bool> expected_valid;
+    int32_t first{0};
+    for (int32_t size : batch_sizes) {
+      batches.push_back(arrow::RecordBatch::Make(schema, size, {int32_array(first, size),
+                                                                double_array(first, size),
+                                                                bool_array(first, size)}));
+      for (int32_t i = 0; i < size; ++i) {
+        expected_valid.push_back(i % 3 != 1);
+        expected_ints.push_back(expected_valid.back() ? first + i : 0);
+        expected_doubles.push_back((first + i) * 0.5);
+        expected_bools.push_back((first + i) % 5 < 2);
+      }
+      first += size;
+    }
+
+    auto d_buffer = to_device(write(schema, batches, as_file), offset);
+    ipc_read_arg args{};
+    args.buffer = d_buffer.data().get() + offset;
+    args.buffer_size = d_buffer.size() - offset;
+    args.zero_copy = true;
+    ASSERT_EQ(GDF_SUCCESS, read_ipc(&args));
+
+    ASSERT_EQ(3, args.num_cols_out);
+    ASSERT_EQ(first, args.num_rows_out);
+    EXPECT_STREQ("ints", args.data[0]->col_name);
+    EXPECT_EQ(GDF_INT32, args.data[0]->dtype);
+    EXPECT_EQ(GDF_FLOAT64, args.data[1]->dtype);
+    EXPECT_EQ(GDF_INT8, args.data[2]->dtype);
+
+    // Only the columns of a single aligned batch can be views
+    bool const views = (1 == batch_sizes.size()) && (0 == offset % 8);
+    EXPECT_EQ(views, args.is_view[0]);
+    EXPECT_EQ(views, args.is_view[1]);
+    EXPECT_FALSE(args.is_view[2]);
+
+    std::vector<int32_t> ints = to_host<int32_t>(args.data[0]);
+    std::vector<bool> valid = valid_to_host(args.data[0]);
+    for (size_t i = 0; i < ints.size(); ++i) {
+      if (!valid[i]) ints[i] = 0;
+    }
+    EXPECT_EQ(expected_ints, ints);
+    EXPECT_EQ(expected_valid, valid);
+    EXPECT_EQ(std::count(expected_valid.begin(), expected_valid.end(), false), args.data[0]->null_count);
+    EXPECT_EQ(expected_doubles, to_host<double>(args.data[1]));
+    EXPECT_EQ(0, args.data[1]->null_count);
+    EXPECT_EQ(expected_bools, to_host<int8_t>(args.data[2]));
+
+    free_columns(args);
+  }
+};
+
+TEST_F(IpcReaderTest, SingleBatchViews)
+{
+  check_numbers({1000}, false, 0);
+}
+
+TEST_F(IpcReaderTest, MisalignedBufferIsCopied)
+{
+  check_numbers({1000}, false, 1);
+}
+
+TEST_F(IpcReaderTest, MultipleBatches)
+{
+  check_numbers({5, 13, 0, 100, 7}, false, 0);
+}
+
+TEST_F(IpcReaderTest, FileFormat)
+{
+  check_numbers({30, 40}, true, 0);
+}
+
+TEST_F(IpcReaderTest, TimestampsAndDictionaries)
+{
+  arrow::TimestampBuilder time_builder(arrow::timestamp(arrow::TimeUnit::MICRO), arrow::default_memory_pool());
+  std::vector<int64_t> times{-5, 0, 1000000, 1234567};
+  for (auto t : times) {
+    time_builder.Append(t);
+  }
+  std::shared_ptr<arrow::Array> time_array;
+  time_builder.Finish(&time_array);
+
+  arrow::StringBuilder string_builder;
+  for (auto s : {"red", "green", "", "blue"}) {
+    string_builder.Append(s);
+  }
+  std::shared_ptr<arrow::Array> string_dictionary;
+  string_builder.Finish(&string_dictionary);
+
+  arrow::Int8Builder index_builder;
+  std::vector<int8_t> indices{3, 0, 2, 1};
+  for (auto i : indices) {
+    index_builder.Append(i);
+  }
+  std::shared_ptr<arrow::Array> index_array;
+  index_builder.Finish(&index_array);
+
+  auto dictionary_type = arrow::dictionary(arrow::int8(), string_dictionary);
+  auto colors = std::make_shared<arrow::DictionaryArray>(dictionary_type, index_array);
+
+  auto schema = arrow::schema({arrow::field("times", time_array->type()),
+                               arrow::field("colors", dictionary_type)});
+  auto batch = arrow::RecordBatch::Make(schema, 4, {time_array, colors});
+
+  auto d_buffer = to_device(write(schema, {batch}, false), 0);
+  ipc_read_arg args{};
+  args.buffer = d_buffer.data().get();
+  args.buffer_size = d_buffer.size();
+  args.zero_copy = true;
+  ASSERT_EQ(GDF_SUCCESS, read_ipc(&args));
+  ASSERT_EQ(2, args.num_cols_out);
+
+  EXPECT_EQ(GDF_TIMESTAMP, args.data[0]->dtype);
+  EXPECT_EQ(TIME_UNIT_us, args.data[0]->dtype_info.time_unit);
+  EXPECT_EQ(times, to_host<int64_t>(args.data[0]));
+  EXPECT_EQ(nullptr, args.dictionaries[0]);
+
+  // The int8 indices are widened to int32 codes
+  EXPECT_EQ(GDF_CATEGORY, args.data[1]->dtype);
+  EXPECT_FALSE(args.is_view[1]);
+  EXPECT_EQ((std::vector<int32_t>{3, 0, 2, 1}), to_host<int32_t>(args.data[1]));
+
+  gdf_column const* dictionary = args.dictionaries[1];
+  ASSERT_NE(nullptr, dictionary);
+  ASSERT_EQ(GDF_STRING, dictionary->dtype);
+  auto strings = static_cast<NVStrings*>(dictionary->data);
+  ASSERT_EQ(4u, strings->size());
+
+  std::vector<int> lengths(4);
+  strings->len(lengths.data(), false);
+  EXPECT_EQ((std::vector<int>{3, 5, 0, 4}), lengths);
+  std::vector<std::vector<char>> host(4);
+  std::vector<char*> host_ptrs;
+  for (size_t i = 0; i < host.size(); ++i) {
+    host[i].resize(lengths[i] + 1);
+    host_ptrs.push_back(host[i].data());
+  }
+  strings->to_host(host_ptrs.data(), 0, 4);
+  EXPECT_STREQ("red", host_ptrs[0]);
+  EXPECT_STREQ("green", host_ptrs[1]);
+  EXPECT_STREQ("", host_ptrs[2]);
+  EXPECT_STREQ("blue", host_ptrs[3]);
+
+  free_columns(args);
+}
+
+TEST_F(IpcReaderTest, MalformedInput)
+{
+  std::vector<uint8_t> garbage(64, 0xab);
+  rmm::device_vector<uint8_t> d_garbage(garbage);
+  ipc_read_arg args{};
+  args.buffer = d_garbage.data().get();
+  args.buffer_size = d_garbage.size();
+  EXPECT_EQ(GDF_FILE_ERROR, read_ipc(&args));
+
+  auto schema = arrow::schema({arrow::field("lists", arrow::list(arrow::int32()))});
+  arrow::ListBuilder builder(arrow::default_memory_pool(), std::make_shared<arrow::Int32Builder>());
+  builder.Append();
+  std::shared_ptr<arrow::Array> lists;
+  builder.Finish(&lists);
+  auto d_buffer = to_device(write(schema, {arrow::RecordBatch::Make(schema, 1, {lists})}, false), 0);
+  args.buffer = d_buffer.data().get();
+  args.buffer_size = d_buffer.size();
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE, read_ipc(&args));
+}
+
+
+struct IpcWriterTest : public IpcReaderTest {
+
+  std::vector<int32_t> ints;
+  std::vector<gdf_valid_type> int_valid;
+  std::vector<double> doubles;
+  std::vector<int64_t> times;
+  std::vector<gdf_col_pointer> columns;
+  std::vector<gdf_column*> column_ptrs;
+
+  void make_columns(size_t size)
+  {
+    for (size_t i = 0; i < size; ++i) {
+      ints.push_back(static_cast<int32_t>(i * 7));
+      doubles.push_back(i * 0.25);
+      times.push_back(static_cast<int64_t>(i) * 1000000007);
+    }
+    int_valid = make_valid(size, [](int i) { return i % 4 != 2; });
+    columns.push_back(create_gdf_column(ints, int_valid));
+    columns.push_back(create_gdf_column(doubles));
+    columns.push_back(create_gdf_column(times));
+    columns[2]->dtype = GDF_TIMESTAMP;
+    columns[2]->dtype_info.time_unit = TIME_UNIT_ns;
+
+    char const* names[] = {"ints", "doubles", "times"};
+    for (size_t c = 0; c < columns.size(); ++c) {
+      columns[c]->col_name = const_cast<char*>(names[c]);
+      column_ptrs.push_back(columns[c].get());
+    }
+  }
+
+  rmm::device_vector<uint8_t> write_to_device()
+  {
+    gdf_ipc_sink sink{};
+    sink.sink_form = IPC_DEVICE_BUFFER;
+    EXPECT_EQ(GDF_SUCCESS, gdf_to_arrow_ipc(column_ptrs.data(), column_ptrs.size(), &sink));
+
+    rmm::device_vector<uint8_t> d_stream(sink.bytes_written);
+    sink.buffer = d_stream.data().get();
+    sink.buffer_size = d_stream.size();
+    EXPECT_EQ(GDF_SUCCESS, gdf_to_arrow_ipc(column_ptrs.data(), column_ptrs.size(), &sink));
+    EXPECT_EQ(d_stream.size(), sink.bytes_written);
+    return d_stream;
+  }
+};
+
+TEST_F(IpcWriterTest, RoundTrip)
+{
+  make_columns(1001);
+  auto d_stream = write_to_device();
+
+  ipc_read_arg args{};
+  args.buffer = d_stream.data().get();
+  args.buffer_size = d_stream.size();
+  args.zero_copy = true;
+  ASSERT_EQ(GDF_SUCCESS, read_ipc(&args));
+  ASSERT_EQ(3, args.num_cols_out);
+  ASSERT_EQ(1001, args.num_rows_out);
+
+  EXPECT_STREQ("ints", args.data[0]->col_name);
+  EXPECT_EQ(GDF_INT32, args.data[0]->dtype);
+  EXPECT_EQ(columns[0]->null_count, args.data[0]->null_count);
+  std::vector<bool> expected_valid;
+  for (size_t i = 0; i < ints.size(); ++i) {
+    expected_valid.push_back(gdf_is_valid(int_valid.data(), i));
+  }
+  EXPECT_EQ(expected_valid, valid_to_host(args.data[0]));
+  EXPECT_EQ(ints, to_host<int32_t>(args.data[0]));
+  EXPECT_EQ(doubles, to_host<double>(args.data[1]));
+  EXPECT_EQ(GDF_TIMESTAMP, args.data[2]->dtype);
+  EXPECT_EQ(TIME_UNIT_ns, args.data[2]->dtype_info.time_unit);
+  EXPECT_EQ(times, to_host<int64_t>(args.data[2]));
+
+  free_columns(args);
+}
+
+// Arrow itself reads the stream
+TEST_F(IpcWriterTest, ReadByArrow)
+{
+  make_columns(100);
+  auto d_stream = write_to_device();
+  std::vector<uint8_t> stream(d_stream.size());
+  thrust::copy(d_stream.begin(), d_stream.end(), stream.begin());
+
+  auto buffer = std::make_shared<arrow::Buffer>(stream.data(), stream.size());
+  auto input = std::make_shared<arrow::io::BufferReader>(buffer);
+  std::shared_ptr<arrow::ipc::RecordBatchReader> reader;
+  ASSERT_TRUE(arrow::ipc::RecordBatchStreamReader::Open(input, &reader).ok());
+  std::shared_ptr<arrow::RecordBatch> batch;
+  ASSERT_TRUE(reader->ReadNext(&batch).ok());
+  ASSERT_NE(nullptr, batch);
+
+  ASSERT_EQ(3, batch->num_columns());
+  EXPECT_EQ("ints", batch->column_name(0));
+  auto int_array = std::static_pointer_cast<arrow::Int32Array>(batch->column(0));
+  auto double_array = std::static_pointer_cast<arrow::DoubleArray>(batch->column(1));
+  EXPECT_EQ(columns[0]->null_count, int_array->null_count());
+  for (int64_t i = 0; i < batch->num_rows(); ++i) {
+    EXPECT_EQ(gdf_is_valid(int_valid.data(), i), int_array->IsValid(i));
+    if (int_array->IsValid(i)) {
+      EXPECT_EQ(ints[i], int_array->Value(i));
+    }
+    EXPECT_EQ(doubles[i], double_array->Value(i));
+  }
+
+  ASSERT_TRUE(reader->ReadNext(&batch).ok());
+  EXPECT_EQ(nullptr, batch);
+}
+
+// The file descriptor gets the same bytes as the device buffer
+TEST_F(IpcWriterTest, FileDescriptor)
+{
+  make_columns(5000);
+  auto d_stream = write_to_device();
+  std::vector<uint8_t> expected(d_stream.size());
+  thrust::copy(d_stream.begin(), d_stream.end(), expected.begin());
+
+  char fname[] = "/tmp/IpcWriterTestXXXXXX";
+  int const fd = mkstemp(fname);
+  ASSERT_GE(fd, 0);
+  gdf_ipc_sink sink{};
+  sink.sink_form = IPC_FILE_DESCRIPTOR;
+  sink.fd = fd;
+  EXPECT_EQ(GDF_SUCCESS, gdf_to_arrow_ipc(column_ptrs.data(), column_ptrs.size(), &sink));
+  EXPECT_EQ(expected.size(), sink.bytes_written);
+
+  std::vector<uint8_t> written(expected.size() + 1);
+  ASSERT_EQ(0, lseek(fd, 0, SEEK_SET));
+  EXPECT_EQ(static_cast<ssize_t>(expected.size()), read(fd, written.data(), written.size()));
+  written.resize(expected.size());
+  EXPECT_EQ(expected, written);
+  close(fd);
+  unlink(fname);
+}
+
+TEST_F(IpcWriterTest, Errors)
+{
+  make_columns(10);
+  gdf_ipc_sink sink{};
+  sink.sink_form = IPC_DEVICE_BUFFER;
+  rmm::device_vector<uint8_t> d_small(16);
+  sink.buffer = d_small.data().get();
+  sink.buffer_size = d_small.size();
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_to_arrow_ipc(column_ptrs.data(), column_ptrs.size(), &sink));
+
+  std::vector<int32_t> short_data(5, 1);
+  auto short_column = create_gdf_column(short_data);
+  short_column->col_name = nullptr;
+  gdf_column* mismatched[] = {columns[0].get(), short_column.get()};
+  sink.buffer = nullptr;
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH, gdf_to_arrow_ipc(mismatched, 2, &sink));
+
+  columns[1]->dtype = GDF_STRING;
+  EXPECT_EQ(GDF_UNSUPPORTED_DTYPE, gdf_to_arrow_ipc(column_ptrs.data(), column_ptrs.size(), &sink));
+  columns[1]->dtype = GDF_FLOAT64;
+}
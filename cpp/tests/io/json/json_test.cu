@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+#include <cudf.h>
+#include <NVStrings.h>
+
+#include "utilities/cudf_utils.h"
+
+#include "tests/utilities/cudf_test_utils.cuh"
+
+bool checkFile(const char *fname)
+{
+	struct stat st;
+	return (stat(fname, &st) ? 0 : 1);
+}
+
+std::vector<std::string> strings_to_host(gdf_column* const col)
+{
+	auto stringList = reinterpret_cast<NVStrings*>(col->data);
+	const auto stringCount = stringList->size();
+	auto stringLengths = std::unique_ptr<int[]>{ new int[stringCount] };
+	stringList->len(stringLengths.get(), false);
+
+	std::vector<std::unique_ptr<char[]>> buffers(stringCount);
+	auto strings = std::unique_ptr<char*[]>{ new char*[stringCount] };
+	for (size_t i = 0; i < stringCount; ++i) {
+		buffers[i].reset(new char[std::max(stringLengths[i], 0) + 1]());
+		strings[i] = buffers[i].get();
+	}
+	stringList->to_host(strings.get(), 0, stringCount);
+	return std::vector<std::string>(strings.get(), strings.get() + stringCount);
+}
+
+json_read_arg buffer_args(std::string const& data)
+{
+	json_read_arg args{};
+	args.input_data_form = gdf_csv_input_form::HOST_BUFFER;
+	args.filepath_or_buffer = data.c_str();
+	args.buffer_size = data.size();
+	args.lines = true;
+	return args;
+}
+
+TEST(gdf_json_test, InferTypes)
+{
+	const std::string data =
+		"{\"id\": 1, \"score\": 0.5, \"name\": \"a\", \"flag\": true}\n"
+		"{\"id\": 2, \"score\": 2, \"name\": \"b\", \"flag\": false}\n"
+		"{\"id\": -3, \"score\": 1e2, \"name\": \"c\", \"flag\": true}\n";
+
+	json_read_arg args = buffer_args(data);
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+	ASSERT_EQ( args.num_cols_out, 4 );
+	ASSERT_EQ( args.num_rows_out, 3 );
+	EXPECT_STREQ( args.data[0]->col_name, "id" );
+	EXPECT_STREQ( args.data[1]->col_name, "score" );
+	EXPECT_STREQ( args.data[2]->col_name, "name" );
+	EXPECT_STREQ( args.data[3]->col_name, "flag" );
+
+	ASSERT_EQ( args.data[0]->dtype, GDF_INT64 );
+	ASSERT_EQ( args.data[1]->dtype, GDF_FLOAT64 );
+	ASSERT_EQ( args.data[2]->dtype, GDF_STRING );
+	ASSERT_EQ( args.data[3]->dtype, GDF_INT8 );
+
+	EXPECT_THAT( to_host<int64_t>(args.data[0]), ::testing::ElementsAre(1, 2, -3) );
+	EXPECT_THAT( to_host<double>(args.data[1]), ::testing::ElementsAre(0.5, 2.0, 100.0) );
+	EXPECT_THAT( strings_to_host(args.data[2]), ::testing::ElementsAre("a", "b", "c") );
+	EXPECT_THAT( to_host<int8_t>(args.data[3]), ::testing::ElementsAre(1, 0, 1) );
+	for (int col = 0; col < args.num_cols_out; ++col) {
+		EXPECT_EQ( args.data[col]->null_count, 0 );
+	}
+}
+
+TEST(gdf_json_test, NullsAndMissingKeys)
+{
+	// The keys of the first record are the columns, in any order afterwards
+	const std::string data =
+		"{\"a\": 10, \"b\": \"x\"}\n"
+		"\n"
+		"{\"b\": null, \"a\": 20, \"c\": 5}\n"
+		"{\"b\": \"z\"}";
+
+	json_read_arg args = buffer_args(data);
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+	ASSERT_EQ( args.num_cols_out, 2 );
+	ASSERT_EQ( args.num_rows_out, 3 );
+
+	// Integers with nulls are read as floats
+	ASSERT_EQ( args.data[0]->dtype, GDF_FLOAT64 );
+	EXPECT_EQ( args.data[0]->null_count, 1 );
+	EXPECT_THAT( valid_to_host(args.data[0]), ::testing::ElementsAre(true, true, false) );
+	const auto a = to_host<double>(args.data[0]);
+	EXPECT_EQ( a[0], 10.0 );
+	EXPECT_EQ( a[1], 20.0 );
+
+	ASSERT_EQ( args.data[1]->dtype, GDF_STRING );
+	EXPECT_EQ( args.data[1]->null_count, 1 );
+	EXPECT_THAT( valid_to_host(args.data[1]), ::testing::ElementsAre(true, false, true) );
+}
+
+TEST(gdf_json_test, DuplicateKeys)
+{
+	// The last value of a repeated key is read, the row counts once
+	const std::string data =
+		"{\"a\": 1, \"b\": 2}\n"
+		"{\"a\": 3, \"b\": null, \"a\": 4}\n"
+		"{\"a\": 5, \"b\": 6}\n";
+
+	json_read_arg args = buffer_args(data);
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+	ASSERT_EQ( args.num_cols_out, 2 );
+	ASSERT_EQ( args.data[0]->dtype, GDF_INT64 );
+	EXPECT_EQ( args.data[0]->null_count, 0 );
+	EXPECT_THAT( to_host<int64_t>(args.data[0]), ::testing::ElementsAre(1, 4, 5) );
+	EXPECT_EQ( args.data[1]->null_count, 1 );
+	EXPECT_THAT( valid_to_host(args.data[1]), ::testing::ElementsAre(true, false, true) );
+}
+
+TEST(gdf_json_test, Strings)
+{
+	// Escapes are kept as they are written, nested values are read as strings
+	const std::string data =
+		"{\"s\": \"a, b\", \"n\": {\"x\": [1, 2]}}\n"
+		"{\"s\": \"say \\\"hi\\\"\", \"n\": [\"}\"]}\n";
+
+	json_read_arg args = buffer_args(data);
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+	ASSERT_EQ( args.num_cols_out, 2 );
+	ASSERT_EQ( args.data[0]->dtype, GDF_STRING );
+	ASSERT_EQ( args.data[1]->dtype, GDF_STRING );
+	EXPECT_THAT( strings_to_host(args.data[0]), ::testing::ElementsAre("a, b", "say \\\"hi\\\"") );
+	EXPECT_THAT( strings_to_host(args.data[1]), ::testing::ElementsAre("{\"x\": [1, 2]}", "[\"}\"]") );
+}
+
+TEST(gdf_json_test, Dtypes)
+{
+	const std::string data =
+		"{\"id\": 1, \"day\": \"2019-02-14\", \"value\": 3}\n"
+		"{\"id\": 2, \"day\": \"2019-02-15\", \"value\": 4}\n";
+
+	{
+		const char* types[] = { "value:float32", "day:date32" };
+		json_read_arg args = buffer_args(data);
+		args.num_cols = std::extent<decltype(types)>::value;
+		args.dtype = types;
+		EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+		ASSERT_EQ( args.num_cols_out, 3 );
+		ASSERT_EQ( args.data[0]->dtype, GDF_INT64 );
+		ASSERT_EQ( args.data[1]->dtype, GDF_DATE32 );
+		ASSERT_EQ( args.data[2]->dtype, GDF_FLOAT32 );
+		EXPECT_THAT( to_host<int32_t>(args.data[1]), ::testing::ElementsAre(17941, 17942) );
+		EXPECT_THAT( to_host<float>(args.data[2]), ::testing::ElementsAre(3.f, 4.f) );
+	}
+	{
+		const char* types[] = { "int32", "str" };
+		json_read_arg args = buffer_args(data);
+		args.num_cols = std::extent<decltype(types)>::value;
+		args.dtype = types;
+		EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+		ASSERT_EQ( args.data[0]->dtype, GDF_INT32 );
+		ASSERT_EQ( args.data[1]->dtype, GDF_STRING );
+		ASSERT_EQ( args.data[2]->dtype, GDF_INT64 );
+		EXPECT_THAT( to_host<int32_t>(args.data[0]), ::testing::ElementsAre(1, 2) );
+		EXPECT_THAT( strings_to_host(args.data[1]), ::testing::ElementsAre("2019-02-14", "2019-02-15") );
+	}
+	{
+		const char* types[] = { "int32", "value:int32" };
+		json_read_arg args = buffer_args(data);
+		args.num_cols = std::extent<decltype(types)>::value;
+		args.dtype = types;
+		EXPECT_EQ( read_json(&args), GDF_INVALID_API_CALL );
+	}
+	{
+		const char* types[] = { "missing:int32" };
+		json_read_arg args = buffer_args(data);
+		args.num_cols = std::extent<decltype(types)>::value;
+		args.dtype = types;
+		EXPECT_EQ( read_json(&args), GDF_INVALID_API_CALL );
+	}
+}
+
+TEST(gdf_json_test, ByteRange)
+{
+	const char* fname = "/tmp/JsonByteRange.json";
+
+	std::ofstream outfile(fname, std::ofstream::out);
+	for (int i = 1; i <= 9; ++i) {
+		outfile << "{\"a\":" << i * 1000 << "}\n";
+	}
+	outfile.close();
+	ASSERT_TRUE( checkFile(fname) );
+
+	// Each record is 11 bytes, the range holds the starts of records 4 to 6
+	json_read_arg args{};
+	args.input_data_form = gdf_csv_input_form::FILE_PATH;
+	args.filepath_or_buffer = fname;
+	args.lines = true;
+	args.byte_range_offset = 25;
+	args.byte_range_size = 40;
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+
+	ASSERT_EQ( args.num_cols_out, 1 );
+	ASSERT_EQ( args.data[0]->dtype, GDF_INT64 );
+	EXPECT_THAT( to_host<int64_t>(args.data[0]), ::testing::ElementsAre(4000, 5000, 6000) );
+}
+
+TEST(gdf_json_test, EmptyByteRange)
+{
+	// No record starts in the range, nor in blank lines
+	const std::string data = "{\"a\":1000}\n{\"a\":2000}\n";
+	json_read_arg args = buffer_args(data);
+	args.byte_range_offset = 2;
+	args.byte_range_size = 5;
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+	EXPECT_EQ( args.num_cols_out, 0 );
+	EXPECT_EQ( args.num_rows_out, 0 );
+
+	const std::string blank_lines = "\n\n";
+	args = buffer_args(blank_lines);
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+	EXPECT_EQ( args.num_cols_out, 0 );
+	EXPECT_EQ( args.num_rows_out, 0 );
+
+	// The columns that the dtypes name are read without rows
+	const char* dtypes[] = {"a:int64", "b:str"};
+	args = buffer_args(data);
+	args.byte_range_offset = 2;
+	args.byte_range_size = 5;
+	args.num_cols = 2;
+	args.dtype = dtypes;
+	EXPECT_EQ( read_json(&args), GDF_SUCCESS );
+	ASSERT_EQ( args.num_cols_out, 2 );
+	EXPECT_EQ( args.num_rows_out, 0 );
+	EXPECT_STREQ( args.data[0]->col_name, "a" );
+	EXPECT_STREQ( args.data[1]->col_name, "b" );
+	EXPECT_EQ( args.data[0]->dtype, GDF_INT64 );
+	EXPECT_EQ( args.data[1]->dtype, GDF_STRING );
+	EXPECT_EQ( args.data[0]->size, 0 );
+	EXPECT_EQ( args.data[1]->size, 0 );
+}
+
+TEST(gdf_json_test, Errors)
+{
+	const std::string data = "{\"a\": 1}\n";
+
+	json_read_arg args = buffer_args(data);
+	args.lines = false;
+	EXPECT_EQ( read_json(&args), GDF_NOTIMPLEMENTED_ERROR );
+
+	args = buffer_args(data);
+	args.byte_range_offset = data.size();
+	EXPECT_EQ( read_json(&args), GDF_INVALID_API_CALL );
+
+	args = buffer_args(data);
+	args.input_data_form = gdf_csv_input_form::FILE_PATH;
+	args.filepath_or_buffer = "/tmp/JsonDoesNotExist.json";
+	EXPECT_EQ( read_json(&args), GDF_FILE_ERROR );
+}
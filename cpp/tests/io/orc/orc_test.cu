@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <NVStrings.h>
+#include <utilities/cudf_utils.h>
+#include <io/orc/orc_streams.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+#include <rmm/rmm.h>
+
+namespace {
+
+// Writes Protocol Buffers messages
+class protobuf_writer {
+ public:
+  std::vector<uint8_t> bytes;
+
+  void uint(int id, uint64_t v) { varint(static_cast<uint64_t>(id) << 3); varint(v); }
+  void sint(int id, int64_t v) { uint(id, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+  void string(int id, std::string const& v) { message(id, std::vector<uint8_t>(v.begin(), v.end())); }
+  void message(int id, protobuf_writer const& v) { message(id, v.bytes); }
+  void message(int id, std::vector<uint8_t> const& v)
+  {
+    varint((static_cast<uint64_t>(id) << 3) | 2);
+    varint(v.size());
+    bytes.insert(bytes.end(), v.begin(), v.end());
+  }
+
+ private:
+  void varint(uint64_t v)
+  {
+    while (v >= 0x80) {
+      bytes.push_back(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(v));
+  }
+};
+
+enum { NONE = 0, ZLIB = 1, SNAPPY = 2 };
+enum { BOOLEAN = 0, LONG = 4, DOUBLE = 6, STRING = 7, STRUCT = 12 };
+enum { PRESENT = 0, DATA = 1, LENGTH = 2, DICTIONARY_DATA = 3 };
+enum { DIRECT = 0, DIRECT_V2 = 2, DICTIONARY_V2 = 3 };
+
+// Snappy with literals only
+std::vector<uint8_t> snappy(std::vector<uint8_t> const& data)
+{
+  std::vector<uint8_t> out;
+  size_t n = data.size();
+  while (n >= 0x80) {
+    out.push_back(static_cast<uint8_t>(n | 0x80));
+    n >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(n));
+  for (size_t pos = 0; pos < data.size(); pos += 60) {
+    size_t const length = std::min<size_t>(60, data.size() - pos);
+    out.push_back(static_cast<uint8_t>((length - 1) << 2));
+    out.insert(out.end(), data.begin() + pos, data.begin() + pos + length);
+  }
+  return out;
+}
+
+// Raw deflate with a single stored block
+std::vector<uint8_t> deflate_stored(std::vector<uint8_t> const& data)
+{
+  uint16_t const length = static_cast<uint16_t>(data.size());
+  std::vector<uint8_t> out{0x01,
+                           static_cast<uint8_t>(length), static_cast<uint8_t>(length >> 8),
+                           static_cast<uint8_t>(~length), static_cast<uint8_t>(~length >> 8)};
+  out.insert(out.end(), data.begin(), data.end());
+  return out;
+}
+
+/**
+ * Compresses a stream into one block with its 3 byte header, the PRESENT
+ * streams are stored as original blocks
+ */
+std::vector<uint8_t> compress(int compression, std::vector<uint8_t> const& data, bool original)
+{
+  if (NONE == compression) {
+    return data;
+  }
+  std::vector<uint8_t> const block = original ? data
+                                   : (SNAPPY == compression) ? snappy(data) : deflate_stored(data);
+  uint32_t const header = (static_cast<uint32_t>(block.size()) << 1) | (original ? 1 : 0);
+  std::vector<uint8_t> out{static_cast<uint8_t>(header), static_cast<uint8_t>(header >> 8),
+                           static_cast<uint8_t>(header >> 16)};
+  out.insert(out.end(), block.begin(), block.end());
+  return out;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& bytes, T v)
+{
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(&v);
+  bytes.insert(bytes.end(), p, p + sizeof(T));
+}
+
+// A byte run length encoded literal run of the bits of up to 8 values
+std::vector<uint8_t> boolean_stream(std::vector<bool> const& bits)
+{
+  uint8_t byte{0};
+  for (size_t i = 0; i < bits.size(); ++i) {
+    byte |= (bits[i] ? 0x80 : 0) >> i;
+  }
+  return {0xff, byte};
+}
+
+} // namespace
+
+TEST(OrcStreamTest, ByteAndBooleanRle)
+{
+  std::vector<uint8_t> bytes(100, 1);
+  std::vector<uint8_t> const zeros{0x61, 0x00};
+  ASSERT_TRUE(orc::decode_byte_rle(zeros.data(), zeros.size(), 100, bytes.data()));
+  EXPECT_EQ(std::vector<uint8_t>(100, 0), bytes);
+
+  std::vector<uint8_t> const literals{0xfe, 0x44, 0x45};
+  ASSERT_TRUE(orc::decode_byte_rle(literals.data(), literals.size(), 2, bytes.data()));
+  EXPECT_EQ(0x44, bytes[0]);
+  EXPECT_EQ(0x45, bytes[1]);
+  EXPECT_FALSE(orc::decode_byte_rle(literals.data(), literals.size(), 3, bytes.data()));
+
+  std::vector<uint8_t> const bits{0xff, 0x80};
+  ASSERT_TRUE(orc::decode_booleans(bits.data(), bits.size(), 3, bytes.data()));
+  EXPECT_EQ((std::vector<uint8_t>{1, 0, 0}), std::vector<uint8_t>(bytes.begin(), bytes.begin() + 3));
+}
+
+TEST(OrcStreamTest, IntegerRleV1)
+{
+  std::vector<int64_t> values(100);
+  std::vector<uint8_t> const run{0x61, 0x00, 0x07};
+  ASSERT_TRUE(orc::decode_int_rle(run.data(), run.size(), false, false, 100, values.data()));
+  EXPECT_EQ(std::vector<int64_t>(100, 7), values);
+
+  std::vector<uint8_t> const literals{0xfb, 0x02, 0x03, 0x04, 0x07, 0x0b};
+  ASSERT_TRUE(orc::decode_int_rle(literals.data(), literals.size(), false, false, 5, values.data()));
+  EXPECT_EQ((std::vector<int64_t>{2, 3, 4, 7, 11}), std::vector<int64_t>(values.begin(), values.begin() + 5));
+}
+
+TEST(OrcStreamTest, IntegerRleV2)
+{
+  std::vector<int64_t> values(20);
+  std::vector<uint8_t> const short_repeat{0x0a, 0x27, 0x10};
+  ASSERT_TRUE(orc::decode_int_rle(short_repeat.data(), short_repeat.size(), true, false, 5, values.data()));
+  EXPECT_EQ(std::vector<int64_t>(5, 10000), std::vector<int64_t>(values.begin(), values.begin() + 5));
+
+  std::vector<uint8_t> const direct{0x5e, 0x03, 0x5c, 0xa1, 0xab, 0x1e, 0xde, 0xad, 0xbe, 0xef};
+  ASSERT_TRUE(orc::decode_int_rle(direct.data(), direct.size(), true, false, 4, values.data()));
+  EXPECT_EQ((std::vector<int64_t>{23713, 43806, 57005, 48879}),
+            std::vector<int64_t>(values.begin(), values.begin() + 4));
+
+  std::vector<uint8_t> const delta{0xc6, 0x09, 0x02, 0x02, 0x22, 0x42, 0x42, 0x46};
+  ASSERT_TRUE(orc::decode_int_rle(delta.data(), delta.size(), true, false, 10, values.data()));
+  EXPECT_EQ((std::vector<int64_t>{2, 3, 5, 7, 11, 13, 17, 19, 23, 29}),
+            std::vector<int64_t>(values.begin(), values.begin() + 10));
+
+  std::vector<uint8_t> const patched{0x8e, 0x13, 0x2b, 0x21, 0x07, 0xd0, 0x1e, 0x00, 0x14, 0x70,
+                                     0x28, 0x32, 0x3c, 0x46, 0x50, 0x5a, 0x64, 0x6e, 0x78, 0x82,
+                                     0x8c, 0x96, 0xa0, 0xaa, 0xb4, 0xbe, 0xfc, 0xe8};
+  ASSERT_TRUE(orc::decode_int_rle(patched.data(), patched.size(), true, false, 20, values.data()));
+  EXPECT_EQ((std::vector<int64_t>{2030, 2000, 2020, 1000000, 2040, 2050, 2060, 2070, 2080, 2090,
+                                  2100, 2110, 2120, 2130, 2140, 2150, 2160, 2170, 2180, 2190}), values);
+
+  EXPECT_FALSE(orc::decode_int_rle(delta.data(), delta.size() - 1, true, false, 10, values.data()));
+}
+
+struct OrcReaderTest : public GdfTest {
+
+  static constexpr int rows_per_stripe{5};
+  static constexpr int num_stripes{2};
+
+  std::vector<uint8_t> file;
+
+  /**
+   * Writes two stripes of five columns:
+   *  id    LONG, DIRECT_V2, one delta run, with statistics
+   *  score DOUBLE, every third row null
+   *  name  STRING, DICTIONARY_V2
+   *  tag   STRING, DIRECT, every fourth row null
+   *  flag  BOOLEAN
+   */
+  void build(int compression)
+  {
+    file.assign({'O', 'R', 'C'});
+    protobuf_writer footer, metadata;
+
+    for (int s = 0; s < num_stripes; ++s) {
+      int64_t const first = s * rows_per_stripe;
+      uint64_t const offset = file.size();
+      protobuf_writer stripe_footer;
+      auto const add_stream = [&](int kind, int column, std::vector<uint8_t> const& data) {
+        std::vector<uint8_t> const stream = compress(compression, data, PRESENT == kind);
+        file.insert(file.end(), stream.begin(), stream.end());
+        protobuf_writer desc;
+        desc.uint(1, kind);
+        desc.uint(2, column);
+        desc.uint(3, stream.size());
+        stripe_footer.message(1, desc);
+      };
+
+      add_stream(DATA, 1, {0xc0, 0x04, static_cast<uint8_t>(first * 2), 0x02});
+
+      std::vector<bool> score_valid, tag_valid, flags;
+      std::vector<uint8_t> scores, tags;
+      for (int64_t r = first; r < first + rows_per_stripe; ++r) {
+        score_valid.push_back(r % 3 != 1);
+        if (score_valid.back()) append(scores, r * 0.5);
+        tag_valid.push_back(r % 4 != 3);
+        if (tag_valid.back()) {
+          std::string const tag = "t" + std::to_string(r);
+          tags.insert(tags.end(), tag.begin(), tag.end());
+        }
+        flags.push_back(r % 2 == 0);
+      }
+      add_stream(PRESENT, 2, boolean_stream(score_valid));
+      add_stream(DATA, 2, scores);
+
+      // The lengths {3, 5, 4} and the indices {1, 1, 0, 2, 1} are bit-packed
+      add_stream(DATA, 3, {0x42, 0x04, 0x52, 0x40});
+      add_stream(LENGTH, 3, {0x44, 0x02, 0x76, 0x00});
+      std::string const dictionary{"redgreenblue"};
+      add_stream(DICTIONARY_DATA, 3, std::vector<uint8_t>(dictionary.begin(), dictionary.end()));
+
+      add_stream(PRESENT, 4, boolean_stream(tag_valid));
+      add_stream(DATA, 4, tags);
+      add_stream(LENGTH, 4, {static_cast<uint8_t>(tags.size() / 2 - 3), 0x00, 0x02});
+
+      add_stream(DATA, 5, boolean_stream(flags));
+
+      for (int kind : {DIRECT, DIRECT_V2, DIRECT, DICTIONARY_V2, DIRECT, DIRECT}) {
+        protobuf_writer encoding;
+        encoding.uint(1, kind);
+        if (DICTIONARY_V2 == kind) encoding.uint(2, 3);
+        stripe_footer.message(2, encoding);
+      }
+      uint64_t const data_length = file.size() - offset;
+      std::vector<uint8_t> const stripe_footer_bytes = compress(compression, stripe_footer.bytes, false);
+      file.insert(file.end(), stripe_footer_bytes.begin(), stripe_footer_bytes.end());
+
+      protobuf_writer info;
+      info.uint(1, offset);
+      info.uint(2, 0);
+      info.uint(3, data_length);
+      info.uint(4, stripe_footer_bytes.size());
+      info.uint(5, rows_per_stripe);
+      footer.message(3, info);
+
+      protobuf_writer stripe_stats, id_stats, int_stats, empty;
+      int_stats.sint(1, first);
+      int_stats.sint(2, first + rows_per_stripe - 1);
+      id_stats.message(2, int_stats);
+      stripe_stats.message(1, empty);
+      stripe_stats.message(1, id_stats);
+      for (int c = 2; c <= 5; ++c) stripe_stats.message(1, empty);
+      metadata.message(1, stripe_stats);
+    }
+
+    protobuf_writer root;
+    root.uint(1, STRUCT);
+    for (int c = 1; c <= 5; ++c) root.uint(2, c);
+    for (std::string name : {"id", "score", "name", "tag", "flag"}) root.string(3, name);
+    footer.message(4, root);
+    for (int kind : {LONG, DOUBLE, STRING, STRING, BOOLEAN}) {
+      protobuf_writer type;
+      type.uint(1, kind);
+      footer.message(4, type);
+    }
+    footer.uint(6, num_stripes * rows_per_stripe);
+
+    std::vector<uint8_t> const metadata_bytes = compress(compression, metadata.bytes, false);
+    std::vector<uint8_t> const footer_bytes = compress(compression, footer.bytes, false);
+    file.insert(file.end(), metadata_bytes.begin(), metadata_bytes.end());
+    file.insert(file.end(), footer_bytes.begin(), footer_bytes.end());
+
+    protobuf_writer postscript;
+    postscript.uint(1, footer_bytes.size());
+    postscript.uint(2, compression);
+    postscript.uint(3, 256 * 1024);
+    postscript.uint(5, metadata_bytes.size());
+    postscript.string(8000, "ORC");
+    file.insert(file.end(), postscript.bytes.begin(), postscript.bytes.end());
+    file.push_back(static_cast<uint8_t>(postscript.bytes.size()));
+  }
+
+  void SetUp() override
+  {
+    GdfTest::SetUp();
+    build(SNAPPY);
+  }
+
+  orc_read_arg make_args()
+  {
+    orc_read_arg args{};
+    args.input_data_form = HOST_BUFFER;
+    args.filepath_or_buffer = reinterpret_cast<const char*>(file.data());
+    args.buffer_size = file.size();
+    args.filter_op = STATS_FILTER_NONE;
+    return args;
+  }
+
+  // Null strings are returned as empty strings
+  static std::vector<std::string> strings(gdf_column const* column)
+  {
+    auto nvstrings = static_cast<NVStrings*>(column->data);
+    std::vector<int> lengths(nvstrings->size());
+    nvstrings->len(lengths.data(), false);
+    std::vector<std::vector<char>> host(lengths.size());
+    std::vector<char*> host_ptrs;
+    for (size_t i = 0; i < host.size(); ++i) {
+      host[i].resize(std::max(lengths[i], 0) + 1, 0);
+      host_ptrs.push_back(host[i].data());
+    }
+    nvstrings->to_host(host_ptrs.data(), 0, static_cast<int>(host_ptrs.size()));
+    return std::vector<std::string>(host_ptrs.begin(), host_ptrs.end());
+  }
+
+  static void free_columns(orc_read_arg& args)
+  {
+    for (int i = 0; i < args.num_cols_out; ++i) {
+      gdf_column* column = args.data[i];
+      if (GDF_STRING == column->dtype) {
+        NVStrings::destroy(static_cast<NVStrings*>(column->data));
+      } else {
+        RMM_FREE(column->data, 0);
+      }
+      RMM_FREE(column->valid, 0);
+      free(column->col_name);
+      free(column);
+    }
+    free(args.data);
+  }
+
+  void expect_all_columns(orc_read_arg& args)
+  {
+    ASSERT_EQ(5, args.num_cols_out);
+    ASSERT_EQ(10, args.num_rows_out);
+    EXPECT_EQ(0, args.num_stripes_skipped);
+
+    gdf_column const* ids = args.data[0];
+    EXPECT_STREQ("id", ids->col_name);
+    ASSERT_EQ(GDF_INT64, ids->dtype);
+    EXPECT_EQ(nullptr, ids->valid);
+    EXPECT_EQ((std::vector<int64_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), to_host<int64_t>(ids));
+
+    gdf_column const* scores = args.data[1];
+    EXPECT_STREQ("score", scores->col_name);
+    ASSERT_EQ(GDF_FLOAT64, scores->dtype);
+    EXPECT_EQ(3, scores->null_count);
+    auto const score_values = to_host<double>(scores);
+    auto const score_valid = valid_to_host(scores);
+    for (int i = 0; i < 10; ++i) {
+      EXPECT_EQ(i % 3 != 1, score_valid[i]);
+      if (score_valid[i]) {
+        EXPECT_EQ(i * 0.5, score_values[i]);
+      }
+    }
+
+    gdf_column const* names = args.data[2];
+    EXPECT_STREQ("name", names->col_name);
+    ASSERT_EQ(GDF_STRING, names->dtype);
+    EXPECT_EQ((std::vector<std::string>{"green", "green", "red", "blue", "green",
+                                        "green", "green", "red", "blue", "green"}), strings(names));
+
+    gdf_column const* tags = args.data[3];
+    EXPECT_STREQ("tag", tags->col_name);
+    ASSERT_EQ(GDF_STRING, tags->dtype);
+    EXPECT_EQ(2, tags->null_count);
+    EXPECT_EQ((std::vector<std::string>{"t0", "t1", "t2", "", "t4", "t5", "t6", "", "t8", "t9"}),
+              strings(tags));
+
+    gdf_column const* flags = args.data[4];
+    EXPECT_STREQ("flag", flags->col_name);
+    ASSERT_EQ(GDF_INT8, flags->dtype);
+    EXPECT_EQ((std::vector<int8_t>{1, 0, 1, 0, 1, 0, 1, 0, 1, 0}), to_host<int8_t>(flags));
+  }
+};
+
+TEST_F(OrcReaderTest, ReadAll)
+{
+  orc_read_arg args = make_args();
+  ASSERT_EQ(GDF_SUCCESS, read_orc(&args));
+  expect_all_columns(args);
+  free_columns(args);
+}
+
+TEST_F(OrcReaderTest, Compression)
+{
+  for (int compression : {NONE, ZLIB}) {
+    build(compression);
+    orc_read_arg args = make_args();
+    ASSERT_EQ(GDF_SUCCESS, read_orc(&args));
+    expect_all_columns(args);
+    free_columns(args);
+  }
+}
+
+TEST_F(OrcReaderTest, ColumnsAndStripeFilter)
+{
+  const char* use_cols[] = {"tag", "score"};
+  orc_read_arg args = make_args();
+  args.use_cols = use_cols;
+  args.num_cols = 2;
+  args.filter_column = "id";
+  args.filter_op = STATS_FILTER_GREATER_EQUAL;
+  args.filter_value = 7;
+  ASSERT_EQ(GDF_SUCCESS, read_orc(&args));
+  ASSERT_EQ(2, args.num_cols_out);
+  ASSERT_EQ(5, args.num_rows_out);
+  EXPECT_EQ(1, args.num_stripes_skipped);
+
+  // Columns are returned in the order of the file
+  gdf_column const* scores = args.data[0];
+  EXPECT_STREQ("score", scores->col_name);
+  EXPECT_EQ(1, scores->null_count);
+  EXPECT_EQ((std::vector<bool>{true, true, false, true, true}), valid_to_host(scores));
+  EXPECT_EQ(5 * 0.5, to_host<double>(scores)[0]);
+  EXPECT_EQ(9 * 0.5, to_host<double>(scores)[4]);
+
+  gdf_column const* tags = args.data[1];
+  EXPECT_STREQ("tag", tags->col_name);
+  EXPECT_EQ((std::vector<bool>{true, true, false, true, true}), valid_to_host(tags));
+
+  free_columns(args);
+
+  // No stripe holds ids below zero
+  args = make_args();
+  args.filter_column = "id";
+  args.filter_op = STATS_FILTER_LESS;
+  args.filter_value = 0;
+  ASSERT_EQ(GDF_SUCCESS, read_orc(&args));
+  EXPECT_EQ(5, args.num_cols_out);
+  EXPECT_EQ(0, args.num_rows_out);
+  EXPECT_EQ(2, args.num_stripes_skipped);
+  free_columns(args);
+}
+
+TEST_F(OrcReaderTest, FilePath)
+{
+  char path[] = "/tmp/orc_test_XXXXXX";
+  int const fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(static_cast<ssize_t>(file.size()), write(fd, file.data(), file.size()));
+  close(fd);
+
+  orc_read_arg args = make_args();
+  args.input_data_form = FILE_PATH;
+  args.filepath_or_buffer = path;
+  EXPECT_EQ(GDF_SUCCESS, read_orc(&args));
+  EXPECT_EQ(5, args.num_cols_out);
+  EXPECT_EQ(10, args.num_rows_out);
+  free_columns(args);
+  unlink(path);
+}
+
+TEST_F(OrcReaderTest, Errors)
+{
+  const char* missing[] = {"missing"};
+  orc_read_arg args = make_args();
+  args.use_cols = missing;
+  args.num_cols = 1;
+  EXPECT_EQ(GDF_INVALID_API_CALL, read_orc(&args));
+
+  args = make_args();
+  args.filter_column = "missing";
+  args.filter_op = STATS_FILTER_EQUAL;
+  EXPECT_EQ(GDF_INVALID_API_CALL, read_orc(&args));
+
+  std::vector<uint8_t> truncated(file.begin(), file.end() - 1);
+  args = make_args();
+  args.filepath_or_buffer = reinterpret_cast<const char*>(truncated.data());
+  args.buffer_size = truncated.size();
+  EXPECT_EQ(GDF_FILE_ERROR, read_orc(&args));
+
+  EXPECT_EQ(GDF_INVALID_API_CALL, read_orc(nullptr));
+}
@@ -0,0 +1,587 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <NVStrings.h>
+#include <utilities/cudf_utils.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+#include <rmm/rmm.h>
+
+namespace {
+
+// Writes the Thrift compact protocol, field ids must increase by at most 15
+class compact_writer {
+ public:
+  std::vector<uint8_t> bytes;
+
+  compact_writer() : ids(1, 0) {}
+
+  void i32(int id, int32_t v) { header(id, 5); zigzag(v); }
+  void i64(int id, int64_t v) { header(id, 6); zigzag(v); }
+  void binary(int id, std::string const& v) { header(id, 8); element(v); }
+  void element(std::string const& v)
+  {
+    varint(v.size());
+    bytes.insert(bytes.end(), v.begin(), v.end());
+  }
+  void element(int32_t v) { zigzag(v); }
+  void list(int id, int element_type, int size)
+  {
+    header(id, 9);
+    bytes.push_back(static_cast<uint8_t>((size << 4) | element_type));
+  }
+  void begin_struct(int id) { header(id, 12); begin_struct(); }
+  void begin_struct() { ids.push_back(0); }
+  void end_struct() { bytes.push_back(0); ids.pop_back(); }
+
+ private:
+  std::vector<int> ids;
+
+  void header(int id, int type)
+  {
+    bytes.push_back(static_cast<uint8_t>(((id - ids.back()) << 4) | type));
+    ids.back() = id;
+  }
+  void varint(uint64_t v)
+  {
+    while (v >= 0x80) {
+      bytes.push_back(static_cast<uint8_t>(v | 0x80));
+      v >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(v));
+  }
+  void zigzag(int64_t v) { varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63)); }
+};
+
+enum { ST_I32 = 5, ST_BINARY = 8, ST_STRUCT = 12 };
+enum { PLAIN = 0, RLE = 3, BIT_PACKED = 4, RLE_DICTIONARY = 8 };
+enum { UNCOMPRESSED = 0, SNAPPY = 1 };
+enum { DATA_PAGE = 0, DICTIONARY_PAGE = 2 };
+
+// Snappy with greedy back-references into the last 4KB, which may overlap
+// the bytes they produce, and literal runs of at most 60 bytes in between
+std::vector<uint8_t> snappy(std::vector<uint8_t> const& data)
+{
+  std::vector<uint8_t> out;
+  size_t n = data.size();
+  while (n >= 0x80) {
+    out.push_back(static_cast<uint8_t>(n | 0x80));
+    n >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(n));
+
+  size_t literals{0};
+  auto const emit_literals = [&](size_t end) {
+    for (size_t pos = literals; pos < end; pos += 60) {
+      size_t const length = std::min<size_t>(60, end - pos);
+      out.push_back(static_cast<uint8_t>((length - 1) << 2));
+      out.insert(out.end(), data.begin() + pos, data.begin() + pos + length);
+    }
+  };
+
+  size_t pos{0};
+  while (pos < data.size()) {
+    size_t best_length{0}, best_offset{0};
+    for (size_t offset = 1; offset <= std::min<size_t>(pos, 4096); ++offset) {
+      size_t length{0};
+      while (length < 64 && pos + length < data.size() &&
+             data[pos + length] == data[pos + length - offset]) {
+        ++length;
+      }
+      if (length > best_length) {
+        best_length = length;
+        best_offset = offset;
+      }
+    }
+    if (best_length < 4) {
+      ++pos;
+      continue;
+    }
+    emit_literals(pos);
+    if (best_length <= 11 && best_offset < 2048) {
+      // Copy with a 1 byte offset
+      out.push_back(static_cast<uint8_t>(((best_offset >> 8) << 5) | ((best_length - 4) << 2) | 1));
+      out.push_back(static_cast<uint8_t>(best_offset));
+    } else {
+      // Copy with a 2 byte offset
+      out.push_back(static_cast<uint8_t>(((best_length - 1) << 2) | 2));
+      out.push_back(static_cast<uint8_t>(best_offset));
+      out.push_back(static_cast<uint8_t>(best_offset >> 8));
+    }
+    pos += best_length;
+    literals = pos;
+  }
+  emit_literals(data.size());
+  return out;
+}
+
+template <typename T>
+void append(std::vector<uint8_t>& bytes, T v)
+{
+  uint8_t const* p = reinterpret_cast<uint8_t const*>(&v);
+  bytes.insert(bytes.end(), p, p + sizeof(T));
+}
+
+struct column_spec {
+  std::string name;
+  int type;
+  int repetition;
+  int converted_type;
+};
+
+struct chunk_spec {
+  int codec;
+  int64_t num_values;
+  int64_t dictionary_page_offset;
+  int64_t data_page_offset;
+  int64_t total_size;
+  std::string min;
+  std::string max;
+};
+
+// Builds a Parquet file page by page
+class parquet_builder {
+ public:
+  std::vector<uint8_t> file;
+  int definition_level_encoding{RLE};
+
+  parquet_builder() : file{'P', 'A', 'R', '1'} {}
+
+  void add_page(int page_type, int32_t num_values, int encoding, int codec,
+                std::vector<uint8_t> const& payload)
+  {
+    std::vector<uint8_t> const data = (SNAPPY == codec) ? snappy(payload) : payload;
+    compact_writer header;
+    header.i32(1, page_type);
+    header.i32(2, static_cast<int32_t>(payload.size()));
+    header.i32(3, static_cast<int32_t>(data.size()));
+    if (DATA_PAGE == page_type) {
+      header.begin_struct(5);
+      header.i32(1, num_values);
+      header.i32(2, encoding);
+      header.i32(3, definition_level_encoding);
+      header.i32(4, RLE);
+      header.end_struct();
+    } else {
+      header.begin_struct(7);
+      header.i32(1, num_values);
+      header.i32(2, encoding);
+      header.end_struct();
+    }
+    header.end_struct();
+    file.insert(file.end(), header.bytes.begin(), header.bytes.end());
+    file.insert(file.end(), data.begin(), data.end());
+  }
+
+  void finish(std::vector<column_spec> const& columns,
+              std::vector<std::vector<chunk_spec>> const& row_groups,
+              std::vector<int64_t> const& num_rows)
+  {
+    compact_writer meta;
+    meta.begin_struct();
+    meta.i32(1, 1);
+    meta.list(2, ST_STRUCT, static_cast<int>(columns.size() + 1));
+    meta.begin_struct();
+    meta.binary(4, "schema");
+    meta.i32(5, static_cast<int32_t>(columns.size()));
+    meta.end_struct();
+    for (auto const& column : columns) {
+      meta.begin_struct();
+      meta.i32(1, column.type);
+      meta.i32(3, column.repetition);
+      meta.binary(4, column.name);
+      if (column.converted_type >= 0) {
+        meta.i32(6, column.converted_type);
+      }
+      meta.end_struct();
+    }
+    int64_t total_rows{0};
+    for (int64_t n : num_rows) total_rows += n;
+    meta.i64(3, total_rows);
+    meta.list(4, ST_STRUCT, static_cast<int>(row_groups.size()));
+    for (size_t g = 0; g < row_groups.size(); ++g) {
+      meta.begin_struct();
+      meta.list(1, ST_STRUCT, static_cast<int>(columns.size()));
+      for (size_t c = 0; c < columns.size(); ++c) {
+        chunk_spec const& chunk = row_groups[g][c];
+        meta.begin_struct();
+        meta.i64(2, chunk.data_page_offset);
+        meta.begin_struct(3);
+        meta.i32(1, columns[c].type);
+        meta.list(2, ST_I32, 1);
+        meta.element(int32_t{PLAIN});
+        meta.list(3, ST_BINARY, 1);
+        meta.element(columns[c].name);
+        meta.i32(4, chunk.codec);
+        meta.i64(5, chunk.num_values);
+        meta.i64(6, chunk.total_size);
+        meta.i64(7, chunk.total_size);
+        meta.i64(9, chunk.data_page_offset);
+        if (chunk.dictionary_page_offset > 0) {
+          meta.i64(11, chunk.dictionary_page_offset);
+        }
+        if (!chunk.min.empty()) {
+          meta.begin_struct(12);
+          meta.binary(5, chunk.max);
+          meta.binary(6, chunk.min);
+          meta.end_struct();
+        }
+        meta.end_struct();
+        meta.end_struct();
+      }
+      meta.i64(2, 0);
+      meta.i64(3, num_rows[g]);
+      meta.end_struct();
+    }
+    meta.end_struct();
+
+    file.insert(file.end(), meta.bytes.begin(), meta.bytes.end());
+    append(file, static_cast<int32_t>(meta.bytes.size()));
+    file.insert(file.end(), {'P', 'A', 'R', '1'});
+  }
+};
+
+} // namespace
+
+struct ParquetReaderTest : public GdfTest {
+
+  static constexpr int rows_per_group{5};
+  static constexpr int num_groups{2};
+
+  std::vector<uint8_t> file;
+
+  /**
+   * Writes two row groups of three columns:
+   *  id    INT32, required, plain, with statistics
+   *  score DOUBLE, optional, plain, snappy compressed, every third row null
+   *  name  BYTE_ARRAY, required, dictionary encoded
+   */
+  void SetUp() override
+  {
+    GdfTest::SetUp();
+
+    std::vector<column_spec> const columns{{"id", 1, 0, -1},
+                                           {"score", 5, 1, -1},
+                                           {"name", 6, 0, 0}};
+    parquet_builder builder;
+    std::vector<std::vector<chunk_spec>> row_groups;
+    for (int g = 0; g < num_groups; ++g) {
+      std::vector<chunk_spec> chunks;
+      int32_t const first = g * rows_per_group;
+
+      int64_t start = builder.file.size();
+      std::vector<uint8_t> ids;
+      for (int32_t i = 0; i < rows_per_group; ++i) {
+        append(ids, first + i);
+      }
+      builder.add_page(DATA_PAGE, rows_per_group, PLAIN, UNCOMPRESSED, ids);
+      std::string min(4, 0), max(4, 0);
+      int32_t const last = first + rows_per_group - 1;
+      memcpy(&min[0], &first, 4);
+      memcpy(&max[0], &last, 4);
+      chunks.push_back({UNCOMPRESSED, rows_per_group, 0, start,
+                        static_cast<int64_t>(builder.file.size()) - start, min, max});
+
+      // One bit-packed run of definition levels, prefixed by its length
+      start = builder.file.size();
+      std::vector<uint8_t> scores;
+      uint8_t levels{0};
+      std::vector<uint8_t> values;
+      for (int32_t i = 0; i < rows_per_group; ++i) {
+        if ((first + i) % 3 != 1) {
+          levels |= 1 << i;
+          append(values, (first + i) * 0.5);
+        }
+      }
+      append(scores, int32_t{2});
+      scores.push_back(3);
+      scores.push_back(levels);
+      scores.insert(scores.end(), values.begin(), values.end());
+      builder.add_page(DATA_PAGE, rows_per_group, PLAIN, SNAPPY, scores);
+      chunks.push_back({SNAPPY, rows_per_group, 0, start,
+                        static_cast<int64_t>(builder.file.size()) - start, "", ""});
+
+      // The indices are a repeated run of two followed by a bit-packed run
+      start = builder.file.size();
+      std::vector<uint8_t> dictionary;
+      for (std::string s : {"red", "green", "blue"}) {
+        append(dictionary, static_cast<int32_t>(s.size()));
+        dictionary.insert(dictionary.end(), s.begin(), s.end());
+      }
+      builder.add_page(DICTIONARY_PAGE, 3, PLAIN, UNCOMPRESSED, dictionary);
+      int64_t const data_start = builder.file.size();
+      builder.add_page(DATA_PAGE, rows_per_group, RLE_DICTIONARY, UNCOMPRESSED,
+                       {2, 4, 1, 3, 0x18, 0x00});
+      chunks.push_back({UNCOMPRESSED, rows_per_group, start, data_start,
+                        static_cast<int64_t>(builder.file.size()) - start, "", ""});
+
+      row_groups.push_back(chunks);
+    }
+    builder.finish(columns, row_groups, std::vector<int64_t>(num_groups, rows_per_group));
+    file = builder.file;
+  }
+
+  pq_read_arg make_args()
+  {
+    pq_read_arg args{};
+    args.input_data_form = HOST_BUFFER;
+    args.filepath_or_buffer = reinterpret_cast<const char*>(file.data());
+    args.buffer_size = file.size();
+    args.filter_op = STATS_FILTER_NONE;
+    return args;
+  }
+
+  static std::vector<std::string> strings(gdf_column const* column)
+  {
+    auto nvstrings = static_cast<NVStrings*>(column->data);
+    std::vector<int> lengths(nvstrings->size());
+    nvstrings->len(lengths.data(), false);
+    std::vector<std::vector<char>> host(lengths.size());
+    std::vector<char*> host_ptrs;
+    for (size_t i = 0; i < host.size(); ++i) {
+      host[i].resize(lengths[i] + 1);
+      host_ptrs.push_back(host[i].data());
+    }
+    nvstrings->to_host(host_ptrs.data(), 0, static_cast<int>(host_ptrs.size()));
+    return std::vector<std::string>(host_ptrs.begin(), host_ptrs.end());
+  }
+
+  static void free_columns(pq_read_arg& args)
+  {
+    for (int i = 0; i < args.num_cols_out; ++i) {
+      gdf_column* column = args.data[i];
+      if (GDF_STRING == column->dtype) {
+        NVStrings::destroy(static_cast<NVStrings*>(column->data));
+      } else {
+        RMM_FREE(column->data, 0);
+      }
+      RMM_FREE(column->valid, 0);
+      free(column->col_name);
+      free(column);
+    }
+    free(args.data);
+  }
+};
+
+TEST_F(ParquetReaderTest, ReadAll)
+{
+  pq_read_arg args = make_args();
+  ASSERT_EQ(GDF_SUCCESS, read_parquet(&args));
+  ASSERT_EQ(3, args.num_cols_out);
+  ASSERT_EQ(10, args.num_rows_out);
+  EXPECT_EQ(0, args.num_row_groups_skipped);
+
+  gdf_column const* ids = args.data[0];
+  EXPECT_STREQ("id", ids->col_name);
+  ASSERT_EQ(GDF_INT32, ids->dtype);
+  EXPECT_EQ(nullptr, ids->valid);
+  EXPECT_EQ((std::vector<int32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}), to_host<int32_t>(ids));
+
+  gdf_column const* scores = args.data[1];
+  EXPECT_STREQ("score", scores->col_name);
+  ASSERT_EQ(GDF_FLOAT64, scores->dtype);
+  EXPECT_EQ(3, scores->null_count);
+  auto const score_values = to_host<double>(scores);
+  auto const score_valid = valid_to_host(scores);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(i % 3 != 1, score_valid[i]);
+    if (score_valid[i]) {
+      EXPECT_EQ(i * 0.5, score_values[i]);
+    }
+  }
+
+  gdf_column const* names = args.data[2];
+  EXPECT_STREQ("name", names->col_name);
+  ASSERT_EQ(GDF_STRING, names->dtype);
+  EXPECT_EQ((std::vector<std::string>{"green", "green", "red", "blue", "green",
+                                      "green", "green", "red", "blue", "green"}), strings(names));
+
+  free_columns(args);
+}
+
+TEST_F(ParquetReaderTest, ColumnsAndRowGroupFilter)
+{
+  const char* use_cols[] = {"score"};
+  pq_read_arg args = make_args();
+  args.use_cols = use_cols;
+  args.num_cols = 1;
+  args.filter_column = "id";
+  args.filter_op = STATS_FILTER_GREATER_EQUAL;
+  args.filter_value = 7;
+  ASSERT_EQ(GDF_SUCCESS, read_parquet(&args));
+  ASSERT_EQ(1, args.num_cols_out);
+  ASSERT_EQ(5, args.num_rows_out);
+  EXPECT_EQ(1, args.num_row_groups_skipped);
+
+  gdf_column const* scores = args.data[0];
+  EXPECT_STREQ("score", scores->col_name);
+  EXPECT_EQ(1, scores->null_count);
+  EXPECT_EQ((std::vector<bool>{true, true, false, true, true}), valid_to_host(scores));
+  EXPECT_EQ(5 * 0.5, to_host<double>(scores)[0]);
+  EXPECT_EQ(9 * 0.5, to_host<double>(scores)[4]);
+
+  free_columns(args);
+
+  // No row group holds ids below zero
+  args = make_args();
+  args.filter_column = "id";
+  args.filter_op = STATS_FILTER_LESS;
+  args.filter_value = 0;
+  ASSERT_EQ(GDF_SUCCESS, read_parquet(&args));
+  EXPECT_EQ(3, args.num_cols_out);
+  EXPECT_EQ(0, args.num_rows_out);
+  EXPECT_EQ(2, args.num_row_groups_skipped);
+  free_columns(args);
+}
+
+TEST_F(ParquetReaderTest, SnappyBackReferences)
+{
+  // Runs of equal values and a repeating pattern compress into overlapping
+  // copies and copies with 1 and 2 byte offsets
+  int32_t const num_rows{2000};
+  std::vector<uint8_t> payload;
+  for (int32_t i = 0; i < num_rows; ++i) {
+    append(payload, static_cast<int32_t>((i < 500) ? 42 : (i % 700) / 3));
+  }
+  ASSERT_LT(snappy(payload).size(), payload.size() / 4);
+
+  parquet_builder builder;
+  int64_t const start = builder.file.size();
+  builder.add_page(DATA_PAGE, num_rows, PLAIN, SNAPPY, payload);
+  builder.finish({{"value", 1, 0, -1}},
+                 {{{SNAPPY, num_rows, 0, start, static_cast<int64_t>(builder.file.size()) - start, "", ""}}},
+                 {num_rows});
+  file = builder.file;
+
+  pq_read_arg args = make_args();
+  ASSERT_EQ(GDF_SUCCESS, read_parquet(&args));
+  ASSERT_EQ(1, args.num_cols_out);
+  ASSERT_EQ(num_rows, args.num_rows_out);
+  auto const result = to_host<int32_t>(args.data[0]);
+  for (int32_t i = 0; i < num_rows; ++i) {
+    EXPECT_EQ((i < 500) ? 42 : (i % 700) / 3, result[i]) << "row " << i;
+  }
+  free_columns(args);
+}
+
+TEST_F(ParquetReaderTest, FilePath)
+{
+  char path[] = "/tmp/parquet_test_XXXXXX";
+  int const fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(static_cast<ssize_t>(file.size()), write(fd, file.data(), file.size()));
+  close(fd);
+
+  pq_read_arg args = make_args();
+  args.input_data_form = FILE_PATH;
+  args.filepath_or_buffer = path;
+  EXPECT_EQ(GDF_SUCCESS, read_parquet(&args));
+  EXPECT_EQ(3, args.num_cols_out);
+  EXPECT_EQ(10, args.num_rows_out);
+  free_columns(args);
+  unlink(path);
+}
+
+TEST_F(ParquetReaderTest, Errors)
+{
+  const char* missing[] = {"missing"};
+  pq_read_arg args = make_args();
+  args.use_cols = missing;
+  args.num_cols = 1;
+  EXPECT_EQ(GDF_INVALID_API_CALL, read_parquet(&args));
+
+  std::vector<uint8_t> truncated(file.begin(), file.end() - 1);
+  args = make_args();
+  args.filepath_or_buffer = reinterpret_cast<const char*>(truncated.data());
+  args.buffer_size = truncated.size();
+  EXPECT_EQ(GDF_FILE_ERROR, read_parquet(&args));
+
+  EXPECT_EQ(GDF_INVALID_API_CALL, read_parquet(nullptr));
+}
+
+TEST_F(ParquetReaderTest, CorruptPages)
+{
+  // Dictionary indices of 7 into a dictionary of three strings
+  parquet_builder builder;
+  std::vector<uint8_t> dictionary;
+  for (std::string s : {"red", "green", "blue"}) {
+    append(dictionary, static_cast<int32_t>(s.size()));
+    dictionary.insert(dictionary.end(), s.begin(), s.end());
+  }
+  int64_t start = builder.file.size();
+  builder.add_page(DICTIONARY_PAGE, 3, PLAIN, UNCOMPRESSED, dictionary);
+  int64_t const data_start = builder.file.size();
+  builder.add_page(DATA_PAGE, rows_per_group, RLE_DICTIONARY, UNCOMPRESSED, {3, 10, 7});
+  builder.finish({{"name", 6, 0, 0}},
+                 {{{UNCOMPRESSED, rows_per_group, start, data_start,
+                    static_cast<int64_t>(builder.file.size()) - start, "", ""}}},
+                 {rows_per_group});
+  file = builder.file;
+  pq_read_arg args = make_args();
+  EXPECT_EQ(GDF_FILE_ERROR, read_parquet(&args));
+  EXPECT_EQ(nullptr, args.data);
+  EXPECT_EQ(0, args.num_cols_out);
+
+  // Definition levels that run out before the values do
+  builder = parquet_builder{};
+  start = builder.file.size();
+  std::vector<uint8_t> scores;
+  append(scores, int32_t{2});
+  scores.push_back(2 << 1);
+  scores.push_back(1);
+  for (int32_t i = 0; i < rows_per_group; ++i) {
+    append(scores, i * 0.5);
+  }
+  builder.add_page(DATA_PAGE, rows_per_group, PLAIN, UNCOMPRESSED, scores);
+  builder.finish({{"score", 5, 1, -1}},
+                 {{{UNCOMPRESSED, rows_per_group, 0, start,
+                    static_cast<int64_t>(builder.file.size()) - start, "", ""}}},
+                 {rows_per_group});
+  file = builder.file;
+  args = make_args();
+  EXPECT_EQ(GDF_FILE_ERROR, read_parquet(&args));
+
+  // Version 1 pages can only have RLE definition levels
+  builder = parquet_builder{};
+  builder.definition_level_encoding = BIT_PACKED;
+  start = builder.file.size();
+  scores.clear();
+  scores.push_back(0x1f);
+  for (int32_t i = 0; i < rows_per_group; ++i) {
+    append(scores, i * 0.5);
+  }
+  builder.add_page(DATA_PAGE, rows_per_group, PLAIN, UNCOMPRESSED, scores);
+  builder.finish({{"score", 5, 1, -1}},
+                 {{{UNCOMPRESSED, rows_per_group, 0, start,
+                    static_cast<int64_t>(builder.file.size()) - start, "", ""}}},
+                 {rows_per_group});
+  file = builder.file;
+  args = make_args();
+  EXPECT_EQ(GDF_NOTIMPLEMENTED_ERROR, read_parquet(&args));
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+#include <rmm/rmm.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+
+// Trades matched with the quotes of their symbol
+struct AsofJoinTest : public GdfTest {
+
+  std::vector<int32_t> left_symbols, right_symbols;
+  std::vector<int64_t> left_times, right_times;
+
+  void make_tables(size_t num_left, size_t num_right, bool sort_right)
+  {
+    std::mt19937 generator(11);
+    std::uniform_int_distribution<int32_t> symbols(0, 7);
+    std::uniform_int_distribution<int64_t> times(0, 1000);
+
+    left_symbols.resize(num_left);
+    left_times.resize(num_left);
+    for (size_t i = 0; i < num_left; ++i) {
+      left_symbols[i] = symbols(generator);
+      left_times[i] = times(generator);
+    }
+
+    std::vector<std::pair<int32_t, int64_t>> quotes(num_right);
+    for (auto& q : quotes) {
+      q = {symbols(generator), times(generator)};
+    }
+    if (sort_right) {
+      std::stable_sort(quotes.begin(), quotes.end());
+    }
+    right_symbols.clear();
+    right_times.clear();
+    for (auto const& q : quotes) {
+      right_symbols.push_back(q.first);
+      right_times.push_back(q.second);
+    }
+  }
+
+  // Scans all the quotes in sorted order; among equal keys the last one
+  // matches backward and the first one forward
+  std::vector<gdf_index_type> reference(gdf_asof_direction direction, double tolerance,
+                                        bool allow_exact_matches)
+  {
+    std::vector<gdf_index_type> order(right_times.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](gdf_index_type a, gdf_index_type b) {
+      return std::make_pair(right_symbols[a], right_times[a]) < std::make_pair(right_symbols[b], right_times[b]);
+    });
+
+    std::vector<gdf_index_type> result;
+    for (size_t i = 0; i < left_times.size(); ++i) {
+      gdf_index_type backward{-1}, forward{-1};
+      for (gdf_index_type j : order) {
+        if (right_symbols[j] != left_symbols[i]) continue;
+        int64_t const t = right_times[j];
+        if (t < left_times[i] || (allow_exact_matches && t == left_times[i])) {
+          backward = j;
+        }
+        if (forward < 0 && (t > left_times[i] || (allow_exact_matches && t == left_times[i]))) {
+          forward = j;
+        }
+      }
+      if (GDF_ASOF_FORWARD == direction) backward = -1;
+      if (GDF_ASOF_BACKWARD == direction) forward = -1;
+
+      gdf_index_type match{backward};
+      int64_t distance = (backward < 0) ? 0 : left_times[i] - right_times[backward];
+      if (forward >= 0 && (backward < 0 || right_times[forward] - left_times[i] < distance)) {
+        match = forward;
+        distance = right_times[forward] - left_times[i];
+      }
+      if (match >= 0 && tolerance >= 0 && distance > tolerance) {
+        match = -1;
+      }
+      result.push_back(match);
+    }
+    return result;
+  }
+
+  std::vector<gdf_index_type> join(gdf_asof_direction direction, double tolerance,
+                                   bool allow_exact_matches, bool is_sorted)
+  {
+    auto left_by = create_gdf_column(left_symbols);
+    auto left_on = create_gdf_column(left_times);
+    auto right_by = create_gdf_column(right_symbols);
+    auto right_on = create_gdf_column(right_times);
+    std::vector<gdf_index_type> zeros(left_times.size(), 0);
+    auto output = create_gdf_column(zeros);
+
+    gdf_column* left_by_cols[] = {left_by.get()};
+    gdf_column* right_by_cols[] = {right_by.get()};
+    gdf_context ctxt{is_sorted ? 1 : 0, GDF_SORT, 0, 0, 0};
+
+    EXPECT_EQ(GDF_SUCCESS, gdf_asof_join(left_by_cols, left_on.get(), right_by_cols, right_on.get(), 1,
+                                         direction, tolerance, allow_exact_matches, output.get(), &ctxt));
+
+    std::vector<gdf_index_type> result(zeros);
+    cudaMemcpy(result.data(), output->data, result.size() * sizeof(gdf_index_type), cudaMemcpyDeviceToHost);
+    return result;
+  }
+};
+
+TEST_F(AsofJoinTest, Directions)
+{
+  for (bool is_sorted : {true, false}) {
+    make_tables(3000, 2000, is_sorted);
+    for (gdf_asof_direction direction : {GDF_ASOF_BACKWARD, GDF_ASOF_FORWARD, GDF_ASOF_NEAREST}) {
+      EXPECT_EQ(reference(direction, -1, true), join(direction, -1, true, is_sorted));
+    }
+  }
+}
+
+TEST_F(AsofJoinTest, ToleranceAndExactMatches)
+{
+  make_tables(3000, 500, false);
+  for (gdf_asof_direction direction : {GDF_ASOF_BACKWARD, GDF_ASOF_FORWARD, GDF_ASOF_NEAREST}) {
+    EXPECT_EQ(reference(direction, 5, true), join(direction, 5, true, false));
+    EXPECT_EQ(reference(direction, -1, false), join(direction, -1, false, false));
+    EXPECT_EQ(reference(direction, 0, true), join(direction, 0, true, false));
+  }
+}
+
+// Timestamps in seconds matched with timestamps in milliseconds, no groups
+TEST_F(AsofJoinTest, TimestampUnits)
+{
+  std::vector<int64_t> trades{1, 2, 5, 10};
+  std::vector<int64_t> quotes{500, 1000, 1999, 4000, 5000, 9000};
+  auto left_on = create_gdf_column(trades);
+  auto right_on = create_gdf_column(quotes);
+  left_on->dtype = GDF_TIMESTAMP;
+  left_on->dtype_info.time_unit = TIME_UNIT_s;
+  right_on->dtype = GDF_TIMESTAMP;
+  right_on->dtype_info.time_unit = TIME_UNIT_ms;
+
+  std::vector<gdf_index_type> zeros(trades.size(), 0);
+  auto output = create_gdf_column(zeros);
+  gdf_context ctxt{1, GDF_SORT, 0, 0, 0};
+
+  ASSERT_EQ(GDF_SUCCESS, gdf_asof_join(nullptr, left_on.get(), nullptr, right_on.get(), 0,
+                                       GDF_ASOF_BACKWARD, 500, true, output.get(), &ctxt));
+  std::vector<gdf_index_type> result(zeros);
+  cudaMemcpy(result.data(), output->data, result.size() * sizeof(gdf_index_type), cudaMemcpyDeviceToHost);
+  EXPECT_EQ((std::vector<gdf_index_type>{1, 2, 4, -1}), result);
+
+  // The keys must have the same type
+  std::vector<int32_t> ints{1, 2, 3, 4};
+  auto int_col = create_gdf_column(ints);
+  EXPECT_EQ(GDF_DTYPE_MISMATCH, gdf_asof_join(nullptr, int_col.get(), nullptr, right_on.get(), 0,
+                                              GDF_ASOF_BACKWARD, -1, true, output.get(), &ctxt));
+}
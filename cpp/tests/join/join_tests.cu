@@ -476,17 +476,17 @@ struct JoinTest : public GdfTest
     size_t total_pairs = left_result.size;
     size_t output_size = total_pairs*2;
 
-    int * l_join_output = static_cast<int*>(left_result.data);
-    int * r_join_output = static_cast<int*>(right_result.data);
+    gdf_index_type * l_join_output = static_cast<gdf_index_type*>(left_result.data);
+    gdf_index_type * r_join_output = static_cast<gdf_index_type*>(right_result.data);
 
     // Host vector to hold gdf join output
-    std::vector<int> host_result(output_size);
+    std::vector<gdf_index_type> host_result(output_size);
 
     // Copy result of gdf join to the host
     EXPECT_EQ(cudaMemcpy(host_result.data(),
-               l_join_output, total_pairs * sizeof(int), cudaMemcpyDeviceToHost), cudaSuccess);
+               l_join_output, total_pairs * sizeof(gdf_index_type), cudaMemcpyDeviceToHost), cudaSuccess);
     EXPECT_EQ(cudaMemcpy(host_result.data() + total_pairs,
-               r_join_output, total_pairs * sizeof(int), cudaMemcpyDeviceToHost), cudaSuccess);
+               r_join_output, total_pairs * sizeof(gdf_index_type), cudaMemcpyDeviceToHost), cudaSuccess);
 
     // Free the original join result
     if(output_size > 0){
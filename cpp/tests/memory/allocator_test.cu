@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+
+#include "utilities/allocator.hpp"
+
+#include "tests/utilities/cudf_test_fixtures.h"
+
+using cudf::memory::allocation_event;
+using cudf::memory::pool_allocator;
+using cudf::memory::rmm_allocator;
+using cudf::memory::host_allocator;
+
+struct AllocatorTest : public GdfTest {};
+
+TEST_F(AllocatorTest, PoolReusesBlocksOnSameStream)
+{
+  pool_allocator pool{std::make_shared<rmm_allocator>()};
+
+  void* first{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&first, 1000, 0));
+  ASSERT_NE(nullptr, first);
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(first, 0));
+
+  // Same size class, same stream: served from the thread cache
+  void* second{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&second, 700, 0));
+  EXPECT_EQ(first, second);
+
+  gdf_allocator_stats stats = pool.get_stats();
+  EXPECT_EQ(2u, stats.num_allocations);
+  EXPECT_EQ(1u, stats.num_cache_hits);
+  EXPECT_EQ(1u, stats.num_upstream_allocations);
+  EXPECT_EQ(1024u, stats.bytes_in_use);
+  EXPECT_EQ(0u, stats.bytes_cached);
+
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(second, 0));
+  EXPECT_EQ(GDF_SUCCESS, pool.release());
+  stats = pool.get_stats();
+  EXPECT_EQ(0u, stats.bytes_in_use);
+  EXPECT_EQ(0u, stats.bytes_cached);
+}
+
+TEST_F(AllocatorTest, PoolDoesNotReuseAcrossStreams)
+{
+  pool_allocator pool{std::make_shared<rmm_allocator>()};
+  cudaStream_t stream;
+  ASSERT_EQ(cudaSuccess, cudaStreamCreate(&stream));
+
+  void* first{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&first, 4096, stream));
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(first, stream));
+
+  void* second{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&second, 4096, 0));
+  EXPECT_NE(first, second);
+  EXPECT_EQ(0u, pool.get_stats().num_cache_hits);
+
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(second, 0));
+  ASSERT_EQ(GDF_SUCCESS, pool.release());
+  ASSERT_EQ(cudaSuccess, cudaStreamDestroy(stream));
+}
+
+TEST_F(AllocatorTest, PoolSharesBlocksBetweenThreads)
+{
+  pool_allocator pool{std::make_shared<rmm_allocator>()};
+
+  // Blocks cached by a thread are handed to the shared arena when it exits
+  void* block{nullptr};
+  std::thread producer([&] {
+    ASSERT_EQ(GDF_SUCCESS, pool.allocate(&block, 256, 0));
+    ASSERT_EQ(GDF_SUCCESS, pool.deallocate(block, 0));
+  });
+  producer.join();
+
+  void* reused{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&reused, 256, 0));
+  EXPECT_EQ(block, reused);
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(reused, 0));
+  ASSERT_EQ(GDF_SUCCESS, pool.release());
+}
+
+TEST_F(AllocatorTest, PoolReleaseDrainsOtherThreads)
+{
+  pool_allocator pool{std::make_shared<rmm_allocator>()};
+
+  // The worker keeps its cached block until release is done
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool cached{false}, released{false};
+  std::thread worker([&] {
+    void* block{nullptr};
+    ASSERT_EQ(GDF_SUCCESS, pool.allocate(&block, 256, 0));
+    ASSERT_EQ(GDF_SUCCESS, pool.deallocate(block, 0));
+    std::unique_lock<std::mutex> lock(mutex);
+    cached = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return released; });
+  });
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return cached; });
+  }
+  EXPECT_EQ(256u, pool.get_stats().bytes_cached);
+  EXPECT_EQ(GDF_SUCCESS, pool.release());
+  EXPECT_EQ(0u, pool.get_stats().bytes_cached);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    released = true;
+  }
+  cv.notify_all();
+  worker.join();
+  EXPECT_EQ(0u, pool.get_stats().bytes_cached);
+}
+
+TEST_F(AllocatorTest, PoolBypassesCacheForLargeBlocks)
+{
+  pool_allocator::options opts;
+  opts.max_cached_block_size = 1 << 12;
+  pool_allocator pool{std::make_shared<rmm_allocator>(), opts};
+
+  void* ptr{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&ptr, (1 << 12) + 1, 0));
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(ptr, 0));
+  EXPECT_EQ(0u, pool.get_stats().bytes_cached);
+}
+
+TEST_F(AllocatorTest, HookObservesEvents)
+{
+  pool_allocator pool{std::make_shared<rmm_allocator>()};
+  std::vector<allocation_event> events;
+  pool.set_hook([&events](allocation_event const& e) { events.push_back(e); });
+
+  void* ptr{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&ptr, 300, 0));
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(ptr, 0));
+  ASSERT_EQ(GDF_SUCCESS, pool.allocate(&ptr, 300, 0));
+  ASSERT_EQ(GDF_SUCCESS, pool.deallocate(ptr, 0));
+
+  ASSERT_EQ(4u, events.size());
+  EXPECT_EQ(allocation_event::ALLOCATE, events[0].kind);
+  EXPECT_FALSE(events[0].cache_hit);
+  EXPECT_EQ(512u, events[0].bytes);
+  EXPECT_EQ(allocation_event::DEALLOCATE, events[1].kind);
+  EXPECT_EQ(allocation_event::ALLOCATE, events[2].kind);
+  EXPECT_TRUE(events[2].cache_hit);
+
+  pool.set_hook(nullptr);
+  ASSERT_EQ(GDF_SUCCESS, pool.release());
+}
+
+TEST_F(AllocatorTest, InvalidDeallocate)
+{
+  pool_allocator pool{std::make_shared<rmm_allocator>()};
+  int not_owned{0};
+  EXPECT_EQ(GDF_INVALID_API_CALL, pool.deallocate(&not_owned, 0));
+  EXPECT_EQ(GDF_SUCCESS, pool.deallocate(nullptr, 0));
+  EXPECT_EQ(GDF_INVALID_API_CALL, pool.allocate(nullptr, 16, 0));
+}
+
+TEST_F(AllocatorTest, HostAllocatorAlignment)
+{
+  host_allocator host;
+  void* ptr{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, host.allocate(&ptr, 3, 0));
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(ptr) % 256);
+  EXPECT_EQ(3u, host.get_stats().bytes_in_use);
+  ASSERT_EQ(GDF_SUCCESS, host.deallocate(ptr, 0));
+  EXPECT_EQ(0u, host.get_stats().bytes_in_use);
+}
+
+TEST_F(AllocatorTest, ScratchMemoryApi)
+{
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_scratch_memory_stats(nullptr));
+
+  void* ptr{nullptr};
+  ASSERT_EQ(GDF_SUCCESS, cudf::memory::device_allocator().allocate(&ptr, 128, 0));
+  ASSERT_EQ(GDF_SUCCESS, cudf::memory::device_allocator().deallocate(ptr, 0));
+
+  gdf_allocator_stats stats;
+  ASSERT_EQ(GDF_SUCCESS, gdf_scratch_memory_stats(&stats));
+  EXPECT_GE(stats.num_allocations, 1u);
+  EXPECT_GE(stats.bytes_cached, 256u);
+
+  ASSERT_EQ(GDF_SUCCESS, gdf_scratch_memory_release());
+  ASSERT_EQ(GDF_SUCCESS, gdf_scratch_memory_stats(&stats));
+  EXPECT_EQ(0u, stats.bytes_cached);
+}
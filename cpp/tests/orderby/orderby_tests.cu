@@ -19,6 +19,7 @@
 #include <type_traits>
 #include <memory>
 #include <numeric>
+#include <algorithm>
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
@@ -27,6 +28,7 @@
 #include <rmm/rmm.h>
 #include <cudf/functions.h>
 #include <utilities/bit_util.cuh>
+#include <orderby/orderby.h>
 
 #include "tests/utilities/cudf_test_fixtures.h"
 
@@ -224,7 +226,7 @@ struct OrderByTest : public GdfTest
   }
 
   void create_gdf_output_buffers(const size_t orderby_column_length) {
-    std::vector<int> temp(orderby_column_length, 0);
+    std::vector<gdf_index_type> temp(orderby_column_length, 0);
     gdf_output_indices_column = create_gdf_column(temp, nullptr, 0);
     gdf_raw_output_indices_column = gdf_output_indices_column.get();
   }
@@ -315,9 +317,13 @@ struct OrderByTest : public GdfTest
    *
    * @param use_default_sort_order Whether or not to sort using the default ascending order 
    * @param print Option to print the result computed by the libgdf function
+   * @param expected_result The error code the sort is expected to return
+   * @param use_comparison_sort Whether to call the comparison sort directly
+   * instead of gdf_order_by, which radix sorts fixed width columns
    */
   /* ----------------------------------------------------------------------------*/
-  std::vector<size_t> compute_gdf_result(bool use_default_sort_order = false, bool print = false, gdf_error expected_result = GDF_SUCCESS)
+  std::vector<size_t> compute_gdf_result(bool use_default_sort_order = false, bool print = false, gdf_error expected_result = GDF_SUCCESS,
+                                         bool use_comparison_sort = false)
   {
     const int num_columns = std::tuple_size<multi_column_t>::value;
 
@@ -327,11 +333,20 @@ struct OrderByTest : public GdfTest
     gdf_column* sort_order_types = gdf_raw_sort_order_types;
     gdf_column* sorted_indices_output = gdf_raw_output_indices_column;
 
-    result_error = gdf_order_by(columns_to_sort,
-                                (use_default_sort_order ? nullptr : (int8_t*)(sort_order_types->data)),
-                                num_columns,
-                                sorted_indices_output,
-                                nulls_are_smallest);
+    if (use_comparison_sort) {
+      result_error = comparison_order_by(columns_to_sort,
+                                         (use_default_sort_order ? nullptr : (int8_t*)(sort_order_types->data)),
+                                         num_columns,
+                                         sorted_indices_output,
+                                         nulls_are_smallest);
+    }
+    else {
+      result_error = gdf_order_by(columns_to_sort,
+                                  (use_default_sort_order ? nullptr : (int8_t*)(sort_order_types->data)),
+                                  num_columns,
+                                  sorted_indices_output,
+                                  nulls_are_smallest);
+    }
 
     EXPECT_EQ(expected_result, result_error) << "The gdf order by function did not complete successfully";
 
@@ -343,14 +358,14 @@ struct OrderByTest : public GdfTest
     }
 
     size_t output_size = sorted_indices_output->size;
-    int* device_result = static_cast<int*>(sorted_indices_output->data);
+    gdf_index_type* device_result = static_cast<gdf_index_type*>(sorted_indices_output->data);
 
     // Host vector to hold gdf sort output
-    std::vector<int> host_result(output_size);
+    std::vector<gdf_index_type> host_result(output_size);
 
     // Copy result of gdf sorted_indices_output the host
     EXPECT_EQ(cudaMemcpy(host_result.data(),
-               device_result, output_size * sizeof(int), cudaMemcpyDeviceToHost), cudaSuccess);
+               device_result, output_size * sizeof(gdf_index_type), cudaMemcpyDeviceToHost), cudaSuccess);
 
     if(print){
       std::cout << "GDF result size: " << host_result.size() << std::endl;
@@ -361,6 +376,67 @@ struct OrderByTest : public GdfTest
 
     return std::vector<size_t>(host_result.begin(), host_result.end());
   }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief  Computes the first k rows of each segment from the reference
+   * solution. Restricting the stable reference order to the rows of a segment
+   * gives the order of that segment.
+   *
+   * @param segment_offsets The first row of each segment, empty for a single segment
+   * @param k The number of rows to select per segment
+   */
+  /* ----------------------------------------------------------------------------*/
+  std::vector<gdf_index_type> compute_reference_top_k(std::vector<gdf_index_type> const & segment_offsets, gdf_size_type k)
+  {
+    std::vector<size_t> sorted = compute_reference_solution();
+    const gdf_size_type num_segments = std::max<gdf_size_type>(1, segment_offsets.size());
+
+    std::vector<gdf_index_type> result(num_segments * k, -1);
+    std::vector<gdf_size_type> selected(num_segments, 0);
+    for (size_t row : sorted) {
+      gdf_size_type segment = 0;
+      if (!segment_offsets.empty()) {
+        segment = std::upper_bound(segment_offsets.begin(), segment_offsets.end(), static_cast<gdf_index_type>(row))
+                  - segment_offsets.begin() - 1;
+      }
+      if (selected[segment] < k) {
+        result[segment * k + selected[segment]++] = row;
+      }
+    }
+    return result;
+  }
+
+  /* --------------------------------------------------------------------------*/
+  /**
+   * @brief  Computes the first k rows of each segment with gdf_top_k or
+   * gdf_segmented_top_k
+   */
+  /* ----------------------------------------------------------------------------*/
+  std::vector<gdf_index_type> compute_gdf_top_k(std::vector<gdf_index_type> const & segment_offsets, gdf_size_type k)
+  {
+    const int num_columns = std::tuple_size<multi_column_t>::value;
+    const gdf_size_type num_segments = std::max<gdf_size_type>(1, segment_offsets.size());
+
+    std::vector<gdf_index_type> temp(num_segments * k, 0);
+    gdf_col_pointer output = create_gdf_column(temp, nullptr, 0);
+    int8_t* sort_order = static_cast<int8_t*>(gdf_raw_sort_order_types->data);
+
+    gdf_error result_error{GDF_SUCCESS};
+    if (segment_offsets.empty()) {
+      result_error = gdf_top_k(gdf_raw_orderby_columns.data(), sort_order, num_columns,
+                               k, output.get(), nulls_are_smallest);
+    }
+    else {
+      gdf_col_pointer offsets = create_gdf_column(segment_offsets, nullptr, 0);
+      result_error = gdf_segmented_top_k(gdf_raw_orderby_columns.data(), sort_order, num_columns,
+                                         offsets.get(), k, output.get(), nulls_are_smallest);
+    }
+    EXPECT_EQ(GDF_SUCCESS, result_error);
+
+    EXPECT_EQ(cudaMemcpy(temp.data(), output->data, temp.size() * sizeof(gdf_index_type), cudaMemcpyDeviceToHost), cudaSuccess);
+    return temp;
+  }
 };
 
 // This structure is used to nest the number/types of columns and
@@ -400,7 +476,10 @@ typedef ::testing::Types<
                           TestParameters< VTuple<double, int32_t>, true >,
                           // Three Column Order by Tests for some combination of types
                           TestParameters< VTuple<int32_t, double, uint32_t>, false >,
-                          TestParameters< VTuple<float, int32_t, float>, true >
+                          TestParameters< VTuple<float, int32_t, float>, true >,
+                          // Key fields that do not fit into a single 64 bit radix key
+                          TestParameters< VTuple<int64_t, double, int64_t>, false >,
+                          TestParameters< VTuple<int16_t, int64_t, int8_t, double>, true >
                           > Implementations;
 
 TYPED_TEST_CASE(OrderByTest, Implementations);
@@ -599,3 +678,97 @@ TYPED_TEST(OrderByTest, EmptyColumnsDefaultSort)
     EXPECT_EQ(reference_result[i], gdf_result[i]);
   }
 }
+
+/*
+ * Below group of test are for testing the comparison sort, which gdf_order_by
+ * only falls back to for inputs the radix sort cannot handle.
+ **/
+
+TYPED_TEST(OrderByTest, ComparisonSortEqualValuesNull)
+{
+  this->create_input(100, 1, 100);
+  this->create_gdf_output_buffers(100);
+
+  std::vector<size_t> reference_result = this->compute_reference_solution();
+
+  std::vector<size_t> gdf_result = this->compute_gdf_result(false, false, GDF_SUCCESS, true);
+
+  ASSERT_EQ(reference_result.size(), gdf_result.size()) << "Size of gdf result does not match reference result\n";
+
+  // Compare the GDF and reference solutions
+  for(size_t i = 0; i < reference_result.size(); ++i){
+    EXPECT_EQ(reference_result[i], gdf_result[i]);
+  }
+}
+
+TYPED_TEST(OrderByTest, ComparisonSortMaxRandomValuesAndNulls)
+{
+  this->create_input(10000, RAND_MAX, 2000);
+  this->create_gdf_output_buffers(10000);
+
+  std::vector<size_t> reference_result = this->compute_reference_solution();
+
+  std::vector<size_t> gdf_result = this->compute_gdf_result(false, false, GDF_SUCCESS, true);
+
+  ASSERT_EQ(reference_result.size(), gdf_result.size()) << "Size of gdf result does not match reference result\n";
+
+  // Compare the GDF and reference solutions
+  for(size_t i = 0; i < reference_result.size(); ++i){
+    EXPECT_EQ(reference_result[i], gdf_result[i]);
+  }
+}
+
+TYPED_TEST(OrderByTest, ComparisonSortMaxRandomValuesDefaultSort)
+{
+  this->create_input(10000, RAND_MAX, 0, false);
+  this->create_gdf_output_buffers(10000);
+
+  std::vector<size_t> reference_result = this->compute_reference_solution();
+
+  std::vector<size_t> gdf_result = this->compute_gdf_result(true, false, GDF_SUCCESS, true);
+
+  ASSERT_EQ(reference_result.size(), gdf_result.size()) << "Size of gdf result does not match reference result\n";
+
+  // Compare the GDF and reference solutions
+  for(size_t i = 0; i < reference_result.size(); ++i){
+    EXPECT_EQ(reference_result[i], gdf_result[i]);
+  }
+}
+
+/*
+ * Below group of test are for testing the gdf_top_k and gdf_segmented_top_k
+ * methods against the first rows of the reference solution.
+ **/
+
+TYPED_TEST(OrderByTest, TopK)
+{
+  this->create_input(10000, 1000, 2000);
+
+  for (gdf_size_type k : {1, 17, 100, 9999, 10000, 12000}) {
+    std::vector<gdf_index_type> reference_result = this->compute_reference_top_k({}, k);
+    std::vector<gdf_index_type> gdf_result = this->compute_gdf_top_k({}, k);
+
+    ASSERT_EQ(reference_result.size(), gdf_result.size());
+    for(size_t i = 0; i < reference_result.size(); ++i){
+      EXPECT_EQ(reference_result[i], gdf_result[i]) << "k " << k << " position " << i;
+    }
+  }
+}
+
+TYPED_TEST(OrderByTest, SegmentedTopK)
+{
+  this->create_input(10000, 100, 500);
+
+  // Segments much larger than k, smaller than k and empty
+  std::vector<gdf_index_type> segment_offsets{0, 5000, 5003, 5003, 9000, 9990};
+
+  for (gdf_size_type k : {1, 10, 50}) {
+    std::vector<gdf_index_type> reference_result = this->compute_reference_top_k(segment_offsets, k);
+    std::vector<gdf_index_type> gdf_result = this->compute_gdf_top_k(segment_offsets, k);
+
+    ASSERT_EQ(reference_result.size(), gdf_result.size());
+    for(size_t i = 0; i < reference_result.size(); ++i){
+      EXPECT_EQ(reference_result[i], gdf_result[i]) << "k " << k << " position " << i;
+    }
+  }
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//Approximate quantile sketch testing
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+#include <utilities/cudf_utils.h>
+#include <rmm/thrust_rmm_allocator.h>
+#include <quantiles/quantile_sketch.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+
+struct QuantileSketchTest : public GdfTest
+{
+  std::vector<double> qvals{0.0, 0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 1.0};
+
+  // Skewed values, so the tails are not simply linear
+  std::vector<double> make_values(size_t size, unsigned seed)
+  {
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    std::vector<double> values(size);
+    for (auto& v : values) {
+      v = distribution(generator) * distribution(generator);
+    }
+    return values;
+  }
+
+  void add(gdf_quantile_sketch_type* sketch, std::vector<double> const& values)
+  {
+    rmm::device_vector<double> d_values(values);
+    gdf_column col{};
+    col.data = d_values.data().get();
+    col.size = d_values.size();
+    col.dtype = GDF_FLOAT64;
+    ASSERT_EQ(GDF_SUCCESS, gdf_quantile_sketch_add(sketch, &col));
+  }
+
+  std::vector<double> query(gdf_quantile_sketch_type* sketch)
+  {
+    std::vector<double> results(qvals.size());
+    EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_query(sketch, qvals.data(), qvals.size(), results.data()));
+    return results;
+  }
+
+  // The estimates must have ranks within a tolerance that shrinks at the tails
+  void check_ranks(std::vector<double> values, std::vector<double> const& estimates)
+  {
+    std::sort(values.begin(), values.end());
+    for (size_t i = 0; i < qvals.size(); ++i) {
+      double const rank = (std::lower_bound(values.begin(), values.end(), estimates[i]) - values.begin())
+                          / static_cast<double>(values.size());
+      double const tolerance = 0.005 + 0.02 * qvals[i] * (1.0 - qvals[i]);
+      EXPECT_NEAR(qvals[i], rank, tolerance) << "q: " << qvals[i] << "; estimate: " << estimates[i];
+    }
+  }
+};
+
+TEST_F(QuantileSketchTest, Batches)
+{
+  gdf_quantile_sketch_type* sketch = gdf_quantile_sketch(100);
+
+  std::vector<double> all;
+  for (unsigned batch = 0; batch < 10; ++batch) {
+    std::vector<double> values = make_values(10000, batch);
+    add(sketch, values);
+    all.insert(all.end(), values.begin(), values.end());
+  }
+
+  std::vector<double> estimates = query(sketch);
+  check_ranks(all, estimates);
+  EXPECT_EQ(*std::min_element(all.begin(), all.end()), estimates.front());
+  EXPECT_EQ(*std::max_element(all.begin(), all.end()), estimates.back());
+
+  // Memory is bounded by the compression, not by the amount of data
+  EXPECT_LE(gdf_quantile_sketch_serialized_size(sketch),
+            sizeof(QuantileSketch::Header) + 100 * sizeof(Centroid));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_free(sketch));
+}
+
+TEST_F(QuantileSketchTest, MergePartitions)
+{
+  std::vector<gdf_quantile_sketch_type*> partitions;
+  std::vector<double> all;
+  for (unsigned p = 0; p < 4; ++p) {
+    // Partitions with different ranges
+    std::vector<double> values = make_values(5000 * (p + 1), 100 + p);
+    for (auto& v : values) {
+      v += p;
+    }
+    partitions.push_back(gdf_quantile_sketch(0));
+    add(partitions.back(), values);
+    all.insert(all.end(), values.begin(), values.end());
+  }
+
+  gdf_quantile_sketch_type* merged = gdf_quantile_sketch(0);
+  for (auto p : partitions) {
+    EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_merge(merged, p));
+    EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_free(p));
+  }
+
+  check_ranks(all, query(merged));
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_free(merged));
+}
+
+TEST_F(QuantileSketchTest, SerializeRoundTrip)
+{
+  gdf_quantile_sketch_type* sketch = gdf_quantile_sketch(50);
+  add(sketch, make_values(20000, 7));
+
+  std::vector<char> buffer(gdf_quantile_sketch_serialized_size(sketch));
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_quantile_sketch_serialize(sketch, buffer.data(), buffer.size() - 1));
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_serialize(sketch, buffer.data(), buffer.size()));
+
+  gdf_quantile_sketch_type* restored = gdf_quantile_sketch_deserialize(buffer.data(), buffer.size());
+  ASSERT_NE(nullptr, restored);
+  EXPECT_EQ(query(sketch), query(restored));
+
+  // Truncated or corrupted buffers are rejected
+  EXPECT_EQ(nullptr, gdf_quantile_sketch_deserialize(buffer.data(), buffer.size() - 1));
+  buffer[0] = ~buffer[0];
+  EXPECT_EQ(nullptr, gdf_quantile_sketch_deserialize(buffer.data(), buffer.size()));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_free(sketch));
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_free(restored));
+}
+
+TEST_F(QuantileSketchTest, NullsAndEmpty)
+{
+  gdf_quantile_sketch_type* sketch = gdf_quantile_sketch(100);
+
+  std::vector<double> results = query(sketch);
+  for (double r : results) {
+    EXPECT_TRUE(std::isnan(r));
+  }
+
+  // Every other row is null; the null rows hold values far out of range
+  std::vector<int32_t> values(1000);
+  std::vector<int32_t> valid_values;
+  std::vector<gdf_valid_type> valid(gdf_get_num_chars_bitmask(values.size()), 0);
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i % 2 == 0) {
+      values[i] = i;
+      valid[i / GDF_VALID_BITSIZE] |= gdf_valid_type{1} << (i % GDF_VALID_BITSIZE);
+      valid_values.push_back(i);
+    } else {
+      values[i] = 1000000;
+    }
+  }
+  rmm::device_vector<int32_t> d_values(values);
+  rmm::device_vector<gdf_valid_type> d_valid(valid);
+
+  gdf_column col{};
+  col.data = d_values.data().get();
+  col.valid = d_valid.data().get();
+  col.size = values.size();
+  col.null_count = values.size() / 2;
+  col.dtype = GDF_INT32;
+  ASSERT_EQ(GDF_SUCCESS, gdf_quantile_sketch_add(sketch, &col));
+
+  results = query(sketch);
+  EXPECT_EQ(0.0, results.front());
+  EXPECT_EQ(998.0, results.back());
+  check_ranks(std::vector<double>(valid_values.begin(), valid_values.end()), results);
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantile_sketch_free(sketch));
+}
@@ -210,6 +210,123 @@ TEST_F(gdf_quantile, ReportValidMaskError)
 }
 
 
+TEST_F(gdf_quantile, BatchMatchesSingle)
+{
+  using VType = double;
+  std::vector<VType> v{6.8, 0.15, 3.4, 4.17, 2.13, 1.11, -1.01, 0.8, 5.7};
+  rmm::device_vector<VType> d_in = v;
+
+  gdf_column col_in{};
+  col_in.size = d_in.size();
+  col_in.data = d_in.data().get();
+  col_in.valid = nullptr;
+  col_in.null_count = 0;
+  col_in.dtype = GDF_FLOAT64;
+
+  std::vector<double> qvals{0.0, 0.25, 0.33, 0.5, 1.0};
+  std::vector<std::vector<double>> v_baseline_exact{
+    {-1.01, -1.01, 0.15, -0.43, -1.01},
+      {0.3125, 0.15, 0.8, 0.475, 0.15},
+        {0.7805, 0.15, 0.8, 0.475, 0.8},
+          {1.62, 1.11, 2.13, 1.62, 2.13},
+            {6.8, 6.8, 6.8, 6.8, 6.8}};
+
+  // Every combination of quantile and method in one call
+  std::vector<double> q;
+  std::vector<gdf_quantile_method> methods;
+  for(size_t i = 0; i < qvals.size(); ++i)
+    for(int m = 0; m < N_GDF_QUANT_METHODS; ++m)
+      {
+        q.push_back(qvals[i]);
+        methods.push_back(static_cast<gdf_quantile_method>(m));
+      }
+
+  std::vector<double> results(q.size(), 0.0);
+  gdf_context ctxt{0, static_cast<gdf_method>(0), 0, 1};
+  EXPECT_EQ(GDF_SUCCESS, gdf_quantiles(&col_in, q.data(), methods.data(), q.size(), results.data(), &ctxt));
+
+  for(size_t i = 0; i < q.size(); ++i)
+    {
+      EXPECT_NEAR(v_baseline_exact[i / N_GDF_QUANT_METHODS][i % N_GDF_QUANT_METHODS], results[i], 1.0e-8)
+        << "q: " << q[i] << "; method: " << methods[i];
+    }
+
+  // The input is not modified without flag_sort_inplace
+  std::vector<VType> h_in(v.size());
+  thrust::copy(d_in.begin(), d_in.end(), h_in.begin());
+  EXPECT_EQ(v, h_in);
+}
+
+TEST_F(gdf_quantile, GroupQuantiles)
+{
+  using VType = int32_t;
+  // Three groups, the last one empty
+  std::vector<std::vector<VType>> groups{{7, 0, 3, 4, 2, 1, -1, 1, 6}, {5, -3, 8}, {}};
+
+  std::vector<VType> v;
+  std::vector<gdf_index_type> offsets;
+  for(auto const& g : groups)
+    {
+      offsets.push_back(v.size());
+      v.insert(v.end(), g.begin(), g.end());
+    }
+  rmm::device_vector<VType> d_in = v;
+  rmm::device_vector<gdf_index_type> d_offsets = offsets;
+
+  gdf_column col_in{};
+  col_in.size = d_in.size();
+  col_in.data = d_in.data().get();
+  col_in.dtype = GDF_INT32;
+
+  gdf_column segment_offsets{};
+  segment_offsets.size = d_offsets.size();
+  segment_offsets.data = d_offsets.data().get();
+  segment_offsets.dtype = GDF_INDEX_DTYPE;
+
+  std::vector<double> q{0.5, 0.9, 0.99, 0.25};
+  std::vector<gdf_quantile_method> methods{GDF_QUANT_LINEAR, GDF_QUANT_NEAREST, GDF_QUANT_HIGHER, GDF_QUANT_MIDPOINT};
+
+  std::vector<rmm::device_vector<double>> d_out(q.size(), rmm::device_vector<double>(groups.size()));
+  std::vector<gdf_column> out_cols(q.size());
+  std::vector<gdf_column*> out;
+  for(size_t j = 0; j < q.size(); ++j)
+    {
+      out_cols[j] = gdf_column{};
+      out_cols[j].size = groups.size();
+      out_cols[j].data = d_out[j].data().get();
+      out_cols[j].dtype = GDF_FLOAT64;
+      out.push_back(&out_cols[j]);
+    }
+
+  gdf_context ctxt{0, static_cast<gdf_method>(0), 0, 1};
+  EXPECT_EQ(GDF_SUCCESS, gdf_group_quantiles(&col_in, &segment_offsets, q.data(), methods.data(), q.size(), out.data(), &ctxt));
+
+  for(size_t g = 0; g < groups.size(); ++g)
+    {
+      for(size_t j = 0; j < q.size(); ++j)
+        {
+          double result = d_out[j][g];
+          if(groups[g].empty())
+            {
+              EXPECT_TRUE(std::isnan(result));
+              continue;
+            }
+
+          // Compare with the single quantile API on the group alone
+          rmm::device_vector<VType> d_group = groups[g];
+          gdf_column group_col{};
+          group_col.size = d_group.size();
+          group_col.data = d_group.data().get();
+          group_col.dtype = GDF_INT32;
+
+          double expected = 0;
+          EXPECT_EQ(GDF_SUCCESS, gdf_quantile_exact(&group_col, methods[j], q[j], &expected, &ctxt));
+          EXPECT_NEAR(expected, result, 1.0e-8) << "group: " << g << "; q: " << q[j];
+        }
+    }
+}
+
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
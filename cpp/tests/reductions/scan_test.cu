@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+// Host reference of a segmented inclusive scan where null elements do not
+// contribute to the running value
+template <typename T, typename Op>
+std::vector<T> reference_scan(std::vector<T> const& data,
+                              std::vector<bool> const& valid,
+                              std::vector<int> const& offsets,
+                              T identity, Op op, bool inclusive)
+{
+  std::vector<T> result(data.size());
+  size_t segment = 0;
+  T running = identity;
+  for (size_t i = 0; i < data.size(); ++i) {
+    if (segment < offsets.size() && static_cast<int>(i) == offsets[segment]) {
+      running = identity;
+      ++segment;
+    }
+    T value = valid[i] ? data[i] : identity;
+    if (inclusive) {
+      running = op(running, value);
+      result[i] = running;
+    } else {
+      result[i] = running;
+      running = op(running, value);
+    }
+  }
+  return result;
+}
+
+template <class T>
+struct ScanTest : public GdfTest {};
+
+typedef ::testing::Types<int8_t, int16_t, int32_t, int64_t, float, double> ScanTypes;
+TYPED_TEST_CASE(ScanTest, ScanTypes);
+
+TYPED_TEST(ScanTest, InclusiveSum)
+{
+  std::vector<TypeParam> data{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  std::vector<TypeParam> expected{1, 3, 6, 10, 15, 21, 28, 36, 45, 55};
+
+  auto input = create_gdf_column(data);
+  auto output = create_gdf_column(std::vector<TypeParam>(data.size()));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_scan(input.get(), output.get(), GDF_SCAN_SUM, 1));
+  EXPECT_EQ(expected, to_host<TypeParam>(output.get()));
+}
+
+TYPED_TEST(ScanTest, ExclusiveMinMax)
+{
+  std::vector<TypeParam> data{5, 3, 7, 1, 9, 2};
+  std::vector<bool> valid(data.size(), true);
+  std::vector<int> offsets{0};
+
+  auto input = create_gdf_column(data);
+  auto output = create_gdf_column(std::vector<TypeParam>(data.size()));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_scan(input.get(), output.get(), GDF_SCAN_MIN, 0));
+  EXPECT_EQ(reference_scan(data, valid, offsets, std::numeric_limits<TypeParam>::max(),
+                           [](TypeParam a, TypeParam b) { return std::min(a, b); }, false),
+            to_host<TypeParam>(output.get()));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_scan(input.get(), output.get(), GDF_SCAN_MAX, 1));
+  EXPECT_EQ(reference_scan(data, valid, offsets, std::numeric_limits<TypeParam>::lowest(),
+                           [](TypeParam a, TypeParam b) { return std::max(a, b); }, true),
+            to_host<TypeParam>(output.get()));
+}
+
+TYPED_TEST(ScanTest, NullsAreSkipped)
+{
+  std::vector<TypeParam> data{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  // rows 1, 4 and 9 are null
+  std::vector<gdf_valid_type> valid_mask{0xED, 0x01};
+  std::vector<bool> valid{true, false, true, true, false, true, true, true, true, false};
+  std::vector<int> offsets{0};
+
+  auto input = create_gdf_column(data, valid_mask);
+  auto output = create_gdf_column(std::vector<TypeParam>(data.size()),
+                                  std::vector<gdf_valid_type>(valid_mask.size(), 0));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_scan(input.get(), output.get(), GDF_SCAN_SUM, 1));
+  EXPECT_EQ(input->null_count, output->null_count);
+
+  auto expected = reference_scan(data, valid, offsets, TypeParam{0},
+                                 [](TypeParam a, TypeParam b) { return a + b; }, true);
+  auto result = to_host<TypeParam>(output.get());
+  for (size_t i = 0; i < data.size(); ++i) {
+    if (valid[i]) EXPECT_EQ(expected[i], result[i]);
+  }
+
+  EXPECT_EQ(valid, valid_to_host(output.get()));
+}
+
+TYPED_TEST(ScanTest, NullsRequireOutputMask)
+{
+  std::vector<TypeParam> data{1, 2, 3};
+  auto input = create_gdf_column(data, std::vector<gdf_valid_type>{0x05});
+  auto output = create_gdf_column(std::vector<TypeParam>(data.size()));
+
+  EXPECT_EQ(GDF_VALIDITY_MISSING, gdf_scan(input.get(), output.get(), GDF_SCAN_SUM, 1));
+}
+
+TYPED_TEST(ScanTest, SegmentedMultiColumn)
+{
+  std::vector<TypeParam> data0{1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<TypeParam> data1{2, 1, 1, 2, 1, 2, 2, 1};
+  std::vector<bool> valid(data0.size(), true);
+  std::vector<int> offsets{0, 3, 4, 7};
+
+  auto input0 = create_gdf_column(data0);
+  auto input1 = create_gdf_column(data1);
+  auto output0 = create_gdf_column(std::vector<TypeParam>(data0.size()));
+  auto output1 = create_gdf_column(std::vector<TypeParam>(data1.size()));
+  auto segment_offsets = create_gdf_column(offsets);
+
+  gdf_column* inputs[] = {input0.get(), input1.get()};
+  gdf_column* outputs[] = {output0.get(), output1.get()};
+
+  auto product = [](TypeParam a, TypeParam b) { return a * b; };
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_segmented_scan(2, inputs, outputs, segment_offsets.get(),
+                                            GDF_SCAN_PRODUCT, 1));
+  EXPECT_EQ(reference_scan(data0, valid, offsets, TypeParam{1}, product, true),
+            to_host<TypeParam>(output0.get()));
+  EXPECT_EQ(reference_scan(data1, valid, offsets, TypeParam{1}, product, true),
+            to_host<TypeParam>(output1.get()));
+
+  EXPECT_EQ(GDF_SUCCESS, gdf_segmented_scan(2, inputs, outputs, segment_offsets.get(),
+                                            GDF_SCAN_PRODUCT, 0));
+  EXPECT_EQ(reference_scan(data0, valid, offsets, TypeParam{1}, product, false),
+            to_host<TypeParam>(output0.get()));
+  EXPECT_EQ(reference_scan(data1, valid, offsets, TypeParam{1}, product, false),
+            to_host<TypeParam>(output1.get()));
+}
+
+TEST(ScanErrorTest, SizeMismatch)
+{
+  auto input0 = create_gdf_column(std::vector<int32_t>{1, 2, 3});
+  auto input1 = create_gdf_column(std::vector<int32_t>{1, 2});
+  auto output0 = create_gdf_column(std::vector<int32_t>(3));
+  auto output1 = create_gdf_column(std::vector<int32_t>(2));
+
+  gdf_column* inputs[] = {input0.get(), input1.get()};
+  gdf_column* outputs[] = {output0.get(), output1.get()};
+
+  EXPECT_EQ(GDF_COLUMN_SIZE_MISMATCH,
+            gdf_segmented_scan(2, inputs, outputs, nullptr, GDF_SCAN_SUM, 1));
+}
+
+TEST(ScanErrorTest, InvalidSegmentOffsets)
+{
+  auto input = create_gdf_column(std::vector<int32_t>{1, 2, 3, 4});
+  auto output = create_gdf_column(std::vector<int32_t>(4));
+
+  gdf_column* inputs[] = {input.get()};
+  gdf_column* outputs[] = {output.get()};
+
+  auto unsorted = create_gdf_column(std::vector<gdf_index_type>{0, 3, 1});
+  EXPECT_EQ(GDF_INVALID_API_CALL,
+            gdf_segmented_scan(1, inputs, outputs, unsorted.get(), GDF_SCAN_SUM, 1));
+
+  auto negative = create_gdf_column(std::vector<gdf_index_type>{-1, 2});
+  EXPECT_EQ(GDF_INVALID_API_CALL,
+            gdf_segmented_scan(1, inputs, outputs, negative.get(), GDF_SCAN_SUM, 1));
+
+  auto past_end = create_gdf_column(std::vector<gdf_index_type>{0, 2, 5});
+  EXPECT_EQ(GDF_INVALID_API_CALL,
+            gdf_segmented_scan(1, inputs, outputs, past_end.get(), GDF_SCAN_SUM, 1));
+
+  auto empty = create_gdf_column(std::vector<gdf_index_type>{});
+  EXPECT_EQ(GDF_DATASET_EMPTY,
+            gdf_segmented_scan(1, inputs, outputs, empty.get(), GDF_SCAN_SUM, 1));
+}
@@ -25,6 +25,7 @@
 #include <cudf/functions.h>
 
 #include <thrust/device_vector.h>
+#include <utilities/cudf_utils.h>
 
 #include "tests/utilities/cudf_test_fixtures.h"
 #include "tests/utilities/cudf_test_utils.cuh"
@@ -313,3 +314,142 @@ TYPED_TEST(ReplaceTest, LargeScaleReplaceTest)
     }
   }
 }
+
+template <class T>
+struct FindAndReplaceTest : public GdfTest
+{
+  // Remaps many values with a dictionary large enough for the hash table
+  void check_large_map(gdf_unmatched_policy policy)
+  {
+    const size_t data_size = 100000;
+    const size_t map_size = 1000;
+
+    // The values 100..119 are not in the map
+    std::vector<T> data(data_size);
+    std::vector<bool> data_bits(data_size);
+    for (size_t i = 0; i < data_size; ++i) {
+      data[i] = static_cast<T>(i % 120);
+      data_bits[i] = (i % 13 != 0);
+    }
+    // The old values 0..99 occur ten times each; the first occurrence maps to 1
+    std::vector<T> old_values(map_size), new_values(map_size);
+    for (size_t i = 0; i < map_size; ++i) {
+      old_values[i] = static_cast<T>(i % 100);
+      new_values[i] = static_cast<T>(i / 100 + 1);
+    }
+
+    auto col = create_gdf_column(data, make_valid(data_size, [&](size_t i) { return data_bits[i]; }));
+    auto old_col = create_gdf_column(old_values);
+    auto new_col = create_gdf_column(new_values);
+    std::vector<T> default_data{T{7}};
+    auto default_col = create_gdf_column(default_data);
+
+    ASSERT_EQ(GDF_SUCCESS, gdf_find_and_replace(col.get(), old_col.get(), new_col.get(),
+                                                policy, default_col.get()));
+
+    auto result = to_host<T>(col.get());
+    auto result_valid = valid_to_host(col.get());
+    gdf_size_type null_count{0};
+    for (size_t i = 0; i < data_size; ++i) {
+      bool const is_valid = result_valid[i];
+      null_count += !is_valid;
+      if (!data_bits[i]) {
+        EXPECT_FALSE(is_valid);
+        continue;
+      }
+      size_t const v = i % 120;
+      if (v < 100) {
+        EXPECT_TRUE(is_valid) << i;
+        EXPECT_EQ(T{1}, result[i]) << i;
+      } else if (GDF_UNMATCHED_NULL == policy) {
+        EXPECT_FALSE(is_valid) << i;
+      } else {
+        EXPECT_TRUE(is_valid) << i;
+        EXPECT_EQ((GDF_UNMATCHED_DEFAULT == policy) ? T{7} : data[i], result[i]) << i;
+      }
+    }
+    EXPECT_EQ(null_count, col->null_count);
+  }
+};
+
+TYPED_TEST_CASE(FindAndReplaceTest, Types);
+
+TYPED_TEST(FindAndReplaceTest, LargeMapFirstOccurrence)
+{
+  this->check_large_map(GDF_UNMATCHED_KEEP);
+  this->check_large_map(GDF_UNMATCHED_NULL);
+  this->check_large_map(GDF_UNMATCHED_DEFAULT);
+}
+
+TYPED_TEST(FindAndReplaceTest, Unmatched)
+{
+  std::vector<TypeParam> data{1, 2, 3, 4, 5, 6};
+  std::vector<TypeParam> old_values{2, 4, 6};
+  std::vector<TypeParam> new_values{20, 40, 60};
+  std::vector<TypeParam> default_data{9};
+
+  for (gdf_unmatched_policy policy : {GDF_UNMATCHED_KEEP, GDF_UNMATCHED_NULL, GDF_UNMATCHED_DEFAULT}) {
+    // Row 2 is null and stays null
+    auto col = create_gdf_column(data, make_valid(6, [](int i) { return i != 2; }));
+    auto old_col = create_gdf_column(old_values);
+    auto new_col = create_gdf_column(new_values);
+    auto default_col = create_gdf_column(default_data);
+
+    ASSERT_EQ(GDF_SUCCESS, gdf_find_and_replace(col.get(), old_col.get(), new_col.get(),
+                                                policy, default_col.get()));
+    auto result = to_host<TypeParam>(col.get());
+    auto valid = valid_to_host(col.get());
+
+    EXPECT_EQ(TypeParam{20}, result[1]);
+    EXPECT_EQ(TypeParam{40}, result[3]);
+    EXPECT_EQ(TypeParam{60}, result[5]);
+    EXPECT_FALSE(valid[2]);
+    for (size_t i : {0, 4}) {
+      switch (policy) {
+        case GDF_UNMATCHED_KEEP:
+          EXPECT_TRUE(valid[i]);
+          EXPECT_EQ(data[i], result[i]);
+          break;
+        case GDF_UNMATCHED_NULL:
+          EXPECT_FALSE(valid[i]);
+          break;
+        case GDF_UNMATCHED_DEFAULT:
+          EXPECT_TRUE(valid[i]);
+          EXPECT_EQ(TypeParam{9}, result[i]);
+          break;
+      }
+    }
+    EXPECT_EQ((GDF_UNMATCHED_NULL == policy) ? 3 : 1, col->null_count);
+  }
+}
+
+TYPED_TEST(FindAndReplaceTest, NullOldAndNewValues)
+{
+  std::vector<TypeParam> data{1, 2, 3, 4};
+  std::vector<TypeParam> old_values{3, 0, 1};
+  std::vector<TypeParam> new_values{30, 99, 10};
+
+  // Row 1 is null and matches the null old value; 3 is replaced with a null
+  auto gdf_col = create_gdf_column(data, make_valid(4, [](int i) { return i != 1; }));
+  auto old_col = create_gdf_column(old_values, make_valid(3, [](int i) { return i != 1; }));
+  auto new_col = create_gdf_column(new_values, make_valid(3, [](int i) { return i != 0; }));
+
+  ASSERT_EQ(GDF_SUCCESS, gdf_find_and_replace(gdf_col.get(), old_col.get(), new_col.get(),
+                                              GDF_UNMATCHED_KEEP, nullptr));
+  auto result = to_host<TypeParam>(gdf_col.get());
+  auto valid = valid_to_host(gdf_col.get());
+
+  EXPECT_EQ(TypeParam{10}, result[0]);
+  EXPECT_EQ(TypeParam{99}, result[1]);
+  EXPECT_FALSE(valid[2]);
+  EXPECT_EQ(TypeParam{4}, result[3]);
+  EXPECT_TRUE(valid[0]);
+  EXPECT_TRUE(valid[1]);
+  EXPECT_TRUE(valid[3]);
+  EXPECT_EQ(1, gdf_col->null_count);
+
+  // Without a validity mask no row can become null
+  auto no_mask_col = create_gdf_column(data);
+  EXPECT_EQ(GDF_VALIDITY_MISSING, gdf_find_and_replace(no_mask_col.get(), old_col.get(), new_col.get(),
+                                                       GDF_UNMATCHED_KEEP, nullptr));
+}
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+#include <utilities/cudf_utils.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+#include <rmm/rmm.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+
+template <class ColumnType>
+struct HistogramTest : public GdfTest {
+
+  HistogramTest() {
+    std::srand(7);
+  }
+
+  std::vector<ColumnType> random_values(size_t size, int range) {
+    std::vector<ColumnType> values(size);
+    for (auto& v : values) {
+      v = static_cast<ColumnType>(std::rand() % range - range / 2);
+    }
+    return values;
+  }
+
+  // The reference bucket of a value is its number of edges passed
+  static size_t reference_bucket(std::vector<ColumnType> const& edges, ColumnType v, bool right) {
+    return right ? std::lower_bound(edges.begin(), edges.end(), v) - edges.begin()
+                 : std::upper_bound(edges.begin(), edges.end(), v) - edges.begin();
+  }
+
+  void check_histogram(size_t num_rows, size_t num_edges, int range, bool right) {
+    std::vector<ColumnType> values = random_values(num_rows, range);
+    std::vector<ColumnType> edges = random_values(num_edges, range);
+    std::sort(edges.begin(), edges.end());
+
+    std::vector<gdf_valid_type> valid(gdf_get_num_chars_bitmask(num_rows), 0);
+    gdf_size_type null_count{0};
+    for (size_t i = 0; i < num_rows; ++i) {
+      if (i % 7 != 3) {
+        valid[i / GDF_VALID_BITSIZE] |= gdf_valid_type{1} << (i % GDF_VALID_BITSIZE);
+      } else {
+        ++null_count;
+      }
+    }
+
+    gdf_col_pointer col = create_gdf_column(values, valid);
+    col->null_count = null_count;
+    gdf_col_pointer bins = create_gdf_column(edges);
+    bins->null_count = 0;
+
+    rmm::device_vector<gdf_size_type> d_counts(num_edges + 1);
+    rmm::device_vector<double> d_sums(num_edges + 1);
+    gdf_column* cols[] = {col.get()};
+    gdf_column* all_bins[] = {bins.get()};
+    gdf_size_type* counts[] = {d_counts.data().get()};
+    double* sums[] = {d_sums.data().get()};
+    ASSERT_EQ(GDF_SUCCESS, gdf_histogram(cols, all_bins, 1, right, counts, sums));
+
+    std::vector<gdf_size_type> expected_counts(num_edges + 1, 0);
+    std::vector<double> expected_sums(num_edges + 1, 0);
+    for (size_t i = 0; i < num_rows; ++i) {
+      if (gdf_is_valid(valid.data(), i)) {
+        size_t const bucket = reference_bucket(edges, values[i], right);
+        expected_counts[bucket]++;
+        expected_sums[bucket] += static_cast<double>(values[i]);
+      }
+    }
+
+    std::vector<gdf_size_type> result_counts(num_edges + 1);
+    std::vector<double> result_sums(num_edges + 1);
+    thrust::copy(d_counts.begin(), d_counts.end(), result_counts.begin());
+    thrust::copy(d_sums.begin(), d_sums.end(), result_sums.begin());
+
+    EXPECT_EQ(expected_counts, result_counts);
+    for (size_t b = 0; b <= num_edges; ++b) {
+      EXPECT_DOUBLE_EQ(expected_sums[b], result_sums[b]) << "bucket " << b;
+    }
+  }
+};
+
+typedef ::testing::Types<int8_t, int16_t, int32_t, int64_t, float, double> HistogramTypes;
+TYPED_TEST_CASE(HistogramTest, HistogramTypes);
+
+TYPED_TEST(HistogramTest, RightEdges)
+{
+  this->check_histogram(10000, 10, 100, true);
+}
+
+TYPED_TEST(HistogramTest, LeftEdges)
+{
+  this->check_histogram(10000, 10, 100, false);
+}
+
+// Too many buckets to privatize them in shared memory
+TYPED_TEST(HistogramTest, ManyBuckets)
+{
+  this->check_histogram(20000, 5000, 120, false);
+}
+
+// The buckets are the indices of gdf_digitize
+TEST(HistogramDetailTest, MatchesDigitize)
+{
+  std::vector<double> bins_data{0, 2, 5, 7, 8};
+  gdf_col_pointer bins = create_gdf_column(bins_data);
+  bins->null_count = 0;
+
+  std::vector<double> col_in_data{-10, 0, 1, 2, 3, 8, 9, 2, 7.5};
+  gdf_col_pointer col_in = create_gdf_column(col_in_data);
+  col_in->null_count = 0;
+
+  for (bool right : {false, true}) {
+    rmm::device_vector<gdf_index_type> d_indices(col_in_data.size());
+    ASSERT_EQ(GDF_SUCCESS, gdf_digitize(col_in.get(), bins.get(), right, d_indices.data().get()));
+    std::vector<gdf_index_type> indices(col_in_data.size());
+    thrust::copy(d_indices.begin(), d_indices.end(), indices.begin());
+
+    rmm::device_vector<gdf_size_type> d_counts(bins_data.size() + 1);
+    gdf_column* cols[] = {col_in.get()};
+    gdf_column* all_bins[] = {bins.get()};
+    gdf_size_type* counts[] = {d_counts.data().get()};
+    ASSERT_EQ(GDF_SUCCESS, gdf_histogram(cols, all_bins, 1, right, counts, nullptr));
+
+    std::vector<gdf_size_type> expected(bins_data.size() + 1, 0);
+    for (auto i : indices) {
+      expected[i]++;
+    }
+    std::vector<gdf_size_type> result(bins_data.size() + 1);
+    thrust::copy(d_counts.begin(), d_counts.end(), result.begin());
+    EXPECT_EQ(expected, result);
+  }
+}
+
+// Uniform bins match explicit edges, also for values on the edges
+TEST(HistogramDetailTest, UniformMatchesEdges)
+{
+  int const num_bins = 7;
+  double const lo = -1.3;
+  double const hi = 2.9;
+
+  std::vector<double> edges(num_bins + 1);
+  for (int k = 0; k <= num_bins; ++k) {
+    edges[k] = (k == num_bins) ? hi : lo + (hi - lo) * k / num_bins;
+  }
+
+  std::vector<double> values;
+  for (int i = 0; i < 5000; ++i) {
+    values.push_back(-2.0 + 5.5 * (std::rand() / static_cast<double>(RAND_MAX)));
+  }
+  values.insert(values.end(), edges.begin(), edges.end());
+  values.push_back(std::numeric_limits<double>::quiet_NaN());
+  values.push_back(std::numeric_limits<double>::infinity());
+  values.push_back(-std::numeric_limits<double>::infinity());
+
+  gdf_col_pointer col = create_gdf_column(values);
+  col->null_count = 0;
+  gdf_col_pointer bins = create_gdf_column(edges);
+  bins->null_count = 0;
+
+  for (bool right : {false, true}) {
+    rmm::device_vector<gdf_size_type> d_uniform(num_bins + 2), d_edges(num_bins + 2);
+    gdf_column* cols[] = {col.get()};
+    gdf_column* all_bins[] = {bins.get()};
+    gdf_size_type* uniform_counts[] = {d_uniform.data().get()};
+    gdf_size_type* edge_counts[] = {d_edges.data().get()};
+
+    ASSERT_EQ(GDF_SUCCESS, gdf_histogram_uniform(cols, 1, &lo, &hi, num_bins, right, uniform_counts, nullptr));
+    ASSERT_EQ(GDF_SUCCESS, gdf_histogram(cols, all_bins, 1, right, edge_counts, nullptr));
+
+    std::vector<gdf_size_type> uniform(num_bins + 2), expected(num_bins + 2);
+    thrust::copy(d_uniform.begin(), d_uniform.end(), uniform.begin());
+    thrust::copy(d_edges.begin(), d_edges.end(), expected.begin());
+    EXPECT_EQ(expected, uniform);
+
+    // Every value but the NaN is counted
+    gdf_size_type total{0};
+    for (auto c : uniform) {
+      total += c;
+    }
+    EXPECT_EQ(static_cast<gdf_size_type>(values.size() - 1), total);
+  }
+
+  double const bad_hi = lo;
+  gdf_column* cols[] = {col.get()};
+  rmm::device_vector<gdf_size_type> d_counts(num_bins + 2);
+  gdf_size_type* counts[] = {d_counts.data().get()};
+  EXPECT_EQ(GDF_INVALID_API_CALL, gdf_histogram_uniform(cols, 1, &lo, &bad_hi, num_bins, false, counts, nullptr));
+}
+
+// Columns of different types in one call
+TEST(HistogramDetailTest, MultiColumn)
+{
+  std::vector<int32_t> ints{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+  std::vector<float> floats{0.5f, 0.25f, 0.75f, 0.1f, 0.9f};
+  gdf_col_pointer col0 = create_gdf_column(ints);
+  gdf_col_pointer col1 = create_gdf_column(floats);
+  col0->null_count = 0;
+  col1->null_count = 0;
+
+  double const lo[] = {0, 0};
+  double const hi[] = {10, 1};
+  rmm::device_vector<gdf_size_type> d_counts0(4), d_counts1(4);
+  rmm::device_vector<double> d_sums0(4);
+  gdf_column* cols[] = {col0.get(), col1.get()};
+  gdf_size_type* counts[] = {d_counts0.data().get(), d_counts1.data().get()};
+  double* sums[] = {d_sums0.data().get(), nullptr};
+
+  // Bins [0, 5), [5, 10) and [0, 0.5), [0.5, 1)
+  ASSERT_EQ(GDF_SUCCESS, gdf_histogram_uniform(cols, 2, lo, hi, 2, false, counts, sums));
+
+  std::vector<gdf_size_type> counts0(4), counts1(4);
+  std::vector<double> sums0(4);
+  thrust::copy(d_counts0.begin(), d_counts0.end(), counts0.begin());
+  thrust::copy(d_counts1.begin(), d_counts1.end(), counts1.begin());
+  thrust::copy(d_sums0.begin(), d_sums0.end(), sums0.begin());
+
+  EXPECT_EQ((std::vector<gdf_size_type>{0, 4, 5, 1}), counts0);
+  EXPECT_EQ((std::vector<double>{0, 10, 35, 10}), sums0);
+  EXPECT_EQ((std::vector<gdf_size_type>{0, 2, 3, 0}), counts1);
+}
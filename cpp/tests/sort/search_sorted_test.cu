@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+#include <utilities/cudf_utils.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+#include "tests/utilities/cudf_test_utils.cuh"
+
+#include <rmm/rmm.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+
+// A two column table: a key with few distinct values and nulls, then a value
+struct SearchSortedTest : public GdfTest {
+
+  struct row {
+    bool key_valid;
+    int32_t key;
+    double value;
+  };
+
+  std::vector<row> make_rows(size_t size, unsigned seed)
+  {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<int32_t> keys(0, 9);
+    std::uniform_int_distribution<int> values(0, 20);
+    std::vector<row> rows(size);
+    for (auto& r : rows) {
+      r.key_valid = (keys(generator) != 0);
+      r.key = r.key_valid ? keys(generator) : 0;
+      r.value = values(generator) * 0.5;
+    }
+    return rows;
+  }
+
+  // The order of gdf_order_by
+  static int compare(row const& a, row const& b, bool key_desc, bool value_desc, bool nulls_are_smallest)
+  {
+    int result{0};
+    if (a.key_valid != b.key_valid) {
+      result = (a.key_valid == nulls_are_smallest) ? 1 : -1;
+    } else if (a.key_valid) {
+      result = (a.key < b.key) ? -1 : (b.key < a.key) ? 1 : 0;
+    }
+    if (0 != result) {
+      return key_desc ? -result : result;
+    }
+    result = (a.value < b.value) ? -1 : (b.value < a.value) ? 1 : 0;
+    return value_desc ? -result : result;
+  }
+
+  std::vector<gdf_col_pointer> to_columns(std::vector<row> const& rows)
+  {
+    std::vector<int32_t> keys;
+    std::vector<double> values;
+    for (size_t i = 0; i < rows.size(); ++i) {
+      keys.push_back(rows[i].key);
+      values.push_back(rows[i].value);
+    }
+    std::vector<gdf_col_pointer> columns;
+    columns.push_back(create_gdf_column(keys, make_valid(rows.size(), [&](int i) {
+      return rows[i].key_valid;
+    })));
+    columns.push_back(create_gdf_column(values));
+    return columns;
+  }
+
+  void check(size_t num_sorted, size_t num_needles, bool key_desc, bool value_desc,
+             bool nulls_are_smallest)
+  {
+    auto less = [&](row const& a, row const& b) {
+      return compare(a, b, key_desc, value_desc, nulls_are_smallest) < 0;
+    };
+    std::vector<row> sorted = make_rows(num_sorted, 1);
+    std::sort(sorted.begin(), sorted.end(), less);
+    std::vector<row> needles = make_rows(num_needles, 2);
+
+    auto sorted_columns = to_columns(sorted);
+    auto needle_columns = to_columns(needles);
+    gdf_column* sorted_cols[] = {sorted_columns[0].get(), sorted_columns[1].get()};
+    gdf_column* needle_cols[] = {needle_columns[0].get(), needle_columns[1].get()};
+
+    rmm::device_vector<int8_t> asc_desc(std::vector<int8_t>{
+      static_cast<int8_t>(key_desc ? GDF_ORDER_DESC : GDF_ORDER_ASC),
+      static_cast<int8_t>(value_desc ? GDF_ORDER_DESC : GDF_ORDER_ASC)});
+
+    gdf_search_index_type* index = gdf_search_index(sorted_cols, 2, asc_desc.data().get(),
+                                                    nulls_are_smallest);
+    ASSERT_NE(nullptr, index);
+
+    for (gdf_search_side side : {GDF_SEARCH_LEFT, GDF_SEARCH_RIGHT}) {
+      std::vector<gdf_index_type> expected;
+      for (auto const& needle : needles) {
+        auto it = (GDF_SEARCH_LEFT == side) ? std::lower_bound(sorted.begin(), sorted.end(), needle, less)
+                                            : std::upper_bound(sorted.begin(), sorted.end(), needle, less);
+        expected.push_back(it - sorted.begin());
+      }
+
+      std::vector<gdf_index_type> zeros(num_needles, 0);
+      auto output = create_gdf_column(zeros);
+      ASSERT_EQ(GDF_SUCCESS, gdf_search_sorted(sorted_cols, needle_cols, 2, asc_desc.data().get(),
+                                               nulls_are_smallest, side, output.get()));
+      EXPECT_EQ(expected, to_host<gdf_index_type>(output.get()));
+
+      auto indexed_output = create_gdf_column(zeros);
+      ASSERT_EQ(GDF_SUCCESS, gdf_search_index_lookup(index, needle_cols, side, indexed_output.get()));
+      EXPECT_EQ(expected, to_host<gdf_index_type>(indexed_output.get()));
+    }
+
+    EXPECT_EQ(GDF_SUCCESS, gdf_search_index_free(index));
+  }
+};
+
+TEST_F(SearchSortedTest, Ascending)
+{
+  check(10000, 5000, false, false, true);
+}
+
+TEST_F(SearchSortedTest, MixedOrderNullsLargest)
+{
+  check(10000, 5000, true, false, false);
+  check(10000, 5000, false, true, true);
+}
+
+// Tables of every size up to a few levels of the Eytzinger tree
+TEST_F(SearchSortedTest, SmallTables)
+{
+  for (size_t size = 0; size < 40; ++size) {
+    check(size, 100, false, false, true);
+  }
+}
+
+TEST_F(SearchSortedTest, MatchesDigitize)
+{
+  std::vector<double> bins_data{0, 2, 5, 7, 8};
+  std::vector<double> values_data{-10, 0, 1, 2, 3, 8, 9, 2, 7.5};
+  auto bins = create_gdf_column(bins_data);
+  auto values = create_gdf_column(values_data);
+  gdf_column* sorted_cols[] = {bins.get()};
+  gdf_column* needle_cols[] = {values.get()};
+
+  for (bool right : {false, true}) {
+    std::vector<gdf_index_type> zeros(values_data.size(), 0);
+    auto digitized = create_gdf_column(zeros);
+    auto searched = create_gdf_column(zeros);
+    ASSERT_EQ(GDF_SUCCESS, gdf_digitize(values.get(), bins.get(), right,
+                                        static_cast<gdf_index_type*>(digitized->data)));
+    // Digitizing with right edges is searching on the left side
+    ASSERT_EQ(GDF_SUCCESS, gdf_search_sorted(sorted_cols, needle_cols, 1, nullptr, 1,
+                                             right ? GDF_SEARCH_LEFT : GDF_SEARCH_RIGHT,
+                                             searched.get()));
+
+    EXPECT_EQ(to_host<gdf_index_type>(digitized.get()), to_host<gdf_index_type>(searched.get()));
+  }
+
+  // Column types must match
+  std::vector<int32_t> int_data{1, 2};
+  auto ints = create_gdf_column(int_data);
+  gdf_column* int_cols[] = {ints.get()};
+  std::vector<gdf_index_type> zeros(2, 0);
+  auto output = create_gdf_column(zeros);
+  EXPECT_EQ(GDF_DTYPE_MISMATCH, gdf_search_sorted(sorted_cols, int_cols, 1, nullptr, 1,
+                                                  GDF_SEARCH_LEFT, output.get()));
+}
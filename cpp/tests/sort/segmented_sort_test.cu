@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2019, NVIDIA CORPORATION.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include <cudf.h>
+#include <cudf/functions.h>
+
+#include "tests/utilities/cudf_test_fixtures.h"
+
+#include <rmm/rmm.h>
+#include <rmm/thrust_rmm_allocator.h>
+
+
+template <class KeyType>
+struct SegmentedSortTest : public GdfTest {
+
+  gdf_dtype key_dtype()
+  {
+    if (std::is_same<KeyType, int8_t>::value) return GDF_INT8;
+    if (std::is_same<KeyType, int32_t>::value) return GDF_INT32;
+    if (std::is_same<KeyType, int64_t>::value) return GDF_INT64;
+    if (std::is_same<KeyType, float>::value) return GDF_FLOAT32;
+    return GDF_FLOAT64;
+  }
+
+  // Segment lengths covering every strategy: empty, single item, per thread,
+  // per block and device-wide
+  std::vector<unsigned> make_offsets(std::vector<unsigned> const& lengths)
+  {
+    std::vector<unsigned> offsets(lengths.size() + 1, 0);
+    std::partial_sum(lengths.begin(), lengths.end(), offsets.begin() + 1);
+    return offsets;
+  }
+
+  std::vector<unsigned> mixed_lengths()
+  {
+    std::mt19937 generator(17);
+    std::vector<unsigned> lengths;
+    for (unsigned length : {0u, 1u, 2u, 5u, 8u, 9u, 100u, 1024u, 1025u, 5000u}) {
+      lengths.push_back(length);
+    }
+    // Many small groups
+    std::uniform_int_distribution<unsigned> small(0, 12);
+    for (int i = 0; i < 2000; ++i) {
+      lengths.push_back(small(generator));
+    }
+    std::shuffle(lengths.begin(), lengths.end(), generator);
+    return lengths;
+  }
+
+  // Few distinct keys, so the stability of the sort is visible in the values
+  std::vector<KeyType> make_keys(size_t size)
+  {
+    std::mt19937 generator(3);
+    std::uniform_int_distribution<int> distribution(-20, 20);
+    std::vector<KeyType> keys(size);
+    for (auto& k : keys) {
+      k = static_cast<KeyType>(distribution(generator));
+    }
+    return keys;
+  }
+
+  void reference_sort(std::vector<KeyType>& keys, std::vector<int64_t>& values,
+                      std::vector<unsigned> const& offsets, bool descending)
+  {
+    for (size_t s = 0; s + 1 < offsets.size(); ++s) {
+      std::vector<size_t> order(offsets[s + 1] - offsets[s]);
+      std::iota(order.begin(), order.end(), offsets[s]);
+      std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return descending ? keys[b] < keys[a] : keys[a] < keys[b];
+      });
+      std::vector<KeyType> sorted_keys;
+      std::vector<int64_t> sorted_values;
+      for (size_t i : order) {
+        sorted_keys.push_back(keys[i]);
+        sorted_values.push_back(values[i]);
+      }
+      std::copy(sorted_keys.begin(), sorted_keys.end(), keys.begin() + offsets[s]);
+      std::copy(sorted_values.begin(), sorted_values.end(), values.begin() + offsets[s]);
+    }
+  }
+
+  void sort(KeyType* keys, int64_t* values, size_t size,
+            unsigned num_segments, unsigned* begin_offsets, unsigned* end_offsets,
+            bool descending)
+  {
+    gdf_column keycol{};
+    keycol.data = keys;
+    keycol.size = size;
+    keycol.dtype = key_dtype();
+    gdf_column valcol{};
+    valcol.data = values;
+    valcol.size = size;
+    valcol.dtype = GDF_INT64;
+
+    gdf_segmented_radixsort_plan_type* plan =
+      gdf_segmented_radixsort_plan(size, descending, 0, 8 * sizeof(KeyType));
+    ASSERT_EQ(GDF_SUCCESS, gdf_segmented_radixsort_plan_setup(plan, sizeof(KeyType), sizeof(int64_t)));
+    EXPECT_EQ(GDF_SUCCESS, gdf_segmented_radixsort_generic(plan, &keycol, &valcol, num_segments,
+                                                           begin_offsets, end_offsets));
+    EXPECT_EQ(GDF_SUCCESS, gdf_segmented_radixsort_plan_free(plan));
+  }
+
+  void run_device(bool descending, bool keys_only)
+  {
+    std::vector<unsigned> offsets = make_offsets(mixed_lengths());
+    size_t const size = offsets.back();
+    std::vector<KeyType> keys = make_keys(size);
+    std::vector<int64_t> values(size);
+    std::iota(values.begin(), values.end(), 0);
+
+    rmm::device_vector<KeyType> d_keys(keys);
+    rmm::device_vector<int64_t> d_values(values);
+    rmm::device_vector<unsigned> d_offsets(offsets);
+
+    sort(d_keys.data().get(), keys_only ? nullptr : d_values.data().get(), size,
+         offsets.size() - 1, d_offsets.data().get(), d_offsets.data().get() + 1, descending);
+
+    reference_sort(keys, values, offsets, descending);
+
+    std::vector<KeyType> result_keys(size);
+    std::vector<int64_t> result_values(size);
+    thrust::copy(d_keys.begin(), d_keys.end(), result_keys.begin());
+    thrust::copy(d_values.begin(), d_values.end(), result_values.begin());
+
+    EXPECT_EQ(keys, result_keys);
+    if (!keys_only) {
+      EXPECT_EQ(values, result_values);
+    }
+  }
+};
+
+using KeyTypes = ::testing::Types<int8_t, int32_t, int64_t, float, double>;
+TYPED_TEST_CASE(SegmentedSortTest, KeyTypes);
+
+TYPED_TEST(SegmentedSortTest, MixedSegmentsAscending)
+{
+  this->run_device(false, false);
+}
+
+TYPED_TEST(SegmentedSortTest, MixedSegmentsDescending)
+{
+  this->run_device(true, false);
+}
+
+TYPED_TEST(SegmentedSortTest, KeysOnly)
+{
+  this->run_device(false, true);
+  this->run_device(true, true);
+}
+
+TYPED_TEST(SegmentedSortTest, HostMemory)
+{
+  for (bool descending : {false, true}) {
+    std::vector<unsigned> offsets = this->make_offsets(this->mixed_lengths());
+    size_t const size = offsets.back();
+    std::vector<TypeParam> keys = this->make_keys(size);
+    std::vector<int64_t> values(size);
+    std::iota(values.begin(), values.end(), 0);
+
+    std::vector<TypeParam> expected_keys(keys);
+    std::vector<int64_t> expected_values(values);
+    this->reference_sort(expected_keys, expected_values, offsets, descending);
+
+    this->sort(keys.data(), values.data(), size,
+               offsets.size() - 1, offsets.data(), offsets.data() + 1, descending);
+
+    EXPECT_EQ(expected_keys, keys);
+    EXPECT_EQ(expected_values, values);
+  }
+}
@@ -307,3 +307,109 @@ TYPED_TEST(TransposeTest, FatNulls)
     this->set_params(num_cols, num_rows, true);
     this->run_test();
 }
+
+TYPED_TEST(TransposeTest, ManyTilesNulls)
+{
+    size_t num_cols = 77;
+    size_t num_rows = 1001;
+    this->set_params(num_cols, num_rows, true);
+    this->run_test();
+}
+
+struct TransposeMixedTest : public GdfTest {};
+
+// Narrower input columns are widened to the output type
+TEST_F(TransposeMixedTest, Widening)
+{
+    size_t const num_rows = 45;
+    std::vector<int8_t> col0(num_rows);
+    std::vector<int16_t> col1(num_rows);
+    std::vector<int32_t> col2(num_rows);
+    for (size_t i = 0; i < num_rows; ++i) {
+        col0[i] = static_cast<int8_t>(-int(i));
+        col1[i] = static_cast<int16_t>(1000 + i);
+        col2[i] = static_cast<int32_t>(100000 * i);
+    }
+    std::vector<gdf_valid_type> valid(gdf_get_num_chars_bitmask(num_rows), 0xff);
+    valid[0] = 0xfe; // row 0 of col0 is null
+
+    std::vector<gdf_col_pointer> in_gdf_columns;
+    in_gdf_columns.push_back(create_gdf_column(col0, valid));
+    in_gdf_columns.push_back(create_gdf_column(col1));
+    in_gdf_columns.push_back(create_gdf_column(col2));
+    in_gdf_columns[0]->null_count = 1;
+
+    std::vector<std::vector<int32_t>> out_columns(num_rows, std::vector<int32_t>(3));
+    auto out_gdf_columns = initialize_gdf_columns(out_columns);
+
+    std::vector<gdf_column*> in_ptrs, out_ptrs;
+    for (auto& c : in_gdf_columns) in_ptrs.push_back(c.get());
+    for (auto& c : out_gdf_columns) out_ptrs.push_back(c.get());
+
+    ASSERT_EQ(GDF_SUCCESS, gdf_transpose(3, in_ptrs.data(), out_ptrs.data()));
+
+    for (size_t i = 0; i < num_rows; ++i) {
+        std::vector<int32_t> row(3);
+        gdf_valid_type row_valid{0};
+        updateHost(row.data(), static_cast<int32_t*>(out_ptrs[i]->data), 3);
+        updateHost(&row_valid, out_ptrs[i]->valid, 1);
+        EXPECT_EQ(int32_t{col0[i]}, row[0]);
+        EXPECT_EQ(int32_t{col1[i]}, row[1]);
+        EXPECT_EQ(col2[i], row[2]);
+        EXPECT_EQ((i == 0) ? 0x06 : 0x07, row_valid & 0x07);
+        EXPECT_EQ((i == 0) ? 1 : 0, out_ptrs[i]->null_count);
+    }
+
+    // Narrowing is not allowed
+    std::vector<std::vector<int8_t>> narrow_columns(num_rows, std::vector<int8_t>(3));
+    auto narrow_gdf_columns = initialize_gdf_columns(narrow_columns);
+    std::vector<gdf_column*> narrow_ptrs;
+    for (auto& c : narrow_gdf_columns) narrow_ptrs.push_back(c.get());
+    EXPECT_EQ(GDF_DTYPE_MISMATCH, gdf_transpose(3, in_ptrs.data(), narrow_ptrs.data()));
+}
+
+// Tables in host memory are transposed on the host
+TEST_F(TransposeMixedTest, HostMemory)
+{
+    size_t const num_cols = 70;
+    size_t const num_rows = 130;
+    auto is_valid = [](size_t row, size_t col) { return ((row ^ col) % 3) != 0; };
+
+    std::vector<std::vector<int64_t>> in_data(num_cols, std::vector<int64_t>(num_rows));
+    std::vector<std::vector<gdf_valid_type>> in_valid(num_cols,
+        std::vector<gdf_valid_type>(gdf_get_num_chars_bitmask(num_rows), 0));
+    std::vector<gdf_column> in_columns(num_cols);
+    for (size_t c = 0; c < num_cols; ++c) {
+        for (size_t r = 0; r < num_rows; ++r) {
+            in_data[c][r] = c * 1000 + r;
+            if (is_valid(r, c))
+                in_valid[c][r / GDF_VALID_BITSIZE] |= gdf_valid_type{1} << (r % GDF_VALID_BITSIZE);
+        }
+        gdf_column_view(&in_columns[c], in_data[c].data(), in_valid[c].data(), num_rows, GDF_INT64);
+        in_columns[c].null_count = 1;
+    }
+
+    std::vector<std::vector<int64_t>> out_data(num_rows, std::vector<int64_t>(num_cols));
+    std::vector<std::vector<gdf_valid_type>> out_valid(num_rows,
+        std::vector<gdf_valid_type>(gdf_get_num_chars_bitmask(num_cols), 0));
+    std::vector<gdf_column> out_columns(num_rows);
+    for (size_t r = 0; r < num_rows; ++r) {
+        gdf_column_view(&out_columns[r], out_data[r].data(), out_valid[r].data(), num_cols, GDF_INT64);
+    }
+
+    std::vector<gdf_column*> in_ptrs, out_ptrs;
+    for (auto& c : in_columns) in_ptrs.push_back(&c);
+    for (auto& c : out_columns) out_ptrs.push_back(&c);
+
+    ASSERT_EQ(GDF_SUCCESS, gdf_transpose(num_cols, in_ptrs.data(), out_ptrs.data()));
+
+    for (size_t r = 0; r < num_rows; ++r) {
+        gdf_size_type null_count{0};
+        for (size_t c = 0; c < num_cols; ++c) {
+            EXPECT_EQ(in_data[c][r], out_data[r][c]);
+            EXPECT_EQ(is_valid(r, c), gdf_is_valid(out_valid[r].data(), c));
+            null_count += !is_valid(r, c);
+        }
+        EXPECT_EQ(null_count, out_columns[r].null_count);
+    }
+}
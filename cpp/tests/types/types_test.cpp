@@ -17,6 +17,7 @@
 #include "gtest/gtest.h"
 
 #include <utilities/wrapper_types.hpp>
+#include <utilities/cudf_utils.h>
 
 #include <cudf.h>
 
@@ -228,3 +229,15 @@ TYPED_TEST(WrappersTest, CompoundAssignmentOperators)
         }
     }
 }
+
+TEST(SizeTypeTest, IndexDtypeMatchesSizeType)
+{
+#ifdef GDF_LARGE_COLUMNS
+  EXPECT_EQ(sizeof(int64_t), sizeof(gdf_size_type));
+  EXPECT_EQ(GDF_INT64, GDF_INDEX_DTYPE);
+#else
+  EXPECT_EQ(sizeof(int32_t), sizeof(gdf_size_type));
+  EXPECT_EQ(GDF_INT32, GDF_INDEX_DTYPE);
+#endif
+  EXPECT_EQ(sizeof(gdf_size_type), sizeof(gdf_index_type));
+}
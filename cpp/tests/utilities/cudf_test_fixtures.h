@@ -4,6 +4,8 @@
 
 #include <rmm/rmm.h>
 
+#include <cudf.h>
+
 // Base class fixture for GDF google tests that initializes / finalizes the memory manager
 struct GdfTest : public ::testing::Test
 {
@@ -12,6 +14,8 @@ struct GdfTest : public ::testing::Test
     }
 
     static void TearDownTestCase() {
+        // Cached scratch blocks must go back to RMM before it is torn down
+        ASSERT_EQ( GDF_SUCCESS, gdf_scratch_memory_release() );
         ASSERT_EQ( RMM_SUCCESS, rmmFinalize() );
     }
 };
@@ -70,7 +70,7 @@ void print_typed_column(col_type * col_data,
   std::cout << std::endl;
 }
 
-void print_gdf_column(gdf_column const * the_column)
+inline void print_gdf_column(gdf_column const * the_column)
 {
   const size_t num_rows = the_column->size;
 
@@ -132,8 +132,8 @@ void print_gdf_column(gdf_column const * the_column)
  * @param validity_mask The validity bitmask to print
  * @param num_rows The length of the column (not the bitmask) in rows
  * ---------------------------------------------------------------------------**/
-void print_valid_data(const gdf_valid_type *validity_mask, 
-                      const size_t num_rows)
+inline void print_valid_data(const gdf_valid_type *validity_mask, 
+                             const size_t num_rows)
 {
   cudaError_t error;
   cudaPointerAttributes attrib;
@@ -188,7 +188,7 @@ gdf_col_pointer create_gdf_column(std::vector<col_type> const & host_vector,
                                       if(nullptr != col->data){RMM_FREE(col->data, 0);} 
                                       if(nullptr != col->valid){RMM_FREE(col->valid, 0);}
                                     };
-  gdf_col_pointer the_column{new gdf_column, deleter};
+  gdf_col_pointer the_column{new gdf_column{}, deleter};
 
   // Allocate device storage for gdf_column and copy contents from host_vector
   RMM_ALLOC(&(the_column->data), host_vector.size() * sizeof(col_type), 0);
@@ -230,6 +230,67 @@ gdf_col_pointer create_gdf_column(std::vector<col_type> const & host_vector,
   return the_column;
 }
 
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Builds a host validity bitmask of size rows
+ *
+ * @param size The number of rows
+ * @param is_valid Returns whether the row at the index passed to it is valid
+ *
+ * @returns The bitmask, padded to whole gdf_valid_type elements
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename valid_initializer_t>
+std::vector<gdf_valid_type> make_valid(gdf_size_type size, valid_initializer_t is_valid)
+{
+  std::vector<gdf_valid_type> valid(gdf_get_num_chars_bitmask(size), 0);
+  for (gdf_size_type i = 0; i < size; ++i) {
+    if (is_valid(i)) {
+      valid[i / GDF_VALID_BITSIZE] |= gdf_valid_type{1} << (i % GDF_VALID_BITSIZE);
+    }
+  }
+  return valid;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Copies the data of a column to the host
+ *
+ * @param col The column, holding elements of type T
+ *
+ * @returns A host vector of the col->size elements
+ */
+/* ----------------------------------------------------------------------------*/
+template <typename T>
+std::vector<T> to_host(gdf_column const* col)
+{
+  std::vector<T> host(col->size);
+  cudaMemcpy(host.data(), col->data, sizeof(T) * col->size, cudaMemcpyDeviceToHost);
+  return host;
+}
+
+/* --------------------------------------------------------------------------*/
+/**
+ * @brief  Copies the validity of a column to the host, one bool per row
+ *
+ * @param col The column, every row is valid if it has no bitmask
+ *
+ * @returns A host vector of the col->size validity bits
+ */
+/* ----------------------------------------------------------------------------*/
+inline std::vector<bool> valid_to_host(gdf_column const* col)
+{
+  std::vector<bool> valid(col->size, true);
+  if (nullptr != col->valid) {
+    std::vector<gdf_valid_type> mask(gdf_get_num_chars_bitmask(col->size));
+    cudaMemcpy(mask.data(), col->valid, mask.size(), cudaMemcpyDeviceToHost);
+    for (gdf_size_type i = 0; i < col->size; ++i) {
+      valid[i] = gdf_is_valid(mask.data(), i);
+    }
+  }
+  return valid;
+}
+
 // This helper generates the validity mask and creates the GDF column
 // Used by the various initializers below.
 template <typename T, typename valid_initializer_t>
@@ -16,6 +16,9 @@ from librmm_cffi import librmm as rmm
 from cudf.utils import cudautils
 from cudf.utils.utils import calc_chunk_size, mask_dtype, mask_bitsize
 
+# dtype of the row index columns libgdf produces: int64 in a
+# GDF_LARGE_COLUMNS build, int32 otherwise
+index_dtype = np.dtype('int%d' % (8 * ffi.sizeof('gdf_index_type')))
 
 def unwrap_devary(devary):
     ptrval = devary.device_ctypes_pointer.value
@@ -230,8 +233,8 @@ def apply_join(col_lhs, col_rhs, how, method='hash'):
         msg = "method not supported"
         raise ValueError(msg)
 
-    col_result_l = columnview(0, None, dtype=np.int32)
-    col_result_r = columnview(0, None, dtype=np.int32)
+    col_result_l = columnview(0, None, dtype=index_dtype)
+    col_result_r = columnview(0, None, dtype=index_dtype)
 
     if(how in ['left', 'inner']):
         list_lhs = []
@@ -252,11 +255,11 @@ def apply_join(col_lhs, col_rhs, how, method='hash'):
 
     left = rmm.device_array_from_ptr(ptr=col_result_l.data,
                                      nelem=col_result_l.size,
-                                     dtype=np.int32)
+                                     dtype=index_dtype)
 
     right = rmm.device_array_from_ptr(ptr=col_result_r.data,
                                       nelem=col_result_r.size,
-                                      dtype=np.int32)
+                                      dtype=index_dtype)
 
     yield(left, right)
 
@@ -464,7 +467,7 @@ def hash_partition(input_columns, key_indices, nparts, output_columns):
 
     col_inputs = [col.cffi_view for col in input_columns]
     col_outputs = [col.cffi_view for col in output_columns]
-    offsets = ffi.new('int[]', nparts)
+    offsets = ffi.new('gdf_size_type[]', nparts)
     hashfn = libgdf.GDF_HASH_MURMUR3
 
     libgdf.gdf_hash_partition(
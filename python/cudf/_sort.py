@@ -6,6 +6,7 @@ from cudf.dataframe.column import Column
 from cudf.utils import cudautils
 import cudf.bindings.sort as cpp_sort
 from cudf.dataframe import columnops
+from cudf._gdf import index_dtype
 from librmm_cffi import librmm as rmm
 
 import collections
@@ -40,8 +41,8 @@ def get_sorted_inds(by, ascending=True, na_position="last"):
         by = [by]
 
     inds = Buffer(cudautils.arange(len(by[0])))
-    # This is due to current limitation in libcudf of using int32
-    col_inds = columnops.as_column(inds).astype('int32')
+    # libcudf writes gdf_index_type indices
+    col_inds = columnops.as_column(inds).astype(index_dtype)
 
     # This needs to be updated to handle list of bools for ascending
     if ascending is True:
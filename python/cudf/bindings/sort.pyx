@@ -17,6 +17,7 @@ import pyarrow as pa
 
 from libgdf_cffi import ffi, libgdf
 from librmm_cffi import librmm as rmm
+from cudf._gdf import index_dtype
 
 
 from libc.stdint cimport uintptr_t, int8_t
@@ -63,7 +64,7 @@ cpdef digitize(column, bins, right=False):
 
     cdef bool cright = right
     cdef gdf_error result
-    out = rmm.device_array(len(column), dtype=np.int32)
+    out = rmm.device_array(len(column), dtype=index_dtype)
     cdef uintptr_t out_ptr = get_ctype_ptr(out)
 
     with nogil: